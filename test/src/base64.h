@@ -2,6 +2,13 @@
 #define BASE64_H_INCLUDED
 
 
+/* Implementation notes:
+ *   encode_base64() and the streaming encoder work on 24- and 12-byte blocks: each 12 bytes are read as three
+ *   big-endian 32-bit words and split into eight 12-bit values, each turned into two characters by a 4096-entry
+ *   pair table. decode_base64() uses a 256-entry character table. Host tests (RFC 4648 vectors, comparison with
+ *   the previous byte-at-a-time implementation) and the MB/s benchmark: tools/base64_bench.cpp
+ */
+
 /* binary_to_base64:
  *   Description:
  *     Converts a single byte from a binary value to the corresponding base64 character
@@ -71,6 +78,41 @@ unsigned int encode_base64(const unsigned char input[], unsigned int input_lengt
 unsigned int decode_base64(const unsigned char input[], unsigned char output[]);
 unsigned int decode_base64(const unsigned char input[], unsigned int input_length, unsigned char output[]);
 
+/* Streaming encoder
+ *   Description:
+ *     Encodes data that arrives in chunks without holding the whole input or output. Whole 3-byte groups
+ *     are encoded straight from each chunk into a small output buffer, which is handed to the sink
+ *     whenever it fills up and once more by base64_encoder_finish(). Output is identical to encode_base64()
+ *     of the concatenated chunks, without the null terminator.
+ *   Usage:
+ *     base64_encoder encoder;
+ *     base64_encoder_init(&encoder, sink, context);
+ *     base64_encoder_update(&encoder, chunk, chunk_length);   // any number of times, any chunk sizes
+ *     unsigned int written = base64_encoder_finish(&encoder); // adds padding, flushes, returns total characters
+ */
+#ifndef BASE64_ENCODER_BUFFER
+#define BASE64_ENCODER_BUFFER 256 // output characters buffered before each sink call, multiple of 4
+#endif
+
+/* base64_sink:
+ *   Receives encoded characters (not null-terminated). Called from base64_encoder_update()/finish()
+ */
+typedef void (*base64_sink)(const char data[], unsigned int length, void *context);
+
+struct base64_encoder {
+  base64_sink sink;
+  void *context;
+  unsigned char pending[3];      // bytes of an incomplete group carried to the next chunk
+  unsigned int pending_length;
+  char buffer[BASE64_ENCODER_BUFFER];
+  unsigned int buffer_length;
+  unsigned int total;            // characters passed to the sink so far
+};
+
+void base64_encoder_init(base64_encoder *encoder, base64_sink sink, void *context);
+void base64_encoder_update(base64_encoder *encoder, const unsigned char input[], unsigned int input_length);
+unsigned int base64_encoder_finish(base64_encoder *encoder);
+
 
 
 #endif // BASE64_H_INCLUDED
\ No newline at end of file
@@ -1,6 +1,7 @@
 from flask import Flask
 
 from routes.ai_routes import ai_bp
+from routes.audio_routes import audio_bp
 from routes.gps_routes import gps_bp
 from routes.health_routes import health_bp
 from routes.navigation_routes import navigation_bp
@@ -19,6 +20,7 @@ def create_app(test_config=None):
     app.register_blueprint(gps_bp)
     app.register_blueprint(weather_bp)
     app.register_blueprint(navigation_bp)
+    app.register_blueprint(audio_bp)
     return app
 
 
@@ -70,7 +70,7 @@ def walking_navigation(origin: str | None, destination_gps: str) -> dict | None:
                 "origin": origin or DEFAULT_LOCATION,
                 "destination": destination_gps,
                 "key": AMAP_API_KEY,
-                "show_fields": "navi",
+                "show_fields": "navi,polyline",
             },
             timeout=HTTP_TIMEOUT_SECONDS,
         )
@@ -36,11 +36,16 @@ CONVERSATION_TIMEOUT = int(_read_value("CONVERSATION_TIMEOUT", "60"))
 NAVIGATION_TIMEOUT = int(_read_value("NAVIGATION_TIMEOUT", "1800"))
 LOCATION_TIMEOUT = int(_read_value("LOCATION_TIMEOUT", "180"))
 DEVICE_STATUS_TIMEOUT = int(_read_value("DEVICE_STATUS_TIMEOUT", "180"))
+TRACE_KEEP_TURNS = int(_read_value("TRACE_KEEP_TURNS", "20"))
+GPS_TRACK_KEEP_POINTS = int(_read_value("GPS_TRACK_KEEP_POINTS", "7200"))
 ARRIVAL_DISTANCE_METERS = int(_read_value("ARRIVAL_DISTANCE_METERS", "20"))
 
 INTENT_CONFIDENCE_THRESHOLD = float(_read_value("INTENT_CONFIDENCE_THRESHOLD", "0.55"))
 HTTP_TIMEOUT_SECONDS = int(_read_value("HTTP_TIMEOUT_SECONDS", "8"))
 
+AUDIO_DIR = _read_value("AUDIO_DIR", os.path.join(os.path.dirname(os.path.abspath(__file__)), "static", "audio"))
+AUDIO_URL_PREFIX = _read_value("AUDIO_URL_PREFIX", "/audio")
+
 CONFIG_VALUES = {
     "QWEATHER_API_KEY": QWEATHER_API_KEY,
     "AL_API_KEY": AL_API_KEY,
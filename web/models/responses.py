@@ -9,6 +9,7 @@ LOCAL_AUDIO_IDS = {
     "not_understood": "not_understood_001",
     "nav_exit": "nav_exit_001",
     "no_navigation": "no_navigation_001",
+    "nav_starting": "nav_starting_001",
     "network_error": "network_error_001",
     "gps_invalid": "gps_invalid_001",
 }
@@ -1,14 +1,15 @@
-from flask import Blueprint, jsonify, request
+from flask import Blueprint, Response, make_response, request
 
-from services import dispatcher, intent_service, navigation_service, response_service
-from utils.validators import get_device_id, require_json_dict
+from services import dispatcher, fast_intent_rules, intent_service, navigation_service, response_service
+from utils import wire_codec
+from utils.validators import get_device_id
 
 ai_bp = Blueprint("ai", __name__)
 
 
 @ai_bp.route("/ai", methods=["POST"])
 def ai_chat():
-    data = require_json_dict(request)
+    data = wire_codec.read_body(request)
     device_id = get_device_id(request, data)
     text = str(data.get("message") or data.get("text") or "").strip()
     if not text:
@@ -19,33 +20,46 @@ def ai_chat():
             ok=False,
             error={"code": "missing_message"},
         )
-        return jsonify(payload), 400
+        return wire_codec.respond(payload, 400)
 
     context = {"navigation_active": navigation_service.is_navigation_active(device_id)}
     intent = intent_service.recognize_intent(device_id, text, context)
     payload = dispatcher.dispatch_intent(device_id, intent)
-    return jsonify(payload), 200
+    return wire_codec.respond(payload, 200)
 
 
 @ai_bp.route("/v1/intent", methods=["POST"])
 def v1_intent():
-    data = require_json_dict(request)
+    data = wire_codec.read_body(request)
     device_id = get_device_id(request, data)
     text = str(data.get("message") or data.get("text") or "").strip()
     if not text:
-        return jsonify({"ok": False, "device_id": device_id, "error": "missing message"}), 400
+        return wire_codec.respond({"ok": False, "device_id": device_id, "error": "missing message"}, 400)
     context = {"navigation_active": navigation_service.is_navigation_active(device_id)}
     intent = intent_service.recognize_intent(device_id, text, context)
-    return jsonify({"ok": True, "device_id": device_id, "intent": intent.to_dict()}), 200
+    return wire_codec.respond({"ok": True, "device_id": device_id, "intent": intent.to_dict()}, 200)
 
 
 @ai_bp.route("/v1/audio", methods=["POST"])
 def v1_audio_placeholder():
-    data = require_json_dict(request)
+    data = wire_codec.read_body(request)
     device_id = get_device_id(request, data)
     payload = response_service.none_response(
         device_id=device_id,
         intent="audio.upload",
         response="音频接口已预留，第一阶段仍由设备端进行语音识别。",
     )
-    return jsonify(payload), 200
+    return wire_codec.respond(payload, 200)
+
+
+@ai_bp.route("/v1/fast_intent_rules", methods=["GET"])
+def v1_fast_intent_rules():
+    payload = fast_intent_rules.rules_payload()
+    etag = f'"{payload["version"]}"'
+    if etag in request.if_none_match or payload["version"] in request.if_none_match:
+        return Response(status=304, headers={"ETag": etag})
+    response = wire_codec.respond({"ok": True, **payload}, 200)
+    if isinstance(response, tuple):
+        response = make_response(*response)
+    response.headers["ETag"] = etag
+    return response
@@ -0,0 +1,12 @@
+from flask import Blueprint, current_app, send_from_directory
+
+from config import AUDIO_DIR
+
+audio_bp = Blueprint("audio", __name__)
+
+
+@audio_bp.route("/audio/<path:filename>", methods=["GET"])
+def read_audio(filename: str):
+    # send_from_directory 自带 ETag / Last-Modified，硬件端用 If-None-Match 复用缓存
+    audio_dir = current_app.config.get("AUDIO_DIR", AUDIO_DIR)
+    return send_from_directory(audio_dir, filename, mimetype="audio/wav", conditional=True, etag=True)
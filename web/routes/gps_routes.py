@@ -1,14 +1,15 @@
-from flask import Blueprint, jsonify, request
+from flask import Blueprint, request
 
 from services import location_service, response_service
-from utils.validators import get_device_id, require_json_dict
+from utils import track_codec, wire_codec
+from utils.validators import get_device_id
 
 gps_bp = Blueprint("gps", __name__)
 
 
 @gps_bp.route("/gps", methods=["POST"])
 def receive_gps_data():
-    data = require_json_dict(request)
+    data = wire_codec.read_body(request)
     device_id = get_device_id(request, data)
     latitude = data.get("latitude")
     longitude = data.get("longitude")
@@ -20,7 +21,7 @@ def receive_gps_data():
             ok=False,
             error={"code": "missing_latitude_or_longitude"},
         )
-        return jsonify(payload), 400
+        return wire_codec.respond(payload, 400)
     try:
         latitude = float(latitude)
         longitude = float(longitude)
@@ -32,7 +33,7 @@ def receive_gps_data():
             ok=False,
             error={"code": "invalid_latitude_or_longitude"},
         )
-        return jsonify(payload), 400
+        return wire_codec.respond(payload, 400)
 
     info = location_service.update_location(device_id, latitude, longitude)
     payload = response_service.none_response(
@@ -47,4 +48,56 @@ def receive_gps_data():
             "location": info,
         },
     )
-    return jsonify(payload), 200
+    return wire_codec.respond(payload, 200)
+
+
+def _track_error(device_id: str, response: str, code: str, status: int = 400):
+    payload = response_service.api_response(
+        device_id=device_id,
+        intent="location.track",
+        response=response,
+        ok=False,
+        error={"code": code},
+    )
+    return wire_codec.respond(payload, status)
+
+
+@gps_bp.route("/v1/gps/track", methods=["POST"])
+def receive_gps_track():
+    data = wire_codec.read_body(request)
+    device_id = get_device_id(request, data)
+    if data.get("format", track_codec.TRACK_FORMAT) != track_codec.TRACK_FORMAT:
+        return _track_error(device_id, "轨迹格式不支持。", "unsupported_track_format")
+    try:
+        points = track_codec.decode_track(data.get("track"))
+    except track_codec.TrackDecodeError as exc:
+        return _track_error(device_id, f"轨迹数据无效：{exc}", "invalid_track")
+    count = data.get("count")
+    if count is not None and count != len(points):
+        return _track_error(device_id, "轨迹点数与 count 不符。", "track_count_mismatch")
+
+    result = location_service.record_track(device_id, points)
+    payload = response_service.none_response(
+        device_id=device_id,
+        intent="location.track",
+        response="轨迹已接收。",
+        extra={"accepted": result["accepted"], "duplicates": result["duplicates"], "last_t": result["last_t"]},
+    )
+    return wire_codec.respond(payload, 200)
+
+
+@gps_bp.route("/v1/gps/track", methods=["GET"])
+def get_gps_track():
+    device_id = (request.args.get("device_id") or "").strip() or get_device_id(request)
+    try:
+        since = int(request.args.get("since") or 0)
+    except ValueError:
+        since = 0
+    points = location_service.get_track(device_id, since)
+    payload = response_service.none_response(
+        device_id=device_id,
+        intent="location.track",
+        response="",
+        extra={"points": points},
+    )
+    return wire_codec.respond(payload, 200)
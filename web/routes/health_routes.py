@@ -1,8 +1,9 @@
 from flask import Blueprint, jsonify, request
 
 from config import get_missing_keys
-from services import response_service
-from utils.validators import get_device_id, require_json_dict
+from services import response_service, trace_service
+from utils import wire_codec
+from utils.validators import get_device_id
 
 health_bp = Blueprint("health", __name__)
 
@@ -14,12 +15,12 @@ def index():
 
 @health_bp.route("/health", methods=["GET"])
 def health():
-    return jsonify({"ok": True, "service": "guide-cane-web", "missing_config": get_missing_keys()}), 200
+    return wire_codec.respond({"ok": True, "service": "guide-cane-web", "missing_config": get_missing_keys()}, 200)
 
 
 @health_bp.route("/v1/device/status", methods=["POST"])
 def device_status():
-    data = require_json_dict(request)
+    data = wire_codec.read_body(request)
     device_id = get_device_id(request, data)
     payload = response_service.api_response(
         device_id=device_id,
@@ -27,4 +28,34 @@ def device_status():
         response="设备状态已接收。",
         extra={"device_status": data},
     )
-    return jsonify(payload), 200
+    return wire_codec.respond(payload, 200)
+
+
+@health_bp.route("/v1/device/trace", methods=["POST"])
+def device_trace_upload():
+    data = wire_codec.read_body(request)
+    device_id = get_device_id(request, data)
+    accepted = trace_service.record_turn(device_id, data)
+    if not accepted:
+        payload = response_service.api_response(
+            device_id=device_id,
+            intent="device.trace",
+            response="追踪数据为空或格式错误。",
+            ok=False,
+            error={"code": "invalid_trace"},
+        )
+        return wire_codec.respond(payload, 400)
+    payload = response_service.api_response(
+        device_id=device_id,
+        intent="device.trace",
+        response="追踪数据已接收。",
+        extra={"events": accepted},
+    )
+    return wire_codec.respond(payload, 200)
+
+
+@health_bp.route("/v1/device/trace", methods=["GET"])
+def device_trace():
+    # 直接返回 Chrome trace-event 格式，不套统一响应结构，便于下载后拖进 Perfetto
+    device_id = (request.args.get("device_id") or "").strip() or get_device_id(request)
+    return jsonify(trace_service.chrome_trace(device_id)), 200
@@ -1,6 +1,7 @@
-from flask import Blueprint, jsonify, request
+from flask import Blueprint, request
 
 from services import weather_service
+from utils import wire_codec
 from utils.validators import get_device_id
 
 weather_bp = Blueprint("weather", __name__)
@@ -13,4 +14,4 @@ def read_weather():
     date = weather_service.normalize_weather_date(request.args.get("date", "today"))
     payload = weather_service.query_weather(device_id, city, date)
     status = 200 if payload.get("ok") else 503
-    return jsonify(payload), status
+    return wire_codec.respond(payload, status)
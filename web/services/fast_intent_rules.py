@@ -0,0 +1,125 @@
+"""Fast-intent rules exported to the device.
+
+The device runs the same keyword matching as `intent_service.fast_intent`
+before posting to `/ai`. Rules are evaluated in list order; the first rule
+with a matching keyword (and satisfied `when`) wins, mirroring the order of
+checks in `fast_intent`. Keep both in sync when adding keywords.
+"""
+
+from __future__ import annotations
+
+import hashlib
+import json
+
+from models.responses import LOCAL_AUDIO_IDS
+from services import intent_service
+from services.dispatcher import HELP_TEXT
+
+RULES_FORMAT = 1
+
+ACTION_LOCAL_AUDIO = "local_audio"
+ACTION_SPEAK = "speak"
+ACTION_SERVER = "server"
+
+WHEN_ALWAYS = "always"
+WHEN_NAVIGATION_ACTIVE = "navigation_active"
+WHEN_NAVIGATION_INACTIVE = "navigation_inactive"
+
+FOLLOW_UP_NONE = "none"
+FOLLOW_UP_EXIT_NAVIGATION = "exit_navigation"
+
+
+def _rule(
+    intent: str,
+    match: str,
+    keywords,
+    action: str,
+    audio_id: str = "",
+    text: str = "",
+    when: str = WHEN_ALWAYS,
+    follow_up: str = FOLLOW_UP_NONE,
+) -> dict:
+    return {
+        "intent": intent,
+        "match": match,
+        "keywords": list(keywords),
+        "action": action,
+        "audio_id": audio_id,
+        "text": text,
+        "when": when,
+        "follow_up": follow_up,
+    }
+
+
+def build_rules() -> list[dict]:
+    exit_all = sorted(intent_service.EXIT_EXPLICIT)
+    return [
+        _rule(
+            "chat.normal",
+            "exact",
+            sorted(intent_service.GREETING_TEXTS),
+            ACTION_LOCAL_AUDIO,
+            audio_id=LOCAL_AUDIO_IDS["hello"],
+            text=intent_service.GREETING_REPLY,
+        ),
+        _rule("chat.normal", "contains", intent_service.JOKE_TEXTS, ACTION_SPEAK, text=intent_service.JOKE_REPLY),
+        _rule("chat.normal", "contains", intent_service.STORY_TEXTS, ACTION_SPEAK, text=intent_service.STORY_REPLY),
+        _rule("chat.normal", "contains", intent_service.CHAT_TEXTS, ACTION_SPEAK, text=intent_service.CHAT_REPLY),
+        _rule("system.help", "exact", sorted(intent_service.HELP_TEXTS), ACTION_SPEAK, text=HELP_TEXT),
+        _rule(
+            "navigation.exit",
+            "exact",
+            exit_all + sorted(intent_service.EXIT_SHORT),
+            ACTION_LOCAL_AUDIO,
+            audio_id=LOCAL_AUDIO_IDS["nav_exit"],
+            text="已退出导航。",
+            when=WHEN_NAVIGATION_ACTIVE,
+            follow_up=FOLLOW_UP_EXIT_NAVIGATION,
+        ),
+        _rule(
+            "navigation.exit",
+            "exact",
+            exit_all,
+            ACTION_LOCAL_AUDIO,
+            audio_id=LOCAL_AUDIO_IDS["no_navigation"],
+            text="当前没有进行中的导航。",
+            when=WHEN_NAVIGATION_INACTIVE,
+        ),
+        # 目的地需要服务端规划路线；设备先播放“正在规划”，同时异步请求 /ai
+        _rule(
+            "navigation.start",
+            "prefix",
+            intent_service.NAV_PREFIXES,
+            ACTION_SERVER,
+            audio_id=LOCAL_AUDIO_IDS["nav_starting"],
+        ),
+        _rule("weather.query", "contains", intent_service.WEATHER_KEYWORDS, ACTION_SERVER),
+        _rule("navigation.update", "contains", intent_service.NAV_UPDATE_TEXTS, ACTION_SERVER),
+        _rule(
+            "navigation.status",
+            "contains",
+            intent_service.NAV_STATUS_TEXTS,
+            ACTION_LOCAL_AUDIO,
+            audio_id=LOCAL_AUDIO_IDS["no_navigation"],
+            text="当前没有进行中的导航。",
+            when=WHEN_NAVIGATION_INACTIVE,
+        ),
+        _rule(
+            "navigation.status",
+            "contains",
+            intent_service.NAV_STATUS_TEXTS,
+            ACTION_SERVER,
+            when=WHEN_NAVIGATION_ACTIVE,
+        ),
+    ]
+
+
+def rules_payload() -> dict:
+    body = {
+        "format": RULES_FORMAT,
+        "normalize_strip": intent_service.NORMALIZE_PUNCTUATION,
+        "rules": build_rules(),
+    }
+    digest = hashlib.sha1(json.dumps(body, ensure_ascii=False, sort_keys=True).encode("utf-8")).hexdigest()
+    body["version"] = digest[:16]
+    return body
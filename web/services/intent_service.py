@@ -24,6 +24,8 @@ NAV_STATUS_TEXTS = ("还有多远", "到哪了", "快到了吗")
 JOKE_TEXTS = ("讲个笑话", "讲笑话", "说个笑话", "来个笑话", "笑话")
 STORY_TEXTS = ("讲个故事", "讲故事", "说个故事", "来个故事", "故事")
 CHAT_TEXTS = ("陪我聊天", "聊聊天", "陪我说话", "和我聊天", "安慰我", "鼓励我")
+NORMALIZE_PUNCTUATION = "，。！？!?,.、"
+GREETING_REPLY = "我在呢，请说导航、天气或者帮助。"
 
 JOKE_REPLY = "当然。路灯为什么不睡觉？因为它一闭眼，整条街就黑了。"
 STORY_REPLY = "当然。从前有颗小星星迷了路，听见脚步声后，跟着勇气回了家。"
@@ -42,7 +44,7 @@ def fast_intent(text: str, device_context: dict[str, Any] | None = None) -> Inte
             intent="chat.normal",
             confidence=1.0,
             arguments={},
-            reply="我在呢，请说导航、天气或者帮助。",
+            reply=GREETING_REPLY,
             safety_level="normal",
             source="fast",
         )
@@ -177,7 +179,7 @@ def parse_and_validate_intent(raw: str | dict[str, Any] | None) -> IntentData:
 
 
 def _normalize_text(text: str) -> str:
-    return re.sub(r"[\s，。！？!?,.、]", "", (text or "").strip())
+    return re.sub(rf"[\s{re.escape(NORMALIZE_PUNCTUATION)}]", "", (text or "").strip())
 
 
 def _parse_weather_args(text: str) -> dict:
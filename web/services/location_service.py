@@ -1,11 +1,13 @@
 import threading
 import time
+from collections import deque
 
 from clients import amap_client
-from config import DEFAULT_LOCATION, DEFAULT_WEATHER_CITY, LOCATION_TIMEOUT
+from config import DEFAULT_LOCATION, DEFAULT_WEATHER_CITY, GPS_TRACK_KEEP_POINTS, LOCATION_TIMEOUT
 from services import response_service
 
 _locations: dict[str, dict] = {}
+_tracks: dict[str, deque] = {}
 _lock = threading.Lock()
 
 
@@ -24,6 +26,38 @@ def update_location(device_id: str, latitude: float, longitude: float) -> dict:
     return dict(info)
 
 
+# 保存设备批量上传的轨迹点（按 GPS UTC 毫秒 t 升序）。设备断网补传或重启后重发时会有重复，
+# 只收比已有最后一点更新的点；收下新点时用最后一点刷新当前位置（只做一次逆地理编码）
+def record_track(device_id: str, points: list[dict]) -> dict:
+    with _lock:
+        track = _tracks.setdefault(device_id, deque(maxlen=GPS_TRACK_KEEP_POINTS))
+        last_t = track[-1]["t"] if track else -1
+        accepted = []
+        for point in sorted(points, key=lambda item: item["t"]):
+            if point["t"] > last_t:
+                accepted.append(point)
+                last_t = point["t"]
+        track.extend(accepted)
+    result = {"accepted": len(accepted), "duplicates": len(points) - len(accepted), "last_t": last_t}
+    if accepted:
+        latest = accepted[-1]
+        result["location"] = update_location(device_id, latest["latitude"], latest["longitude"])
+    return result
+
+
+def get_track(device_id: str, since: int = 0) -> list[dict]:
+    with _lock:
+        return [dict(point) for point in _tracks.get(device_id, ()) if point["t"] > since]
+
+
+def clear_tracks(device_id: str | None = None) -> None:
+    with _lock:
+        if device_id is None:
+            _tracks.clear()
+        else:
+            _tracks.pop(device_id, None)
+
+
 def get_location(device_id: str) -> dict | None:
     with _lock:
         info = _locations.get(device_id)
@@ -1,3 +1,4 @@
+import hashlib
 import threading
 import time
 
@@ -96,6 +97,7 @@ def start_navigation(device_id: str, destination: str) -> dict:
             "total_distance": nav["distance"],
             "total_duration": nav["duration"],
             "next_instruction": first_instruction,
+            "route_id": _route_id(nav),
         },
     )
 
@@ -156,6 +158,39 @@ def update_navigation(device_id: str) -> dict:
             "remaining_distance": nav["distance"],
             "total_duration": nav["duration"],
             "navigation_complete": False,
+            "route_id": _route_id(nav),
+        },
+    )
+
+
+def get_route(device_id: str) -> dict:
+    """当前路线的紧凑形式，设备端据此本地匹配 GPS 并按距离触发下一步指令。"""
+    with _lock:
+        session = _sessions.get(device_id)
+        if not session:
+            return no_navigation(device_id, "navigation.route")
+        nav = session.get("last_navigation") or {}
+        destination = session.get("destination", "")
+
+    steps = [_compact_step(step) for step in nav.get("steps", [])]
+    steps = [step for step in steps if step["polyline"]]
+    if not steps:
+        return response_service.api_response(
+            device_id=device_id,
+            intent="navigation.route",
+            response="当前路线没有可用的轨迹数据。",
+            ok=False,
+            error={"code": "route_unavailable"},
+        )
+    return response_service.none_response(
+        device_id=device_id,
+        intent="navigation.route",
+        response="",
+        extra={
+            "route_id": _route_id(nav),
+            "destination": destination,
+            "total_distance": int(nav.get("distance", 0)),
+            "steps": steps,
         },
     )
 
@@ -221,6 +256,40 @@ def _destination_candidates(device_id: str, destination: str) -> list[str]:
     return list(dict.fromkeys(candidates))
 
 
+def _route_id(nav: dict) -> str:
+    digest = hashlib.sha1()
+    for step in nav.get("steps", []):
+        digest.update(str(step.get("polyline", "")).encode())
+        digest.update(str(step.get("instruction", "")).encode())
+    return digest.hexdigest()[:16]
+
+
+def _compact_step(step: dict) -> dict:
+    # "lng,lat;lng,lat" -> 1e-6 度整数，首点为绝对值，其后为相对上一点的增量
+    polyline = []
+    previous = None
+    for pair in str(step.get("polyline", "")).split(";"):
+        try:
+            lng_text, lat_text = pair.split(",")
+            point = (round(float(lng_text) * 1e6), round(float(lat_text) * 1e6))
+        except ValueError:
+            continue
+        if previous is None:
+            polyline.extend(point)
+        else:
+            polyline.extend((point[0] - previous[0], point[1] - previous[1]))
+        previous = point
+    try:
+        distance = int(step.get("step_distance", step.get("distance", 0)))
+    except (TypeError, ValueError):
+        distance = 0
+    return {
+        "instruction": step.get("instruction", ""),
+        "distance": distance,
+        "polyline": polyline,
+    }
+
+
 def _navigation_payload(
     active: bool,
     destination: str = "",
@@ -2,8 +2,8 @@ from __future__ import annotations
 
 from uuid import uuid4
 
-from config import get_missing_keys
-from models.responses import LOCAL_AUDIO_IDS, SPEAK_LOCAL_AUDIO, SPEAK_NONE, SPEAK_TTS_TEXT
+from config import AUDIO_URL_PREFIX, get_missing_keys
+from models.responses import LOCAL_AUDIO_IDS, SPEAK_AUDIO_URL, SPEAK_LOCAL_AUDIO, SPEAK_NONE, SPEAK_TTS_TEXT
 
 
 CONFIG_LABELS = {
@@ -78,6 +78,28 @@ def local_audio_response(
     )
 
 
+def audio_url_response(
+    device_id: str,
+    intent: str,
+    response: str,
+    filename: str,
+    ok: bool = True,
+    navigation: dict | None = None,
+    extra: dict | None = None,
+) -> dict:
+    return api_response(
+        device_id=device_id,
+        intent=intent,
+        response=response,
+        ok=ok,
+        speak_mode=SPEAK_AUDIO_URL,
+        speak_text=response,
+        audio_url=f"{AUDIO_URL_PREFIX.rstrip('/')}/{filename.lstrip('/')}",
+        navigation=navigation,
+        extra=extra,
+    )
+
+
 def none_response(device_id: str, intent: str, response: str, extra: dict | None = None) -> dict:
     return api_response(
         device_id=device_id,
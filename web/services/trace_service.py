@@ -0,0 +1,60 @@
+import threading
+from collections import deque
+
+from config import TRACE_KEEP_TURNS
+
+# 单轮上报的事件数上限，设备端追踪环本身只有 64 段
+MAX_EVENTS_PER_TURN = 256
+
+_traces: dict[str, deque] = {}
+_lock = threading.Lock()
+
+
+def _clean_event(event) -> dict | None:
+    if not isinstance(event, dict):
+        return None
+    name = event.get("name")
+    ts = event.get("ts")
+    dur = event.get("dur")
+    if not isinstance(name, str) or not isinstance(ts, (int, float)) or not isinstance(dur, (int, float)):
+        return None
+    return {
+        "name": name,
+        "cat": str(event.get("cat") or "voice"),
+        "ph": "X",
+        "ts": ts,
+        "dur": dur,
+        "pid": event.get("pid", 1),
+        "tid": event.get("tid", 0),
+        "args": event.get("args") if isinstance(event.get("args"), dict) else {},
+    }
+
+
+# 保存设备上报的一轮语音交互追踪，返回收下的事件数
+def record_turn(device_id: str, data: dict) -> int:
+    events = data.get("traceEvents")
+    if not isinstance(events, list):
+        return 0
+    cleaned = [event for event in map(_clean_event, events[:MAX_EVENTS_PER_TURN]) if event]
+    if not cleaned:
+        return 0
+    with _lock:
+        turns = _traces.setdefault(device_id, deque(maxlen=TRACE_KEEP_TURNS))
+        turns.append({"turn": data.get("turn"), "events": cleaned})
+    return len(cleaned)
+
+
+# 最近 TRACE_KEEP_TURNS 轮合并为 Chrome trace-event JSON，可直接在 ui.perfetto.dev 打开
+def chrome_trace(device_id: str) -> dict:
+    with _lock:
+        turns = list(_traces.get(device_id, ()))
+    events = [dict(event) for turn in turns for event in turn["events"]]
+    return {"traceEvents": events, "displayTimeUnit": "ms"}
+
+
+def clear(device_id: str | None = None) -> None:
+    with _lock:
+        if device_id is None:
+            _traces.clear()
+        else:
+            _traces.pop(device_id, None)
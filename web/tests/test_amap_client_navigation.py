@@ -84,4 +84,4 @@ def test_walking_navigation_uses_default_origin_when_origin_missing(monkeypatch)
     assert captured["url"].endswith("/v5/direction/walking")
     assert captured["params"]["origin"] == "113.390342,22.527403"
     assert captured["params"]["destination"] == "113.390400,22.527390"
-    assert captured["params"]["show_fields"] == "navi"
+    assert captured["params"]["show_fields"] == "navi,polyline"
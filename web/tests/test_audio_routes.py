@@ -0,0 +1,46 @@
+import struct
+
+import pytest
+
+from services import response_service
+
+
+def _wav_bytes(samples: int = 160) -> bytes:
+    data = b"\x00\x00" * samples
+    header = b"RIFF" + struct.pack("<I", 36 + len(data)) + b"WAVE"
+    header += b"fmt " + struct.pack("<IHHIIHH", 16, 1, 1, 16000, 32000, 2, 16)
+    header += b"data" + struct.pack("<I", len(data))
+    return header + data
+
+
+@pytest.fixture()
+def audio_client(app, tmp_path):
+    (tmp_path / "tone_001.wav").write_bytes(_wav_bytes())
+    app.config["AUDIO_DIR"] = str(tmp_path)
+    return app.test_client()
+
+
+def test_audio_file_served_with_etag(audio_client):
+    response = audio_client.get("/audio/tone_001.wav")
+    assert response.status_code == 200
+    assert response.mimetype == "audio/wav"
+    assert response.headers.get("ETag")
+    assert response.data.startswith(b"RIFF")
+
+
+def test_audio_file_not_modified_for_matching_etag(audio_client):
+    etag = audio_client.get("/audio/tone_001.wav").headers["ETag"]
+    response = audio_client.get("/audio/tone_001.wav", headers={"If-None-Match": etag})
+    assert response.status_code == 304
+    assert response.data == b""
+
+
+def test_audio_file_missing_returns_404(audio_client):
+    assert audio_client.get("/audio/missing.wav").status_code == 404
+
+
+def test_audio_url_response_points_at_audio_route():
+    payload = response_service.audio_url_response("guide-cane-001", "chat.normal", "你好", "tone_001.wav")
+    assert payload["speak"]["mode"] == "audio_url"
+    assert payload["speak"]["audio_url"] == "/audio/tone_001.wav"
+    assert payload["speak"]["text"] == "你好"
@@ -0,0 +1,57 @@
+import pytest
+
+from services import trace_service
+
+
+@pytest.fixture(autouse=True)
+def clear_traces():
+    trace_service.clear()
+    yield
+    trace_service.clear()
+
+
+def _turn(turn: int) -> dict:
+    base = turn * 10_000_000
+    return {
+        "turn": turn,
+        "traceEvents": [
+            {"name": "asr", "cat": "voice", "ph": "X", "ts": base + 100, "dur": 850_000, "pid": 1, "tid": 1,
+             "args": {"turn": turn}},
+            {"name": "turn", "cat": "voice", "ph": "X", "ts": base, "dur": 4_200_000, "pid": 1, "tid": 1,
+             "args": {"turn": turn}},
+        ],
+    }
+
+
+def test_trace_upload_then_export_chrome_format(client):
+    headers = {"X-Device-ID": "guide-cane-001"}
+    response = client.post("/v1/device/trace", json=_turn(1), headers=headers)
+    assert response.status_code == 200
+    assert response.get_json()["events"] == 2
+
+    client.post("/v1/device/trace", json=_turn(2), headers=headers)
+    trace = client.get("/v1/device/trace?device_id=guide-cane-001").get_json()
+    assert trace["displayTimeUnit"] == "ms"
+    assert [event["args"]["turn"] for event in trace["traceEvents"]] == [1, 1, 2, 2]
+    assert all(event["ph"] == "X" for event in trace["traceEvents"])
+
+    other = client.get("/v1/device/trace", headers={"X-Device-ID": "guide-cane-002"}).get_json()
+    assert other["traceEvents"] == []
+
+
+def test_trace_upload_rejects_malformed_events(client):
+    response = client.post(
+        "/v1/device/trace",
+        json={"turn": 3, "traceEvents": [{"name": "asr"}, "bad"]},
+        headers={"X-Device-ID": "guide-cane-001"},
+    )
+    assert response.status_code == 400
+    assert response.get_json()["error"]["code"] == "invalid_trace"
+
+
+def test_trace_keeps_recent_turns(client, monkeypatch):
+    monkeypatch.setattr(trace_service, "TRACE_KEEP_TURNS", 2)
+    for turn in range(1, 5):
+        client.post("/v1/device/trace", json=_turn(turn), headers={"X-Device-ID": "guide-cane-001"})
+    trace = client.get("/v1/device/trace?device_id=guide-cane-001").get_json()
+    assert sorted({event["args"]["turn"] for event in trace["traceEvents"]}) == [3, 4]
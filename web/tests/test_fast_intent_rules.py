@@ -0,0 +1,103 @@
+import json
+import os
+import re
+
+import pytest
+
+from services import fast_intent_rules
+from services.intent_service import _normalize_text, fast_intent
+
+
+def _device_match(text: str, navigation_active: bool):
+    """Reference of the firmware matcher: first rule in list order wins."""
+    payload = fast_intent_rules.rules_payload()
+    normalized = _normalize_text(text)
+    for rule in payload["rules"]:
+        if rule["when"] == "navigation_active" and not navigation_active:
+            continue
+        if rule["when"] == "navigation_inactive" and navigation_active:
+            continue
+        for keyword in rule["keywords"]:
+            if rule["match"] == "exact" and normalized == keyword:
+                return rule, ""
+            if rule["match"] == "prefix" and normalized.startswith(keyword) and len(normalized) > len(keyword):
+                return rule, normalized[len(keyword) :]
+            if rule["match"] == "contains" and keyword in normalized:
+                return rule, ""
+    return None, ""
+
+
+UTTERANCES = [
+    "你好",
+    "在吗？",
+    "给我讲个笑话听听。",
+    "讲个故事吧",
+    "陪我聊天",
+    "帮助",
+    "停止导航",
+    "取消",
+    "算了",
+    "导航到图书馆",
+    "帮我导航到南昌大学第一食堂",
+    "去二食堂",
+    "今天天气怎么样",
+    "明天会下雨吗",
+    "下一步怎么走",
+    "还有多远",
+    "到哪了",
+    "今天星期几",
+    "",
+]
+
+
+@pytest.mark.parametrize("navigation_active", [False, True])
+@pytest.mark.parametrize("text", UTTERANCES)
+def test_device_rules_agree_with_server_fast_intent(text, navigation_active):
+    expected = fast_intent(text, {"navigation_active": navigation_active})
+    rule, argument = _device_match(text, navigation_active)
+    if expected is None or expected.intent == "unknown":
+        assert rule is None
+        return
+    assert rule is not None
+    assert rule["intent"] == expected.intent
+    if expected.intent == "navigation.start":
+        assert argument == expected.arguments["destination"]
+    if rule["action"] == "speak":
+        assert rule["text"]
+
+
+def test_local_answers_match_server_audio(client):
+    rule, _ = _device_match("你好", False)
+    assert rule["action"] == "local_audio"
+    server = client.post("/ai", json={"message": "你好"}).get_json()
+    assert rule["audio_id"] == server["speak"]["audio_id"]
+
+    rule, _ = _device_match("还有多远", False)
+    server = client.post("/ai", json={"message": "还有多远"}, headers={"X-Device-ID": "fast-rules"}).get_json()
+    assert rule["audio_id"] == server["speak"]["audio_id"]
+
+
+def test_rules_endpoint_supports_etag(client):
+    response = client.get("/v1/fast_intent_rules")
+    assert response.status_code == 200
+    data = response.get_json()
+    assert data["ok"] is True
+    assert data["format"] == fast_intent_rules.RULES_FORMAT
+    assert data["rules"][0]["audio_id"] == "hello_001"
+    etag = response.headers["ETag"]
+    assert etag.strip('"') == data["version"]
+
+    cached = client.get("/v1/fast_intent_rules", headers={"If-None-Match": etag})
+    assert cached.status_code == 304
+
+
+def test_firmware_builtin_rules_are_current():
+    source = os.path.join(
+        os.path.dirname(__file__), "..", "..", "硬件端", "src", "services", "fast_intent.cpp"
+    )
+    if not os.path.exists(source):
+        pytest.skip("firmware tree not present")
+    with open(source, encoding="utf-8") as handle:
+        match = re.search(r'R"JSON\((.*?)\)JSON"', handle.read(), re.S)
+    assert match is not None
+    assert json.loads(match.group(1)) == fast_intent_rules.rules_payload()
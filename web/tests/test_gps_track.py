@@ -0,0 +1,127 @@
+import base64
+
+import pytest
+
+from clients import amap_client
+from services import location_service
+from utils import track_codec
+
+# 与硬件端 tools/gps_track_check.cpp 中 TrackEncoder 的输出逐字节一致
+DEVICE_VECTOR = bytes.fromhex("0180d4f28dc232a8ff8e26c4f0ff6e2c0a09d00f180d2e0a0ad00f0000000000")
+VECTOR_POINTS = [
+    {"t": 1735732800000, "latitude": 39.968724, "longitude": 116.390946, "speed_kmh": 4.3, "hdop": 0.9, "satellites": 9},
+    {"t": 1735732801000, "latitude": 39.968736, "longitude": 116.390939, "speed_kmh": 4.5, "hdop": 0.9, "satellites": 10},
+    {"t": 1735732802000, "latitude": 39.968736, "longitude": 116.390939, "speed_kmh": None, "hdop": None, "satellites": 0},
+]
+
+
+@pytest.fixture(autouse=True)
+def clear_tracks(monkeypatch):
+    monkeypatch.setattr(amap_client, "reverse_geocode", lambda longitude, latitude: {"city": "北京市", "district": "海淀区"})
+    location_service.clear_tracks()
+    yield
+    location_service.clear_tracks()
+
+
+def _walk(start_t: int, count: int) -> list[dict]:
+    return [
+        {
+            "t": start_t + i * 1000,
+            "latitude": 28.680000 + i * 0.000012,
+            "longitude": 115.890000 - i * 0.000007,
+            "speed_kmh": 4.2,
+            "hdop": 1.1,
+            "satellites": 8,
+        }
+        for i in range(count)
+    ]
+
+
+def _post(client, points: list[dict], **extra):
+    body = {"format": 1, "count": len(points), "track": base64.b64encode(track_codec.encode_track(points)).decode()}
+    body.update(extra)
+    return client.post("/v1/gps/track", json=body, headers={"X-Device-ID": "guide-cane-001"})
+
+
+def test_decode_matches_device_encoder():
+    points = track_codec.decode_track(DEVICE_VECTOR)
+    assert len(points) == 3
+    for got, want in zip(points, VECTOR_POINTS):
+        assert got["t"] == want["t"]
+        assert got["latitude"] == pytest.approx(want["latitude"], abs=1e-9)
+        assert got["longitude"] == pytest.approx(want["longitude"], abs=1e-9)
+        assert got["speed_kmh"] == (pytest.approx(want["speed_kmh"]) if want["speed_kmh"] is not None else None)
+        assert got["hdop"] == (pytest.approx(want["hdop"]) if want["hdop"] is not None else None)
+        assert got["satellites"] == want["satellites"]
+    assert track_codec.encode_track(VECTOR_POINTS) == DEVICE_VECTOR
+
+
+def test_decode_rejects_corrupt_tracks():
+    for bad in (b"", b"\x02\x00", DEVICE_VECTOR[:-3], b"\x01\xff\xff", "not base64!"):
+        with pytest.raises(track_codec.TrackDecodeError):
+            track_codec.decode_track(bad)
+
+
+def test_track_upload_updates_location_and_stores_points(client):
+    points = _walk(1735732800000, 120)
+    response = _post(client, points)
+    assert response.status_code == 200
+    data = response.get_json()
+    assert data["accepted"] == 120 and data["duplicates"] == 0
+    assert data["last_t"] == points[-1]["t"]
+
+    location = location_service.get_location("guide-cane-001")
+    assert location["latitude"] == pytest.approx(points[-1]["latitude"], abs=1e-6)
+    assert location["city"] == "北京市"
+
+    stored = client.get("/v1/gps/track?device_id=guide-cane-001&since=%d" % points[99]["t"]).get_json()["points"]
+    assert [point["t"] for point in stored] == [point["t"] for point in points[100:]]
+
+
+def test_replayed_batches_are_deduplicated(client):
+    points = _walk(1735732800000, 30)
+    _post(client, points[:20])
+    # 设备重启后溢出文件从头补传：前 20 个点重复，只收后 10 个
+    response = _post(client, points)
+    data = response.get_json()
+    assert data["accepted"] == 10 and data["duplicates"] == 20
+    assert len(location_service.get_track("guide-cane-001")) == 30
+
+
+def test_track_upload_accepts_msgpack_bin(client):
+    import msgpack
+
+    body = msgpack.packb({"format": 1, "count": 3, "track": DEVICE_VECTOR}, use_bin_type=True)
+    response = client.post(
+        "/v1/gps/track",
+        data=body,
+        headers={"Content-Type": "application/msgpack", "X-Device-ID": "guide-cane-002"},
+    )
+    assert response.status_code == 200
+    assert response.get_json()["accepted"] == 3
+
+
+def test_track_upload_rejects_bad_requests(client):
+    response = _post(client, _walk(1735732800000, 5), count=6)
+    assert response.status_code == 400
+    assert response.get_json()["error"]["code"] == "track_count_mismatch"
+
+    response = _post(client, _walk(1735732800000, 5), format=2)
+    assert response.get_json()["error"]["code"] == "unsupported_track_format"
+
+    response = client.post("/v1/gps/track", json={"track": "AQ=="}, headers={"X-Device-ID": "guide-cane-001"})
+    assert response.status_code == 200 and response.get_json()["accepted"] == 0
+
+    response = client.post("/v1/gps/track", json={"track": 12}, headers={"X-Device-ID": "guide-cane-001"})
+    assert response.status_code == 400
+    assert response.get_json()["error"]["code"] == "invalid_track"
+
+
+def test_batched_upload_is_smaller_than_single_fix_requests():
+    points = _walk(1735732800000, 120)
+    batched = len(base64.b64encode(track_codec.encode_track(points)))
+    single = sum(
+        len('{"device_id":"guide-cane-001","latitude":%.6f,"longitude":%.6f}' % (p["latitude"], p["longitude"]))
+        for p in points
+    )
+    assert batched * 5 < single
@@ -0,0 +1,76 @@
+import pytest
+
+from services import navigation_service
+
+DEVICE_ID = "test-device-route"
+DESTINATION = "图书馆"
+STEPS = [
+    {
+        "instruction": "向南步行100米右转",
+        "step_distance": "100",
+        "polyline": "113.390342,22.527403;113.390342,22.526503",
+    },
+    {
+        "instruction": "向西步行50米到达目的地",
+        "step_distance": "50",
+        "polyline": "113.390342,22.526503;113.389855,22.526503",
+    },
+]
+
+
+def _start_session(monkeypatch, steps=STEPS):
+    monkeypatch.setattr(navigation_service.response_service, "config_error", lambda *args: None)
+    monkeypatch.setattr(navigation_service.location_service, "get_origin", lambda device_id: "113.390342,22.527403")
+    monkeypatch.setattr(navigation_service.location_service, "get_city", lambda device_id: "")
+    monkeypatch.setattr(navigation_service.amap_client, "geocode_destination", lambda destination: "113.389855,22.526503")
+    monkeypatch.setattr(
+        navigation_service.amap_client,
+        "walking_navigation",
+        lambda origin, destination: {
+            "distance": 150,
+            "duration": 120,
+            "steps": steps,
+            "first_instruction": steps[0]["instruction"],
+        },
+    )
+    return navigation_service.start_navigation(DEVICE_ID, DESTINATION)
+
+
+@pytest.fixture(autouse=True)
+def clear_navigation_sessions():
+    with navigation_service._lock:
+        navigation_service._sessions.clear()
+    yield
+    with navigation_service._lock:
+        navigation_service._sessions.clear()
+
+
+def test_route_is_delta_encoded_micro_degrees(monkeypatch):
+    started = _start_session(monkeypatch)
+
+    route = navigation_service.get_route(DEVICE_ID)
+
+    assert route["ok"] is True
+    assert route["route_id"] == started["route_id"]
+    assert route["destination"] == DESTINATION
+    assert route["total_distance"] == 150
+    assert [step["instruction"] for step in route["steps"]] == [step["instruction"] for step in STEPS]
+    assert route["steps"][0]["distance"] == 100
+    assert route["steps"][0]["polyline"] == [113390342, 22527403, 0, -900]
+    assert route["steps"][1]["polyline"] == [113390342, 22526503, -487, 0]
+
+
+def test_route_without_polyline_is_unavailable(monkeypatch):
+    _start_session(monkeypatch, steps=[{"instruction": "向南步行1米到达目的地"}])
+
+    route = navigation_service.get_route(DEVICE_ID)
+
+    assert route["ok"] is False
+    assert route["error"]["code"] == "route_unavailable"
+
+
+def test_route_endpoint_returns_404_without_session(client):
+    response = client.post("/v1/navigation/route", json={}, headers={"X-Device-ID": "guide-cane-route"})
+
+    assert response.status_code == 404
+    assert response.get_json()["intent"] == "navigation.route"
@@ -0,0 +1,56 @@
+import msgpack
+
+from utils import wire_codec
+
+MSGPACK_HEADERS = {
+    "Content-Type": wire_codec.MSGPACK_MIMETYPE,
+    "Accept": wire_codec.MSGPACK_MIMETYPE,
+    "X-Device-ID": "guide-cane-001",
+}
+
+
+def test_ai_accepts_and_returns_msgpack(client):
+    body = msgpack.packb({"device_id": "guide-cane-001", "message": "你好"})
+    response = client.post("/ai", data=body, headers=MSGPACK_HEADERS)
+    assert response.status_code == 200
+    assert response.mimetype == wire_codec.MSGPACK_MIMETYPE
+    data = msgpack.unpackb(response.data, raw=False)
+    assert data["speak"]["mode"] == "local_audio"
+    assert data["speak"]["audio_id"] == "hello_001"
+    assert data["navigation"]["remaining_distance"] is None
+
+
+def test_msgpack_response_starts_with_map_marker(client):
+    body = msgpack.packb({"message": "还有多远"})
+    response = client.post("/ai", data=body, headers=MSGPACK_HEADERS)
+    first = response.data[0]
+    assert 0x80 <= first <= 0x8F or first in (0xDE, 0xDF)
+
+
+def test_json_request_without_accept_still_gets_json(client):
+    response = client.post("/ai", json={"message": "你好"}, headers={"Accept": "*/*"})
+    assert response.status_code == 200
+    assert response.is_json
+    assert response.get_json()["speak"]["audio_id"] == "hello_001"
+
+
+def test_gps_msgpack_body_is_decoded(client, monkeypatch):
+    from services import location_service
+
+    captured = {}
+
+    def fake_update_location(device_id, latitude, longitude):
+        captured.update(device_id=device_id, latitude=latitude, longitude=longitude)
+        return {"city": "南昌市", "district": "", "formatted_address": ""}
+
+    monkeypatch.setattr(location_service, "update_location", fake_update_location)
+    body = msgpack.packb({"latitude": 28.68, "longitude": 115.89})
+    response = client.post("/gps", data=body, headers=MSGPACK_HEADERS)
+    assert response.status_code == 200
+    assert captured == {"device_id": "guide-cane-001", "latitude": 28.68, "longitude": 115.89}
+
+
+def test_malformed_msgpack_body_is_treated_as_empty(client):
+    response = client.post("/ai", data=b"\xc1\xc1", headers=MSGPACK_HEADERS)
+    assert response.status_code == 400
+    assert msgpack.unpackb(response.data, raw=False)["error"]["code"] == "missing_message"
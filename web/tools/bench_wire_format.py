@@ -0,0 +1,141 @@
+#!/usr/bin/env python3
+"""Compare JSON and MessagePack encodings of typical device responses.
+
+Usage:
+  python tools/bench_wire_format.py
+  python tools/bench_wire_format.py --dump-fixtures /tmp/wire_fixtures
+
+Prints encoded size, encode/decode time and peak traced memory per decode
+for a navigation update and a weather reply. --dump-fixtures writes each
+payload as .json and .msgpack so the device-side host benchmark
+(硬件端/tools/wire_format_bench.cpp) can parse the exact same bytes.
+"""
+
+from __future__ import annotations
+
+import argparse
+import json
+import os
+import sys
+import timeit
+import tracemalloc
+from pathlib import Path
+
+ROOT = Path(__file__).resolve().parents[1]
+if str(ROOT) not in sys.path:
+    sys.path.insert(0, str(ROOT))
+
+from services import response_service  # noqa: E402
+from utils import wire_codec  # noqa: E402
+
+
+def navigation_fixture() -> dict:
+    instruction = "沿学府大道向东步行120米，前方路口右转"
+    return response_service.api_response(
+        device_id="guide-cane-001",
+        intent="navigation.update",
+        response=instruction,
+        navigation={
+            "active": True,
+            "destination": "南昌大学图书馆",
+            "remaining_distance": 860,
+            "total_duration": 690,
+            "next_instruction": instruction,
+        },
+        extra={
+            "next_instruction": instruction,
+            "remaining_distance": 860,
+            "total_duration": 690,
+            "navigation_complete": False,
+        },
+    )
+
+
+def weather_fixture() -> dict:
+    daily = [
+        {
+            "fxDate": f"2026-10-{19 + offset:02d}",
+            "tempMax": str(26 - offset),
+            "tempMin": str(17 - offset),
+            "textDay": "多云",
+            "textNight": "晴",
+            "windDirDay": "东北风",
+            "windScaleDay": "1-3",
+            "humidity": "68",
+            "precip": "0.0",
+            "uvIndex": "4",
+        }
+        for offset in range(3)
+    ]
+    return response_service.api_response(
+        device_id="guide-cane-001",
+        intent="weather.query",
+        response="南昌市今天多云，17到26度，东北风1-3级。",
+        extra={"city": "南昌市", "date": "today", "daily": daily},
+    )
+
+
+FIXTURES = {"navigation": navigation_fixture, "weather": weather_fixture}
+
+
+def encode_json(payload: dict) -> bytes:
+    return json.dumps(payload, ensure_ascii=False, separators=(",", ":")).encode("utf-8")
+
+
+def decode_json(raw: bytes) -> dict:
+    return json.loads(raw)
+
+
+def peak_decode_bytes(decode, raw: bytes) -> int:
+    tracemalloc.start()
+    tracemalloc.reset_peak()
+    decode(raw)
+    _, peak = tracemalloc.get_traced_memory()
+    tracemalloc.stop()
+    return peak
+
+
+def bench(name: str, payload: dict, number: int) -> None:
+    codecs = (
+        ("json", encode_json, decode_json),
+        ("msgpack", wire_codec.encode_msgpack, wire_codec.decode_msgpack),
+    )
+    for codec_name, encode, decode in codecs:
+        raw = encode(payload)
+        encode_us = timeit.timeit(lambda: encode(payload), number=number) / number * 1e6
+        decode_us = timeit.timeit(lambda: decode(raw), number=number) / number * 1e6
+        peak = peak_decode_bytes(decode, raw)
+        print(
+            f"{name:<11} {codec_name:<8} bytes={len(raw):<5} "
+            f"encode={encode_us:7.2f}us decode={decode_us:7.2f}us "
+            f"decode_peak={peak}B"
+        )
+
+
+def dump_fixtures(directory: str) -> None:
+    os.makedirs(directory, exist_ok=True)
+    for name, factory in FIXTURES.items():
+        payload = factory()
+        payload["request_id"] = "00000000-0000-0000-0000-000000000000"
+        Path(directory, f"{name}.json").write_bytes(encode_json(payload))
+        Path(directory, f"{name}.msgpack").write_bytes(wire_codec.encode_msgpack(payload))
+    print(f"fixtures written to {directory}")
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--number", type=int, default=20000, help="iterations per timing")
+    parser.add_argument("--dump-fixtures", metavar="DIR", help="write .json/.msgpack fixtures and exit")
+    args = parser.parse_args()
+
+    if args.dump_fixtures:
+        dump_fixtures(args.dump_fixtures)
+        return 0
+
+    for name, factory in FIXTURES.items():
+        bench(name, factory(), args.number)
+    return 0
+
+
+if __name__ == "__main__":
+    raise SystemExit(main())
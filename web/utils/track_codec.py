@@ -0,0 +1,117 @@
+import base64
+import binascii
+
+# 设备端 GPS 轨迹批量编码（硬件端 src/utils/gps_track.h，format 1）：
+# 首字节格式号；首点 uvarint(utc_ms) svarint(lat_e6) svarint(lng_e6)，其余点为相对上一点的 svarint 增量；
+# 每点再跟 uvarint(速度 0.1 km/h + 1) uvarint(HDOP×10 + 1) uvarint(卫星数)，0 表示未知。
+TRACK_FORMAT = 1
+
+
+class TrackDecodeError(ValueError):
+    pass
+
+
+def _uvarint(data: bytes, pos: int) -> tuple[int, int]:
+    value = 0
+    shift = 0
+    while True:
+        if pos >= len(data):
+            raise TrackDecodeError("truncated varint")
+        byte = data[pos]
+        pos += 1
+        value |= (byte & 0x7F) << shift
+        if not byte & 0x80:
+            return value, pos
+        shift += 7
+        if shift > 63:
+            raise TrackDecodeError("varint too long")
+
+
+def _svarint(data: bytes, pos: int) -> tuple[int, int]:
+    value, pos = _uvarint(data, pos)
+    return (value >> 1) ^ -(value & 1), pos
+
+
+def _to_bytes(track) -> bytes:
+    # MessagePack 可以直接带 bin，JSON 里是 base64 文本
+    if isinstance(track, (bytes, bytearray)):
+        return bytes(track)
+    if isinstance(track, str):
+        try:
+            return base64.b64decode(track, validate=True)
+        except (binascii.Error, ValueError) as exc:
+            raise TrackDecodeError("invalid base64") from exc
+    raise TrackDecodeError("track must be base64 text or bytes")
+
+
+def decode_track(track) -> list[dict]:
+    data = _to_bytes(track)
+    if not data:
+        raise TrackDecodeError("empty track")
+    if data[0] != TRACK_FORMAT:
+        raise TrackDecodeError(f"unsupported format {data[0]}")
+
+    points = []
+    pos = 1
+    t = lat = lng = 0
+    while pos < len(data):
+        if not points:
+            t, pos = _uvarint(data, pos)
+            lat, pos = _svarint(data, pos)
+            lng, pos = _svarint(data, pos)
+        else:
+            dt, pos = _svarint(data, pos)
+            dlat, pos = _svarint(data, pos)
+            dlng, pos = _svarint(data, pos)
+            t, lat, lng = t + dt, lat + dlat, lng + dlng
+        speed, pos = _uvarint(data, pos)
+        hdop, pos = _uvarint(data, pos)
+        satellites, pos = _uvarint(data, pos)
+        if abs(lat) > 90_000_000 or abs(lng) > 180_000_000:
+            raise TrackDecodeError("coordinate out of range")
+        points.append(
+            {
+                "t": t,
+                "latitude": lat / 1e6,
+                "longitude": lng / 1e6,
+                "speed_kmh": (speed - 1) / 10 if speed else None,
+                "hdop": (hdop - 1) / 10 if hdop else None,
+                "satellites": satellites,
+            }
+        )
+    return points
+
+
+def encode_track(points: list[dict]) -> bytes:
+    """与设备端相同的编码，供测试和工具生成请求体。"""
+    out = bytearray([TRACK_FORMAT])
+
+    def uvarint(value: int) -> None:
+        while value >= 0x80:
+            out.append((value & 0x7F) | 0x80)
+            value >>= 7
+        out.append(value)
+
+    def svarint(value: int) -> None:
+        uvarint((value << 1) ^ (value >> 63))
+
+    last = None
+    for point in points:
+        t = int(point["t"])
+        lat = round(point["latitude"] * 1e6)
+        lng = round(point["longitude"] * 1e6)
+        if last is None:
+            uvarint(t)
+            svarint(lat)
+            svarint(lng)
+        else:
+            svarint(t - last[0])
+            svarint(lat - last[1])
+            svarint(lng - last[2])
+        speed = point.get("speed_kmh")
+        hdop = point.get("hdop")
+        uvarint(0 if speed is None else round(speed * 10) + 1)
+        uvarint(0 if hdop is None else round(hdop * 10) + 1)
+        uvarint(int(point.get("satellites") or 0))
+        last = (t, lat, lng)
+    return bytes(out)
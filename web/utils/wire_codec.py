@@ -0,0 +1,40 @@
+import msgpack
+from flask import Request, Response, jsonify, request
+
+from utils.validators import require_json_dict
+
+MSGPACK_MIMETYPE = "application/msgpack"
+MSGPACK_MIMETYPES = (MSGPACK_MIMETYPE, "application/x-msgpack")
+
+
+def is_msgpack_request(req: Request) -> bool:
+    return req.mimetype in MSGPACK_MIMETYPES
+
+
+def wants_msgpack(req: Request) -> bool:
+    # 只认显式声明，`*/*` 仍返回 JSON，避免浏览器和旧设备收到二进制
+    return any(mimetype in MSGPACK_MIMETYPES and quality > 0 for mimetype, quality in req.accept_mimetypes)
+
+
+def encode_msgpack(payload: dict) -> bytes:
+    return msgpack.packb(payload, use_bin_type=True)
+
+
+def decode_msgpack(raw: bytes) -> dict:
+    try:
+        data = msgpack.unpackb(raw, raw=False, strict_map_key=False)
+    except (ValueError, msgpack.ExtraData, msgpack.FormatError, msgpack.StackError):
+        return {}
+    return data if isinstance(data, dict) else {}
+
+
+def read_body(req: Request) -> dict:
+    if is_msgpack_request(req):
+        return decode_msgpack(req.get_data(cache=True))
+    return require_json_dict(req)
+
+
+def respond(payload: dict, status: int = 200):
+    if wants_msgpack(request):
+        return Response(encode_msgpack(payload), status=status, mimetype=MSGPACK_MIMETYPE)
+    return jsonify(payload), status
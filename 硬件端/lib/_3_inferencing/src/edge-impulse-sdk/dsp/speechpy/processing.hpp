@@ -384,6 +384,67 @@ namespace processing {
         return numframes;
     }
 
+    /**
+     * Row of the input that lands at (possibly negative) position `pos` after
+     * numpy::pad_1d_symmetric, i.e. reflection with the edge row repeated.
+     */
+    static inline size_t cmvnw_symmetric_row(int32_t pos, size_t rows)
+    {
+        const int32_t period = static_cast<int32_t>(rows * 2);
+        int32_t m = pos % period;
+        if (m < 0) {
+            m += period;
+        }
+        return m < static_cast<int32_t>(rows) ? static_cast<size_t>(m) : static_cast<size_t>(period - 1 - m);
+    }
+
+    /**
+     * Column sums (and optionally sums of squares) over the padded rows
+     * [first, first + win_size).
+     */
+    static void cmvnw_window_sums(matrix_t *features_matrix, int32_t first, uint16_t win_size,
+        float *sum, float *sum_sq)
+    {
+        const size_t cols = features_matrix->cols;
+        for (size_t col = 0; col < cols; col++) {
+            sum[col] = 0.0f;
+            if (sum_sq) {
+                sum_sq[col] = 0.0f;
+            }
+        }
+
+        for (int32_t pos = first; pos < first + win_size; pos++) {
+            const float *row = features_matrix->buffer +
+                (cmvnw_symmetric_row(pos, features_matrix->rows) * cols);
+            for (size_t col = 0; col < cols; col++) {
+                sum[col] += row[col];
+                if (sum_sq) {
+                    sum_sq[col] += row[col] * row[col];
+                }
+            }
+        }
+    }
+
+    /**
+     * Move the window so it starts at `first`: drop padded row first - 1 and
+     * add padded row first + win_size - 1.
+     */
+    static void cmvnw_slide(matrix_t *features_matrix, int32_t first, uint16_t win_size,
+        float *sum, float *sum_sq)
+    {
+        const size_t cols = features_matrix->cols;
+        const float *out = features_matrix->buffer +
+            (cmvnw_symmetric_row(first - 1, features_matrix->rows) * cols);
+        const float *in = features_matrix->buffer +
+            (cmvnw_symmetric_row(first + win_size - 1, features_matrix->rows) * cols);
+        for (size_t col = 0; col < cols; col++) {
+            sum[col] += in[col] - out[col];
+            if (sum_sq) {
+                sum_sq[col] += (in[col] * in[col]) - (out[col] * out[col]);
+            }
+        }
+    }
+
     /**
      * This function performs local cepstral mean and
      * variance normalization on a sliding window. The code assumes that
@@ -404,80 +465,67 @@ namespace processing {
             return EIDSP_OK;
         }
 
-        uint16_t pad_size = (win_size - 1) / 2;
-
-        int ret;
-        float *features_buffer_ptr;
-
-        // mean & variance normalization
-        EI_DSP_MATRIX(vec_pad, features_matrix->rows + (pad_size * 2), features_matrix->cols);
-        if (!vec_pad.buffer) {
-            EIDSP_ERR(EIDSP_OUT_OF_MEM);
+        if (features_matrix->rows == 0) {
+            EIDSP_ERR(EIDSP_INPUT_MATRIX_EMPTY);
         }
 
-        ret = numpy::pad_1d_symmetric(features_matrix, &vec_pad, pad_size, pad_size);
-        if (ret != EIDSP_OK) {
-            EIDSP_ERR(ret);
-        }
+        const size_t rows = features_matrix->rows;
+        const size_t cols = features_matrix->cols;
+        const int32_t first = -static_cast<int32_t>((win_size - 1) / 2);
+        const float inv_win = 1.0f / static_cast<float>(win_size);
 
-        EI_DSP_MATRIX(mean_matrix, vec_pad.cols, 1);
-        if (!mean_matrix.buffer) {
+        // One scratch buffer: per-row statistics, plus two rows of running sums.
+        // The windows slide over the symmetric padding without materializing it,
+        // so each row costs O(cols) instead of O(win_size * cols). The sums are
+        // rebuilt every win_size rows to keep float drift bounded (amortized O(cols)).
+        EI_DSP_MATRIX(scratch, rows + 2, cols);
+        if (!scratch.buffer) {
             EIDSP_ERR(EIDSP_OUT_OF_MEM);
         }
+        float *stats = scratch.buffer;
+        float *sum = scratch.buffer + (rows * cols);
+        float *sum_sq = sum + cols;
 
-        EI_DSP_MATRIX(window_variance, vec_pad.cols, 1);
-        if (!window_variance.buffer) {
-            return EIDSP_OUT_OF_MEM;
-        }
-
-        for (size_t ix = 0; ix < features_matrix->rows; ix++) {
-            // create a slice on the vec_pad
-            EI_DSP_MATRIX_B(window, win_size, vec_pad.cols, vec_pad.buffer + (ix * vec_pad.cols));
-            if (!window.buffer) {
-                EIDSP_ERR(EIDSP_OUT_OF_MEM);
+        // pass 1: local mean of the original features
+        for (size_t ix = 0; ix < rows; ix++) {
+            if (ix % win_size == 0) {
+                cmvnw_window_sums(features_matrix, first + static_cast<int32_t>(ix), win_size, sum, nullptr);
             }
-
-            ret = numpy::mean_axis0(&window, &mean_matrix);
-            if (ret != EIDSP_OK) {
-                EIDSP_ERR(ret);
+            else {
+                cmvnw_slide(features_matrix, first + static_cast<int32_t>(ix), win_size, sum, nullptr);
             }
-
-            // subtract the mean for the features
-            for (size_t fm_col = 0; fm_col < features_matrix->cols; fm_col++) {
-                features_matrix->buffer[(ix * features_matrix->cols) + fm_col] =
-                    features_matrix->buffer[(ix * features_matrix->cols) + fm_col] - mean_matrix.buffer[fm_col];
+            for (size_t col = 0; col < cols; col++) {
+                stats[(ix * cols) + col] = sum[col] * inv_win;
             }
         }
 
-        ret = numpy::pad_1d_symmetric(features_matrix, &vec_pad, pad_size, pad_size);
-        if (ret != EIDSP_OK) {
-            EIDSP_ERR(ret);
+        for (size_t ix = 0; ix < rows * cols; ix++) {
+            features_matrix->buffer[ix] -= stats[ix];
         }
 
-        for (size_t ix = 0; ix < features_matrix->rows; ix++) {
-            // create a slice on the vec_pad
-            EI_DSP_MATRIX_B(window, win_size, vec_pad.cols, vec_pad.buffer + (ix * vec_pad.cols));
-            if (!window.buffer) {
-                EIDSP_ERR(EIDSP_OUT_OF_MEM);
-            }
-
-            if (variance_normalization == true) {
-                ret = numpy::std_axis0(&window, &window_variance);
-                if (ret != EIDSP_OK) {
-                    EIDSP_ERR(ret);
+        // pass 2: local standard deviation of the mean-subtracted features
+        if (variance_normalization == true) {
+            for (size_t ix = 0; ix < rows; ix++) {
+                if (ix % win_size == 0) {
+                    cmvnw_window_sums(features_matrix, first + static_cast<int32_t>(ix), win_size, sum, sum_sq);
                 }
-
-                features_buffer_ptr = &features_matrix->buffer[ix * vec_pad.cols];
-                for (size_t col = 0; col < vec_pad.cols; col++) {
-                    *(features_buffer_ptr) = (*(features_buffer_ptr)) /
-                                             (window_variance.buffer[col] + 1e-10);
-                    features_buffer_ptr++;
+                else {
+                    cmvnw_slide(features_matrix, first + static_cast<int32_t>(ix), win_size, sum, sum_sq);
+                }
+                for (size_t col = 0; col < cols; col++) {
+                    float mean = sum[col] * inv_win;
+                    float variance = (sum_sq[col] * inv_win) - (mean * mean);
+                    stats[(ix * cols) + col] = sqrt(variance > 0.0f ? variance : 0.0f);
                 }
             }
+
+            for (size_t ix = 0; ix < rows * cols; ix++) {
+                features_matrix->buffer[ix] = features_matrix->buffer[ix] / (stats[ix] + 1e-10);
+            }
         }
 
         if (scale) {
-            ret = numpy::normalize(features_matrix);
+            int ret = numpy::normalize(features_matrix);
             if (ret != EIDSP_OK) {
                 EIDSP_ERR(ret);
             }
@@ -36,6 +36,12 @@
 #include "edge-impulse-sdk/tensorflow/lite/c/common.h"
 #include "edge-impulse-sdk/tensorflow/lite/micro/micro_mutable_op_resolver.h"
 #include "edge-impulse-sdk/porting/ei_classifier_porting.h"
+#include "tflite-model/tflite_learn_3_compiled.h"
+#include "edge-impulse-sdk/tensorflow/lite/kernels/internal/common.h"
+#include "edge-impulse-sdk/tensorflow/lite/kernels/internal/quantization_util.h"
+#if EI_COMPILED_MODEL_PROFILING
+#include "edge-impulse-sdk/classifier/ei_classifier_config.h"
+#endif
 
 #if EI_CLASSIFIER_PRINT_STATE
 #if defined(__cplusplus) && EI_C_LINKAGE == 1
@@ -437,6 +443,11 @@ static void init_tflite_eval_tensor(int i, TfLiteEvalTensor *tensor) {
 #endif // EI_CLASSIFIER_ALLOCATION_HEAP
 }
 
+#if EI_COMPILED_MODEL_PROFILING
+static tflite_learn_3_profile_t profile;
+static size_t profile_overflow_bytes = 0;
+#endif // EI_COMPILED_MODEL_PROFILING
+
 static void* overflow_buffers[EI_MAX_OVERFLOW_BUFFER_COUNT];
 static size_t overflow_buffers_ix = 0;
 static void * AllocatePersistentBufferImpl(struct TfLiteContext* ctx,
@@ -459,6 +470,9 @@ static void * AllocatePersistentBufferImpl(struct TfLiteContext* ctx,
       return NULL;
     }
     overflow_buffers[overflow_buffers_ix++] = ptr;
+#if EI_COMPILED_MODEL_PROFILING
+    profile_overflow_bytes += bytes;
+#endif
     return ptr;
   }
 
@@ -608,6 +622,55 @@ class EonMicroContext : public MicroContext {
 
 };
 
+#if EI_COMPILED_MODEL_PROFILING
+static const char *const profile_op_names[OP_LAST] = {
+  "RESHAPE", "CONV_2D", "MAX_POOL_2D", "FULLY_CONNECTED", "SOFTMAX",
+};
+
+static const char *ProfileKernels() {
+#if defined(EI_CLASSIFIER_TFLITE_ENABLE_ESP_NN_S3)
+  return "esp-nn-s3";
+#elif defined(EI_CLASSIFIER_TFLITE_ENABLE_ESP_NN) && EI_CLASSIFIER_TFLITE_ENABLE_ESP_NN == 1
+  return "esp-nn";
+#elif defined(EI_CLASSIFIER_TFLITE_ENABLE_CMSIS_NN) && EI_CLASSIFIER_TFLITE_ENABLE_CMSIS_NN == 1
+  return "cmsis-nn";
+#else
+  return "reference";
+#endif
+}
+
+static void ProfileRecordMemory() {
+  size_t scratch_bytes = 0;
+  for (size_t ix = 0; ix < scratch_buffers_ix; ix++) {
+    scratch_bytes += scratch_buffers[ix].bytes;
+  }
+  size_t tensor_bytes = (size_t)(tensor_boundary - tensor_arena);
+  size_t persistent_bytes = (size_t)(tensor_arena + kTensorArenaSize - current_location);
+
+  profile.kernels = ProfileKernels();
+  profile.arena_size = kTensorArenaSize;
+  if (tensor_bytes > profile.tensor_bytes) profile.tensor_bytes = tensor_bytes;
+  if (persistent_bytes > profile.persistent_bytes) profile.persistent_bytes = persistent_bytes;
+  if (tensor_bytes + persistent_bytes > profile.arena_high_water) {
+    profile.arena_high_water = tensor_bytes + persistent_bytes;
+  }
+  if (scratch_buffers_ix > profile.scratch_count) profile.scratch_count = scratch_buffers_ix;
+  if (scratch_bytes > profile.scratch_bytes) profile.scratch_bytes = scratch_bytes;
+  if (overflow_buffers_ix > profile.overflow_count) profile.overflow_count = overflow_buffers_ix;
+  if (profile_overflow_bytes > profile.overflow_bytes) profile.overflow_bytes = profile_overflow_bytes;
+  for (size_t i = 0; i < TFLITE_LEARN_3_NODE_COUNT; ++i) {
+    profile.nodes[i].op = profile_op_names[used_ops[i]];
+  }
+}
+
+static void ProfileRecordNode(size_t i, uint32_t elapsed_us) {
+  tflite_learn_3_node_profile_t &node = profile.nodes[i];
+  if (node.invocations == 0 || elapsed_us < node.min_us) node.min_us = elapsed_us;
+  if (elapsed_us > node.max_us) node.max_us = elapsed_us;
+  node.total_us += elapsed_us;
+  node.invocations++;
+}
+#endif // EI_COMPILED_MODEL_PROFILING
 
 } // namespace
 
@@ -674,7 +737,13 @@ TfLiteStatus tflite_learn_3_init( void*(*alloc_fnc)(size_t,size_t) ) {
     for(size_t i = tflNodes_subgraph_index[g]; i < tflNodes_subgraph_index[g+1]; ++i) {
       if (registrations[used_ops[i]].prepare) {
         ResetTensors();
+#if EI_COMPILED_MODEL_PROFILING
+        uint64_t prepare_start_us = ei_read_timer_us();
+#endif
         TfLiteStatus status = registrations[used_ops[i]].prepare(&ctx, &tflNodes[i]);
+#if EI_COMPILED_MODEL_PROFILING
+        profile.nodes[i].prepare_us = (uint32_t)(ei_read_timer_us() - prepare_start_us);
+#endif
         if (status != kTfLiteOk) {
           return status;
         }
@@ -683,6 +752,10 @@ TfLiteStatus tflite_learn_3_init( void*(*alloc_fnc)(size_t,size_t) ) {
   }
   current_subgraph_index = 0;
 
+#if EI_COMPILED_MODEL_PROFILING
+  ProfileRecordMemory();
+#endif
+
   return kTfLiteOk;
 }
 
@@ -697,10 +770,19 @@ TfLiteStatus tflite_learn_3_output(int index, TfLiteTensor *tensor) {
 }
 
 TfLiteStatus tflite_learn_3_invoke() {
+#if EI_COMPILED_MODEL_PROFILING
+  profile.invocations++;
+#endif
   for (size_t i = 0; i < 11; ++i) {
     ResetTensors();
 
+#if EI_COMPILED_MODEL_PROFILING
+    uint64_t node_start_us = ei_read_timer_us();
+#endif
     TfLiteStatus status = registrations[used_ops[i]].invoke(&ctx, &tflNodes[i]);
+#if EI_COMPILED_MODEL_PROFILING
+    ProfileRecordNode(i, (uint32_t)(ei_read_timer_us() - node_start_us));
+#endif
 
 #if EI_CLASSIFIER_PRINT_STATE
     ei_printf("layer %lu\n", i);
@@ -781,5 +863,270 @@ TfLiteStatus tflite_learn_3_reset( void (*free_fnc)(void* ptr) ) {
     ei_free(overflow_buffers[ix]);
   }
   overflow_buffers_ix = 0;
+#if EI_COMPILED_MODEL_PROFILING
+  profile_overflow_bytes = 0;
+#endif
+  return kTfLiteOk;
+}
+
+#if EI_COMPILED_MODEL_PROFILING
+const tflite_learn_3_profile_t *tflite_learn_3_profile() {
+  return &profile;
+}
+
+void tflite_learn_3_profile_reset() {
+  memset(&profile, 0, sizeof(profile));
+}
+
+void tflite_learn_3_profile_print() {
+  uint64_t total_us = 0;
+  for (size_t i = 0; i < TFLITE_LEARN_3_NODE_COUNT; ++i) {
+    total_us += profile.nodes[i].total_us;
+  }
+  ei_printf("tflite_learn_3 profile: kernels=%s invocations=%lu\n",
+    profile.kernels ? profile.kernels : "?", (unsigned long)profile.invocations);
+  ei_printf("node op               prepare_us   avg_us   min_us   max_us  share\n");
+  for (size_t i = 0; i < TFLITE_LEARN_3_NODE_COUNT; ++i) {
+    const tflite_learn_3_node_profile_t &node = profile.nodes[i];
+    uint32_t avg_us = node.invocations ? (uint32_t)(node.total_us / node.invocations) : 0;
+    uint32_t share = total_us ? (uint32_t)(node.total_us * 1000 / total_us) : 0;
+    ei_printf("%4u %-16s %10lu %8lu %8lu %8lu %3lu.%lu%%\n",
+      (unsigned)i, node.op ? node.op : "?", (unsigned long)node.prepare_us, (unsigned long)avg_us,
+      (unsigned long)node.min_us, (unsigned long)node.max_us,
+      (unsigned long)(share / 10), (unsigned long)(share % 10));
+  }
+  ei_printf("arena: size=%u high_water=%u tensors=%u persistent=%u scratch=%u/%uB overflow=%u/%uB\n",
+    (unsigned)profile.arena_size, (unsigned)profile.arena_high_water, (unsigned)profile.tensor_bytes,
+    (unsigned)profile.persistent_bytes, (unsigned)profile.scratch_count, (unsigned)profile.scratch_bytes,
+    (unsigned)profile.overflow_count, (unsigned)profile.overflow_bytes);
+}
+
+size_t tflite_learn_3_profile_json(char *buffer, size_t size) {
+  size_t used = 0;
+  // snprintf returns the would-be length; keep counting past the end so callers can size the buffer
+  #define PROFILE_APPEND(...) do { \
+    int n = snprintf(buffer && used < size ? buffer + used : nullptr, \
+                     buffer && used < size ? size - used : 0, __VA_ARGS__); \
+    if (n > 0) used += (size_t)n; \
+  } while (0)
+
+  PROFILE_APPEND("{\"model\":\"tflite_learn_3\",\"kernels\":\"%s\",\"invocations\":%lu,",
+    profile.kernels ? profile.kernels : "", (unsigned long)profile.invocations);
+  PROFILE_APPEND("\"arena\":{\"size\":%u,\"high_water\":%u,\"tensors\":%u,\"persistent\":%u,"
+    "\"scratch_count\":%u,\"scratch_bytes\":%u,\"overflow_count\":%u,\"overflow_bytes\":%u},\"nodes\":[",
+    (unsigned)profile.arena_size, (unsigned)profile.arena_high_water, (unsigned)profile.tensor_bytes,
+    (unsigned)profile.persistent_bytes, (unsigned)profile.scratch_count, (unsigned)profile.scratch_bytes,
+    (unsigned)profile.overflow_count, (unsigned)profile.overflow_bytes);
+  for (size_t i = 0; i < TFLITE_LEARN_3_NODE_COUNT; ++i) {
+    const tflite_learn_3_node_profile_t &node = profile.nodes[i];
+    PROFILE_APPEND("%s{\"node\":%u,\"op\":\"%s\",\"invocations\":%lu,\"prepare_us\":%lu,"
+      "\"total_us\":%llu,\"min_us\":%lu,\"max_us\":%lu}",
+      i ? "," : "", (unsigned)i, node.op ? node.op : "", (unsigned long)node.invocations,
+      (unsigned long)node.prepare_us, (unsigned long long)node.total_us, (unsigned long)node.min_us,
+      (unsigned long)node.max_us);
+  }
+  PROFILE_APPEND("]}");
+  #undef PROFILE_APPEND
+  return used;
+}
+#endif // EI_COMPILED_MODEL_PROFILING
+
+// ---------------------------------------------------------------------------
+// Streaming execution
+//
+// The graph is CONV(1x3, same) -> MAXPOOL(2) -> CONV(1x3, same) -> MAXPOOL(2)
+// -> FC -> SOFTMAX over 50 time steps. When the input window advances by a
+// multiple of 4 frames, every cached activation column keeps its meaning after
+// a shift, so only columns whose receptive field saw a changed input frame are
+// recomputed. The conv/pool arithmetic mirrors the int8 reference kernels
+// (per-channel requantization, padding skipped) and the FC + SOFTMAX nodes run
+// through the regular registrations on the cached pool output.
+// ---------------------------------------------------------------------------
+namespace {
+
+constexpr int kStreamFrames = 50;
+constexpr int kStreamCoeffs = 13;
+constexpr int kConv1Channels = 8;
+constexpr int kPool1Frames = 25;
+constexpr int kConv2Channels = 16;
+constexpr int kPool2Frames = 13;
+constexpr int kStreamAlign = 4; // two stride-2 pools
+
+struct StreamingState {
+  bool primed;
+  int32_t conv1_multiplier[kConv1Channels];
+  int conv1_shift[kConv1Channels];
+  int32_t conv2_multiplier[kConv2Channels];
+  int conv2_shift[kConv2Channels];
+  int8_t input[kStreamFrames * kStreamCoeffs];
+  int8_t conv1[kStreamFrames * kConv1Channels];
+  int8_t pool1[kPool1Frames * kConv1Channels];
+  int8_t conv2[kPool1Frames * kConv2Channels];
+  int8_t pool2[kPool2Frames * kConv2Channels];
+  tflite_learn_3_streaming_stats_t stats;
+};
+
+static StreamingState stream_state;
+
+static void StreamingQuantize(const TfLiteAffineQuantization &input, const TfLiteAffineQuantization &filter,
+                              const TfLiteAffineQuantization &output, int channels,
+                              int32_t *multiplier, int *shift) {
+  // Same double-precision path as PopulateConvolutionQuantizationParams
+  const float input_scale = input.scale->data[0];
+  const float output_scale = output.scale->data[0];
+  for (int ch = 0; ch < channels; ++ch) {
+    const double effective = static_cast<double>(input_scale) *
+                             static_cast<double>(filter.scale->data[ch]) /
+                             static_cast<double>(output_scale);
+    tflite::QuantizeMultiplier(effective, &multiplier[ch], &shift[ch]);
+  }
+}
+
+// One output column of a 1x3 'same' conv with ReLU, int8 in/out, per-channel weights.
+static void StreamingConvColumn(const int8_t *in, int frames, int in_ch, int col,
+                                const int8_t *filter, const int32_t *bias, int out_ch,
+                                int32_t input_offset, int32_t output_offset,
+                                const int32_t *multiplier, const int *shift, int8_t *out) {
+  for (int oc = 0; oc < out_ch; ++oc) {
+    int32_t acc = 0;
+    for (int k = 0; k < 3; ++k) {
+      const int t = col + k - 1;
+      if (t < 0 || t >= frames) {
+        continue;
+      }
+      const int8_t *x = in + (t * in_ch);
+      const int8_t *w = filter + (((oc * 3) + k) * in_ch);
+      for (int ic = 0; ic < in_ch; ++ic) {
+        acc += w[ic] * (x[ic] + input_offset);
+      }
+    }
+    acc += bias[oc];
+    acc = tflite::MultiplyByQuantizedMultiplier(acc, multiplier[oc], shift[oc]);
+    acc += output_offset;
+    // ReLU on an int8 output with zero point -128 leaves the range at [-128, 127]
+    acc = acc < -128 ? -128 : (acc > 127 ? 127 : acc);
+    out[(col * out_ch) + oc] = static_cast<int8_t>(acc);
+  }
+}
+
+// One output column of a stride-2 max pool; the 'same' tail column only sees one input.
+static void StreamingPoolColumn(const int8_t *in, int frames, int ch, int col, int8_t *out) {
+  const int t = col * 2;
+  for (int c = 0; c < ch; ++c) {
+    int8_t v = in[(t * ch) + c];
+    if (t + 1 < frames && in[((t + 1) * ch) + c] > v) {
+      v = in[((t + 1) * ch) + c];
+    }
+    out[(col * ch) + c] = v;
+  }
+}
+
+template <size_t N>
+static void StreamingShift(int8_t (&buffer)[N], size_t bytes) {
+  memmove(buffer, buffer + bytes, N - bytes);
+}
+
+} // namespace
+
+void tflite_learn_3_streaming_reset() {
+  stream_state.primed = false;
+}
+
+const tflite_learn_3_streaming_stats_t *tflite_learn_3_streaming_stats() {
+  return &stream_state.stats;
+}
+
+TfLiteStatus tflite_learn_3_invoke_streaming(int shift_frames) {
+  StreamingState &s = stream_state;
+  if (!s.primed) {
+    StreamingQuantize(g0::quant12, g0::quant11, g0::quant13, kConv1Channels, s.conv1_multiplier, s.conv1_shift);
+    StreamingQuantize(g0::quant16, g0::quant9, g0::quant17, kConv2Channels, s.conv2_multiplier, s.conv2_shift);
+  }
+
+  TfLiteTensor input;
+  init_tflite_tensor(0, &input);
+  const int8_t *x = input.data.int8;
+
+  // Anything that breaks pool alignment falls back to recomputing every column
+  const bool incremental = s.primed && shift_frames >= 0 && shift_frames < kStreamFrames &&
+                           (shift_frames % kStreamAlign) == 0;
+  const int shift = incremental ? shift_frames : 0;
+  if (incremental && shift > 0) {
+    StreamingShift(s.input, shift * kStreamCoeffs);
+    StreamingShift(s.conv1, shift * kConv1Channels);
+    StreamingShift(s.pool1, (shift / 2) * kConv1Channels);
+    StreamingShift(s.conv2, (shift / 2) * kConv2Channels);
+    StreamingShift(s.pool2, (shift / 4) * kConv2Channels);
+  }
+
+  bool dirty_in[kStreamFrames];
+  for (int t = 0; t < kStreamFrames; ++t) {
+    const int8_t *column = x + (t * kStreamCoeffs);
+    dirty_in[t] = !incremental || t >= kStreamFrames - shift ||
+                  memcmp(column, s.input + (t * kStreamCoeffs), kStreamCoeffs) != 0;
+    if (dirty_in[t]) {
+      memcpy(s.input + (t * kStreamCoeffs), column, kStreamCoeffs);
+    }
+  }
+
+  const int32_t conv1_input_offset = -g0::quant12.zero_point->data[0];
+  const int32_t conv1_output_offset = g0::quant13.zero_point->data[0];
+  const int32_t conv2_input_offset = -g0::quant16.zero_point->data[0];
+  const int32_t conv2_output_offset = g0::quant17.zero_point->data[0];
+
+  bool dirty_conv1[kStreamFrames];
+  for (int t = 0; t < kStreamFrames; ++t) {
+    // column 0 moved from a position whose left neighbour was real data, now it is padding
+    dirty_conv1[t] = (t == 0 && shift > 0) || dirty_in[t] || (t > 0 && dirty_in[t - 1]) ||
+                     (t + 1 < kStreamFrames && dirty_in[t + 1]);
+    if (dirty_conv1[t]) {
+      StreamingConvColumn(s.input, kStreamFrames, kStreamCoeffs, t, g0::tensor_data11, g0::tensor_data10,
+                          kConv1Channels, conv1_input_offset, conv1_output_offset,
+                          s.conv1_multiplier, s.conv1_shift, s.conv1);
+      s.stats.conv1_columns++;
+    }
+  }
+
+  bool dirty_pool1[kPool1Frames];
+  for (int t = 0; t < kPool1Frames; ++t) {
+    dirty_pool1[t] = dirty_conv1[t * 2] || dirty_conv1[(t * 2) + 1];
+    if (dirty_pool1[t]) {
+      StreamingPoolColumn(s.conv1, kStreamFrames, kConv1Channels, t, s.pool1);
+    }
+  }
+
+  bool dirty_conv2[kPool1Frames];
+  for (int t = 0; t < kPool1Frames; ++t) {
+    dirty_conv2[t] = (t == 0 && shift > 0) || dirty_pool1[t] || (t > 0 && dirty_pool1[t - 1]) ||
+                     (t + 1 < kPool1Frames && dirty_pool1[t + 1]);
+    if (dirty_conv2[t]) {
+      StreamingConvColumn(s.pool1, kPool1Frames, kConv1Channels, t, g0::tensor_data9, g0::tensor_data8,
+                          kConv2Channels, conv2_input_offset, conv2_output_offset,
+                          s.conv2_multiplier, s.conv2_shift, s.conv2);
+      s.stats.conv2_columns++;
+    }
+  }
+
+  for (int t = 0; t < kPool2Frames; ++t) {
+    if (dirty_conv2[t * 2] || ((t * 2) + 1 < kPool1Frames && dirty_conv2[(t * 2) + 1])) {
+      StreamingPoolColumn(s.conv2, kPool1Frames, kConv2Channels, t, s.pool2);
+    }
+  }
+
+  s.primed = true;
+  s.stats.invocations++;
+  s.stats.incremental += incremental ? 1 : 0;
+
+  // Hand the cached pool output to the regular RESHAPE -> FC -> SOFTMAX nodes
+  TfLiteTensor pooled;
+  init_tflite_tensor(19, &pooled);
+  memcpy(pooled.data.int8, s.pool2, sizeof(s.pool2));
+  for (size_t i = 8; i < 11; ++i) {
+    ResetTensors();
+    TfLiteStatus status = registrations[used_ops[i]].invoke(&ctx, &tflNodes[i]);
+    if (status != kTfLiteOk) {
+      return status;
+    }
+  }
   return kTfLiteOk;
 }
@@ -46,6 +46,62 @@ TfLiteStatus tflite_learn_3_invoke();
 //Frees memory allocated
 TfLiteStatus tflite_learn_3_reset( void (*free)(void* ptr) );
 
+// Streaming execution: shift_frames is how many input frames the window advanced
+// since the previous call. Multiples of 4 reuse cached conv/pool columns whose
+// inputs did not change; anything else recomputes every column. The output
+// tensor is bit-identical to tflite_learn_3_invoke() for the same input.
+typedef struct {
+  uint32_t invocations;
+  uint32_t incremental;
+  uint32_t conv1_columns;
+  uint32_t conv2_columns;
+} tflite_learn_3_streaming_stats_t;
+
+TfLiteStatus tflite_learn_3_invoke_streaming(int shift_frames);
+void tflite_learn_3_streaming_reset();
+const tflite_learn_3_streaming_stats_t *tflite_learn_3_streaming_stats();
+
+#ifndef EI_COMPILED_MODEL_PROFILING
+#define EI_COMPILED_MODEL_PROFILING 0
+#endif
+
+#if EI_COMPILED_MODEL_PROFILING
+// Per-node profile collected by init/prepare/invoke when built with
+// -DEI_COMPILED_MODEL_PROFILING=1. Times come from ei_read_timer_us(); memory
+// figures are the peak seen over all init() calls since the last profile reset.
+#define TFLITE_LEARN_3_NODE_COUNT 11
+
+typedef struct {
+  const char *op;
+  uint32_t invocations;
+  uint64_t total_us;
+  uint32_t min_us;
+  uint32_t max_us;
+  uint32_t prepare_us;
+} tflite_learn_3_node_profile_t;
+
+typedef struct {
+  const char *kernels;          // kernel family linked into this build
+  size_t arena_size;
+  size_t tensor_bytes;          // activation tensors, from the bottom of the arena
+  size_t persistent_bytes;      // kernel persistent + scratch buffers, from the top
+  size_t arena_high_water;
+  size_t scratch_count;
+  size_t scratch_bytes;
+  size_t overflow_count;        // persistent buffers that spilled to ei_calloc
+  size_t overflow_bytes;
+  uint32_t invocations;
+  tflite_learn_3_node_profile_t nodes[TFLITE_LEARN_3_NODE_COUNT];
+} tflite_learn_3_profile_t;
+
+const tflite_learn_3_profile_t *tflite_learn_3_profile();
+void tflite_learn_3_profile_reset();
+// Prints one row per node through ei_printf.
+void tflite_learn_3_profile_print();
+// Writes the profile as JSON; returns the length snprintf would need (excluding NUL).
+size_t tflite_learn_3_profile_json(char *buffer, size_t size);
+#endif // EI_COMPILED_MODEL_PROFILING
+
 
 // Returns the number of input tensors.
 inline size_t tflite_learn_3_inputs() {
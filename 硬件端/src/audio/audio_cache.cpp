@@ -0,0 +1,491 @@
+#include "audio_cache.h"
+
+#include <LittleFS.h>
+#include <esp_heap_caps.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+#include "../voice.h"
+#include "local_audio.h"
+
+namespace
+{
+constexpr const char *kCacheDir = "/cache";
+constexpr const char *kIndexPath = "/cache/index.bin";
+constexpr uint32_t kIndexMagic = 0x31434341; // "ACC1"
+constexpr uint64_t kFnvPrime = 1099511628211ULL;
+constexpr uint32_t kTouchFlushInterval = 8;
+
+struct CacheEntry
+{
+  uint64_t key;
+  uint32_t size;
+  uint32_t lastUsed;
+  char etag[AUDIO_CACHE_ETAG_MAX];
+};
+
+struct IndexHeader
+{
+  uint32_t magic;
+  uint32_t count;
+  uint32_t useClock;
+  uint32_t entrySize;
+};
+
+CacheEntry *entries = nullptr;
+size_t entryCount = 0;
+uint32_t useClock = 0;
+uint32_t totalBytes = 0;
+uint32_t pendingTouches = 0;
+bool cacheReady = false;
+SemaphoreHandle_t cacheMutex = nullptr;
+
+class CacheLock
+{
+public:
+  CacheLock() { xSemaphoreTake(cacheMutex, portMAX_DELAY); }
+  ~CacheLock() { xSemaphoreGive(cacheMutex); }
+};
+
+String entryPath(uint64_t key, const char *suffix)
+{
+  char path[40];
+  snprintf(path, sizeof(path), "%s/%016llx%s", kCacheDir,
+           static_cast<unsigned long long>(key), suffix);
+  return String(path);
+}
+
+void copyEtag(char *dest, const char *etag)
+{
+  dest[0] = '\0';
+  if (etag == nullptr)
+  {
+    return;
+  }
+  size_t length = strlen(etag);
+  if (length >= AUDIO_CACHE_ETAG_MAX)
+  {
+    // 过长的 ETag 无法原样回传 If-None-Match，按无 ETag 处理
+    return;
+  }
+  memcpy(dest, etag, length + 1);
+}
+
+int findEntry(uint64_t key)
+{
+  for (size_t i = 0; i < entryCount; ++i)
+  {
+    if (entries[i].key == key)
+    {
+      return static_cast<int>(i);
+    }
+  }
+  return -1;
+}
+
+void saveIndex()
+{
+  File file = LittleFS.open(kIndexPath, "w");
+  if (!file)
+  {
+    Serial.println("[AudioCache] Failed to write cache index.");
+    return;
+  }
+
+  IndexHeader header = {kIndexMagic, static_cast<uint32_t>(entryCount), useClock, sizeof(CacheEntry)};
+  file.write(reinterpret_cast<const uint8_t *>(&header), sizeof(header));
+  file.write(reinterpret_cast<const uint8_t *>(entries), entryCount * sizeof(CacheEntry));
+  file.close();
+  pendingTouches = 0;
+}
+
+void removeEntryAt(size_t index)
+{
+  LittleFS.remove(entryPath(entries[index].key, ".wav"));
+  totalBytes -= entries[index].size;
+  entries[index] = entries[entryCount - 1];
+  --entryCount;
+}
+
+// 淘汰最久未使用的条目，直到能容纳 incomingBytes 且留出一个索引槽位
+void evictFor(size_t incomingBytes)
+{
+  while (entryCount > 0 &&
+         (entryCount >= AUDIO_CACHE_MAX_ENTRIES || totalBytes + incomingBytes > AUDIO_CACHE_BUDGET_BYTES))
+  {
+    size_t oldest = 0;
+    for (size_t i = 1; i < entryCount; ++i)
+    {
+      if (entries[i].lastUsed < entries[oldest].lastUsed)
+      {
+        oldest = i;
+      }
+    }
+    Serial.printf("[AudioCache] Evict %016llx (%u bytes)\n",
+                  static_cast<unsigned long long>(entries[oldest].key),
+                  static_cast<unsigned>(entries[oldest].size));
+    removeEntryAt(oldest);
+  }
+}
+
+void loadIndex()
+{
+  entryCount = 0;
+  totalBytes = 0;
+  useClock = 0;
+
+  File file = LittleFS.open(kIndexPath, "r");
+  if (!file)
+  {
+    return;
+  }
+
+  IndexHeader header = {};
+  bool headerOk = file.read(reinterpret_cast<uint8_t *>(&header), sizeof(header)) == sizeof(header) &&
+                  header.magic == kIndexMagic &&
+                  header.entrySize == sizeof(CacheEntry) &&
+                  header.count <= AUDIO_CACHE_MAX_ENTRIES;
+  if (!headerOk)
+  {
+    file.close();
+    Serial.println("[AudioCache] Cache index invalid; starting empty.");
+    return;
+  }
+
+  size_t bytes = header.count * sizeof(CacheEntry);
+  if (file.read(reinterpret_cast<uint8_t *>(entries), bytes) != bytes)
+  {
+    file.close();
+    Serial.println("[AudioCache] Cache index truncated; starting empty.");
+    return;
+  }
+  file.close();
+
+  useClock = header.useClock;
+  for (size_t i = 0; i < header.count; ++i)
+  {
+    File payload = LittleFS.open(entryPath(entries[i].key, ".wav"), "r");
+    if (!payload || payload.size() != entries[i].size)
+    {
+      continue;
+    }
+    payload.close();
+    entries[entryCount++] = entries[i];
+    totalBytes += entries[i].size;
+  }
+}
+
+// 清理断电遗留的 .tmp 和不在索引中的孤儿文件
+void removeOrphanFiles()
+{
+  File dir = LittleFS.open(kCacheDir);
+  if (!dir || !dir.isDirectory())
+  {
+    return;
+  }
+
+  String orphans[8];
+  size_t orphanCount = 0;
+  File child = dir.openNextFile();
+  while (child && orphanCount < 8)
+  {
+    String name = child.name();
+    child.close();
+    int slash = name.lastIndexOf('/');
+    if (slash >= 0)
+    {
+      name = name.substring(slash + 1);
+    }
+
+    bool known = name == "index.bin";
+    if (!known && name.endsWith(".wav") && name.length() == 20)
+    {
+      uint64_t key = strtoull(name.substring(0, 16).c_str(), nullptr, 16);
+      known = findEntry(key) >= 0;
+    }
+    if (!known)
+    {
+      orphans[orphanCount++] = String(kCacheDir) + "/" + name;
+    }
+    child = dir.openNextFile();
+  }
+  dir.close();
+
+  for (size_t i = 0; i < orphanCount; ++i)
+  {
+    LittleFS.remove(orphans[i]);
+  }
+}
+
+bool insertEntry(uint64_t key, size_t size, const char *etag)
+{
+  int existing = findEntry(key);
+  if (existing >= 0)
+  {
+    totalBytes -= entries[existing].size;
+    entries[existing] = entries[entryCount - 1];
+    --entryCount;
+  }
+
+  evictFor(size);
+  if (entryCount >= AUDIO_CACHE_MAX_ENTRIES || totalBytes + size > AUDIO_CACHE_BUDGET_BYTES)
+  {
+    return false;
+  }
+
+  CacheEntry &entry = entries[entryCount++];
+  entry.key = key;
+  entry.size = static_cast<uint32_t>(size);
+  entry.lastUsed = ++useClock;
+  copyEtag(entry.etag, etag);
+  totalBytes += entry.size;
+  saveIndex();
+  return true;
+}
+
+} // namespace
+
+uint64_t audioCacheHash(const void *data, size_t length, uint64_t seed)
+{
+  const uint8_t *bytes = static_cast<const uint8_t *>(data);
+  uint64_t hash = seed;
+  for (size_t i = 0; i < length; ++i)
+  {
+    hash ^= bytes[i];
+    hash *= kFnvPrime;
+  }
+  return hash;
+}
+
+bool audioCacheInit()
+{
+  if (cacheReady)
+  {
+    return true;
+  }
+
+  if (!initLocalAudioStorage())
+  {
+    Serial.println("[AudioCache] LittleFS unavailable; audio cache disabled.");
+    return false;
+  }
+
+  if (cacheMutex == nullptr)
+  {
+    cacheMutex = xSemaphoreCreateMutex();
+  }
+  if (entries == nullptr)
+  {
+    entries = static_cast<CacheEntry *>(
+        heap_caps_calloc(AUDIO_CACHE_MAX_ENTRIES, sizeof(CacheEntry), MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT));
+  }
+  if (cacheMutex == nullptr || entries == nullptr)
+  {
+    Serial.println("[AudioCache] Failed to allocate cache index.");
+    return false;
+  }
+
+  if (!LittleFS.exists(kCacheDir))
+  {
+    LittleFS.mkdir(kCacheDir);
+  }
+
+  CacheLock lock;
+  loadIndex();
+  removeOrphanFiles();
+  cacheReady = true;
+  Serial.printf("[AudioCache] Ready: %u entries, %u/%u bytes\n",
+                static_cast<unsigned>(entryCount),
+                static_cast<unsigned>(totalBytes),
+                static_cast<unsigned>(AUDIO_CACHE_BUDGET_BYTES));
+  return true;
+}
+
+bool audioCacheLookup(uint64_t key, AudioCacheInfo *info)
+{
+  if (!cacheReady)
+  {
+    return false;
+  }
+
+  CacheLock lock;
+  int index = findEntry(key);
+  if (index < 0)
+  {
+    return false;
+  }
+  if (info != nullptr)
+  {
+    info->size = entries[index].size;
+    memcpy(info->etag, entries[index].etag, sizeof(info->etag));
+  }
+  return true;
+}
+
+bool audioCachePlay(uint64_t key, uint32_t playbackSampleRate)
+{
+  if (!cacheReady)
+  {
+    return false;
+  }
+
+  {
+    CacheLock lock;
+    int index = findEntry(key);
+    if (index < 0)
+    {
+      return false;
+    }
+    entries[index].lastUsed = ++useClock;
+    if (++pendingTouches >= kTouchFlushInterval)
+    {
+      saveIndex();
+    }
+  }
+
+  File file = LittleFS.open(entryPath(key, ".wav"), "r");
+  if (!file)
+  {
+    Serial.printf("[AudioCache] Missing payload for %016llx\n", static_cast<unsigned long long>(key));
+    audioCacheRemove(key);
+    return false;
+  }
+
+  Serial.printf("[AudioCache] Hit %016llx (%u bytes)\n",
+                static_cast<unsigned long long>(key),
+                static_cast<unsigned>(file.size()));
+  bool ok = playAudioStreamAtRate(file, file.size(), playbackSampleRate);
+  file.close();
+  return ok;
+}
+
+bool audioCacheStore(uint64_t key, const uint8_t *data, size_t length, const char *etag)
+{
+  AudioCacheWriter writer;
+  if (!writer.begin(key, length, etag))
+  {
+    return false;
+  }
+  writer.write(data, length);
+  return writer.commit();
+}
+
+void audioCacheRemove(uint64_t key)
+{
+  if (!cacheReady)
+  {
+    return;
+  }
+
+  CacheLock lock;
+  int index = findEntry(key);
+  if (index >= 0)
+  {
+    removeEntryAt(static_cast<size_t>(index));
+    saveIndex();
+  }
+}
+
+AudioCacheWriter::~AudioCacheWriter()
+{
+  abort();
+}
+
+bool AudioCacheWriter::begin(uint64_t key, size_t expectedSize, const char *etag)
+{
+  abort();
+  if (!cacheReady || expectedSize == 0 || expectedSize > AUDIO_CACHE_BUDGET_BYTES / 2)
+  {
+    return false;
+  }
+
+  {
+    // 先腾出空间，避免写入过程中 LittleFS 被写满
+    CacheLock lock;
+    evictFor(expectedSize);
+  }
+
+  file_ = LittleFS.open(entryPath(key, ".tmp"), "w");
+  if (!file_)
+  {
+    return false;
+  }
+
+  key_ = key;
+  expected_ = expectedSize;
+  written_ = 0;
+  failed_ = false;
+  active_ = true;
+  copyEtag(etag_, etag);
+  return true;
+}
+
+size_t AudioCacheWriter::write(const uint8_t *data, size_t length)
+{
+  if (!active_ || failed_ || length == 0)
+  {
+    return 0;
+  }
+  if (written_ + length > expected_)
+  {
+    failed_ = true;
+    return 0;
+  }
+
+  size_t n = file_.write(data, length);
+  if (n != length)
+  {
+    failed_ = true;
+  }
+  written_ += n;
+  return n;
+}
+
+bool AudioCacheWriter::commit()
+{
+  if (!active_)
+  {
+    return false;
+  }
+
+  file_.close();
+  active_ = false;
+  String tmpPath = entryPath(key_, ".tmp");
+  if (failed_ || written_ != expected_)
+  {
+    LittleFS.remove(tmpPath);
+    return false;
+  }
+
+  String finalPath = entryPath(key_, ".wav");
+  LittleFS.remove(finalPath);
+  if (!LittleFS.rename(tmpPath, finalPath))
+  {
+    LittleFS.remove(tmpPath);
+    return false;
+  }
+
+  CacheLock lock;
+  if (!insertEntry(key_, written_, etag_))
+  {
+    LittleFS.remove(finalPath);
+    return false;
+  }
+  Serial.printf("[AudioCache] Stored %016llx (%u bytes, total %u)\n",
+                static_cast<unsigned long long>(key_),
+                static_cast<unsigned>(written_),
+                static_cast<unsigned>(totalBytes));
+  return true;
+}
+
+void AudioCacheWriter::abort()
+{
+  if (!active_)
+  {
+    return;
+  }
+  file_.close();
+  LittleFS.remove(entryPath(key_, ".tmp"));
+  active_ = false;
+}
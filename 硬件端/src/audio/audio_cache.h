@@ -0,0 +1,53 @@
+#ifndef AUDIO_CACHE_H
+#define AUDIO_CACHE_H
+
+#include <Arduino.h>
+#include <FS.h>
+
+#include "../config.h"
+
+// LittleFS 内容寻址音频缓存：key 为 64 位 FNV-1a 哈希，按 LRU 在字节预算内淘汰。
+struct AudioCacheInfo
+{
+  uint32_t size;
+  char etag[AUDIO_CACHE_ETAG_MAX];
+};
+
+// seed 默认为 FNV-1a 64 位偏移基数；分段哈希时把上一段的结果作为 seed 传入
+uint64_t audioCacheHash(const void *data, size_t length, uint64_t seed = 0xcbf29ce484222325ULL);
+
+bool audioCacheInit();
+bool audioCacheLookup(uint64_t key, AudioCacheInfo *info);
+bool audioCachePlay(uint64_t key, uint32_t playbackSampleRate = LOCAL_AUDIO_PLAYBACK_SAMPLE_RATE);
+bool audioCacheStore(uint64_t key, const uint8_t *data, size_t length, const char *etag = "");
+void audioCacheRemove(uint64_t key);
+
+// 边下载边写入缓存，commit() 之前不会出现在索引中。
+class AudioCacheWriter
+{
+public:
+  AudioCacheWriter() = default;
+  ~AudioCacheWriter();
+
+  bool begin(uint64_t key, size_t expectedSize, const char *etag = "");
+  size_t write(const uint8_t *data, size_t length);
+  bool commit();
+  void abort();
+
+  bool active() const { return active_; }
+  size_t bytesWritten() const { return written_; }
+
+private:
+  AudioCacheWriter(const AudioCacheWriter &) = delete;
+  AudioCacheWriter &operator=(const AudioCacheWriter &) = delete;
+
+  File file_;
+  uint64_t key_ = 0;
+  size_t expected_ = 0;
+  size_t written_ = 0;
+  bool active_ = false;
+  bool failed_ = false;
+  char etag_[AUDIO_CACHE_ETAG_MAX] = {0};
+};
+
+#endif // AUDIO_CACHE_H
@@ -2,8 +2,8 @@
 
 #include <FS.h>
 #include <LittleFS.h>
-#include <esp_heap_caps.h>
 
+#include "../utils/voice_arena.h"
 #include "../voice.h"
 
 namespace
@@ -62,17 +62,6 @@ bool ensureStorageMounted()
   return storageMounted;
 }
 
-uint8_t *allocateAudioBuffer(size_t size)
-{
-  uint8_t *buffer = static_cast<uint8_t *>(
-      heap_caps_malloc(size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT));
-  if (buffer == nullptr)
-  {
-    buffer = static_cast<uint8_t *>(heap_caps_malloc(size, MALLOC_CAP_8BIT));
-  }
-  return buffer;
-}
-
 } // namespace
 
 bool initLocalAudioStorage()
@@ -120,7 +109,9 @@ bool playLocalAudioById(const String &audioId)
     return false;
   }
 
-  uint8_t *buffer = allocateAudioBuffer(fileSize);
+  // 从播放区分配，播放结束随租约回收
+  VoiceArenaLease lease(VoiceArenaRegion::Playback);
+  uint8_t *buffer = lease.alloc(fileSize);
   if (buffer == nullptr)
   {
     Serial.printf("[LocalAudio] Not enough memory for %s (%u bytes)\n",
@@ -138,7 +129,6 @@ bool playLocalAudioById(const String &audioId)
                   path.c_str(),
                   static_cast<unsigned>(bytesRead),
                   static_cast<unsigned>(fileSize));
-    free(buffer);
     return false;
   }
 
@@ -146,7 +136,5 @@ bool playLocalAudioById(const String &audioId)
                 path.c_str(),
                 static_cast<unsigned>(LOCAL_AUDIO_PLAYBACK_SAMPLE_RATE),
                 static_cast<unsigned>(fileSize));
-  bool ok = playLocalAudioBuffer(buffer, fileSize);
-  free(buffer);
-  return ok;
+  return playLocalAudioBuffer(buffer, fileSize);
 }
@@ -0,0 +1,177 @@
+#include "remote_audio.h"
+
+#include <HTTPClient.h>
+#include <WiFi.h>
+
+#include "../config.h"
+#include "../voice.h"
+#include "audio_cache.h"
+
+namespace
+{
+constexpr size_t kUnknownAudioLength = 0x7FFFFFFF;
+
+// 把读取到的字节同时写入缓存文件的 Stream 包装
+class TeeStream : public Stream
+{
+public:
+  TeeStream(Stream &source, AudioCacheWriter *writer) : source_(source), writer_(writer) {}
+
+  int available() override { return source_.available(); }
+  int peek() override { return source_.peek(); }
+  void flush() override {}
+  size_t write(uint8_t) override { return 0; }
+
+  int read() override
+  {
+    int c = source_.read();
+    if (c >= 0 && writer_ != nullptr)
+    {
+      uint8_t byte = static_cast<uint8_t>(c);
+      writer_->write(&byte, 1);
+    }
+    return c;
+  }
+
+  size_t readBytes(char *buffer, size_t length) override
+  {
+    size_t n = source_.readBytes(buffer, length);
+    if (n > 0 && writer_ != nullptr)
+    {
+      writer_->write(reinterpret_cast<const uint8_t *>(buffer), n);
+    }
+    return n;
+  }
+
+  // data 块之后可能还有 LIST 等尾块，读完才能得到完整可缓存的文件
+  void drainTo(size_t totalLength)
+  {
+    uint8_t discard[256];
+    while (writer_ != nullptr && writer_->bytesWritten() < totalLength)
+    {
+      size_t chunk = min(sizeof(discard), totalLength - writer_->bytesWritten());
+      if (readBytes(reinterpret_cast<char *>(discard), chunk) == 0)
+      {
+        break;
+      }
+    }
+  }
+
+private:
+  Stream &source_;
+  AudioCacheWriter *writer_;
+};
+
+String resolveAudioUrl(const String &audioUrl)
+{
+  if (audioUrl.startsWith("/"))
+  {
+    return String(SERVER_BASE_URL) + audioUrl;
+  }
+  return audioUrl;
+}
+
+bool playCachedFallback(uint64_t key, bool hasCached, const char *reason)
+{
+  if (!hasCached)
+  {
+    return false;
+  }
+  Serial.printf("[RemoteAudio] %s, playing cached copy\n", reason);
+  return audioCachePlay(key);
+}
+
+} // namespace
+
+bool playRemoteAudioUrl(const String &audioUrl)
+{
+  if (audioUrl.length() == 0)
+  {
+    return false;
+  }
+
+  String url = resolveAudioUrl(audioUrl);
+  uint64_t key = audioCacheHash(url.c_str(), url.length());
+  AudioCacheInfo cached = {};
+  bool hasCached = audioCacheLookup(key, &cached);
+
+  // 没有 ETag 的条目视为按 URL 不可变，直接本地播放
+  if (hasCached && cached.etag[0] == '\0')
+  {
+    return audioCachePlay(key);
+  }
+
+  if (WiFi.status() != WL_CONNECTED)
+  {
+    return playCachedFallback(key, hasCached, "WiFi offline");
+  }
+
+  HTTPClient http;
+  if (!http.begin(url))
+  {
+    Serial.printf("[RemoteAudio] HTTPClient begin failed: %s\n", url.c_str());
+    return playCachedFallback(key, hasCached, "begin failed");
+  }
+
+  const char *headerKeys[] = {"ETag", "Content-Type"};
+  http.collectHeaders(headerKeys, 2);
+  http.useHTTP10(true);
+  http.setTimeout(AUDIO_URL_HTTP_TIMEOUT_MS);
+  http.addHeader("X-Device-ID", DEVICE_ID);
+  if (hasCached)
+  {
+    http.addHeader("If-None-Match", cached.etag);
+  }
+
+  unsigned long startMs = millis();
+  int status = http.GET();
+  if (status == HTTP_CODE_NOT_MODIFIED && hasCached)
+  {
+    http.end();
+    Serial.printf("[RemoteAudio] 304 Not Modified in %lu ms\n", millis() - startMs);
+    return audioCachePlay(key);
+  }
+
+  if (status != HTTP_CODE_OK)
+  {
+    Serial.printf("[RemoteAudio] GET %s failed, http=%d\n", url.c_str(), status);
+    http.end();
+    return playCachedFallback(key, hasCached, "download failed");
+  }
+
+  WiFiClient *stream = http.getStreamPtr();
+  if (stream == nullptr)
+  {
+    http.end();
+    return playCachedFallback(key, hasCached, "no stream");
+  }
+
+  int contentLength = http.getSize();
+  String etag = http.header("ETag");
+  AudioCacheWriter writer;
+  bool caching = contentLength > 0 && writer.begin(key, static_cast<size_t>(contentLength), etag.c_str());
+  Serial.printf("[RemoteAudio] Streaming %s (%d bytes, first byte %lu ms, cache=%s)\n",
+                url.c_str(),
+                contentLength,
+                millis() - startMs,
+                caching ? "yes" : "no");
+
+  TeeStream tee(*stream, caching ? &writer : nullptr);
+  size_t audioLength = contentLength > 0 ? static_cast<size_t>(contentLength) : kUnknownAudioLength;
+  bool ok = playAudioStream(tee, audioLength);
+
+  if (caching)
+  {
+    if (ok)
+    {
+      tee.drainTo(static_cast<size_t>(contentLength));
+    }
+    if (!ok || !writer.commit())
+    {
+      writer.abort();
+    }
+  }
+
+  http.end();
+  return ok;
+}
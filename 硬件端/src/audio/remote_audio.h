@@ -0,0 +1,9 @@
+#ifndef REMOTE_AUDIO_H
+#define REMOTE_AUDIO_H
+
+#include <Arduino.h>
+
+// 播放服务端 speak.audio_url 指向的 WAV：边下载边送入 I2S，同时写入 LittleFS 缓存。
+bool playRemoteAudioUrl(const String &audioUrl);
+
+#endif // REMOTE_AUDIO_H
@@ -0,0 +1,161 @@
+#include "wait_prompt.h"
+
+#include <Arduino.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "../config.h"
+#include "../utils/deferred_log.h"
+#include "../utils/latency_trace.h"
+#include "../voice.h"
+#include "local_audio.h"
+
+namespace
+{
+TaskHandle_t promptTask = nullptr;
+// 发起本次提示音的任务；播放任务回报结束、发起者取走通知之前一直非空
+volatile TaskHandle_t ownerTask = nullptr;
+volatile bool cancelRequested = false;
+const char *pendingAudioId = nullptr;
+uint16_t pendingTurn = 0;
+
+portMUX_TYPE statsMux = portMUX_INITIALIZER_UNLOCKED;
+WaitPromptStats stats = {};
+
+void promptLoop(void *parameter)
+{
+  (void)parameter;
+  while (true)
+  {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    TaskHandle_t owner = ownerTask;
+    if (owner == nullptr)
+    {
+      continue;
+    }
+
+    uint64_t startUs = traceNowUs();
+    // 回复在播放任务被调度之前就已就绪时不再开始播放
+    if (!cancelRequested && !playLocalAudioById(pendingAudioId))
+    {
+      Serial.printf("[WaitPrompt] %s unavailable, continuing without prompt.\n", pendingAudioId);
+    }
+    traceRecordForTurn(TraceWaitPrompt, startUs, pendingTurn);
+
+    portENTER_CRITICAL(&statsMux);
+    if (cancelRequested)
+    {
+      ++stats.cancelled;
+    }
+    else
+    {
+      ++stats.completed;
+    }
+    stats.lastPlayMs = static_cast<uint32_t>((traceNowUs() - startUs) / 1000);
+    portEXIT_CRITICAL(&statsMux);
+
+    xTaskNotifyGive(owner);
+  }
+}
+
+void finish(bool cancel)
+{
+  TaskHandle_t self = xTaskGetCurrentTaskHandle();
+  if (ownerTask == nullptr || ownerTask != self)
+  {
+    return;
+  }
+
+  uint64_t startUs = traceNowUs();
+  uint32_t waitedMs = 0;
+  if (cancel)
+  {
+    cancelRequested = true;
+    requestPlaybackStop();
+  }
+  // 播放任务可能恰好在停止请求之后才读取停止代数，每隔一小段重发一次，直到它回报结束
+  while (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(WAIT_PROMPT_STOP_RETRY_MS)) == 0)
+  {
+    waitedMs += WAIT_PROMPT_STOP_RETRY_MS;
+    if (cancel || waitedMs >= WAIT_PROMPT_JOIN_TIMEOUT_MS)
+    {
+      cancelRequested = true;
+      requestPlaybackStop();
+    }
+  }
+  ownerTask = nullptr;
+  traceRecord(TracePromptJoin, startUs);
+
+  portENTER_CRITICAL(&statsMux);
+  stats.lastJoinMs = static_cast<uint32_t>((traceNowUs() - startUs) / 1000);
+  portEXIT_CRITICAL(&statsMux);
+}
+} // namespace
+
+bool waitPromptBegin()
+{
+  if (promptTask != nullptr)
+  {
+    return true;
+  }
+  if (xTaskCreatePinnedToCore(promptLoop, "WaitPrompt", WAIT_PROMPT_TASK_STACK_SIZE, nullptr,
+                              WAIT_PROMPT_TASK_PRIORITY, &promptTask, WAIT_PROMPT_TASK_CORE) != pdPASS)
+  {
+    Serial.println("[WaitPrompt] Init failed: task not created, prompt will play before ASR.");
+    promptTask = nullptr;
+    return false;
+  }
+  return true;
+}
+
+void waitPromptStart(const char *audioId)
+{
+  if (promptTask == nullptr || ownerTask != nullptr)
+  {
+    // 没有播放任务时退回原来的顺序：播完再识别
+    TRACE_SPAN(TraceWaitPrompt);
+    portENTER_CRITICAL(&statsMux);
+    ++stats.inlinePlays;
+    portEXIT_CRITICAL(&statsMux);
+    if (!playLocalAudioById(audioId))
+    {
+      Serial.printf("[WaitPrompt] %s unavailable, continuing without prompt.\n", audioId);
+    }
+    return;
+  }
+
+  pendingAudioId = audioId;
+  pendingTurn = traceCurrentTurn();
+  cancelRequested = false;
+  portENTER_CRITICAL(&statsMux);
+  ++stats.started;
+  portEXIT_CRITICAL(&statsMux);
+  ownerTask = xTaskGetCurrentTaskHandle();
+  xTaskNotifyGive(promptTask);
+}
+
+void waitPromptYield()
+{
+  finish(true);
+}
+
+void waitPromptJoin()
+{
+  finish(false);
+}
+
+WaitPromptStats waitPromptStats()
+{
+  portENTER_CRITICAL(&statsMux);
+  WaitPromptStats copy = stats;
+  portEXIT_CRITICAL(&statsMux);
+  return copy;
+}
+
+void waitPromptReportStats()
+{
+  WaitPromptStats copy = waitPromptStats();
+  DLOG(0, "[稍等提示] 并行: %u, 播完: %u, 被回复中止: %u, 同步播放: %u, 最近一次 播放 %u ms / 语音任务等待 %u ms\n",
+       copy.started, copy.completed, copy.cancelled, copy.inlinePlays, copy.lastPlayMs, copy.lastJoinMs);
+}
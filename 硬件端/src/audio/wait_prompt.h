@@ -0,0 +1,31 @@
+#ifndef WAIT_PROMPT_H
+#define WAIT_PROMPT_H
+
+#include <stdint.h>
+
+// “请稍等”提示音放到单独的播放任务上：录音结束后语音任务只发一个任务通知，随即开始 ASR 和 /ai，
+// 提示音在播放任务上同时播放，不再把整段时长加到每一轮的延迟上。
+// 语音任务要用扬声器之前（回复已就绪）调用 waitPromptYield：提示音还没播完就中止
+// （I2S 当前分块写完即停），播放任务结束后用任务通知回报，语音任务收到后才开始播放回复。
+struct WaitPromptStats
+{
+  uint32_t started;     // 交给播放任务的次数
+  uint32_t completed;   // 完整播完
+  uint32_t cancelled;   // 回复先就绪，被中止
+  uint32_t inlinePlays; // 播放任务不可用时在语音任务上同步播放
+  uint32_t lastPlayMs;  // 最近一次提示音从开始到结束
+  uint32_t lastJoinMs;  // 最近一次语音任务等提示音结束
+};
+
+bool waitPromptBegin();
+// 语音任务调用：在播放任务上开始播放 audioId（字符串需一直有效），立即返回
+void waitPromptStart(const char *audioId);
+// 语音任务占用扬声器前调用：提示音仍在播放时中止并等它结束。
+// 不是发起提示音的任务、或没有提示音时立即返回，其他任务上的播放不受影响
+void waitPromptYield();
+// 一轮结束前调用：等提示音自然播完（没有回复要播时不截断），超过 WAIT_PROMPT_JOIN_TIMEOUT_MS 则中止
+void waitPromptJoin();
+WaitPromptStats waitPromptStats();
+void waitPromptReportStats();
+
+#endif // WAIT_PROMPT_H
@@ -0,0 +1,118 @@
+#include "wake_gate.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+bool WakeGate::processBlock(const int16_t *samples, size_t count)
+{
+  if (count == 0)
+  {
+    return false;
+  }
+
+  // 一阶低通（16 kHz 下约 320 Hz）分出低频带，余量即高频带；风扇、电源哼声主要落在低频带
+  uint32_t lowSum = 0;
+  uint32_t highSum = 0;
+  int32_t lowPass = lowPass_;
+  for (size_t i = 0; i < count; ++i)
+  {
+    int32_t x = samples[i];
+    lowPass += (x - lowPass) >> 3;
+    lowSum += static_cast<uint32_t>(abs(lowPass));
+    highSum += static_cast<uint32_t>(abs(x - lowPass));
+  }
+  lowPass_ = lowPass;
+  uint32_t low = lowSum / count;
+  uint32_t high = highSum / count;
+
+  // 对数前加上绝对余量，噪声抑制后零星残留的小幅度不会产生大通量
+  float lowLog = log2f(static_cast<float>(low + config_.floorMargin));
+  float highLog = log2f(static_cast<float>(high + config_.floorMargin));
+  float flux = fmaxf(0.0f, lowLog - prevLowLog_) + fmaxf(0.0f, highLog - prevHighLog_);
+  prevLowLog_ = lowLog;
+  prevHighLog_ = highLog;
+
+  bool triggered;
+  if (seenBlocks_ < config_.warmupBlocks)
+  {
+    if (seenBlocks_ == 0 || low < lowFloor_)
+    {
+      lowFloor_ = low;
+    }
+    if (seenBlocks_ == 0 || high < highFloor_)
+    {
+      highFloor_ = high;
+    }
+    ++seenBlocks_;
+    triggered = true;
+  }
+  else
+  {
+    triggered = exceedsFloor(low, lowFloor_) || exceedsFloor(high, highFloor_) || flux > config_.fluxThreshold;
+    trackFloor(low, &lowFloor_);
+    trackFloor(high, &highFloor_);
+  }
+
+  bool open = triggered;
+  if (triggered)
+  {
+    hangover_ = config_.hangoverBlocks;
+  }
+  else if (hangover_ > 0)
+  {
+    --hangover_;
+    open = true;
+  }
+
+  windowOpen_ = windowOpen_ || open;
+  ++stats_.blocks;
+  if (open)
+  {
+    ++stats_.openBlocks;
+  }
+  return open;
+}
+
+bool WakeGate::finishWindow()
+{
+  bool open = windowOpen_;
+  windowOpen_ = hangover_ > 0;
+  ++stats_.windows;
+  if (open)
+  {
+    ++stats_.openWindows;
+  }
+  return open;
+}
+
+void WakeGate::reset()
+{
+  stats_ = {};
+  lowPass_ = 0;
+  lowFloor_ = 0;
+  highFloor_ = 0;
+  prevLowLog_ = 0.0f;
+  prevHighLog_ = 0.0f;
+  seenBlocks_ = 0;
+  hangover_ = 0;
+  windowOpen_ = false;
+}
+
+bool WakeGate::exceedsFloor(uint32_t level, uint32_t floor) const
+{
+  return static_cast<float>(level) > static_cast<float>(floor) * config_.floorRatio + config_.floorMargin;
+}
+
+// 底噪快降慢升：下降按 1/16 跟随（不直接取最小值，起伏的风扇噪声不至于把底噪压到谷底），
+// 上升按 1/2^shift 缓慢跟随，语音短时能量不会把底噪抬上去
+void WakeGate::trackFloor(uint32_t level, uint32_t *floor) const
+{
+  if (level < *floor)
+  {
+    *floor -= (*floor - level + 15) >> 4;
+  }
+  else
+  {
+    *floor += (level - *floor) >> config_.floorRiseShift;
+  }
+}
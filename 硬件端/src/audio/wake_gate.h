@@ -0,0 +1,61 @@
+#ifndef WAKE_GATE_H
+#define WAKE_GATE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// 唤醒词级联的第一级：在每个 I2S 采集块上算低/高两个频带的平均幅度和频谱通量，
+// 与自适应底噪比较。一个推理窗口内任一块打开（含触发后的 hangover），整个窗口才交给
+// run_classifier；窗口里触发点之前的音频一并送入分类器，相当于最多一个窗口的回看。
+struct WakeGateConfig
+{
+  float floorRatio = 2.5f;      // 频带幅度超过底噪的倍数（约 8 dB）
+  uint16_t floorMargin = 24;    // 底噪之上的绝对余量，静音时底噪为 0
+  float fluxThreshold = 1.5f;   // 两个频带 log2 幅度相对上一块的正向变化之和
+  uint8_t floorRiseShift = 8;   // 底噪每块上升差值的 1/256，约 16 s 时间常数
+  uint16_t hangoverBlocks = 8;  // 触发后继续打开的块数，1024 样本/块约 0.5 s
+  uint16_t warmupBlocks = 16;   // 底噪收敛前一律打开
+};
+
+struct WakeGateStats
+{
+  uint32_t blocks;
+  uint32_t openBlocks;
+  uint32_t windows;
+  uint32_t openWindows;
+};
+
+class WakeGate
+{
+public:
+  explicit WakeGate(const WakeGateConfig &config = WakeGateConfig()) : config_(config) {}
+
+  // 处理一个采集块，返回该块是否打开
+  bool processBlock(const int16_t *samples, size_t count);
+  // 推理窗口填满时调用：返回本窗口是否有块打开，并开始下一个窗口（hangover 跨窗口保留）
+  bool finishWindow();
+  // 采集暂停/缓冲区丢弃时清掉当前窗口，底噪保留
+  void discardWindow() { windowOpen_ = false; }
+  void reset();
+
+  const WakeGateStats &stats() const { return stats_; }
+  uint16_t lowFloor() const { return static_cast<uint16_t>(lowFloor_); }
+  uint16_t highFloor() const { return static_cast<uint16_t>(highFloor_); }
+
+private:
+  bool exceedsFloor(uint32_t level, uint32_t floor) const;
+  void trackFloor(uint32_t level, uint32_t *floor) const;
+
+  WakeGateConfig config_;
+  WakeGateStats stats_ = {};
+  int32_t lowPass_ = 0;
+  uint32_t lowFloor_ = 0;
+  uint32_t highFloor_ = 0;
+  float prevLowLog_ = 0.0f;
+  float prevHighLog_ = 0.0f;
+  uint32_t seenBlocks_ = 0;
+  uint16_t hangover_ = 0;
+  bool windowOpen_ = false;
+};
+
+#endif // WAKE_GATE_H
@@ -1,145 +1,277 @@
 #include "base64.h"
+
+#include <stdint.h>
+#include <string.h>
+
+namespace {
+
+#ifdef BASE64_URL
+constexpr char kAlphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+#else
+constexpr char kAlphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+#endif
+
+// 12-bit pair table: entry i holds the two base64 characters for the 12-bit value i,
+// so every 3 input bytes become two lookups and two 2-byte stores instead of four
+// calls through binary_to_base64(). 8 KB, constant-initialised (flash rodata, no startup cost)
+#define B64_PAIR(i) {kAlphabet[(i) >> 6], kAlphabet[(i) & 0x3F]}
+#define B64_PAIR4(i) B64_PAIR(i), B64_PAIR((i) + 1), B64_PAIR((i) + 2), B64_PAIR((i) + 3)
+#define B64_PAIR16(i) B64_PAIR4(i), B64_PAIR4((i) + 4), B64_PAIR4((i) + 8), B64_PAIR4((i) + 12)
+#define B64_PAIR64(i) B64_PAIR16(i), B64_PAIR16((i) + 16), B64_PAIR16((i) + 32), B64_PAIR16((i) + 48)
+#define B64_PAIR256(i) B64_PAIR64(i), B64_PAIR64((i) + 64), B64_PAIR64((i) + 128), B64_PAIR64((i) + 192)
+#define B64_PAIR1024(i) B64_PAIR256(i), B64_PAIR256((i) + 256), B64_PAIR256((i) + 512), B64_PAIR256((i) + 768)
+
+const char kPairs[4096][2] = {
+  B64_PAIR1024(0), B64_PAIR1024(1024), B64_PAIR1024(2048), B64_PAIR1024(3072)
+};
+
+#undef B64_PAIR
+#undef B64_PAIR4
+#undef B64_PAIR16
+#undef B64_PAIR64
+#undef B64_PAIR256
+#undef B64_PAIR1024
+
+constexpr unsigned char decode_value(unsigned int c) {
+  return ('A' <= c && c <= 'Z') ? c - 'A'
+       : ('a' <= c && c <= 'z') ? c - 71
+       : ('0' <= c && c <= '9') ? c + 4
+#ifdef BASE64_URL
+       : c == '-' ? 62
+       : c == '_' ? 63
+#else
+       : c == '+' ? 62
+       : c == '/' ? 63
+#endif
+       : 255;
+}
+
+// Character -> 6-bit value, 255 for anything outside the alphabet
+#define B64_DEC(c) decode_value(c)
+#define B64_DEC4(c) B64_DEC(c), B64_DEC((c) + 1), B64_DEC((c) + 2), B64_DEC((c) + 3)
+#define B64_DEC16(c) B64_DEC4(c), B64_DEC4((c) + 4), B64_DEC4((c) + 8), B64_DEC4((c) + 12)
+#define B64_DEC64(c) B64_DEC16(c), B64_DEC16((c) + 16), B64_DEC16((c) + 32), B64_DEC16((c) + 48)
+
+const unsigned char kDecode[256] = {
+  B64_DEC64(0), B64_DEC64(64), B64_DEC64(128), B64_DEC64(192)
+};
+
+#undef B64_DEC
+#undef B64_DEC4
+#undef B64_DEC16
+#undef B64_DEC64
+
+inline uint32_t load_be32(const unsigned char *p) {
+  uint32_t v;
+  memcpy(&v, p, sizeof(v));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+  v = __builtin_bswap32(v);
+#elif !defined(__BYTE_ORDER__)
+  v = (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | p[3];
+#endif
+  return v;
+}
+
+inline void put_pair(char *out, uint32_t index) {
+  memcpy(out, kPairs[index], 2);
+}
+
+// 12 input bytes (three 32-bit words) -> 16 characters
+inline void encode_block12(const unsigned char *in, char *out) {
+  uint32_t w0 = load_be32(in);
+  uint32_t w1 = load_be32(in + 4);
+  uint32_t w2 = load_be32(in + 8);
+  put_pair(out,      w0 >> 20);
+  put_pair(out + 2,  (w0 >> 8) & 0xFFF);
+  put_pair(out + 4,  (w0 & 0xFF) << 4 | w1 >> 28);
+  put_pair(out + 6,  (w1 >> 16) & 0xFFF);
+  put_pair(out + 8,  (w1 >> 4) & 0xFFF);
+  put_pair(out + 10, (w1 & 0x0F) << 8 | w2 >> 24);
+  put_pair(out + 12, (w2 >> 12) & 0xFFF);
+  put_pair(out + 14, w2 & 0xFFF);
+}
+
+// groups * 3 input bytes -> groups * 4 characters, no padding and no terminator
+void encode_groups(const unsigned char *in, unsigned int groups, char *out) {
+  // 24-byte blocks: two independent 12-byte halves per iteration
+  while (groups >= 8) {
+    encode_block12(in, out);
+    encode_block12(in + 12, out + 16);
+    in += 24;
+    out += 32;
+    groups -= 8;
+  }
+  if (groups >= 4) {
+    encode_block12(in, out);
+    in += 12;
+    out += 16;
+    groups -= 4;
+  }
+  while (groups > 0) {
+    put_pair(out,     (uint32_t)in[0] << 4 | in[1] >> 4);
+    put_pair(out + 2, (uint32_t)(in[1] & 0x0F) << 8 | in[2]);
+    in += 3;
+    out += 4;
+    --groups;
+  }
+}
+
+// Final 1 or 2 bytes -> 4 characters with '=' padding
+void encode_tail(const unsigned char *in, unsigned int length, char *out) {
+  out[0] = kAlphabet[in[0] >> 2];
+  if (length == 1) {
+    out[1] = kAlphabet[(in[0] & 0x03) << 4];
+    out[2] = '=';
+  } else {
+    out[1] = kAlphabet[(in[0] & 0x03) << 4 | in[1] >> 4];
+    out[2] = kAlphabet[(in[1] & 0x0F) << 2];
+  }
+  out[3] = '=';
+}
+
+void flush_encoder(base64_encoder *encoder) {
+  if (encoder->buffer_length > 0) {
+    encoder->sink(encoder->buffer, encoder->buffer_length, encoder->context);
+    encoder->total += encoder->buffer_length;
+    encoder->buffer_length = 0;
+  }
+}
+
+} // namespace
+
 unsigned char binary_to_base64(unsigned char v) {
-    // Capital letters - 'A' is ascii 65 and base64 0
-    if(v < 26) return v + 'A';
-    
-    // Lowercase letters - 'a' is ascii 97 and base64 26
-    if(v < 52) return v + 71;
-    
-    // Digits - '0' is ascii 48 and base64 52
-    if(v < 62) return v - 4;
-    
-    #ifdef BASE64_URL
-    // '-' is ascii 45 and base64 62
-    if(v == 62) return '-';
-    #else
-    // '+' is ascii 43 and base64 62
-    if(v == 62) return '+';
-    #endif
-  
-    #ifdef BASE64_URL
-    // '_' is ascii 95 and base64 62
-    if(v == 63) return '_';
-    #else
-    // '/' is ascii 47 and base64 63
-    if(v == 63) return '/';
-    #endif
-    
-    return 64;
+  return v < 64 ? kAlphabet[v] : 64;
+}
+
+unsigned char base64_to_binary(unsigned char c) {
+  return kDecode[c];
+}
+
+unsigned int encode_base64_length(unsigned int input_length) {
+  return (input_length + 2)/3*4;
+}
+
+unsigned int decode_base64_length(const unsigned char input[]) {
+  return decode_base64_length(input, -1);
+}
+
+unsigned int decode_base64_length(const unsigned char input[], unsigned int input_length) {
+  const unsigned char *start = input;
+
+  while(kDecode[input[0]] < 64 && (unsigned int) (input - start) < input_length) {
+    ++input;
   }
-  
-  unsigned char base64_to_binary(unsigned char c) {
-    // Capital letters - 'A' is ascii 65 and base64 0
-    if('A' <= c && c <= 'Z') return c - 'A';
-    
-    // Lowercase letters - 'a' is ascii 97 and base64 26
-    if('a' <= c && c <= 'z') return c - 71;
-    
-    // Digits - '0' is ascii 48 and base64 52
-    if('0' <= c && c <= '9') return c + 4;
-    
-    #ifdef BASE64_URL
-    // '-' is ascii 45 and base64 62
-    if(c == '-') return 62;
-    #else
-    // '+' is ascii 43 and base64 62
-    if(c == '+') return 62;
-    #endif
-    
-    #ifdef BASE64_URL
-    // '_' is ascii 95 and base64 62
-    if(c == '_') return 63;
-    #else
-    // '/' is ascii 47 and base64 63
-    if(c == '/') return 63;
-    #endif
-    
-    return 255;
+
+  input_length = (unsigned int) (input - start);
+  return input_length/4*3 + (input_length % 4 ? input_length % 4 - 1 : 0);
+}
+
+unsigned int encode_base64(const unsigned char input[], unsigned int input_length, unsigned char output[]) {
+  unsigned int full_sets = input_length/3;
+  char *out = reinterpret_cast<char *>(output);
+
+  encode_groups(input, full_sets, out);
+  out += full_sets * 4;
+  if (input_length % 3) {
+    encode_tail(input + full_sets * 3, input_length % 3, out);
+    out += 4;
   }
-  
-  unsigned int encode_base64_length(unsigned int input_length) {
-    return (input_length + 2)/3*4;
+  out[0] = '\0';
+
+  return encode_base64_length(input_length);
+}
+
+unsigned int decode_base64(const unsigned char input[], unsigned char output[]) {
+  return decode_base64(input, -1, output);
+}
+
+unsigned int decode_base64(const unsigned char input[], unsigned int input_length, unsigned char output[]) {
+  unsigned int output_length = decode_base64_length(input, input_length);
+
+  // decode_base64_length() already stopped at the first character outside the alphabet,
+  // so every table lookup below is a valid 6-bit value
+  for(unsigned int i = 2; i < output_length; i += 3) {
+    uint32_t v = (uint32_t)kDecode[input[0]] << 18 | (uint32_t)kDecode[input[1]] << 12 |
+                 (uint32_t)kDecode[input[2]] << 6 | kDecode[input[3]];
+    output[0] = v >> 16;
+    output[1] = v >> 8;
+    output[2] = v;
+
+    input += 4;
+    output += 3;
   }
-  
-  unsigned int decode_base64_length(const unsigned char input[]) {
-    return decode_base64_length(input, -1);
+
+  switch(output_length % 3) {
+    case 1:
+      output[0] = kDecode[input[0]] << 2 | kDecode[input[1]] >> 4;
+      break;
+    case 2:
+      output[0] = kDecode[input[0]] << 2 | kDecode[input[1]] >> 4;
+      output[1] = kDecode[input[1]] << 4 | kDecode[input[2]] >> 2;
+      break;
   }
-  
-  unsigned int decode_base64_length(const unsigned char input[], unsigned int input_length) {
-    const unsigned char *start = input;
-    
-    while(base64_to_binary(input[0]) < 64 && (unsigned int) (input - start) < input_length) {
-      ++input;
+
+  return output_length;
+}
+
+void base64_encoder_init(base64_encoder *encoder, base64_sink sink, void *context) {
+  encoder->sink = sink;
+  encoder->context = context;
+  encoder->pending_length = 0;
+  encoder->buffer_length = 0;
+  encoder->total = 0;
+}
+
+void base64_encoder_update(base64_encoder *encoder, const unsigned char input[], unsigned int input_length) {
+  // Complete a group left over from the previous chunk
+  if (encoder->pending_length > 0) {
+    while (encoder->pending_length < 3 && input_length > 0) {
+      encoder->pending[encoder->pending_length++] = *input++;
+      --input_length;
+    }
+    if (encoder->pending_length < 3) {
+      return;
     }
-    
-    input_length = (unsigned int) (input - start);
-    return input_length/4*3 + (input_length % 4 ? input_length % 4 - 1 : 0);
+    if (encoder->buffer_length + 4 > BASE64_ENCODER_BUFFER) {
+      flush_encoder(encoder);
+    }
+    encode_groups(encoder->pending, 1, encoder->buffer + encoder->buffer_length);
+    encoder->buffer_length += 4;
+    encoder->pending_length = 0;
   }
-  
-  unsigned int encode_base64(const unsigned char input[], unsigned int input_length, unsigned char output[]) {
-    unsigned int full_sets = input_length/3;
-    
-    // While there are still full sets of 24 bits...
-    for(unsigned int i = 0; i < full_sets; ++i) {
-      output[0] = binary_to_base64(                         input[0] >> 2);
-      output[1] = binary_to_base64((input[0] & 0x03) << 4 | input[1] >> 4);
-      output[2] = binary_to_base64((input[1] & 0x0F) << 2 | input[2] >> 6);
-      output[3] = binary_to_base64( input[2] & 0x3F);
-      
-      input += 3;
-      output += 4;
+
+  // Whole groups straight from the caller's chunk into the output buffer
+  while (input_length >= 3) {
+    unsigned int room = (BASE64_ENCODER_BUFFER - encoder->buffer_length) / 4;
+    if (room == 0) {
+      flush_encoder(encoder);
+      continue;
     }
-    
-    switch(input_length % 3) {
-      case 0:
-        output[0] = '\0';
-        break;
-      case 1:
-        output[0] = binary_to_base64(                         input[0] >> 2);
-        output[1] = binary_to_base64((input[0] & 0x03) << 4);
-        output[2] = '=';
-        output[3] = '=';
-        output[4] = '\0';
-        break;
-      case 2:
-        output[0] = binary_to_base64(                         input[0] >> 2);
-        output[1] = binary_to_base64((input[0] & 0x03) << 4 | input[1] >> 4);
-        output[2] = binary_to_base64((input[1] & 0x0F) << 2);
-        output[3] = '=';
-        output[4] = '\0';
-        break;
+    unsigned int groups = input_length / 3;
+    if (groups > room) {
+      groups = room;
     }
-    
-    return encode_base64_length(input_length);
+    encode_groups(input, groups, encoder->buffer + encoder->buffer_length);
+    encoder->buffer_length += groups * 4;
+    input += groups * 3;
+    input_length -= groups * 3;
   }
-  
-  unsigned int decode_base64(const unsigned char input[], unsigned char output[]) {
-    return decode_base64(input, -1, output);
+
+  while (input_length > 0) {
+    encoder->pending[encoder->pending_length++] = *input++;
+    --input_length;
   }
-  
-  unsigned int decode_base64(const unsigned char input[], unsigned int input_length, unsigned char output[]) {
-    unsigned int output_length = decode_base64_length(input, input_length);
-    
-    // While there are still full sets of 24 bits...
-    for(unsigned int i = 2; i < output_length; i += 3) {
-      output[0] = base64_to_binary(input[0]) << 2 | base64_to_binary(input[1]) >> 4;
-      output[1] = base64_to_binary(input[1]) << 4 | base64_to_binary(input[2]) >> 2;
-      output[2] = base64_to_binary(input[2]) << 6 | base64_to_binary(input[3]);
-      
-      input += 4;
-      output += 3;
-    }
-    
-    switch(output_length % 3) {
-      case 1:
-        output[0] = base64_to_binary(input[0]) << 2 | base64_to_binary(input[1]) >> 4;
-        break;
-      case 2:
-        output[0] = base64_to_binary(input[0]) << 2 | base64_to_binary(input[1]) >> 4;
-        output[1] = base64_to_binary(input[1]) << 4 | base64_to_binary(input[2]) >> 2;
-        break;
+}
+
+unsigned int base64_encoder_finish(base64_encoder *encoder) {
+  if (encoder->pending_length > 0) {
+    if (encoder->buffer_length + 4 > BASE64_ENCODER_BUFFER) {
+      flush_encoder(encoder);
     }
-    
-    return output_length;
+    encode_tail(encoder->pending, encoder->pending_length, encoder->buffer + encoder->buffer_length);
+    encoder->buffer_length += 4;
+    encoder->pending_length = 0;
   }
-  
\ No newline at end of file
+  flush_encoder(encoder);
+  return encoder->total;
+}
@@ -14,16 +14,71 @@
 
 #define ULTRASONIC_TASK_PRIORITY 3
 #define VOICE_TASK_PRIORITY 10
-#define BUTTON_TASK_PRIORITY 1
-#define LIGHT_SENSOR_TASK_PRIORITY 1
 #define GPS_TASK_PRIORITY 1
 
 #define ULTRASONIC_TASK_STACK_SIZE 4096
-#define BUTTON_TASK_STACK_SIZE 4096
-#define LIGHT_SENSOR_TASK_STACK_SIZE 4096
 #define VOICE_TASK_STACK_SIZE (1024 * 32)
+// 只在 GPS_TEST_MODE 下单独建 GPS 任务；正常模式 GPS 轮询是传感器调度任务的作业
 #define GPS_TASK_STACK_SIZE 4096
 
+// 传感器调度任务：按键、光敏、GPS 串口轮询共用一个任务和时间轮（tick 为 SENSOR_SCHEDULER_TICK_MS）
+#define SENSOR_SCHEDULER_PRIORITY 2
+#define SENSOR_SCHEDULER_STACK_SIZE 4096
+#define SENSOR_SCHEDULER_CORE 0
+#define SENSOR_SCHEDULER_TICK_MS 10
+#define LIGHT_SENSOR_POLL_MS 1000
+// GPS 串口收完一批 NMEA（接收空闲超时）就唤醒作业解析；这里只是串口事件丢失时的兜底周期
+#define GPS_POLL_INTERVAL_MS 1000
+
+// 按键：中断边沿消抖时间、长按阈值、双击间隔（毫秒），边沿队列长度
+#define BUTTON_DEBOUNCE_MS 25
+#define BUTTON_LONG_PRESS_MS 800
+#define BUTTON_DOUBLE_PRESS_GAP_MS 250
+#define BUTTON_EDGE_QUEUE_LENGTH 32
+
+// 后台网络任务：导航轮询/GPS/设备状态上报/快速意图后台请求；导航播报的 TTS 也在该任务的完成回调里执行，栈按 HTTPS 预留
+#define NETWORK_WORKER_PRIORITY 2
+#define NETWORK_WORKER_STACK_SIZE (1024 * 16)
+#define NETWORK_WORKER_CORE 0
+#define NETWORK_WORKER_QUEUE_LENGTH 12 // 每类请求最多一个在队列里，不小于 NetworkJobKind::Count
+#define DEVICE_STATUS_INTERVAL_MS 60000
+
+// “请稍等”提示音播放任务（核心 1）：与语音任务上的 ASR、/ai 并行播放，回复就绪时中止
+#define WAIT_PROMPT_TASK_PRIORITY 5
+#define WAIT_PROMPT_TASK_STACK_SIZE 6144
+#define WAIT_PROMPT_TASK_CORE 1
+#define WAIT_PROMPT_AUDIO_ID "wait_001"
+#define WAIT_PROMPT_STOP_RETRY_MS 20
+#define WAIT_PROMPT_JOIN_TIMEOUT_MS 10000
+
+// 开机阶段：WiFi、存储、I2S、Token、唤醒词各在一个临时任务上按依赖并行初始化，完成即退出
+#define BOOT_MAX_STAGES 8
+#define BOOT_STAGE_TASK_PRIORITY 2
+#define BOOT_STAGE_STACK_SIZE 6144
+#define BOOT_TOKEN_STAGE_STACK_SIZE (1024 * 12)
+
+// 延迟日志排空任务：最低优先级，实时任务只写环不等串口
+#define DLOG_TASK_PRIORITY 1
+#define DLOG_TASK_STACK_SIZE 4096
+#define DLOG_TASK_CORE 0
+#define DLOG_RING_SLOTS 128
+#define DLOG_DRAIN_INTERVAL_MS 20
+// 1：串口输出二进制帧（tools/dlog_decode.cpp 解码），0：排空任务格式化为文本
+#ifndef DLOG_BINARY_OUTPUT
+#define DLOG_BINARY_OUTPUT 0
+#endif
+
+// 语音链路延迟追踪：环内保留的阶段数、每阶段计算 p50/p95 的最近样本数；
+// LATENCY_TRACE_UPLOAD 为 1 时每轮结束后上报 POST /v1/device/trace
+#ifndef LATENCY_TRACE_ENABLED
+#define LATENCY_TRACE_ENABLED 1
+#endif
+#define LATENCY_TRACE_SPANS 64
+#define LATENCY_TRACE_WINDOW 32
+#ifndef LATENCY_TRACE_UPLOAD
+#define LATENCY_TRACE_UPLOAD 0
+#endif
+
 #define VIBRATION_MODULE_PIN 3
 #define ULTRASONIC_TRIG_PIN 8
 #define ULTRASONIC_ECHO_PIN 18
@@ -35,8 +90,24 @@
 #define GPS_RX_PIN 17
 #define GPS_TX_PIN -1
 #define GPS_BAUD_RATE 9600
-#define GPS_UPLOAD_INTERVAL_MS 5000
 #define GPS_FIX_STALE_MS 15000
+// GPS 位置估计：局部东北平面上的匀速卡尔曼滤波，融合定位位置（按 HDOP 加权）和 RMC/VTG 速度航向，
+// 导航按查询时刻取外推位置；丢星时最多外推 GPS_ESTIMATE_MAX_COAST_MS，误差超过 GPS_ESTIMATE_MAX_ERROR_M 时不可用
+#define GPS_ESTIMATE_ACCEL_NOISE 0.5f
+#define GPS_ESTIMATE_UERE_M 4.0f
+#define GPS_ESTIMATE_MAX_COAST_MS 10000
+#define GPS_ESTIMATE_MAX_ERROR_M 30.0f
+
+// GPS 轨迹存储转发：每个有效 RMC 定位（约 1 Hz）进 PSRAM 环，攒够一批或到上传间隔时
+// delta/varint 编码后一次 POST /v1/gps/track。断网或失败时留在环里并指数退避重试；
+// 环超过 3/4 时最旧的点溢出到 LittleFS 文件，恢复后先补传文件再传环，服务端按时间戳去重
+#define GPS_TRACK_RING_POINTS 3600
+#define GPS_TRACK_BATCH_POINTS 120
+#define GPS_TRACK_UPLOAD_INTERVAL_MS 20000
+#define GPS_TRACK_RETRY_MAX_MS 300000
+#define GPS_TRACK_SPILL_MAX_BYTES (256 * 1024)
+// 溢出文件超过一半时开始抽稀，每 N 个定位只记 1 个，长时间断网时轨迹变稀而不是截断
+#define GPS_TRACK_DECIMATE 5
 
 #ifndef WIFI_SSID
 #define WIFI_SSID "YOUR_WIFI_SSID"
@@ -58,6 +129,10 @@
 #define SERVER_HTTP_TIMEOUT_MS 10000
 #endif
 
+#ifndef SERVER_WIRE_FORMAT_MSGPACK
+#define SERVER_WIRE_FORMAT_MSGPACK 0
+#endif
+
 #define GPS_TEST_MODE 0
 
 #ifndef BAIDU_CLIENT_ID
@@ -108,6 +183,59 @@
 #define LOCAL_AUDIO_PLAYBACK_SAMPLE_RATE 16000
 #endif
 
+#ifndef AUDIO_CACHE_BUDGET_BYTES
+#define AUDIO_CACHE_BUDGET_BYTES (1536UL * 1024UL)
+#endif
+
+#ifndef BAIDU_TTS_CACHE_ENABLED
+#define BAIDU_TTS_CACHE_ENABLED 1
+#endif
+
+// 设备端快速意图：问候/退出导航等直接本地应答，规则从服务端同步
+#ifndef FAST_INTENT_ENABLED
+#define FAST_INTENT_ENABLED 1
+#endif
+
+// 唤醒词级联：采集块上的能量/频谱通量门控打开时才运行分类器；能量低于阈值的窗口直接丢弃
+#ifndef WAKE_GATE_ENABLED
+#define WAKE_GATE_ENABLED 1
+#endif
+
+#ifndef WAKE_MIN_AUDIO_ENERGY
+#define WAKE_MIN_AUDIO_ENERGY 150
+#endif
+
+// 设备端路线跟随：导航开始时下载一次路线折线，本地匹配 GPS 并按距离播报；关闭后回到 30 秒轮询
+#ifndef ROUTE_FOLLOW_ENABLED
+#define ROUTE_FOLLOW_ENABLED 1
+#endif
+// 路线跟随取位置估计做地图匹配的间隔；偏航判定按连续匹配次数计，与 1 Hz 定位对齐
+#define ROUTE_FOLLOW_STEP_MS 1000
+// 本地路线指令合成/播放失败时每 ROUTE_FOLLOW_STEP_MS 重试一次，最多失败这么多次；语音链路忙碌时一直等，不计次数
+#define NAV_PROMPT_MAX_ATTEMPTS 3
+
+// 导航指令预取：提前合成的步数、每次导航写入音频缓存的字节上限、预取所需的最少空闲 PSRAM
+#ifndef NAV_PREFETCH_AHEAD
+#define NAV_PREFETCH_AHEAD 3
+#endif
+
+#ifndef NAV_PREFETCH_BUDGET_BYTES
+#define NAV_PREFETCH_BUDGET_BYTES (512UL * 1024UL)
+#endif
+
+#ifndef NAV_PREFETCH_MIN_FREE_PSRAM
+#define NAV_PREFETCH_MIN_FREE_PSRAM (512UL * 1024UL)
+#endif
+
+// 唤醒词模型逐层耗时：需在 build_flags 中加 -DEI_COMPILED_MODEL_PROFILING=1，每隔 N 次推理打印一次
+#ifndef WAKE_WORD_PROFILE_INTERVAL
+#define WAKE_WORD_PROFILE_INTERVAL 200
+#endif
+
+#define AUDIO_CACHE_MAX_ENTRIES 96
+#define AUDIO_CACHE_ETAG_MAX 48
+#define AUDIO_URL_HTTP_TIMEOUT_MS 10000
+
 #define BAIDU_TOKEN_CLIENT_TIMEOUT_SEC 8
 #define BAIDU_TOKEN_CONNECT_TIMEOUT_MS 5000
 #define BAIDU_TOKEN_HTTP_TIMEOUT_MS 8000
@@ -119,6 +247,13 @@
 #define BAIDU_TTS_HTTP_TIMEOUT_MS 15000
 #define BAIDU_TTS_DOWNLOAD_IDLE_TIMEOUT_MS 5000
 #define BAIDU_TOKEN_REFRESH_MARGIN_SEC 86400ULL
+// 主循环每隔这么久检查一次 Token 是否临近过期，需要时投递到网络任务续期
+#define BAIDU_TOKEN_REFRESH_CHECK_MS (10UL * 60UL * 1000UL)
+// Token 过期判断依赖系统时间，WiFi 初始化后启动 SNTP
+#define SNTP_SERVER_PRIMARY "ntp.aliyun.com"
+#define SNTP_SERVER_SECONDARY "pool.ntp.org"
+// 语音交互期间保持 TLS 连接的主机（TTS HTTPS 接口），多段合成复用；其余主机只缓存会话
+#define SECURE_CONN_WARM_HOST "tsn.baidu.com"
 
 #ifndef BAIDU_ACCESS_TOKEN_SEED
 #define BAIDU_ACCESS_TOKEN_SEED ""
@@ -149,18 +284,26 @@
 #define RECORD_TIME_SECONDS 10
 #define BUFFER_SIZE (SAMPLE_RATE * RECORD_TIME_SECONDS * 2)
 
+// 语音链路内存区（PSRAM，开机预留）：录音 PCM、ASR 请求体（base64 + JSON 外壳）、
+// TTS 分段下载、播放（本地 WAV 最大约 145 KB，JSON 内嵌音频解码后不超过下载区）
+#define VOICE_ARENA_CAPTURE_BYTES BUFFER_SIZE
+#define VOICE_ARENA_ENCODE_BYTES ((BUFFER_SIZE + 2) / 3 * 4 + 512)
+#ifndef VOICE_ARENA_NETWORK_BYTES
+#define VOICE_ARENA_NETWORK_BYTES (256 * 1024)
+#endif
+#ifndef VOICE_ARENA_PLAYBACK_BYTES
+#define VOICE_ARENA_PLAYBACK_BYTES (256 * 1024)
+#endif
+
 #define EIDSP_QUANTIZE_FILTERBANK 0
 #define LED_BUILT_IN 21
 
 extern bool isConnectedToWifi;
 
 extern TaskHandle_t ultrasonicTaskHandle;
-extern TaskHandle_t buttonTaskHandle;
-extern TaskHandle_t lightSensorTaskHandle;
 extern TaskHandle_t voiceTaskHandle;
 extern TaskHandle_t gpsTaskHandle;
 
 extern bool record_status_me;
-extern String accessToken;
 
 #endif // CONFIG_H
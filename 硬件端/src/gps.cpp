@@ -1,97 +1,107 @@
 #include "gps.h"
 
 #include <HardwareSerial.h>
+#include <math.h>
 #include <string.h>
 
 #include "config.h"
 #include "network.h"
+#include "services/sensor_scheduler.h"
+#include "services/track_store.h"
+#include "utils/deferred_log.h"
+#include "utils/nmea_parser.h"
 
 namespace
 {
-HardwareSerial gpsSerial(1);
-GpsFix latestFix = {0.0, 0.0, false, 0, ""};
-char sentenceBuffer[128];
-size_t sentenceIndex = 0;
+// 9600 波特每秒约 960 字节；兜底周期内串口事件丢了也不会溢出
+const size_t kUartRxBufferSize = 2048;
 
-double nmeaToDecimal(const char *value)
-{
-    double raw = atof(value);
-    int degrees = static_cast<int>(raw / 100);
-    double minutes = raw - (degrees * 100);
-    return degrees + minutes / 60.0;
-}
-
-void updateFix(const char *utcTime, const char *latValue, const char *ns, const char *lonValue, const char *ew)
+HardwareSerial gpsSerial(1);
+NmeaParser nmeaParser; // 只在读串口的任务（调度任务或测试任务）上使用
+portMUX_TYPE fixMux = portMUX_INITIALIZER_UNLOCKED;
+GpsFix latestFix = {};
+PositionFilter positionFilter;   // 只在读串口的任务上更新
+PositionFilter publishedFilter;  // fixMux 保护的副本，供其他任务外推
+unsigned long lastWaitingLogTime = 0;
+volatile int wakeJob = -1;
+volatile TaskHandle_t wakeTask = nullptr;
+
+// 串口事件任务里执行：一批 NMEA 收完（接收空闲超时）后唤醒读串口的一方
+void onUartReceive()
 {
-    if (!latValue || !lonValue || !ns || !ew || !utcTime)
+    int job = wakeJob;
+    if (job >= 0)
     {
+        sensorSchedulerKick(job);
         return;
     }
-
-    double latitude = nmeaToDecimal(latValue);
-    double longitude = nmeaToDecimal(lonValue);
-
-    if (ns[0] == 'S')
-    {
-        latitude = -latitude;
-    }
-    if (ew[0] == 'W')
+    TaskHandle_t task = wakeTask;
+    if (task != nullptr)
     {
-        longitude = -longitude;
+        xTaskNotifyGive(task);
     }
-
-    latestFix.latitude = latitude;
-    latestFix.longitude = longitude;
-    latestFix.valid = true;
-    latestFix.updatedAt = millis();
-    latestFix.utcTime = utcTime;
-
-    Serial.printf("[GPS] Valid fix parsed | lat=%.6f lon=%.6f utc=%s\n",
-                  latestFix.latitude, latestFix.longitude, latestFix.utcTime.c_str());
 }
 
-void parseRmcSentence(char *sentence)
+void resetFix(GpsFix &fix)
 {
-    char *fields[16] = {0};
-    int fieldCount = 0;
-
-    char *context = nullptr;
-    char *token = strtok_r(sentence, ",", &context);
-    while (token != nullptr && fieldCount < 16)
-    {
-        fields[fieldCount++] = token;
-        token = strtok_r(nullptr, ",", &context);
-    }
-
-    if (fieldCount < 7)
-    {
-        return;
-    }
-
-    if (strcmp(fields[2], "A") != 0)
-    {
-        latestFix.valid = false;
-        return;
-    }
-
-    updateFix(fields[1], fields[3], fields[4], fields[5], fields[6]);
+    memset(&fix, 0, sizeof(fix));
+    fix.altitudeM = NAN;
+    fix.speedKmh = NAN;
+    fix.courseDeg = NAN;
+    fix.hdop = NAN;
 }
 
-void processSentence(char *sentence)
+// 解析器状态合并进对外的定位快照；只有 RMC/GGA 带来有效位置时才刷新 updatedAt
+void publishFix(uint8_t decoded)
 {
-    if (sentence[0] != '$')
-    {
-        return;
-    }
+    const NmeaFix &nmea = nmeaParser.fix();
+    bool positionSentence = (decoded & (NmeaParser::Rmc | NmeaParser::Gga)) != 0;
+    unsigned long now = millis();
+    int64_t utcMs = nmeaUtcToEpochMs(nmea.utcDate, nmea.utcTime);
 
-    if (strlen(sentence) < 6)
+    portENTER_CRITICAL(&fixMux);
+    if (positionSentence)
     {
-        return;
+        latestFix.valid = nmea.positionValid;
+        if (nmea.positionValid)
+        {
+            latestFix.latitude = nmea.latitude;
+            latestFix.longitude = nmea.longitude;
+            latestFix.updatedAt = now;
+        }
     }
-
-    if (sentence[3] == 'R' && sentence[4] == 'M' && sentence[5] == 'C')
+    latestFix.altitudeM = nmea.altitudeM;
+    latestFix.speedKmh = nmea.speedKmh;
+    latestFix.courseDeg = nmea.courseDeg;
+    latestFix.hdop = nmea.hdop;
+    latestFix.satellites = nmea.satellites;
+    latestFix.quality = nmea.quality;
+    latestFix.fixMode = nmea.fixMode;
+    memcpy(latestFix.utcTime, nmea.utcTime, sizeof(latestFix.utcTime));
+    memcpy(latestFix.utcDate, nmea.utcDate, sizeof(latestFix.utcDate));
+    latestFix.utcMs = utcMs > 0 ? utcMs : 0;
+    GpsFix snapshot = latestFix;
+    portEXIT_CRITICAL(&fixMux);
+
+    if ((decoded & NmeaParser::Rmc) != 0 && nmea.positionValid)
     {
-        parseRmcSentence(sentence);
+        // 每个 RMC 一次观测（同一批里的 GGA/VTG 已先合并进 HDOP 和速度航向），滤波在锁外算完再发布
+        bool accepted = positionFilter.update(now, nmea.latitude, nmea.longitude, nmea.hdop, nmea.speedKmh,
+                                              nmea.courseDeg);
+        portENTER_CRITICAL(&fixMux);
+        publishedFilter = positionFilter;
+        portEXIT_CRITICAL(&fixMux);
+        if (!accepted)
+        {
+            Serial.printf("[GPS] Fix rejected as a jump | lat=%.6f lon=%.6f hdop=%.1f\n",
+                          nmea.latitude, nmea.longitude, nmea.hdop);
+        }
+
+        // 每个有效 RMC（约 1 Hz）记一个轨迹点，批量上传由 trackStoreServiceTick 决定
+        trackStoreRecord(snapshot);
+        Serial.printf("[GPS] Valid fix parsed | lat=%.6f lon=%.6f utc=%s sats=%u hdop=%.1f speed=%.1fkm/h\n",
+                      nmea.latitude, nmea.longitude, nmea.utcTime, static_cast<unsigned>(nmea.satellites),
+                      nmea.hdop, nmea.speedKmh);
     }
 }
 } // namespace
@@ -102,100 +112,138 @@ void gpsInit()
     Serial.printf("[GPS] About to start UART1 with RX=%d, TX=%d, baud=%d\n", GPS_RX_PIN, GPS_TX_PIN, GPS_BAUD_RATE);
     Serial.flush();
 
+    // 缓冲区大小必须在 begin 之前设置；onReceive 只在接收空闲超时（一批语句收完）时回调
+    gpsSerial.setRxBufferSize(kUartRxBufferSize);
+    gpsSerial.onReceive(onUartReceive, true);
     gpsSerial.begin(GPS_BAUD_RATE, SERIAL_8N1, GPS_RX_PIN, GPS_TX_PIN);
-    sentenceIndex = 0;
-    latestFix = {0.0, 0.0, false, 0, ""};
+    nmeaParser.reset();
+    trackStoreBegin();
+    PositionFilterConfig filterConfig;
+    filterConfig.accelNoise = GPS_ESTIMATE_ACCEL_NOISE;
+    filterConfig.uereMeters = GPS_ESTIMATE_UERE_M;
+    filterConfig.maxCoastMs = GPS_ESTIMATE_MAX_COAST_MS;
+    filterConfig.maxErrorMeters = GPS_ESTIMATE_MAX_ERROR_M;
+    positionFilter = PositionFilter(filterConfig);
+    portENTER_CRITICAL(&fixMux);
+    resetFix(latestFix);
+    publishedFilter = positionFilter;
+    portEXIT_CRITICAL(&fixMux);
 
     Serial.printf("[GPS] UART1 started successfully | RX=%d TX=%d baud=%d\n", GPS_RX_PIN, GPS_TX_PIN, GPS_BAUD_RATE);
     Serial.flush();
 }
 
+void gpsSetWakeJob(int jobId)
+{
+    wakeJob = jobId;
+}
+
 void gpsPoll()
 {
-    while (gpsSerial.available() > 0)
+    uint8_t decoded = 0;
+    int available = gpsSerial.available();
+    while (available > 0)
     {
-        char c = static_cast<char>(gpsSerial.read());
-
-        if (c == '\r')
+        // 零拷贝：串口驱动的环形缓冲区直接读进解析器的行缓冲区，完整语句原地解析
+        size_t room = 0;
+        char *dest = nmeaParser.writeBuffer(&room);
+        size_t want = static_cast<size_t>(available) < room ? static_cast<size_t>(available) : room;
+        size_t got = gpsSerial.read(reinterpret_cast<uint8_t *>(dest), want);
+        if (got == 0)
         {
-            continue;
-        }
-
-        if (c == '\n')
-        {
-            sentenceBuffer[sentenceIndex] = '\0';
-            if (sentenceIndex > 0)
-            {
-                processSentence(sentenceBuffer);
-            }
-            sentenceIndex = 0;
-            continue;
+            break;
         }
+        decoded |= nmeaParser.commit(got);
+        available = gpsSerial.available();
+    }
 
-        if (sentenceIndex < sizeof(sentenceBuffer) - 1)
-        {
-            sentenceBuffer[sentenceIndex++] = c;
-        }
-        else
-        {
-            sentenceIndex = 0;
-        }
+    if (decoded != 0)
+    {
+        publishFix(decoded);
     }
 }
 
 bool gpsHasValidFix()
 {
-    return latestFix.valid && (millis() - latestFix.updatedAt) <= GPS_FIX_STALE_MS;
+    portENTER_CRITICAL(&fixMux);
+    bool valid = latestFix.valid;
+    unsigned long updatedAt = latestFix.updatedAt;
+    portEXIT_CRITICAL(&fixMux);
+    return valid && (millis() - updatedAt) <= GPS_FIX_STALE_MS;
 }
 
 GpsFix gpsGetLatestFix()
 {
-    return latestFix;
+    portENTER_CRITICAL(&fixMux);
+    GpsFix copy = latestFix;
+    portEXIT_CRITICAL(&fixMux);
+    return copy;
 }
 
-void gpsTask(void *pvParameters)
+PositionEstimate gpsEstimatePosition(unsigned long atMs)
 {
-    (void)pvParameters;
-    unsigned long lastUploadTime = 0;
-    unsigned long lastWaitingLogTime = 0;
+    portENTER_CRITICAL(&fixMux);
+    PositionFilter copy = publishedFilter;
+    portEXIT_CRITICAL(&fixMux);
+    return copy.estimate(static_cast<uint32_t>(atMs));
+}
 
-    Serial.printf("[GPS] Task started | UART1 RX=%d TX=%d baud=%d upload=%dms\n",
-                  GPS_RX_PIN, GPS_TX_PIN, GPS_BAUD_RATE, GPS_UPLOAD_INTERVAL_MS);
+void gpsEstimateCounters(uint32_t *accepted, uint32_t *rejected, uint32_t *resets)
+{
+    portENTER_CRITICAL(&fixMux);
+    *accepted = publishedFilter.accepted();
+    *rejected = publishedFilter.rejected();
+    *resets = publishedFilter.resets();
+    portEXIT_CRITICAL(&fixMux);
+}
 
-    while (true)
-    {
-        gpsPoll();
+void gpsReportStats()
+{
+    PositionEstimate estimate = gpsEstimatePosition(millis());
+    uint32_t accepted = 0;
+    uint32_t rejected = 0;
+    uint32_t resets = 0;
+    gpsEstimateCounters(&accepted, &rejected, &resets);
+    DLOG(0, "[位置估计] %s, 误差 %.1f 米, 距定位 %u ms, 速度 %.1f km/h 航向 %.0f\n",
+         estimate.valid ? "可用" : "不可用", estimate.errorMeters, estimate.ageMs, estimate.speedKmh,
+         estimate.courseDeg);
+    DLOG(0, "[位置估计] 接受: %u, 跳点丢弃: %u, 重置: %u\n", accepted, rejected, resets);
+}
+
+void gpsServiceTick()
+{
+    gpsPoll();
+    // 轨迹始终在记录；有网时按批上传，断网时留在环里或溢出到文件，恢复后补传
+    trackStoreServiceTick();
 
-        if (gpsHasValidFix() && isConnectedToWifi)
+    if (!(gpsHasValidFix() && isConnectedToWifi) && millis() - lastWaitingLogTime >= 5000)
+    {
+        lastWaitingLogTime = millis();
+        if (!isConnectedToWifi)
         {
-            unsigned long now = millis();
-            if (now - lastUploadTime >= GPS_UPLOAD_INTERVAL_MS)
-            {
-                GpsFix fix = gpsGetLatestFix();
-                if (sendGpsData(fix.latitude, fix.longitude))
-                {
-                    lastUploadTime = now;
-                    Serial.printf("[GPS] Upload success | lat=%.6f lon=%.6f\n", fix.latitude, fix.longitude);
-                }
-                else
-                {
-                    Serial.printf("[GPS] Upload failed | lat=%.6f lon=%.6f\n", fix.latitude, fix.longitude);
-                }
-            }
+            TrackStoreStats track = trackStoreStats();
+            Serial.printf("[GPS] Waiting for WiFi, buffering fixes (%u in memory, %u bytes spilled)...\n",
+                          static_cast<unsigned>(track.ringSize), static_cast<unsigned>(track.spillBytes));
         }
-        else if (millis() - lastWaitingLogTime >= 5000)
+        else
         {
-            lastWaitingLogTime = millis();
-            if (!isConnectedToWifi)
-            {
-                Serial.println("[GPS] Waiting for WiFi before uploading fixes...");
-            }
-            else
-            {
-                Serial.println("[GPS] Waiting for a fresh valid NMEA fix...");
-            }
+            Serial.println("[GPS] Waiting for a fresh valid NMEA fix...");
         }
+    }
+}
 
-        vTaskDelay(pdMS_TO_TICKS(200));
+void gpsTask(void *pvParameters)
+{
+    (void)pvParameters;
+
+    Serial.printf("[GPS] Task started | UART1 RX=%d TX=%d baud=%d upload=%dms\n",
+                  GPS_RX_PIN, GPS_TX_PIN, GPS_BAUD_RATE, GPS_TRACK_UPLOAD_INTERVAL_MS);
+
+    // 测试模式没有调度任务，串口事件直接通知本任务
+    wakeTask = xTaskGetCurrentTaskHandle();
+    while (true)
+    {
+        gpsServiceTick();
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(GPS_POLL_INTERVAL_MS));
     }
 }
@@ -3,19 +3,44 @@
 
 #include <Arduino.h>
 
+#include "utils/position_filter.h"
+
+// 最近一次定位（按值拷贝，无堆内存）。数值字段未知时为 NAN
 struct GpsFix
 {
     double latitude;
     double longitude;
     bool valid;
-    unsigned long updatedAt;
-    String utcTime;
+    unsigned long updatedAt; // 最近一次有效位置的 millis()
+    float altitudeM;
+    float speedKmh;
+    float courseDeg;
+    float hdop;
+    uint8_t satellites;
+    uint8_t quality; // GGA 定位质量
+    uint8_t fixMode; // GSA：1 无定位 2 二维 3 三维
+    char utcTime[11];
+    char utcDate[7];
+    int64_t utcMs; // RMC 日期+时间的 Unix 纪元毫秒，未知为 0
 };
 
 void gpsInit();
+// 把串口里已到的字节直接读进 NMEA 解析器并更新定位
 void gpsPoll();
 bool gpsHasValidFix();
 GpsFix gpsGetLatestFix();
+// 滤波后的位置按 atMs（millis）外推：定位之间平滑插值，丢星时短时推算；valid 为假时不要用于导航
+PositionEstimate gpsEstimatePosition(unsigned long atMs);
+// 位置估计的累计计数：接受的定位、被当作跳点丢弃的定位、重置次数
+void gpsEstimateCounters(uint32_t *accepted, uint32_t *rejected, uint32_t *resets);
+// 当前位置估计和上面的计数，经 DLOG 输出
+void gpsReportStats();
+// 串口收到一批数据（接收空闲超时）时提前唤醒的传感器调度作业
+void gpsSetWakeJob(int jobId);
+// 读串口、记录轨迹并按需投递批量上传，不阻塞；正常模式由传感器调度任务在串口有数据时调用，
+// GPS_POLL_INTERVAL_MS 只是兜底周期
+void gpsServiceTick();
+// 仅 GPS_TEST_MODE 使用的独立任务
 void gpsTask(void *pvParameters);
 
 #endif // GPS_H
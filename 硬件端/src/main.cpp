@@ -9,6 +9,8 @@
 #include <HTTPClient.h>
 #include <ArduinoJson.h>
 #include <driver/i2s.h>
+#include <esp_heap_caps.h>
+#include <new>
 #include <_3_inferencing.h>
 #include <HCSR04.h>
 
@@ -20,14 +22,31 @@
 
 // 项目头文件
 #include "app_state.h"
+#include "audio/audio_cache.h"
 #include "audio/local_audio.h"
+#include "audio/remote_audio.h"
+#include "audio/wait_prompt.h"
+#include "audio/wake_gate.h"
 #include "config.h"
 #include "gps.h"
 #include "network.h"
+#include "sensors/button_manager.h"
+#include "services/boot_sequencer.h"
+#include "services/fast_intent.h"
+#include "services/nav_prefetch.h"
+#include "services/network_worker.h"
+#include "services/route_follower.h"
+#include "services/secure_conn.h"
+#include "services/sensor_scheduler.h"
 #include "services/server_api.h"
+#include "services/track_store.h"
 #include "speech/baidu_asr.h"
+#include "speech/baidu_token.h"
 #include "speech/baidu_tts.h"
+#include "utils/deferred_log.h"
 #include "utils/json_helper.h"
+#include "utils/latency_trace.h"
+#include "utils/voice_arena.h"
 #include "voice.h"
 
 // ==================== 宏定义 ====================
@@ -45,6 +64,7 @@ typedef struct
   uint8_t buf_ready;  // 缓冲区就绪标志
   uint32_t buf_count; // 当前缓冲区计数
   uint32_t n_samples; // 采样数量
+  bool gate_open;     // 本窗口是否通过能量/通量门控
 } inference_t;
 
 // ==================== 全局变量 ====================
@@ -60,15 +80,50 @@ static bool record_status = true; // 录音状态标志
 static volatile bool voiceInteractionRequested = false;
 static volatile bool voiceInteractionInProgress = false;
 static volatile bool audioPlaybackInProgress = false;
+// 双击按键：由语音任务重播最近一次 TTS 播报
+static volatile bool repeatSpeechRequested = false;
+static portMUX_TYPE lastSpokenMux = portMUX_INITIALIZER_UNLOCKED;
+static char lastSpokenText[512] = {0};
 static TaskHandle_t captureSamplesTaskHandle = NULL;
 static unsigned long voiceTriggerCooldownUntil = 0;
 static const unsigned long VOICE_TRIGGER_COOLDOWN_MS = 2000;
 
+// 唤醒词级联第一级：采集任务逐块更新，门控关闭的窗口不跑 MFCC+CNN
+static WakeGate wakeGate;
+static uint32_t wakeWindowCount = 0;     // 已就绪的推理窗口数
+static uint32_t wakeClassifierRuns = 0;  // 实际调用 run_classifier 的次数
+
 // 导航状态管理变量
 static bool navigationActive = false;        // 导航是否激活
 static String currentDestination = "";       // 当前目的地
 static unsigned long lastNavigationUpdate = 0; // 上次导航更新时间
 static const unsigned long NAVIGATION_UPDATE_INTERVAL = 30000; // 导航更新间隔(30秒)
+static volatile uint32_t navigationGeneration = 0; // 每次开始/结束导航递增，丢弃旧导航的异步结果
+// 语音任务（开始/结束导航）、网络任务（导航更新/路线回调）和主循环（轮询）都会改导航状态：
+// 激活标志、代次、目的地、路线请求和预取队列的写入，以及异步结果按代次的校验，都在这把锁里做。
+// 加锁顺序：navigationMutex 在 routeMutex、navSpeechMutex 之前
+static SemaphoreHandle_t navigationMutex = NULL;
+static unsigned long lastDeviceStatusReport = 0;
+
+// 设备端路线跟随：路线在网络任务上加载，主循环逐个 GPS 定位匹配，两边用互斥锁串行
+static RouteFollower *routeFollower = nullptr;
+static SemaphoreHandle_t routeMutex = NULL;
+static unsigned long lastRouteFixAt = 0; // 上次送入匹配的 millis()，每 ROUTE_FOLLOW_STEP_MS 送一次位置估计
+
+// 导航播报转交语音任务：网络任务的回调和主循环只把内容放进这里，合成/播放和 audioPlaybackInProgress 的置位都在语音任务上，
+// 网络任务不会被 TTS/I2S 占住，忙碌判断和置位也不再跨任务竞争
+static SemaphoreHandle_t navSpeechMutex = NULL;
+static volatile bool navUpdateSpeechPending = false;
+static ServerResponse navUpdateSpeech;           // 最近一次服务端导航响应，新的覆盖旧的
+static uint32_t navUpdateSpeechGeneration = 0;
+// 本地路线指令留在槽里直到真正播出：语音链路忙时一直等，合成/播放失败隔 ROUTE_FOLLOW_STEP_MS 重试，
+// 新的一步覆盖旧的
+static volatile bool navPromptSpeechPending = false;
+static char navPromptSpeech[192] = {0};          // 本地路线指令文本
+static uint32_t navPromptSpeechGeneration = 0;
+static int navPromptSpeechStep = -1;
+static uint8_t navPromptSpeechAttempts = 0;      // 已失败的播放次数
+static unsigned long navPromptSpeechLastAttempt = 0;
 
 static bool shouldPauseWakeAudioCapture()
 {
@@ -87,6 +142,7 @@ static void resetWakeInferenceBuffer()
 {
   inference.buf_count = 0;
   inference.buf_ready = 0;
+  wakeGate.discardWindow();
 }
 
 // ==================== 函数声明 ====================
@@ -97,7 +153,8 @@ void initVibrationAndBuzzer(); // 振动模块和蜂鸣器初始化
 void initButtonPins();         // 按钮引脚初始化
 void initLightSensorPins();    // 光敏传感器引脚初始化
 void initLEDPins();            // LED引脚初始化
-void initWakeWordSystem();     // 唤醒词系统初始化
+bool initWakeWordSystem();     // 唤醒词系统初始化
+void registerBootStages();     // 登记并行的开机阶段
 
 // FreeRTOS任务管理
 void setupTasks();       // 创建FreeRTOS任务
@@ -107,9 +164,12 @@ void printTaskInfo();    // 打印任务信息
 
 // 硬件功能任务
 void ultrasonicTask(void *pvParameters);  // 超声波检测任务
-void buttonTask(void *parameter);         // 按钮检测任务
-void lightSensorTask(void *pvParameters); // 光敏传感器任务
-void gpsTask(void *pvParameters);         // GPS任务
+void gpsTask(void *pvParameters);         // GPS任务（仅 GPS_TEST_MODE）
+
+// 传感器调度作业（运行在传感器调度任务上，不能阻塞）
+void onButtonGesture(ButtonGesture gesture); // 按键手势分发
+void lightSensorJob(void *context);          // 光敏传感器轮询
+void gpsJob(void *context);                  // GPS串口轮询与上报
 
 // 超声波相关函数
 bool testHCSR04BasicFunction();          // 测试HCSR04基础功能
@@ -117,7 +177,9 @@ float measureUltrasonicDistance();       // 使用HCSR04库测量超声波距离
 void triggerObstacleAlert(float distance); // 触发障碍物警报
 
 // 按钮相关函数
-void handleButtonPress(); // 处理按钮按下事件
+void handleButtonPress();       // 单击：启动语音交互
+void handleButtonLongPress();   // 长按：中止当前播报
+void handleButtonDoublePress(); // 双击：重播最近一次播报
 
 // 光敏传感器相关函数
 bool checkLightCondition();        // 检查光线条件
@@ -137,17 +199,22 @@ void resetRecordStatus();
 bool isValidRecording(size_t recordingSize);                                                                                     // 检查录音有效性
 void playWaitPrompt();                                                                                                           // 播放处理中提示音
 void speakServerResponse(const ServerResponse &serverResponse);                                                                  // 播放服务端新响应
+bool handleFastIntent(const String &recognizedText, String *response, bool *serverRequested);                                    // 设备端快速意图
 
 // 导航相关函数
 void startNavigation(String destination);     // 启动导航
+void endNavigationLocally();                  // 本地结束导航：作废在途结果、清空路线和预取、回到空闲
 void updateNavigationStatus();                // 更新导航状态
-void stopNavigation();                        // 停止导航
+void playPendingNavigationSpeech();           // 语音任务空闲时播放网络任务转交的导航播报
 void checkNavigationUpdate();                 // 检查是否需要更新导航
+bool followNavigationRoute();                 // 本地路线跟随，返回 false 时回退到服务端轮询
+void checkDeviceStatusReport();               // 定期投递设备状态上报
+void checkTokenRefresh();                     // Token 临近过期时投递后台续期
 
 // 唤醒词推理相关
 void performWakeWordInference();                          // 执行唤醒词推理
 void printInferenceResults(ei_impulse_result_t *result);  // 打印推理结果
-void checkWakeWordDetection(ei_impulse_result_t *result); // 检查唤醒词检测
+void checkWakeWordDetection(ei_impulse_result_t *result, uint32_t audioEnergy); // 检查唤醒词检测
 void handleWakeWordDetected();                            // 处理唤醒词检测事件
 
 // 音频推理系统函数
@@ -166,20 +233,24 @@ void playAudio_Zai(); // 播放唤醒响应音频
 // ==================== 主程序入口 ====================
 /**
  * @brief 系统初始化函数
- * 按顺序初始化各个模块和组件
+ * 硬件和避障相关任务在这里顺序启动，联网、存储、音频、唤醒词交给开机阶段并行初始化
  */
 void setup()
 {
   setAppState(BOOTING);
   // 串口初始化
   Serial.begin(115200);
+  dlogStart();
   ei_printf("\n=== 星辰引路者 - 智能导盲杖启动 ===\n");
   ei_printf("基于ESP32-S3的多模态智能导盲系统\n");
   ei_printf("版本: v1.0\n");
   ei_printf("========================================\n");
 
+  // 语音链路的大缓冲区在其他 PSRAM 分配之前一次性预留，之后每轮交互不再分配
+  voiceArenaBegin();
+
   // 1. 硬件初始化
-  ei_printf("[1/5] 初始化硬件模块...\n");
+  ei_printf("[1/3] 初始化硬件模块...\n");
   initHardware();
   
   // 1.5. HCSR04硬件测试
@@ -194,87 +265,162 @@ void setup()
   //   ei_printf("  ✗ HCSR04超声波模块测试失败，请检查硬件连接\n");
   // }
 
-  // 2. 网络初始化
-  ei_printf("[2/5] 初始化WiFi连接...\n");
+  // 2. 避障、按键等安全相关任务最先启动，不等网络和语音
+#if GPS_TEST_MODE
+  ei_printf("[2/3] 启动FreeRTOS任务...\n");
+  ei_printf("  [GPS TEST MODE] 已启用，仅保留 GPS 主链路，语音/超声波/按钮/光敏任务将被屏蔽。\n");
+#else
+  ei_printf("[2/3] 启动FreeRTOS任务（避障优先）...\n");
+#endif
+  ei_printf("[GPS] 即将执行 gpsInit()...\n");
+  gpsInit();
+  ei_printf("[GPS] gpsInit() 已返回，准备启动任务...\n");
+  navigationMutex = xSemaphoreCreateMutex();
+  navSpeechMutex = xSemaphoreCreateMutex();
+  setupTasks();
+
+  if (!networkWorkerStart())
+  {
+    ei_printf("  ✗ 后台网络任务启动失败，导航/GPS/状态上报不可用\n");
+  }
+
+#if ROUTE_FOLLOW_ENABLED
+  routeMutex = xSemaphoreCreateMutex();
+  void *routeMemory = heap_caps_malloc(sizeof(RouteFollower), MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+  if (routeMemory == nullptr)
+  {
+    routeMemory = malloc(sizeof(RouteFollower));
+  }
+  if (routeMutex != NULL && routeMemory != nullptr)
+  {
+    routeFollower = new (routeMemory) RouteFollower();
+  }
+  else
+  {
+    ei_printf("  ✗ 路线跟随初始化失败，导航改用服务端轮询\n");
+  }
+#endif
+
+  // 3. WiFi、存储、音频、百度Token、唤醒词按依赖在后台并行初始化，setup() 不再阻塞
+  ei_printf("[3/3] 后台并行初始化 WiFi/存储/音频/百度Token/唤醒词...\n");
+  registerBootStages();
+  if (!bootSequencerStart())
+  {
+    ei_printf("  ! 部分开机阶段未能创建任务，已在 setup() 中顺序执行\n");
+  }
+
+  ei_printf("\n=== setup 完成，避障已运行，语音功能就绪后提示 ===\n");
+}
+
+// ==================== 开机阶段 ====================
+// 阶段 id 由 registerBootStages 登记时分配
+static int bootWifiStage = -1;
+#if !GPS_TEST_MODE
+static int bootStorageStage = -1;
+static int bootAudioStage = -1;
+static int bootTokenStage = -1;
+static int bootWakeStage = -1;
+#endif
+
+static bool runWifiStage()
+{
   setAppState(WIFI_CONNECTING);
   initWiFi();
   if (WiFi.status() == WL_CONNECTED)
   {
     ei_printf("  ✓ WiFi初始化完成\n");
+    return true;
   }
-  else
+  ei_printf("  ! WiFi当前未完全连通，自动重连在后台继续\n");
+  return false;
+}
+
+#if !GPS_TEST_MODE
+static bool runStorageStage()
+{
+  bool ok = initLocalAudioStorage();
+  if (ok)
   {
-    ei_printf("  ! WiFi当前未完全连通，下一步将阻塞等待百度Token并持续重试\n");
+    trackStoreAttachStorage();
   }
+  ok = audioCacheInit() && ok;
+  ok = fastIntentInit() && ok;
+  return ok;
+}
 
-  // 3. 百度语音令牌初始化
-#if GPS_TEST_MODE
-  ei_printf("[3/5] GPS测试模式下跳过百度语音令牌获取...\n");
-#else
-  ei_printf("[3/6] 获取百度语音服务令牌...\n");
-  accessToken = waitForAccessToken_baidu();
+static bool runAudioStage()
+{
+  set_i2s();
+  return true;
+}
+
+static bool runTokenStage()
+{
+  // NVS 缓存命中时不用等网络；否则等 WiFi 阶段结束再联网获取（其间 WiFi 由 initWiFi 独占）
+  String token = loadCachedAccessToken_baidu();
+  if (token.length() == 0)
+  {
+    bootStagesDone(BOOT_STAGE_BIT(bootWifiStage), portMAX_DELAY);
+    token = waitForAccessToken_baidu();
+  }
+  baiduTokenSet(token);
   ei_printf("  ✓ 百度语音服务初始化成功\n");
-#endif
+  return true;
+}
 
-  // 4. 音频系统初始化
-#if GPS_TEST_MODE
-  ei_printf("[4/5] 初始化功能模块...\n");
-  ei_printf("  [GPS TEST MODE] 已启用，仅保留 GPS 主链路，语音/超声波/按钮/光敏任务将被屏蔽。\n");
-#else
-  ei_printf("[4/6] 初始化功能模块...\n");
-  set_i2s();
-  initLocalAudioStorage();
-#endif
+static bool runWakeStage()
+{
+  return initWakeWordSystem();
+}
 
-  ei_printf("[GPS] 即将执行 gpsInit()...\n");
-  gpsInit();
-  ei_printf("[GPS] gpsInit() 已返回，准备启动任务...\n");
+static bool runRulesStage()
+{
+  fastIntentSyncRulesAsync();
+  return true;
+}
 
-  // 5. 启动FreeRTOS任务
-#if GPS_TEST_MODE
-  ei_printf("[5/5] 启动FreeRTOS任务...\n");
-#else
-  ei_printf("[5/6] 启动FreeRTOS任务...\n");
+static bool runVoiceReadyStage()
+{
+  bool ok = bootStageOk(bootAudioStage) && bootStageOk(bootWakeStage);
+  bootMarkMilestone(BootMilestone::VoiceReady);
+  setAppState(IDLE);
+  if (!ok)
+  {
+    ei_printf("  ! 音频或唤醒词初始化失败，仅按键可触发语音交互\n");
+  }
+  return ok;
+}
 #endif
-  setupTasks();
 
-  // 6. 完成剩余初始化
-#if GPS_TEST_MODE
-  ei_printf("[5/5] 完成剩余初始化...\n");
-#else
-  ei_printf("[6/6] 完成剩余初始化...\n");
-#endif
+void registerBootStages()
+{
+  bootWifiStage = bootStageAdd("wifi", runWifiStage, 0, BOOT_STAGE_STACK_SIZE);
 #if GPS_TEST_MODE
   ei_printf("  [GPS TEST MODE] 已跳过语音服务和唤醒词初始化。\n");
-#endif
-
-  ei_printf("\n=== 系统初始化完成 ===\n");
-
-  // FreeRTOS超声波模块测试
-  // ei_printf("\n[测试] 验证FreeRTOS超声波功能...\n");
-  // vTaskDelay(pdMS_TO_TICKS(1000)); // 等待1秒让系统稳定
-
-  // 唤醒词推理系统初始化
-#if !GPS_TEST_MODE
-  initWakeWordSystem();
-#endif
   setAppState(IDLE);
+#else
+  bootStorageStage = bootStageAdd("storage", runStorageStage, 0, BOOT_STAGE_STACK_SIZE);
+  bootAudioStage = bootStageAdd("audio", runAudioStage, 0, BOOT_STAGE_STACK_SIZE);
+  bootTokenStage = bootStageAdd("token", runTokenStage, 0, BOOT_TOKEN_STAGE_STACK_SIZE);
+  // 唤醒词采集任务读 I2S_NUM_0，必须在 set_i2s 之后
+  bootWakeStage = bootStageAdd("wake", runWakeStage, BOOT_STAGE_BIT(bootAudioStage), BOOT_STAGE_STACK_SIZE);
+  bootStageAdd("rules", runRulesStage, BOOT_STAGE_BIT(bootWifiStage) | BOOT_STAGE_BIT(bootStorageStage),
+               BOOT_STAGE_STACK_SIZE);
+  bootStageAdd("voice", runVoiceReadyStage,
+               BOOT_STAGE_BIT(bootStorageStage) | BOOT_STAGE_BIT(bootAudioStage) | BOOT_STAGE_BIT(bootTokenStage) |
+                   BOOT_STAGE_BIT(bootWakeStage),
+               BOOT_STAGE_STACK_SIZE);
+#endif
 }
 
 
 /**
  * @brief 初始化唤醒词推理系统
  */
-void initWakeWordSystem()
+bool initWakeWordSystem()
 {
   ei_printf("\n--- 唤醒词推理系统初始化 ---\n");
 
-  // 等待串口就绪
-  while (!Serial)
-  {
-    delay(10);
-  }
-
   // 设置LED指示灯
   pinMode(LED_BUILT_IN, OUTPUT);
   digitalWrite(LED_BUILT_IN, LOW);
@@ -287,19 +433,67 @@ void initWakeWordSystem()
   ei_printf("  分类数量: %d\n", sizeof(ei_classifier_inferencing_categories) / sizeof(ei_classifier_inferencing_categories[0]));
   ei_printf("  唤醒阈值: %.2f\n", PRED_VALUE_THRESHOLD);
 
-  ei_printf("\n1秒后开始连续推理...\n");
-  ei_sleep(1000);
-
-  // 启动麦克风推理
+  // 启动麦克风推理（I2S 已由音频阶段初始化，不再额外等待）
   if (microphone_inference_start(EI_CLASSIFIER_RAW_SAMPLE_COUNT) == false)
   {
     ei_printf("错误: 无法分配音频缓冲区 (大小 %d)\n", EI_CLASSIFIER_RAW_SAMPLE_COUNT);
     ei_printf("这可能是由于模型的窗口长度导致的\n");
-    return;
+    return false;
   }
 
   ei_printf("✓ 唤醒词检测已启动...\n");
-  ei_printf("--- 系统就绪，等待唤醒词 ---\n");
+  return true;
+}
+
+/**
+ * @brief 心跳统计：主循环自己的状态和唤醒门控，再依次调用各模块的 xxxReportStats()
+ * 全部经 DLOG 入环，格式化和串口输出在延迟日志任务上完成，不占用唤醒词推理循环
+ * @param now 当前 millis()
+ */
+static void reportHeartbeatStats(unsigned long now)
+{
+  DLOG(0, "[主循环] 系统运行正常，唤醒词检测活跃, app_state: %s\n", appStateToString(getAppState()));
+  DLOG(0, "[状态监控] record_status: %s, record_status_me: %s, voice_req: %s, voice_run: %s, playback: %s, buf_ready: %d\n",
+       record_status ? "true" : "false",
+       record_status_me ? "true" : "false",
+       voiceInteractionRequested ? "true" : "false",
+       voiceInteractionInProgress ? "true" : "false",
+       audioPlaybackInProgress ? "true" : "false",
+       inference.buf_ready);
+  DLOG(0, "[音频调试] inference.buf_count: %d, inference.n_samples: %d, inference.buffer: %s\n",
+       inference.buf_count, inference.n_samples, inference.buffer ? "已分配" : "未分配");
+
+  // 唤醒门控占空比与分类器调用频率（自上次心跳以来）
+  static WakeGateStats lastGateStats = {};
+  static uint32_t lastClassifierRuns = 0;
+  static uint32_t lastWindowCount = 0;
+  static unsigned long lastGateReport = 0;
+  WakeGateStats gateStats = wakeGate.stats();
+  uint32_t gateBlocks = gateStats.blocks - lastGateStats.blocks;
+  uint32_t gateOpenBlocks = gateStats.openBlocks - lastGateStats.openBlocks;
+  uint32_t classifierRuns = wakeClassifierRuns - lastClassifierRuns;
+  float elapsedMinutes = (now - lastGateReport) / 60000.0f;
+  DLOG(0, "[唤醒门控] 窗口: %u, 门控打开: %.1f%%, 分类器调用: %u (%.1f 次/分钟), 底噪: %u/%u\n",
+       wakeWindowCount - lastWindowCount,
+       gateBlocks ? 100.0f * gateOpenBlocks / gateBlocks : 0.0f,
+       classifierRuns,
+       elapsedMinutes > 0 ? classifierRuns / elapsedMinutes : 0.0f,
+       wakeGate.lowFloor(), wakeGate.highFloor());
+  lastGateStats = gateStats;
+  lastClassifierRuns = wakeClassifierRuns;
+  lastWindowCount = wakeWindowCount;
+  lastGateReport = now;
+
+  networkWorkerReportStats();
+  dlogReportStats();
+  buttonManagerReportStats();
+  sensorSchedulerReportStats();
+  voiceArenaReportStats();
+  waitPromptReportStats();
+  secureConnReportStats();
+  trackStoreReportStats();
+  gpsReportStats();
+  navPrefetchReportStats();
 }
 
 /**
@@ -316,8 +510,10 @@ void loop()
     GpsFix fix = gpsGetLatestFix();
     if (gpsHasValidFix())
     {
-      Serial.printf("[GPS TEST] Latest fix OK | lat=%.6f lon=%.6f utc=%s\n",
-                    fix.latitude, fix.longitude, fix.utcTime.c_str());
+      PositionEstimate estimate = gpsEstimatePosition(millis());
+      Serial.printf("[GPS TEST] Latest fix OK | lat=%.6f lon=%.6f utc=%s sats=%u hdop=%.1f | estimate lat=%.6f lon=%.6f err=%.1fm\n",
+                    fix.latitude, fix.longitude, fix.utcTime, static_cast<unsigned>(fix.satellites), fix.hdop,
+                    estimate.latitude, estimate.longitude, estimate.errorMeters);
     }
     else
     {
@@ -328,6 +524,8 @@ void loop()
   return;
 #endif
 
+  tracePollSerial();
+
   static unsigned long lastHeartbeat = 0;
   static unsigned long lastStateCheck = 0;
   static unsigned long voiceInteractionStartTime = 0;
@@ -338,21 +536,7 @@ void loop()
   if (currentTime - lastHeartbeat > 10000)
   {
     bool voiceBusy = voiceInteractionRequested || voiceInteractionInProgress || audioPlaybackInProgress;
-    ei_printf("[主循环] 系统运行正常，唤醒词检测活跃\n");
-    ei_printf("[状态监控] app_state: %s\n", appStateToString(getAppState()));
-    ei_printf("[状态监控] record_status: %s, record_status_me: %s, voice_req: %s, voice_run: %s, playback: %s, buf_ready: %d\n", 
-              record_status ? "true" : "false", 
-              record_status_me ? "true" : "false",
-              voiceInteractionRequested ? "true" : "false",
-              voiceInteractionInProgress ? "true" : "false",
-              audioPlaybackInProgress ? "true" : "false",
-              inference.buf_ready);
-    
-    // 添加音频系统状态调试信息
-    ei_printf("[音频调试] inference.buf_count: %d, inference.n_samples: %d\n",
-              inference.buf_count, inference.n_samples);
-    ei_printf("[音频调试] inference.buffer: %s\n", 
-              inference.buffer ? "已分配" : "未分配");
+    reportHeartbeatStats(currentTime);
     
     // 检查语音交互是否卡住
     if (voiceBusy) {
@@ -380,11 +564,18 @@ void loop()
   }
   
   
-  // 执行唤醒词推理
-  performWakeWordInference();
+  // 执行唤醒词推理（语音就绪前唤醒了也无法交互，先不推理）
+  if (bootMilestoneReached(BootMilestone::VoiceReady))
+  {
+    performWakeWordInference();
+  }
   
-  // 检查导航更新
+  // 检查导航更新（只投递到后台网络任务，不在这里等待 HTTP）
   checkNavigationUpdate();
+  checkDeviceStatusReport();
+  checkTokenRefresh();
+  navPrefetchPoll(navigationActive,
+                  voiceInteractionRequested || voiceInteractionInProgress || audioPlaybackInProgress);
 
   // 短暂延迟，避免过度占用CPU
   vTaskDelay(10 / portTICK_PERIOD_MS);
@@ -428,6 +619,22 @@ void performWakeWordInference()
     return;
   }
 
+  ++wakeWindowCount;
+
+  // 静音窗口原本也要跑完 MFCC+CNN 才在 checkWakeWordDetection 里按能量丢弃；
+  // 先做能量检查（结果不变），再看第一级门控，都通过才调用分类器
+  uint32_t audioEnergy = calculateAudioEnergy(inference.buffer, inference.n_samples * 2);
+  if (audioEnergy < WAKE_MIN_AUDIO_ENERGY)
+  {
+    return;
+  }
+#if WAKE_GATE_ENABLED
+  if (!inference.gate_open)
+  {
+    return;
+  }
+#endif
+
   // 设置信号结构
   signal_t signal;
   signal.total_length = EI_CLASSIFIER_RAW_SAMPLE_COUNT;
@@ -436,17 +643,29 @@ void performWakeWordInference()
 
   // 运行分类器
   EI_IMPULSE_ERROR r = run_classifier(&signal, &result, debug_nn);
+  ++wakeClassifierRuns;
   if (r != EI_IMPULSE_OK)
   {
     ei_printf("错误: 分类器运行失败 (%d)\n", r);
     return;
   }
 
+#if EI_COMPILED_MODEL_PROFILING
+  const tflite_learn_3_profile_t *profile = tflite_learn_3_profile();
+  if (profile->invocations % WAKE_WORD_PROFILE_INTERVAL == 0)
+  {
+    static char profileJson[1536];
+    tflite_learn_3_profile_print();
+    tflite_learn_3_profile_json(profileJson, sizeof(profileJson));
+    ei_printf("[模型剖析] %s\n", profileJson);
+  }
+#endif
+
   // 打印推理结果
   // printInferenceResults(&result);
 
   // 检查唤醒词
-  checkWakeWordDetection(&result);
+  checkWakeWordDetection(&result, audioEnergy);
 }
 
 /**
@@ -469,22 +688,12 @@ void printInferenceResults(ei_impulse_result_t *result)
 /**
  * @brief 检查唤醒词检测
  * @param result 推理结果指针
+ * @param audioEnergy 当前窗口的音频能量，调用前已确认不低于 WAKE_MIN_AUDIO_ENERGY
  */
-void checkWakeWordDetection(ei_impulse_result_t *result)
+void checkWakeWordDetection(ei_impulse_result_t *result, uint32_t audioEnergy)
 {
-  // 计算当前音频缓冲区的能量水平
-  uint32_t audioEnergy = calculateAudioEnergy(inference.buffer, inference.n_samples * 2);
-  const uint32_t MIN_AUDIO_ENERGY = 150; // 最小音频能量阈值，过滤静音状态
-  
   ei_printf("[唤醒检测] 置信度: %.3f, 音频能量: %u\n", result->classification[0].value, audioEnergy);
   
-  // 首先检查音频能量是否足够（避免静音时的误触发）
-  if (audioEnergy < MIN_AUDIO_ENERGY)
-  {
-    // ei_printf("[唤醒检测] 音频能量过低 (%u < %u)，跳过检测\n", audioEnergy, MIN_AUDIO_ENERGY);
-    return;
-  }
-  
   // 唤醒词在第一位，此时判断classification[0]位置大于阈值表示唤醒
   if (result->classification[0].value > PRED_VALUE_THRESHOLD)
   {
@@ -522,6 +731,7 @@ void handleWakeWordDetected()
   record_status = false;
   record_status_me = false;
 
+  traceMarkTrigger();
   voiceInteractionRequested = true;
 
   ei_printf("[唤醒检测] 唤醒处理完成，等待语音任务响应\n");
@@ -655,53 +865,30 @@ void createCore0Tasks()
       0 // 在核心0上运行
   );
 
-  // 创建按钮检测任务
-  BaseType_t result2 = xTaskCreatePinnedToCore(
-      buttonTask,
-      "ButtonTask",
-      BUTTON_TASK_STACK_SIZE,
-      NULL,
-      BUTTON_TASK_PRIORITY,
-      &buttonTaskHandle,
-      0 // 在核心0上运行
-  );
-
-  // 创建光敏传感器任务
-  BaseType_t result3 = xTaskCreatePinnedToCore(
-      lightSensorTask,
-      "LightSensorTask",
-      LIGHT_SENSOR_TASK_STACK_SIZE,
-      NULL,
-      LIGHT_SENSOR_TASK_PRIORITY,
-      &lightSensorTaskHandle,
-      0 // 在核心0上运行
-  );
-
-  BaseType_t result4 = xTaskCreatePinnedToCore(
-      gpsTask,
-      "GpsTask",
-      GPS_TASK_STACK_SIZE,
-      NULL,
-      GPS_TASK_PRIORITY,
-      &gpsTaskHandle,
-      0 // 在核心0上运行
-  );
+  // 按键、光敏、GPS 作为作业登记到同一个传感器调度任务，不再各占一个任务。
+  // 首次执行都放在一个周期后，与按键作业的 1 秒空闲检查对齐到同一批截止时刻，少唤醒几次
+  bool buttonOk = buttonManagerBegin(onButtonGesture);
+  bool lightOk = sensorSchedulerAddPeriodic("light", LIGHT_SENSOR_POLL_MS, LIGHT_SENSOR_POLL_MS, lightSensorJob, NULL) != TimerWheel::kInvalidJob;
+  // GPS 由串口接收事件提前触发，周期只是兜底
+  int gpsJobId = sensorSchedulerAddPeriodic("gps", GPS_POLL_INTERVAL_MS, GPS_POLL_INTERVAL_MS, gpsJob, NULL);
+  bool gpsOk = gpsJobId != TimerWheel::kInvalidJob;
+  gpsSetWakeJob(gpsJobId);
+  bool schedulerOk = sensorSchedulerStart();
 
   // 检查核心0任务创建结果
-  if (result1 == pdPASS && result2 == pdPASS && result3 == pdPASS && result4 == pdPASS)
+  if (result1 == pdPASS && schedulerOk && buttonOk && lightOk && gpsOk)
   {
     ei_printf("  ✓ 核心0任务组创建成功\n");
-    ei_printf("    - GPS任务: %s\n", result4 == pdPASS ? "成功" : "失败");
-    ei_printf("    - 按钮任务: %s\n", result2 == pdPASS ? "成功" : "失败");
-    ei_printf("    - 光敏传感器任务: %s\n", result3 == pdPASS ? "成功" : "失败");
   }
   else
   {
     ei_printf("  ✗ 核心0任务组创建失败\n");
-    ei_printf("    - GPS任务: %s\n", result4 == pdPASS ? "成功" : "失败");
-    ei_printf("    - 按钮任务: %s\n", result2 == pdPASS ? "成功" : "失败");
-    ei_printf("    - 光敏传感器任务: %s\n", result3 == pdPASS ? "成功" : "失败");
   }
+  ei_printf("    - 语音任务: %s\n", result1 == pdPASS ? "成功" : "失败");
+  ei_printf("    - 传感器调度任务: %s\n", schedulerOk ? "成功" : "失败");
+  ei_printf("    - 按钮作业: %s\n", buttonOk ? "成功" : "失败");
+  ei_printf("    - 光敏传感器作业: %s\n", lightOk ? "成功" : "失败");
+  ei_printf("    - GPS作业: %s\n", gpsOk ? "成功" : "失败");
 }
 
 /**
@@ -726,8 +913,11 @@ void createCore1Tasks()
       1 // 在核心1上运行
   );
 
+  // “请稍等”提示音播放任务，与核心0上语音任务的 ASR、/ai 并行
+  bool waitPromptOk = waitPromptBegin();
+
   // 检查核心1任务创建结果
-  if (result == pdPASS)
+  if (result == pdPASS && waitPromptOk)
   {
     ei_printf("  ✓ 核心1任务组创建成功\n");
   }
@@ -735,6 +925,8 @@ void createCore1Tasks()
   {
     ei_printf("  ✗ 核心1任务组创建失败\n");
   }
+  ei_printf("    - 超声波任务: %s\n", result == pdPASS ? "成功" : "失败");
+  ei_printf("    - 提示音播放任务: %s\n", waitPromptOk ? "成功" : "失败");
 }
 
 /**
@@ -754,11 +946,10 @@ void printTaskInfo()
 
   ei_printf("核心0任务:\n");
   ei_printf("  - 语音交互处理\n");
-  ei_printf("  - 按钮状态监测\n");
-  ei_printf("  - 光敏传感器控制\n");
-  ei_printf("  - GPS定位与上报\n");
+  ei_printf("  - 传感器调度（按钮、光敏 %d ms、GPS 串口事件 / 兜底 %d ms）\n", LIGHT_SENSOR_POLL_MS, GPS_POLL_INTERVAL_MS);
   ei_printf("核心1任务:\n");
   ei_printf("  - 超声波避障检测\n");
+  ei_printf("  - “请稍等”提示音播放\n");
   Serial.printf("可用堆内存: %d 字节\n", esp_get_free_heap_size());
   ei_printf("--- 任务信息结束 ---\n");
 }
@@ -789,13 +980,14 @@ void ultrasonicTask(void *pvParameters)
     // 监控栈使用情况（每50次循环输出一次）
     if (stackDebugCounter % 50 == 0) {
       UBaseType_t stackHighWaterMark = uxTaskGetStackHighWaterMark(NULL);
-      ei_printf("[超声波任务] 栈剩余: %d 字节\n", stackHighWaterMark * sizeof(StackType_t));
+      DLOG(0, "[超声波任务] 栈剩余: %d 字节\n", stackHighWaterMark * sizeof(StackType_t));
     }
     stackDebugCounter++;
     totalMeasurements++;
     
     // 使用HCSR04库测量距离
     float distance = measureUltrasonicDistance();
+    bootMarkMilestone(BootMilestone::ObstacleReady);
 
     if (distance > 0 && distance < 400) // HCSR04有效测量范围2-400cm
     {
@@ -839,8 +1031,8 @@ void ultrasonicTask(void *pvParameters)
     if (millis() - lastStatsReport > 30000)
     {
       float successRate = (float)successCount / totalMeasurements * 100;
-      ei_printf("超声波统计: 总测量%d次, 成功%d次, 失败%d次, 成功率%.1f%% (HCSR04库模式)\n", 
-               totalMeasurements, successCount, failureCount, successRate);
+      DLOG(0, "超声波统计: 总测量%d次, 成功%d次, 失败%d次, 成功率%.1f%% (HCSR04库模式)\n",
+           totalMeasurements, successCount, failureCount, successRate);
       lastStatsReport = millis();
     }
 
@@ -904,7 +1096,7 @@ float measureUltrasonicDistance()
   // 验证距离范围 (HC-SR04 有效范围: 2-400cm)
   if (distance < 2 || distance > 400)
   {
-    ei_printf("超声波测量超出范围");
+    DLOG(1000, "超声波测量超出范围: %.1f cm\n", distance);
     return -1;
   }
   
@@ -917,7 +1109,7 @@ float measureUltrasonicDistance()
  */
 void triggerObstacleAlert(float distance)
 {
-  // Serial.printf("警告: 检测到障碍物，距离 %.1f cm\n", distance);
+  DLOG(1000, "警告: 检测到障碍物，距离 %.1f cm\n", distance);
 
   // 振动和蜂鸣器警报
   digitalWrite(VIBRATION_MODULE_PIN, HIGH);
@@ -930,92 +1122,130 @@ void triggerObstacleAlert(float distance)
 }
 
 /**
- * @brief 按钮检测任务
- * 监听按钮按下事件，触发语音交互
- * @param parameter 任务参数（未使用）
+ * @brief 按键手势分发
+ * 边沿由 GPIO 中断入队并唤醒传感器调度任务，消抖和手势识别按边沿时间戳进行，这里只在有手势时被调用
+ * @param gesture 识别出的手势
  */
-void buttonTask(void *parameter)
+void onButtonGesture(ButtonGesture gesture)
 {
-  ei_printf("按钮检测任务启动\n");
-  ei_printf("按钮引脚: %d\n", TEST_BUTTON_PIN);
-  
-  // 添加任务启动确认
-  int buttonCheckCount = 0;
-
-  while (1)
+  switch (gesture)
   {
-    int buttonState = digitalRead(TEST_BUTTON_PIN);
-    
-    // 每10秒输出一次按钮状态用于调试
-    // if (buttonCheckCount % 100 == 0) {
-    //   ei_printf("[按钮任务] 按钮状态: %s (引脚%d)\n", 
-    //             buttonState == LOW ? "按下" : "释放", TEST_BUTTON_PIN);
-    // }
-    // buttonCheckCount++;
-    
-    if (buttonState == LOW)
-    {
-      ei_printf("[按钮任务] 检测到按钮按下！\n");
-      handleButtonPress();
-    }
-    vTaskDelay(100 / portTICK_PERIOD_MS);
+  case ButtonGesture::ShortPress:
+    handleButtonPress();
+    break;
+  case ButtonGesture::LongPress:
+    handleButtonLongPress();
+    break;
+  case ButtonGesture::DoublePress:
+    handleButtonDoublePress();
+    break;
+  default:
+    break;
   }
 }
 
 /**
- * @brief 处理按钮按下事件
+ * @brief 处理按钮单击事件
  */
 void handleButtonPress()
 {
-  ei_printf("[按钮处理] 开始处理按钮按下事件\n");
-  
-  // 防抖动延时
-  vTaskDelay(100 / portTICK_PERIOD_MS);
+  if (!bootMilestoneReached(BootMilestone::VoiceReady))
+  {
+    ei_printf("[按钮处理] 语音服务仍在启动，忽略本次按钮触发\n");
+    return;
+  }
 
-  // 确认按钮仍然被按下
-  int buttonState = digitalRead(TEST_BUTTON_PIN);
-  // ei_printf("[按钮处理] 防抖后按钮状态: %s\n", buttonState == LOW ? "按下" : "释放");
-  
-  if (buttonState == LOW)
+  if (millis() < voiceTriggerCooldownUntil)
   {
-    if (millis() < voiceTriggerCooldownUntil)
-    {
-      ei_printf("[按钮处理] 当前处于对话结束冷却期，忽略本次按钮触发\n");
-      return;
-    }
+    ei_printf("[按钮处理] 当前处于对话结束冷却期，忽略本次按钮触发\n");
+    return;
+  }
 
-    if (voiceInteractionRequested || voiceInteractionInProgress || audioPlaybackInProgress)
-    {
-      ei_printf("[按钮处理] 当前语音链路忙碌，忽略本次按钮触发\n");
-      return;
-    }
+  if (voiceInteractionRequested || voiceInteractionInProgress || audioPlaybackInProgress)
+  {
+    ei_printf("[按钮处理] 当前语音链路忙碌，忽略本次按钮触发\n");
+    return;
+  }
 
-    ei_printf("[按钮触发] 按钮确认被按下，启动语音交互\n");
-    // ei_printf("[按钮触发] 触发前状态 - record_status: %s, record_status_me: %s\n", 
-    //           record_status ? "true" : "false", record_status_me ? "true" : "false");
+  ei_printf("[按钮触发] 单击，启动语音交互\n");
+  digitalWrite(LED_BUILT_IN, HIGH); // 点亮LED指示
 
-    digitalWrite(LED_BUILT_IN, HIGH); // 点亮LED指示
-    // ei_printf("[按钮触发] LED已点亮\n");
+  // 停止后台唤醒词音频采集，避免和正式录音抢占同一麦克风I2S口
+  record_status = false;
+  record_status_me = false;
 
-    // 停止后台唤醒词音频采集，避免和正式录音抢占同一麦克风I2S口
-    record_status = false;
-    record_status_me = false;
+  // 设置语音交互标志
+  traceMarkTrigger();
+  voiceInteractionRequested = true;
+}
 
-    // 设置语音交互标志
-    voiceInteractionRequested = true;
-    
-    // ei_printf("[按钮触发] 触发后状态 - record_status: %s, record_status_me: %s\n", 
-    //           record_status ? "true" : "false", record_status_me ? "true" : "false");
+/**
+ * @brief 处理按钮长按事件：播报中则中止播报
+ */
+void handleButtonLongPress()
+{
+  if (!audioPlaybackInProgress)
+  {
+    ei_printf("[按钮处理] 长按，当前没有播报\n");
+    return;
+  }
+  ei_printf("[按钮触发] 长按，中止当前播报\n");
+  requestPlaybackStop();
+}
 
-    // 额外延时避免重复触发
-    vTaskDelay(300 / portTICK_PERIOD_MS);
-    
-    ei_printf("[按钮触发] 按钮触发的语音交互准备完成\n");
+/**
+ * @brief 处理按钮双击事件：重播最近一次播报（导航指令或服务端回复）
+ */
+void handleButtonDoublePress()
+{
+  if (voiceInteractionRequested || voiceInteractionInProgress || audioPlaybackInProgress)
+  {
+    ei_printf("[按钮处理] 当前语音链路忙碌，忽略本次双击\n");
+    return;
   }
-  else
+  ei_printf("[按钮触发] 双击，重播最近一次播报\n");
+  repeatSpeechRequested = true;
+}
+
+/**
+ * @brief 记录最近一次 TTS 播报的文本，超长时按 UTF-8 字符边界截断
+ */
+static void rememberSpokenText(const String &text)
+{
+  size_t length = text.length();
+  if (length >= sizeof(lastSpokenText))
+  {
+    length = sizeof(lastSpokenText) - 1;
+    while (length > 0 && (static_cast<uint8_t>(text[length]) & 0xC0) == 0x80)
+    {
+      --length;
+    }
+  }
+  portENTER_CRITICAL(&lastSpokenMux);
+  memcpy(lastSpokenText, text.c_str(), length);
+  lastSpokenText[length] = '\0';
+  portEXIT_CRITICAL(&lastSpokenMux);
+}
+
+/**
+ * @brief 重播最近一次播报（运行在语音任务上）
+ */
+static void repeatLastSpokenText()
+{
+  char text[sizeof(lastSpokenText)];
+  portENTER_CRITICAL(&lastSpokenMux);
+  memcpy(text, lastSpokenText, sizeof(text));
+  portEXIT_CRITICAL(&lastSpokenMux);
+  if (text[0] == '\0')
   {
-    ei_printf("[按钮处理] 防抖后按钮已释放，忽略此次触发\n");
+    ei_printf("[按钮处理] 还没有可重播的内容\n");
+    return;
   }
+
+  audioPlaybackInProgress = true;
+  bool ttsOk = speakTextWithBaidu(baiduTokenGet(), String(text));
+  audioPlaybackInProgress = false;
+  ei_printf(ttsOk ? "[语音合成] 重播完成: %s\n" : "[语音合成] 重播失败: %s\n", text);
 }
 
 /**
@@ -1035,9 +1265,18 @@ void voiceTask(void *parameter)
       ei_printf("[语音任务] 检测到语音交互触发信号\n");
       voiceInteractionRequested = false;
       voiceInteractionInProgress = true;
+      // 用户唤醒时放弃还没播出的服务端导航播报，下个轮询周期再取
+      navUpdateSpeechPending = false;
       
       // 执行完整的语音交互流程
+      traceBeginTurn();
+      voiceArenaBeginTurn();
+      // TTS 已改走 HTTPS 时让网络任务在录音期间先完成握手
+      secureConnBeginTurn(baiduTtsPrefersHttps());
       handleVoiceInteraction();
+      secureConnEndTurn();
+      voiceArenaEndTurn();
+      traceEndTurn();
       
       // 语音交互完成后，重置状态以等待下次唤醒
       ei_printf("[语音任务] 语音交互完成，重置状态等待下次唤醒\n");
@@ -1047,6 +1286,15 @@ void voiceTask(void *parameter)
       
       ei_printf("[语音任务] 等待下次触发信号...\n");
     }
+    else if (repeatSpeechRequested && !voiceInteractionInProgress)
+    {
+      repeatSpeechRequested = false;
+      repeatLastSpokenText();
+    }
+    else
+    {
+      playPendingNavigationSpeech();
+    }
     vTaskDelay(20 / portTICK_PERIOD_MS);
   }
 }
@@ -1056,19 +1304,23 @@ void voiceTask(void *parameter)
  */
 void handleVoiceInteraction()
 {
+  TRACE_SPAN(TraceTurn);
   ei_printf("[语音交互] 开始语音交互流程\n");
   setAppState(SPEAKING);
   audioPlaybackInProgress = true;
-  playAudio_Zai();
+  {
+    TRACE_SPAN(TraceRecordPrompt);
+    playAudio_Zai();
+  }
   audioPlaybackInProgress = false;
 
   setAppState(RECORDING);
   // ei_printf("[语音交互] 当前状态 - record_status: %s, record_status_me: %s\n", 
   //           record_status ? "true" : "false", record_status_me ? "true" : "false");
 
-  // 分配音频缓冲区内存
-  // ei_printf("[语音交互] 分配音频数据缓冲区\n");
-  uint8_t *pcm_data = (uint8_t *)ps_malloc(BUFFER_SIZE);
+  // 录音缓冲区来自开机预留的采集区，函数返回时随租约回收
+  VoiceArenaLease captureLease(VoiceArenaRegion::Capture);
+  uint8_t *pcm_data = captureLease.alloc(BUFFER_SIZE);
   if (!pcm_data)
   {
     ei_printf("[语音交互] 错误:内存分配失败，退出语音交互\n");
@@ -1086,7 +1338,6 @@ void handleVoiceInteraction()
   if (!isValidRecording(recordingSize))
   {
     ei_printf("[语音交互] 录音质量不佳，退出语音交互\n");
-    free(pcm_data);
     digitalWrite(LED_BUILT_IN, LOW);
     return;
   }
@@ -1101,6 +1352,8 @@ void handleVoiceInteraction()
   
   // 执行语音识别和处理
   processVoiceRecognition(pcm_data, recordingSize);
+  // 没有回复要播（识别失败、服务端不要求播报）时提示音不截断，等它播完再结束本轮
+  waitPromptJoin();
   
   unsigned long endTime = millis();
   unsigned long processingTime = endTime - startTime;
@@ -1112,10 +1365,6 @@ void handleVoiceInteraction()
     ei_printf("[语音交互] 警告:语音处理超时 (%lu ms > %lu ms)\n", processingTime, VOICE_PROCESSING_TIMEOUT);
   }
 
-  // 释放内存
-  // ei_printf("[语音交互] 释放音频缓冲区内存\n");
-  free(pcm_data);
-
   // 确保LED被关闭
   digitalWrite(LED_BUILT_IN, LOW);
   digitalWrite(LED_BUILTIN, LOW);  // 同时关闭外置LED
@@ -1137,6 +1386,7 @@ void handleVoiceInteraction()
  */
 size_t performAudioRecording(uint8_t *pcm_data)
 {
+  TRACE_SPAN(TraceRecording);
   ei_printf("[录音] 开始音频录制...\n");
   digitalWrite(LED_BUILT_IN, HIGH);
   digitalWrite(LED_BUILTIN, HIGH);  // 同时点亮外置LED
@@ -1161,7 +1411,7 @@ size_t performAudioRecording(uint8_t *pcm_data)
     
     if (result != ESP_OK)
     {
-      Serial.printf("[录音] I2S读取错误: %s\n", esp_err_to_name(result));
+      DLOG(0, "[录音] I2S读取错误: %s\n", esp_err_to_name(result));
       break;
     }
 
@@ -1172,7 +1422,7 @@ size_t performAudioRecording(uint8_t *pcm_data)
 
     if (bytes_read == 0)
     {
-      Serial.printf("[录音] 缓冲区已满，停止录音 - 录制大小: %d\n", recordingSize);
+      DLOG(0, "[录音] 缓冲区已满，停止录音 - 录制大小: %d\n", recordingSize);
       break;
     }
 
@@ -1200,30 +1450,30 @@ size_t performAudioRecording(uint8_t *pcm_data)
       if (audioEnergy > 300)
       {
         VoiceCnt++;
-        Serial.printf("[录音] 缓冲期检测到语音活动，能量: %d\n", audioEnergy);
+        DLOG(250, "[录音] 缓冲期检测到语音活动，能量: %d\n", audioEnergy);
       }
     }
 
     // 每隔一段时间输出录音状态
     if (recordingSize % 10240 == 0) // 每10KB输出一次状态
     {
-      Serial.printf("[录音] 录音进行中... 已录制: %d 字节, 音频能量: %d, 静音计数: %d\n", recordingSize, audioEnergy, noVoiceTotal);
+      DLOG(0, "[录音] 录音进行中... 已录制: %d 字节, 音频能量: %d, 静音计数: %d\n", recordingSize, audioEnergy, noVoiceTotal);
     }
 
     // 检查录音结束条件
     if (shouldStopRecording(noVoiceTotal, recordingSize))
     {
       recording = false;
-      ei_printf("[录音] 检测到静音持续时间过长，停止录音\n");
-      ei_printf("[录音] 录音完成\n");
+      DLOG(0, "[录音] 检测到静音持续时间过长，停止录音\n");
+      DLOG(0, "[录音] 录音完成\n");
     }
     
     // 检查录音超时
     if (millis() - recordingStartTime > MAX_RECORDING_TIME_MS)
     {
       recording = false;
-      ei_printf("[录音] 录音超时，强制停止录音\n");
-      ei_printf("[录音] 录音时长: %lu 毫秒\n", millis() - recordingStartTime);
+      DLOG(0, "[录音] 录音超时，强制停止录音\n");
+      DLOG(0, "[录音] 录音时长: %lu 毫秒\n", millis() - recordingStartTime);
     }
   }
 
@@ -1285,8 +1535,8 @@ void updateVoiceDetection(uint32_t audioEnergy, size_t *noVoicePre, size_t *noVo
   debugCounter++;
   if (debugCounter % 15 == 0) // 增加输出频率，每15次输出一次
   {
-    Serial.printf("[语音检测] 音频能量: %d, 语音计数: %d, 当前静音: %d, 总静音: %d\n", 
-                  audioEnergy, *VoiceCnt, *noVoiceCur, *noVoiceTotal);
+    DLOG(0, "[语音检测] 音频能量: %d, 语音计数: %d, 当前静音: %d, 总静音: %d\n",
+         audioEnergy, *VoiceCnt, *noVoiceCur, *noVoiceTotal);
   }
 }
 
@@ -1352,14 +1602,9 @@ bool isValidRecording(size_t recordingSize)
 
 void playWaitPrompt()
 {
-  ei_printf("[响应播报] 录音完成，播放请稍等提示\n");
-  setAppState(SPEAKING);
-  audioPlaybackInProgress = true;
-  if (!playLocalAudioById("wait_001"))
-  {
-    ei_printf("[响应播报] wait_001 本地提示音不可用，继续处理语音\n");
-  }
-  audioPlaybackInProgress = false;
+  // 提示音在播放任务上与识别、/ai 并行；回复开始播放前由播放路径中止，一轮结束前 waitPromptJoin 收尾
+  ei_printf("[响应播报] 录音完成，请稍等提示与语音识别并行播放\n");
+  waitPromptStart(WAIT_PROMPT_AUDIO_ID);
 }
 
 /**
@@ -1375,7 +1620,7 @@ void processVoiceRecognition(uint8_t *pcm_data, size_t recordingSize)
     
     setAppState(ASR_PROCESSING);
     try {
-      recognizedText = recognizeSpeechWithBaidu(accessToken, pcm_data, recordingSize);
+      recognizedText = recognizeSpeechWithBaidu(baiduTokenGet(), pcm_data, recordingSize);
       ei_printf("[语音识别] 识别结果: %s\n", recognizedText.c_str());
     } catch (...) {
       ei_printf("[语音识别] 错误:语音识别API调用异常\n");
@@ -1384,17 +1629,26 @@ void processVoiceRecognition(uint8_t *pcm_data, size_t recordingSize)
 
     if (recognizedText.length() > 0)
     {
-      ei_printf("[AI对话] 发送文本到AI服务器\n");
       String response = "";
-      
+      bool serverRequested = false;
+      if (handleFastIntent(recognizedText, &response, &serverRequested))
+      {
+        ei_printf("[语音识别] 语音识别处理完成\n");
+        return;
+      }
+
       setAppState(SERVER_PROCESSING);
-      try {
-        response = sendTextToServer(recognizedText);
-        ei_printf("[AI对话] AI回复: %s\n", response.c_str());
-      } catch (...) {
-        ei_printf("[AI对话] 错误:AI服务器请求异常\n");
-        response = "";
+      if (!serverRequested)
+      {
+        ei_printf("[AI对话] 发送文本到AI服务器\n");
+        try {
+          response = sendTextToServer(recognizedText);
+        } catch (...) {
+          ei_printf("[AI对话] 错误:AI服务器请求异常\n");
+          response = "";
+        }
       }
+      ei_printf("[AI对话] AI回复: %s\n", describeServerPayload(response).c_str());
 
       if (response.length() > 0)
       {
@@ -1403,7 +1657,7 @@ void processVoiceRecognition(uint8_t *pcm_data, size_t recordingSize)
 
         if (serverResponse.navigationStarted || serverResponse.navigationActive)
         {
-          String destination = serverResponse.destination;
+          String destination = serverResponse.destination.c_str();
           if (destination.length() == 0)
           {
             destination = "当前目的地";
@@ -1412,10 +1666,7 @@ void processVoiceRecognition(uint8_t *pcm_data, size_t recordingSize)
         }
         else if (serverResponse.navigationComplete || serverResponse.navigationExited)
         {
-          navigationActive = false;
-          currentDestination = "";
-          lastNavigationUpdate = 0;
-          setAppNavigationActive(false);
+          endNavigationLocally();
         }
       }
       else
@@ -1440,9 +1691,59 @@ void processVoiceRecognition(uint8_t *pcm_data, size_t recordingSize)
   ei_printf("[语音识别] 语音识别处理完成\n");
 }
 
+/**
+ * @brief 设备端快速意图：命中本地规则时直接播报，省去一次 /ai 往返
+ * @param response 规则要求服务端处理且已后台请求时，写入取回的回复
+ * @param serverRequested 是否已经发出 /ai 请求，调用方据此避免重复发送
+ * @return true 表示已在本地处理完毕
+ */
+bool handleFastIntent(const String &recognizedText, String *response, bool *serverRequested)
+{
+  FastIntentMatch match;
+  unsigned long startUs = micros();
+  if (!fastIntentMatch(recognizedText, navigationActive, &match))
+  {
+    return false;
+  }
+  ei_printf("[快速意图] 命中 %s (规则 %d, 匹配耗时 %luus)\n", match.intent.c_str(), match.ruleIndex, micros() - startUs);
+
+  if (match.action == FastIntentAction::Server)
+  {
+    // 需要服务端的意图：先后台发出 /ai，再播放本地确认音，二者重叠
+    if (match.audioId.isEmpty() || !fastIntentBeginServerRequest(recognizedText))
+    {
+      return false;
+    }
+    *serverRequested = true;
+    setAppState(SPEAKING);
+    audioPlaybackInProgress = true;
+    playLocalAudioById(match.audioId.c_str());
+    audioPlaybackInProgress = false;
+    setAppState(SERVER_PROCESSING);
+    *response = fastIntentAwaitServerReply(SERVER_HTTP_TIMEOUT_MS + 2000);
+    return false;
+  }
+
+  ServerResponse local;
+  local.jsonValid = true;
+  local.ok = true;
+  local.intent = match.intent.c_str();
+  local.speakMode = match.action == FastIntentAction::LocalAudio ? "local_audio" : "tts_text";
+  local.audioId = match.audioId.c_str();
+  local.speakText = match.text.c_str();
+  speakServerResponse(local);
+
+  if (match.followUp == FastIntentFollowUp::ExitNavigation)
+  {
+    endNavigationLocally();
+    fastIntentRunFollowUpAsync(match.followUp);
+  }
+  return true;
+}
+
 void speakServerResponse(const ServerResponse &serverResponse)
 {
-  String speakMode = serverResponse.speakMode;
+  const auto &speakMode = serverResponse.speakMode;
   if (speakMode == "none")
   {
     ei_printf("[响应播报] 服务端要求不播报\n");
@@ -1452,9 +1753,9 @@ void speakServerResponse(const ServerResponse &serverResponse)
   setAppState(SPEAKING);
   audioPlaybackInProgress = true;
 
-  if (speakMode == "local_audio" && serverResponse.audioId.length() > 0)
+  if (speakMode == "local_audio" && !serverResponse.audioId.isEmpty())
   {
-    if (playLocalAudioById(serverResponse.audioId))
+    if (playLocalAudioById(serverResponse.audioId.c_str()))
     {
       ei_printf("[响应播报] 已播放本地音频: %s\n", serverResponse.audioId.c_str());
       audioPlaybackInProgress = false;
@@ -1463,19 +1764,26 @@ void speakServerResponse(const ServerResponse &serverResponse)
     ei_printf("[响应播报] 本地音频不可用，回退到TTS\n");
   }
 
-  String textToSpeak = getSpeakText(serverResponse);
-  if (textToSpeak.length() == 0)
+  if (speakMode == "audio_url" && !serverResponse.audioUrl.isEmpty())
   {
-    textToSpeak = "当前没有可播报的返回内容，请稍后重试。";
+    if (playRemoteAudioUrl(serverResponse.audioUrl.c_str()))
+    {
+      ei_printf("[响应播报] 已播放远程音频: %s\n", serverResponse.audioUrl.c_str());
+      audioPlaybackInProgress = false;
+      return;
+    }
+    ei_printf("[响应播报] audio_url 播放失败，回退到文本TTS\n");
   }
 
-  if (speakMode == "audio_url")
+  String textToSpeak = getSpeakText(serverResponse);
+  if (textToSpeak.length() == 0)
   {
-    ei_printf("[响应播报] audio_url 暂未实现，回退到文本TTS\n");
+    textToSpeak = "当前没有可播报的返回内容，请稍后重试。";
   }
 
+  rememberSpokenText(textToSpeak);
   try {
-    bool ttsOk = speakTextWithBaidu(accessToken, textToSpeak);
+    bool ttsOk = speakTextWithBaidu(baiduTokenGet(), textToSpeak);
     ei_printf(ttsOk ? "[语音合成] 语音合成并播放完成\n" : "[语音合成] 语音合成或播放失败\n");
   } catch (...) {
     ei_printf("[语音合成] 错误:语音合成API调用异常\n");
@@ -1487,6 +1795,240 @@ void speakServerResponse(const ServerResponse &serverResponse)
  * @brief 启用连续对话模式
  */
 
+/**
+ * @brief 清空本地路线（导航开始/结束、路线变更时调用）
+ */
+static void clearNavigationRoute()
+{
+  if (routeFollower == nullptr)
+  {
+    return;
+  }
+  xSemaphoreTake(routeMutex, portMAX_DELAY);
+  routeFollower->clear();
+  xSemaphoreGive(routeMutex);
+  lastRouteFixAt = 0;
+  // 旧路线上还没播出的指令作废，新路线加载后按当前位置重新播报
+  navPromptSpeechPending = false;
+}
+
+/**
+ * @brief 结束导航的状态变更，调用方持有 navigationMutex
+ */
+static void endNavigationLocked()
+{
+  ++navigationGeneration;
+  navigationActive = false;
+  currentDestination = "";
+  lastNavigationUpdate = 0;
+  setAppNavigationActive(false);
+  clearNavigationRoute();
+  navPrefetchCancel();
+  setAppState(IDLE);
+}
+
+/**
+ * @brief 本地结束导航（服务端返回结束/退出、快速意图“退出导航”、轮询发现导航已不激活）
+ * 代次加一让在途的路线下载、导航更新和播报结果全部作废，清空本地路线和预取，回到空闲状态
+ */
+void endNavigationLocally()
+{
+  xSemaphoreTake(navigationMutex, portMAX_DELAY);
+  endNavigationLocked();
+  xSemaphoreGive(navigationMutex);
+}
+
+/**
+ * @brief 把已播报步之后的 NAV_PREFETCH_AHEAD 步指令排进预取队列
+ */
+static void queueUpcomingPrompts()
+{
+  xSemaphoreTake(routeMutex, portMAX_DELAY);
+  size_t stepCount = routeFollower->stepCount();
+  for (size_t step = routeFollower->announcedStep() + 1;
+       step < stepCount && step <= static_cast<size_t>(routeFollower->announcedStep()) + NAV_PREFETCH_AHEAD; ++step)
+  {
+    navPrefetchEnqueue(routeFollower->stepInstruction(step));
+  }
+  xSemaphoreGive(routeMutex);
+}
+
+/**
+ * @brief 路线下载完成回调（运行在后台网络任务上）
+ * @param result 请求结果
+ * @param context 投递时的导航代次
+ */
+static void onNavigationRouteDone(const NetworkJobResult &result, void *context)
+{
+  uint32_t generation = (uint32_t)(uintptr_t)context;
+  if (!result.ok)
+  {
+    ei_printf("[导航] 路线下载失败 (http=%d)，继续使用服务端轮询\n", result.httpStatus);
+    return;
+  }
+
+  // 持锁校验代次再加载：下载期间导航可能已结束或换了目的地
+  unsigned long start = millis();
+  xSemaphoreTake(navigationMutex, portMAX_DELAY);
+  if (generation != navigationGeneration || !navigationActive)
+  {
+    xSemaphoreGive(navigationMutex);
+    return;
+  }
+  xSemaphoreTake(routeMutex, portMAX_DELAY);
+  bool loaded = routeFollower->loadResponse(result.payload.c_str(), result.payload.length());
+  size_t steps = routeFollower->stepCount();
+  size_t points = routeFollower->pointCount();
+  float meters = routeFollower->totalMeters();
+  xSemaphoreGive(routeMutex);
+  lastRouteFixAt = 0;
+  if (loaded)
+  {
+    queueUpcomingPrompts();
+  }
+  xSemaphoreGive(navigationMutex);
+
+  if (loaded)
+  {
+    ei_printf("[导航] 路线已加载: %u 步 %u 点 %.0f 米 (下载 %u ms, 解析 %lu ms)\n", (unsigned)steps,
+              (unsigned)points, meters, result.elapsedMs, millis() - start);
+  }
+  else
+  {
+    ei_printf("[导航] 路线解析失败，继续使用服务端轮询\n");
+  }
+}
+
+/**
+ * @brief 投递路线下载；同一导航代次内路线变化（偏航重规划）时也会调用。调用方持有 navigationMutex
+ */
+static void requestNavigationRoute()
+{
+#if ROUTE_FOLLOW_ENABLED
+  if (routeFollower == nullptr)
+  {
+    return;
+  }
+  clearNavigationRoute();
+  navPrefetchCancel();
+  networkSubmitNavigationRoute(onNavigationRouteDone, (void *)(uintptr_t)navigationGeneration);
+#endif
+}
+
+/**
+ * @brief 把服务端导航响应转交语音任务播报（在网络任务上调用）
+ * @param serverResponse 解析后的响应
+ * @param generation 播报所属的导航代次
+ */
+static void postNavigationUpdateSpeech(const ServerResponse &serverResponse, uint32_t generation)
+{
+  xSemaphoreTake(navSpeechMutex, portMAX_DELAY);
+  navUpdateSpeech = serverResponse;
+  navUpdateSpeechGeneration = generation;
+  navUpdateSpeechPending = true;
+  xSemaphoreGive(navSpeechMutex);
+}
+
+/**
+ * @brief 把本地路线指令交给语音任务播报（在主循环上调用），播出前一直留在槽里
+ * @param text 指令文本
+ * @param step 指令所属的步
+ * @param generation 播报所属的导航代次
+ */
+static void postNavigationPromptSpeech(const char *text, int step, uint32_t generation)
+{
+  xSemaphoreTake(navSpeechMutex, portMAX_DELAY);
+  strlcpy(navPromptSpeech, text, sizeof(navPromptSpeech));
+  navPromptSpeechStep = step;
+  navPromptSpeechGeneration = generation;
+  navPromptSpeechAttempts = 0;
+  navPromptSpeechPending = true;
+  xSemaphoreGive(navSpeechMutex);
+}
+
+/**
+ * @brief 记录一次本地路线指令的播放结果：播出、作废或失败次数用完时清掉，否则留着下次重试
+ * 播放期间槽里已换成新的一步时什么都不做
+ */
+static void finishNavigationPromptSpeech(int step, uint32_t generation, bool done)
+{
+  xSemaphoreTake(navSpeechMutex, portMAX_DELAY);
+  if (navPromptSpeechPending && navPromptSpeechStep == step && navPromptSpeechGeneration == generation)
+  {
+    if (done || ++navPromptSpeechAttempts >= NAV_PROMPT_MAX_ATTEMPTS)
+    {
+      navPromptSpeechPending = false;
+    }
+    navPromptSpeechLastAttempt = millis();
+  }
+  xSemaphoreGive(navSpeechMutex);
+}
+
+/**
+ * @brief 播放转交过来的导航播报（运行在语音任务上），每次最多播一条，期间的唤醒请求下一轮先处理
+ * 本地路线指令优先，失败后的重试间隔内先播服务端响应；导航已结束或换了目的地时丢弃。
+ * TTS 按文本命中音频缓存时不联网
+ */
+void playPendingNavigationSpeech()
+{
+  if (!navPromptSpeechPending && !navUpdateSpeechPending)
+  {
+    return;
+  }
+
+  char prompt[sizeof(navPromptSpeech)] = {0};
+  int step = -1;
+  ServerResponse update;
+  bool hasUpdate = false;
+  uint32_t generation = 0;
+  xSemaphoreTake(navSpeechMutex, portMAX_DELAY);
+  if (navPromptSpeechPending &&
+      (navPromptSpeechAttempts == 0 || millis() - navPromptSpeechLastAttempt >= ROUTE_FOLLOW_STEP_MS))
+  {
+    memcpy(prompt, navPromptSpeech, sizeof(prompt));
+    step = navPromptSpeechStep;
+    generation = navPromptSpeechGeneration;
+  }
+  else if (navUpdateSpeechPending)
+  {
+    update = navUpdateSpeech;
+    generation = navUpdateSpeechGeneration;
+    navUpdateSpeechPending = false;
+    hasUpdate = true;
+  }
+  xSemaphoreGive(navSpeechMutex);
+  if (!hasUpdate && prompt[0] == '\0')
+  {
+    return;
+  }
+
+  // 结束导航的那条响应（到达/退出）在本地结束之后投递，代次已是新的，只按代次判断
+  if (generation != navigationGeneration || (!hasUpdate && !navigationActive))
+  {
+    if (!hasUpdate)
+    {
+      finishNavigationPromptSpeech(step, generation, true);
+    }
+    return;
+  }
+
+  if (hasUpdate)
+  {
+    speakServerResponse(update);
+  }
+  else
+  {
+    setAppState(SPEAKING);
+    rememberSpokenText(prompt);
+    audioPlaybackInProgress = true;
+    bool ttsOk = speakTextWithBaidu(baiduTokenGet(), String(prompt));
+    audioPlaybackInProgress = false;
+    ei_printf(ttsOk ? "[导航] 本地路线播报第 %d 步: %s\n" : "[导航] 本地路线播报第 %d 步失败: %s\n", step, prompt);
+    finishNavigationPromptSpeech(step, generation, ttsOk);
+  }
+  setAppState(navigationActive ? NAVIGATING : IDLE);
+}
+
 /**
  * @brief 启动导航
  * @param destination 目的地
@@ -1494,71 +2036,111 @@ void speakServerResponse(const ServerResponse &serverResponse)
 void startNavigation(String destination)
 {
   ei_printf("[导航] 启动导航到: %s\n", destination.c_str());
+  xSemaphoreTake(navigationMutex, portMAX_DELAY);
+  ++navigationGeneration;
   navigationActive = true;
   setAppNavigationActive(true);
   setAppState(NAVIGATING);
   currentDestination = destination;
   lastNavigationUpdate = millis();
+  navPrefetchBegin();
+  requestNavigationRoute();
+  xSemaphoreGive(navigationMutex);
 }
 
 /**
- * @brief 更新导航状态
+ * @brief 导航更新完成回调（运行在后台网络任务上）
+ * 响应在锁外解析；结束/重新规划等状态变更持锁并在代次仍一致时才做，回调期间语音任务开始的新导航不受影响
+ * @param result 请求结果
+ * @param context 投递时的导航代次
  */
-void updateNavigationStatus()
+static void onNavigationUpdateDone(const NetworkJobResult &result, void *context)
 {
-  if (!navigationActive || currentDestination.isEmpty()) {
-    return;
+  uint32_t generation = (uint32_t)(uintptr_t)context;
+  if (result.payload.length() == 0)
+  {
+    ei_printf("[导航] 更新导航状态失败，服务器无响应 (http=%d, %u ms)\n", result.httpStatus, result.elapsedMs);
   }
+  // 直接构造，网络任务栈上不再多一份临时 ServerResponse
+  ServerResponse serverResponse = result.payload.length() > 0 ? parseServerResponse(result.payload) : ServerResponse();
 
-  if (voiceInteractionRequested || voiceInteractionInProgress || audioPlaybackInProgress)
+  xSemaphoreTake(navigationMutex, portMAX_DELAY);
+  if (generation != navigationGeneration || !navigationActive)
   {
-    ei_printf("[导航] 当前语音链路忙碌，跳过本次导航播报更新\n");
+    xSemaphoreGive(navigationMutex);
+    ei_printf("[导航] 导航已变更，丢弃过期的更新结果\n");
     return;
   }
-  
-  ei_printf("[导航] 更新导航状态\n");
-
-  String response = ServerApi::postNavigationUpdate(currentDestination);
-  if (response.length() > 0) {
-    ei_printf("[导航] 服务器响应: %s\n", response.c_str());
+  lastNavigationUpdate = millis();
+  if (result.payload.length() == 0)
+  {
+    xSemaphoreGive(navigationMutex);
+    return;
+  }
+  ei_printf("[导航] 服务器响应 (%u ms): %s\n", result.elapsedMs, describeServerPayload(result.payload).c_str());
 
-    ServerResponse serverResponse = parseServerResponse(response);
-    if (serverResponse.nextInstruction.length() > 0 || getSpeakText(serverResponse).length() > 0)
+#if ROUTE_FOLLOW_ENABLED
+  // 偏航后服务端按当前位置重新规划，route_id 变化时重新下载路线
+  if (routeFollower != nullptr && serverResponse.navigationActive && !serverResponse.routeId.isEmpty())
+  {
+    xSemaphoreTake(routeMutex, portMAX_DELAY);
+    // 偏航后本地不再匹配，即使路线未变也重新加载一次，回到路线上后继续本地跟随
+    bool stale = !routeFollower->loaded() || routeFollower->offRoute() ||
+                 strcmp(routeFollower->routeId(), serverResponse.routeId.c_str()) != 0;
+    xSemaphoreGive(routeMutex);
+    if (stale)
     {
-      speakServerResponse(serverResponse);
+      requestNavigationRoute();
     }
+  }
+#endif
+  if (serverResponse.navigationComplete || !serverResponse.navigationActive)
+  {
+    ei_printf("[导航] 导航结束或服务端返回非激活状态\n");
+    endNavigationLocked();
+  }
 
-    if (serverResponse.navigationComplete || !serverResponse.navigationActive)
+  if (!serverResponse.nextInstruction.isEmpty() || getSpeakText(serverResponse)[0] != '\0')
+  {
+    // 请求期间用户可能已唤醒设备，这时放弃本次播报，下个周期再取
+    if (voiceInteractionRequested || voiceInteractionInProgress)
     {
-      ei_printf("[导航] 导航结束或服务端返回非激活状态\n");
-      navigationActive = false;
-      currentDestination = "";
-      setAppNavigationActive(false);
-      setAppState(IDLE);
+      ei_printf("[导航] 语音链路忙碌，跳过本次导航播报\n");
+    }
+    else
+    {
+      postNavigationUpdateSpeech(serverResponse, navigationGeneration);
     }
-  } else {
-    ei_printf("[导航] 更新导航状态失败，服务器无响应\n");
   }
-
-  lastNavigationUpdate = millis();
+  xSemaphoreGive(navigationMutex);
 }
 
 /**
- * @brief 停止导航
+ * @brief 更新导航状态
+ * 请求投递到后台网络任务，结果在 onNavigationUpdateDone 中处理
  */
-void stopNavigation()
+void updateNavigationStatus()
 {
-  ei_printf("[导航] 停止导航\n");
-  navigationActive = false;
-  setAppNavigationActive(false);
-  setAppState(IDLE);
-  currentDestination = "";
-  lastNavigationUpdate = 0;
-  
-  if (ServerApi::postExitNavigation()) {
-    ei_printf("[导航] 成功通知后端退出导航\n");
-  } else {
-    ei_printf("[导航] 通知后端退出导航失败\n");
+  if (voiceInteractionRequested || voiceInteractionInProgress || audioPlaybackInProgress)
+  {
+    ei_printf("[导航] 当前语音链路忙碌，跳过本次导航播报更新\n");
+    return;
+  }
+
+  // 目的地和代次成对取出：语音任务可能同时在开始/结束导航
+  xSemaphoreTake(navigationMutex, portMAX_DELAY);
+  bool active = navigationActive;
+  String destination = currentDestination;
+  uint32_t generation = navigationGeneration;
+  xSemaphoreGive(navigationMutex);
+  if (!active || destination.isEmpty()) {
+    return;
+  }
+
+  if (networkSubmitNavigationUpdate(destination, onNavigationUpdateDone, (void *)(uintptr_t)generation))
+  {
+    ei_printf("[导航] 更新导航状态\n");
+    lastNavigationUpdate = millis();
   }
 }
 
@@ -1567,11 +2149,123 @@ void stopNavigation()
  */
 void checkNavigationUpdate()
 {
-  if (navigationActive && (millis() - lastNavigationUpdate) >= NAVIGATION_UPDATE_INTERVAL) {
+  if (!navigationActive || followNavigationRoute()) {
+    return;
+  }
+  if ((millis() - lastNavigationUpdate) >= NAVIGATION_UPDATE_INTERVAL &&
+      !networkJobPending(NetworkJobKind::NavigationUpdate)) {
     updateNavigationStatus();
   }
 }
 
+/**
+ * @brief 本地路线跟随：每 ROUTE_FOLLOW_STEP_MS 用位置估计做一次地图匹配，接近路口时播报下一步
+ * 偏航/到达时立即向服务端同步一次，之后回到轮询直到服务端给出新路线或结束导航
+ * @return true 表示本地跟随生效，本周期不需要轮询
+ */
+bool followNavigationRoute()
+{
+#if ROUTE_FOLLOW_ENABLED
+  if (routeFollower == nullptr)
+  {
+    return false;
+  }
+
+  // 用滤波后的位置估计：定位之间按速度外推，跳点已剔除，短时丢星也能继续推进；
+  // 估计不可用（丢星太久或误差太大）时本地无法推进，回到服务端轮询
+  unsigned long now = millis();
+  PositionEstimate estimate = gpsEstimatePosition(now);
+  if (!estimate.valid)
+  {
+    return false;
+  }
+
+  RouteFix routeFix;
+  char instruction[192] = {0};
+  xSemaphoreTake(routeMutex, portMAX_DELAY);
+  bool active = routeFollower->loaded() && !routeFollower->offRoute() && !routeFollower->arrived();
+  bool fresh = active && (lastRouteFixAt == 0 || now - lastRouteFixAt >= ROUTE_FOLLOW_STEP_MS);
+  if (fresh)
+  {
+    routeFix = routeFollower->update(estimate.latitude, estimate.longitude);
+    if (routeFix.instruction != nullptr)
+    {
+      strlcpy(instruction, routeFix.instruction, sizeof(instruction));
+    }
+    active = !routeFollower->offRoute() && !routeFollower->arrived();
+  }
+  xSemaphoreGive(routeMutex);
+  if (!fresh)
+  {
+    return active;
+  }
+  lastRouteFixAt = now;
+
+  switch (routeFix.event)
+  {
+  case RouteEvent::Instruction:
+    ei_printf("[导航] 距路口 %.0f 米，播报第 %d 步\n", routeFix.toManeuverMeters, routeFix.step);
+    // RouteFollower 已把这一步记为已播报，语音链路忙时也要交给语音任务留着，空闲后再播
+    postNavigationPromptSpeech(instruction, routeFix.step, navigationGeneration);
+    queueUpcomingPrompts();
+    break;
+  case RouteEvent::Deviation:
+    ei_printf("[导航] 偏离路线 %.0f 米，请求重新规划\n", routeFix.offRouteMeters);
+    lastNavigationUpdate = 0;
+    break;
+  case RouteEvent::Arrival:
+    ei_printf("[导航] 距终点 %.0f 米，向服务端确认到达\n", routeFix.remainingMeters);
+    lastNavigationUpdate = 0;
+    break;
+  default:
+    break;
+  }
+  return active;
+#else
+  return false;
+#endif
+}
+
+/**
+ * @brief 定期投递设备状态上报
+ */
+void checkDeviceStatusReport()
+{
+  if (!isConnectedToWifi || millis() - lastDeviceStatusReport < DEVICE_STATUS_INTERVAL_MS)
+  {
+    return;
+  }
+
+  DeviceStatusReport report;
+  report.uptimeMs = millis();
+  report.freeHeap = ESP.getFreeHeap();
+  report.rssi = WiFi.RSSI();
+  report.appState = appStateToString(getAppState());
+  report.navigationActive = navigationActive;
+  report.gpsValid = gpsHasValidFix();
+  if (networkSubmitDeviceStatus(report, nullptr, nullptr))
+  {
+    lastDeviceStatusReport = millis();
+  }
+}
+
+/**
+ * @brief Token 续期检查：临近过期（BAIDU_TOKEN_REFRESH_MARGIN_SEC）时交给网络任务，不阻塞主循环
+ */
+void checkTokenRefresh()
+{
+  static unsigned long lastTokenCheck = 0;
+  if (!baiduTokenReady() || millis() - lastTokenCheck < BAIDU_TOKEN_REFRESH_CHECK_MS)
+  {
+    return;
+  }
+  lastTokenCheck = millis();
+  if (baiduTokenNeedsRefresh(baiduTokenGet()))
+  {
+    networkSubmitTokenRefresh(nullptr, nullptr);
+  }
+}
+
 // ==================== 音频推理回调系统 ====================
 /**
  * @brief 音频推理回调函数
@@ -1583,14 +2277,16 @@ static void audio_inference_callback(uint32_t n_bytes)
   // 将16位音频样本复制到推理缓冲区
   int samples_count = n_bytes >> 1; // 除以2，因为每个样本是16位（2字节）
 
+#if WAKE_GATE_ENABLED
+  // 第一级门控按采集块更新，每块只做一次累加，远低于 MFCC+CNN 的开销
+  wakeGate.processBlock(sampleBuffer, samples_count);
+#endif
+
   for (int i = 0; i < samples_count; i++)
   {
     // 检查缓冲区是否还有空间
     if (inference.buf_count >= inference.n_samples)
     {
-      // 缓冲区已满，标记为就绪
-      inference.buf_count = 0;
-      inference.buf_ready = 1;
       break;
     }
 
@@ -1598,9 +2294,10 @@ static void audio_inference_callback(uint32_t n_bytes)
     inference.buffer[inference.buf_count++] = sampleBuffer[i];
   }
 
-  // 如果缓冲区已满，标记为就绪
+  // 如果缓冲区已满，记录门控结果并标记为就绪
   if (inference.buf_count >= inference.n_samples)
   {
+    inference.gate_open = wakeGate.finishWindow();
     inference.buf_count = 0;
     inference.buf_ready = 1;
   }
@@ -1628,7 +2325,7 @@ static void capture_samples(void *arg)
     {
       if (!capturePaused)
       {
-        ei_printf("[音频调试] SPEAKING/播放中，暂停唤醒采集\n");
+        DLOG(0, "[音频调试] SPEAKING/播放中，暂停唤醒采集\n");
         capturePaused = true;
       }
       resetWakeInferenceBuffer();
@@ -1639,7 +2336,7 @@ static void capture_samples(void *arg)
 
     if (capturePaused)
     {
-      ei_printf("[音频调试] 播放结束，恢复唤醒采集\n");
+      DLOG(0, "[音频调试] 播放结束，恢复唤醒采集\n");
       capturePaused = false;
     }
 
@@ -1650,7 +2347,7 @@ static void capture_samples(void *arg)
     // 检查读取结果
     if (result != ESP_OK || bytes_read <= 0)
     {
-      ei_printf("[音频调试] I2S读取错误: %d, 字节数: %d\n", result, bytes_read);
+      DLOG(1000, "[音频调试] I2S读取错误: %d, 字节数: %d\n", result, bytes_read);
       continue;
     }
 
@@ -1658,8 +2355,8 @@ static void capture_samples(void *arg)
     unsigned long current_time = millis();
     if (current_time - last_debug_time > 5000)
     {
-      ei_printf("[音频调试] I2S读取正常: %d 字节，样本数: %d，计数器: %d\n", 
-                bytes_read, bytes_read/2, debug_counter);
+      DLOG(0, "[音频调试] I2S读取正常: %d 字节，样本数: %d，计数器: %d\n",
+           bytes_read, bytes_read / 2, debug_counter);
       last_debug_time = current_time;
     }
     debug_counter++;
@@ -1667,7 +2364,7 @@ static void capture_samples(void *arg)
     // 检查是否为部分读取
     if (bytes_read < i2s_bytes_to_read)
     {
-      ei_printf("[音频调试] I2S部分读取: %d/%d 字节\n", bytes_read, i2s_bytes_to_read);
+      DLOG(1000, "[音频调试] I2S部分读取: %d/%d 字节\n", bytes_read, i2s_bytes_to_read);
     }
 
     // 音频数据增益处理（放大8倍以提高音量）
@@ -1760,6 +2457,7 @@ static bool microphone_inference_start(uint32_t n_samples)
   inference.buf_count = 0;
   inference.n_samples = n_samples;
   inference.buf_ready = 0;
+  inference.gate_open = true;
 
   // 等待系统稳定
   ei_sleep(100);
@@ -1885,40 +2583,35 @@ static void microphone_inference_end(void)
 }
 
 /**
- * @brief 光敏传感器任务
- * 根据环境光线自动控制照明
- * @param pvParameters 任务参数（未使用）
+ * @brief 光敏传感器作业
+ * 根据环境光线自动控制照明，每 LIGHT_SENSOR_POLL_MS 由传感器调度任务调用
+ * @param context 作业参数（未使用）
  */
-void lightSensorTask(void *pvParameters)
+void lightSensorJob(void *context)
 {
-  ei_printf("光敏传感器任务启动\n");
-
+  (void)context;
   static bool lastLightState = false;
-  static int debugCounter = 0;
 
-  while (1)
-  {
-    // 监控栈使用情况（每100次循环输出一次）
-    if (debugCounter % 100 == 0) {
-      UBaseType_t stackHighWaterMark = uxTaskGetStackHighWaterMark(NULL);
-      // ei_printf("[光敏传感器] 栈剩余: %d 字节\n", stackHighWaterMark * sizeof(StackType_t));
-    }
-    debugCounter++;
-
-    bool currentLightState = checkLightCondition();
-
-    // 只在状态改变时执行操作，避免重复输出
-    if (currentLightState != lastLightState)
-    {
-      controlLighting(currentLightState);
-      lastLightState = currentLightState;
-    }
+  bool currentLightState = checkLightCondition();
 
-    // 每隔一段时间检测一次
-    vTaskDelay(1000 / portTICK_PERIOD_MS);
+  // 只在状态改变时执行操作，避免重复输出
+  if (currentLightState != lastLightState)
+  {
+    controlLighting(currentLightState);
+    lastLightState = currentLightState;
   }
 }
 
+/**
+ * @brief GPS作业：读串口 NMEA，按间隔投递上报
+ * @param context 作业参数（未使用）
+ */
+void gpsJob(void *context)
+{
+  (void)context;
+  gpsServiceTick();
+}
+
 /**
  * @brief 检查光线条件
  * @return true表示黑暗，false表示明亮
@@ -1,5 +1,6 @@
 #include "network.h"
 #include "services/server_api.h"
+#include "utils/latency_trace.h"
 
 static const char *wifiStatusToString(wl_status_t status)
 {
@@ -109,10 +110,14 @@ void initWiFi()
     logMatchingWifiNetworks();
     isConnectedToWifi = false;
   }
+
+  // 不等待结果：SNTP 在后台重试，连上 WiFi 后自动校时
+  configTime(0, 0, SNTP_SERVER_PRIMARY, SNTP_SERVER_SECONDARY);
 }
 
 String sendTextToServer(String text)
 {
+  TRACE_SPAN(TraceServer);
   return ServerApi::postAiText(text);
 }
 
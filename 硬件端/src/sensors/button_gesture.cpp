@@ -0,0 +1,147 @@
+#include "button_gesture.h"
+
+void ButtonGestureDetector::onEdge(bool pressed, uint32_t timeMs)
+{
+  if (pressed == raw_)
+  {
+    return;
+  }
+  // 先按旧电平把状态机推进到边沿时刻：上一个电平若已保持够久，在这里生效
+  advance(timeMs);
+  raw_ = pressed;
+  rawSince_ = timeMs;
+}
+
+ButtonGesture ButtonGestureDetector::update(uint32_t nowMs)
+{
+  advance(nowMs);
+  if (pendingCount_ == 0)
+  {
+    return ButtonGesture::None;
+  }
+  ButtonGesture gesture = pending_[pendingHead_];
+  pendingHead_ = (pendingHead_ + 1) % (sizeof(pending_) / sizeof(pending_[0]));
+  --pendingCount_;
+  return gesture;
+}
+
+uint32_t ButtonGestureDetector::msUntilDeadline(uint32_t nowMs) const
+{
+  if (pendingCount_ > 0)
+  {
+    return 0;
+  }
+
+  uint32_t deadline = UINT32_MAX;
+  auto consider = [&](uint32_t since, uint32_t duration) {
+    uint32_t elapsed = nowMs - since;
+    uint32_t left = elapsed >= duration ? 0 : duration - elapsed;
+    if (left < deadline)
+    {
+      deadline = left;
+    }
+  };
+
+  if (raw_ != stable_)
+  {
+    consider(rawSince_, config_.debounceMs);
+  }
+  else if (raw_ && (state_ == State::Pressed || state_ == State::SecondPressed))
+  {
+    consider(pressAt_, config_.longPressMs);
+  }
+  else if (!raw_ && state_ == State::WaitSecond)
+  {
+    consider(releaseAt_, config_.doublePressGapMs);
+  }
+  return deadline;
+}
+
+void ButtonGestureDetector::reset(bool pressed, uint32_t nowMs)
+{
+  // 上电时按键已按下：视为长按已处理，松开后回到空闲，不补发手势
+  state_ = pressed ? State::LongHeld : State::Idle;
+  raw_ = pressed;
+  stable_ = pressed;
+  rawSince_ = nowMs;
+  pendingHead_ = 0;
+  pendingCount_ = 0;
+}
+
+void ButtonGestureDetector::advance(uint32_t nowMs)
+{
+  // 1. 原始电平保持满 debounceMs：以边沿时刻生效，按下时长和双击间隔都从真实边沿算起
+  if (raw_ != stable_ && nowMs - rawSince_ >= config_.debounceMs)
+  {
+    commit(raw_, rawSince_);
+  }
+
+  // 2. 长按：仍有未确认的松开边沿时先不判，等消抖结果
+  if (raw_ && stable_ && (state_ == State::Pressed || state_ == State::SecondPressed) &&
+      nowMs - pressAt_ >= config_.longPressMs)
+  {
+    if (state_ == State::SecondPressed)
+    {
+      emit(ButtonGesture::ShortPress);
+    }
+    emit(ButtonGesture::LongPress);
+    state_ = State::LongHeld;
+  }
+
+  // 3. 双击窗口结束且没有待确认的按下：第一次按下是单击
+  if (!raw_ && state_ == State::WaitSecond && nowMs - releaseAt_ >= config_.doublePressGapMs)
+  {
+    emit(ButtonGesture::ShortPress);
+    state_ = State::Idle;
+  }
+}
+
+void ButtonGestureDetector::commit(bool pressed, uint32_t atMs)
+{
+  stable_ = pressed;
+  if (pressed)
+  {
+    if (state_ == State::WaitSecond && atMs - releaseAt_ < config_.doublePressGapMs)
+    {
+      state_ = State::SecondPressed;
+    }
+    else
+    {
+      if (state_ == State::WaitSecond)
+      {
+        emit(ButtonGesture::ShortPress);
+      }
+      state_ = State::Pressed;
+    }
+    pressAt_ = atMs;
+    return;
+  }
+
+  switch (state_)
+  {
+  case State::Pressed:
+    state_ = State::WaitSecond;
+    releaseAt_ = atMs;
+    break;
+  case State::SecondPressed:
+    emit(ButtonGesture::DoublePress);
+    state_ = State::Idle;
+    break;
+  default:
+    state_ = State::Idle;
+    break;
+  }
+}
+
+void ButtonGestureDetector::emit(ButtonGesture gesture)
+{
+  const uint8_t capacity = sizeof(pending_) / sizeof(pending_[0]);
+  if (pendingCount_ == capacity)
+  {
+    // 调用方长时间不取：丢最旧的
+    pendingHead_ = (pendingHead_ + 1) % capacity;
+    --pendingCount_;
+  }
+  pending_[(pendingHead_ + pendingCount_) % capacity] = gesture;
+  ++pendingCount_;
+}
@@ -0,0 +1,66 @@
+#ifndef BUTTON_GESTURE_H
+#define BUTTON_GESTURE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// 按键手势状态机：输入为中断里打了时间戳的原始边沿，电平保持 debounceMs 才算稳定
+// （按边沿时刻计时，不固定延时），在稳定的按下/松开上识别单击、长按、双击。
+// 纯逻辑，不依赖 Arduino，主机端用合成边沿时序验证（tools/button_gesture_replay.cpp）。
+enum class ButtonGesture : uint8_t
+{
+  None,
+  ShortPress,  // 松开后 doublePressGapMs 内没有再次按下
+  LongPress,   // 按住满 longPressMs 即触发，不等松开
+  DoublePress  // 两次短按，第二次松开时触发
+};
+
+struct ButtonGestureConfig
+{
+  uint16_t debounceMs = 25;        // 短于它的脉冲视为抖动
+  uint16_t longPressMs = 800;
+  uint16_t doublePressGapMs = 250; // 第一次松开到第二次按下的最大间隔
+};
+
+class ButtonGestureDetector
+{
+public:
+  explicit ButtonGestureDetector(const ButtonGestureConfig &config = ButtonGestureConfig()) : config_(config) {}
+
+  // 原始边沿：pressed 为边沿之后的电平；与上一个边沿电平相同（丢了反向边沿或抖动）时忽略
+  void onEdge(bool pressed, uint32_t timeMs);
+  // 把状态机推进到 nowMs，取出一个已识别的手势；同一时刻可能产生两个（单击后紧跟长按），需循环取到 None
+  ButtonGesture update(uint32_t nowMs);
+  // 距离下一个需要 update 的时刻（消抖结束、长按阈值、双击窗口）；没有待定事件时返回 UINT32_MAX
+  uint32_t msUntilDeadline(uint32_t nowMs) const;
+  // 最后一个原始边沿的电平，按键任务超时后与 GPIO 比较以补回丢失的边沿
+  bool rawPressed() const { return raw_; }
+  void reset(bool pressed, uint32_t nowMs);
+
+private:
+  enum class State : uint8_t
+  {
+    Idle,
+    Pressed,        // 第一次按下
+    LongHeld,       // 已触发长按，等松开
+    WaitSecond,     // 第一次松开，等待双击
+    SecondPressed
+  };
+
+  void advance(uint32_t nowMs);
+  void commit(bool pressed, uint32_t atMs);
+  void emit(ButtonGesture gesture);
+
+  ButtonGestureConfig config_;
+  State state_ = State::Idle;
+  bool raw_ = false;
+  bool stable_ = false;
+  uint32_t rawSince_ = 0;
+  uint32_t pressAt_ = 0;
+  uint32_t releaseAt_ = 0;
+  ButtonGesture pending_[4] = {};
+  uint8_t pendingHead_ = 0;
+  uint8_t pendingCount_ = 0;
+};
+
+#endif // BUTTON_GESTURE_H
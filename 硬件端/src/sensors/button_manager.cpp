@@ -1,10 +1,164 @@
 #include "button_manager.h"
 
 #include <Arduino.h>
+#include <driver/gpio.h>
+#include <esp_timer.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
 
 #include "config.h"
+#include "services/sensor_scheduler.h"
+#include "utils/deferred_log.h"
+
+namespace
+{
+struct ButtonEdge
+{
+  uint32_t timeMs;
+  bool pressed;
+};
+
+ButtonGestureConfig gestureConfig()
+{
+  ButtonGestureConfig config;
+  config.debounceMs = BUTTON_DEBOUNCE_MS;
+  config.longPressMs = BUTTON_LONG_PRESS_MS;
+  config.doublePressGapMs = BUTTON_DOUBLE_PRESS_GAP_MS;
+  return config;
+}
+
+// 没有待定截止时刻时也每秒检查一次，用于补回丢失的边沿
+const uint32_t kIdleResyncMs = 1000;
+
+QueueHandle_t edgeQueue = nullptr;
+ButtonGestureDetector detector(gestureConfig());
+ButtonGestureHandler gestureHandler = nullptr;
+int buttonJob = TimerWheel::kInvalidJob;
+portMUX_TYPE statsMux = portMUX_INITIALIZER_UNLOCKED;
+ButtonManagerStats stats = {};
+
+// 按下为低电平（INPUT_PULLUP）
+bool readPressed()
+{
+  return gpio_get_level(static_cast<gpio_num_t>(TEST_BUTTON_PIN)) == 0;
+}
+
+void IRAM_ATTR onButtonEdge()
+{
+  ButtonEdge edge;
+  edge.timeMs = static_cast<uint32_t>(esp_timer_get_time() / 1000);
+  edge.pressed = readPressed();
+  // 没有任务阻塞在队列上，由调度作业取，这里只需唤醒调度任务
+  bool queued = xQueueSendFromISR(edgeQueue, &edge, nullptr) == pdTRUE;
+  portENTER_CRITICAL_ISR(&statsMux);
+  ++stats.edges;
+  if (!queued)
+  {
+    ++stats.droppedEdges;
+  }
+  portEXIT_CRITICAL_ISR(&statsMux);
+  sensorSchedulerKickFromISR(buttonJob);
+}
+
+void countGesture(ButtonGesture gesture)
+{
+  portENTER_CRITICAL(&statsMux);
+  switch (gesture)
+  {
+  case ButtonGesture::ShortPress:
+    ++stats.shortPresses;
+    break;
+  case ButtonGesture::LongPress:
+    ++stats.longPresses;
+    break;
+  case ButtonGesture::DoublePress:
+    ++stats.doublePresses;
+    break;
+  default:
+    break;
+  }
+  portEXIT_CRITICAL(&statsMux);
+}
+
+// 调度作业：中断唤醒或截止时刻到达时执行
+void buttonJobRun(void *context)
+{
+  (void)context;
+  bool drained = false;
+  ButtonEdge edge;
+  while (xQueueReceive(edgeQueue, &edge, 0) == pdTRUE)
+  {
+    detector.onEdge(edge.pressed, edge.timeMs);
+    drained = true;
+  }
+
+  // 队列满时丢过边沿：截止时刻醒来仍与实际电平不一致就按现在的电平补一个
+  if (!drained)
+  {
+    bool pressed = readPressed();
+    if (pressed != detector.rawPressed())
+    {
+      detector.onEdge(pressed, millis());
+    }
+  }
+
+  uint32_t now = millis();
+  for (ButtonGesture gesture = detector.update(now); gesture != ButtonGesture::None; gesture = detector.update(now))
+  {
+    countGesture(gesture);
+    if (gestureHandler != nullptr)
+    {
+      gestureHandler(gesture);
+    }
+  }
+
+  // 截止时刻向上取整到时间轮 tick，消抖判定只会晚不会早
+  uint32_t waitMs = detector.msUntilDeadline(millis());
+  sensorSchedulerReschedule(buttonJob, waitMs < kIdleResyncMs ? waitMs : kIdleResyncMs);
+}
+} // namespace
 
 void buttonManagerInitPins()
 {
   pinMode(TEST_BUTTON_PIN, INPUT_PULLUP);
 }
+
+bool buttonManagerBegin(ButtonGestureHandler handler)
+{
+  if (edgeQueue != nullptr)
+  {
+    return true;
+  }
+  edgeQueue = xQueueCreate(BUTTON_EDGE_QUEUE_LENGTH, sizeof(ButtonEdge));
+  if (edgeQueue == nullptr)
+  {
+    return false;
+  }
+  buttonJob = sensorSchedulerAddOneShot("button", kIdleResyncMs, buttonJobRun, nullptr);
+  if (buttonJob == TimerWheel::kInvalidJob)
+  {
+    vQueueDelete(edgeQueue);
+    edgeQueue = nullptr;
+    return false;
+  }
+  gestureHandler = handler;
+  detector.reset(readPressed(), millis());
+  attachInterrupt(digitalPinToInterrupt(TEST_BUTTON_PIN), onButtonEdge, CHANGE);
+  return true;
+}
+
+ButtonManagerStats buttonManagerStats()
+{
+  portENTER_CRITICAL(&statsMux);
+  ButtonManagerStats copy = stats;
+  portEXIT_CRITICAL(&statsMux);
+  return copy;
+}
+
+void buttonManagerReportStats()
+{
+  ButtonManagerStats stats = buttonManagerStats();
+  DLOG(0, "[按键] 边沿: %u, 队列满丢弃: %u, 单击: %u, 长按: %u, 双击: %u\n",
+       stats.edges, stats.droppedEdges, stats.shortPresses, stats.longPresses, stats.doublePresses);
+}
@@ -1,6 +1,27 @@
 #ifndef BUTTON_MANAGER_H
 #define BUTTON_MANAGER_H
 
+#include <stdint.h>
+
+#include "button_gesture.h"
+
+struct ButtonManagerStats
+{
+  uint32_t edges;         // 中断收到的边沿（含抖动）
+  uint32_t droppedEdges;  // 队列满丢弃，之后按 GPIO 电平补齐
+  uint32_t shortPresses;
+  uint32_t longPresses;
+  uint32_t doublePresses;
+};
+
+// 在传感器调度任务上调用，不能阻塞
+typedef void (*ButtonGestureHandler)(ButtonGesture gesture);
+
 void buttonManagerInitPins();
+// 建边沿队列、登记传感器调度作业并挂 GPIO 中断（CHANGE），在 sensorSchedulerStart() 之前调用一次。
+// 中断入队后提前唤醒作业；作业处理边沿后按下一个消抖/长按/双击截止时刻重新登记，不做固定延时
+bool buttonManagerBegin(ButtonGestureHandler handler);
+ButtonManagerStats buttonManagerStats();
+void buttonManagerReportStats();
 
 #endif // BUTTON_MANAGER_H
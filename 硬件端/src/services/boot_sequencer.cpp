@@ -0,0 +1,179 @@
+#include "boot_sequencer.h"
+
+#include <Arduino.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
+#include "freertos/task.h"
+
+#include "../config.h"
+
+namespace
+{
+struct BootStage
+{
+  const char *name;
+  BootStageFn run;
+  uint32_t dependsOn;
+  uint32_t stackSize;
+  uint32_t startMs;
+  uint32_t endMs;
+  bool ok;
+};
+
+const char *const kMilestoneNames[] = {"避障就绪", "语音就绪"};
+
+BootStage stages[BOOT_MAX_STAGES];
+size_t stageCount = 0;
+size_t remaining = 0;
+EventGroupHandle_t doneBits = nullptr;
+portMUX_TYPE bootMux = portMUX_INITIALIZER_UNLOCKED;
+volatile uint32_t milestoneMs[static_cast<size_t>(BootMilestone::Count)] = {};
+
+void printSummary()
+{
+  Serial.println("[Boot] 开机阶段（开机后 ms）:");
+  for (size_t i = 0; i < stageCount; ++i)
+  {
+    const BootStage &stage = stages[i];
+    Serial.printf("[Boot]   %-10s %6lu -> %6lu  (%5lu ms) %s\n", stage.name,
+                  static_cast<unsigned long>(stage.startMs), static_cast<unsigned long>(stage.endMs),
+                  static_cast<unsigned long>(stage.endMs - stage.startMs), stage.ok ? "ok" : "FAILED");
+  }
+  for (size_t i = 0; i < static_cast<size_t>(BootMilestone::Count); ++i)
+  {
+    if (milestoneMs[i] != 0)
+    {
+      Serial.printf("[Boot]   %s: %lu ms\n", kMilestoneNames[i], static_cast<unsigned long>(milestoneMs[i]));
+    }
+    else
+    {
+      Serial.printf("[Boot]   %s: 未达到\n", kMilestoneNames[i]);
+    }
+  }
+}
+
+void runStage(size_t index)
+{
+  BootStage &stage = stages[index];
+  if (stage.dependsOn != 0)
+  {
+    xEventGroupWaitBits(doneBits, stage.dependsOn, pdFALSE, pdTRUE, portMAX_DELAY);
+  }
+
+  stage.startMs = millis();
+  stage.ok = stage.run();
+  stage.endMs = millis();
+  Serial.printf("[Boot] %s %s in %lu ms\n", stage.name, stage.ok ? "done" : "failed",
+                static_cast<unsigned long>(stage.endMs - stage.startMs));
+  xEventGroupSetBits(doneBits, BOOT_STAGE_BIT(index));
+
+  portENTER_CRITICAL(&bootMux);
+  bool last = --remaining == 0;
+  portEXIT_CRITICAL(&bootMux);
+  if (last)
+  {
+    printSummary();
+  }
+}
+
+void stageTask(void *parameter)
+{
+  runStage(reinterpret_cast<uintptr_t>(parameter));
+  vTaskDelete(nullptr);
+}
+} // namespace
+
+int bootStageAdd(const char *name, BootStageFn run, uint32_t dependsOn, uint32_t stackSize)
+{
+  // 只能依赖已登记的阶段，登记顺序即拓扑序，不会成环
+  if (doneBits != nullptr || stageCount >= BOOT_MAX_STAGES || (dependsOn >> stageCount) != 0)
+  {
+    Serial.printf("[Boot] Stage %s rejected.\n", name);
+    return -1;
+  }
+  BootStage &stage = stages[stageCount];
+  stage.name = name;
+  stage.run = run;
+  stage.dependsOn = dependsOn;
+  stage.stackSize = stackSize;
+  stage.startMs = 0;
+  stage.endMs = 0;
+  stage.ok = false;
+  return static_cast<int>(stageCount++);
+}
+
+bool bootSequencerStart()
+{
+  if (doneBits != nullptr)
+  {
+    return true;
+  }
+  doneBits = xEventGroupCreate();
+  if (doneBits == nullptr)
+  {
+    Serial.println("[Boot] Init failed: out of memory.");
+    return false;
+  }
+
+  remaining = stageCount;
+  bool allStarted = true;
+  for (size_t i = 0; i < stageCount; ++i)
+  {
+    if (xTaskCreate(stageTask, stages[i].name, stages[i].stackSize, reinterpret_cast<void *>(i),
+                    BOOT_STAGE_TASK_PRIORITY, nullptr) != pdPASS)
+    {
+      // 建不了任务就在当前任务上执行，依赖它的阶段照常等待置位
+      Serial.printf("[Boot] %s: task not created, running inline.\n", stages[i].name);
+      allStarted = false;
+      runStage(i);
+    }
+  }
+  return allStarted;
+}
+
+bool bootStagesDone(uint32_t mask, uint32_t timeoutMs)
+{
+  if (doneBits == nullptr)
+  {
+    return false;
+  }
+  EventBits_t bits = xEventGroupWaitBits(doneBits, mask, pdFALSE, pdTRUE, pdMS_TO_TICKS(timeoutMs));
+  return (bits & mask) == mask;
+}
+
+bool bootStageOk(int id)
+{
+  return id >= 0 && static_cast<size_t>(id) < stageCount && bootStagesDone(BOOT_STAGE_BIT(id)) && stages[id].ok;
+}
+
+void bootMarkMilestone(BootMilestone milestone)
+{
+  size_t slot = static_cast<size_t>(milestone);
+  if (milestoneMs[slot] != 0)
+  {
+    return;
+  }
+  uint32_t nowMs = millis();
+  portENTER_CRITICAL(&bootMux);
+  bool first = milestoneMs[slot] == 0;
+  if (first)
+  {
+    milestoneMs[slot] = nowMs > 0 ? nowMs : 1;
+  }
+  portEXIT_CRITICAL(&bootMux);
+  if (first)
+  {
+    Serial.printf("[Boot] %s: 开机后 %lu ms\n", kMilestoneNames[slot], static_cast<unsigned long>(nowMs));
+  }
+}
+
+bool bootMilestoneReached(BootMilestone milestone)
+{
+  return milestoneMs[static_cast<size_t>(milestone)] != 0;
+}
+
+uint32_t bootMilestoneMs(BootMilestone milestone)
+{
+  return milestoneMs[static_cast<size_t>(milestone)];
+}
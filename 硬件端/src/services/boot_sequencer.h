@@ -0,0 +1,35 @@
+#ifndef BOOT_SEQUENCER_H
+#define BOOT_SEQUENCER_H
+
+#include <stdint.h>
+
+// 开机阶段调度：每个阶段声明依赖的阶段，依赖全部完成后在自己的临时任务上执行，
+// 互不依赖的阶段（WiFi、LittleFS、I2S、Token 等）并行。安全相关的任务在 setup() 里最先启动，
+// 不登记为阶段。阶段结束（不论成败）都会置位，依赖方自行判断前序是否成功。
+// 所有阶段结束后打印各阶段的起止时间，以及避障就绪、语音就绪两个里程碑的开机耗时。
+
+#define BOOT_STAGE_BIT(id) (1UL << (id))
+
+typedef bool (*BootStageFn)();
+
+enum class BootMilestone : uint8_t
+{
+  ObstacleReady, // 超声波任务完成第一次测距
+  VoiceReady,    // Token、I2S、唤醒词都已就绪，可以开始语音交互
+  Count
+};
+
+// 在 bootSequencerStart 之前登记；返回阶段 id（用于 BOOT_STAGE_BIT），登记满时返回 -1
+int bootStageAdd(const char *name, BootStageFn run, uint32_t dependsOn, uint32_t stackSize);
+bool bootSequencerStart();
+// 阻塞等待 mask 中的阶段全部结束；timeoutMs 为 0 时只检查不等待
+bool bootStagesDone(uint32_t mask, uint32_t timeoutMs = 0);
+bool bootStageOk(int id);
+
+// 记录里程碑（只记第一次），任何任务都可调用
+void bootMarkMilestone(BootMilestone milestone);
+bool bootMilestoneReached(BootMilestone milestone);
+// 开机到里程碑的毫秒数，未达到时为 0
+uint32_t bootMilestoneMs(BootMilestone milestone);
+
+#endif // BOOT_SEQUENCER_H
@@ -0,0 +1,684 @@
+#include "fast_intent.h"
+
+#include <ArduinoJson.h>
+#include <string.h>
+
+#ifdef ARDUINO
+#include <HTTPClient.h>
+#include <LittleFS.h>
+#include <WiFi.h>
+#include <esp_heap_caps.h>
+#include <new>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+#include "../config.h"
+#include "network_worker.h"
+#endif
+
+namespace
+{
+enum RuleMatch : uint8_t
+{
+  kMatchExact,
+  kMatchPrefix,
+  kMatchContains
+};
+
+enum RuleWhen : uint8_t
+{
+  kWhenAlways,
+  kWhenNavigationActive,
+  kWhenNavigationInactive
+};
+
+// 与 web/services/fast_intent_rules.py 的 rules_payload() 保持一致
+const char kDefaultRulesJson[] = R"JSON({"format":1,"normalize_strip":"，。！？!?,.、","rules":[{"intent":"chat.normal","match":"exact","keywords":["你好","喂","在吗","小助手","您好"],"action":"local_audio","audio_id":"hello_001","text":"我在呢，请说导航、天气或者帮助。","when":"always","follow_up":"none"},{"intent":"chat.normal","match":"contains","keywords":["讲个笑话","讲笑话","说个笑话","来个笑话","笑话"],"action":"speak","audio_id":"","text":"当然。路灯为什么不睡觉？因为它一闭眼，整条街就黑了。","when":"always","follow_up":"none"},{"intent":"chat.normal","match":"contains","keywords":["讲个故事","讲故事","说个故事","来个故事","故事"],"action":"speak","audio_id":"","text":"当然。从前有颗小星星迷了路，听见脚步声后，跟着勇气回了家。","when":"always","follow_up":"none"},{"intent":"chat.normal","match":"contains","keywords":["陪我聊天","聊聊天","陪我说话","和我聊天","安慰我","鼓励我"],"action":"speak","audio_id":"","text":"我在呢。你可以慢慢说，我会陪你聊，也能帮你导航和查天气。","when":"always","follow_up":"none"},{"intent":"system.help","match":"exact","keywords":["你能做什么","帮助","怎么用"],"action":"speak","audio_id":"","text":"我可以帮你导航、查询天气、播报当前位置和查看设备状态。请说导航到某地，或者问今天天气。","when":"always","follow_up":"none"},{"intent":"navigation.exit","match":"exact","keywords":["停止导航","取消导航","结束导航","退出导航","不去了","停止","取消","算了","退出"],"action":"local_audio","audio_id":"nav_exit_001","text":"已退出导航。","when":"navigation_active","follow_up":"exit_navigation"},{"intent":"navigation.exit","match":"exact","keywords":["停止导航","取消导航","结束导航","退出导航"],"action":"local_audio","audio_id":"no_navigation_001","text":"当前没有进行中的导航。","when":"navigation_inactive","follow_up":"none"},{"intent":"navigation.start","match":"prefix","keywords":["帮我导航到","导航到","带我去","我要去","去"],"action":"server","audio_id":"nav_starting_001","text":"","when":"always","follow_up":"none"},{"intent":"weather.query","match":"contains","keywords":["天气","下雨","温度","冷不冷","热不热","气温"],"action":"server","audio_id":"","text":"","when":"always","follow_up":"none"},{"intent":"navigation.update","match":"contains","keywords":["下一步","继续导航","现在怎么走","怎么走"],"action":"server","audio_id":"","text":"","when":"always","follow_up":"none"},{"intent":"navigation.status","match":"contains","keywords":["还有多远","到哪了","快到了吗"],"action":"local_audio","audio_id":"no_navigation_001","text":"当前没有进行中的导航。","when":"navigation_inactive","follow_up":"none"},{"intent":"navigation.status","match":"contains","keywords":["还有多远","到哪了","快到了吗"],"action":"server","audio_id":"","text":"","when":"navigation_active","follow_up":"none"}],"version":"24178f572ec1e7aa"})JSON";
+
+bool parseMatch(const char *value, uint8_t *out)
+{
+  if (strcmp(value, "exact") == 0)
+  {
+    *out = kMatchExact;
+  }
+  else if (strcmp(value, "prefix") == 0)
+  {
+    *out = kMatchPrefix;
+  }
+  else if (strcmp(value, "contains") == 0)
+  {
+    *out = kMatchContains;
+  }
+  else
+  {
+    return false;
+  }
+  return true;
+}
+
+bool parseAction(const char *value, uint8_t *out)
+{
+  if (strcmp(value, "server") == 0)
+  {
+    *out = static_cast<uint8_t>(FastIntentAction::Server);
+  }
+  else if (strcmp(value, "local_audio") == 0)
+  {
+    *out = static_cast<uint8_t>(FastIntentAction::LocalAudio);
+  }
+  else if (strcmp(value, "speak") == 0)
+  {
+    *out = static_cast<uint8_t>(FastIntentAction::Speak);
+  }
+  else
+  {
+    return false;
+  }
+  return true;
+}
+
+uint8_t parseWhen(const char *value)
+{
+  if (strcmp(value, "navigation_active") == 0)
+  {
+    return kWhenNavigationActive;
+  }
+  if (strcmp(value, "navigation_inactive") == 0)
+  {
+    return kWhenNavigationInactive;
+  }
+  return kWhenAlways;
+}
+
+uint8_t parseFollowUp(const char *value)
+{
+  if (strcmp(value, "exit_navigation") == 0)
+  {
+    return static_cast<uint8_t>(FastIntentFollowUp::ExitNavigation);
+  }
+  return static_cast<uint8_t>(FastIntentFollowUp::None);
+}
+
+size_t utf8CharLength(uint8_t lead)
+{
+  if (lead < 0x80)
+  {
+    return 1;
+  }
+  if ((lead & 0xE0) == 0xC0)
+  {
+    return 2;
+  }
+  if ((lead & 0xF0) == 0xE0)
+  {
+    return 3;
+  }
+  if ((lead & 0xF8) == 0xF0)
+  {
+    return 4;
+  }
+  return 1;
+}
+
+bool isStripChar(const char *ch, size_t length, const char *strip)
+{
+  if (length == 1 && (ch[0] == ' ' || ch[0] == '\t' || ch[0] == '\r' || ch[0] == '\n'))
+  {
+    return true;
+  }
+  // 全角空格 U+3000
+  if (length == 3 && memcmp(ch, "\xE3\x80\x80", 3) == 0)
+  {
+    return true;
+  }
+  for (const char *p = strip; *p != '\0';)
+  {
+    size_t stripLength = utf8CharLength(static_cast<uint8_t>(*p));
+    if (stripLength == length && memcmp(p, ch, length) == 0)
+    {
+      return true;
+    }
+    p += stripLength;
+  }
+  return false;
+}
+} // namespace
+
+const char *fastIntentDefaultRules()
+{
+  return kDefaultRulesJson;
+}
+
+void FastIntentMatcher::reset()
+{
+  nodeCount_ = 1;
+  keywordCount_ = 0;
+  ruleCount_ = 0;
+  poolUsed_ = 0;
+  version_[0] = '\0';
+  nodes_[0] = {kNone, kNone, 0, kNone, kNone, 0};
+  strip_ = poolString("");
+}
+
+uint16_t FastIntentMatcher::poolString(const char *value)
+{
+  size_t length = value == nullptr ? 0 : strlen(value);
+  if (poolUsed_ + length + 1 > kPoolBytes)
+  {
+    return kNone;
+  }
+  uint16_t offset = static_cast<uint16_t>(poolUsed_);
+  memcpy(pool_ + poolUsed_, value == nullptr ? "" : value, length);
+  pool_[poolUsed_ + length] = '\0';
+  poolUsed_ += length + 1;
+  return offset;
+}
+
+uint16_t FastIntentMatcher::child(uint16_t node, uint8_t byte) const
+{
+  for (uint16_t next = nodes_[node].firstChild; next != kNone; next = nodes_[next].nextSibling)
+  {
+    if (nodes_[next].byte == byte)
+    {
+      return next;
+    }
+  }
+  return kNone;
+}
+
+bool FastIntentMatcher::insertKeyword(const char *keyword, uint16_t rule, uint16_t order)
+{
+  size_t length = strlen(keyword);
+  if (length == 0 || length >= kMaxTextBytes || keywordCount_ >= kMaxKeywords)
+  {
+    return false;
+  }
+
+  uint16_t node = 0;
+  for (size_t i = 0; i < length; ++i)
+  {
+    uint8_t byte = static_cast<uint8_t>(keyword[i]);
+    uint16_t next = child(node, byte);
+    if (next == kNone)
+    {
+      if (nodeCount_ >= kMaxNodes)
+      {
+        return false;
+      }
+      next = static_cast<uint16_t>(nodeCount_++);
+      nodes_[next] = {kNone, nodes_[node].firstChild, 0, kNone, kNone, byte};
+      nodes_[node].firstChild = next;
+    }
+    node = next;
+  }
+
+  uint16_t index = static_cast<uint16_t>(keywordCount_++);
+  keywords_[index] = {rule, order, static_cast<uint16_t>(length), nodes_[node].output};
+  nodes_[node].output = index;
+  return true;
+}
+
+bool FastIntentMatcher::buildFailLinks()
+{
+  size_t head = 0;
+  size_t tail = 0;
+  for (uint16_t next = nodes_[0].firstChild; next != kNone; next = nodes_[next].nextSibling)
+  {
+    nodes_[next].fail = 0;
+    nodes_[next].dictLink = kNone;
+    queue_[tail++] = next;
+  }
+
+  while (head < tail)
+  {
+    uint16_t node = queue_[head++];
+    for (uint16_t next = nodes_[node].firstChild; next != kNone; next = nodes_[next].nextSibling)
+    {
+      uint16_t fail = nodes_[node].fail;
+      uint16_t target = child(fail, nodes_[next].byte);
+      while (target == kNone && fail != 0)
+      {
+        fail = nodes_[fail].fail;
+        target = child(fail, nodes_[next].byte);
+      }
+      nodes_[next].fail = target == kNone ? 0 : target;
+
+      uint16_t failNode = nodes_[next].fail;
+      nodes_[next].dictLink = nodes_[failNode].output != kNone ? failNode : nodes_[failNode].dictLink;
+      if (tail >= kMaxNodes)
+      {
+        return false;
+      }
+      queue_[tail++] = next;
+    }
+  }
+  return true;
+}
+
+bool FastIntentMatcher::load(const char *json, size_t length)
+{
+  JsonDocument doc;
+  DeserializationError error = deserializeJson(doc, json, length);
+  if (error || (doc["format"] | 0) != 1)
+  {
+    return false;
+  }
+
+  JsonArrayConst rules = doc["rules"];
+  if (rules.isNull() || rules.size() == 0 || rules.size() > kMaxRules)
+  {
+    return false;
+  }
+
+  reset();
+  strip_ = poolString(doc["normalize_strip"] | "");
+  for (JsonObjectConst rule : rules)
+  {
+    Rule parsed = {};
+    if (!parseMatch(rule["match"] | "", &parsed.match) || !parseAction(rule["action"] | "", &parsed.action))
+    {
+      reset();
+      return false;
+    }
+    parsed.when = parseWhen(rule["when"] | "always");
+    parsed.followUp = parseFollowUp(rule["follow_up"] | "none");
+    parsed.intent = poolString(rule["intent"] | "");
+    parsed.audioId = poolString(rule["audio_id"] | "");
+    parsed.text = poolString(rule["text"] | "");
+    if (parsed.intent == kNone || parsed.audioId == kNone || parsed.text == kNone)
+    {
+      reset();
+      return false;
+    }
+
+    uint16_t ruleIndex = static_cast<uint16_t>(ruleCount_);
+    uint16_t order = 0;
+    for (JsonVariantConst keyword : rule["keywords"].as<JsonArrayConst>())
+    {
+      if (!insertKeyword(keyword | "", ruleIndex, order++))
+      {
+        reset();
+        return false;
+      }
+    }
+    rules_[ruleCount_++] = parsed;
+  }
+
+  if (strip_ == kNone || !buildFailLinks())
+  {
+    reset();
+    ruleCount_ = 0;
+    return false;
+  }
+
+  const char *version = doc["version"] | "";
+  strncpy(version_, version, sizeof(version_) - 1);
+  version_[sizeof(version_) - 1] = '\0';
+  return true;
+}
+
+size_t FastIntentMatcher::normalize(const char *text, char *out, size_t outSize) const
+{
+  const char *strip = pool_ + strip_;
+  size_t written = 0;
+  while (*text != '\0')
+  {
+    size_t length = utf8CharLength(static_cast<uint8_t>(*text));
+    if (strnlen(text, length) < length)
+    {
+      break;
+    }
+    if (!isStripChar(text, length, strip))
+    {
+      if (written + length >= outSize)
+      {
+        break;
+      }
+      memcpy(out + written, text, length);
+      written += length;
+    }
+    text += length;
+  }
+  out[written] = '\0';
+  return written;
+}
+
+bool FastIntentMatcher::match(const char *text, bool navigationActive, FastIntentMatch *out) const
+{
+  *out = FastIntentMatch();
+  if (!loaded() || text == nullptr)
+  {
+    return false;
+  }
+
+  char normalized[kMaxTextBytes];
+  size_t length = normalize(text, normalized, sizeof(normalized));
+  if (length == 0)
+  {
+    return false;
+  }
+
+  uint16_t bestKeyword = kNone;
+  uint16_t state = 0;
+  for (size_t i = 0; i < length; ++i)
+  {
+    uint8_t byte = static_cast<uint8_t>(normalized[i]);
+    uint16_t next = child(state, byte);
+    while (next == kNone && state != 0)
+    {
+      state = nodes_[state].fail;
+      next = child(state, byte);
+    }
+    state = next == kNone ? 0 : next;
+
+    uint16_t hit = nodes_[state].output != kNone ? state : nodes_[state].dictLink;
+    for (; hit != kNone; hit = nodes_[hit].dictLink)
+    {
+      for (uint16_t k = nodes_[hit].output; k != kNone; k = keywords_[k].nextAtNode)
+      {
+        const Keyword &keyword = keywords_[k];
+        const Rule &rule = rules_[keyword.rule];
+        size_t end = i + 1;
+        size_t start = end - keyword.length;
+
+        if ((rule.when == kWhenNavigationActive && !navigationActive) ||
+            (rule.when == kWhenNavigationInactive && navigationActive))
+        {
+          continue;
+        }
+        if (rule.match == kMatchExact && (start != 0 || end != length))
+        {
+          continue;
+        }
+        if (rule.match == kMatchPrefix && (start != 0 || end == length))
+        {
+          continue;
+        }
+
+        // 规则顺序优先，同一规则内按关键词顺序，与服务端逐条判断等价
+        if (bestKeyword == kNone ||
+            keyword.rule < keywords_[bestKeyword].rule ||
+            (keyword.rule == keywords_[bestKeyword].rule && keyword.order < keywords_[bestKeyword].order))
+        {
+          bestKeyword = k;
+        }
+      }
+    }
+  }
+
+  if (bestKeyword == kNone)
+  {
+    return false;
+  }
+
+  const Keyword &keyword = keywords_[bestKeyword];
+  const Rule &rule = rules_[keyword.rule];
+  out->ruleIndex = keyword.rule;
+  out->action = static_cast<FastIntentAction>(rule.action);
+  out->followUp = static_cast<FastIntentFollowUp>(rule.followUp);
+  out->intent = pool_ + rule.intent;
+  out->audioId = pool_ + rule.audioId;
+  out->text = pool_ + rule.text;
+  if (rule.match == kMatchPrefix)
+  {
+    out->argument = normalized + keyword.length;
+  }
+  return true;
+}
+
+#ifdef ARDUINO
+namespace
+{
+constexpr const char *kRulesPath = "/fast_intent_rules.json";
+constexpr const char *kRulesTmpPath = "/fast_intent_rules.tmp";
+
+// 两份匹配器放在 PSRAM：后台同步写备用份，成功后在锁内交换
+FastIntentMatcher *activeMatcher = nullptr;
+FastIntentMatcher *standbyMatcher = nullptr;
+SemaphoreHandle_t matcherMutex = nullptr;
+
+// 后台 /ai 在网络任务上执行：每次发起递增代次，等待超时后代次作废，迟到的回复直接丢弃
+SemaphoreHandle_t serverReplyMutex = nullptr;
+SemaphoreHandle_t serverReplyReady = nullptr;
+String *pendingServerReply = nullptr;
+uint32_t serverRequestGeneration = 0;
+
+class MatcherLock
+{
+public:
+  MatcherLock() { xSemaphoreTake(matcherMutex, portMAX_DELAY); }
+  ~MatcherLock() { xSemaphoreGive(matcherMutex); }
+};
+
+FastIntentMatcher *allocateMatcher()
+{
+  void *memory = heap_caps_malloc(sizeof(FastIntentMatcher), MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+  if (memory == nullptr)
+  {
+    memory = malloc(sizeof(FastIntentMatcher));
+  }
+  return memory == nullptr ? nullptr : new (memory) FastIntentMatcher();
+}
+
+bool loadRulesFile(FastIntentMatcher *matcher)
+{
+  File file = LittleFS.open(kRulesPath, "r");
+  if (!file)
+  {
+    return false;
+  }
+  String json = file.readString();
+  file.close();
+  return matcher->load(json.c_str(), json.length());
+}
+
+void saveRulesFile(const String &json)
+{
+  File file = LittleFS.open(kRulesTmpPath, "w");
+  if (!file)
+  {
+    return;
+  }
+  bool ok = file.print(json) == json.length();
+  file.close();
+  if (ok)
+  {
+    LittleFS.remove(kRulesPath);
+    ok = LittleFS.rename(kRulesTmpPath, kRulesPath);
+  }
+  if (!ok)
+  {
+    LittleFS.remove(kRulesTmpPath);
+  }
+}
+
+void onExitNavigationDone(const NetworkJobResult &result, void *context)
+{
+  (void)context;
+  Serial.printf("[FastIntent] Background exit_navigation %s\n", result.ok ? "acknowledged" : "failed");
+}
+
+void onServerReplyDone(const NetworkJobResult &result, void *context)
+{
+  uint32_t generation = (uint32_t)(uintptr_t)context;
+  xSemaphoreTake(serverReplyMutex, portMAX_DELAY);
+  if (generation == serverRequestGeneration)
+  {
+    *pendingServerReply = result.payload;
+    xSemaphoreGive(serverReplyReady);
+  }
+  else
+  {
+    Serial.printf("[FastIntent] Dropping late /ai reply (%lu ms)\n", static_cast<unsigned long>(result.elapsedMs));
+  }
+  xSemaphoreGive(serverReplyMutex);
+}
+} // namespace
+
+bool fastIntentInit()
+{
+  if (activeMatcher != nullptr)
+  {
+    return activeMatcher->loaded();
+  }
+
+  matcherMutex = xSemaphoreCreateMutex();
+  serverReplyMutex = xSemaphoreCreateMutex();
+  serverReplyReady = xSemaphoreCreateBinary();
+  pendingServerReply = new String();
+  activeMatcher = allocateMatcher();
+  standbyMatcher = allocateMatcher();
+  if (matcherMutex == nullptr || serverReplyMutex == nullptr || serverReplyReady == nullptr || activeMatcher == nullptr ||
+      standbyMatcher == nullptr)
+  {
+    Serial.println("[FastIntent] Init failed: out of memory.");
+    return false;
+  }
+
+  const char *source = "flash";
+  if (!loadRulesFile(activeMatcher))
+  {
+    source = "builtin";
+    activeMatcher->load(kDefaultRulesJson, strlen(kDefaultRulesJson));
+  }
+  Serial.printf("[FastIntent] %s rules %s: %u rules, %u keywords, %u nodes\n",
+                source,
+                activeMatcher->version(),
+                static_cast<unsigned>(activeMatcher->ruleCount()),
+                static_cast<unsigned>(activeMatcher->keywordCount()),
+                static_cast<unsigned>(activeMatcher->nodeCount()));
+  return activeMatcher->loaded();
+}
+
+bool fastIntentMatch(const String &text, bool navigationActive, FastIntentMatch *out)
+{
+#if FAST_INTENT_ENABLED
+  if (activeMatcher == nullptr)
+  {
+    *out = FastIntentMatch();
+    return false;
+  }
+  MatcherLock lock;
+  return activeMatcher->match(text.c_str(), navigationActive, out);
+#else
+  (void)text;
+  (void)navigationActive;
+  *out = FastIntentMatch();
+  return false;
+#endif
+}
+
+void fastIntentSyncRulesAsync()
+{
+  if (activeMatcher == nullptr)
+  {
+    return;
+  }
+  networkSubmitFastIntentRules(nullptr, nullptr);
+}
+
+bool fastIntentSyncRules(int *httpStatus)
+{
+  String version;
+  {
+    MatcherLock lock;
+    version = activeMatcher->version();
+  }
+
+  HTTPClient http;
+  String url = String(SERVER_BASE_URL) + "/v1/fast_intent_rules";
+  int status = -1;
+  if (WiFi.status() == WL_CONNECTED && http.begin(url))
+  {
+    http.setTimeout(SERVER_HTTP_TIMEOUT_MS);
+    http.addHeader("X-Device-ID", DEVICE_ID);
+    if (version.length() > 0)
+    {
+      http.addHeader("If-None-Match", "\"" + version + "\"");
+    }
+
+    status = http.GET();
+    if (status == HTTP_CODE_NOT_MODIFIED)
+    {
+      Serial.printf("[FastIntent] Rules up to date (%s)\n", version.c_str());
+    }
+    else if (status == HTTP_CODE_OK)
+    {
+      String json = http.getString();
+      if (standbyMatcher->load(json.c_str(), json.length()))
+      {
+        {
+          MatcherLock lock;
+          FastIntentMatcher *previous = activeMatcher;
+          activeMatcher = standbyMatcher;
+          standbyMatcher = previous;
+        }
+        saveRulesFile(json);
+        Serial.printf("[FastIntent] Rules updated to %s (%u rules, %u nodes)\n",
+                      activeMatcher->version(),
+                      static_cast<unsigned>(activeMatcher->ruleCount()),
+                      static_cast<unsigned>(activeMatcher->nodeCount()));
+      }
+      else
+      {
+        Serial.println("[FastIntent] Server rules rejected; keeping current rules.");
+      }
+    }
+    else
+    {
+      Serial.printf("[FastIntent] Rules sync failed, http=%d\n", status);
+    }
+    http.end();
+  }
+
+  *httpStatus = status;
+  return status == HTTP_CODE_OK || status == HTTP_CODE_NOT_MODIFIED;
+}
+
+void fastIntentRunFollowUpAsync(FastIntentFollowUp followUp)
+{
+  if (followUp != FastIntentFollowUp::ExitNavigation)
+  {
+    return;
+  }
+  if (!networkSubmitExitNavigation(onExitNavigationDone, nullptr))
+  {
+    Serial.println("[FastIntent] exit_navigation already pending; not queued again.");
+  }
+}
+
+bool fastIntentBeginServerRequest(const String &text)
+{
+  // 网络任务正忙时不排在别的请求后面，交给调用方同步发送
+  if (serverReplyReady == nullptr || !networkWorkerIdle())
+  {
+    return false;
+  }
+  xSemaphoreTake(serverReplyMutex, portMAX_DELAY);
+  uint32_t generation = ++serverRequestGeneration;
+  xSemaphoreTake(serverReplyReady, 0);
+  *pendingServerReply = "";
+  xSemaphoreGive(serverReplyMutex);
+  return networkSubmitAiText(text.c_str(), onServerReplyDone, (void *)(uintptr_t)generation);
+}
+
+String fastIntentAwaitServerReply(uint32_t timeoutMs)
+{
+  if (serverReplyReady == nullptr)
+  {
+    return "";
+  }
+  bool ready = xSemaphoreTake(serverReplyReady, pdMS_TO_TICKS(timeoutMs)) == pdTRUE;
+  xSemaphoreTake(serverReplyMutex, portMAX_DELAY);
+  // 超时与回复同时到达时以锁内状态为准；作废代次后网络任务上迟到的回复不再写入
+  if (!ready)
+  {
+    ready = xSemaphoreTake(serverReplyReady, 0) == pdTRUE;
+  }
+  ++serverRequestGeneration;
+  String reply = ready ? *pendingServerReply : String();
+  xSemaphoreGive(serverReplyMutex);
+  return reply;
+}
+#endif
@@ -0,0 +1,130 @@
+#ifndef FAST_INTENT_H
+#define FAST_INTENT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../utils/json_helper.h"
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#endif
+
+// 设备端快速意图：与服务端 intent_service.fast_intent 同一套关键词，
+// 规则来自 GET /v1/fast_intent_rules，按列表顺序优先，命中则跳过 /ai 往返。
+enum class FastIntentAction : uint8_t
+{
+  Server,     // 仍需服务端；audioId 非空时先本地播放提示，同时异步请求 /ai
+  LocalAudio, // 播放本地音频，缺失时用 text 走 TTS
+  Speak       // 直接 TTS 播报 text
+};
+
+enum class FastIntentFollowUp : uint8_t
+{
+  None,
+  ExitNavigation // 本地已答复，后台通知服务端退出导航
+};
+
+struct FastIntentMatch
+{
+  int ruleIndex = -1;
+  FastIntentAction action = FastIntentAction::Server;
+  FastIntentFollowUp followUp = FastIntentFollowUp::None;
+  FixedString<32> intent;
+  FixedString<32> audioId;
+  FixedString<256> text;
+  FixedString<96> argument; // prefix 规则剩余部分，例如目的地
+};
+
+// 字节级 Aho-Corasick 自动机，UTF-8 关键词按字节插入，一次扫描找出全部命中。
+class FastIntentMatcher
+{
+public:
+  static constexpr size_t kMaxNodes = 1024;
+  static constexpr size_t kMaxKeywords = 192;
+  static constexpr size_t kMaxRules = 32;
+  static constexpr size_t kPoolBytes = 4096;
+  static constexpr size_t kMaxTextBytes = 256;
+
+  // 解析规则 JSON 并重建自动机；失败时返回 false，调用方应继续使用旧规则
+  bool load(const char *json, size_t length);
+  bool match(const char *text, bool navigationActive, FastIntentMatch *out) const;
+
+  bool loaded() const { return ruleCount_ > 0; }
+  const char *version() const { return version_; }
+  size_t ruleCount() const { return ruleCount_; }
+  size_t nodeCount() const { return nodeCount_; }
+  size_t keywordCount() const { return keywordCount_; }
+
+private:
+  static constexpr uint16_t kNone = 0xFFFF;
+
+  struct Node
+  {
+    uint16_t firstChild;
+    uint16_t nextSibling;
+    uint16_t fail;
+    uint16_t output;   // 在此结束的第一个关键词
+    uint16_t dictLink; // 沿 fail 链最近的带输出节点
+    uint8_t byte;
+  };
+
+  struct Keyword
+  {
+    uint16_t rule;
+    uint16_t order;
+    uint16_t length;
+    uint16_t nextAtNode;
+  };
+
+  struct Rule
+  {
+    uint8_t match;
+    uint8_t action;
+    uint8_t when;
+    uint8_t followUp;
+    uint16_t intent;
+    uint16_t audioId;
+    uint16_t text;
+  };
+
+  void reset();
+  uint16_t poolString(const char *value);
+  bool insertKeyword(const char *keyword, uint16_t rule, uint16_t order);
+  uint16_t child(uint16_t node, uint8_t byte) const;
+  bool buildFailLinks();
+  size_t normalize(const char *text, char *out, size_t outSize) const;
+
+  Node nodes_[kMaxNodes];
+  Keyword keywords_[kMaxKeywords];
+  Rule rules_[kMaxRules];
+  char pool_[kPoolBytes];
+  uint16_t queue_[kMaxNodes];
+  size_t nodeCount_ = 0;
+  size_t keywordCount_ = 0;
+  size_t ruleCount_ = 0;
+  size_t poolUsed_ = 0;
+  uint16_t strip_ = 0;
+  char version_[24] = {0};
+};
+
+// 编译进固件的默认规则，与服务端当前规则一致；首次同步前和离线时使用
+const char *fastIntentDefaultRules();
+
+#ifdef ARDUINO
+bool fastIntentInit();
+bool fastIntentMatch(const String &text, bool navigationActive, FastIntentMatch *out);
+void fastIntentSyncRulesAsync();
+// 网络任务上执行：带 If-None-Match 拉取规则，成功后换入备用匹配器并落盘；304 也算成功
+bool fastIntentSyncRules(int *httpStatus);
+
+// 退出导航等后续请求投递到网络任务，不等待结果
+void fastIntentRunFollowUpAsync(FastIntentFollowUp followUp);
+
+// 后台发送 /ai（网络任务空闲时才投递，否则返回 false 由调用方同步发送）：调用方在等待期间播放本地提示音，再取回响应。
+// 等待超时后本次请求作废，网络任务上迟到的回复被丢弃
+bool fastIntentBeginServerRequest(const String &text);
+String fastIntentAwaitServerReply(uint32_t timeoutMs);
+#endif
+
+#endif // FAST_INTENT_H
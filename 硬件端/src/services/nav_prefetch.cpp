@@ -0,0 +1,183 @@
+#include "nav_prefetch.h"
+
+#include <esp_heap_caps.h>
+#include <string.h>
+
+#include "../config.h"
+#include "../speech/baidu_token.h"
+#include "../speech/baidu_tts.h"
+#include "../utils/deferred_log.h"
+#include "network_worker.h"
+
+namespace
+{
+constexpr size_t kTextBytes = 192;
+
+struct PrefetchQueue
+{
+  char text[NAV_PREFETCH_AHEAD][kTextBytes];
+  size_t head;
+  size_t count;
+};
+
+portMUX_TYPE prefetchMux = portMUX_INITIALIZER_UNLOCKED;
+PrefetchQueue queue = {};
+// 每次取消递增；投递时带上当时的值，回调里不一致说明路线已变，直接丢弃不联网
+volatile uint32_t epoch = 0;
+NavPrefetchStats stats = {};
+
+void bump(uint32_t *counter)
+{
+  portENTER_CRITICAL(&prefetchMux);
+  ++*counter;
+  portEXIT_CRITICAL(&prefetchMux);
+}
+
+// 运行在后台网络任务上
+void onPrefetchDone(const NetworkJobResult &result, void *context)
+{
+  uint32_t jobEpoch = (uint32_t)(uintptr_t)context;
+  if (jobEpoch != epoch)
+  {
+    bump(&stats.cancelled);
+    return;
+  }
+
+  size_t written = 0;
+  if (!prefetchTextWithBaidu(baiduTokenGet(), result.payload, &written))
+  {
+    bump(&stats.failed);
+    Serial.printf("[NavPrefetch] Failed: %s\n", result.payload.c_str());
+    return;
+  }
+  if (written == 0)
+  {
+    bump(&stats.alreadyCached);
+    return;
+  }
+
+  portENTER_CRITICAL(&prefetchMux);
+  ++stats.fetched;
+  stats.bytes += written;
+  portEXIT_CRITICAL(&prefetchMux);
+  Serial.printf("[NavPrefetch] Cached %u bytes (%lu ms): %s\n", static_cast<unsigned>(written),
+                static_cast<unsigned long>(result.elapsedMs), result.payload.c_str());
+}
+
+void clearQueue()
+{
+  portENTER_CRITICAL(&prefetchMux);
+  stats.cancelled += queue.count;
+  queue.head = 0;
+  queue.count = 0;
+  ++epoch;
+  portEXIT_CRITICAL(&prefetchMux);
+}
+} // namespace
+
+void navPrefetchBegin()
+{
+  clearQueue();
+  portENTER_CRITICAL(&prefetchMux);
+  stats.bytes = 0;
+  portEXIT_CRITICAL(&prefetchMux);
+}
+
+void navPrefetchCancel()
+{
+  clearQueue();
+}
+
+bool navPrefetchEnqueue(const char *text)
+{
+#if BAIDU_TTS_CACHE_ENABLED
+  size_t length = text == nullptr ? 0 : strlen(text);
+  if (length == 0 || length >= kTextBytes)
+  {
+    return false;
+  }
+
+  bool queued = false;
+  portENTER_CRITICAL(&prefetchMux);
+  bool duplicate = false;
+  for (size_t i = 0; i < queue.count; ++i)
+  {
+    if (strcmp(queue.text[(queue.head + i) % NAV_PREFETCH_AHEAD], text) == 0)
+    {
+      duplicate = true;
+      break;
+    }
+  }
+  if (!duplicate && queue.count < NAV_PREFETCH_AHEAD)
+  {
+    memcpy(queue.text[(queue.head + queue.count) % NAV_PREFETCH_AHEAD], text, length + 1);
+    ++queue.count;
+    ++stats.queued;
+    queued = true;
+  }
+  portEXIT_CRITICAL(&prefetchMux);
+  return queued;
+#else
+  (void)text;
+  return false;
+#endif
+}
+
+void navPrefetchPoll(bool navigationActive, bool voiceBusy)
+{
+  if (queue.count == 0)
+  {
+    return;
+  }
+  if (!navigationActive)
+  {
+    clearQueue();
+    return;
+  }
+  // 预取让位于播报、语音交互和所有其他网络请求，每次只占用网络任务一条指令的时间
+  if (voiceBusy || !networkWorkerIdle())
+  {
+    return;
+  }
+
+  // 闪存：本次导航写入缓存的字节数有上限，避免把常用提示音挤出 LRU；PSRAM：TTS 下载缓冲按整段分配
+  if (stats.bytes >= NAV_PREFETCH_BUDGET_BYTES ||
+      (psramFound() && heap_caps_get_free_size(MALLOC_CAP_SPIRAM) < NAV_PREFETCH_MIN_FREE_PSRAM))
+  {
+    clearQueue();
+    bump(&stats.budgetSkipped);
+    return;
+  }
+
+  char text[kTextBytes];
+  uint32_t jobEpoch;
+  portENTER_CRITICAL(&prefetchMux);
+  if (queue.count == 0)
+  {
+    portEXIT_CRITICAL(&prefetchMux);
+    return;
+  }
+  memcpy(text, queue.text[queue.head], kTextBytes);
+  queue.head = (queue.head + 1) % NAV_PREFETCH_AHEAD;
+  --queue.count;
+  jobEpoch = epoch;
+  portEXIT_CRITICAL(&prefetchMux);
+
+  networkSubmitPromptPrefetch(text, onPrefetchDone, (void *)(uintptr_t)jobEpoch);
+}
+
+NavPrefetchStats navPrefetchStats()
+{
+  portENTER_CRITICAL(&prefetchMux);
+  NavPrefetchStats copy = stats;
+  portEXIT_CRITICAL(&prefetchMux);
+  return copy;
+}
+
+void navPrefetchReportStats()
+{
+  NavPrefetchStats copy = navPrefetchStats();
+  DLOG(0, "[导航预取] 排队: %u, 合成: %u, 已缓存: %u, 取消: %u\n",
+       copy.queued, copy.fetched, copy.alreadyCached, copy.cancelled);
+  DLOG(0, "[导航预取] 失败: %u, 超预算: %u, 本次导航写入: %u 字节\n", copy.failed, copy.budgetSkipped, copy.bytes);
+}
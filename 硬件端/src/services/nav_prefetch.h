@@ -0,0 +1,30 @@
+#ifndef NAV_PREFETCH_H
+#define NAV_PREFETCH_H
+
+#include <Arduino.h>
+
+// 导航指令预取：导航中把接下来几步的指令在网络空闲时合成进 TTS 缓存，
+// 到路口播报时直接读本地文件，不再等一次 TTS 往返。
+struct NavPrefetchStats
+{
+  uint32_t queued;
+  uint32_t fetched;        // 实际调用 TTS 写入缓存
+  uint32_t alreadyCached;  // 所有分段已在缓存中
+  uint32_t cancelled;      // 路线变化/导航结束后丢弃
+  uint32_t failed;
+  uint32_t budgetSkipped;  // 本次导航字节预算用完或 PSRAM 不足
+  uint32_t bytes;          // 本次导航已写入缓存的字节数
+};
+
+// 新导航开始：清空队列、重置字节预算
+void navPrefetchBegin();
+// 路线变化或导航结束：丢弃排队中的预取，执行中的结果回来后也丢弃
+void navPrefetchCancel();
+// 按路线顺序排队一条指令，队列里已有相同文本时忽略；队列满时返回 false（新来的总是更远的一步）
+bool navPrefetchEnqueue(const char *text);
+// 主循环调用：导航中且语音链路和网络任务都空闲时投递一条
+void navPrefetchPoll(bool navigationActive, bool voiceBusy);
+NavPrefetchStats navPrefetchStats();
+void navPrefetchReportStats();
+
+#endif // NAV_PREFETCH_H
@@ -0,0 +1,352 @@
+#include "network_worker.h"
+
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+
+#include "../config.h"
+#include "../speech/baidu_token.h"
+#include "../utils/deferred_log.h"
+#include "fast_intent.h"
+#include "secure_conn.h"
+#include "server_api.h"
+#include "track_store.h"
+
+namespace
+{
+struct NetworkJob
+{
+  NetworkJobKind kind;
+  NetworkJobCallback callback;
+  void *context;
+  union
+  {
+    char text[192]; // 导航目的地、播报指令或 /ai 识别文本
+    DeviceStatusReport status;
+    uint16_t turn; // 延迟追踪轮次，执行时再从追踪环里取该轮的阶段
+  };
+};
+
+QueueHandle_t jobQueue = nullptr;
+TaskHandle_t workerTask = nullptr;
+portMUX_TYPE statsMux = portMUX_INITIALIZER_UNLOCKED;
+// 每类请求最多一个在队列或执行中，周期性请求不会在网络变慢时越积越多
+volatile bool pending[static_cast<size_t>(NetworkJobKind::Count)] = {};
+static_assert(NETWORK_WORKER_QUEUE_LENGTH >= static_cast<int>(NetworkJobKind::Count),
+              "each job kind needs a queue slot");
+NetworkWorkerStats stats = {};
+
+const char *kindName(NetworkJobKind kind)
+{
+  switch (kind)
+  {
+  case NetworkJobKind::NavigationUpdate:
+    return "navigation_update";
+  case NetworkJobKind::GpsTrack:
+    return "gps_track";
+  case NetworkJobKind::DeviceStatus:
+    return "device_status";
+  case NetworkJobKind::NavigationRoute:
+    return "navigation_route";
+  case NetworkJobKind::PromptPrefetch:
+    return "prompt_prefetch";
+  case NetworkJobKind::LatencyTrace:
+    return "latency_trace";
+  case NetworkJobKind::SecurePrewarm:
+    return "secure_prewarm";
+  case NetworkJobKind::TokenRefresh:
+    return "token_refresh";
+  case NetworkJobKind::FastIntentRules:
+    return "fast_intent_rules";
+  case NetworkJobKind::ExitNavigation:
+    return "exit_navigation";
+  case NetworkJobKind::AiText:
+    return "ai_text";
+  default:
+    return "unknown";
+  }
+}
+
+NetworkJobResult execute(const NetworkJob &job)
+{
+  NetworkJobResult result;
+  result.kind = job.kind;
+  result.httpStatus = 0;
+  switch (job.kind)
+  {
+  case NetworkJobKind::NavigationUpdate:
+    result.payload = ServerApi::postNavigationUpdate(String(job.text), &result.httpStatus);
+    break;
+  case NetworkJobKind::DeviceStatus:
+    result.payload = ServerApi::postDeviceStatus(job.status, &result.httpStatus);
+    break;
+  case NetworkJobKind::NavigationRoute:
+    result.payload = ServerApi::postNavigationRoute(&result.httpStatus);
+    break;
+  case NetworkJobKind::LatencyTrace:
+    result.payload = ServerApi::postLatencyTrace(job.turn, &result.httpStatus);
+    break;
+  case NetworkJobKind::AiText:
+    result.payload = ServerApi::postAiText(String(job.text), &result.httpStatus);
+    break;
+  case NetworkJobKind::PromptPrefetch:
+    result.payload = job.text;
+    result.ok = true;
+    return result;
+  case NetworkJobKind::SecurePrewarm:
+    result.ok = secureConnPrewarm();
+    return result;
+  case NetworkJobKind::TokenRefresh:
+    result.ok = baiduTokenRefresh();
+    return result;
+  case NetworkJobKind::GpsTrack:
+    result.ok = trackStoreRunJob(&result.httpStatus);
+    return result;
+  case NetworkJobKind::FastIntentRules:
+    result.ok = fastIntentSyncRules(&result.httpStatus);
+    return result;
+  case NetworkJobKind::ExitNavigation:
+    result.ok = ServerApi::postExitNavigation();
+    return result;
+  default:
+    break;
+  }
+  result.ok = result.httpStatus >= 200 && result.httpStatus < 300;
+  return result;
+}
+
+void workerLoop(void *parameter)
+{
+  (void)parameter;
+  NetworkJob job;
+  while (true)
+  {
+    if (xQueueReceive(jobQueue, &job, portMAX_DELAY) != pdTRUE)
+    {
+      continue;
+    }
+
+    unsigned long start = millis();
+    NetworkJobResult result = execute(job);
+    result.elapsedMs = millis() - start;
+
+    portENTER_CRITICAL(&statsMux);
+    ++stats.completed;
+    if (!result.ok)
+    {
+      ++stats.failed;
+    }
+    if (result.elapsedMs > stats.maxElapsedMs)
+    {
+      stats.maxElapsedMs = result.elapsedMs;
+    }
+    portEXIT_CRITICAL(&statsMux);
+
+    if (!result.ok)
+    {
+      Serial.printf("[NetWorker] %s failed, http=%d (%lu ms)\n", kindName(job.kind), result.httpStatus,
+                    static_cast<unsigned long>(result.elapsedMs));
+    }
+
+    // 回调结束后才清 pending：调用方在回调里更新的计时/状态对下一次投递可见
+    if (job.callback)
+    {
+      job.callback(result, job.context);
+    }
+    pending[static_cast<size_t>(job.kind)] = false;
+  }
+}
+
+bool submit(NetworkJob &job)
+{
+  if (jobQueue == nullptr)
+  {
+    return false;
+  }
+
+  size_t slot = static_cast<size_t>(job.kind);
+  portENTER_CRITICAL(&statsMux);
+  bool busy = pending[slot];
+  if (busy)
+  {
+    ++stats.coalesced;
+  }
+  else
+  {
+    pending[slot] = true;
+  }
+  portEXIT_CRITICAL(&statsMux);
+  if (busy)
+  {
+    return false;
+  }
+
+  if (xQueueSend(jobQueue, &job, 0) != pdTRUE)
+  {
+    portENTER_CRITICAL(&statsMux);
+    pending[slot] = false;
+    ++stats.dropped;
+    portEXIT_CRITICAL(&statsMux);
+    return false;
+  }
+
+  portENTER_CRITICAL(&statsMux);
+  ++stats.submitted;
+  portEXIT_CRITICAL(&statsMux);
+  return true;
+}
+
+NetworkJob makeJob(NetworkJobKind kind, NetworkJobCallback callback, void *context)
+{
+  NetworkJob job;
+  memset(&job, 0, sizeof(job));
+  job.kind = kind;
+  job.callback = callback;
+  job.context = context;
+  return job;
+}
+
+bool submitText(NetworkJobKind kind, const char *text, NetworkJobCallback callback, void *context)
+{
+  NetworkJob job = makeJob(kind, callback, context);
+  size_t length = strlen(text);
+  if (length >= sizeof(job.text))
+  {
+    Serial.printf("[NetWorker] Text too long (%u bytes)\n", static_cast<unsigned>(length));
+    return false;
+  }
+  memcpy(job.text, text, length + 1);
+  return submit(job);
+}
+} // namespace
+
+bool networkWorkerStart()
+{
+  if (workerTask != nullptr)
+  {
+    return true;
+  }
+
+  jobQueue = xQueueCreate(NETWORK_WORKER_QUEUE_LENGTH, sizeof(NetworkJob));
+  if (jobQueue == nullptr)
+  {
+    Serial.println("[NetWorker] Init failed: out of memory.");
+    return false;
+  }
+  if (xTaskCreatePinnedToCore(workerLoop, "NetWorker", NETWORK_WORKER_STACK_SIZE, nullptr,
+                              NETWORK_WORKER_PRIORITY, &workerTask, NETWORK_WORKER_CORE) != pdPASS)
+  {
+    Serial.println("[NetWorker] Init failed: task not created.");
+    vQueueDelete(jobQueue);
+    jobQueue = nullptr;
+    workerTask = nullptr;
+    return false;
+  }
+  return true;
+}
+
+bool networkSubmitNavigationUpdate(const String &destination, NetworkJobCallback callback, void *context)
+{
+  NetworkJob job = makeJob(NetworkJobKind::NavigationUpdate, callback, context);
+  if (destination.length() >= sizeof(job.text))
+  {
+    Serial.printf("[NetWorker] Destination too long (%u bytes)\n", static_cast<unsigned>(destination.length()));
+    return false;
+  }
+  memcpy(job.text, destination.c_str(), destination.length() + 1);
+  return submit(job);
+}
+
+bool networkSubmitGpsTrack(NetworkJobCallback callback, void *context)
+{
+  NetworkJob job = makeJob(NetworkJobKind::GpsTrack, callback, context);
+  return submit(job);
+}
+
+bool networkSubmitDeviceStatus(const DeviceStatusReport &report, NetworkJobCallback callback, void *context)
+{
+  NetworkJob job = makeJob(NetworkJobKind::DeviceStatus, callback, context);
+  job.status = report;
+  return submit(job);
+}
+
+bool networkSubmitNavigationRoute(NetworkJobCallback callback, void *context)
+{
+  NetworkJob job = makeJob(NetworkJobKind::NavigationRoute, callback, context);
+  return submit(job);
+}
+
+bool networkSubmitPromptPrefetch(const char *text, NetworkJobCallback callback, void *context)
+{
+  return submitText(NetworkJobKind::PromptPrefetch, text, callback, context);
+}
+
+bool networkSubmitLatencyTrace(uint16_t turn, NetworkJobCallback callback, void *context)
+{
+  NetworkJob job = makeJob(NetworkJobKind::LatencyTrace, callback, context);
+  job.turn = turn;
+  return submit(job);
+}
+
+bool networkSubmitSecurePrewarm(NetworkJobCallback callback, void *context)
+{
+  NetworkJob job = makeJob(NetworkJobKind::SecurePrewarm, callback, context);
+  return submit(job);
+}
+
+bool networkSubmitTokenRefresh(NetworkJobCallback callback, void *context)
+{
+  NetworkJob job = makeJob(NetworkJobKind::TokenRefresh, callback, context);
+  return submit(job);
+}
+
+bool networkSubmitFastIntentRules(NetworkJobCallback callback, void *context)
+{
+  NetworkJob job = makeJob(NetworkJobKind::FastIntentRules, callback, context);
+  return submit(job);
+}
+
+bool networkSubmitExitNavigation(NetworkJobCallback callback, void *context)
+{
+  NetworkJob job = makeJob(NetworkJobKind::ExitNavigation, callback, context);
+  return submit(job);
+}
+
+bool networkSubmitAiText(const char *text, NetworkJobCallback callback, void *context)
+{
+  return submitText(NetworkJobKind::AiText, text, callback, context);
+}
+
+bool networkJobPending(NetworkJobKind kind)
+{
+  return pending[static_cast<size_t>(kind)];
+}
+
+bool networkWorkerIdle()
+{
+  for (size_t i = 0; i < static_cast<size_t>(NetworkJobKind::Count); ++i)
+  {
+    if (pending[i])
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+NetworkWorkerStats networkWorkerStats()
+{
+  portENTER_CRITICAL(&statsMux);
+  NetworkWorkerStats copy = stats;
+  portEXIT_CRITICAL(&statsMux);
+  return copy;
+}
+
+void networkWorkerReportStats()
+{
+  NetworkWorkerStats stats = networkWorkerStats();
+  DLOG(0, "[网络任务] 投递: %u, 合并: %u, 丢弃: %u, 完成: %u, 失败: %u, 最长耗时: %u ms\n",
+       stats.submitted, stats.coalesced, stats.dropped, stats.completed, stats.failed, stats.maxElapsedMs);
+}
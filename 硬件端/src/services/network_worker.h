@@ -0,0 +1,80 @@
+#ifndef NETWORK_WORKER_H
+#define NETWORK_WORKER_H
+
+#include <Arduino.h>
+
+// 后台网络任务：导航轮询、GPS 上报、设备状态上报、快速意图的后台请求排队到同一个任务里执行，
+// 主循环（唤醒词检测）只负责投递，不再等待 HTTP。
+enum class NetworkJobKind : uint8_t
+{
+  NavigationUpdate,
+  GpsTrack,
+  DeviceStatus,
+  NavigationRoute,
+  PromptPrefetch,   // 不发请求：payload 即指令文本，回调里只合成写缓存不播放
+  LatencyTrace,     // 上报一轮语音交互的延迟追踪
+  SecurePrewarm,    // 不发请求：提前与 TTS 主机完成 TLS 握手，本轮合成直接复用
+  TokenRefresh,     // 百度 AccessToken 临近过期时后台续期
+  FastIntentRules,  // 快速意图规则同步（开机一次）
+  ExitNavigation,   // 快速意图本地退出导航后通知服务端
+  AiText,           // 快速意图需要服务端时与本地确认音重叠发出的 /ai
+  Count
+};
+
+struct NetworkJobResult
+{
+  NetworkJobKind kind;
+  bool ok;          // HTTP 2xx
+  int httpStatus;   // <=0 为连接/超时错误
+  uint32_t elapsedMs;
+  String payload;   // 响应体，GPS/设备状态只用于日志
+};
+
+// 完成回调在网络任务上执行，回调返回前同类请求仍视为未完成；播报等非网络的慢操作转交对应任务，不要占住网络任务
+typedef void (*NetworkJobCallback)(const NetworkJobResult &result, void *context);
+
+struct DeviceStatusReport
+{
+  uint32_t uptimeMs;
+  uint32_t freeHeap;
+  int32_t rssi;
+  const char *appState; // 静态字符串，例如 appStateToString() 的返回值
+  bool navigationActive;
+  bool gpsValid;
+};
+
+struct NetworkWorkerStats
+{
+  uint32_t submitted;
+  uint32_t coalesced; // 同类请求仍在排队/执行，本次投递被合并
+  uint32_t dropped;   // 队列满
+  uint32_t completed;
+  uint32_t failed;
+  uint32_t maxElapsedMs;
+};
+
+bool networkWorkerStart();
+
+// 投递请求；同类请求尚未完成时返回 false（调用方下个周期再试），不会阻塞
+bool networkSubmitNavigationUpdate(const String &destination, NetworkJobCallback callback, void *context);
+// GPS 轨迹：按需溢出到 LittleFS 并上传一批（见 track_store.h）
+bool networkSubmitGpsTrack(NetworkJobCallback callback, void *context);
+bool networkSubmitDeviceStatus(const DeviceStatusReport &report, NetworkJobCallback callback, void *context);
+bool networkSubmitNavigationRoute(NetworkJobCallback callback, void *context);
+bool networkSubmitPromptPrefetch(const char *text, NetworkJobCallback callback, void *context);
+bool networkSubmitLatencyTrace(uint16_t turn, NetworkJobCallback callback, void *context);
+bool networkSubmitSecurePrewarm(NetworkJobCallback callback, void *context);
+bool networkSubmitTokenRefresh(NetworkJobCallback callback, void *context);
+bool networkSubmitFastIntentRules(NetworkJobCallback callback, void *context);
+bool networkSubmitExitNavigation(NetworkJobCallback callback, void *context);
+// 识别文本超过任务内联缓冲区时返回 false
+bool networkSubmitAiText(const char *text, NetworkJobCallback callback, void *context);
+
+bool networkJobPending(NetworkJobKind kind);
+// 没有任何请求在排队或执行，低优先级工作（预取）只在此时投递
+bool networkWorkerIdle();
+NetworkWorkerStats networkWorkerStats();
+// 心跳统计，经 DLOG 输出
+void networkWorkerReportStats();
+
+#endif // NETWORK_WORKER_H
@@ -0,0 +1,411 @@
+#include "route_follower.h"
+
+#include <math.h>
+#include <string.h>
+
+#ifdef ARDUINO
+#include <ArduinoJson.h>
+#include <stdlib.h>
+
+#include "../utils/json_helper.h"
+#endif
+
+namespace
+{
+constexpr double kMetersPerDegreeLat = 110574.0;
+constexpr double kMetersPerDegreeLng = 111320.0;
+constexpr double kDegreesToRadians = 3.14159265358979323846 / 180.0;
+constexpr float kDuplicatePointMeters = 0.5f;
+constexpr float kForwardJumpMeters = 60.0f; // 超过该前跳距离的候选加罚分，折返路线上不会提前跳到后段
+} // namespace
+
+void RouteFollower::clear()
+{
+  loaded_ = false;
+  routeId_[0] = '\0';
+  pointCount_ = 0;
+  stepCount_ = 0;
+  poolUsed_ = 0;
+  gridEntries_ = 0;
+  gridW_ = 0;
+  gridH_ = 0;
+  progress_ = 0.0f;
+  announcedStep_ = 0;
+  offRouteCount_ = 0;
+  arrived_ = false;
+}
+
+bool RouteFollower::beginRoute(const char *routeId)
+{
+  clear();
+  strncpy(routeId_, routeId ? routeId : "", sizeof(routeId_) - 1);
+  routeId_[sizeof(routeId_) - 1] = '\0';
+  return true;
+}
+
+bool RouteFollower::addStep(const char *instruction, const int32_t *lngLatE6, size_t pointCount)
+{
+  if (stepCount_ >= kMaxSteps || pointCount == 0)
+  {
+    return false;
+  }
+  size_t length = strlen(instruction ? instruction : "");
+  if (poolUsed_ + length + 1 > kPoolBytes)
+  {
+    return false;
+  }
+
+  if (pointCount_ == 0)
+  {
+    originLng_ = lngLatE6[0] / 1e6;
+    originLat_ = lngLatE6[1] / 1e6;
+    metersPerLat_ = kMetersPerDegreeLat;
+    metersPerLng_ = kMetersPerDegreeLng * cos(originLat_ * kDegreesToRadians);
+  }
+
+  Step &step = steps_[stepCount_];
+  step.firstPoint = static_cast<uint16_t>(pointCount_);
+  for (size_t i = 0; i < pointCount; ++i)
+  {
+    float x;
+    float y;
+    project(lngLatE6[i * 2 + 1] / 1e6, lngLatE6[i * 2] / 1e6, &x, &y);
+    if (pointCount_ > 0)
+    {
+      float dx = x - x_[pointCount_ - 1];
+      float dy = y - y_[pointCount_ - 1];
+      float segmentLength = sqrtf(dx * dx + dy * dy);
+      // 相邻步首尾相接：新步的首点与上一步末点重合时复用该点作为本步起点
+      if (segmentLength < kDuplicatePointMeters)
+      {
+        if (i == 0)
+        {
+          step.firstPoint = static_cast<uint16_t>(pointCount_ - 1);
+        }
+        continue;
+      }
+      if (pointCount_ >= kMaxPoints)
+      {
+        return false;
+      }
+      along_[pointCount_] = along_[pointCount_ - 1] + segmentLength;
+    }
+    else
+    {
+      along_[0] = 0.0f;
+    }
+    x_[pointCount_] = x;
+    y_[pointCount_] = y;
+    ++pointCount_;
+  }
+
+  step.instruction = static_cast<uint16_t>(poolUsed_);
+  memcpy(pool_ + poolUsed_, instruction ? instruction : "", length + 1);
+  poolUsed_ += length + 1;
+  ++stepCount_;
+  return true;
+}
+
+bool RouteFollower::finishRoute()
+{
+  loaded_ = stepCount_ > 0 && pointCount_ >= 2 && buildGrid();
+  return loaded_;
+}
+
+const char *RouteFollower::stepInstruction(size_t step) const
+{
+  return step < stepCount_ ? pool_ + steps_[step].instruction : "";
+}
+
+void RouteFollower::project(double latitude, double longitude, float *x, float *y) const
+{
+  *x = static_cast<float>((longitude - originLng_) * metersPerLng_);
+  *y = static_cast<float>((latitude - originLat_) * metersPerLat_);
+}
+
+bool RouteFollower::buildGrid()
+{
+  float minX = x_[0];
+  float maxX = x_[0];
+  float minY = y_[0];
+  float maxY = y_[0];
+  for (size_t i = 1; i < pointCount_; ++i)
+  {
+    minX = fminf(minX, x_[i]);
+    maxX = fmaxf(maxX, x_[i]);
+    minY = fminf(minY, y_[i]);
+    maxY = fmaxf(maxY, y_[i]);
+  }
+  gridMinX_ = minX;
+  gridMinY_ = minY;
+  cellMeters_ = fmaxf(kMinCellMeters, fmaxf(maxX - minX, maxY - minY) / (kGridDim - 1));
+
+  // 登记项超出容量时放大格子重建；最坏情况退化为单格线性扫描
+  while (true)
+  {
+    gridW_ = static_cast<int>((maxX - minX) / cellMeters_) + 1;
+    gridH_ = static_cast<int>((maxY - minY) / cellMeters_) + 1;
+    size_t cells = static_cast<size_t>(gridW_) * gridH_;
+    memset(cellStart_, 0, (cells + 1) * sizeof(cellStart_[0]));
+
+    size_t total = 0;
+    for (size_t s = 0; s + 1 < pointCount_; ++s)
+    {
+      int x0, y0, x1, y1;
+      cellOf(fminf(x_[s], x_[s + 1]), fminf(y_[s], y_[s + 1]), &x0, &y0);
+      cellOf(fmaxf(x_[s], x_[s + 1]), fmaxf(y_[s], y_[s + 1]), &x1, &y1);
+      for (int cy = y0; cy <= y1; ++cy)
+      {
+        for (int cx = x0; cx <= x1; ++cx)
+        {
+          ++cellStart_[cy * gridW_ + cx + 1];
+          ++total;
+        }
+      }
+    }
+    if (total > kMaxGridEntries)
+    {
+      if (gridW_ == 1 && gridH_ == 1)
+      {
+        return false;
+      }
+      cellMeters_ *= 1.5f;
+      continue;
+    }
+
+    for (size_t c = 0; c < cells; ++c)
+    {
+      cellStart_[c + 1] += cellStart_[c];
+    }
+    // 以 cellStart_ 作写指针填充，填完后各项恰好前移一格，再整体右移还原
+    for (size_t s = 0; s + 1 < pointCount_; ++s)
+    {
+      int x0, y0, x1, y1;
+      cellOf(fminf(x_[s], x_[s + 1]), fminf(y_[s], y_[s + 1]), &x0, &y0);
+      cellOf(fmaxf(x_[s], x_[s + 1]), fmaxf(y_[s], y_[s + 1]), &x1, &y1);
+      for (int cy = y0; cy <= y1; ++cy)
+      {
+        for (int cx = x0; cx <= x1; ++cx)
+        {
+          cellSegments_[cellStart_[cy * gridW_ + cx]++] = static_cast<uint16_t>(s);
+        }
+      }
+    }
+    for (size_t c = cells; c > 0; --c)
+    {
+      cellStart_[c] = cellStart_[c - 1];
+    }
+    cellStart_[0] = 0;
+    gridEntries_ = total;
+    return true;
+  }
+}
+
+void RouteFollower::cellOf(float x, float y, int *cx, int *cy) const
+{
+  int ix = static_cast<int>(floorf((x - gridMinX_) / cellMeters_));
+  int iy = static_cast<int>(floorf((y - gridMinY_) / cellMeters_));
+  *cx = ix < 0 ? 0 : (ix >= gridW_ ? gridW_ - 1 : ix);
+  *cy = iy < 0 ? 0 : (iy >= gridH_ ? gridH_ - 1 : iy);
+}
+
+float RouteFollower::nearestOnSegment(size_t segment, float x, float y, float *along) const
+{
+  float ax = x_[segment];
+  float ay = y_[segment];
+  float dx = x_[segment + 1] - ax;
+  float dy = y_[segment + 1] - ay;
+  float lengthSq = dx * dx + dy * dy;
+  float t = lengthSq > 0.0f ? ((x - ax) * dx + (y - ay) * dy) / lengthSq : 0.0f;
+  t = t < 0.0f ? 0.0f : (t > 1.0f ? 1.0f : t);
+  float px = ax + t * dx - x;
+  float py = ay + t * dy - y;
+  *along = along_[segment] + t * (along_[segment + 1] - along_[segment]);
+  return sqrtf(px * px + py * py);
+}
+
+int RouteFollower::stepOfPoint(size_t point) const
+{
+  int step = 0;
+  while (step + 1 < static_cast<int>(stepCount_) && steps_[step + 1].firstPoint <= point)
+  {
+    ++step;
+  }
+  return step;
+}
+
+RouteFix RouteFollower::update(double latitude, double longitude)
+{
+  RouteFix fix;
+  if (!loaded_)
+  {
+    return fix;
+  }
+
+  float x;
+  float y;
+  project(latitude, longitude, &x, &y);
+
+  // 只搜索以定位为中心、半径为两倍偏航阈值的格子
+  float radius = config_.deviationMeters * 2.0f;
+  int x0, y0, x1, y1;
+  cellOf(x - radius, y - radius, &x0, &y0);
+  cellOf(x + radius, y + radius, &x1, &y1);
+  bool inside = x + radius >= gridMinX_ && y + radius >= gridMinY_ &&
+                x - radius <= gridMinX_ + gridW_ * cellMeters_ && y - radius <= gridMinY_ + gridH_ * cellMeters_;
+
+  float bestCost = INFINITY;
+  float bestDistance = INFINITY;
+  float bestAlong = 0.0f;
+  int bestSegment = -1;
+  for (int cy = y0; inside && cy <= y1; ++cy)
+  {
+    for (int cx = x0; cx <= x1; ++cx)
+    {
+      int cell = cy * gridW_ + cx;
+      for (uint16_t e = cellStart_[cell]; e < cellStart_[cell + 1]; ++e)
+      {
+        uint16_t segment = cellSegments_[e];
+        float along;
+        float distance = nearestOnSegment(segment, x, y, &along);
+        if (along < progress_ - config_.backtrackMeters)
+        {
+          continue;
+        }
+        float ahead = along - progress_ - kForwardJumpMeters;
+        float cost = distance + (ahead > 0.0f ? 0.1f * ahead : 0.0f);
+        if (cost < bestCost)
+        {
+          bestCost = cost;
+          bestDistance = distance;
+          bestAlong = along;
+          bestSegment = segment;
+        }
+      }
+    }
+  }
+
+  fix.matched = bestSegment >= 0 && bestDistance <= radius;
+  fix.offRouteMeters = fix.matched ? bestDistance : radius;
+  if (!fix.matched || bestDistance > config_.deviationMeters)
+  {
+    if (offRouteCount_ < 255)
+    {
+      ++offRouteCount_;
+    }
+    if (offRouteCount_ == config_.deviationFixes)
+    {
+      fix.event = RouteEvent::Deviation;
+    }
+    fix.alongMeters = progress_;
+    fix.remainingMeters = totalMeters() - progress_;
+    return fix;
+  }
+  offRouteCount_ = 0;
+
+  // 进度只前进不后退，GPS 抖动不会导致同一路口重复播报
+  progress_ = fmaxf(progress_, bestAlong);
+  int step = stepOfPoint(static_cast<size_t>(bestSegment));
+  if (progress_ >= along_[pointCount_ - 1] - 0.01f)
+  {
+    step = static_cast<int>(stepCount_) - 1;
+  }
+  while (step + 1 < static_cast<int>(stepCount_) && along_[steps_[step + 1].firstPoint] <= progress_)
+  {
+    ++step;
+  }
+  fix.step = step;
+  fix.alongMeters = progress_;
+  fix.remainingMeters = totalMeters() - progress_;
+  fix.toManeuverMeters = step + 1 < static_cast<int>(stepCount_)
+                             ? along_[steps_[step + 1].firstPoint] - progress_
+                             : fix.remainingMeters;
+
+  if (!arrived_ && fix.remainingMeters <= config_.arrivalMeters)
+  {
+    arrived_ = true;
+    fix.event = RouteEvent::Arrival;
+    return fix;
+  }
+
+  // 临近路口播报下一步；定位中断后已经越过路口时补播当前步
+  int target = step;
+  if (step + 1 < static_cast<int>(stepCount_) && fix.toManeuverMeters <= config_.announceMeters)
+  {
+    target = step + 1;
+  }
+  if (target > announcedStep_)
+  {
+    announcedStep_ = target;
+    fix.event = RouteEvent::Instruction;
+    fix.step = target;
+    fix.instruction = stepInstruction(static_cast<size_t>(target));
+  }
+  return fix;
+}
+
+#ifdef ARDUINO
+bool RouteFollower::loadResponse(const char *payload, size_t length)
+{
+  JsonDocument doc;
+  DeserializationError error = isMsgPackPayload(payload, length) ? deserializeMsgPack(doc, payload, length)
+                                                                 : deserializeJson(doc, payload, length);
+  if (error || !(doc["ok"] | false))
+  {
+    clear();
+    return false;
+  }
+
+  JsonArrayConst steps = doc["steps"].as<JsonArrayConst>();
+  int32_t *points = static_cast<int32_t *>(malloc(kMaxPoints * 2 * sizeof(int32_t)));
+  if (points == nullptr)
+  {
+    clear();
+    return false;
+  }
+
+  bool ok = beginRoute(doc["route_id"] | "");
+  for (JsonObjectConst step : steps)
+  {
+    JsonArrayConst polyline = step["polyline"].as<JsonArrayConst>();
+    size_t count = 0;
+    int32_t lng = 0;
+    int32_t lat = 0;
+    size_t index = 0;
+    for (JsonVariantConst value : polyline)
+    {
+      int32_t v = value.as<int32_t>();
+      if (index % 2 == 0)
+      {
+        lng = index == 0 ? v : lng + v;
+      }
+      else
+      {
+        lat = index == 1 ? v : lat + v;
+        if (count >= kMaxPoints)
+        {
+          ok = false;
+          break;
+        }
+        points[count * 2] = lng;
+        points[count * 2 + 1] = lat;
+        ++count;
+      }
+      ++index;
+    }
+    if (!ok || !addStep(step["instruction"] | "", points, count))
+    {
+      ok = false;
+      break;
+    }
+  }
+  free(points);
+
+  if (!ok || !finishRoute())
+  {
+    clear();
+    return false;
+  }
+  return true;
+}
+#endif
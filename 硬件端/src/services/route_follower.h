@@ -0,0 +1,131 @@
+#ifndef ROUTE_FOLLOWER_H
+#define ROUTE_FOLLOWER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#endif
+
+// 设备端路线跟随：POST /v1/navigation/route 下载一次路线（各步折线 + 指令），
+// 每个 GPS 定位在本地做地图匹配（局部平面坐标 + 网格索引找最近线段），
+// 按到下一路口的距离触发指令；只在偏航或到达时才需要和服务端同步。
+enum class RouteEvent : uint8_t
+{
+  None,
+  Instruction, // 接近第 step 步的起点，播报该步指令
+  Deviation,   // 连续若干个定位离路线过远
+  Arrival      // 距终点不足 arrivalMeters
+};
+
+struct RouteFollowerConfig
+{
+  float announceMeters = 20.0f;     // 距路口多远播报下一步
+  float deviationMeters = 25.0f;    // 离最近线段超过该距离视为偏离
+  uint8_t deviationFixes = 3;       // 连续偏离的定位数，过滤单点漂移
+  float arrivalMeters = 15.0f;
+  float backtrackMeters = 40.0f;    // 匹配时允许的回退距离，避免跳到折返路线的另一侧
+};
+
+struct RouteFix
+{
+  RouteEvent event = RouteEvent::None;
+  int step = -1;              // 当前所在步；Instruction 时为要播报的步
+  const char *instruction = nullptr;
+  float offRouteMeters = 0.0f;
+  float alongMeters = 0.0f;   // 沿路线已走距离
+  float toManeuverMeters = 0.0f;
+  float remainingMeters = 0.0f;
+  bool matched = false;       // 搜索半径内找到了线段
+};
+
+class RouteFollower
+{
+public:
+  static constexpr size_t kMaxPoints = 1024;
+  static constexpr size_t kMaxSteps = 48;
+  static constexpr size_t kPoolBytes = 6144;
+  static constexpr size_t kGridDim = 48;          // 单边最多格数，超出时放大格子
+  static constexpr size_t kMaxGridEntries = 4096;
+  static constexpr float kMinCellMeters = 30.0f;
+
+  explicit RouteFollower(const RouteFollowerConfig &config = RouteFollowerConfig()) : config_(config) {}
+
+  void clear();
+  // 逐步追加路线：points 为 1e-6 度的绝对坐标 [lng, lat, lng, lat, ...]
+  bool beginRoute(const char *routeId);
+  bool addStep(const char *instruction, const int32_t *lngLatE6, size_t pointCount);
+  bool finishRoute();
+
+  // 每个新定位调用一次
+  RouteFix update(double latitude, double longitude);
+
+  bool loaded() const { return loaded_; }
+  const char *routeId() const { return routeId_; }
+  size_t stepCount() const { return stepCount_; }
+  size_t pointCount() const { return pointCount_; }
+  size_t gridEntries() const { return gridEntries_; }
+  float cellMeters() const { return cellMeters_; }
+  float totalMeters() const { return pointCount_ ? along_[pointCount_ - 1] : 0.0f; }
+  const char *stepInstruction(size_t step) const;
+  // 已播报的最后一步；路线重新加载后归零
+  int announcedStep() const { return announcedStep_; }
+  // 偏航或到达后本地不再产生新事件，调用方改回服务端轮询
+  bool offRoute() const { return offRouteCount_ >= config_.deviationFixes; }
+  bool arrived() const { return arrived_; }
+
+#ifdef ARDUINO
+  // 解析 /v1/navigation/route 响应（增量编码的折线，JSON 或 MessagePack），失败时保持未加载
+  bool loadResponse(const char *payload, size_t length);
+#endif
+
+private:
+  struct Step
+  {
+    uint16_t firstPoint;
+    uint16_t instruction; // pool_ 偏移
+  };
+
+  void project(double latitude, double longitude, float *x, float *y) const;
+  bool buildGrid();
+  void cellOf(float x, float y, int *cx, int *cy) const;
+  float nearestOnSegment(size_t segment, float x, float y, float *along) const;
+  int stepOfPoint(size_t point) const;
+
+  RouteFollowerConfig config_;
+  bool loaded_ = false;
+  char routeId_[24] = {0};
+
+  // 局部平面坐标（米）：以首点为原点的等距投影，步行路线范围内误差可忽略
+  double originLat_ = 0.0;
+  double originLng_ = 0.0;
+  double metersPerLng_ = 0.0;
+  double metersPerLat_ = 0.0;
+  float x_[kMaxPoints];
+  float y_[kMaxPoints];
+  float along_[kMaxPoints];
+  size_t pointCount_ = 0;
+
+  Step steps_[kMaxSteps];
+  size_t stepCount_ = 0;
+  char pool_[kPoolBytes];
+  size_t poolUsed_ = 0;
+
+  // 网格索引（CSR）：线段 i 连接点 i 与 i+1，按包围盒登记到覆盖的格子
+  float gridMinX_ = 0.0f;
+  float gridMinY_ = 0.0f;
+  float cellMeters_ = kMinCellMeters;
+  int gridW_ = 0;
+  int gridH_ = 0;
+  uint16_t cellStart_[kGridDim * kGridDim + 1];
+  uint16_t cellSegments_[kMaxGridEntries];
+  size_t gridEntries_ = 0;
+
+  float progress_ = 0.0f;
+  int announcedStep_ = 0;
+  uint8_t offRouteCount_ = 0;
+  bool arrived_ = false;
+};
+
+#endif // ROUTE_FOLLOWER_H
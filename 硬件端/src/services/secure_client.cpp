@@ -0,0 +1,400 @@
+#include "secure_client.h"
+
+#include <WiFi.h>
+#include <errno.h>
+#include <string.h>
+
+#include "lwip/sockets.h"
+#include "mbedtls/error.h"
+
+namespace
+{
+const char *kPersonalization = "guide-cane-tls";
+}
+
+SecureClient::SecureClient(SecureConnPool *pool)
+    : pool_(pool), sessionValid_(false), open_(false), peerClosed_(false), resumed_(false), held_(false),
+      peeked_(-1)
+{
+  mbedtls_ssl_session_init(&session_);
+  mbedtls_net_init(&net_);
+}
+
+SecureClient::~SecureClient()
+{
+  held_ = false;
+  close();
+  mbedtls_ssl_session_free(&session_);
+}
+
+bool SecureClient::waitSocket(bool forWrite, uint32_t timeoutMs)
+{
+  fd_set fds;
+  FD_ZERO(&fds);
+  FD_SET(net_.fd, &fds);
+  struct timeval tv;
+  tv.tv_sec = timeoutMs / 1000;
+  tv.tv_usec = (timeoutMs % 1000) * 1000;
+  int ready = forWrite ? select(net_.fd + 1, nullptr, &fds, nullptr, &tv)
+                       : select(net_.fd + 1, &fds, nullptr, nullptr, &tv);
+  return ready > 0;
+}
+
+bool SecureClient::openSocket(const char *host, uint16_t port, uint32_t timeoutMs)
+{
+  IPAddress ip;
+  if (!WiFi.hostByName(host, ip))
+  {
+    Serial.printf("[SecureConn] DNS failed: %s\n", host);
+    return false;
+  }
+
+  int fd = lwip_socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+  if (fd < 0)
+  {
+    Serial.printf("[SecureConn] socket failed: errno %d\n", errno);
+    return false;
+  }
+  net_.fd = fd;
+  lwip_fcntl(fd, F_SETFL, lwip_fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+  int one = 1;
+  lwip_setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = static_cast<uint32_t>(ip);
+  addr.sin_port = htons(port);
+  int result = lwip_connect(fd, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr));
+  if (result < 0 && errno != EINPROGRESS)
+  {
+    Serial.printf("[SecureConn] connect %s:%u failed: errno %d\n", host, port, errno);
+    return false;
+  }
+  if (result < 0)
+  {
+    if (!waitSocket(true, timeoutMs))
+    {
+      Serial.printf("[SecureConn] connect %s:%u timed out\n", host, port);
+      return false;
+    }
+    int socketError = 0;
+    socklen_t length = sizeof(socketError);
+    lwip_getsockopt(fd, SOL_SOCKET, SO_ERROR, &socketError, &length);
+    if (socketError != 0)
+    {
+      Serial.printf("[SecureConn] connect %s:%u failed: errno %d\n", host, port, socketError);
+      return false;
+    }
+  }
+  return true;
+}
+
+bool SecureClient::handshake(uint32_t timeoutMs)
+{
+  // 逐步推进握手：完整握手一定经过服务端证书这一步，会话恢复时服务端 Hello 之后直接切换密钥。
+  // 不能比较会话 ID：用 ticket 恢复时 mbedTLS 会随机生成新 ID
+  bool sawCertificate = false;
+  unsigned long startMs = millis();
+  while (ssl_.state != MBEDTLS_SSL_HANDSHAKE_OVER)
+  {
+    int ret = mbedtls_ssl_handshake_step(&ssl_);
+    if (ssl_.state == MBEDTLS_SSL_SERVER_CERTIFICATE)
+    {
+      sawCertificate = true;
+    }
+    if (ret == 0)
+    {
+      continue;
+    }
+    if (ret != MBEDTLS_ERR_SSL_WANT_READ && ret != MBEDTLS_ERR_SSL_WANT_WRITE)
+    {
+      char message[96];
+      mbedtls_strerror(ret, message, sizeof(message));
+      Serial.printf("[SecureConn] handshake failed: -0x%04x %s\n", -ret, message);
+      return false;
+    }
+    unsigned long elapsedMs = millis() - startMs;
+    if (elapsedMs >= timeoutMs)
+    {
+      Serial.println("[SecureConn] handshake timed out");
+      return false;
+    }
+    waitSocket(ret == MBEDTLS_ERR_SSL_WANT_WRITE, timeoutMs - elapsedMs);
+  }
+  resumed_ = !sawCertificate;
+  return true;
+}
+
+bool SecureClient::open(const char *host, uint16_t port, const uint8_t *session, size_t sessionLength,
+                        uint32_t timeoutMs)
+{
+  close();
+  unsigned long startMs = millis();
+  mbedtls_ssl_init(&ssl_);
+  mbedtls_ssl_config_init(&conf_);
+  mbedtls_ctr_drbg_init(&drbg_);
+  mbedtls_entropy_init(&entropy_);
+  open_ = true; // 从这里起 close() 负责释放上下文
+
+  int ret = mbedtls_ctr_drbg_seed(&drbg_, mbedtls_entropy_func, &entropy_,
+                                  reinterpret_cast<const unsigned char *>(kPersonalization),
+                                  strlen(kPersonalization));
+  if (ret == 0)
+  {
+    ret = mbedtls_ssl_config_defaults(&conf_, MBEDTLS_SSL_IS_CLIENT, MBEDTLS_SSL_TRANSPORT_STREAM,
+                                      MBEDTLS_SSL_PRESET_DEFAULT);
+  }
+  if (ret != 0)
+  {
+    Serial.printf("[SecureConn] init failed: -0x%04x\n", -ret);
+    close();
+    return false;
+  }
+  mbedtls_ssl_conf_authmode(&conf_, MBEDTLS_SSL_VERIFY_NONE);
+  mbedtls_ssl_conf_rng(&conf_, mbedtls_ctr_drbg_random, &drbg_);
+#if defined(MBEDTLS_SSL_SESSION_TICKETS)
+  mbedtls_ssl_conf_session_tickets(&conf_, MBEDTLS_SSL_SESSION_TICKETS_ENABLED);
+#endif
+  if (mbedtls_ssl_setup(&ssl_, &conf_) != 0 || mbedtls_ssl_set_hostname(&ssl_, host) != 0)
+  {
+    Serial.println("[SecureConn] ssl setup failed");
+    close();
+    return false;
+  }
+
+  if (session != nullptr && sessionLength > 0)
+  {
+    mbedtls_ssl_session cached;
+    mbedtls_ssl_session_init(&cached);
+    // 缓存的会话加载失败只是退回完整握手
+    if (mbedtls_ssl_session_load(&cached, session, sessionLength) == 0)
+    {
+      mbedtls_ssl_set_session(&ssl_, &cached);
+    }
+    mbedtls_ssl_session_free(&cached);
+  }
+
+  if (!openSocket(host, port, timeoutMs))
+  {
+    close();
+    return false;
+  }
+  mbedtls_ssl_set_bio(&ssl_, &net_, mbedtls_net_send, mbedtls_net_recv, nullptr);
+
+  unsigned long elapsedMs = millis() - startMs;
+  if (elapsedMs >= timeoutMs || !handshake(timeoutMs - elapsedMs))
+  {
+    close();
+    return false;
+  }
+
+  mbedtls_ssl_session_free(&session_);
+  mbedtls_ssl_session_init(&session_);
+  sessionValid_ = mbedtls_ssl_get_session(&ssl_, &session_) == 0;
+  Serial.printf("[SecureConn] %s:%u %s handshake %lu ms\n", host, port, resumed_ ? "resumed" : "full",
+                millis() - startMs);
+  return true;
+}
+
+size_t SecureClient::saveSession(uint8_t *out, size_t capacity)
+{
+  if (!sessionValid_)
+  {
+    return 0;
+  }
+  size_t length = 0;
+  int ret = mbedtls_ssl_session_save(&session_, out, out != nullptr ? capacity : 0, &length);
+  if (out == nullptr)
+  {
+    return ret == 0 || ret == MBEDTLS_ERR_SSL_BUFFER_TOO_SMALL ? length : 0;
+  }
+  return ret == 0 ? length : 0;
+}
+
+bool SecureClient::isOpen()
+{
+  if (!open_)
+  {
+    return false;
+  }
+  available();
+  return !peerClosed_;
+}
+
+void SecureClient::release()
+{
+  if (net_.fd >= 0)
+  {
+    mbedtls_net_free(&net_);
+  }
+  mbedtls_ssl_free(&ssl_);
+  mbedtls_ssl_config_free(&conf_);
+  mbedtls_ctr_drbg_free(&drbg_);
+  mbedtls_entropy_free(&entropy_);
+}
+
+void SecureClient::close()
+{
+  if (!open_)
+  {
+    return;
+  }
+  if (net_.fd >= 0 && !peerClosed_ && ssl_.state == MBEDTLS_SSL_HANDSHAKE_OVER)
+  {
+    mbedtls_ssl_close_notify(&ssl_);
+  }
+  release();
+  open_ = false;
+  peerClosed_ = false;
+  peeked_ = -1;
+}
+
+int SecureClient::connect(IPAddress ip, uint16_t port)
+{
+  return connect(ip, port, static_cast<int32_t>(_timeout));
+}
+
+int SecureClient::connect(IPAddress ip, uint16_t port, int32_t timeoutMs)
+{
+  return connect(ip.toString().c_str(), port, timeoutMs);
+}
+
+int SecureClient::connect(const char *host, uint16_t port)
+{
+  return connect(host, port, static_cast<int32_t>(_timeout));
+}
+
+int SecureClient::connect(const char *host, uint16_t port, int32_t timeoutMs)
+{
+  uint32_t timeout = timeoutMs > 0 ? static_cast<uint32_t>(timeoutMs) : 5000;
+  if (pool_ != nullptr)
+  {
+    return pool_->connect(*this, host, port, timeout) ? 1 : 0;
+  }
+  return open(host, port, nullptr, 0, timeout) ? 1 : 0;
+}
+
+size_t SecureClient::write(uint8_t data)
+{
+  return write(&data, 1);
+}
+
+size_t SecureClient::write(const uint8_t *buffer, size_t size)
+{
+  if (!open_ || peerClosed_)
+  {
+    return 0;
+  }
+  size_t written = 0;
+  unsigned long lastProgressMs = millis();
+  while (written < size)
+  {
+    int ret = mbedtls_ssl_write(&ssl_, buffer + written, size - written);
+    if (ret > 0)
+    {
+      written += static_cast<size_t>(ret);
+      lastProgressMs = millis();
+      continue;
+    }
+    if (ret != MBEDTLS_ERR_SSL_WANT_READ && ret != MBEDTLS_ERR_SSL_WANT_WRITE)
+    {
+      peerClosed_ = true;
+      break;
+    }
+    unsigned long idleMs = millis() - lastProgressMs;
+    if (idleMs >= _timeout)
+    {
+      break;
+    }
+    waitSocket(ret == MBEDTLS_ERR_SSL_WANT_WRITE, _timeout - idleMs);
+  }
+  return written;
+}
+
+int SecureClient::available()
+{
+  if (!open_)
+  {
+    return 0;
+  }
+  int pending = peeked_ >= 0 ? 1 : 0;
+  if (!peerClosed_)
+  {
+    // 零长度读取只推进记录层：解密已到达的数据，或收到 close_notify/EOF
+    int ret = mbedtls_ssl_read(&ssl_, nullptr, 0);
+    if (ret < 0 && ret != MBEDTLS_ERR_SSL_WANT_READ && ret != MBEDTLS_ERR_SSL_WANT_WRITE)
+    {
+      peerClosed_ = true;
+    }
+  }
+  return pending + static_cast<int>(mbedtls_ssl_get_bytes_avail(&ssl_));
+}
+
+int SecureClient::read()
+{
+  uint8_t data = 0;
+  return read(&data, 1) == 1 ? data : -1;
+}
+
+int SecureClient::read(uint8_t *buffer, size_t size)
+{
+  if (!open_ || size == 0)
+  {
+    return -1;
+  }
+  size_t offset = 0;
+  if (peeked_ >= 0)
+  {
+    buffer[offset++] = static_cast<uint8_t>(peeked_);
+    peeked_ = -1;
+  }
+  if (offset < size && available() > 0)
+  {
+    int ret = mbedtls_ssl_read(&ssl_, buffer + offset, size - offset);
+    if (ret > 0)
+    {
+      offset += static_cast<size_t>(ret);
+    }
+  }
+  return offset > 0 ? static_cast<int>(offset) : -1;
+}
+
+int SecureClient::peek()
+{
+  if (peeked_ < 0)
+  {
+    uint8_t data = 0;
+    if (read(&data, 1) == 1)
+    {
+      peeked_ = data;
+    }
+  }
+  return peeked_;
+}
+
+void SecureClient::flush()
+{
+  uint8_t discard[64];
+  while (available() > 0)
+  {
+    read(discard, sizeof(discard));
+  }
+}
+
+void SecureClient::stop()
+{
+  if (!held_)
+  {
+    close();
+  }
+}
+
+uint8_t SecureClient::connected()
+{
+  if (!open_)
+  {
+    return 0;
+  }
+  return available() > 0 || !peerClosed_;
+}
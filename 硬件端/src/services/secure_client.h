@@ -0,0 +1,74 @@
+#ifndef SECURE_CLIENT_H
+#define SECURE_CLIENT_H
+
+#include <Arduino.h>
+#include <WiFiClient.h>
+
+#include "mbedtls/ctr_drbg.h"
+#include "mbedtls/entropy.h"
+#include "mbedtls/net_sockets.h"
+#include "mbedtls/ssl.h"
+
+#include "../utils/secure_conn_pool.h"
+
+// 可恢复会话的 TLS 客户端：接口与 WiFiClientSecure 相同（HTTPClient 直接可用），
+// 证书不校验（同原来的 setInsecure），区别是握手时能带上缓存的会话做简化握手，
+// 握手后可导出会话。WiFiClientSecure 不提供会话接口，所以直接用 mbedTLS 实现。
+class SecureClient : public WiFiClient, public TlsTransport
+{
+public:
+  explicit SecureClient(SecureConnPool *pool = nullptr);
+  ~SecureClient();
+
+  using WiFiClient::write;
+  // WiFiClient 接口；connect 经过连接池（有池时），带缓存会话
+  int connect(IPAddress ip, uint16_t port) override;
+  int connect(IPAddress ip, uint16_t port, int32_t timeoutMs) override;
+  int connect(const char *host, uint16_t port) override;
+  int connect(const char *host, uint16_t port, int32_t timeoutMs) override;
+  size_t write(uint8_t data) override;
+  size_t write(const uint8_t *buffer, size_t size) override;
+  int available() override;
+  int read() override;
+  int read(uint8_t *buffer, size_t size) override;
+  int peek() override;
+  void flush() override;
+  void stop() override;
+  uint8_t connected() override;
+
+  // TlsTransport
+  bool open(const char *host, uint16_t port, const uint8_t *session, size_t sessionLength,
+            uint32_t timeoutMs) override;
+  bool resumed() const override { return resumed_; }
+  size_t saveSession(uint8_t *out, size_t capacity) override;
+  bool isOpen() override;
+  void close() override;
+
+  // 持有期间 stop() 不关闭连接：HTTPClient 析构时总会 stop，连接是否保留由持有方（SecureConnLease）决定
+  void setHeld(bool held) { held_ = held; }
+
+private:
+  SecureClient(const SecureClient &);
+  SecureClient &operator=(const SecureClient &);
+
+  bool openSocket(const char *host, uint16_t port, uint32_t timeoutMs);
+  bool handshake(uint32_t timeoutMs);
+  bool waitSocket(bool forWrite, uint32_t timeoutMs);
+  void release();
+
+  SecureConnPool *pool_;
+  mbedtls_ssl_context ssl_;
+  mbedtls_ssl_config conf_;
+  mbedtls_ctr_drbg_context drbg_;
+  mbedtls_entropy_context entropy_;
+  mbedtls_net_context net_;
+  mbedtls_ssl_session session_;
+  bool sessionValid_;
+  bool open_;
+  bool peerClosed_;
+  bool resumed_;
+  bool held_;
+  int peeked_; // peek 读出的一个字节，-1 表示没有
+};
+
+#endif // SECURE_CLIENT_H
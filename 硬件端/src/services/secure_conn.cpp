@@ -0,0 +1,142 @@
+#include "secure_conn.h"
+
+#include <esp_timer.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+#include "../config.h"
+#include "../utils/deferred_log.h"
+#include "network_worker.h"
+#include "secure_client.h"
+
+namespace
+{
+StaticSemaphore_t poolMutexBuffer;
+SemaphoreHandle_t poolMutex = nullptr;
+portMUX_TYPE poolMutexInitMux = portMUX_INITIALIZER_UNLOCKED;
+
+uint64_t clockUs()
+{
+  return static_cast<uint64_t>(esp_timer_get_time());
+}
+
+// 池只在读写缓存时持锁，其间会 malloc/free，所以用互斥量而不是临界区
+void lockPool(void *context)
+{
+  (void)context;
+  portENTER_CRITICAL(&poolMutexInitMux);
+  if (poolMutex == nullptr)
+  {
+    poolMutex = xSemaphoreCreateMutexStatic(&poolMutexBuffer);
+  }
+  portEXIT_CRITICAL(&poolMutexInitMux);
+  xSemaphoreTake(poolMutex, portMAX_DELAY);
+}
+
+void unlockPool(void *context)
+{
+  (void)context;
+  xSemaphoreGive(poolMutex);
+}
+
+SecureConnPool pool(clockUs, lockPool, unlockPool, nullptr);
+SecureClient warmClient(&pool);
+bool warmBound = false;
+
+void bindWarm()
+{
+  if (!warmBound)
+  {
+    pool.setWarm(&warmClient, SECURE_CONN_WARM_HOST, 443);
+    warmBound = true;
+  }
+}
+} // namespace
+
+void secureConnBeginTurn(bool prewarm)
+{
+  bindWarm();
+  pool.setKeepWarm(true);
+  if (prewarm && !pool.warmOpen())
+  {
+    networkSubmitSecurePrewarm(nullptr, nullptr);
+  }
+}
+
+void secureConnEndTurn()
+{
+  pool.setKeepWarm(false);
+}
+
+bool secureConnPrewarm()
+{
+  // 一轮已结束（预热排在别的请求后面）就不再握手
+  if (!pool.keepWarm() || !pool.claimWarm(SECURE_CONN_WARM_HOST, 443))
+  {
+    return false;
+  }
+  bool ok = pool.openWarm(BAIDU_HTTPS_HANDSHAKE_TIMEOUT_SEC * 1000UL);
+  pool.releaseWarm(ok);
+  return ok;
+}
+
+SecureConnStats secureConnStats()
+{
+  return pool.stats();
+}
+
+void secureConnReportStats()
+{
+  SecureConnStats copy = secureConnStats();
+  uint32_t fullHandshakes = copy.handshakes - copy.resumed;
+  DLOG(0, "[TLS连接] 握手: %u (会话恢复 %u), 平均 完整 %.1f ms / 恢复 %.1f ms\n",
+       copy.handshakes, copy.resumed,
+       fullHandshakes ? copy.fullHandshakeUs / 1000.0f / fullHandshakes : 0.0f,
+       copy.resumed ? copy.resumedHandshakeUs / 1000.0f / copy.resumed : 0.0f);
+  DLOG(0, "[TLS连接] 复用保温连接: %u, 保温被占用: %u, 失败: %u\n", copy.reused, copy.warmBusy, copy.failed);
+}
+
+SecureConnLease::SecureConnLease(const char *host, uint16_t port, uint32_t timeoutMs)
+    : client_(nullptr), temporary_(nullptr), warm_(false), reusable_(false)
+{
+  bindWarm();
+  if (pool.claimWarm(host, port))
+  {
+    warm_ = true;
+    if (pool.openWarm(timeoutMs))
+    {
+      client_ = &warmClient;
+    }
+  }
+  else
+  {
+    temporary_ = new SecureClient(&pool);
+    if (pool.connect(*temporary_, host, port, timeoutMs))
+    {
+      client_ = temporary_;
+    }
+  }
+  if (client_ != nullptr)
+  {
+    client_->setHeld(true);
+  }
+}
+
+SecureConnLease::~SecureConnLease()
+{
+  if (client_ != nullptr)
+  {
+    client_->setHeld(false);
+  }
+  if (warm_)
+  {
+    pool.releaseWarm(reusable_ && client_ != nullptr);
+  }
+  delete temporary_;
+}
+
+WiFiClient *SecureConnLease::client()
+{
+  return client_;
+}
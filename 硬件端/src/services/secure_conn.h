@@ -0,0 +1,43 @@
+#ifndef SECURE_CONN_H
+#define SECURE_CONN_H
+
+#include <Arduino.h>
+
+#include "../utils/secure_conn_pool.h"
+
+class SecureClient;
+
+// 百度接口的 HTTPS 连接：所有 TLS 连接共用一个会话缓存（按主机），新连接先尝试恢复会话；
+// 语音交互进行中对 SECURE_CONN_WARM_HOST（TTS）保持一条连接，多段合成复用，一轮结束时关闭。
+// 语音任务在一轮开始/结束时调用 begin/end；prewarm 为真时让网络任务提前握手，录音期间完成。
+void secureConnBeginTurn(bool prewarm);
+void secureConnEndTurn();
+// 网络任务上执行：本轮保温连接还没建立时先握手，返回连接可用
+bool secureConnPrewarm();
+SecureConnStats secureConnStats();
+void secureConnReportStats();
+
+// 一次 HTTPS 请求期间持有连接：host 是保温主机且空闲时用保温连接，否则建一条临时连接（同样带缓存会话）。
+// 析构时归还：setReusable() 表示响应已完整读完且服务端允许 keep-alive，保温连接才保留。
+class SecureConnLease
+{
+public:
+  SecureConnLease(const char *host, uint16_t port, uint32_t timeoutMs);
+  ~SecureConnLease();
+
+  // 连接失败时返回 nullptr
+  WiFiClient *client();
+  bool warm() const { return warm_; }
+  void setReusable() { reusable_ = true; }
+
+private:
+  SecureConnLease(const SecureConnLease &);
+  SecureConnLease &operator=(const SecureConnLease &);
+
+  SecureClient *client_;
+  SecureClient *temporary_;
+  bool warm_;
+  bool reusable_;
+};
+
+#endif // SECURE_CONN_H
@@ -0,0 +1,211 @@
+#include "sensor_scheduler.h"
+
+#include <Arduino.h>
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "../config.h"
+#include "../utils/deferred_log.h"
+
+namespace
+{
+TimerWheel wheel(SENSOR_SCHEDULER_TICK_MS);
+bool wheelStarted = false;
+TaskHandle_t schedulerTask = nullptr;
+
+portMUX_TYPE statsMux = portMUX_INITIALIZER_UNLOCKED;
+uint32_t pendingKicks = 0; // 每个作业一位，中断置位，调度任务取走
+SensorSchedulerStats stats = {};
+TimerJobStats jobSnapshot[TimerWheel::kMaxJobs] = {};
+bool jobValid[TimerWheel::kMaxJobs] = {};
+
+void ensureWheel()
+{
+  // 第一次登记作业时以当前时刻为起点，之前的 millis() 不算作欠下的 tick
+  if (!wheelStarted)
+  {
+    wheel.begin(millis());
+    wheelStarted = true;
+  }
+}
+
+void publishJobStats()
+{
+  TimerJobStats copy[TimerWheel::kMaxJobs];
+  bool valid[TimerWheel::kMaxJobs];
+  for (size_t i = 0; i < TimerWheel::kMaxJobs; ++i)
+  {
+    valid[i] = wheel.jobStats(static_cast<int>(i), &copy[i]);
+  }
+  portENTER_CRITICAL(&statsMux);
+  memcpy(jobSnapshot, copy, sizeof(jobSnapshot));
+  memcpy(jobValid, valid, sizeof(jobValid));
+  portEXIT_CRITICAL(&statsMux);
+}
+
+void schedulerLoop(void *parameter)
+{
+  (void)parameter;
+  while (true)
+  {
+    size_t ran = wheel.advance(millis());
+
+    portENTER_CRITICAL(&statsMux);
+    uint32_t kicked = pendingKicks;
+    pendingKicks = 0;
+    portEXIT_CRITICAL(&statsMux);
+    uint32_t kickCount = 0;
+    for (int id = 0; kicked != 0; ++id, kicked >>= 1)
+    {
+      if ((kicked & 1u) != 0 && wheel.kick(id))
+      {
+        ++kickCount;
+      }
+    }
+
+    portENTER_CRITICAL(&statsMux);
+    stats.jobRuns += ran;
+    stats.kicks += kickCount;
+    portEXIT_CRITICAL(&statsMux);
+    publishJobStats();
+
+    // 睡到最近的截止时刻（向上取整到系统 tick，避免早醒一次空转）；中断通知会提前唤醒
+    uint32_t waitMs = wheel.msUntilNext(millis());
+    TickType_t ticks = waitMs == UINT32_MAX ? portMAX_DELAY
+                                            : (waitMs + portTICK_PERIOD_MS - 1) / portTICK_PERIOD_MS;
+    ulTaskNotifyTake(pdTRUE, ticks);
+
+    portENTER_CRITICAL(&statsMux);
+    ++stats.wakeups;
+    portEXIT_CRITICAL(&statsMux);
+  }
+}
+} // namespace
+
+int sensorSchedulerAddPeriodic(const char *name, uint32_t periodMs, uint32_t firstDelayMs, TimerJobFn fn, void *context)
+{
+  ensureWheel();
+  int id = wheel.addPeriodic(name, periodMs, firstDelayMs, fn, context);
+  if (id == TimerWheel::kInvalidJob)
+  {
+    Serial.printf("[SensorSched] Job pool full, %s not added.\n", name);
+  }
+  return id;
+}
+
+int sensorSchedulerAddOneShot(const char *name, uint32_t delayMs, TimerJobFn fn, void *context)
+{
+  ensureWheel();
+  int id = wheel.addOneShot(name, delayMs, fn, context);
+  if (id == TimerWheel::kInvalidJob)
+  {
+    Serial.printf("[SensorSched] Job pool full, %s not added.\n", name);
+  }
+  return id;
+}
+
+bool sensorSchedulerReschedule(int id, uint32_t delayMs)
+{
+  return wheel.reschedule(id, delayMs);
+}
+
+bool sensorSchedulerStart()
+{
+  if (schedulerTask != nullptr)
+  {
+    return true;
+  }
+  ensureWheel();
+  if (xTaskCreatePinnedToCore(schedulerLoop, "SensorSched", SENSOR_SCHEDULER_STACK_SIZE, nullptr,
+                              SENSOR_SCHEDULER_PRIORITY, &schedulerTask, SENSOR_SCHEDULER_CORE) != pdPASS)
+  {
+    Serial.println("[SensorSched] Init failed: task not created.");
+    schedulerTask = nullptr;
+    return false;
+  }
+  return true;
+}
+
+void IRAM_ATTR sensorSchedulerKickFromISR(int id)
+{
+  if (id < 0 || id >= static_cast<int>(TimerWheel::kMaxJobs))
+  {
+    return;
+  }
+  portENTER_CRITICAL_ISR(&statsMux);
+  pendingKicks |= 1u << id;
+  portEXIT_CRITICAL_ISR(&statsMux);
+  // 任务还没创建时只留下标记，任务第一次循环时执行
+  if (schedulerTask == nullptr)
+  {
+    return;
+  }
+  BaseType_t woken = pdFALSE;
+  vTaskNotifyGiveFromISR(schedulerTask, &woken);
+  if (woken)
+  {
+    portYIELD_FROM_ISR();
+  }
+}
+
+void sensorSchedulerKick(int id)
+{
+  if (id < 0 || id >= static_cast<int>(TimerWheel::kMaxJobs))
+  {
+    return;
+  }
+  portENTER_CRITICAL(&statsMux);
+  pendingKicks |= 1u << id;
+  portEXIT_CRITICAL(&statsMux);
+  if (schedulerTask != nullptr)
+  {
+    xTaskNotifyGive(schedulerTask);
+  }
+}
+
+SensorSchedulerStats sensorSchedulerStats()
+{
+  portENTER_CRITICAL(&statsMux);
+  SensorSchedulerStats copy = stats;
+  portEXIT_CRITICAL(&statsMux);
+  return copy;
+}
+
+bool sensorSchedulerJobStats(int id, TimerJobStats *out)
+{
+  if (id < 0 || id >= static_cast<int>(TimerWheel::kMaxJobs) || out == nullptr)
+  {
+    return false;
+  }
+  portENTER_CRITICAL(&statsMux);
+  bool valid = jobValid[id];
+  *out = jobSnapshot[id];
+  portEXIT_CRITICAL(&statsMux);
+  return valid;
+}
+
+void sensorSchedulerReportStats()
+{
+  static uint32_t lastWakeups = 0;
+  static unsigned long lastReportAt = 0;
+  unsigned long now = millis();
+  SensorSchedulerStats copy = sensorSchedulerStats();
+  float seconds = (now - lastReportAt) / 1000.0f;
+  DLOG(0, "[传感器调度] 唤醒: %.1f 次/秒, 中断触发: %u, 作业执行: %u\n",
+       seconds > 0 ? (copy.wakeups - lastWakeups) / seconds : 0.0f, copy.kicks, copy.jobRuns);
+  lastWakeups = copy.wakeups;
+  lastReportAt = now;
+
+  for (int id = 0; id < static_cast<int>(TimerWheel::kMaxJobs); ++id)
+  {
+    TimerJobStats job;
+    if (sensorSchedulerJobStats(id, &job))
+    {
+      DLOG(0, "[传感器调度]   %s: 执行 %u, 中断 %u, 跳过 %u, 延迟 平均 %.1f ms / 最大 %u ms\n",
+           job.name, job.runs, job.kicks, job.missed,
+           job.runs ? static_cast<float>(job.totalLateMs) / job.runs : 0.0f, job.maxLateMs);
+    }
+  }
+}
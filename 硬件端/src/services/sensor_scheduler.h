@@ -0,0 +1,36 @@
+#ifndef SENSOR_SCHEDULER_H
+#define SENSOR_SCHEDULER_H
+
+#include <stdint.h>
+
+#include "../utils/timer_wheel.h"
+
+// 低频传感器调度任务（核心 0）：按键、光敏、GPS 读串口不再各占一个任务和 4 KB 栈，
+// 作为作业登记到同一个时间轮上，任务一次睡到最近的截止时刻。作业在调度任务上顺序执行，
+// 不能阻塞（不 vTaskDelay、不等 HTTP）。中断用 sensorSchedulerKickFromISR、
+// 其他任务用 sensorSchedulerKick 提前唤醒某个作业。
+struct SensorSchedulerStats
+{
+  uint32_t wakeups;  // 调度任务从等待中返回的次数
+  uint32_t kicks;    // 中断或其他任务提前触发的作业次数
+  uint32_t jobRuns;  // 按截止时刻执行的作业次数
+};
+
+// 登记作业：在 sensorSchedulerStart() 之前，或在作业回调里调用（时间轮不加锁）
+int sensorSchedulerAddPeriodic(const char *name, uint32_t periodMs, uint32_t firstDelayMs, TimerJobFn fn, void *context);
+int sensorSchedulerAddOneShot(const char *name, uint32_t delayMs, TimerJobFn fn, void *context);
+bool sensorSchedulerReschedule(int id, uint32_t delayMs);
+
+bool sensorSchedulerStart();
+// 中断里调用：标记作业待执行并唤醒调度任务，作业在任务上下文里执行
+void sensorSchedulerKickFromISR(int id);
+// 任务上下文（如串口事件回调）里的同一操作
+void sensorSchedulerKick(int id);
+
+SensorSchedulerStats sensorSchedulerStats();
+// 调度任务每次醒来后更新的快照，可在其他任务里读取
+bool sensorSchedulerJobStats(int id, TimerJobStats *out);
+// 唤醒频率按两次调用之间的间隔计算，再逐个作业输出执行延迟（DLOG）
+void sensorSchedulerReportStats();
+
+#endif // SENSOR_SCHEDULER_H
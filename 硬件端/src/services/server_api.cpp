@@ -4,19 +4,32 @@
 #include <HTTPClient.h>
 
 #include "config.h"
+#include "network_worker.h"
+#include "utils/json_helper.h"
+#include "utils/gps_track.h"
+#include "utils/latency_trace.h"
+#include "utils/wire_body.h"
 
-namespace ServerApi
+namespace
 {
-String postJson(const String &path, const String &body, int *httpStatus)
+constexpr const char *kJsonContentType = "application/json";
+constexpr const char *kMsgPackContentType = "application/msgpack";
+
+String postBytes(const String &path, const uint8_t *body, size_t length, const char *contentType, int *httpStatus)
 {
   String serverUrl = String(SERVER_BASE_URL) + path;
   HTTPClient http;
   http.begin(serverUrl);
   http.setTimeout(SERVER_HTTP_TIMEOUT_MS);
-  http.addHeader("Content-Type", "application/json");
+  http.addHeader("Content-Type", contentType);
   http.addHeader("X-Device-ID", DEVICE_ID);
+#if SERVER_WIRE_FORMAT_MSGPACK
+  // 服务端按 Accept 协商响应编码，旧服务端忽略该头仍返回 JSON
+  http.addHeader("Accept", kMsgPackContentType);
+#endif
 
-  int status = http.POST(body);
+  // 按长度发送，请求体里的 0x00 原样发出
+  int status = http.POST(const_cast<uint8_t *>(body), length);
   if (httpStatus)
   {
     *httpStatus = status;
@@ -36,47 +49,114 @@ String postJson(const String &path, const String &body, int *httpStatus)
   return payload;
 }
 
-String postAiText(const String &text)
+// 按 SERVER_WIRE_FORMAT_MSGPACK 选择请求体编码，服务端按 Content-Type 解码
+String postDocument(const String &path, const JsonDocument &doc, int *httpStatus = nullptr)
+{
+  WireBody body;
+  if (!body.encode(doc, SERVER_WIRE_FORMAT_MSGPACK))
+  {
+    Serial.printf("[ServerApi] POST %s: failed to encode %u-byte body\n", path.c_str(),
+                  static_cast<unsigned>(body.length()));
+    if (httpStatus)
+    {
+      *httpStatus = -1;
+    }
+    return "";
+  }
+  return postBytes(path, body.data(), body.length(),
+                   SERVER_WIRE_FORMAT_MSGPACK ? kMsgPackContentType : kJsonContentType, httpStatus);
+}
+} // namespace
+
+namespace ServerApi
+{
+String postJson(const String &path, const String &body, int *httpStatus)
+{
+  return postBytes(path, reinterpret_cast<const uint8_t *>(body.c_str()), body.length(), kJsonContentType, httpStatus);
+}
+
+String postAiText(const String &text, int *httpStatus)
 {
   DynamicJsonDocument doc(1024);
   doc["device_id"] = DEVICE_ID;
   doc["message"] = text;
-  String body;
-  serializeJson(doc, body);
-  return postJson("/ai", body);
+  return postDocument("/ai", doc, httpStatus);
 }
 
-bool postGps(double latitude, double longitude)
+bool postGps(double latitude, double longitude, int *httpStatus)
 {
   DynamicJsonDocument doc(256);
   doc["device_id"] = DEVICE_ID;
   doc["latitude"] = latitude;
   doc["longitude"] = longitude;
-  String body;
-  serializeJson(doc, body);
 
   int status = 0;
-  String payload = postJson("/gps", body, &status);
+  String payload = postDocument("/gps", doc, &status);
+  if (httpStatus)
+  {
+    *httpStatus = status;
+  }
   bool ok = status >= 200 && status < 300;
+  String summary = describeServerPayload(payload);
   if (ok)
   {
-    Serial.printf("[GPS] Server acknowledged upload | http=%d body=%s\n", status, payload.c_str());
+    Serial.printf("[GPS] Server acknowledged upload | http=%d body=%s\n", status, summary.c_str());
   }
   else
   {
-    Serial.printf("[GPS] Server rejected upload | http=%d body=%s\n", status, payload.c_str());
+    Serial.printf("[GPS] Server rejected upload | http=%d body=%s\n", status, summary.c_str());
   }
   return ok;
 }
 
-String postNavigationUpdate(const String &destination)
+String postGpsTrack(const char *track, size_t count, int *httpStatus)
+{
+  // const char* 只存指针，不拷贝 base64 文本
+  DynamicJsonDocument doc(256);
+  doc["device_id"] = DEVICE_ID;
+  doc["format"] = kTrackFormat;
+  doc["count"] = count;
+  doc["track"] = track;
+  return postDocument("/v1/gps/track", doc, httpStatus);
+}
+
+String postGpsTrackBinary(const uint8_t *track, size_t length, size_t count, int *httpStatus)
+{
+  // ArduinoJson 7 的 MsgPackBinary 序列化为 bin 8/16，服务端 track_codec 直接按字节解码
+  DynamicJsonDocument doc(256);
+  doc["device_id"] = DEVICE_ID;
+  doc["format"] = kTrackFormat;
+  doc["count"] = count;
+  doc["track"] = MsgPackBinary(track, length);
+  return postDocument("/v1/gps/track", doc, httpStatus);
+}
+
+String postNavigationUpdate(const String &destination, int *httpStatus)
 {
   DynamicJsonDocument doc(512);
   doc["device_id"] = DEVICE_ID;
   doc["destination"] = destination;
-  String body;
-  serializeJson(doc, body);
-  return postJson("/navigation_update", body);
+  return postDocument("/navigation_update", doc, httpStatus);
+}
+
+String postNavigationRoute(int *httpStatus)
+{
+  DynamicJsonDocument doc(128);
+  doc["device_id"] = DEVICE_ID;
+  return postDocument("/v1/navigation/route", doc, httpStatus);
+}
+
+String postDeviceStatus(const DeviceStatusReport &report, int *httpStatus)
+{
+  DynamicJsonDocument doc(384);
+  doc["device_id"] = DEVICE_ID;
+  doc["uptime_ms"] = report.uptimeMs;
+  doc["free_heap"] = report.freeHeap;
+  doc["rssi"] = report.rssi;
+  doc["app_state"] = report.appState;
+  doc["navigation_active"] = report.navigationActive;
+  doc["gps_valid"] = report.gpsValid;
+  return postDocument("/v1/device/status", doc, httpStatus);
 }
 
 bool postExitNavigation()
@@ -84,11 +164,14 @@ bool postExitNavigation()
   DynamicJsonDocument doc(256);
   doc["device_id"] = DEVICE_ID;
   doc["action"] = "exit_navigation";
-  String body;
-  serializeJson(doc, body);
 
   int status = 0;
-  postJson("/exit_navigation", body, &status);
+  postDocument("/exit_navigation", doc, &status);
   return status >= 200 && status < 300;
 }
+
+String postLatencyTrace(uint16_t turn, int *httpStatus)
+{
+  return postJson("/v1/device/trace", traceTurnJson(turn), httpStatus);
+}
 }
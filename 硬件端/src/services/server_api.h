@@ -3,13 +3,23 @@
 
 #include <Arduino.h>
 
+struct DeviceStatusReport;
+
 namespace ServerApi
 {
 String postJson(const String &path, const String &body, int *httpStatus = nullptr);
-String postAiText(const String &text);
-bool postGps(double latitude, double longitude);
-String postNavigationUpdate(const String &destination);
+String postAiText(const String &text, int *httpStatus = nullptr);
+bool postGps(double latitude, double longitude, int *httpStatus = nullptr);
+// 一批轨迹点：track 为 gps_track 编码后的 base64，count 为点数（JSON 请求体）
+String postGpsTrack(const char *track, size_t count, int *httpStatus = nullptr);
+// 同上，track 为编码后的原始字节，作为 MessagePack bin 发送；只在 SERVER_WIRE_FORMAT_MSGPACK 下使用
+String postGpsTrackBinary(const uint8_t *track, size_t length, size_t count, int *httpStatus = nullptr);
+String postNavigationUpdate(const String &destination, int *httpStatus = nullptr);
+String postNavigationRoute(int *httpStatus = nullptr);
+String postDeviceStatus(const DeviceStatusReport &report, int *httpStatus = nullptr);
 bool postExitNavigation();
+// Chrome trace-event 格式的一轮语音交互延迟，始终以 JSON 上报
+String postLatencyTrace(uint16_t turn, int *httpStatus = nullptr);
 }
 
 #endif // SERVER_API_H
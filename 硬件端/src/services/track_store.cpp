@@ -0,0 +1,397 @@
+#include "track_store.h"
+
+#include <LittleFS.h>
+#include <esp_heap_caps.h>
+#include <math.h>
+
+#include "../base64.h"
+#include "../config.h"
+#include "../utils/deferred_log.h"
+#include "../utils/gps_track.h"
+#include "network_worker.h"
+#include "server_api.h"
+
+namespace
+{
+constexpr const char *kSpillPath = "/gps_track.bin";
+constexpr size_t kHighWater = GPS_TRACK_RING_POINTS * 3 / 4;
+constexpr size_t kLowWater = GPS_TRACK_RING_POINTS / 4;
+
+portMUX_TYPE trackMux = portMUX_INITIALIZER_UNLOCKED;
+TrackRing ring;
+TrackStoreStats stats = {};
+uint32_t recordSeq = 0;
+
+// 以下只在后台网络任务上读写（spillBytes/readOffset 另由调度任务读取判断时机）
+bool storageReady = false;
+volatile uint32_t spillBytes = 0; // 溢出文件总长度
+volatile uint32_t readOffset = 0; // 已补传到的位置；重启后从头补传，服务端按时间戳去重
+TrackPoint *batch = nullptr;
+uint8_t *encoded = nullptr;
+#if !SERVER_WIRE_FORMAT_MSGPACK
+unsigned char *encodedText = nullptr; // JSON 没有二进制类型，批次转成 base64 文本发送
+#endif
+
+volatile unsigned long lastUploadAt = 0;
+volatile unsigned long nextAttemptAt = 0;
+uint32_t retryDelayMs = GPS_TRACK_UPLOAD_INTERVAL_MS;
+
+void *allocate(size_t bytes)
+{
+  void *memory = heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+  return memory != nullptr ? memory : malloc(bytes);
+}
+
+void bump(uint32_t *counter, uint32_t amount = 1)
+{
+  portENTER_CRITICAL(&trackMux);
+  *counter += amount;
+  portEXIT_CRITICAL(&trackMux);
+}
+
+uint32_t spillUnread()
+{
+  return spillBytes - readOffset;
+}
+
+void resetSpill()
+{
+  LittleFS.remove(kSpillPath);
+  spillBytes = 0;
+  readOffset = 0;
+}
+
+// 环超过高水位时，把最旧的点按批追加到溢出文件，直到降到低水位
+void spillIfNeeded()
+{
+  if (!storageReady)
+  {
+    return;
+  }
+  portENTER_CRITICAL(&trackMux);
+  size_t size = ring.size();
+  portEXIT_CRITICAL(&trackMux);
+  if (size <= kHighWater)
+  {
+    return;
+  }
+
+  while (size > kLowWater)
+  {
+    size_t want = size - kLowWater < GPS_TRACK_BATCH_POINTS ? size - kLowWater : GPS_TRACK_BATCH_POINTS;
+    portENTER_CRITICAL(&trackMux);
+    uint64_t seq = ring.headSeq();
+    size_t count = ring.copyOldest(batch, want);
+    portEXIT_CRITICAL(&trackMux);
+
+    size_t bytes = count * sizeof(TrackPoint);
+    bool written = false;
+    if (spillBytes + bytes <= GPS_TRACK_SPILL_MAX_BYTES)
+    {
+      File file = LittleFS.open(kSpillPath, "a");
+      written = file && file.write(reinterpret_cast<const uint8_t *>(batch), bytes) == bytes;
+      file.close();
+    }
+    if (written)
+    {
+      spillBytes += bytes;
+    }
+    else
+    {
+      Serial.printf("[TrackStore] Spill file full or not writable, dropped %u points\n", static_cast<unsigned>(count));
+    }
+
+    portENTER_CRITICAL(&trackMux);
+    ring.dropThrough(seq + count);
+    if (written)
+    {
+      stats.spilledPoints += count;
+    }
+    else
+    {
+      stats.dropped += count;
+    }
+    size = ring.size();
+    portEXIT_CRITICAL(&trackMux);
+  }
+}
+
+// 取下一批：先补传溢出文件里更早的点，再传环里的；返回点数
+size_t loadBatch(bool *fromFile, uint64_t *ringSeq)
+{
+  *fromFile = false;
+  if (storageReady && spillUnread() >= sizeof(TrackPoint))
+  {
+    File file = LittleFS.open(kSpillPath, "r");
+    if (file && file.seek(readOffset))
+    {
+      size_t want = spillUnread() / sizeof(TrackPoint);
+      if (want > GPS_TRACK_BATCH_POINTS)
+      {
+        want = GPS_TRACK_BATCH_POINTS;
+      }
+      size_t got = file.read(reinterpret_cast<uint8_t *>(batch), want * sizeof(TrackPoint)) / sizeof(TrackPoint);
+      file.close();
+      if (got > 0)
+      {
+        *fromFile = true;
+        return got;
+      }
+    }
+    // 文件丢了或读不出来：放弃剩余部分，继续传环
+    Serial.println("[TrackStore] Spill file unreadable, discarding it.");
+    resetSpill();
+  }
+
+  portENTER_CRITICAL(&trackMux);
+  *ringSeq = ring.headSeq();
+  size_t count = ring.copyOldest(batch, GPS_TRACK_BATCH_POINTS);
+  portEXIT_CRITICAL(&trackMux);
+  return count;
+}
+
+void acknowledge(size_t count, bool fromFile, uint64_t ringSeq)
+{
+  if (fromFile)
+  {
+    readOffset += count * sizeof(TrackPoint);
+    if (readOffset >= spillBytes)
+    {
+      resetSpill();
+    }
+    bump(&stats.replayedPoints, count);
+    return;
+  }
+  portENTER_CRITICAL(&trackMux);
+  ring.dropThrough(ringSeq + count);
+  portEXIT_CRITICAL(&trackMux);
+}
+
+bool uploadBatch(int *httpStatus)
+{
+  bool fromFile = false;
+  uint64_t ringSeq = 0;
+  size_t count = loadBatch(&fromFile, &ringSeq);
+  if (count == 0)
+  {
+    return true;
+  }
+
+  TrackEncoder encoder(encoded, trackEncodedBound(GPS_TRACK_BATCH_POINTS));
+  for (size_t i = 0; i < count; ++i)
+  {
+    encoder.add(batch[i]);
+  }
+  int status = 0;
+#if SERVER_WIRE_FORMAT_MSGPACK
+  // MessagePack 请求体直接带 bin，没有 base64 的 4/3 膨胀
+  ServerApi::postGpsTrackBinary(encoded, encoder.length(), count, &status);
+#else
+  encode_base64(encoded, static_cast<unsigned int>(encoder.length()), encodedText);
+  ServerApi::postGpsTrack(reinterpret_cast<const char *>(encodedText), count, &status);
+#endif
+  if (httpStatus)
+  {
+    *httpStatus = status;
+  }
+
+  unsigned long now = millis();
+  bool ok = status >= 200 && status < 300;
+  // “收到 2xx 才删除”的唯一例外：4xx（invalid_track、track_count_mismatch 等）说明这批数据本身有问题，
+  // 原样重发永远不会成功，留着会让后面所有的点（含溢出文件）一起卡住，所以丢弃并计入 rejected。
+  // 404（多半是旧服务端）、408、429 不是数据的问题，照常退避重试
+  bool rejected = status >= 400 && status < 500 && status != 404 && status != 408 && status != 429;
+  if (ok || rejected)
+  {
+    acknowledge(count, fromFile, ringSeq);
+    portENTER_CRITICAL(&trackMux);
+    if (ok)
+    {
+      stats.uploadedPoints += count;
+      stats.encodedBytes += encoder.length();
+      ++stats.batches;
+    }
+    else
+    {
+      ++stats.rejected;
+    }
+    portEXIT_CRITICAL(&trackMux);
+    lastUploadAt = now;
+    retryDelayMs = GPS_TRACK_UPLOAD_INTERVAL_MS;
+    nextAttemptAt = now;
+    if (rejected)
+    {
+      Serial.printf("[TrackStore] Server rejected %u points, http=%d\n", static_cast<unsigned>(count), status);
+    }
+    return true;
+  }
+
+  // 失败：点留在原处，按指数退避重试
+  bump(&stats.failures);
+  nextAttemptAt = now + retryDelayMs;
+  Serial.printf("[TrackStore] Upload of %u points failed, http=%d, retry in %lu s\n", static_cast<unsigned>(count),
+                status, static_cast<unsigned long>(retryDelayMs / 1000));
+  retryDelayMs = retryDelayMs * 2 > GPS_TRACK_RETRY_MAX_MS ? GPS_TRACK_RETRY_MAX_MS : retryDelayMs * 2;
+  return false;
+}
+
+uint16_t toSpeed(float speedKmh)
+{
+  if (isnan(speedKmh) || speedKmh < 0.0f)
+  {
+    return kTrackUnknownSpeed;
+  }
+  float scaled = speedKmh * 10.0f + 0.5f;
+  return scaled >= kTrackUnknownSpeed ? kTrackUnknownSpeed - 1 : static_cast<uint16_t>(scaled);
+}
+
+uint8_t toHdop(float hdop)
+{
+  if (isnan(hdop) || hdop < 0.0f || hdop * 10.0f + 0.5f >= kTrackUnknownHdop)
+  {
+    return kTrackUnknownHdop;
+  }
+  return static_cast<uint8_t>(hdop * 10.0f + 0.5f);
+}
+} // namespace
+
+bool trackStoreBegin()
+{
+  if (batch != nullptr)
+  {
+    return true;
+  }
+  TrackPoint *storage = static_cast<TrackPoint *>(allocate(GPS_TRACK_RING_POINTS * sizeof(TrackPoint)));
+  batch = static_cast<TrackPoint *>(allocate(GPS_TRACK_BATCH_POINTS * sizeof(TrackPoint)));
+  size_t encodedBound = trackEncodedBound(GPS_TRACK_BATCH_POINTS);
+  encoded = static_cast<uint8_t *>(allocate(encodedBound));
+#if SERVER_WIRE_FORMAT_MSGPACK
+  bool textReady = true;
+#else
+  encodedText = static_cast<unsigned char *>(allocate(encode_base64_length(encodedBound) + 1));
+  bool textReady = encodedText != nullptr;
+#endif
+  if (storage == nullptr || batch == nullptr || encoded == nullptr || !textReady)
+  {
+    Serial.println("[TrackStore] Init failed: out of memory.");
+    free(storage);
+    free(batch);
+    free(encoded);
+    batch = nullptr;
+    encoded = nullptr;
+#if !SERVER_WIRE_FORMAT_MSGPACK
+    free(encodedText);
+    encodedText = nullptr;
+#endif
+    return false;
+  }
+  portENTER_CRITICAL(&trackMux);
+  ring.attach(storage, GPS_TRACK_RING_POINTS);
+  portEXIT_CRITICAL(&trackMux);
+  return true;
+}
+
+void trackStoreAttachStorage()
+{
+  // 在开机阶段任务上调用，此时网络任务还不会碰溢出文件（storageReady 仍为 false）
+  File file = LittleFS.open(kSpillPath, "r");
+  uint32_t size = file ? static_cast<uint32_t>(file.size()) : 0;
+  file.close();
+  spillBytes = size - size % sizeof(TrackPoint);
+  readOffset = 0;
+  storageReady = true;
+  if (spillBytes > 0)
+  {
+    Serial.printf("[TrackStore] %u points from the last session waiting to be replayed.\n",
+                  static_cast<unsigned>(spillBytes / sizeof(TrackPoint)));
+  }
+}
+
+void trackStoreRecord(const GpsFix &fix)
+{
+  if (batch == nullptr || !fix.valid || fix.utcMs <= 0)
+  {
+    return;
+  }
+  // 背压：溢出文件过半说明断网已久，抽稀以延长能覆盖的时长
+  if (spillBytes > GPS_TRACK_SPILL_MAX_BYTES / 2 && (recordSeq++ % GPS_TRACK_DECIMATE) != 0)
+  {
+    bump(&stats.decimated);
+    return;
+  }
+
+  TrackPoint point;
+  point.utcMs = fix.utcMs;
+  point.latE6 = static_cast<int32_t>(lround(fix.latitude * 1e6));
+  point.lonE6 = static_cast<int32_t>(lround(fix.longitude * 1e6));
+  point.speedDkmh = toSpeed(fix.speedKmh);
+  point.hdopX10 = toHdop(fix.hdop);
+  point.satellites = fix.satellites;
+
+  portENTER_CRITICAL(&trackMux);
+  // 同一秒的 RMC 重复送来（比如兜底轮询和串口事件各读到一次）时不重复记录
+  bool duplicate = ring.size() > 0 && ring.at(ring.size() - 1).utcMs == point.utcMs;
+  if (!duplicate)
+  {
+    if (!ring.push(point))
+    {
+      ++stats.dropped;
+    }
+    ++stats.recorded;
+  }
+  portEXIT_CRITICAL(&trackMux);
+}
+
+void trackStoreServiceTick()
+{
+  if (batch == nullptr || networkJobPending(NetworkJobKind::GpsTrack))
+  {
+    return;
+  }
+
+  portENTER_CRITICAL(&trackMux);
+  size_t size = ring.size();
+  portEXIT_CRITICAL(&trackMux);
+
+  unsigned long now = millis();
+  bool needSpill = storageReady && size > kHighWater;
+  bool backlog = spillUnread() > 0 || size >= GPS_TRACK_BATCH_POINTS;
+  bool due = size > 0 && now - lastUploadAt >= GPS_TRACK_UPLOAD_INTERVAL_MS;
+  bool canUpload = isConnectedToWifi && static_cast<long>(now - nextAttemptAt) >= 0 && (backlog || due);
+  if (needSpill || canUpload)
+  {
+    networkSubmitGpsTrack(nullptr, nullptr);
+  }
+}
+
+bool trackStoreRunJob(int *httpStatus)
+{
+  spillIfNeeded();
+  if (!isConnectedToWifi || static_cast<long>(millis() - nextAttemptAt) < 0)
+  {
+    return true;
+  }
+  return uploadBatch(httpStatus);
+}
+
+TrackStoreStats trackStoreStats()
+{
+  portENTER_CRITICAL(&trackMux);
+  TrackStoreStats copy = stats;
+  copy.ringSize = ring.size();
+  copy.ringCapacity = ring.capacity();
+  portEXIT_CRITICAL(&trackMux);
+  copy.spillBytes = spillUnread();
+  return copy;
+}
+
+void trackStoreReportStats()
+{
+  TrackStoreStats copy = trackStoreStats();
+  DLOG(0, "[GPS轨迹] 记录: %u (抽稀 %u), 上传: %u 点 / %u 批, 平均 %.1f 字节/点\n",
+       copy.recorded, copy.decimated, copy.uploadedPoints, copy.batches,
+       copy.uploadedPoints ? static_cast<float>(copy.encodedBytes) / copy.uploadedPoints : 0.0f);
+  DLOG(0, "[GPS轨迹] 环: %u/%u, 溢出待补传: %u 字节, 已补传: %u\n",
+       copy.ringSize, copy.ringCapacity, copy.spillBytes, copy.replayedPoints);
+  DLOG(0, "[GPS轨迹] 失败: %u, 拒收: %u, 丢弃: %u\n", copy.failures, copy.rejected, copy.dropped);
+}
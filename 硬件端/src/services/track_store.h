@@ -0,0 +1,43 @@
+#ifndef TRACK_STORE_H
+#define TRACK_STORE_H
+
+#include <Arduino.h>
+
+#include "../gps.h"
+
+// GPS 轨迹存储转发：定位全速进 PSRAM 环，按批编码后由后台网络任务上传到 /v1/gps/track。
+// 网络不通时点留在环里，环快满时溢出到 LittleFS，恢复后按时间顺序补传。
+// 记录在传感器调度任务上，溢出和上传都在后台网络任务上，调度作业不碰文件和网络。
+// 点收到 2xx 后才从环/文件里删除；唯一例外是服务端 4xx 拒收的批次（数据本身有问题，重发不会成功），
+// 丢弃后计入 rejected，免得一批坏数据堵住后面所有的点。
+struct TrackStoreStats
+{
+  uint32_t recorded;     // 进环的定位
+  uint32_t decimated;    // 溢出文件过半后抽稀跳过的定位
+  uint32_t uploadedPoints;
+  uint32_t batches;      // 成功的上传请求
+  uint32_t encodedBytes; // 成功上传的编码后字节数（JSON 请求体里 base64 之前）
+  uint32_t failures;     // 上传失败（之后指数退避）
+  uint32_t rejected;     // 服务端 4xx 拒收后丢弃的批次
+  uint32_t spilledPoints;
+  uint32_t replayedPoints; // 从溢出文件补传的点
+  uint32_t dropped;      // 环被覆盖或溢出文件满而丢失的点
+  uint32_t ringSize;
+  uint32_t ringCapacity;
+  uint32_t spillBytes;   // 溢出文件中尚未补传的字节
+};
+
+// 分配环和上传缓冲（PSRAM 优先），gpsInit 里调用
+bool trackStoreBegin();
+// LittleFS 挂载后调用，之后才会溢出到文件；同时接上次开机没补传完的文件
+void trackStoreAttachStorage();
+// 调度任务：记录一个有效定位（没有 UTC 日期的定位不记）
+void trackStoreRecord(const GpsFix &fix);
+// 调度任务：需要溢出或到了上传时机时投递后台任务，不阻塞
+void trackStoreServiceTick();
+// 后台网络任务上执行：按需溢出，再上传一批；没有要做的事也返回 true
+bool trackStoreRunJob(int *httpStatus);
+TrackStoreStats trackStoreStats();
+void trackStoreReportStats();
+
+#endif // TRACK_STORE_H
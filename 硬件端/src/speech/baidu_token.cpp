@@ -0,0 +1,68 @@
+#include "baidu_token.h"
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+#include "voice.h"
+
+namespace
+{
+StaticSemaphore_t tokenMutexBuffer;
+SemaphoreHandle_t tokenMutex = nullptr;
+portMUX_TYPE tokenMutexInitMux = portMUX_INITIALIZER_UNLOCKED;
+String currentToken;
+volatile bool tokenReady = false;
+
+class TokenLock
+{
+public:
+  TokenLock()
+  {
+    portENTER_CRITICAL(&tokenMutexInitMux);
+    if (tokenMutex == nullptr)
+    {
+      tokenMutex = xSemaphoreCreateMutexStatic(&tokenMutexBuffer);
+    }
+    portEXIT_CRITICAL(&tokenMutexInitMux);
+    xSemaphoreTake(tokenMutex, portMAX_DELAY);
+  }
+  ~TokenLock() { xSemaphoreGive(tokenMutex); }
+};
+} // namespace
+
+void baiduTokenSet(const String &token)
+{
+  {
+    TokenLock lock;
+    currentToken = token;
+  }
+  tokenReady = token.length() > 0;
+}
+
+String baiduTokenGet()
+{
+  TokenLock lock;
+  return currentToken;
+}
+
+bool baiduTokenReady()
+{
+  return tokenReady;
+}
+
+bool baiduTokenRefresh()
+{
+  if (!baiduTokenNeedsRefresh(baiduTokenGet()))
+  {
+    return false;
+  }
+  Serial.println("[voice] Baidu token close to expiry, refreshing in background");
+  String token = refreshAccessToken_baidu();
+  if (token.length() == 0)
+  {
+    // 旧 Token 在过期前仍可用，下个检查周期再试
+    return false;
+  }
+  baiduTokenSet(token);
+  return true;
+}
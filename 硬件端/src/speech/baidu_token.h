@@ -0,0 +1,15 @@
+#ifndef BAIDU_TOKEN_H
+#define BAIDU_TOKEN_H
+
+#include <Arduino.h>
+
+// 当前使用的百度 AccessToken：开机阶段取得后写入，网络任务在临近过期时后台续期并替换，
+// 语音任务和网络任务随时读取。读写都拷贝 String，由互斥量保护。
+void baiduTokenSet(const String &token);
+String baiduTokenGet();
+bool baiduTokenReady();
+
+// 网络任务上执行：临近过期时联网续期一次，成功后替换当前 Token；无需续期或失败返回 false
+bool baiduTokenRefresh();
+
+#endif // BAIDU_TOKEN_H
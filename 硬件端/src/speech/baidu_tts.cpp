@@ -6,3 +6,8 @@ bool speakTextWithBaidu(String accessToken, String text)
 {
   return baiduTTS_Send(accessToken, text);
 }
+
+bool prefetchTextWithBaidu(String accessToken, String text, size_t *bytesCached)
+{
+  return baiduTTS_Prefetch(accessToken, text, bytesCached);
+}
@@ -4,5 +4,6 @@
 #include <Arduino.h>
 
 bool speakTextWithBaidu(String accessToken, String text);
+bool prefetchTextWithBaidu(String accessToken, String text, size_t *bytesCached = nullptr);
 
 #endif // BAIDU_TTS_H
@@ -0,0 +1,510 @@
+#include "deferred_log.h"
+
+#include <ctype.h>
+#include <stdio.h>
+
+#ifdef ARDUINO
+#include <atomic>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "../config.h"
+#endif
+
+namespace
+{
+int32_t valueAsInt(const DlogValue &value)
+{
+  if (value.type == DlogFloat)
+  {
+    return static_cast<int32_t>(value.f);
+  }
+  return value.i;
+}
+
+uint32_t valueAsUint(const DlogValue &value)
+{
+  if (value.type == DlogFloat)
+  {
+    return static_cast<uint32_t>(value.f);
+  }
+  return value.u;
+}
+
+double valueAsDouble(const DlogValue &value)
+{
+  switch (value.type)
+  {
+  case DlogFloat:
+    return value.f;
+  case DlogInt:
+    return value.i;
+  case DlogUint:
+    return value.u;
+  default:
+    return 0.0;
+  }
+}
+
+class Output
+{
+public:
+  Output(char *out, size_t capacity) : out_(out), capacity_(capacity) {}
+
+  void append(const char *text, size_t length)
+  {
+    size_t room = capacity_ - 1 - used_;
+    if (length > room)
+    {
+      length = room;
+    }
+    memcpy(out_ + used_, text, length);
+    used_ += length;
+  }
+
+  size_t finish()
+  {
+    out_[used_] = '\0';
+    return used_;
+  }
+
+private:
+  char *out_;
+  size_t capacity_;
+  size_t used_ = 0;
+};
+} // namespace
+
+size_t dlogFormat(char *out, size_t capacity, const char *format, const DlogValue *args, size_t argc)
+{
+  if (out == nullptr || capacity == 0)
+  {
+    return 0;
+  }
+  Output output(out, capacity);
+  size_t next = 0;
+  const char *p = format;
+  while (*p != '\0')
+  {
+    if (*p != '%')
+    {
+      const char *start = p;
+      while (*p != '\0' && *p != '%')
+      {
+        ++p;
+      }
+      output.append(start, p - start);
+      continue;
+    }
+    if (p[1] == '%')
+    {
+      output.append("%", 1);
+      p += 2;
+      continue;
+    }
+
+    // 重建单个说明符：保留标志/宽度/精度，去掉长度修饰（参数在设备上都按 32 位记录）
+    char spec[16];
+    size_t specLength = 0;
+    spec[specLength++] = *p++;
+    while (*p != '\0' && strchr("-+ #0", *p) != nullptr && specLength < sizeof(spec) - 2)
+    {
+      spec[specLength++] = *p++;
+    }
+    while (*p != '\0' && (isdigit(static_cast<unsigned char>(*p)) || *p == '.') && specLength < sizeof(spec) - 2)
+    {
+      spec[specLength++] = *p++;
+    }
+    while (*p != '\0' && strchr("hlzjtL", *p) != nullptr)
+    {
+      ++p;
+    }
+    char conversion = *p;
+    if (conversion == '\0')
+    {
+      break;
+    }
+    ++p;
+    spec[specLength++] = conversion;
+    spec[specLength] = '\0';
+
+    if (next >= argc)
+    {
+      output.append("<?>", 3);
+      continue;
+    }
+    const DlogValue &value = args[next++];
+
+    char piece[64];
+    int length = 0;
+    switch (conversion)
+    {
+    case 'd':
+    case 'i':
+      length = snprintf(piece, sizeof(piece), spec, static_cast<int>(valueAsInt(value)));
+      break;
+    case 'u':
+    case 'x':
+    case 'X':
+    case 'o':
+    case 'c':
+      length = snprintf(piece, sizeof(piece), spec, static_cast<unsigned>(valueAsUint(value)));
+      break;
+    case 'f':
+    case 'F':
+    case 'e':
+    case 'E':
+    case 'g':
+    case 'G':
+      length = snprintf(piece, sizeof(piece), spec, valueAsDouble(value));
+      break;
+    case 's':
+    {
+      const char *text = value.type == DlogString ? (value.s != nullptr ? value.s : "(null)") : "<?>";
+      if (specLength == 2)
+      {
+        output.append(text, strlen(text));
+        continue;
+      }
+      length = snprintf(piece, sizeof(piece), spec, text);
+      break;
+    }
+    case 'p':
+      length = snprintf(piece, sizeof(piece), "0x%08x", static_cast<unsigned>(value.u));
+      break;
+    default:
+      output.append(spec, specLength);
+      continue;
+    }
+    if (length > 0)
+    {
+      output.append(piece, length < static_cast<int>(sizeof(piece)) ? length : sizeof(piece) - 1);
+    }
+  }
+  return output.finish();
+}
+
+#ifdef ARDUINO
+namespace
+{
+static_assert((DLOG_RING_SLOTS & (DLOG_RING_SLOTS - 1)) == 0, "DLOG_RING_SLOTS must be a power of two");
+constexpr uint32_t kRingMask = DLOG_RING_SLOTS - 1;
+constexpr size_t kMaxInlineString = 64;
+
+struct Slot
+{
+  std::atomic<uint32_t> sequence;
+  DlogSite *site;
+  uint32_t timestampUs;
+  uint32_t suppressed;
+  uint8_t core;
+  uint8_t argc;
+  uint8_t types[kDlogMaxArgs];
+  uintptr_t args[kDlogMaxArgs];
+};
+
+// 有界多生产者单消费者环（Vyukov 序号法）：生产者只做一次 CAS 占位，写完后发布序号，
+// 同核的任务互相抢占也不会阻塞；消费者只有排空任务一个。每核一个环，两核的写入互不争用缓存行。
+struct Ring
+{
+  std::atomic<uint32_t> enqueuePos;
+  uint32_t dequeuePos;
+  Slot slots[DLOG_RING_SLOTS];
+};
+
+Ring rings[portNUM_PROCESSORS];
+volatile bool ringsReady = false;
+TaskHandle_t drainTask = nullptr;
+std::atomic<uint32_t> writtenCount(0);
+std::atomic<uint32_t> droppedCount(0);
+std::atomic<uint32_t> suppressedCount(0);
+uint32_t emittedCount = 0;
+uint32_t maxDepth = 0;
+uint16_t nextSiteId = 0;
+
+struct Record
+{
+  DlogSite *site;
+  uint32_t timestampUs;
+  uint32_t suppressed;
+  uint8_t core;
+  uint8_t argc;
+  uint8_t types[kDlogMaxArgs];
+  uintptr_t args[kDlogMaxArgs];
+};
+
+bool pop(Ring &ring, Record *record)
+{
+  Slot &slot = ring.slots[ring.dequeuePos & kRingMask];
+  if (slot.sequence.load(std::memory_order_acquire) != ring.dequeuePos + 1)
+  {
+    return false;
+  }
+  record->site = slot.site;
+  record->timestampUs = slot.timestampUs;
+  record->suppressed = slot.suppressed;
+  record->core = slot.core;
+  record->argc = slot.argc;
+  memcpy(record->types, slot.types, sizeof(record->types));
+  memcpy(record->args, slot.args, sizeof(record->args));
+  slot.sequence.store(ring.dequeuePos + DLOG_RING_SLOTS, std::memory_order_release);
+  ++ring.dequeuePos;
+  return true;
+}
+
+void toValues(const Record &record, DlogValue *values)
+{
+  for (size_t i = 0; i < record.argc; ++i)
+  {
+    values[i].type = record.types[i];
+    if (record.types[i] == DlogString)
+    {
+      values[i].s = reinterpret_cast<const char *>(record.args[i]);
+    }
+    else
+    {
+      values[i].u = static_cast<uint32_t>(record.args[i]);
+    }
+  }
+}
+
+void emitText(const Record &record)
+{
+  DlogValue values[kDlogMaxArgs];
+  toValues(record, values);
+  char line[256];
+  size_t length = dlogFormat(line, sizeof(line), record.site->format, values, record.argc);
+  if (record.suppressed > 0)
+  {
+    // 限速或环满未输出的条数插在行尾换行之前
+    bool newline = length > 0 && line[length - 1] == '\n';
+    if (newline)
+    {
+      --length;
+    }
+    length += snprintf(line + length, sizeof(line) - length, " (+%u 条未输出)%s",
+                       static_cast<unsigned>(record.suppressed), newline ? "\n" : "");
+    if (length >= sizeof(line))
+    {
+      length = sizeof(line) - 1;
+    }
+  }
+  Serial.write(reinterpret_cast<const uint8_t *>(line), length);
+}
+
+void writeFrame(uint8_t type, const uint8_t *payload, size_t length)
+{
+  uint8_t header[kDlogFrameHeader] = {kDlogFrameMagic0, kDlogFrameMagic1, type,
+                                      static_cast<uint8_t>(length & 0xFF), static_cast<uint8_t>(length >> 8)};
+  uint8_t check = 0;
+  for (size_t i = 0; i < length; ++i)
+  {
+    check ^= payload[i];
+  }
+  Serial.write(header, sizeof(header));
+  Serial.write(payload, length);
+  Serial.write(&check, 1);
+}
+
+void put16(uint8_t *out, uint16_t value)
+{
+  out[0] = value & 0xFF;
+  out[1] = value >> 8;
+}
+
+void put32(uint8_t *out, uint32_t value)
+{
+  for (int i = 0; i < 4; ++i)
+  {
+    out[i] = (value >> (8 * i)) & 0xFF;
+  }
+}
+
+void emitBinary(const Record &record)
+{
+  uint8_t payload[kDlogMaxFramePayload];
+  DlogSite *site = record.site;
+  if (site->id == 0)
+  {
+    // 首次出现的调用点先发定义帧，解码器据此建表；排空任务是唯一写 id 的地方
+    site->id = ++nextSiteId;
+    size_t formatLength = strlen(site->format);
+    if (formatLength > kDlogMaxFramePayload - 2)
+    {
+      formatLength = kDlogMaxFramePayload - 2;
+    }
+    put16(payload, site->id);
+    memcpy(payload + 2, site->format, formatLength);
+    writeFrame(DlogFrameDefine, payload, formatLength + 2);
+  }
+
+  size_t length = 0;
+  put16(payload, site->id);
+  payload[2] = record.core;
+  payload[3] = record.argc;
+  put32(payload + 4, record.timestampUs);
+  put32(payload + 8, record.suppressed);
+  length = 12;
+  for (size_t i = 0; i < record.argc; ++i)
+  {
+    payload[length++] = record.types[i];
+    if (record.types[i] == DlogString)
+    {
+      // 字符串在设备上解引用后内联，解码器不需要固件镜像
+      const char *text = reinterpret_cast<const char *>(record.args[i]);
+      size_t textLength = text == nullptr ? 0 : strnlen(text, kMaxInlineString);
+      payload[length++] = static_cast<uint8_t>(textLength);
+      memcpy(payload + length, text, textLength);
+      length += textLength;
+    }
+    else
+    {
+      put32(payload + length, static_cast<uint32_t>(record.args[i]));
+      length += 4;
+    }
+  }
+  writeFrame(DlogFrameEvent, payload, length);
+}
+
+void drainLoop(void *parameter)
+{
+  (void)parameter;
+  Record record;
+  while (true)
+  {
+    bool any = false;
+    for (size_t core = 0; core < portNUM_PROCESSORS; ++core)
+    {
+      Ring &ring = rings[core];
+      uint32_t depth = ring.enqueuePos.load(std::memory_order_relaxed) - ring.dequeuePos;
+      if (depth > maxDepth)
+      {
+        maxDepth = depth;
+      }
+      while (pop(ring, &record))
+      {
+        any = true;
+#if DLOG_BINARY_OUTPUT
+        emitBinary(record);
+#else
+        emitText(record);
+#endif
+        ++emittedCount;
+      }
+    }
+    if (!any)
+    {
+      vTaskDelay(pdMS_TO_TICKS(DLOG_DRAIN_INTERVAL_MS));
+    }
+  }
+}
+} // namespace
+
+bool dlogStart()
+{
+  if (drainTask != nullptr)
+  {
+    return true;
+  }
+  for (size_t core = 0; core < portNUM_PROCESSORS; ++core)
+  {
+    rings[core].enqueuePos.store(0, std::memory_order_relaxed);
+    rings[core].dequeuePos = 0;
+    for (uint32_t i = 0; i < DLOG_RING_SLOTS; ++i)
+    {
+      rings[core].slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+  std::atomic_thread_fence(std::memory_order_release);
+  ringsReady = true;
+
+  if (xTaskCreatePinnedToCore(drainLoop, "LogDrain", DLOG_TASK_STACK_SIZE, nullptr, DLOG_TASK_PRIORITY,
+                              &drainTask, DLOG_TASK_CORE) != pdPASS)
+  {
+    ringsReady = false;
+    drainTask = nullptr;
+    Serial.println("[DLog] Init failed: task not created.");
+    return false;
+  }
+  return true;
+}
+
+void dlogSubmit(DlogSite *site, const DlogArg *args, size_t argc)
+{
+  if (!ringsReady)
+  {
+    return;
+  }
+
+  uint32_t nowMs = millis();
+  if (site->minIntervalMs != 0 && site->lastMs != 0 && nowMs - site->lastMs < site->minIntervalMs)
+  {
+    __atomic_add_fetch(&site->suppressed, 1, __ATOMIC_RELAXED);
+    suppressedCount.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  site->lastMs = nowMs != 0 ? nowMs : 1;
+  uint32_t suppressed = __atomic_exchange_n(&site->suppressed, 0, __ATOMIC_RELAXED);
+
+  uint8_t core = static_cast<uint8_t>(xPortGetCoreID());
+  Ring &ring = rings[core];
+  uint32_t pos = ring.enqueuePos.load(std::memory_order_relaxed);
+  Slot *slot = nullptr;
+  while (true)
+  {
+    slot = &ring.slots[pos & kRingMask];
+    uint32_t sequence = slot->sequence.load(std::memory_order_acquire);
+    int32_t diff = static_cast<int32_t>(sequence - pos);
+    if (diff == 0)
+    {
+      if (ring.enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+      {
+        break;
+      }
+    }
+    else if (diff < 0)
+    {
+      // 环满：丢弃本条，抑制计数还给调用点，下次输出时一并报告
+      __atomic_add_fetch(&site->suppressed, suppressed + 1, __ATOMIC_RELAXED);
+      droppedCount.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    else
+    {
+      pos = ring.enqueuePos.load(std::memory_order_relaxed);
+    }
+  }
+
+  slot->site = site;
+  slot->timestampUs = micros();
+  slot->suppressed = suppressed;
+  slot->core = core;
+  slot->argc = static_cast<uint8_t>(argc);
+  for (size_t i = 0; i < argc; ++i)
+  {
+    slot->types[i] = args[i].type;
+    slot->args[i] = args[i].bits;
+  }
+  slot->sequence.store(pos + 1, std::memory_order_release);
+  writtenCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+DlogStats dlogStats()
+{
+  DlogStats stats;
+  stats.written = writtenCount.load(std::memory_order_relaxed);
+  stats.dropped = droppedCount.load(std::memory_order_relaxed);
+  stats.suppressed = suppressedCount.load(std::memory_order_relaxed);
+  stats.emitted = emittedCount;
+  stats.maxDepth = maxDepth;
+  return stats;
+}
+
+void dlogReportStats()
+{
+  DlogStats stats = dlogStats();
+  DLOG(0, "[延迟日志] 写入: %u, 输出: %u, 环满丢弃: %u, 限速: %u, 环最高占用: %u/%u\n",
+       stats.written, stats.emitted, stats.dropped, stats.suppressed, stats.maxDepth, DLOG_RING_SLOTS);
+}
+#endif
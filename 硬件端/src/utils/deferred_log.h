@@ -0,0 +1,145 @@
+#ifndef DEFERRED_LOG_H
+#define DEFERRED_LOG_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <type_traits>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#endif
+
+// 延迟日志：实时任务里只把调用点指针、时间戳和原始参数（各 32 位）写进本核的无锁环，
+// 格式化和串口输出由低优先级的排空任务完成，采集/测距任务不再阻塞在 UART 上。
+//
+//   DLOG(1000, "[录音] 已录制: %u 字节, 能量: %u\n", recordingSize, audioEnergy);
+//
+// 第一个参数是该调用点的最小输出间隔（毫秒，0 为不限），间隔内的调用只计数，
+// 下次输出时附带被抑制的条数。%s 参数只记录指针，只能传字符串常量或静态缓冲区。
+// 二进制输出模式（DLOG_BINARY_OUTPUT）下串口只发帧，主机端用 tools/dlog_decode.cpp 还原文本。
+
+constexpr size_t kDlogMaxArgs = 6;
+
+enum DlogArgType : uint8_t
+{
+  DlogInt = 0,
+  DlogUint = 1,
+  DlogFloat = 2,
+  DlogString = 3
+};
+
+struct DlogSite
+{
+  const char *format;
+  uint16_t minIntervalMs;
+  uint16_t id;            // 排空任务首次见到该调用点时分配，二进制帧里代替格式串
+  uint32_t lastMs;
+  uint32_t suppressed;    // 间隔内被丢弃的调用数
+};
+
+// 数值参数占低 32 位；字符串参数为指针（ESP32 上同为 32 位）
+struct DlogArg
+{
+  uint8_t type;
+  uintptr_t bits;
+};
+
+// 格式化用的参数：字符串在设备上是原指针，在解码器里指向帧内的内联副本
+struct DlogValue
+{
+  uint8_t type;
+  union
+  {
+    int32_t i;
+    uint32_t u;
+    float f;
+    const char *s;
+  };
+};
+
+// 按 printf 语义格式化，参数类型以记录的类型为准（%d 遇到浮点参数时取整而不是按位解释）；
+// 不支持 %ll 和 %n。返回写入的字节数（不含结尾 0），超出时截断。
+size_t dlogFormat(char *out, size_t capacity, const char *format, const DlogValue *args, size_t argc);
+
+// 二进制帧：A5 5A type len(u16 LE) payload xor(payload)
+enum DlogFrameType : uint8_t
+{
+  DlogFrameDefine = 'D', // id(u16) format...
+  DlogFrameEvent = 'E'   // id(u16) core(u8) argc(u8) timestampUs(u32) suppressed(u32) 参数...
+};
+constexpr uint8_t kDlogFrameMagic0 = 0xA5;
+constexpr uint8_t kDlogFrameMagic1 = 0x5A;
+constexpr size_t kDlogFrameHeader = 5;
+constexpr size_t kDlogMaxFramePayload = 512;
+
+struct DlogStats
+{
+  uint32_t written;
+  uint32_t dropped;    // 环满
+  uint32_t suppressed; // 调用点限速
+  uint32_t emitted;
+  uint32_t maxDepth;   // 单个环的历史最高占用
+};
+
+template <typename T>
+inline DlogArg dlogPack(T value)
+{
+  static_assert(std::is_arithmetic<T>::value || std::is_enum<T>::value, "DLOG only takes numbers and C strings");
+  static_assert(sizeof(T) <= 4 || std::is_floating_point<T>::value, "DLOG arguments are 32-bit");
+  DlogArg arg;
+  if (std::is_floating_point<T>::value)
+  {
+    float f = static_cast<float>(value);
+    uint32_t bits;
+    memcpy(&bits, &f, sizeof(f));
+    arg.type = DlogFloat;
+    arg.bits = bits;
+  }
+  else
+  {
+    arg.type = std::is_signed<T>::value ? DlogInt : DlogUint;
+    arg.bits = static_cast<uint32_t>(value);
+  }
+  return arg;
+}
+
+inline DlogArg dlogPack(const char *value)
+{
+  DlogArg arg;
+  arg.type = DlogString;
+  arg.bits = reinterpret_cast<uintptr_t>(value);
+  return arg;
+}
+
+inline DlogArg dlogPack(char *value)
+{
+  return dlogPack(static_cast<const char *>(value));
+}
+
+#ifdef ARDUINO
+bool dlogStart();
+// 实时路径：限速检查 + 一次无锁入环，不格式化、不触碰串口，可在任务上下文任意核调用
+void dlogSubmit(DlogSite *site, const DlogArg *args, size_t argc);
+DlogStats dlogStats();
+// 延迟日志自身的统计也走环：调用方只入队，不在当前任务上写串口
+void dlogReportStats();
+
+template <typename... Args>
+inline void dlogWrite(DlogSite *site, Args... args)
+{
+  static_assert(sizeof...(Args) <= kDlogMaxArgs, "DLOG takes at most 6 arguments");
+  const DlogArg packed[sizeof...(Args) + 1] = {dlogPack(args)..., DlogArg()};
+  dlogSubmit(site, packed, sizeof...(Args));
+}
+
+#define DLOG(intervalMs, format, ...)                                  \
+  do                                                                   \
+  {                                                                    \
+    static DlogSite dlogSite_ = {format, (intervalMs), 0, 0, 0};       \
+    dlogWrite(&dlogSite_, ##__VA_ARGS__);                              \
+  } while (0)
+#endif
+
+#endif // DEFERRED_LOG_H
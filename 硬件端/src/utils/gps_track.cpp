@@ -0,0 +1,123 @@
+#include "gps_track.h"
+
+#include <string.h>
+
+namespace
+{
+size_t putUvarint(uint8_t *out, uint64_t value)
+{
+  size_t length = 0;
+  while (value >= 0x80)
+  {
+    out[length++] = static_cast<uint8_t>(value | 0x80);
+    value >>= 7;
+  }
+  out[length++] = static_cast<uint8_t>(value);
+  return length;
+}
+
+size_t putSvarint(uint8_t *out, int64_t value)
+{
+  uint64_t zigzag = (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+  return putUvarint(out, zigzag);
+}
+} // namespace
+
+void TrackRing::attach(TrackPoint *storage, size_t capacity)
+{
+  points_ = storage;
+  capacity_ = storage != nullptr ? capacity : 0;
+  head_ = 0;
+  size_ = 0;
+  headSeq_ = 0;
+  overwritten_ = 0;
+}
+
+bool TrackRing::push(const TrackPoint &point)
+{
+  if (capacity_ == 0)
+  {
+    ++overwritten_;
+    return false;
+  }
+  bool room = size_ < capacity_;
+  if (!room)
+  {
+    head_ = (head_ + 1) % capacity_;
+    --size_;
+    ++headSeq_;
+    ++overwritten_;
+  }
+  points_[(head_ + size_) % capacity_] = point;
+  ++size_;
+  return room;
+}
+
+size_t TrackRing::copyOldest(TrackPoint *out, size_t maxCount) const
+{
+  size_t count = size_ < maxCount ? size_ : maxCount;
+  for (size_t i = 0; i < count; ++i)
+  {
+    out[i] = at(i);
+  }
+  return count;
+}
+
+void TrackRing::drop(size_t count)
+{
+  if (count > size_)
+  {
+    count = size_;
+  }
+  if (capacity_ != 0)
+  {
+    head_ = (head_ + count) % capacity_;
+  }
+  size_ -= count;
+  headSeq_ += count;
+}
+
+void TrackRing::dropThrough(uint64_t seq)
+{
+  if (seq > headSeq_)
+  {
+    drop(static_cast<size_t>(seq - headSeq_));
+  }
+}
+
+TrackEncoder::TrackEncoder(uint8_t *out, size_t capacity) : out_(out), capacity_(capacity), length_(0), count_(0)
+{
+  memset(&last_, 0, sizeof(last_));
+  if (capacity_ > 0)
+  {
+    out_[length_++] = kTrackFormat;
+  }
+}
+
+bool TrackEncoder::add(const TrackPoint &point)
+{
+  if (length_ == 0 || capacity_ - length_ < kMaxPointBytes)
+  {
+    return false;
+  }
+  uint8_t *p = out_ + length_;
+  if (count_ == 0)
+  {
+    p += putUvarint(p, static_cast<uint64_t>(point.utcMs < 0 ? 0 : point.utcMs));
+    p += putSvarint(p, point.latE6);
+    p += putSvarint(p, point.lonE6);
+  }
+  else
+  {
+    p += putSvarint(p, point.utcMs - last_.utcMs);
+    p += putSvarint(p, static_cast<int64_t>(point.latE6) - last_.latE6);
+    p += putSvarint(p, static_cast<int64_t>(point.lonE6) - last_.lonE6);
+  }
+  p += putUvarint(p, point.speedDkmh == kTrackUnknownSpeed ? 0 : point.speedDkmh + 1u);
+  p += putUvarint(p, point.hdopX10 == kTrackUnknownHdop ? 0 : point.hdopX10 + 1u);
+  p += putUvarint(p, point.satellites);
+  length_ = static_cast<size_t>(p - out_);
+  last_ = point;
+  ++count_;
+  return true;
+}
@@ -0,0 +1,86 @@
+#ifndef GPS_TRACK_H
+#define GPS_TRACK_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// GPS 轨迹点的环形缓冲与批量上传编码。纯逻辑，不依赖 Arduino，不加锁（调用方负责），
+// 主机端测试与体积对比见 tools/gps_track_check.cpp，服务端解码见 web/utils/track_codec.py。
+//
+// 编码（format 1）：首字节为格式号，之后逐点：
+//   第一个点  uvarint(utcMs)   svarint(latE6)  svarint(lonE6)
+//   其余的点  svarint(Δ utcMs) svarint(Δ latE6) svarint(Δ lonE6)   —— 相对上一点
+//   每个点    uvarint(速度 0.1 km/h + 1) uvarint(HDOP×10 + 1) uvarint(卫星数)   —— 0 表示未知
+// svarint 为 zigzag 后的 LEB128。1 Hz 步行时每点约 7 字节，JSON 单点上报约 80 字节。
+struct TrackPoint
+{
+  int64_t utcMs;       // GPS UTC，Unix 纪元毫秒
+  int32_t latE6;       // 1e-6 度
+  int32_t lonE6;
+  uint16_t speedDkmh;  // 0.1 km/h，kUnknownSpeed 为未知
+  uint8_t hdopX10;     // HDOP×10，kUnknownHdop 为未知（> 25.4 也记为未知）
+  uint8_t satellites;
+};
+
+static const uint16_t kTrackUnknownSpeed = UINT16_MAX;
+static const uint8_t kTrackUnknownHdop = UINT8_MAX;
+static const uint8_t kTrackFormat = 1;
+
+// 固定容量的环，满了覆盖最旧的点。headSeq() 是最旧点的序号（已移出的点数），
+// 上传时记下发送时的 headSeq，确认后 dropThrough 只移出确实发出去的那些点
+class TrackRing
+{
+public:
+  TrackRing() : points_(nullptr), capacity_(0), head_(0), size_(0), headSeq_(0), overwritten_(0) {}
+
+  void attach(TrackPoint *storage, size_t capacity);
+  // 返回 false 表示环满，覆盖了最旧的点
+  bool push(const TrackPoint &point);
+  const TrackPoint &at(size_t index) const { return points_[(head_ + index) % capacity_]; }
+  // 拷出最旧的至多 maxCount 个点，返回个数
+  size_t copyOldest(TrackPoint *out, size_t maxCount) const;
+  void drop(size_t count);
+  // 移出序号小于 seq 的点（已被覆盖的不重复计）
+  void dropThrough(uint64_t seq);
+
+  size_t size() const { return size_; }
+  size_t capacity() const { return capacity_; }
+  uint64_t headSeq() const { return headSeq_; }
+  uint32_t overwritten() const { return overwritten_; }
+
+private:
+  TrackPoint *points_;
+  size_t capacity_;
+  size_t head_;
+  size_t size_;
+  uint64_t headSeq_;
+  uint32_t overwritten_;
+};
+
+// 逐点追加编码，空间不够时拒绝整个点（不会写出半个点）
+class TrackEncoder
+{
+public:
+  // 单点编码的最大字节数：10 + 5 + 5 + 3 + 2 + 2
+  static const size_t kMaxPointBytes = 27;
+
+  TrackEncoder(uint8_t *out, size_t capacity);
+  bool add(const TrackPoint &point);
+  size_t length() const { return length_; }
+  size_t count() const { return count_; }
+
+private:
+  uint8_t *out_;
+  size_t capacity_;
+  size_t length_;
+  size_t count_;
+  TrackPoint last_;
+};
+
+// count 个点编码后的最大字节数（含格式字节）
+inline size_t trackEncodedBound(size_t count)
+{
+  return 1 + count * TrackEncoder::kMaxPointBytes;
+}
+
+#endif // GPS_TRACK_H
@@ -1,82 +1,400 @@
 #include "json_helper.h"
 
 #include <ArduinoJson.h>
+#include <new>
 
-ServerResponse parseServerResponse(const String &payload)
+#ifdef ARDUINO
+#include <esp_heap_caps.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#endif
+
+#ifndef SERVER_RESPONSE_ARENA_BYTES
+#define SERVER_RESPONSE_ARENA_BYTES 16384
+#endif
+
+#ifndef SERVER_RESPONSE_FILTER_ARENA_BYTES
+#define SERVER_RESPONSE_FILTER_ARENA_BYTES 4096
+#endif
+
+namespace
 {
-  ServerResponse parsed;
-  if (payload.length() == 0)
+// 单次解析的 bump 内存池：每次解析前 reset，末尾块可原地扩缩，
+// 其余块 realloc 时复制到新位置，旧空间在下次 reset 时整体回收。
+class ArenaAllocator : public ArduinoJson::Allocator
+{
+public:
+  explicit ArenaAllocator(size_t capacity) : capacity_(capacity) {}
+
+  void attach(uint8_t *buffer)
   {
-    parsed.response = "";
-    return parsed;
+    buffer_ = buffer;
+    reset();
   }
 
-  DynamicJsonDocument doc(4096);
-  DeserializationError error = deserializeJson(doc, payload);
-  if (error)
+  bool attached() const { return buffer_ != nullptr; }
+
+  void reset()
+  {
+    used_ = 0;
+    last_ = nullptr;
+  }
+
+  void *allocate(size_t size) override
+  {
+    if (buffer_ == nullptr)
+    {
+      ++overflows_;
+      return nullptr;
+    }
+    size_t blockSize = align(size) + kHeaderSize;
+    if (blockSize > capacity_ - used_)
+    {
+      ++overflows_;
+      return nullptr;
+    }
+    uint8_t *block = buffer_ + used_;
+    *reinterpret_cast<size_t *>(block) = size;
+    used_ += blockSize;
+    last_ = block + kHeaderSize;
+    noteHighWater();
+    return last_;
+  }
+
+  void deallocate(void *pointer) override
+  {
+    if (pointer != nullptr && pointer == last_)
+    {
+      used_ = static_cast<uint8_t *>(pointer) - buffer_ - kHeaderSize;
+      last_ = nullptr;
+    }
+  }
+
+  void *reallocate(void *pointer, size_t newSize) override
+  {
+    if (pointer == nullptr)
+    {
+      return allocate(newSize);
+    }
+
+    size_t *header = reinterpret_cast<size_t *>(static_cast<uint8_t *>(pointer) - kHeaderSize);
+    size_t oldSize = *header;
+    if (pointer == last_)
+    {
+      size_t start = static_cast<uint8_t *>(pointer) - buffer_;
+      if (align(newSize) > capacity_ - start)
+      {
+        ++overflows_;
+        return nullptr;
+      }
+      *header = newSize;
+      used_ = start + align(newSize);
+      noteHighWater();
+      return pointer;
+    }
+
+    if (newSize <= oldSize)
+    {
+      *header = newSize;
+      return pointer;
+    }
+
+    void *moved = allocate(newSize);
+    if (moved != nullptr)
+    {
+      memcpy(moved, pointer, oldSize);
+    }
+    return moved;
+  }
+
+  size_t highWater() const { return highWater_; }
+  size_t overflows() const { return overflows_; }
+
+private:
+  static constexpr size_t kAlignment = alignof(max_align_t) < 8 ? 8 : alignof(max_align_t);
+  static constexpr size_t kHeaderSize = kAlignment;
+
+  static size_t align(size_t size) { return (size + kAlignment - 1) & ~(kAlignment - 1); }
+
+  void noteHighWater()
   {
-    parsed.response = payload;
-    return parsed;
+    if (used_ > highWater_)
+    {
+      highWater_ = used_;
+    }
   }
 
-  parsed.jsonValid = true;
-  parsed.ok = doc["ok"] | true;
-  parsed.intent = doc["intent"] | "";
-  parsed.response = doc["response"] | "";
-  parsed.error = doc["error"]["message"] | "";
+  uint8_t *buffer_ = nullptr;
+  size_t capacity_;
+  size_t used_ = 0;
+  size_t highWater_ = 0;
+  size_t overflows_ = 0;
+  void *last_ = nullptr;
+};
 
-  if (doc.containsKey("speak"))
+ArenaAllocator responseArena(SERVER_RESPONSE_ARENA_BYTES);
+ArenaAllocator filterArena(SERVER_RESPONSE_FILTER_ARENA_BYTES);
+
+#ifdef ARDUINO
+// 内存池在首次解析时从 PSRAM 一次性取得，之后每轮解析都不再碰堆
+void attachArena(ArenaAllocator &arena, size_t size)
+{
+  if (arena.attached())
   {
-    JsonObject speak = doc["speak"].as<JsonObject>();
-    parsed.speakMode = speak["mode"] | "tts_text";
-    parsed.speakText = speak["text"] | "";
-    parsed.audioId = speak["audio_id"] | "";
-    parsed.audioUrl = speak["audio_url"] | "";
+    return;
   }
+  void *buffer = heap_caps_malloc(size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+  if (buffer == nullptr)
+  {
+    buffer = malloc(size);
+  }
+  arena.attach(static_cast<uint8_t *>(buffer));
+}
 
-  if (doc.containsKey("navigation"))
+bool ensureArenas()
+{
+  attachArena(responseArena, SERVER_RESPONSE_ARENA_BYTES);
+  attachArena(filterArena, SERVER_RESPONSE_FILTER_ARENA_BYTES);
+  return responseArena.attached() && filterArena.attached();
+}
+#else
+alignas(max_align_t) uint8_t responseArenaStorage[SERVER_RESPONSE_ARENA_BYTES];
+alignas(max_align_t) uint8_t filterArenaStorage[SERVER_RESPONSE_FILTER_ARENA_BYTES];
+
+bool ensureArenas()
+{
+  if (!responseArena.attached())
   {
-    JsonObject navigation = doc["navigation"].as<JsonObject>();
-    parsed.navigationActive = navigation["active"] | false;
-    parsed.destination = navigation["destination"] | "";
-    parsed.remainingDistance = navigation["remaining_distance"] | -1;
-    parsed.totalDuration = navigation["total_duration"] | -1;
-    parsed.nextInstruction = navigation["next_instruction"] | "";
+    responseArena.attach(responseArenaStorage);
+    filterArena.attach(filterArenaStorage);
   }
+  return true;
+}
+#endif
+
+#ifdef ARDUINO
+// 语音任务和 loop() 都会解析响应，内存池只有一份
+StaticSemaphore_t parseMutexBuffer;
+SemaphoreHandle_t parseMutex = nullptr;
+portMUX_TYPE parseMutexInitMux = portMUX_INITIALIZER_UNLOCKED;
 
-  parsed.navigationStarted = doc["navigation_started"] | false;
-  parsed.navigationComplete = doc["navigation_complete"] | false;
-  parsed.navigationExited = doc["navigation_exited"] | false;
+class ParseLock
+{
+public:
+  ParseLock()
+  {
+    portENTER_CRITICAL(&parseMutexInitMux);
+    if (parseMutex == nullptr)
+    {
+      parseMutex = xSemaphoreCreateMutexStatic(&parseMutexBuffer);
+    }
+    portEXIT_CRITICAL(&parseMutexInitMux);
+    xSemaphoreTake(parseMutex, portMAX_DELAY);
+  }
+  ~ParseLock() { xSemaphoreGive(parseMutex); }
+};
+#else
+class ParseLock
+{
+};
+#endif
 
-  if (parsed.destination.length() == 0 && doc.containsKey("destination"))
+// 只保留 ServerResponse 用到的字段，weather.daily 等大块内容在解析时直接跳过
+const JsonDocument &responseFilter()
+{
+  static JsonDocument filter(&filterArena);
+  static bool built = false;
+  if (!built)
   {
-    parsed.destination = doc["destination"].as<String>();
+    filter["ok"] = true;
+    filter["intent"] = true;
+    filter["response"] = true;
+    filter["error"] = true;
+    filter["speak"]["mode"] = true;
+    filter["speak"]["text"] = true;
+    filter["speak"]["audio_id"] = true;
+    filter["speak"]["audio_url"] = true;
+    filter["navigation"]["active"] = true;
+    filter["navigation"]["destination"] = true;
+    filter["navigation"]["remaining_distance"] = true;
+    filter["navigation"]["total_duration"] = true;
+    filter["navigation"]["next_instruction"] = true;
+    filter["navigation_started"] = true;
+    filter["navigation_complete"] = true;
+    filter["navigation_exited"] = true;
+    filter["destination"] = true;
+    filter["next_instruction"] = true;
+    filter["route_id"] = true;
+    built = true;
   }
-  if (parsed.nextInstruction.length() == 0 && doc.containsKey("next_instruction"))
+  return filter;
+}
+
+template <size_t Capacity>
+void assignField(FixedString<Capacity> &target, const char *value, ServerResponse *parsed)
+{
+  if (!target.assign(value))
   {
-    parsed.nextInstruction = doc["next_instruction"].as<String>();
+    parsed->truncated = true;
   }
+}
+
+void fillFromDocument(const JsonDocument &doc, ServerResponse *parsed)
+{
+  parsed->ok = doc["ok"] | true;
+  assignField(parsed->intent, doc["intent"] | "", parsed);
+  assignField(parsed->response, doc["response"] | "", parsed);
+  assignField(parsed->error, doc["error"]["message"] | "", parsed);
 
-  if (parsed.response.length() == 0 && doc.containsKey("error") && doc["error"].is<const char *>())
+  JsonObjectConst speak = doc["speak"];
+  if (!speak.isNull())
   {
-    parsed.response = doc["error"].as<String>();
+    assignField(parsed->speakMode, speak["mode"] | "tts_text", parsed);
+    assignField(parsed->speakText, speak["text"] | "", parsed);
+    assignField(parsed->audioId, speak["audio_id"] | "", parsed);
+    assignField(parsed->audioUrl, speak["audio_url"] | "", parsed);
   }
-  return parsed;
+
+  JsonObjectConst navigation = doc["navigation"];
+  if (!navigation.isNull())
+  {
+    parsed->navigationActive = navigation["active"] | false;
+    assignField(parsed->destination, navigation["destination"] | "", parsed);
+    parsed->remainingDistance = navigation["remaining_distance"] | -1L;
+    parsed->totalDuration = navigation["total_duration"] | -1L;
+    assignField(parsed->nextInstruction, navigation["next_instruction"] | "", parsed);
+  }
+
+  parsed->navigationStarted = doc["navigation_started"] | false;
+  parsed->navigationComplete = doc["navigation_complete"] | false;
+  parsed->navigationExited = doc["navigation_exited"] | false;
+  assignField(parsed->routeId, doc["route_id"] | "", parsed);
+
+  if (parsed->destination.isEmpty())
+  {
+    assignField(parsed->destination, doc["destination"] | "", parsed);
+  }
+  if (parsed->nextInstruction.isEmpty())
+  {
+    assignField(parsed->nextInstruction, doc["next_instruction"] | "", parsed);
+  }
+  if (parsed->response.isEmpty() && doc["error"].is<const char *>())
+  {
+    assignField(parsed->response, doc["error"].as<const char *>(), parsed);
+  }
+}
+} // namespace
+
+bool isMsgPackPayload(const char *payload, size_t length)
+{
+  if (payload == nullptr || length == 0)
+  {
+    return false;
+  }
+  // 响应顶层总是 map：fixmap 0x80-0x8f、map16 0xde、map32 0xdf，JSON 则以 '{' 或空白开头
+  uint8_t first = static_cast<uint8_t>(payload[0]);
+  return (first >= 0x80 && first <= 0x8f) || first == 0xde || first == 0xdf;
+}
+
+bool parseServerResponse(const char *payload, size_t length, ServerResponse *parsed)
+{
+  // 原地重置，不在调用方栈上再放一份几 KB 的临时对象
+  new (parsed) ServerResponse();
+  if (payload == nullptr || length == 0)
+  {
+    return false;
+  }
+
+  ParseLock lock;
+  if (!ensureArenas())
+  {
+    return false;
+  }
+  const JsonDocument &filter = responseFilter();
+  responseArena.reset();
+  DeserializationError error;
+  {
+    JsonDocument doc(&responseArena);
+    if (isMsgPackPayload(payload, length))
+    {
+      error = deserializeMsgPack(doc, payload, length, DeserializationOption::Filter(filter));
+    }
+    else
+    {
+      error = deserializeJson(doc, payload, length, DeserializationOption::Filter(filter));
+    }
+
+    if (!error)
+    {
+      parsed->jsonValid = true;
+      fillFromDocument(doc, parsed);
+    }
+  }
+  responseArena.reset();
+
+  if (error)
+  {
+    // 旧服务端可能直接返回纯文本
+    if (!isMsgPackPayload(payload, length) && !parsed->response.assign(payload, length))
+    {
+      parsed->truncated = true;
+    }
+    return false;
+  }
+  return true;
 }
 
-String getSpeakText(const ServerResponse &response)
+const char *getSpeakText(const ServerResponse &response)
 {
-  if (response.speakText.length() > 0)
+  if (!response.speakText.isEmpty())
   {
-    return response.speakText;
+    return response.speakText.c_str();
   }
-  if (response.response.length() > 0)
+  if (!response.response.isEmpty())
   {
-    return response.response;
+    return response.response.c_str();
   }
-  if (response.nextInstruction.length() > 0)
+  if (!response.nextInstruction.isEmpty())
   {
-    return response.nextInstruction;
+    return response.nextInstruction.c_str();
   }
   return "";
 }
+
+size_t serverResponseArenaHighWater()
+{
+  return responseArena.highWater();
+}
+
+size_t serverResponseArenaOverflows()
+{
+  return responseArena.overflows();
+}
+
+#ifdef ARDUINO
+bool isMsgPackPayload(const String &payload)
+{
+  return isMsgPackPayload(payload.c_str(), payload.length());
+}
+
+String describeServerPayload(const String &payload)
+{
+  if (isMsgPackPayload(payload))
+  {
+    return "<msgpack " + String(payload.length()) + " bytes>";
+  }
+  return payload;
+}
+
+ServerResponse parseServerResponse(const String &payload)
+{
+  ServerResponse parsed;
+  parseServerResponse(payload.c_str(), payload.length(), &parsed);
+  if (parsed.truncated)
+  {
+    Serial.println("[ServerResponse] Some fields were truncated to fit fixed buffers.");
+  }
+  return parsed;
+}
+#endif
@@ -1,30 +1,122 @@
 #ifndef JSON_HELPER_H
 #define JSON_HELPER_H
 
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifdef ARDUINO
 #include <Arduino.h>
+#endif
+
+// 定长内联字符串：解析时不触碰堆，超长内容在 UTF-8 字符边界截断。
+template <size_t Capacity>
+class FixedString
+{
+public:
+  static_assert(Capacity > 1 && Capacity <= 0xFFFF, "FixedString capacity out of range");
+
+  FixedString() { clear(); }
+  FixedString(const char *text) { assign(text); }
+
+  void clear()
+  {
+    text_[0] = '\0';
+    length_ = 0;
+  }
+
+  // 返回 false 表示发生了截断
+  bool assign(const char *text)
+  {
+    return assign(text, text == nullptr ? 0 : strlen(text));
+  }
+
+  bool assign(const char *text, size_t length)
+  {
+    if (text == nullptr)
+    {
+      clear();
+      return true;
+    }
+    bool fits = length < Capacity;
+    if (!fits)
+    {
+      length = Capacity - 1;
+      // 回退到 UTF-8 首字节，避免把半个汉字送进 TTS
+      while (length > 0 && (static_cast<uint8_t>(text[length]) & 0xC0) == 0x80)
+      {
+        --length;
+      }
+    }
+    memmove(text_, text, length);
+    text_[length] = '\0';
+    length_ = static_cast<uint16_t>(length);
+    return fits;
+  }
+
+  FixedString &operator=(const char *text)
+  {
+    assign(text);
+    return *this;
+  }
 
+  const char *c_str() const { return text_; }
+  size_t length() const { return length_; }
+  bool isEmpty() const { return length_ == 0; }
+  static constexpr size_t capacity() { return Capacity; }
+
+  bool operator==(const char *other) const { return other != nullptr && strcmp(text_, other) == 0; }
+  bool operator!=(const char *other) const { return !(*this == other); }
+
+private:
+  char text_[Capacity];
+  uint16_t length_;
+};
+
+// 播报文本（response、speak.text）按服务端最长回复定容量：/ai 的模型输出上限是 QWEN_MAX_TOKENS（默认 512），
+// 连同 JSON 外壳约 680 个汉字以内，汉字按 3 字节计。见 web/API.md“统一响应”
+#ifndef SERVER_RESPONSE_TEXT_BYTES
+#define SERVER_RESPONSE_TEXT_BYTES 2048
+#endif
+
+// 其余字段按 TTS 最多 8 段 × 42 字节留余量
 struct ServerResponse
 {
   bool jsonValid = false;
   bool ok = false;
-  String intent = "";
-  String response = "";
-  String error = "";
-  String speakMode = "tts_text";
-  String speakText = "";
-  String audioId = "";
-  String audioUrl = "";
+  bool truncated = false;
+  FixedString<32> intent;
+  FixedString<SERVER_RESPONSE_TEXT_BYTES> response;
+  FixedString<96> error;
+  FixedString<16> speakMode = "tts_text";
+  FixedString<SERVER_RESPONSE_TEXT_BYTES> speakText;
+  FixedString<32> audioId;
+  FixedString<160> audioUrl;
   bool navigationActive = false;
   bool navigationComplete = false;
   bool navigationStarted = false;
   bool navigationExited = false;
-  String destination = "";
-  String nextInstruction = "";
+  FixedString<96> destination;
+  FixedString<192> nextInstruction;
   long remainingDistance = -1;
   long totalDuration = -1;
+  FixedString<24> routeId;
 };
 
+// payload 可以是 JSON 或 MessagePack（SERVER_WIRE_FORMAT_MSGPACK），按首字节自动识别。
+// 解析使用静态过滤文档和固定内存池，不做任何堆分配；非 JSON 内容原样截断写入 response。
+bool isMsgPackPayload(const char *payload, size_t length);
+bool parseServerResponse(const char *payload, size_t length, ServerResponse *parsed);
+const char *getSpeakText(const ServerResponse &response);
+
+// 诊断用：内存池历史最高占用字节数，以及池耗尽导致分配失败的累计次数（应恒为 0）
+size_t serverResponseArenaHighWater();
+size_t serverResponseArenaOverflows();
+
+#ifdef ARDUINO
+bool isMsgPackPayload(const String &payload);
+String describeServerPayload(const String &payload);
 ServerResponse parseServerResponse(const String &payload);
-String getSpeakText(const ServerResponse &response);
+#endif
 
 #endif // JSON_HELPER_H
@@ -0,0 +1,370 @@
+#include "latency_trace.h"
+
+#include <esp_timer.h>
+#include <string.h>
+
+#include <algorithm>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "../services/network_worker.h"
+
+namespace
+{
+struct StageWindow
+{
+  uint32_t samples[LATENCY_TRACE_WINDOW];
+  uint32_t next;
+  uint32_t count;
+};
+
+portMUX_TYPE traceMux = portMUX_INITIALIZER_UNLOCKED;
+TraceSpan spans[LATENCY_TRACE_SPANS];
+uint32_t spanNext = 0;
+uint32_t spanCount = 0;
+StageWindow windows[TraceStageCount] = {};
+
+volatile uint64_t triggerUs = 0;
+uint16_t turnCounter = 0;
+volatile uint16_t activeTurn = 0;
+volatile TaskHandle_t turnTask = nullptr;
+
+const char *const kStageNames[TraceStageCount] = {
+    "turn", "wake", "record_prompt", "recording", "wait_prompt", "prompt_join",
+    "asr", "server", "tts", "tts_fetch", "playback"};
+
+// 轮次结束时打印的中文标签，与 TraceStage 一一对应
+const char *const kStageLabels[TraceStageCount] = {
+    "整轮", "唤醒", "提示音", "录音", "稍等", "等提示音", "识别", "服务端", "合成", "TTS下载", "播放"};
+
+void pushSpan(const TraceSpan &span)
+{
+  portENTER_CRITICAL(&traceMux);
+  spans[spanNext] = span;
+  spanNext = (spanNext + 1) % LATENCY_TRACE_SPANS;
+  if (spanCount < LATENCY_TRACE_SPANS)
+  {
+    ++spanCount;
+  }
+  StageWindow &window = windows[span.stage];
+  window.samples[window.next] = span.durationUs;
+  window.next = (window.next + 1) % LATENCY_TRACE_WINDOW;
+  if (window.count < LATENCY_TRACE_WINDOW)
+  {
+    ++window.count;
+  }
+  portEXIT_CRITICAL(&traceMux);
+}
+
+// 由旧到新第 index 个阶段；index 越界返回 false
+bool spanAt(uint32_t index, TraceSpan *out)
+{
+  portENTER_CRITICAL(&traceMux);
+  bool ok = index < spanCount;
+  if (ok)
+  {
+    *out = spans[(spanNext + LATENCY_TRACE_SPANS - spanCount + index) % LATENCY_TRACE_SPANS];
+  }
+  portEXIT_CRITICAL(&traceMux);
+  return ok;
+}
+
+void writeEvents(Print &out, uint16_t turn)
+{
+  bool first = true;
+  TraceSpan span;
+  for (uint32_t i = 0; spanAt(i, &span); ++i)
+  {
+    if (turn != 0 && span.turn != turn)
+    {
+      continue;
+    }
+    // tid 取泳道：1 为语音任务，阶段按时间自然嵌套；2 为并行的提示音，与识别/服务端上下对齐显示重叠
+    out.printf("%s{\"name\":\"%s\",\"cat\":\"voice\",\"ph\":\"X\",\"ts\":%llu,\"dur\":%u,"
+               "\"pid\":1,\"tid\":%u,\"args\":{\"turn\":%u,\"core\":%u}}",
+               first ? "" : ",", kStageNames[span.stage],
+               static_cast<unsigned long long>(span.startUs), static_cast<unsigned>(span.durationUs),
+               static_cast<unsigned>(span.lane + 1), static_cast<unsigned>(span.turn),
+               static_cast<unsigned>(span.core));
+    first = false;
+  }
+}
+
+class StringPrint : public Print
+{
+public:
+  explicit StringPrint(String &target) : target_(target) {}
+  size_t write(uint8_t c) override
+  {
+    target_ += static_cast<char>(c);
+    return 1;
+  }
+  size_t write(const uint8_t *buffer, size_t size) override
+  {
+    target_.concat(reinterpret_cast<const char *>(buffer), size);
+    return size;
+  }
+
+private:
+  String &target_;
+};
+
+// 并行泳道上的阶段与语音任务上识别、服务端两段的交集之和（这两段互不嵌套）
+uint32_t parallelOverlapUs(uint16_t turn)
+{
+  uint32_t overlapUs = 0;
+  TraceSpan parallel;
+  for (uint32_t i = 0; spanAt(i, &parallel); ++i)
+  {
+    if (parallel.turn != turn || parallel.lane == 0)
+    {
+      continue;
+    }
+    uint64_t parallelEnd = parallel.startUs + parallel.durationUs;
+    TraceSpan span;
+    for (uint32_t j = 0; spanAt(j, &span); ++j)
+    {
+      if (span.turn != turn || span.lane != 0 || (span.stage != TraceAsr && span.stage != TraceServer))
+      {
+        continue;
+      }
+      uint64_t start = std::max(parallel.startUs, span.startUs);
+      uint64_t end = std::min(parallelEnd, span.startUs + span.durationUs);
+      if (end > start)
+      {
+        overlapUs += static_cast<uint32_t>(end - start);
+      }
+    }
+  }
+  return overlapUs;
+}
+
+void printTurnSummary(uint16_t turn)
+{
+  uint32_t totals[TraceStageCount] = {};
+  uint32_t counts[TraceStageCount] = {};
+  TraceSpan span;
+  for (uint32_t i = 0; spanAt(i, &span); ++i)
+  {
+    if (span.turn == turn)
+    {
+      totals[span.stage] += span.durationUs;
+      ++counts[span.stage];
+    }
+  }
+  uint32_t overlapUs = parallelOverlapUs(turn);
+
+  // 同一阶段出现多次（分段 TTS）时按总和显示
+  String line = "[延迟追踪] 第 " + String(turn) + " 轮:";
+  for (size_t stage = 0; stage < TraceStageCount; ++stage)
+  {
+    if (counts[stage] == 0)
+    {
+      continue;
+    }
+    line += " " + String(kStageLabels[stage]) + " " + String(totals[stage] / 1000) + "ms";
+    if (counts[stage] > 1)
+    {
+      line += "x" + String(counts[stage]);
+    }
+  }
+  Serial.println(line);
+  if (counts[TraceWaitPrompt] != 0)
+  {
+    // 提示音与识别/服务端重叠的部分不再计入整轮；等提示音是回复就绪后仍为它付出的时间
+    Serial.printf("[延迟追踪] 第 %u 轮: 稍等提示音与识别/服务端重叠 %lu ms，等提示音 %lu ms\n",
+                  static_cast<unsigned>(turn), static_cast<unsigned long>(overlapUs / 1000),
+                  static_cast<unsigned long>(totals[TracePromptJoin] / 1000));
+  }
+
+  for (size_t stage = 0; stage < TraceStageCount; ++stage)
+  {
+    TraceStageStats stats = traceStageStats(static_cast<TraceStage>(stage));
+    if (stats.count == 0)
+    {
+      continue;
+    }
+    Serial.printf("[延迟追踪] %-13s p50: %lu ms, p95: %lu ms, 最大: %lu ms (n=%u)\n", kStageNames[stage],
+                  static_cast<unsigned long>(stats.p50Us / 1000), static_cast<unsigned long>(stats.p95Us / 1000),
+                  static_cast<unsigned long>(stats.maxUs / 1000), static_cast<unsigned>(stats.count));
+  }
+}
+
+#if LATENCY_TRACE_UPLOAD
+void onTraceUploaded(const NetworkJobResult &result, void *context)
+{
+  if (!result.ok)
+  {
+    Serial.printf("[延迟追踪] 第 %u 轮上报失败, http=%d\n", static_cast<unsigned>((uintptr_t)context),
+                  result.httpStatus);
+  }
+}
+#endif
+} // namespace
+
+const char *traceStageName(TraceStage stage)
+{
+  return stage < TraceStageCount ? kStageNames[stage] : "unknown";
+}
+
+uint64_t traceNowUs()
+{
+  return static_cast<uint64_t>(esp_timer_get_time());
+}
+
+void traceMarkTrigger()
+{
+  triggerUs = traceNowUs();
+}
+
+uint16_t traceBeginTurn()
+{
+  // 0 保留给“无进行中的轮次”
+  if (++turnCounter == 0)
+  {
+    turnCounter = 1;
+  }
+  turnTask = xTaskGetCurrentTaskHandle();
+  activeTurn = turnCounter;
+
+  uint64_t trigger = triggerUs;
+  triggerUs = 0;
+  if (trigger != 0)
+  {
+    traceRecord(TraceWake, trigger);
+  }
+  return turnCounter;
+}
+
+void traceEndTurn()
+{
+  uint16_t turn = activeTurn;
+  activeTurn = 0;
+  turnTask = nullptr;
+  if (turn == 0)
+  {
+    return;
+  }
+
+  printTurnSummary(turn);
+#if LATENCY_TRACE_UPLOAD
+  networkSubmitLatencyTrace(turn, onTraceUploaded, (void *)(uintptr_t)turn);
+#endif
+}
+
+uint16_t traceCurrentTurn()
+{
+  return activeTurn;
+}
+
+void traceRecord(TraceStage stage, uint64_t startUs)
+{
+#if LATENCY_TRACE_ENABLED
+  uint16_t turn = activeTurn;
+  if (turn == 0 || stage >= TraceStageCount || xTaskGetCurrentTaskHandle() != turnTask)
+  {
+    return;
+  }
+
+  TraceSpan span;
+  span.startUs = startUs;
+  span.durationUs = static_cast<uint32_t>(traceNowUs() - startUs);
+  span.turn = turn;
+  span.stage = stage;
+  span.core = static_cast<uint8_t>(xPortGetCoreID());
+  span.lane = 0;
+  pushSpan(span);
+#else
+  (void)stage;
+  (void)startUs;
+#endif
+}
+
+void traceRecordForTurn(TraceStage stage, uint64_t startUs, uint16_t turn)
+{
+#if LATENCY_TRACE_ENABLED
+  if (turn == 0 || turn != activeTurn || stage >= TraceStageCount)
+  {
+    return;
+  }
+
+  TraceSpan span;
+  span.startUs = startUs;
+  span.durationUs = static_cast<uint32_t>(traceNowUs() - startUs);
+  span.turn = turn;
+  span.stage = stage;
+  span.core = static_cast<uint8_t>(xPortGetCoreID());
+  span.lane = xTaskGetCurrentTaskHandle() == turnTask ? 0 : 1;
+  pushSpan(span);
+#else
+  (void)stage;
+  (void)startUs;
+  (void)turn;
+#endif
+}
+
+TraceStageStats traceStageStats(TraceStage stage)
+{
+  TraceStageStats stats = {};
+  if (stage >= TraceStageCount)
+  {
+    return stats;
+  }
+
+  uint32_t samples[LATENCY_TRACE_WINDOW];
+  portENTER_CRITICAL(&traceMux);
+  stats.count = windows[stage].count;
+  memcpy(samples, windows[stage].samples, sizeof(uint32_t) * stats.count);
+  portEXIT_CRITICAL(&traceMux);
+  if (stats.count == 0)
+  {
+    return stats;
+  }
+
+  // 最近邻秩：第 ceil(p * n) 小的样本
+  uint32_t *end = samples + stats.count;
+  size_t p50 = (stats.count + 1) / 2 - 1;
+  size_t p95 = (stats.count * 95 + 99) / 100 - 1;
+  std::nth_element(samples, samples + p50, end);
+  stats.p50Us = samples[p50];
+  std::nth_element(samples, samples + p95, end);
+  stats.p95Us = samples[p95];
+  stats.maxUs = *std::max_element(samples, end);
+  return stats;
+}
+
+void traceWriteChromeJson(Print &out, uint16_t turn)
+{
+  out.print("{\"traceEvents\":[");
+  writeEvents(out, turn);
+  out.print("],\"displayTimeUnit\":\"ms\"}");
+}
+
+String traceTurnJson(uint16_t turn)
+{
+  String json;
+  json.reserve(1024);
+  StringPrint out(json);
+  out.printf("{\"turn\":%u,\"traceEvents\":[", static_cast<unsigned>(turn));
+  writeEvents(out, turn);
+  out.print("]}");
+  return json;
+}
+
+void tracePollSerial()
+{
+#if LATENCY_TRACE_ENABLED
+  while (Serial.available() > 0)
+  {
+    int command = Serial.read();
+    if (command == 't' || command == 'T')
+    {
+      // 起止标记便于从串口日志里截出 JSON
+      Serial.println("\n[延迟追踪] ---- trace begin ----");
+      traceWriteChromeJson(Serial);
+      Serial.println("\n[延迟追踪] ---- trace end ----");
+    }
+  }
+#endif
+}
@@ -0,0 +1,99 @@
+#ifndef LATENCY_TRACE_H
+#define LATENCY_TRACE_H
+
+#include <Arduino.h>
+
+#include "../config.h"
+
+// 语音链路延迟追踪：一轮对话（唤醒/按键 → 播报结束）分配一个轮次号，
+// 各阶段的起止时间（esp_timer 微秒）写入固定大小的环，轮次结束时打印分阶段耗时和 p50/p95。
+//
+//   TRACE_SPAN(TraceAsr);   // 作用域结束时记录一段
+//
+// 只记录发起本轮的语音任务上的阶段，导航播报、预取等在其他任务上的 TTS 不会混进来；
+// 与语音任务并行、明确归入本轮的阶段（“请稍等”提示音）用 traceRecordForTurn 记录，单独一条泳道。
+// 导出为 Chrome trace-event JSON（chrome://tracing 或 ui.perfetto.dev 打开）：
+// 串口输入 't' 输出环内全部阶段；LATENCY_TRACE_UPLOAD 打开时每轮结束后经网络任务上报到服务端。
+enum TraceStage : uint8_t
+{
+  TraceTurn = 0,      // handleVoiceInteraction 整轮
+  TraceWake,          // 唤醒/按键触发到语音任务接手
+  TraceRecordPrompt,  // “我在”提示音
+  TraceRecording,
+  TraceWaitPrompt,    // “请稍等”提示音（播放任务上，与识别/服务端并行）
+  TracePromptJoin,    // 语音任务要用扬声器时等提示音结束（含中止）
+  TraceAsr,
+  TraceServer,        // POST /ai
+  TraceTts,           // baiduTTS_Send 整段文本
+  TraceTtsFetch,      // 单段 TTS 请求到音频下载完成
+  TracePlayback,      // 单段 TTS 音频播放（含缓存命中）
+  TraceStageCount
+};
+
+struct TraceSpan
+{
+  uint64_t startUs;
+  uint32_t durationUs;
+  uint16_t turn;
+  uint8_t stage;
+  uint8_t core;
+  uint8_t lane;      // 0：语音任务；1：与之并行的任务
+};
+
+struct TraceStageStats
+{
+  uint32_t count;    // 窗口内样本数（最近 LATENCY_TRACE_WINDOW 次）
+  uint32_t p50Us;
+  uint32_t p95Us;
+  uint32_t maxUs;
+};
+
+const char *traceStageName(TraceStage stage);
+uint64_t traceNowUs();
+
+// 唤醒词/按键触发时调用，记下触发时刻；语音任务接手时由 traceBeginTurn 记为 TraceWake
+void traceMarkTrigger();
+// 语音任务开始一轮对话，返回新的轮次号；此后当前任务上的阶段归入该轮
+uint16_t traceBeginTurn();
+// 本轮结束：打印分阶段耗时和各阶段 p50/p95，按配置上报
+void traceEndTurn();
+uint16_t traceCurrentTurn();
+
+// 记录一段 [startUs, 现在)；不在进行中的轮次或不是发起本轮的任务时忽略
+void traceRecord(TraceStage stage, uint64_t startUs);
+// 其他任务上归入指定轮次的一段；该轮已结束时忽略
+void traceRecordForTurn(TraceStage stage, uint64_t startUs, uint16_t turn);
+TraceStageStats traceStageStats(TraceStage stage);
+
+// Chrome trace-event JSON：turn 为 0 时输出环内全部阶段
+void traceWriteChromeJson(Print &out, uint16_t turn = 0);
+// 上报用：{"turn":N,"traceEvents":[...]}
+String traceTurnJson(uint16_t turn);
+// 主循环调用：处理串口输入的导出命令
+void tracePollSerial();
+
+class TraceScope
+{
+public:
+  explicit TraceScope(TraceStage stage) : stage_(stage), startUs_(traceNowUs()) {}
+  ~TraceScope() { traceRecord(stage_, startUs_); }
+  TraceScope(const TraceScope &) = delete;
+  TraceScope &operator=(const TraceScope &) = delete;
+
+private:
+  TraceStage stage_;
+  uint64_t startUs_;
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#if LATENCY_TRACE_ENABLED
+#define TRACE_SPAN(stage) TraceScope TRACE_CONCAT(traceScope_, __LINE__)(stage)
+#else
+#define TRACE_SPAN(stage) \
+  do                      \
+  {                       \
+  } while (0)
+#endif
+
+#endif // LATENCY_TRACE_H
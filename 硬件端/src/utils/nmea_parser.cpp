@@ -0,0 +1,523 @@
+#include "nmea_parser.h"
+
+#include <math.h>
+#include <string.h>
+
+namespace
+{
+const float kKnotsToKmh = 1.852f;
+
+int hexValue(char c)
+{
+  if (c >= '0' && c <= '9')
+  {
+    return c - '0';
+  }
+  if (c >= 'A' && c <= 'F')
+  {
+    return c - 'A' + 10;
+  }
+  if (c >= 'a' && c <= 'f')
+  {
+    return c - 'a' + 10;
+  }
+  return -1;
+}
+
+// 十进制小数（可带符号），不经过 strtod/locale；空串或含其他字符返回 false
+bool parseDecimal(const char *text, double *out)
+{
+  const char *p = text;
+  bool negative = false;
+  if (*p == '-' || *p == '+')
+  {
+    negative = *p == '-';
+    ++p;
+  }
+  uint64_t mantissa = 0;
+  int fractionDigits = 0;
+  bool seenDigit = false;
+  bool seenPoint = false;
+  for (; *p != '\0'; ++p)
+  {
+    if (*p >= '0' && *p <= '9')
+    {
+      // 超过 18 位有效数字的部分不再累加（NMEA 字段远小于此）
+      if (mantissa < 100000000000000000ULL)
+      {
+        mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0');
+        if (seenPoint)
+        {
+          ++fractionDigits;
+        }
+      }
+      seenDigit = true;
+    }
+    else if (*p == '.' && !seenPoint)
+    {
+      seenPoint = true;
+    }
+    else
+    {
+      return false;
+    }
+  }
+  if (!seenDigit)
+  {
+    return false;
+  }
+  static const double kPow10[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9,
+                                  1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18};
+  double value = static_cast<double>(mantissa) / kPow10[fractionDigits];
+  *out = negative ? -value : value;
+  return true;
+}
+
+// 可选的浮点字段：空字段为 NAN（未知），格式错误返回 false
+bool parseOptionalFloat(const char *text, float *out)
+{
+  if (text[0] == '\0')
+  {
+    *out = NAN;
+    return true;
+  }
+  double value = 0.0;
+  if (!parseDecimal(text, &value))
+  {
+    return false;
+  }
+  *out = static_cast<float>(value);
+  return true;
+}
+
+bool parseOptionalUint(const char *text, uint8_t *out)
+{
+  uint32_t value = 0;
+  for (const char *p = text; *p != '\0'; ++p)
+  {
+    if (*p < '0' || *p > '9')
+    {
+      return false;
+    }
+    value = value * 10 + static_cast<uint32_t>(*p - '0');
+    if (value > 255)
+    {
+      return false;
+    }
+  }
+  *out = static_cast<uint8_t>(value);
+  return true;
+}
+
+// ddmm.mmmm / dddmm.mmmm 转十进制度
+bool parseCoordinate(const char *text, char hemisphere, char negativeHemisphere, double maxDegrees,
+                     double *out)
+{
+  double raw = 0.0;
+  if (!parseDecimal(text, &raw) || raw < 0.0)
+  {
+    return false;
+  }
+  double degrees = floor(raw / 100.0);
+  double minutes = raw - degrees * 100.0;
+  if (minutes >= 60.0 || degrees > maxDegrees)
+  {
+    return false;
+  }
+  double value = degrees + minutes / 60.0;
+  if (hemisphere == negativeHemisphere)
+  {
+    value = -value;
+  }
+  *out = value;
+  return true;
+}
+
+void copyField(char *dest, size_t capacity, const char *text)
+{
+  if (text[0] == '\0')
+  {
+    return;
+  }
+  size_t length = strlen(text);
+  if (length >= capacity)
+  {
+    length = capacity - 1;
+  }
+  memcpy(dest, text, length);
+  dest[length] = '\0';
+}
+int twoDigits(const char *text)
+{
+  if (text[0] < '0' || text[0] > '9' || text[1] < '0' || text[1] > '9')
+  {
+    return -1;
+  }
+  return (text[0] - '0') * 10 + (text[1] - '0');
+}
+
+// 公历日期到 1970-01-01 的天数（Howard Hinnant 的 days_from_civil）
+int64_t daysFromCivil(int year, int month, int day)
+{
+  year -= month <= 2 ? 1 : 0;
+  int era = (year >= 0 ? year : year - 399) / 400;
+  int yearOfEra = year - era * 400;
+  int dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+  int dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+  return static_cast<int64_t>(era) * 146097 + dayOfEra - 719468;
+}
+} // namespace
+
+int64_t nmeaUtcToEpochMs(const char *utcDate, const char *utcTime)
+{
+  if (strlen(utcDate) != 6 || strlen(utcTime) < 6)
+  {
+    return -1;
+  }
+  int day = twoDigits(utcDate);
+  int month = twoDigits(utcDate + 2);
+  int year = twoDigits(utcDate + 4);
+  int hour = twoDigits(utcTime);
+  int minute = twoDigits(utcTime + 2);
+  int second = twoDigits(utcTime + 4);
+  if (day < 1 || day > 31 || month < 1 || month > 12 || year < 0 || hour < 0 || hour > 23 || minute < 0 ||
+      minute > 59 || second < 0 || second > 60)
+  {
+    return -1;
+  }
+  int millis = 0;
+  if (utcTime[6] == '.')
+  {
+    int scale = 100;
+    for (const char *p = utcTime + 7; *p >= '0' && *p <= '9' && scale > 0; ++p, scale /= 10)
+    {
+      millis += (*p - '0') * scale;
+    }
+  }
+  int64_t days = daysFromCivil(2000 + year, month, day);
+  return ((days * 24 + hour) * 60 + minute) * 60000LL + second * 1000LL + millis;
+}
+
+NmeaParser::NmeaParser()
+{
+  reset();
+}
+
+void NmeaParser::reset()
+{
+  length_ = 0;
+  discarding_ = false;
+  memset(&fix_, 0, sizeof(fix_));
+  fix_.altitudeM = NAN;
+  fix_.hdop = NAN;
+  fix_.pdop = NAN;
+  fix_.vdop = NAN;
+  fix_.speedKmh = NAN;
+  fix_.courseDeg = NAN;
+  memset(&stats_, 0, sizeof(stats_));
+}
+
+char *NmeaParser::writeBuffer(size_t *room)
+{
+  *room = kLineCapacity - length_;
+  return line_ + length_;
+}
+
+uint8_t NmeaParser::finishLine(size_t start, size_t end)
+{
+  if (discarding_)
+  {
+    discarding_ = false;
+    return None;
+  }
+  while (end > start && (line_[end - 1] == '\r' || line_[end - 1] == ' '))
+  {
+    --end;
+  }
+  if (end == start || line_[start] != '$')
+  {
+    return None;
+  }
+  return parseSentence(line_ + start, end - start);
+}
+
+uint8_t NmeaParser::commit(size_t length)
+{
+  if (length > kLineCapacity - length_)
+  {
+    length = kLineCapacity - length_;
+  }
+  stats_.bytes += static_cast<uint32_t>(length);
+  size_t end = length_ + length;
+  size_t start = 0;
+  size_t scan = length_;
+  uint8_t decoded = 0;
+
+  while (true)
+  {
+    const char *newline = static_cast<const char *>(memchr(line_ + scan, '\n', end - scan));
+    size_t stop = newline ? static_cast<size_t>(newline - line_) : end;
+    // 行中间出现 '$' 说明上一句被截断（丢了行尾），从这里开始新的一句
+    while (start + 1 < stop)
+    {
+      const char *dollar = static_cast<const char *>(memchr(line_ + start + 1, '$', stop - start - 1));
+      if (dollar == nullptr)
+      {
+        break;
+      }
+      size_t at = static_cast<size_t>(dollar - line_);
+      decoded |= finishLine(start, at);
+      start = at;
+    }
+    if (newline == nullptr)
+    {
+      break;
+    }
+    decoded |= finishLine(start, stop);
+    start = stop + 1;
+    scan = start;
+  }
+
+  // 剩下的半句移到缓冲区开头，等下一次 commit 补齐
+  size_t remaining = end - start;
+  if (remaining == kLineCapacity)
+  {
+    if (!discarding_)
+    {
+      ++stats_.overflows;
+      discarding_ = true;
+    }
+    remaining = 0;
+  }
+  else if (start > 0 && remaining > 0)
+  {
+    memmove(line_, line_ + start, remaining);
+  }
+  length_ = remaining;
+  return decoded;
+}
+
+uint8_t NmeaParser::feed(const char *data, size_t length)
+{
+  uint8_t decoded = 0;
+  while (length > 0)
+  {
+    size_t room = 0;
+    char *dest = writeBuffer(&room);
+    size_t chunk = length < room ? length : room;
+    memcpy(dest, data, chunk);
+    decoded |= commit(chunk);
+    data += chunk;
+    length -= chunk;
+  }
+  return decoded;
+}
+
+NmeaParser::Sentence NmeaParser::parseSentence(char *line, size_t length)
+{
+  if (length < 7 || line[0] != '$')
+  {
+    ++stats_.checksumErrors;
+    return None;
+  }
+
+  // 一遍完成校验和累加与原地切分：逗号改成 '\0'，空字段得到空串，字段下标与协议一致
+  char *fields[kMaxFields];
+  size_t count = 0;
+  fields[count++] = line + 1;
+  uint8_t sum = 0;
+  size_t star = 1;
+  for (; star < length && line[star] != '*'; ++star)
+  {
+    char c = line[star];
+    sum ^= static_cast<uint8_t>(c);
+    if (c == ',')
+    {
+      line[star] = '\0';
+      if (count < kMaxFields)
+      {
+        fields[count++] = line + star + 1;
+      }
+    }
+  }
+  // 没有校验和的语句也丢弃：接收机都会带，缺失说明数据不完整
+  if (star + 3 != length)
+  {
+    ++stats_.checksumErrors;
+    return None;
+  }
+  int high = hexValue(line[star + 1]);
+  int low = hexValue(line[star + 2]);
+  if (high < 0 || low < 0 || static_cast<uint8_t>(high * 16 + low) != sum)
+  {
+    ++stats_.checksumErrors;
+    return None;
+  }
+  line[star] = '\0';
+
+  const char *address = fields[0];
+  // 两字母 talker + 三字母类型；专有语句（$P...）不处理
+  if (strlen(address) != 5 || address[0] == 'P')
+  {
+    ++stats_.ignored;
+    return None;
+  }
+  const char *type = address + 2;
+  Sentence sentence = None;
+  bool ok = false;
+  if (memcmp(type, "RMC", 3) == 0)
+  {
+    sentence = Rmc;
+    ok = decodeRmc(fields, count);
+  }
+  else if (memcmp(type, "GGA", 3) == 0)
+  {
+    sentence = Gga;
+    ok = decodeGga(fields, count);
+  }
+  else if (memcmp(type, "VTG", 3) == 0)
+  {
+    sentence = Vtg;
+    ok = decodeVtg(fields, count);
+  }
+  else if (memcmp(type, "GSA", 3) == 0)
+  {
+    sentence = Gsa;
+    ok = decodeGsa(fields, count);
+  }
+  else
+  {
+    ++stats_.ignored;
+    return None;
+  }
+  if (!ok)
+  {
+    ++stats_.malformed;
+    return None;
+  }
+  ++stats_.sentences;
+  return sentence;
+}
+
+bool NmeaParser::decodePosition(const char *lat, const char *ns, const char *lon, const char *ew)
+{
+  double latitude = 0.0;
+  double longitude = 0.0;
+  if ((ns[0] != 'N' && ns[0] != 'S') || (ew[0] != 'E' && ew[0] != 'W') ||
+      !parseCoordinate(lat, ns[0], 'S', 90.0, &latitude) || !parseCoordinate(lon, ew[0], 'W', 180.0, &longitude))
+  {
+    return false;
+  }
+  fix_.latitude = latitude;
+  fix_.longitude = longitude;
+  return true;
+}
+
+// 各解码函数先把数值字段解到局部变量，全部成功才写入 fix_，格式错误的语句不会留下半截状态
+
+// $xxRMC,time,status,lat,N/S,lon,E/W,knots,course,date,magvar,E/W[,mode[,navStatus]]
+bool NmeaParser::decodeRmc(char **fields, size_t count)
+{
+  if (count < 10)
+  {
+    return false;
+  }
+  float knots = NAN;
+  float course = NAN;
+  if (!parseOptionalFloat(fields[7], &knots) || !parseOptionalFloat(fields[8], &course))
+  {
+    return false;
+  }
+  // NMEA 2.3 起带模式字段，N 表示数据无效，即使状态是 A
+  bool valid = fields[2][0] == 'A' && !(count > 12 && fields[12][0] == 'N');
+  if (valid && !decodePosition(fields[3], fields[4], fields[5], fields[6]))
+  {
+    return false;
+  }
+  fix_.positionValid = valid;
+  fix_.speedKmh = isnan(knots) ? NAN : knots * kKnotsToKmh;
+  fix_.courseDeg = course;
+  copyField(fix_.utcTime, sizeof(fix_.utcTime), fields[1]);
+  copyField(fix_.utcDate, sizeof(fix_.utcDate), fields[9]);
+  return true;
+}
+
+// $xxGGA,time,lat,N/S,lon,E/W,quality,numSV,hdop,alt,M,sep,M,diffAge,diffStation
+bool NmeaParser::decodeGga(char **fields, size_t count)
+{
+  if (count < 10)
+  {
+    return false;
+  }
+  uint8_t quality = 0;
+  uint8_t satellites = 0;
+  float hdop = NAN;
+  float altitude = NAN;
+  if (!parseOptionalUint(fields[6], &quality) || !parseOptionalUint(fields[7], &satellites) ||
+      !parseOptionalFloat(fields[8], &hdop) || !parseOptionalFloat(fields[9], &altitude))
+  {
+    return false;
+  }
+  bool valid = quality > 0;
+  if (valid && !decodePosition(fields[2], fields[3], fields[4], fields[5]))
+  {
+    return false;
+  }
+  fix_.positionValid = valid;
+  fix_.quality = quality;
+  fix_.satellites = satellites;
+  fix_.hdop = hdop;
+  fix_.altitudeM = valid ? altitude : NAN;
+  copyField(fix_.utcTime, sizeof(fix_.utcTime), fields[1]);
+  return true;
+}
+
+// $xxVTG,courseTrue,T,courseMag,M,knots,N,kmh,K[,mode]
+bool NmeaParser::decodeVtg(char **fields, size_t count)
+{
+  if (count < 8)
+  {
+    return false;
+  }
+  float course = NAN;
+  float knots = NAN;
+  float kmh = NAN;
+  if (!parseOptionalFloat(fields[1], &course) || !parseOptionalFloat(fields[5], &knots) ||
+      !parseOptionalFloat(fields[7], &kmh))
+  {
+    return false;
+  }
+  if (isnan(kmh) && !isnan(knots))
+  {
+    kmh = knots * kKnotsToKmh;
+  }
+  fix_.courseDeg = course;
+  fix_.speedKmh = kmh;
+  return true;
+}
+
+// $xxGSA,mode,fixType,sv1..sv12,pdop,hdop,vdop[,systemId]
+bool NmeaParser::decodeGsa(char **fields, size_t count)
+{
+  if (count < 18)
+  {
+    return false;
+  }
+  uint8_t fixMode = 0;
+  float pdop = NAN;
+  float hdop = NAN;
+  float vdop = NAN;
+  if (!parseOptionalUint(fields[2], &fixMode) || !parseOptionalFloat(fields[15], &pdop) ||
+      !parseOptionalFloat(fields[16], &hdop) || !parseOptionalFloat(fields[17], &vdop))
+  {
+    return false;
+  }
+  fix_.fixMode = fixMode;
+  fix_.pdop = pdop;
+  fix_.vdop = vdop;
+  if (!isnan(hdop))
+  {
+    fix_.hdop = hdop;
+  }
+  return true;
+}
@@ -0,0 +1,90 @@
+#ifndef NMEA_PARSER_H
+#define NMEA_PARSER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// NMEA 0183 解码：RMC、GGA、VTG、GSA（任意两字母 talker，GP/GN/BD/GL/GA）。
+// 串口数据直接读进解析器自己的行缓冲区（writeBuffer/commit），完整语句在原地切分字段，
+// 不复制、不分配；空字段保留位置（",,"），字段下标不会错位。校验和 *hh 不符或缺失的语句丢弃。
+// 纯逻辑，不依赖 Arduino；主机端语料测试和吞吐基准见 tools/nmea_check.cpp。
+struct NmeaFix
+{
+  // 位置：RMC 状态 A 或 GGA 定位质量 > 0 时更新；RMC 为 V 或 GGA 质量为 0 时 positionValid 置假
+  double latitude;
+  double longitude;
+  bool positionValid;
+  float altitudeM;  // GGA 海拔，未知为 NAN
+  uint8_t quality;  // GGA 定位质量：0 无效 1 单点 2 差分 4/5 RTK 6 推算
+  uint8_t satellites; // GGA 参与解算的卫星数
+  uint8_t fixMode;  // GSA：1 无定位 2 二维 3 三维，0 未收到
+  float hdop;       // GGA/GSA，未知为 NAN
+  float pdop;       // GSA
+  float vdop;       // GSA
+  float speedKmh;   // VTG km/h，没有时由 RMC 节换算；未知为 NAN
+  float courseDeg;  // 真北航向，静止时接收机常给空字段，未知为 NAN
+  char utcTime[11]; // hhmmss.sss，原样保留
+  char utcDate[7];  // ddmmyy（RMC）
+};
+
+struct NmeaStats
+{
+  uint32_t sentences;      // 校验通过并解码的语句
+  uint32_t checksumErrors; // 校验和不符或缺失
+  uint32_t malformed;      // 字段不足、数值格式错误
+  uint32_t ignored;        // 校验通过但不是上述四种（GSV、TXT 等）
+  uint32_t overflows;      // 超长行丢弃
+  uint32_t bytes;
+};
+
+// RMC 的 ddmmyy + hhmmss.sss 转 Unix 纪元毫秒（两位年份按 2000 年后），任一字段缺失或格式不对返回 -1
+int64_t nmeaUtcToEpochMs(const char *utcDate, const char *utcTime);
+
+class NmeaParser
+{
+public:
+  // NMEA 规定一句最长 82 字节；留余量给多模接收机偶尔的长 GSA
+  static const size_t kLineCapacity = 128;
+  static const size_t kMaxFields = 24;
+
+  enum Sentence : uint8_t
+  {
+    None = 0,
+    Rmc = 1 << 0,
+    Gga = 1 << 1,
+    Vtg = 1 << 2,
+    Gsa = 1 << 3,
+  };
+
+  NmeaParser();
+  void reset();
+
+  // 零拷贝输入：串口直接读进返回的缓冲区（最多 *room 字节），再 commit 实际读到的字节数。
+  // commit 处理其中所有完整语句，返回本次解码的语句类型（Sentence 的按位或）
+  char *writeBuffer(size_t *room);
+  uint8_t commit(size_t length);
+  // 便于测试：把任意分块的数据拷进缓冲区再 commit
+  uint8_t feed(const char *data, size_t length);
+
+  // 解码一条完整语句（不含行尾），原地修改；校验失败返回 None
+  Sentence parseSentence(char *line, size_t length);
+
+  const NmeaFix &fix() const { return fix_; }
+  const NmeaStats &stats() const { return stats_; }
+
+private:
+  uint8_t finishLine(size_t start, size_t end);
+  bool decodeRmc(char **fields, size_t count);
+  bool decodeGga(char **fields, size_t count);
+  bool decodeVtg(char **fields, size_t count);
+  bool decodeGsa(char **fields, size_t count);
+  bool decodePosition(const char *lat, const char *ns, const char *lon, const char *ew);
+
+  char line_[kLineCapacity];
+  size_t length_;
+  bool discarding_; // 超长行：丢到下一个行尾
+  NmeaFix fix_;
+  NmeaStats stats_;
+};
+
+#endif // NMEA_PARSER_H
@@ -0,0 +1,188 @@
+#include "position_filter.h"
+
+#include <math.h>
+
+namespace
+{
+constexpr double kMetersPerDegreeLat = 110574.0;
+constexpr double kMetersPerDegreeLng = 111320.0;
+constexpr double kDegreesToRadians = 3.14159265358979323846 / 180.0;
+constexpr float kRadiansToDegrees = 180.0f / 3.14159265f;
+constexpr float kInitialSpeedSigmaMps = 2.0f; // 没有速度观测时的初始速度不确定度（步行上限附近）
+constexpr float kRecenterMeters = 2000.0f;    // 离原点超过该距离时平移原点，float 坐标保持厘米级精度
+constexpr float kMinHdop = 0.5f;
+} // namespace
+
+void PositionFilter::reset()
+{
+  initialized_ = false;
+  originLat_ = 0.0;
+  originLng_ = 0.0;
+  metersPerLat_ = kMetersPerDegreeLat;
+  metersPerLng_ = kMetersPerDegreeLng;
+  lastMs_ = 0;
+  east_ = north_ = eastV_ = northV_ = 0.0f;
+  p00_ = p01_ = p11_ = 0.0f;
+  rejectRun_ = 0;
+  accepted_ = 0;
+  rejected_ = 0;
+  resets_ = 0;
+}
+
+void PositionFilter::setOrigin(double latitude, double longitude)
+{
+  originLat_ = latitude;
+  originLng_ = longitude;
+  metersPerLat_ = kMetersPerDegreeLat;
+  metersPerLng_ = kMetersPerDegreeLng * cos(latitude * kDegreesToRadians);
+}
+
+void PositionFilter::project(double latitude, double longitude, float *east, float *north) const
+{
+  *east = static_cast<float>((longitude - originLng_) * metersPerLng_);
+  *north = static_cast<float>((latitude - originLat_) * metersPerLat_);
+}
+
+void PositionFilter::start(uint32_t nowMs, float east, float north, float sigma)
+{
+  initialized_ = true;
+  lastMs_ = nowMs;
+  east_ = east;
+  north_ = north;
+  eastV_ = northV_ = 0.0f;
+  p00_ = sigma * sigma;
+  p01_ = 0.0f;
+  p11_ = kInitialSpeedSigmaMps * kInitialSpeedSigmaMps;
+  rejectRun_ = 0;
+}
+
+// 匀速模型：x += v·dt；白噪声加速度的离散化过程噪声 q·[dt³/3 dt²/2; dt²/2 dt]
+void PositionFilter::predict(float dt)
+{
+  if (dt <= 0.0f)
+  {
+    return;
+  }
+  float q = config_.accelNoise;
+  east_ += eastV_ * dt;
+  north_ += northV_ * dt;
+  p00_ += 2.0f * dt * p01_ + dt * dt * p11_ + q * dt * dt * dt / 3.0f;
+  p01_ += dt * p11_ + q * dt * dt / 2.0f;
+  p11_ += q * dt;
+}
+
+bool PositionFilter::update(uint32_t nowMs, double latitude, double longitude, float hdop, float speedKmh,
+                            float courseDeg)
+{
+  float effectiveHdop = isnan(hdop) ? config_.defaultHdop : (hdop < kMinHdop ? kMinHdop : hdop);
+  float sigma = config_.uereMeters * effectiveHdop;
+  float r = sigma * sigma;
+
+  if (!initialized_ || nowMs - lastMs_ > config_.resetAfterMs)
+  {
+    if (initialized_)
+    {
+      resets_++;
+    }
+    setOrigin(latitude, longitude);
+    start(nowMs, 0.0f, 0.0f, sigma);
+    accepted_++;
+  }
+  else
+  {
+    predict(static_cast<float>(nowMs - lastMs_) / 1000.0f);
+    lastMs_ = nowMs;
+
+    float east = 0.0f;
+    float north = 0.0f;
+    project(latitude, longitude, &east, &north);
+    float ye = east - east_;
+    float yn = north - north_;
+    float s = p00_ + r;
+    if ((ye * ye + yn * yn) / s > config_.gateChi2)
+    {
+      rejected_++;
+      if (++rejectRun_ <= config_.maxRejects)
+      {
+        return false;
+      }
+      // 连续多个定位都落在门限外：是滤波跟丢了（长时间外推、急转），不是跳点
+      resets_++;
+      start(nowMs, east, north, sigma);
+    }
+    else
+    {
+      // 位置观测 H = [1 0]，两个轴增益相同
+      float k0 = p00_ / s;
+      float k1 = p01_ / s;
+      east_ += k0 * ye;
+      north_ += k0 * yn;
+      eastV_ += k1 * ye;
+      northV_ += k1 * yn;
+      p11_ -= k1 * p01_;
+      p01_ -= k0 * p01_;
+      p00_ -= k0 * p00_;
+      rejectRun_ = 0;
+    }
+    accepted_++;
+  }
+
+  // 速度观测 H = [0 1]：低速时接收机航向是噪声，按静止观测；有速度没航向时定不了方向，不用
+  float speed = isnan(speedKmh) ? NAN : speedKmh / 3.6f;
+  bool moving = !isnan(speed) && speed >= config_.minCourseSpeedMps;
+  if (!isnan(speed) && (!moving || !isnan(courseDeg)))
+  {
+    float course = moving ? courseDeg / kRadiansToDegrees : 0.0f;
+    float ve = (moving ? speed * sinf(course) : 0.0f) - eastV_;
+    float vn = (moving ? speed * cosf(course) : 0.0f) - northV_;
+    float s = p11_ + config_.speedSigmaMps * config_.speedSigmaMps;
+    float k0 = p01_ / s;
+    float k1 = p11_ / s;
+    east_ += k0 * ve;
+    north_ += k0 * vn;
+    eastV_ += k1 * ve;
+    northV_ += k1 * vn;
+    p00_ -= k0 * p01_;
+    p01_ -= k0 * p11_;
+    p11_ -= k1 * p11_;
+  }
+
+  if (fabsf(east_) > kRecenterMeters || fabsf(north_) > kRecenterMeters)
+  {
+    setOrigin(originLat_ + north_ / metersPerLat_, originLng_ + east_ / metersPerLng_);
+    east_ = north_ = 0.0f;
+  }
+  return true;
+}
+
+PositionEstimate PositionFilter::estimate(uint32_t atMs) const
+{
+  PositionEstimate out = {};
+  if (!initialized_)
+  {
+    return out;
+  }
+
+  // atMs 可能略早于最近定位（调用方先取时间后拿快照），按 0 处理
+  int32_t elapsed = static_cast<int32_t>(atMs - lastMs_);
+  uint32_t age = elapsed > 0 ? static_cast<uint32_t>(elapsed) : 0;
+  uint32_t coastMs = age < config_.maxCoastMs ? age : config_.maxCoastMs;
+  float dt = static_cast<float>(coastMs) / 1000.0f;
+  float q = config_.accelNoise;
+  float east = east_ + eastV_ * dt;
+  float north = north_ + northV_ * dt;
+  float p00 = p00_ + 2.0f * dt * p01_ + dt * dt * p11_ + q * dt * dt * dt / 3.0f;
+
+  out.latitude = originLat_ + north / metersPerLat_;
+  out.longitude = originLng_ + east / metersPerLng_;
+  out.eastMps = eastV_;
+  out.northMps = northV_;
+  float speed = sqrtf(eastV_ * eastV_ + northV_ * northV_);
+  out.speedKmh = speed * 3.6f;
+  float course = atan2f(eastV_, northV_) * kRadiansToDegrees;
+  out.courseDeg = course < 0.0f ? course + 360.0f : course;
+  out.errorMeters = sqrtf(2.0f * p00);
+  out.ageMs = age;
+  out.valid = age <= config_.maxCoastMs && out.errorMeters <= config_.maxErrorMeters;
+  return out;
+}
@@ -0,0 +1,84 @@
+#ifndef POSITION_FILTER_H
+#define POSITION_FILTER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// GPS 位置估计：局部东-北平面坐标（米，以首个定位为原点）上的匀速卡尔曼滤波。
+// 状态为东/北位置与速度，过程噪声为白噪声加速度；观测为定位位置（标准差 = UERE × HDOP）
+// 和 RMC/VTG 的速度航向（换算成东/北速度）。两个轴的观测噪声相同，协方差只需存一份 2×2。
+// 位置新息超出卡方门限的定位视为多径跳点丢弃，连续被拒若干次则按新定位重置。
+// 任意时刻都可查询按速度外推的位置（定位之间插值、丢星时短时推算），不改变滤波状态。
+// 纯逻辑，不依赖 Arduino，不加锁（调用方负责）；主机端轨迹回放见 tools/position_filter_replay.cpp。
+struct PositionFilterConfig
+{
+  float accelNoise = 0.5f;       // 过程噪声加速度谱密度（m²/s³），步行转弯、起停
+  float uereMeters = 4.0f;       // HDOP 为 1 时的定位标准差
+  float defaultHdop = 2.0f;      // 没有 HDOP 时按该值
+  float speedSigmaMps = 0.5f;    // 速度观测标准差
+  float minCourseSpeedMps = 0.4f; // 低于该速度时航向不可信，按静止观测
+  float gateChi2 = 13.8f;        // 二维卡方 99.9%
+  uint8_t maxRejects = 3;        // 连续被拒的定位数，超过后认为是滤波跑偏而不是跳点
+  uint32_t resetAfterMs = 60000; // 超过该时长没有定位时，下一个定位直接重置
+  uint32_t maxCoastMs = 10000;   // 外推超过该时长的估计不再可用，位置停在外推上限处
+  float maxErrorMeters = 30.0f;  // 估计误差（1σ 半径）超过该值时不可用
+};
+
+struct PositionEstimate
+{
+  double latitude;
+  double longitude;
+  float eastMps;
+  float northMps;
+  float speedKmh;
+  float courseDeg;   // 真北顺时针，0~360
+  float errorMeters; // 位置 1σ 半径
+  uint32_t ageMs;    // 距最近一次被接受的定位
+  bool valid;
+};
+
+class PositionFilter
+{
+public:
+  explicit PositionFilter(const PositionFilterConfig &config = PositionFilterConfig()) : config_(config) { reset(); }
+
+  void reset();
+  // 一个定位：nowMs 为收到的时刻（millis），hdop/speedKmh/courseDeg 未知时传 NAN。
+  // 返回 false 表示该定位被当作跳点丢弃
+  bool update(uint32_t nowMs, double latitude, double longitude, float hdop, float speedKmh, float courseDeg);
+  // 按匀速模型外推到 atMs；atMs 早于最近定位时返回最近定位时刻的估计
+  PositionEstimate estimate(uint32_t atMs) const;
+
+  bool initialized() const { return initialized_; }
+  uint32_t accepted() const { return accepted_; }
+  uint32_t rejected() const { return rejected_; }
+  uint32_t resets() const { return resets_; }
+
+private:
+  void start(uint32_t nowMs, float east, float north, float sigma);
+  void predict(float dt);
+  void setOrigin(double latitude, double longitude);
+  void project(double latitude, double longitude, float *east, float *north) const;
+
+  PositionFilterConfig config_;
+  bool initialized_;
+  double originLat_;
+  double originLng_;
+  double metersPerLat_;
+  double metersPerLng_;
+  uint32_t lastMs_;
+  // 状态：东/北位置与速度；两个轴共用一份协方差 [p00 p01; p01 p11]
+  float east_;
+  float north_;
+  float eastV_;
+  float northV_;
+  float p00_;
+  float p01_;
+  float p11_;
+  uint8_t rejectRun_;
+  uint32_t accepted_;
+  uint32_t rejected_;
+  uint32_t resets_;
+};
+
+#endif // POSITION_FILTER_H
@@ -0,0 +1,274 @@
+#include "secure_conn_pool.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+SecureConnPool::SecureConnPool(ClockFn clockUs, LockFn lock, LockFn unlock, void *lockContext)
+    : clockUs_(clockUs), lock_(lock), unlock_(unlock), lockContext_(lockContext), sessions_(), stats_(),
+      warm_(nullptr), warmHost_(), warmPort_(0), warmBusy_(false), warmOpen_(false), keepWarm_(false)
+{
+}
+
+SecureConnPool::~SecureConnPool()
+{
+  for (size_t i = 0; i < kMaxHosts; ++i)
+  {
+    free(sessions_[i].data);
+  }
+}
+
+void SecureConnPool::lock() const
+{
+  if (lock_ != nullptr)
+  {
+    lock_(lockContext_);
+  }
+}
+
+void SecureConnPool::unlock() const
+{
+  if (unlock_ != nullptr)
+  {
+    unlock_(lockContext_);
+  }
+}
+
+SecureConnPool::SessionEntry *SecureConnPool::findLocked(const char *host)
+{
+  for (size_t i = 0; i < kMaxHosts; ++i)
+  {
+    if (sessions_[i].data != nullptr && strcmp(sessions_[i].host, host) == 0)
+    {
+      return &sessions_[i];
+    }
+  }
+  return nullptr;
+}
+
+void SecureConnPool::storeLocked(const char *host, uint8_t *data, size_t length)
+{
+  SessionEntry *entry = findLocked(host);
+  if (entry == nullptr)
+  {
+    // 空槽优先，否则替换最久没用过的主机
+    entry = &sessions_[0];
+    for (size_t i = 0; i < kMaxHosts; ++i)
+    {
+      if (sessions_[i].data == nullptr)
+      {
+        entry = &sessions_[i];
+        break;
+      }
+      if (sessions_[i].lastUsedUs < entry->lastUsedUs)
+      {
+        entry = &sessions_[i];
+      }
+    }
+    strncpy(entry->host, host, kMaxHostLength);
+    entry->host[kMaxHostLength] = '\0';
+  }
+  free(entry->data);
+  entry->data = data;
+  entry->length = length;
+  entry->lastUsedUs = clockUs_();
+  ++stats_.sessionsStored;
+}
+
+bool SecureConnPool::connect(TlsTransport &transport, const char *host, uint16_t port, uint32_t timeoutMs)
+{
+  bool cacheable = strlen(host) <= kMaxHostLength;
+  uint8_t *offered = nullptr;
+  size_t offeredLength = 0;
+  if (cacheable)
+  {
+    // 拷一份再握手：握手期间其他任务可能替换这个主机的缓存
+    lock();
+    SessionEntry *entry = findLocked(host);
+    if (entry != nullptr)
+    {
+      offered = static_cast<uint8_t *>(malloc(entry->length));
+      if (offered != nullptr)
+      {
+        memcpy(offered, entry->data, entry->length);
+        offeredLength = entry->length;
+        entry->lastUsedUs = clockUs_();
+      }
+    }
+    unlock();
+  }
+
+  uint64_t startUs = clockUs_();
+  bool ok = transport.open(host, port, offered, offeredLength, timeoutMs);
+  uint32_t elapsedUs = static_cast<uint32_t>(clockUs_() - startUs);
+  free(offered);
+  if (!ok)
+  {
+    lock();
+    ++stats_.failed;
+    unlock();
+    return false;
+  }
+
+  bool resumed = offeredLength > 0 && transport.resumed();
+  // 恢复时服务端也可能换发新 ticket，每次握手后都重新导出
+  uint8_t *saved = nullptr;
+  size_t savedLength = cacheable ? transport.saveSession(nullptr, 0) : 0;
+  if (savedLength > 0 && savedLength <= kMaxSessionBytes)
+  {
+    saved = static_cast<uint8_t *>(malloc(savedLength));
+    if (saved != nullptr && transport.saveSession(saved, savedLength) != savedLength)
+    {
+      free(saved);
+      saved = nullptr;
+    }
+  }
+
+  lock();
+  ++stats_.handshakes;
+  if (resumed)
+  {
+    ++stats_.resumed;
+    stats_.resumedHandshakeUs += elapsedUs;
+  }
+  else
+  {
+    stats_.fullHandshakeUs += elapsedUs;
+  }
+  stats_.lastHandshakeUs = elapsedUs;
+  if (elapsedUs > stats_.maxHandshakeUs)
+  {
+    stats_.maxHandshakeUs = elapsedUs;
+  }
+  if (saved != nullptr)
+  {
+    storeLocked(host, saved, savedLength);
+  }
+  unlock();
+  return true;
+}
+
+void SecureConnPool::setWarm(TlsTransport *transport, const char *host, uint16_t port)
+{
+  lock();
+  warm_ = transport;
+  strncpy(warmHost_, host, kMaxHostLength);
+  warmHost_[kMaxHostLength] = '\0';
+  warmPort_ = port;
+  unlock();
+}
+
+bool SecureConnPool::claimWarm(const char *host, uint16_t port)
+{
+  lock();
+  bool matches = warm_ != nullptr && port == warmPort_ && strcmp(host, warmHost_) == 0;
+  bool claimed = matches && !warmBusy_;
+  if (claimed)
+  {
+    warmBusy_ = true;
+  }
+  else if (matches)
+  {
+    ++stats_.warmBusy;
+  }
+  unlock();
+  return claimed;
+}
+
+bool SecureConnPool::openWarm(uint32_t timeoutMs)
+{
+  // warmOpen_ 只由占用者改写，这里不需要锁
+  if (warmOpen_)
+  {
+    if (warm_->isOpen())
+    {
+      lock();
+      ++stats_.reused;
+      unlock();
+      return true;
+    }
+    // 服务端已关闭空闲连接（keep-alive 超时），重新握手，通常能用缓存会话恢复
+    warm_->close();
+    warmOpen_ = false;
+  }
+  warmOpen_ = connect(*warm_, warmHost_, warmPort_, timeoutMs);
+  return warmOpen_;
+}
+
+void SecureConnPool::releaseWarm(bool reusable)
+{
+  lock();
+  bool keep = reusable && keepWarm_;
+  unlock();
+  if (!keep)
+  {
+    closeWarm();
+  }
+  lock();
+  warmBusy_ = false;
+  unlock();
+}
+
+void SecureConnPool::setKeepWarm(bool keepWarm)
+{
+  lock();
+  keepWarm_ = keepWarm;
+  bool closeNow = !keepWarm && !warmBusy_ && warmOpen_;
+  if (closeNow)
+  {
+    warmBusy_ = true;
+  }
+  unlock();
+  if (closeNow)
+  {
+    closeWarm();
+    lock();
+    warmBusy_ = false;
+    unlock();
+  }
+}
+
+void SecureConnPool::closeWarm()
+{
+  if (warmOpen_)
+  {
+    warm_->close();
+    warmOpen_ = false;
+  }
+}
+
+void SecureConnPool::forgetSession(const char *host)
+{
+  lock();
+  SessionEntry *entry = findLocked(host);
+  if (entry != nullptr)
+  {
+    free(entry->data);
+    entry->data = nullptr;
+    entry->length = 0;
+    entry->host[0] = '\0';
+  }
+  unlock();
+}
+
+size_t SecureConnPool::sessionCount() const
+{
+  size_t count = 0;
+  lock();
+  for (size_t i = 0; i < kMaxHosts; ++i)
+  {
+    if (sessions_[i].data != nullptr)
+    {
+      ++count;
+    }
+  }
+  unlock();
+  return count;
+}
+
+SecureConnStats SecureConnPool::stats() const
+{
+  lock();
+  SecureConnStats copy = stats_;
+  unlock();
+  return copy;
+}
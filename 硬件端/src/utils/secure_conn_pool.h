@@ -0,0 +1,109 @@
+#ifndef SECURE_CONN_POOL_H
+#define SECURE_CONN_POOL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// TLS 连接的平台实现：设备上是 mbedTLS（services/secure_client.cpp），主机端测试用 OpenSSL。
+// 会话以序列化字节交换，池只按主机缓存，不关心具体格式。
+class TlsTransport
+{
+public:
+  virtual ~TlsTransport() {}
+  // session 非空时带上缓存的会话尝试恢复，服务端不认时由 TLS 库退回完整握手
+  virtual bool open(const char *host, uint16_t port, const uint8_t *session, size_t sessionLength,
+                    uint32_t timeoutMs) = 0;
+  virtual bool resumed() const = 0;
+  // 导出当前会话：out 为空时只返回所需长度；没有会话或 capacity 不够时返回 0
+  virtual size_t saveSession(uint8_t *out, size_t capacity) = 0;
+  // 连接仍然可用：对端没有关闭
+  virtual bool isOpen() = 0;
+  virtual void close() = 0;
+};
+
+struct SecureConnStats
+{
+  uint32_t handshakes;         // 完整 + 恢复
+  uint32_t resumed;            // 用缓存会话的简化握手
+  uint32_t failed;             // 连接或握手失败
+  uint32_t reused;             // 直接复用保温连接，没有握手
+  uint32_t warmBusy;           // 保温连接正被占用，改用临时连接
+  uint32_t sessionsStored;
+  uint64_t fullHandshakeUs;    // 完整握手累计耗时
+  uint64_t resumedHandshakeUs; // 简化握手累计耗时
+  uint32_t maxHandshakeUs;
+  uint32_t lastHandshakeUs;
+};
+
+// 安全连接池：按主机缓存 TLS 会话（会话 ID 或 ticket），新连接先尝试恢复，省掉密钥交换；
+// 另有一个保温连接只给 warmHost 用，keepWarm 打开时（语音交互进行中）请求结束后不关闭，
+// 多段 TTS 复用同一条连接。纯逻辑，不依赖 Arduino/FreeRTOS；锁由调用方以函数指针提供，
+// 只在读写缓存和统计时持有，握手和收发都在锁外。主机端验证见 tools/secure_conn_check.cpp。
+class SecureConnPool
+{
+public:
+  static const size_t kMaxHosts = 4;
+  static const size_t kMaxHostLength = 63;
+  static const size_t kMaxSessionBytes = 4096;
+
+  typedef uint64_t (*ClockFn)();
+  typedef void (*LockFn)(void *context);
+
+  SecureConnPool(ClockFn clockUs, LockFn lock = nullptr, LockFn unlock = nullptr, void *lockContext = nullptr);
+  ~SecureConnPool();
+
+  // 把 transport 连到 host:port：有缓存会话时带上尝试恢复，握手成功后更新缓存并计入统计
+  bool connect(TlsTransport &transport, const char *host, uint16_t port, uint32_t timeoutMs);
+
+  // 保温连接只服务一个主机；transport 由调用方持有，生命周期长于池的使用
+  void setWarm(TlsTransport *transport, const char *host, uint16_t port);
+  // 占用保温连接：host 不是保温主机或已被占用时返回 false，调用方改用临时连接
+  bool claimWarm(const char *host, uint16_t port);
+  // 已占用后调用：连接仍开着就直接复用，否则重新连接（带缓存会话）
+  bool openWarm(uint32_t timeoutMs);
+  // 归还：reusable（响应完整读完、服务端没要求关闭）且 keepWarm 时保持连接，否则关闭
+  void releaseWarm(bool reusable);
+  // 关闭 keepWarm 时顺带关掉空闲的保温连接；被占用时由归还方关闭
+  void setKeepWarm(bool keepWarm);
+  bool keepWarm() const { return keepWarm_; }
+  bool warmOpen() const { return warmOpen_; }
+
+  void forgetSession(const char *host);
+  size_t sessionCount() const;
+  SecureConnStats stats() const;
+
+private:
+  SecureConnPool(const SecureConnPool &);
+  SecureConnPool &operator=(const SecureConnPool &);
+
+  struct SessionEntry
+  {
+    char host[kMaxHostLength + 1];
+    uint8_t *data;
+    size_t length;
+    uint64_t lastUsedUs;
+  };
+
+  void lock() const;
+  void unlock() const;
+  SessionEntry *findLocked(const char *host);
+  void storeLocked(const char *host, uint8_t *data, size_t length);
+  void closeWarm();
+
+  ClockFn clockUs_;
+  LockFn lock_;
+  LockFn unlock_;
+  void *lockContext_;
+
+  SessionEntry sessions_[kMaxHosts];
+  SecureConnStats stats_;
+
+  TlsTransport *warm_;
+  char warmHost_[kMaxHostLength + 1];
+  uint16_t warmPort_;
+  bool warmBusy_;
+  bool warmOpen_;
+  bool keepWarm_;
+};
+
+#endif // SECURE_CONN_POOL_H
@@ -0,0 +1,363 @@
+#include "timer_wheel.h"
+
+namespace
+{
+// bits 循环右移 shift 位后最低的置位位置；bits 为 0 时返回 64
+uint32_t firstSetFrom(uint64_t bits, uint32_t shift)
+{
+  if (bits == 0)
+  {
+    return 64;
+  }
+  shift &= 63;
+  uint64_t rotated = shift == 0 ? bits : (bits >> shift) | (bits << (64 - shift));
+  return static_cast<uint32_t>(__builtin_ctzll(rotated));
+}
+} // namespace
+
+void TimerWheel::begin(uint32_t nowMs)
+{
+  tick_ = 0;
+  tickBaseMs_ = nowMs;
+  lastNowMs_ = nowMs;
+  for (int level = 0; level < kLevels; ++level)
+  {
+    occupied_[level] = 0;
+    for (uint32_t slot = 0; slot < kSlots; ++slot)
+    {
+      heads_[level][slot] = -1;
+    }
+  }
+  for (size_t i = 0; i < kMaxJobs; ++i)
+  {
+    jobs_[i].used = false;
+  }
+  jobCount_ = 0;
+}
+
+int TimerWheel::addPeriodic(const char *name, uint32_t periodMs, uint32_t firstDelayMs, TimerJobFn fn, void *context)
+{
+  if (periodMs == 0)
+  {
+    return kInvalidJob;
+  }
+  int id = allocate(name, periodMs, fn, context);
+  if (id != kInvalidJob)
+  {
+    schedule(id, lastNowMs_ + firstDelayMs);
+  }
+  return id;
+}
+
+int TimerWheel::addOneShot(const char *name, uint32_t delayMs, TimerJobFn fn, void *context)
+{
+  int id = allocate(name, 0, fn, context);
+  if (id != kInvalidJob)
+  {
+    schedule(id, lastNowMs_ + delayMs);
+  }
+  return id;
+}
+
+bool TimerWheel::reschedule(int id, uint32_t delayMs)
+{
+  if (id < 0 || id >= static_cast<int>(kMaxJobs) || !jobs_[id].used)
+  {
+    return false;
+  }
+  unlink(id);
+  schedule(id, lastNowMs_ + delayMs);
+  return true;
+}
+
+bool TimerWheel::kick(int id)
+{
+  if (id < 0 || id >= static_cast<int>(kMaxJobs) || !jobs_[id].used)
+  {
+    return false;
+  }
+  ++jobs_[id].stats.kicks;
+  jobs_[id].fn(jobs_[id].context);
+  return true;
+}
+
+bool TimerWheel::cancel(int id)
+{
+  if (id < 0 || id >= static_cast<int>(kMaxJobs) || !jobs_[id].used)
+  {
+    return false;
+  }
+  unlink(id);
+  jobs_[id].used = false;
+  --jobCount_;
+  return true;
+}
+
+size_t TimerWheel::advance(uint32_t nowMs)
+{
+  lastNowMs_ = nowMs;
+  size_t ran = 0;
+  // 任务被阻塞过久时逐 tick 追赶：空 tick 只做位运算，高层槽按顺序下放，到期顺序不乱
+  while (nowMs - tickBaseMs_ >= tickMs_)
+  {
+    tickBaseMs_ += tickMs_;
+    ++tick_;
+    ran += processTick(nowMs);
+  }
+  return ran;
+}
+
+uint32_t TimerWheel::msUntilNext(uint32_t nowMs) const
+{
+  uint32_t ticks = UINT32_MAX;
+  for (int level = 0; level < kLevels; ++level)
+  {
+    uint32_t candidate = nextTickAt(level);
+    if (candidate < ticks)
+    {
+      ticks = candidate;
+    }
+  }
+  if (ticks == UINT32_MAX)
+  {
+    return UINT32_MAX;
+  }
+  uint32_t dueMs = tickBaseMs_ + ticks * tickMs_;
+  int32_t left = static_cast<int32_t>(dueMs - nowMs);
+  return left > 0 ? static_cast<uint32_t>(left) : 0;
+}
+
+bool TimerWheel::jobStats(int id, TimerJobStats *out) const
+{
+  if (id < 0 || id >= static_cast<int>(kMaxJobs) || !jobs_[id].used || out == nullptr)
+  {
+    return false;
+  }
+  *out = jobs_[id].stats;
+  return true;
+}
+
+int TimerWheel::allocate(const char *name, uint32_t periodMs, TimerJobFn fn, void *context)
+{
+  if (fn == nullptr)
+  {
+    return kInvalidJob;
+  }
+  for (size_t i = 0; i < kMaxJobs; ++i)
+  {
+    if (!jobs_[i].used)
+    {
+      Job &job = jobs_[i];
+      job = Job();
+      job.used = true;
+      job.fn = fn;
+      job.context = context;
+      job.level = -1;
+      job.next = -1;
+      job.prev = -1;
+      job.stats.name = name;
+      job.stats.periodMs = periodMs;
+      ++jobCount_;
+      return static_cast<int>(i);
+    }
+  }
+  return kInvalidJob;
+}
+
+void TimerWheel::schedule(int id, uint32_t deadlineMs)
+{
+  Job &job = jobs_[id];
+  job.deadlineMs = deadlineMs;
+  // 向上取整到 tick 边界，保证不早于截止时刻执行；至少下一个 tick
+  int32_t aheadMs = static_cast<int32_t>(deadlineMs - tickBaseMs_);
+  uint32_t ticks = aheadMs <= 0 ? 1 : (static_cast<uint32_t>(aheadMs) + tickMs_ - 1) / tickMs_;
+  job.expiresTick = tick_ + ticks;
+  insert(id);
+}
+
+void TimerWheel::insert(int id)
+{
+  Job &job = jobs_[id];
+  uint32_t delta = job.expiresTick - tick_;
+  int level;
+  uint32_t slot;
+  if (delta < kSlots)
+  {
+    level = 0;
+    slot = job.expiresTick & kSlotMask;
+  }
+  else if (delta < (kSlots << kSlotBits))
+  {
+    level = 1;
+    slot = (job.expiresTick >> kSlotBits) & kSlotMask;
+  }
+  else
+  {
+    // 超出三级范围的先放在最远处，下放到一级时再按截止时刻判断是否真的到期
+    const uint32_t maxDelta = (kSlots << (2 * kSlotBits)) - 1;
+    if (delta > maxDelta)
+    {
+      job.expiresTick = tick_ + maxDelta;
+    }
+    level = 2;
+    slot = (job.expiresTick >> (2 * kSlotBits)) & kSlotMask;
+  }
+
+  job.level = static_cast<int8_t>(level);
+  job.slot = static_cast<uint8_t>(slot);
+  job.prev = -1;
+  job.next = heads_[level][slot];
+  if (job.next >= 0)
+  {
+    jobs_[job.next].prev = static_cast<int16_t>(id);
+  }
+  heads_[level][slot] = static_cast<int16_t>(id);
+  occupied_[level] |= 1ULL << slot;
+}
+
+void TimerWheel::unlink(int id)
+{
+  Job &job = jobs_[id];
+  if (job.level < 0)
+  {
+    return;
+  }
+  if (job.prev >= 0)
+  {
+    jobs_[job.prev].next = job.next;
+  }
+  else
+  {
+    heads_[job.level][job.slot] = job.next;
+    if (job.next < 0)
+    {
+      occupied_[job.level] &= ~(1ULL << job.slot);
+    }
+  }
+  if (job.next >= 0)
+  {
+    jobs_[job.next].prev = job.prev;
+  }
+  job.level = -1;
+  job.next = -1;
+  job.prev = -1;
+}
+
+size_t TimerWheel::processTick(uint32_t nowMs)
+{
+  if ((tick_ & kSlotMask) == 0)
+  {
+    if ((tick_ & ((kSlots << kSlotBits) - 1)) == 0)
+    {
+      cascade(2, (tick_ >> (2 * kSlotBits)) & kSlotMask);
+    }
+    cascade(1, (tick_ >> kSlotBits) & kSlotMask);
+  }
+
+  // 先整体摘下本槽：回调里重新登记到本槽的作业（例如 reschedule(0)）留到下一圈
+  uint32_t slot = tick_ & kSlotMask;
+  int16_t due[kMaxJobs];
+  size_t dueCount = 0;
+  for (int id = heads_[0][slot]; id >= 0;)
+  {
+    int next = jobs_[id].next;
+    jobs_[id].level = -1;
+    jobs_[id].next = -1;
+    jobs_[id].prev = -1;
+    due[dueCount++] = static_cast<int16_t>(id);
+    id = next;
+  }
+  heads_[0][slot] = -1;
+  occupied_[0] &= ~(1ULL << slot);
+
+  size_t ran = 0;
+  for (size_t i = 0; i < dueCount; ++i)
+  {
+    // 前面的回调可能取消或重新设定了同槽的作业
+    int id = due[i];
+    if (!jobs_[id].used || jobs_[id].level >= 0)
+    {
+      continue;
+    }
+    run(id, nowMs);
+    ++ran;
+  }
+  return ran;
+}
+
+void TimerWheel::cascade(int level, uint32_t slot)
+{
+  int id = heads_[level][slot];
+  heads_[level][slot] = -1;
+  occupied_[level] &= ~(1ULL << slot);
+  while (id >= 0)
+  {
+    int next = jobs_[id].next;
+    insert(id);
+    id = next;
+  }
+}
+
+void TimerWheel::run(int id, uint32_t nowMs)
+{
+  Job &job = jobs_[id];
+  int32_t lateMs = static_cast<int32_t>(nowMs - job.deadlineMs);
+  if (lateMs < 0 && static_cast<int32_t>(tickBaseMs_ - job.deadlineMs) < 0)
+  {
+    // 超远期作业被截断后提前下放：还没到截止时刻，重新登记
+    schedule(id, job.deadlineMs);
+    return;
+  }
+  if (lateMs < 0)
+  {
+    lateMs = 0;
+  }
+
+  ++job.stats.runs;
+  job.stats.totalLateMs += static_cast<uint32_t>(lateMs);
+  if (static_cast<uint32_t>(lateMs) > job.stats.maxLateMs)
+  {
+    job.stats.maxLateMs = static_cast<uint32_t>(lateMs);
+  }
+
+  job.fn(job.context);
+
+  // 回调里取消或重新设定了自己就不再按周期登记
+  if (!job.used || job.level >= 0 || job.stats.periodMs == 0)
+  {
+    return;
+  }
+  uint32_t period = job.stats.periodMs;
+  uint32_t next = job.deadlineMs + period;
+  int32_t behind = static_cast<int32_t>(nowMs - next);
+  if (behind >= 0)
+  {
+    uint32_t skipped = static_cast<uint32_t>(behind) / period + 1;
+    job.stats.missed += skipped;
+    next += skipped * period;
+  }
+  schedule(id, next);
+}
+
+uint32_t TimerWheel::nextTickAt(int level) const
+{
+  if (occupied_[level] == 0)
+  {
+    return UINT32_MAX;
+  }
+  // 按时间顺序第一个有作业的槽（从下一个 tick / 下一组起循环查找）
+  uint32_t shift = level * kSlotBits;
+  uint32_t from = (tick_ >> shift) + 1;
+  uint32_t slot = (from + firstSetFrom(occupied_[level], from)) & kSlotMask;
+  // 高层槽的下放由 advance() 逐 tick 追赶时顺带完成，不单独唤醒：直接取槽里最早的到期 tick
+  uint32_t earliest = UINT32_MAX;
+  for (int id = heads_[level][slot]; id >= 0; id = jobs_[id].next)
+  {
+    uint32_t ahead = jobs_[id].expiresTick - tick_;
+    if (ahead < earliest)
+    {
+      earliest = ahead;
+    }
+  }
+  return earliest;
+}
@@ -0,0 +1,93 @@
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// 分层时间轮：三级各 64 个槽，tick 为 tickMs（默认 10 ms），一级覆盖 0.64 s，二级 41 s，三级 44 min。
+// 作业从固定池里分配，插入/取消 O(1)；高层的槽在轮到时整体下放。各级槽占用位图让
+// msUntilNext() 不用逐槽扫描就能算出下一个到期时刻，调度任务据此一次睡到底。
+// 纯逻辑，不依赖 Arduino/FreeRTOS，也不加锁：只在调度任务里调用（或在任务启动前注册），
+// 主机端验证见 tools/timer_wheel_sim.cpp。
+typedef void (*TimerJobFn)(void *context);
+
+struct TimerJobStats
+{
+  const char *name;
+  uint32_t periodMs;   // 0 为一次性作业
+  uint32_t runs;
+  uint32_t kicks;      // 被外部事件（中断）提前触发的次数
+  uint32_t missed;     // 周期作业落后超过一个周期而跳过的次数
+  uint32_t maxLateMs;  // 实际执行时刻晚于截止时刻的最大值
+  uint32_t totalLateMs;
+};
+
+class TimerWheel
+{
+public:
+  static constexpr size_t kMaxJobs = 16;
+  static constexpr int kInvalidJob = -1;
+
+  explicit TimerWheel(uint32_t tickMs = 10) : tickMs_(tickMs == 0 ? 1 : tickMs) { begin(0); }
+
+  // 时钟起点；之后 advance() 的时间都相对它推进（millis() 回绕也按差值处理）
+  void begin(uint32_t nowMs);
+
+  // 返回作业 id，池满返回 kInvalidJob。第一次在 firstDelayMs 后执行，之后按截止时刻（不是执行时刻）累加周期，不漂移
+  int addPeriodic(const char *name, uint32_t periodMs, uint32_t firstDelayMs, TimerJobFn fn, void *context);
+  // 一次性作业执行后仍占着 id，可以 reschedule 再次使用，cancel 后才释放
+  int addOneShot(const char *name, uint32_t delayMs, TimerJobFn fn, void *context);
+  // 重新设定下一次截止时刻（周期作业从这里重新起算）
+  bool reschedule(int id, uint32_t delayMs);
+  // 立即执行一次（不影响周期作业原有的截止时刻），用于中断唤醒后的处理
+  bool kick(int id);
+  bool cancel(int id);
+
+  // 推进到 nowMs 并执行到期作业，返回执行的作业数
+  size_t advance(uint32_t nowMs);
+  // 距下一次有作业到期的毫秒数；没有任何作业时返回 UINT32_MAX
+  uint32_t msUntilNext(uint32_t nowMs) const;
+
+  bool jobStats(int id, TimerJobStats *out) const;
+  size_t jobCount() const { return jobCount_; }
+
+private:
+  static constexpr int kLevels = 3;
+  static constexpr uint32_t kSlotBits = 6;
+  static constexpr uint32_t kSlots = 1u << kSlotBits;
+  static constexpr uint32_t kSlotMask = kSlots - 1;
+
+  struct Job
+  {
+    TimerJobFn fn;
+    void *context;
+    uint32_t deadlineMs;
+    uint32_t expiresTick;
+    int16_t next;
+    int16_t prev;
+    int8_t level;    // -1：不在轮上（一次性作业已执行或正在执行）
+    uint8_t slot;
+    bool used;
+    TimerJobStats stats;
+  };
+
+  int allocate(const char *name, uint32_t periodMs, TimerJobFn fn, void *context);
+  void schedule(int id, uint32_t deadlineMs);
+  void insert(int id);
+  void unlink(int id);
+  size_t processTick(uint32_t nowMs);
+  void cascade(int level, uint32_t slot);
+  void run(int id, uint32_t nowMs);
+  uint32_t nextTickAt(int level) const;
+
+  uint32_t tickMs_;
+  uint32_t tick_ = 0;        // 最近处理过的 tick
+  uint32_t tickBaseMs_ = 0;  // tick_ 对应的毫秒时刻
+  uint32_t lastNowMs_ = 0;   // 最近一次 advance() 的时刻，reschedule 等相对它计算
+  int16_t heads_[kLevels][kSlots];
+  uint64_t occupied_[kLevels] = {};
+  Job jobs_[kMaxJobs] = {};
+  size_t jobCount_ = 0;
+};
+
+#endif // TIMER_WHEEL_H
@@ -0,0 +1,304 @@
+#include "voice_arena.h"
+
+#include <Arduino.h>
+#include <esp_heap_caps.h>
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "../config.h"
+#include "deferred_log.h"
+
+namespace
+{
+const size_t kAlign = 16;
+
+struct Region
+{
+  const char *name;
+  uint8_t *base;
+  size_t capacity;
+  size_t used;
+  TaskHandle_t owner;
+  uint16_t depth;
+};
+
+Region regions[kVoiceArenaRegionCount] = {
+    {"capture", nullptr, 0, 0, nullptr, 0},
+    {"encode", nullptr, 0, 0, nullptr, 0},
+    {"network", nullptr, 0, 0, nullptr, 0},
+    {"playback", nullptr, 0, 0, nullptr, 0},
+};
+
+const size_t kRegionBytes[kVoiceArenaRegionCount] = {
+    VOICE_ARENA_CAPTURE_BYTES,
+    VOICE_ARENA_ENCODE_BYTES,
+    VOICE_ARENA_NETWORK_BYTES,
+    VOICE_ARENA_PLAYBACK_BYTES,
+};
+
+portMUX_TYPE arenaMux = portMUX_INITIALIZER_UNLOCKED;
+VoiceArenaStats stats = {};
+bool turnActive = false;
+
+size_t alignUp(size_t value)
+{
+  return (value + kAlign - 1) & ~(kAlign - 1);
+}
+
+uint32_t psramFree()
+{
+  return static_cast<uint32_t>(heap_caps_get_free_size(MALLOC_CAP_SPIRAM));
+}
+
+// 轮内检查点：每次分配/释放时看一眼 PSRAM 堆，记录最低值
+void sampleHeap()
+{
+  if (!turnActive)
+  {
+    return;
+  }
+  uint32_t freeBytes = psramFree();
+  portENTER_CRITICAL(&arenaMux);
+  if (freeBytes < stats.turnLowestFree)
+  {
+    stats.turnLowestFree = freeBytes;
+  }
+  portEXIT_CRITICAL(&arenaMux);
+}
+
+void countAllocation(VoiceArenaRegion region, size_t used)
+{
+  size_t index = static_cast<size_t>(region);
+  portENTER_CRITICAL(&arenaMux);
+  ++stats.allocations;
+  if (used > stats.peak[index])
+  {
+    stats.peak[index] = used;
+  }
+  portEXIT_CRITICAL(&arenaMux);
+}
+
+void countFallback()
+{
+  portENTER_CRITICAL(&arenaMux);
+  ++stats.fallbacks;
+  ++stats.turnFallbacks;
+  portEXIT_CRITICAL(&arenaMux);
+}
+} // namespace
+
+bool voiceArenaBegin()
+{
+  bool ok = true;
+  for (size_t i = 0; i < kVoiceArenaRegionCount; ++i)
+  {
+    Region &region = regions[i];
+    if (region.base != nullptr)
+    {
+      continue;
+    }
+    size_t bytes = alignUp(kRegionBytes[i]);
+    region.base = static_cast<uint8_t *>(heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT));
+    if (region.base == nullptr)
+    {
+      Serial.printf("[VoiceArena] Failed to reserve %s region (%u bytes), falling back to heap.\n", region.name,
+                    static_cast<unsigned>(bytes));
+      ok = false;
+      continue;
+    }
+    region.capacity = bytes;
+    stats.capacity[i] = bytes;
+  }
+  Serial.printf("[VoiceArena] Reserved capture %u, encode %u, network %u, playback %u bytes; PSRAM free %u\n",
+                static_cast<unsigned>(stats.capacity[0]), static_cast<unsigned>(stats.capacity[1]),
+                static_cast<unsigned>(stats.capacity[2]), static_cast<unsigned>(stats.capacity[3]),
+                static_cast<unsigned>(psramFree()));
+  return ok;
+}
+
+void voiceArenaBeginTurn()
+{
+  uint32_t freeBytes = psramFree();
+  uint32_t bootMin = static_cast<uint32_t>(heap_caps_get_minimum_free_size(MALLOC_CAP_SPIRAM));
+  portENTER_CRITICAL(&arenaMux);
+  stats.turnStartFree = freeBytes;
+  stats.turnLowestFree = freeBytes;
+  stats.turnFallbacks = 0;
+  stats.bootMinFreeBefore = bootMin;
+  portEXIT_CRITICAL(&arenaMux);
+  turnActive = true;
+}
+
+void voiceArenaEndTurn()
+{
+  sampleHeap();
+  turnActive = false;
+  uint32_t freeBytes = psramFree();
+  uint32_t bootMin = static_cast<uint32_t>(heap_caps_get_minimum_free_size(MALLOC_CAP_SPIRAM));
+  portENTER_CRITICAL(&arenaMux);
+  ++stats.turns;
+  stats.turnEndFree = freeBytes;
+  stats.bootMinFreeAfter = bootMin;
+  VoiceArenaStats copy = stats;
+  portEXIT_CRITICAL(&arenaMux);
+
+  Serial.printf("[VoiceArena] turn %u: PSRAM free %u -> %u, lowest in turn -%u, boot minimum %u -> %u, heap fallbacks %u\n",
+                static_cast<unsigned>(copy.turns), static_cast<unsigned>(copy.turnStartFree),
+                static_cast<unsigned>(copy.turnEndFree),
+                static_cast<unsigned>(copy.turnStartFree - copy.turnLowestFree),
+                static_cast<unsigned>(copy.bootMinFreeBefore), static_cast<unsigned>(copy.bootMinFreeAfter),
+                static_cast<unsigned>(copy.turnFallbacks));
+}
+
+VoiceArenaStats voiceArenaStats()
+{
+  portENTER_CRITICAL(&arenaMux);
+  VoiceArenaStats copy = stats;
+  portEXIT_CRITICAL(&arenaMux);
+  return copy;
+}
+
+void voiceArenaReportStats()
+{
+  VoiceArenaStats copy = voiceArenaStats();
+  DLOG(0, "[语音内存] 轮次: %u, 回退到堆: %u, PSRAM 开机以来最低空闲: %u\n",
+       copy.turns, copy.fallbacks, (unsigned)heap_caps_get_minimum_free_size(MALLOC_CAP_SPIRAM));
+  DLOG(0, "[语音内存] 区域峰值 采集 %u/%u 编码 %u/%u\n",
+       (unsigned)copy.peak[0], (unsigned)copy.capacity[0], (unsigned)copy.peak[1], (unsigned)copy.capacity[1]);
+  DLOG(0, "[语音内存] 区域峰值 网络 %u/%u 播放 %u/%u\n",
+       (unsigned)copy.peak[2], (unsigned)copy.capacity[2], (unsigned)copy.peak[3], (unsigned)copy.capacity[3]);
+}
+
+VoiceArenaLease::VoiceArenaLease(VoiceArenaRegion region)
+    : region_(region), owned_(false), startOffset_(0), last_(nullptr), heapBlocks_(), heapCount_(0)
+{
+  Region &r = regions[static_cast<size_t>(region)];
+  TaskHandle_t self = xTaskGetCurrentTaskHandle();
+  portENTER_CRITICAL(&arenaMux);
+  if (r.base != nullptr && (r.owner == nullptr || r.owner == self))
+  {
+    r.owner = self;
+    ++r.depth;
+    owned_ = true;
+    startOffset_ = r.used;
+  }
+  portEXIT_CRITICAL(&arenaMux);
+}
+
+VoiceArenaLease::~VoiceArenaLease()
+{
+  for (size_t i = 0; i < heapCount_; ++i)
+  {
+    free(heapBlocks_[i]);
+  }
+  sampleHeap();
+  if (!owned_)
+  {
+    return;
+  }
+  Region &r = regions[static_cast<size_t>(region_)];
+  portENTER_CRITICAL(&arenaMux);
+  // 嵌套租约按栈的顺序结束，退回到本租约开始时的位置
+  r.used = startOffset_;
+  if (--r.depth == 0)
+  {
+    r.owner = nullptr;
+  }
+  portEXIT_CRITICAL(&arenaMux);
+}
+
+uint8_t *VoiceArenaLease::alloc(size_t size)
+{
+  if (owned_)
+  {
+    Region &r = regions[static_cast<size_t>(region_)];
+    size_t offset = r.used;
+    if (size <= r.capacity - offset)
+    {
+      r.used = alignUp(offset + size) < r.capacity ? alignUp(offset + size) : r.capacity;
+      last_ = r.base + offset;
+      countAllocation(region_, r.used);
+      sampleHeap();
+      return last_;
+    }
+  }
+  last_ = heapAlloc(size);
+  sampleHeap();
+  return last_;
+}
+
+uint8_t *VoiceArenaLease::grow(uint8_t *buffer, size_t used, size_t newSize)
+{
+  if (buffer == nullptr)
+  {
+    return alloc(newSize);
+  }
+  if (owned_ && buffer == last_)
+  {
+    Region &r = regions[static_cast<size_t>(region_)];
+    if (buffer >= r.base && buffer < r.base + r.capacity)
+    {
+      size_t offset = static_cast<size_t>(buffer - r.base);
+      if (newSize <= r.capacity - offset)
+      {
+        r.used = alignUp(offset + newSize) < r.capacity ? alignUp(offset + newSize) : r.capacity;
+        countAllocation(region_, r.used);
+        return buffer;
+      }
+    }
+  }
+
+  uint8_t *bigger = alloc(newSize);
+  if (bigger == nullptr)
+  {
+    return nullptr;
+  }
+  memcpy(bigger, buffer, used);
+  // 原缓冲区若在区域里，租约结束时一起退回；在堆上则立即释放
+  releaseHeap(buffer);
+  return bigger;
+}
+
+uint8_t *VoiceArenaLease::heapAlloc(size_t size)
+{
+  if (heapCount_ == kMaxHeapBlocks)
+  {
+    Serial.println("[VoiceArena] Too many heap fallbacks in one lease.");
+    return nullptr;
+  }
+  uint8_t *buffer = static_cast<uint8_t *>(heap_caps_malloc(size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT));
+  if (buffer == nullptr)
+  {
+    buffer = static_cast<uint8_t *>(heap_caps_malloc(size, MALLOC_CAP_8BIT));
+  }
+  if (buffer == nullptr)
+  {
+    return nullptr;
+  }
+  Region &r = regions[static_cast<size_t>(region_)];
+  Serial.printf("[VoiceArena] %s region %s, %u bytes from heap\n", r.name,
+                owned_ ? "full" : (r.base == nullptr ? "not reserved" : "busy"), static_cast<unsigned>(size));
+  heapBlocks_[heapCount_++] = buffer;
+  countFallback();
+  return buffer;
+}
+
+bool VoiceArenaLease::releaseHeap(uint8_t *buffer)
+{
+  for (size_t i = 0; i < heapCount_; ++i)
+  {
+    if (heapBlocks_[i] == buffer)
+    {
+      free(buffer);
+      heapBlocks_[i] = heapBlocks_[--heapCount_];
+      if (last_ == buffer)
+      {
+        last_ = nullptr;
+      }
+      return true;
+    }
+  }
+  return false;
+}
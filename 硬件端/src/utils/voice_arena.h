@@ -0,0 +1,77 @@
+#ifndef VOICE_ARENA_H
+#define VOICE_ARENA_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// 语音链路内存区：开机时从 PSRAM 一次性预留采集、编码、网络、播放四块固定区域，
+// 每轮交互的大缓冲区用 VoiceArenaLease 在对应区域里顺序分配，租约结束时退回到租约开始时的位置，
+// 不再每轮 ps_malloc/free 几百 KB，PSRAM 堆不会随使用时间碎片化。
+// 区域正被其他任务占用、放不下或开机预留失败时回退到堆（计入 fallbacks），行为与原来相同。
+enum class VoiceArenaRegion : uint8_t
+{
+  Capture,  // 录音 PCM
+  Encode,   // ASR 请求体（base64 直接写进 JSON）
+  Network,  // TTS 分段下载
+  Playback, // 本地 WAV、JSON 内嵌音频解码、流式播放块
+  Count
+};
+
+static const size_t kVoiceArenaRegionCount = static_cast<size_t>(VoiceArenaRegion::Count);
+
+struct VoiceArenaStats
+{
+  uint32_t turns;
+  uint32_t allocations;    // 从区域分配（含原地扩展）
+  uint32_t fallbacks;      // 回退到堆，累计
+  uint32_t turnFallbacks;  // 最近一轮的回退次数
+  size_t capacity[kVoiceArenaRegionCount];
+  size_t peak[kVoiceArenaRegionCount]; // 各区域开机以来的最高用量
+  // PSRAM 堆水位（字节）：最近一轮开始/结束时的空闲、轮内各检查点的最低空闲，
+  // 以及开机以来的最低空闲在这一轮前后的值。稳定状态下一轮交互不应让后者下降
+  uint32_t turnStartFree;
+  uint32_t turnEndFree;
+  uint32_t turnLowestFree;
+  uint32_t bootMinFreeBefore;
+  uint32_t bootMinFreeAfter;
+};
+
+// 开机时尽早调用（在其他大块 PSRAM 分配之前），区域按 VOICE_ARENA_*_BYTES 预留
+bool voiceArenaBegin();
+// 语音任务在一轮交互前后调用，结束时打印本轮水位
+void voiceArenaBeginTurn();
+void voiceArenaEndTurn();
+VoiceArenaStats voiceArenaStats();
+void voiceArenaReportStats();
+
+// 区域租约：构造时为当前任务占用区域（同一任务可嵌套），析构时释放本租约分配的全部内存。
+// 只在创建它的任务上使用，分配的缓冲区不能活得比租约长。
+class VoiceArenaLease
+{
+public:
+  explicit VoiceArenaLease(VoiceArenaRegion region);
+  ~VoiceArenaLease();
+
+  uint8_t *alloc(size_t size);
+  // 把 buffer（本租约分配的）扩到 newSize，保留前 used 字节；是本租约最后一次分配时原地扩展。
+  // 失败返回 nullptr，原缓冲区仍然有效
+  uint8_t *grow(uint8_t *buffer, size_t used, size_t newSize);
+
+private:
+  VoiceArenaLease(const VoiceArenaLease &);
+  VoiceArenaLease &operator=(const VoiceArenaLease &);
+
+  uint8_t *heapAlloc(size_t size);
+  bool releaseHeap(uint8_t *buffer);
+
+  static const size_t kMaxHeapBlocks = 4;
+
+  VoiceArenaRegion region_;
+  bool owned_;
+  size_t startOffset_;
+  uint8_t *last_;
+  void *heapBlocks_[kMaxHeapBlocks];
+  size_t heapCount_;
+};
+
+#endif // VOICE_ARENA_H
@@ -0,0 +1,46 @@
+#ifndef WIRE_BODY_H
+#define WIRE_BODY_H
+
+#include <ArduinoJson.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+// 请求体编码：JSON 文本或 MessagePack 字节，按 measureJson/measureMsgPack 的长度写进一块字节缓冲区。
+// MessagePack 几乎总带 0x00（0 和小整数的 uint8/16/32、str16 长度头、double 的字节、bin 内容），
+// 不能写进 Arduino String —— String 写入器按 C 字符串 concat，遇到第一个 0x00 就截断。
+// 主机端往返测试见 tools/wire_body_check.cpp。
+class WireBody
+{
+public:
+  WireBody() : data_(nullptr), length_(0) {}
+  ~WireBody() { free(data_); }
+  WireBody(const WireBody &) = delete;
+  WireBody &operator=(const WireBody &) = delete;
+
+  // 返回 false 表示内存不足或写出长度与预估不符
+  bool encode(JsonVariantConst doc, bool msgpack)
+  {
+    free(data_);
+    data_ = nullptr;
+    length_ = 0;
+    size_t expected = msgpack ? measureMsgPack(doc) : measureJson(doc);
+    // 多留 1 字节：serializeJson 有余量时会写结尾 0，不计入长度
+    data_ = static_cast<uint8_t *>(malloc(expected + 1));
+    if (data_ == nullptr)
+    {
+      return false;
+    }
+    length_ = msgpack ? serializeMsgPack(doc, data_, expected + 1) : serializeJson(doc, data_, expected + 1);
+    return length_ == expected;
+  }
+
+  const uint8_t *data() const { return data_; }
+  size_t length() const { return length_; }
+
+private:
+  uint8_t *data_;
+  size_t length_;
+};
+
+#endif // WIRE_BODY_H
@@ -1,5 +1,10 @@
 #include "voice.h"
+#include "audio/audio_cache.h"
 #include "audio/local_audio.h"
+#include "audio/wait_prompt.h"
+#include "services/secure_conn.h"
+#include "utils/latency_trace.h"
+#include "utils/voice_arena.h"
 #include "esp_heap_caps.h"
 #include <Preferences.h>
 #include <stdlib.h>
@@ -45,6 +50,8 @@ const i2s_pin_config_t i2sOut_pin_config = {
 static uint32_t currentSpeakerSampleRate = 0;
 static uint16_t currentSpeakerChannels = 0;
 static const uint32_t kSpeakerDrainGuardMs = 40;
+// 每次请求停止播放递增；播放开始时记下当前值，写 I2S 的循环里发现变化即提前结束
+static volatile uint32_t playbackStopGeneration = 0;
 
 // 初始化I2S
 void set_i2s()
@@ -151,8 +158,9 @@ static void playAudioStable(uint8_t *audioData, size_t audioDataSize)
   }
 
   constexpr size_t kI2sWriteChunkBytes = 2048;
+  uint32_t stopGeneration = playbackStopGeneration;
   size_t totalWritten = 0;
-  while (totalWritten < audioDataSize)
+  while (totalWritten < audioDataSize && stopGeneration == playbackStopGeneration)
   {
     size_t chunkSize = audioDataSize - totalWritten;
     if (chunkSize > kI2sWriteChunkBytes)
@@ -241,6 +249,11 @@ static void waitForSpeakerDrain(uint32_t playbackSampleRate)
   vTaskDelay(pdMS_TO_TICKS(kSpeakerDrainGuardMs));
 }
 
+void requestPlaybackStop()
+{
+  ++playbackStopGeneration;
+}
+
 void clearAudio(void)
 {
   // 清空I2S DMA缓冲区
@@ -258,6 +271,9 @@ struct WavPlaybackInfo
 
 static bool configureSpeakerSampleRate(uint32_t sampleRate, uint16_t channels)
 {
+  // 所有播放都从这里开始：语音任务的回复就绪时，中止仍在播放的“请稍等”并等它让出扬声器
+  waitPromptYield();
+
   const uint32_t targetSampleRate = sampleRate > 0 ? sampleRate : SAMPLE_RATE;
   const uint16_t targetChannels = 1;
   (void)channels;
@@ -281,7 +297,8 @@ static bool configureSpeakerSampleRate(uint32_t sampleRate, uint16_t channels)
   return true;
 }
 
-static bool downloadHttpBody(HTTPClient &http, uint8_t **outBuffer, size_t *outLength)
+// 缓冲区从 lease 分配（网络区），随租约结束一起回收，调用方不 free
+static bool downloadHttpBody(HTTPClient &http, VoiceArenaLease &lease, uint8_t **outBuffer, size_t *outLength)
 {
   if (outBuffer == nullptr || outLength == nullptr)
   {
@@ -300,12 +317,7 @@ static bool downloadHttpBody(HTTPClient &http, uint8_t **outBuffer, size_t *outL
   int expectedLength = http.getSize();
   int contentLength = expectedLength;
   size_t capacity = expectedLength > 0 ? static_cast<size_t>(expectedLength) : 4096;
-  uint8_t *buffer = static_cast<uint8_t *>(
-      heap_caps_malloc(capacity + 1, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT));
-  if (buffer == nullptr)
-  {
-    buffer = static_cast<uint8_t *>(heap_caps_malloc(capacity + 1, MALLOC_CAP_8BIT));
-  }
+  uint8_t *buffer = lease.alloc(capacity + 1);
   if (buffer == nullptr)
   {
     Serial.println("[语音合成] 错误: 无法分配音频下载缓冲区");
@@ -353,16 +365,10 @@ static bool downloadHttpBody(HTTPClient &http, uint8_t **outBuffer, size_t *outL
       {
         newCapacity *= 2;
       }
-      uint8_t *newBuffer = static_cast<uint8_t *>(
-          heap_caps_realloc(buffer, newCapacity + 1, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT));
+      // 没有 Content-Length 时按倍数扩展；缓冲区是网络区最后一块时原地扩展，不拷贝
+      uint8_t *newBuffer = lease.grow(buffer, totalRead, newCapacity + 1);
       if (newBuffer == nullptr)
       {
-        newBuffer = static_cast<uint8_t *>(
-            heap_caps_realloc(buffer, newCapacity + 1, MALLOC_CAP_8BIT));
-      }
-      if (newBuffer == nullptr)
-      {
-        free(buffer);
         Serial.println("[语音合成] 错误: 扩展音频缓冲区失败");
         return false;
       }
@@ -387,14 +393,12 @@ static bool downloadHttpBody(HTTPClient &http, uint8_t **outBuffer, size_t *outL
 
   if (totalRead == 0)
   {
-    free(buffer);
     Serial.println("[语音合成] 错误: 未下载到任何音频数据");
     return false;
   }
 
   if (expectedLength > 0 && contentLength > 0)
   {
-    free(buffer);
     Serial.printf("[语音合成] 错误: TTS音频下载不完整，已读=%u，应读=%u，剩余=%d\n",
                   static_cast<unsigned>(totalRead),
                   static_cast<unsigned>(expectedLength),
@@ -794,20 +798,17 @@ static bool playPcmPayloadFromStream(Stream &stream, size_t payloadLength)
   }
 
   constexpr size_t kAudioChunkSize = 4096;
-  uint8_t *buffer = static_cast<uint8_t *>(
-      heap_caps_malloc(kAudioChunkSize, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT));
-  if (buffer == nullptr)
-  {
-    buffer = static_cast<uint8_t *>(heap_caps_malloc(kAudioChunkSize, MALLOC_CAP_8BIT));
-  }
+  VoiceArenaLease lease(VoiceArenaRegion::Playback);
+  uint8_t *buffer = lease.alloc(kAudioChunkSize);
   if (buffer == nullptr)
   {
     Serial.println("[LocalAudio] Failed to allocate stream playback buffer.");
     return false;
   }
 
+  uint32_t stopGeneration = playbackStopGeneration;
   size_t remaining = payloadLength;
-  while (remaining > 0)
+  while (remaining > 0 && stopGeneration == playbackStopGeneration)
   {
     size_t chunk = min(remaining, kAudioChunkSize);
     chunk &= ~static_cast<size_t>(0x01);
@@ -819,19 +820,16 @@ static bool playPcmPayloadFromStream(Stream &stream, size_t payloadLength)
     if (!readExact(stream, buffer, chunk))
     {
       Serial.println("[LocalAudio] Failed to read audio stream chunk.");
-      free(buffer);
       return false;
     }
 
     playAudio(buffer, chunk);
     remaining -= chunk;
   }
-
-  free(buffer);
   return true;
 }
 
-bool playAudioStream(Stream &audioStream, size_t audioLength)
+bool playAudioStreamAtRate(Stream &audioStream, size_t audioLength, uint32_t playbackSampleRate)
 {
   if (audioLength < 12)
   {
@@ -889,7 +887,7 @@ bool playAudioStream(Stream &audioStream, size_t audioLength)
                       static_cast<unsigned>(audioFormat),
                       static_cast<unsigned>(info.channels),
                       static_cast<unsigned>(info.bitsPerSample),
-                      static_cast<unsigned long>(LOCAL_AUDIO_PLAYBACK_SAMPLE_RATE));
+                      static_cast<unsigned long>(playbackSampleRate));
       }
 
       size_t rest = availableChunkSize > fmtRead ? availableChunkSize - fmtRead : 0;
@@ -918,7 +916,7 @@ bool playAudioStream(Stream &audioStream, size_t audioLength)
         return false;
       }
 
-      if (!configureSpeakerSampleRate(LOCAL_AUDIO_PLAYBACK_SAMPLE_RATE, 1))
+      if (!configureSpeakerSampleRate(playbackSampleRate, 1))
       {
         return false;
       }
@@ -927,7 +925,7 @@ bool playAudioStream(Stream &audioStream, size_t audioLength)
                     static_cast<unsigned>(info.payloadLength));
       clearAudio();
       bool ok = playPcmPayloadFromStream(audioStream, info.payloadLength);
-      waitForSpeakerDrain(LOCAL_AUDIO_PLAYBACK_SAMPLE_RATE);
+      waitForSpeakerDrain(playbackSampleRate);
       clearAudio();
       return ok;
     }
@@ -943,6 +941,11 @@ bool playAudioStream(Stream &audioStream, size_t audioLength)
   return false;
 }
 
+bool playAudioStream(Stream &audioStream, size_t audioLength)
+{
+  return playAudioStreamAtRate(audioStream, audioLength, LOCAL_AUDIO_PLAYBACK_SAMPLE_RATE);
+}
+
 static size_t findFirstBodyChar(const uint8_t *buffer, size_t bufferLength)
 {
   size_t offset = 0;
@@ -977,7 +980,81 @@ static bool bodyLooksLikeWav(const uint8_t *buffer, size_t bufferLength)
          memcmp(buffer + 8, "WAVE", 4) == 0;
 }
 
-static bool handleBaiduTtsJsonBody(uint8_t *responseBuffer, size_t responseLength)
+// TTS 缓存 key：发音人/语速/音调/音量/采样率参与种子，改参数后旧条目自然失效并被 LRU 淘汰
+static uint64_t ttsCacheKey(const String &text)
+{
+  int ttsPer = BAIDU_TTS_PER;
+  int ttsAue = BAIDU_TTS_AUE;
+#if BAIDU_TTS_FORCE_16K_WAV
+  ttsAue = 6;
+#endif
+
+  char params[96];
+  int paramsLength = snprintf(params,
+                              sizeof(params),
+                              "tts:per=%d;spd=%d;pit=%d;vol=%d;aue=%d;rate=%lu",
+                              ttsPer,
+                              BAIDU_TTS_SPD,
+                              BAIDU_TTS_PIT,
+                              BAIDU_TTS_VOL,
+                              ttsAue,
+                              static_cast<unsigned long>(BAIDU_TTS_PLAYBACK_SAMPLE_RATE));
+  uint64_t seed = audioCacheHash(params, static_cast<size_t>(paramsLength));
+  return audioCacheHash(text.c_str(), text.length(), seed);
+}
+
+static bool storeTtsCacheEntry(uint64_t cacheKey, const uint8_t *audio, size_t audioLength)
+{
+#if BAIDU_TTS_CACHE_ENABLED
+  if (cacheKey == 0 || !bodyLooksLikeWav(audio, audioLength))
+  {
+    return false;
+  }
+  if (audioCacheStore(cacheKey, audio, audioLength))
+  {
+    Serial.printf("[语音合成] 已缓存分段音频 %016llx，长度=%u\n",
+                  static_cast<unsigned long long>(cacheKey),
+                  static_cast<unsigned>(audioLength));
+    return true;
+  }
+  return false;
+#else
+  (void)cacheKey;
+  (void)audio;
+  (void)audioLength;
+  return false;
+#endif
+}
+
+// prefetchBytes 非空时为预取：只写缓存不播放，写入的字节数通过它返回
+static bool playOrCacheTtsAudio(uint8_t *audio, size_t audioLength, uint64_t cacheKey, size_t *prefetchBytes)
+{
+  if (prefetchBytes != nullptr)
+  {
+    if (!storeTtsCacheEntry(cacheKey, audio, audioLength))
+    {
+      return false;
+    }
+    *prefetchBytes = audioLength;
+    return true;
+  }
+
+  bool ok;
+  {
+    TRACE_SPAN(TracePlayback);
+    ok = playAudioBuffer(audio, audioLength);
+  }
+  if (ok)
+  {
+    storeTtsCacheEntry(cacheKey, audio, audioLength);
+  }
+  return ok;
+}
+
+static bool handleBaiduTtsJsonBody(uint8_t *responseBuffer,
+                                   size_t responseLength,
+                                   uint64_t cacheKey = 0,
+                                   size_t *prefetchBytes = nullptr)
 {
   if (responseBuffer == nullptr || responseLength == 0)
   {
@@ -1012,11 +1089,8 @@ static bool handleBaiduTtsJsonBody(uint8_t *responseBuffer, size_t responseLengt
   unsigned int decodedLength = decode_base64_length(
       reinterpret_cast<const unsigned char *>(binary),
       binaryLength);
-  uint8_t *audioBuffer = static_cast<uint8_t *>(ps_malloc(decodedLength));
-  if (audioBuffer == nullptr)
-  {
-    audioBuffer = static_cast<uint8_t *>(malloc(decodedLength));
-  }
+  VoiceArenaLease lease(VoiceArenaRegion::Playback);
+  uint8_t *audioBuffer = lease.alloc(decodedLength);
   if (audioBuffer == nullptr)
   {
     Serial.println("[语音合成] 错误: 无法为binary音频分配缓冲区");
@@ -1031,9 +1105,7 @@ static bool handleBaiduTtsJsonBody(uint8_t *responseBuffer, size_t responseLengt
   Serial.printf("[语音合成] 已从JSON binary解码音频，长度=%u\n",
                 static_cast<unsigned>(actualLength));
 
-  bool ok = playAudioBuffer(audioBuffer, actualLength);
-  free(audioBuffer);
-  return ok;
+  return playOrCacheTtsAudio(audioBuffer, actualLength, cacheKey, prefetchBytes);
 }
 
 static void printBodyPreview(const uint8_t *buffer, size_t bufferLength)
@@ -1335,12 +1407,6 @@ String getAccessToken_baidu()
     return "";
   }
 
-  WiFiClientSecure client;
-  client.setInsecure();
-  client.setTimeout(BAIDU_TOKEN_CLIENT_TIMEOUT_SEC);
-  client.setHandshakeTimeout(BAIDU_HTTPS_HANDSHAKE_TIMEOUT_SEC);
-
-  HTTPClient https;
   IPAddress resolvedIp;
   const char *baiduHost = "aip.baidubce.com";
   String accessToken = "";
@@ -1373,7 +1439,18 @@ String getAccessToken_baidu()
     return "";
   }
 
-  if (!https.begin(client, targetUrl))
+  // 连接先于 HTTPClient 构造：HTTPClient 析构时还会 stop 它
+  SecureConnLease lease(baiduHost, 443, BAIDU_HTTPS_HANDSHAKE_TIMEOUT_SEC * 1000UL);
+  WiFiClient *client = lease.client();
+  if (client == nullptr)
+  {
+    Serial.println("[voice] token TLS connect failed");
+    return "";
+  }
+  client->setTimeout(BAIDU_TOKEN_CLIENT_TIMEOUT_SEC);
+
+  HTTPClient https;
+  if (!https.begin(*client, targetUrl))
   {
     Serial.println("[voice] HTTPClient begin failed");
     return "";
@@ -1441,7 +1518,7 @@ String getAccessToken_baidu()
   return accessToken;
 }
 
-String waitForAccessToken_baidu()
+String loadCachedAccessToken_baidu()
 {
   String cachedToken = loadBaiduAccessTokenCache();
   if (cachedToken.length() > 0)
@@ -1456,6 +1533,16 @@ String waitForAccessToken_baidu()
     Serial.println("[voice] Baidu token loaded from config seed and persisted to NVS");
     return seedToken;
   }
+  return "";
+}
+
+String waitForAccessToken_baidu()
+{
+  String cachedToken = loadCachedAccessToken_baidu();
+  if (cachedToken.length() > 0)
+  {
+    return cachedToken;
+  }
 
   uint32_t attempt = 0;
 
@@ -1482,8 +1569,44 @@ String waitForAccessToken_baidu()
   }
 }
 
+bool baiduTokenNeedsRefresh(const String &token)
+{
+  uint64_t now = getCurrentUnixTime();
+  if (token.length() == 0 || now == 0)
+  {
+    // 系统时间未同步时无法判断，等 SNTP
+    return false;
+  }
+
+  uint64_t expiresAt = parseBaiduAccessTokenExpiresAt(token);
+  if (expiresAt == 0)
+  {
+    Preferences prefs;
+    if (prefs.begin("baidu_token", true))
+    {
+      if (prefs.getString("access", "") == token)
+      {
+        expiresAt = parseUint64String(prefs.getString("expires_at", ""));
+      }
+      prefs.end();
+    }
+  }
+  return expiresAt != 0 && now + BAIDU_TOKEN_REFRESH_MARGIN_SEC >= expiresAt;
+}
+
+String refreshAccessToken_baidu()
+{
+  String token = getAccessToken_baidu();
+  if (token.length() > 0)
+  {
+    saveBaiduAccessTokenCache(token, 0);
+  }
+  return token;
+}
+
 String baidu_voice_recognition(String accessToken, uint8_t *audioData, int audioDataSize)
 {
+  TRACE_SPAN(TraceAsr);
   String recognizedText = "";
 
   if (accessToken == "")
@@ -1492,49 +1615,34 @@ String baidu_voice_recognition(String accessToken, uint8_t *audioData, int audio
     return recognizedText;
   }
 
-  // audio数据包许愿哦进行Base64编码，数据量会增大1/3
-  int audio_data_len = audioDataSize * sizeof(char) * 1.4;
-  unsigned char *audioDataBase64 = (unsigned char *)ps_malloc(audio_data_len);
-  if (!audioDataBase64)
-  {
-    Serial.println("Failed to allocate memory for audioDataBase64");
-    return recognizedText;
-  }
-
-  // json包大小，由于需要将audioData数据进行Base64的编码，数据量会增大1/3
-  int data_json_len = audioDataSize * sizeof(char) * 1.4;
-  char *data_json = (char *)ps_malloc(data_json_len);
+  // 请求体在编码区里一次拼好：JSON 外壳之后直接写 base64（数据量增大 1/3），
+  // 不再单独分配 base64 缓冲区，POST 时也不再复制成 String
+  size_t base64Length = encode_base64_length(static_cast<unsigned int>(audioDataSize));
+  size_t data_json_len = base64Length + accessToken.length() + 256;
+  VoiceArenaLease lease(VoiceArenaRegion::Encode);
+  char *data_json = reinterpret_cast<char *>(lease.alloc(data_json_len));
   if (!data_json)
   {
     Serial.println("Failed to allocate memory for data_json");
     return recognizedText;
   }
 
-  // Base64 encode audio data
-  encode_base64(audioData, audioDataSize, audioDataBase64);
-
-  memset(data_json, '\0', data_json_len);
-  strcat(data_json, "{");
-  strcat(data_json, "\"format\":\"pcm\",");
-  strcat(data_json, "\"rate\":16000,");
-  strcat(data_json, "\"dev_pid\":1537,");
-  strcat(data_json, "\"channel\":1,");
-  strcat(data_json, "\"cuid\":\"57722200\",");
-  strcat(data_json, "\"token\":\"");
-  strcat(data_json, accessToken.c_str());
-  strcat(data_json, "\",");
-  sprintf(data_json + strlen(data_json), "\"len\":%d,", audioDataSize);
-  strcat(data_json, "\"speech\":\"");
-  strcat(data_json, (const char *)audioDataBase64);
-  strcat(data_json, "\"");
-  strcat(data_json, "}");
+  int headerLength = snprintf(data_json, data_json_len,
+                              "{\"format\":\"pcm\",\"rate\":16000,\"dev_pid\":1537,\"channel\":1,"
+                              "\"cuid\":\"57722200\",\"token\":\"%s\",\"len\":%d,\"speech\":\"",
+                              accessToken.c_str(), audioDataSize);
+  size_t jsonLength = static_cast<size_t>(headerLength);
+  jsonLength += encode_base64(audioData, static_cast<unsigned int>(audioDataSize),
+                              reinterpret_cast<unsigned char *>(data_json + jsonLength));
+  memcpy(data_json + jsonLength, "\"}", 3);
+  jsonLength += 2;
 
   // 创建http请求
   HTTPClient http_client;
 
   http_client.begin("http://vop.baidu.com/server_api");
   http_client.addHeader("Content-Type", "application/json");
-  int httpCode = http_client.POST(data_json);
+  int httpCode = http_client.POST(reinterpret_cast<uint8_t *>(data_json), jsonLength);
 
   if (httpCode > 0)
   {
@@ -1579,17 +1687,6 @@ String baidu_voice_recognition(String accessToken, uint8_t *audioData, int audio
     Serial.printf("[HTTP] POST failed, error: %s\n", http_client.errorToString(httpCode).c_str());
   }
 
-  // 释放内存
-  if (audioDataBase64)
-  {
-    free(audioDataBase64);
-  }
-
-  if (data_json)
-  {
-    free(data_json);
-  }
-
   http_client.end();
 
   return recognizedText;
@@ -1605,7 +1702,12 @@ void playAudio_Zai(void)
 }
 
 
-static bool handleBaiduTtsHttpResponse(HTTPClient &http, int httpResponseCode, const char *transportName)
+static bool handleBaiduTtsHttpResponse(HTTPClient &http,
+                                       int httpResponseCode,
+                                       const char *transportName,
+                                       uint64_t cacheKey,
+                                       size_t *prefetchBytes,
+                                       uint64_t fetchStartUs)
 {
   Serial.printf("[语音合成][%s] HTTP状态码=%d\n", transportName, httpResponseCode);
 
@@ -1628,13 +1730,15 @@ static bool handleBaiduTtsHttpResponse(HTTPClient &http, int httpResponseCode, c
     return false;
   }
 
+  VoiceArenaLease lease(VoiceArenaRegion::Network);
   uint8_t *responseBuffer = nullptr;
   size_t responseLength = 0;
-  if (!downloadHttpBody(http, &responseBuffer, &responseLength))
+  if (!downloadHttpBody(http, lease, &responseBuffer, &responseLength))
   {
     Serial.printf("[voice][tts][%s] response body download failed\n", transportName);
     return false;
   }
+  traceRecord(TraceTtsFetch, fetchStartUs);
 
   Serial.printf("[voice][tts][%s] response bytes=%u\n",
                 transportName,
@@ -1643,12 +1747,12 @@ static bool handleBaiduTtsHttpResponse(HTTPClient &http, int httpResponseCode, c
 
   if (contentType.startsWith("audio") || bodyLooksLikeWav(responseBuffer, responseLength))
   {
-    handled = playAudioBuffer(responseBuffer, responseLength);
+    handled = playOrCacheTtsAudio(responseBuffer, responseLength, cacheKey, prefetchBytes);
   }
 
   if (!handled && (contentType.indexOf("json") >= 0 || bodyLooksLikeJson(responseBuffer, responseLength)))
   {
-    handled = handleBaiduTtsJsonBody(responseBuffer, responseLength);
+    handled = handleBaiduTtsJsonBody(responseBuffer, responseLength, cacheKey, prefetchBytes);
   }
 
   if (!handled)
@@ -1656,15 +1760,18 @@ static bool handleBaiduTtsHttpResponse(HTTPClient &http, int httpResponseCode, c
     Serial.printf("[voice][tts][%s] unhandled response body\n", transportName);
     printBodyPreview(responseBuffer, responseLength);
   }
-
-  free(responseBuffer);
   return handled;
 }
 
+// reusable 非空时请求 keep-alive，返回后表示连接可以留给下一段：
+// 响应按 Content-Length 完整读完、服务端没有要求关闭、连接里没有多余数据
 static bool postBaiduTtsRequest(WiFiClient &client,
                                 const String &url,
                                 const String &requestBody,
-                                const char *transportName)
+                                const char *transportName,
+                                uint64_t cacheKey,
+                                size_t *prefetchBytes,
+                                bool *reusable = nullptr)
 {
   HTTPClient http;
   if (!http.begin(client, url))
@@ -1673,10 +1780,13 @@ static bool postBaiduTtsRequest(WiFiClient &client,
     return false;
   }
 
-  const char *headerKeys[] = {"Content-Type"};
-  http.collectHeaders(headerKeys, 1);
-  http.setReuse(false);
-  http.addHeader("Connection", "close");
+  const char *headerKeys[] = {"Content-Type", "Connection"};
+  http.collectHeaders(headerKeys, 2);
+  http.setReuse(reusable != nullptr);
+  if (reusable == nullptr)
+  {
+    http.addHeader("Connection", "close");
+  }
   http.setFollowRedirects(HTTPC_FORCE_FOLLOW_REDIRECTS);
   http.setConnectTimeout(BAIDU_TOKEN_CONNECT_TIMEOUT_MS);
   http.setTimeout(BAIDU_TTS_HTTP_TIMEOUT_MS);
@@ -1688,12 +1798,65 @@ static bool postBaiduTtsRequest(WiFiClient &client,
                 transportName,
                 static_cast<unsigned>(requestBody.length()));
 
+  uint64_t fetchStartUs = traceNowUs();
   int httpResponseCode = http.POST(requestBody);
-  bool ok = handleBaiduTtsHttpResponse(http, httpResponseCode, transportName);
+  bool ok = handleBaiduTtsHttpResponse(http, httpResponseCode, transportName, cacheKey, prefetchBytes, fetchStartUs);
+  if (reusable != nullptr)
+  {
+    *reusable = ok && http.getSize() > 0 && !http.header("Connection").equalsIgnoreCase("close") &&
+                client.available() == 0;
+  }
   http.end();
   return ok;
 }
 
+// HTTP 失败而 HTTPS 成功过之后，后续分段先走 HTTPS（连接可以复用，也会在一轮开始时预热）
+static volatile bool ttsPreferHttps = false;
+
+static bool baiduTtsPostHttp(const String &requestBody, uint64_t cacheKey, size_t *prefetchBytes)
+{
+  WiFiClient plainClient;
+  plainClient.setTimeout((BAIDU_TTS_HTTP_TIMEOUT_MS + 999) / 1000);
+  return postBaiduTtsRequest(plainClient,
+                             "http://tsn.baidu.com/text2audio",
+                             requestBody,
+                             "http",
+                             cacheKey,
+                             prefetchBytes);
+}
+
+static bool baiduTtsPostHttps(const String &requestBody, uint64_t cacheKey, size_t *prefetchBytes)
+{
+  // 语音交互进行中用保温连接（SECURE_CONN_WARM_HOST 即 tsn.baidu.com），被占用时临时建连，都带缓存会话
+  SecureConnLease lease(SECURE_CONN_WARM_HOST, 443, BAIDU_HTTPS_HANDSHAKE_TIMEOUT_SEC * 1000UL);
+  WiFiClient *client = lease.client();
+  if (client == nullptr)
+  {
+    Serial.println("[语音合成][https] TLS连接失败");
+    return false;
+  }
+  client->setTimeout((BAIDU_TTS_HTTP_TIMEOUT_MS + 999) / 1000);
+
+  bool reusable = false;
+  bool ok = postBaiduTtsRequest(*client,
+                                "https://tsn.baidu.com/text2audio",
+                                requestBody,
+                                "https",
+                                cacheKey,
+                                prefetchBytes,
+                                lease.warm() ? &reusable : nullptr);
+  if (reusable)
+  {
+    lease.setReusable();
+  }
+  return ok;
+}
+
+bool baiduTtsPrefersHttps()
+{
+  return ttsPreferHttps;
+}
+
 static int utf8SafeEnd(const String &text, int start, int limit)
 {
   int end = min(limit, static_cast<int>(text.length()));
@@ -1802,56 +1965,77 @@ static int buildTtsSegments(const String &text, String *segments, int maxSegment
   return count;
 }
 
-static bool baiduTtsSendSingleSegment(const String &access_token, const String &text)
+// 单段请求：先走 HTTP，失败回退 HTTPS（HTTP 不通过后反过来）；prefetchBytes 含义同 playOrCacheTtsAudio
+static bool baiduTtsRequestSegment(const String &access_token,
+                                   const String &text,
+                                   uint64_t cacheKey,
+                                   size_t *prefetchBytes)
 {
   if (access_token == "")
   {
     Serial.println("access_token is null");
     return false;
   }
+  String requestBody = buildBaiduTtsRequestBody(access_token, text);
 
-  if (text.length() == 0)
+  Serial.printf("[语音合成] 分段文本: %s\n", text.c_str());
+  if (ttsPreferHttps)
   {
-    Serial.println("text is null");
+    if (baiduTtsPostHttps(requestBody, cacheKey, prefetchBytes))
+    {
+      return true;
+    }
+    Serial.println("[语音合成] HTTPS失败，回退到HTTP");
+    if (baiduTtsPostHttp(requestBody, cacheKey, prefetchBytes))
+    {
+      ttsPreferHttps = false;
+      return true;
+    }
     return false;
   }
-  String requestBody = buildBaiduTtsRequestBody(access_token, text);
 
-  Serial.printf("[语音合成] 分段文本: %s\n", text.c_str());
-  WiFiClient plainClient;
-  plainClient.setTimeout((BAIDU_TTS_HTTP_TIMEOUT_MS + 999) / 1000);
-  if (postBaiduTtsRequest(plainClient,
-                          "http://tsn.baidu.com/text2audio",
-                          requestBody,
-                          "http"))
+  if (baiduTtsPostHttp(requestBody, cacheKey, prefetchBytes))
   {
     return true;
   }
 
   Serial.println("[语音合成] HTTP失败，回退到HTTPS");
-  WiFiClientSecure secureClient;
-  secureClient.setInsecure();
-  secureClient.setTimeout((BAIDU_TTS_HTTP_TIMEOUT_MS + 999) / 1000);
-  secureClient.setHandshakeTimeout(BAIDU_HTTPS_HANDSHAKE_TIMEOUT_SEC);
-  if (postBaiduTtsRequest(secureClient,
-                          "https://tsn.baidu.com/text2audio",
-                          requestBody,
-                          "https"))
+  if (baiduTtsPostHttps(requestBody, cacheKey, prefetchBytes))
   {
+    ttsPreferHttps = true;
     return true;
   }
 
   return false;
 }
 
-bool baiduTTS_Send(String access_token, String text)
+static bool baiduTtsSendSingleSegment(const String &access_token, const String &text)
 {
-  if (access_token == "")
+  if (text.length() == 0)
   {
-    Serial.println("access_token is null");
+    Serial.println("text is null");
     return false;
   }
 
+  uint64_t cacheKey = 0;
+#if BAIDU_TTS_CACHE_ENABLED
+  cacheKey = ttsCacheKey(text);
+  uint64_t playbackStartUs = traceNowUs();
+  if (audioCachePlay(cacheKey, BAIDU_TTS_PLAYBACK_SAMPLE_RATE))
+  {
+    traceRecord(TracePlayback, playbackStartUs);
+    Serial.printf("[语音合成] 缓存命中: %s\n", text.c_str());
+    return true;
+  }
+#endif
+
+  return baiduTtsRequestSegment(access_token, text, cacheKey, nullptr);
+}
+
+bool baiduTTS_Send(String access_token, String text)
+{
+  TRACE_SPAN(TraceTts);
+  // access_token 为空时仍尝试逐段命中本地缓存，未命中的段在单段发送时报错
   text.trim();
   if (text.length() == 0)
   {
@@ -1868,8 +2052,14 @@ bool baiduTTS_Send(String access_token, String text)
   }
 
   Serial.printf("[语音合成] 文本分为 %d 段\n", segmentCount);
+  uint32_t stopGeneration = playbackStopGeneration;
   for (int i = 0; i < segmentCount; ++i)
   {
+    if (stopGeneration != playbackStopGeneration)
+    {
+      Serial.printf("[语音合成] 播放被中止，跳过剩余 %d 段\n", segmentCount - i);
+      return true;
+    }
     Serial.printf("[语音合成] 播放第 %d/%d 段\n", i + 1, segmentCount);
     if (!baiduTtsSendSingleSegment(access_token, segments[i]))
     {
@@ -1883,3 +2073,47 @@ bool baiduTTS_Send(String access_token, String text)
 
   return true;
 }
+
+bool baiduTTS_Prefetch(String access_token, String text, size_t *bytesCached)
+{
+  // 与 baiduTTS_Send 相同的分段与缓存 key，播放时逐段命中
+  if (bytesCached != nullptr)
+  {
+    *bytesCached = 0;
+  }
+#if BAIDU_TTS_CACHE_ENABLED
+  text.trim();
+  constexpr int kMaxTtsSegments = 8;
+  String segments[kMaxTtsSegments];
+  int segmentCount = buildTtsSegments(text, segments, kMaxTtsSegments);
+  if (segmentCount <= 0)
+  {
+    return false;
+  }
+
+  for (int i = 0; i < segmentCount; ++i)
+  {
+    uint64_t cacheKey = ttsCacheKey(segments[i]);
+    AudioCacheInfo info;
+    if (audioCacheLookup(cacheKey, &info))
+    {
+      continue;
+    }
+    size_t stored = 0;
+    if (!baiduTtsRequestSegment(access_token, segments[i], cacheKey, &stored))
+    {
+      Serial.printf("[语音合成] 预取第 %d/%d 段失败\n", i + 1, segmentCount);
+      return false;
+    }
+    if (bytesCached != nullptr)
+    {
+      *bytesCached += stored;
+    }
+  }
+  return true;
+#else
+  (void)access_token;
+  (void)text;
+  return false;
+#endif
+}
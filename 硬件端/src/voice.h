@@ -14,10 +14,23 @@
 void set_i2s();
 String getAccessToken_baidu();
 String waitForAccessToken_baidu();
+// NVS 缓存或配置种子中未过期的 Token，都没有时返回空串，不联网
+String loadCachedAccessToken_baidu();
+// Token 将在 BAIDU_TOKEN_REFRESH_MARGIN_SEC 内过期；系统时间未同步或过期时间未知时返回 false
+bool baiduTokenNeedsRefresh(const String &token);
+// 联网获取一次新 Token 并写入 NVS，失败返回空串
+String refreshAccessToken_baidu();
 String baidu_voice_recognition(String accessToken, uint8_t *audioData, int audioDataSize);
 bool baiduTTS_Send(String access_token, String text);
+// 只合成写入 TTS 缓存不播放，已缓存的分段跳过；bytesCached 返回新写入的字节数
+bool baiduTTS_Prefetch(String access_token, String text, size_t *bytesCached = nullptr);
+// HTTP 合成失败、HTTPS 成功后为真：后续合成先走 HTTPS，语音任务据此在一轮开始时预热 TLS 连接
+bool baiduTtsPrefersHttps();
 bool playAudioBuffer(uint8_t *audioBuffer, size_t audioLength);
 bool playLocalAudioBuffer(uint8_t *audioBuffer, size_t audioLength);
 bool playAudioStream(Stream &audioStream, size_t audioLength);
+bool playAudioStreamAtRate(Stream &audioStream, size_t audioLength, uint32_t playbackSampleRate);
+// 中止正在进行的播放（当前 I2S 分块写完即停，多段 TTS 不再播后续段），之后开始的播放不受影响
+void requestPlaybackStop();
 
 #endif // VOICE_H
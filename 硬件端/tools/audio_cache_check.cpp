@@ -0,0 +1,561 @@
+// Host check for the LittleFS audio cache (src/audio/audio_cache.cpp) and the
+// streaming audio_url fetch that fills it (src/audio/remote_audio.cpp).
+//
+// Both sources are compiled unchanged against the Arduino/LittleFS/HTTPClient
+// stand-ins in tools/host_shims: LittleFS is a temporary host directory and
+// HTTPClient is a plain HTTP/1.0 client. The server is an in-process stand-in
+// for GET /audio/<file> (web/routes/audio_routes.py): it serves WAV bodies with a
+// quoted ETag and answers 304 when If-None-Match matches, the way Flask's
+// send_from_directory(conditional=True, etag=True) does. Playback is a stub that
+// reads the stream and keeps the bytes, so every check compares what would have
+// reached I2S with what the server sent.
+//
+// Scenarios: 64-bit FNV-1a key (reference vectors, seed chaining, relative and
+// absolute URLs map to one entry), cold fetch streams and caches the body, 304
+// revalidation plays the cached copy, a changed ETag replaces the entry, trailing
+// chunks after the data the player reads are still drained into the cache,
+// entries without an ETag are replayed without a request, offline/5xx fall back
+// to the cached copy, the .tmp -> .wav rename is the only way an entry appears,
+// the index file survives a reboot (stale .tmp and orphan files are removed,
+// size mismatches and a corrupt index are dropped), and LRU eviction order under
+// the byte budget and the entry limit, before and after a reboot.
+//
+/*
+ *   g++ -std=c++17 -O2 -Wall -Itools/host_shims tools/audio_cache_check.cpp -o audio_cache_check -lpthread
+ *   ./audio_cache_check
+ */
+
+#include <Arduino.h>
+
+#include <poll.h>
+#include <stdlib.h>
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 64 KiB 预算：几个 16 KiB 条目就能覆盖淘汰顺序
+#define AUDIO_CACHE_BUDGET_BYTES (64UL * 1024UL)
+// 相对 audio_url 拼到替身服务器上，端口在运行时才知道
+const char *standInBaseUrl();
+#define SERVER_BASE_URL standInBaseUrl()
+
+// voice.h 会拉进 I2S、ArduinoJson 等设备头文件；这里只需要播放函数，声明后由下面的桩实现
+#define VOICE_H
+bool playAudioStream(Stream &audioStream, size_t audioLength);
+bool playAudioStreamAtRate(Stream &audioStream, size_t audioLength, uint32_t playbackSampleRate);
+
+#include "../src/audio/audio_cache.cpp"
+#include "../src/audio/remote_audio.cpp"
+
+namespace
+{
+int failures = 0;
+
+void expect(bool condition, const char *what)
+{
+  if (!condition)
+  {
+    ++failures;
+    printf("  FAIL: %s\n", what);
+  }
+}
+
+// ---- playback stub ----
+
+std::string played;
+size_t playerReadLimit = SIZE_MAX; // 模拟只读到 data 块结尾就停的播放器
+int playCount = 0;
+
+bool playInto(Stream &audioStream, size_t audioLength)
+{
+  ++playCount;
+  played.clear();
+  size_t want = min(audioLength, playerReadLimit);
+  char buffer[512];
+  while (played.size() < want)
+  {
+    size_t n = audioStream.readBytes(buffer, min(sizeof(buffer), want - played.size()));
+    if (n == 0)
+    {
+      break;
+    }
+    played.append(buffer, n);
+  }
+  return audioLength == kUnknownAudioLength || played.size() == want;
+}
+
+// ---- stand-in server ----
+
+struct Asset
+{
+  std::string body;
+  std::string etag; // 空串表示不带 ETag
+  int forceStatus = 0;
+};
+
+struct Request
+{
+  std::string path;
+  std::string ifNoneMatch;
+  std::string deviceId;
+  int status;
+};
+
+class StandInServer
+{
+public:
+  bool start()
+  {
+    listenFd_ = socket(AF_INET, SOCK_STREAM, 0);
+    int one = 1;
+    setsockopt(listenFd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    if (bind(listenFd_, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0 || listen(listenFd_, 8) != 0)
+    {
+      return false;
+    }
+    socklen_t len = sizeof(addr);
+    getsockname(listenFd_, reinterpret_cast<sockaddr *>(&addr), &len);
+    snprintf(baseUrl_, sizeof(baseUrl_), "http://127.0.0.1:%u", ntohs(addr.sin_port));
+    acceptThread_ = std::thread([this] { acceptLoop(); });
+    return true;
+  }
+
+  void stop()
+  {
+    stopping_ = true;
+    acceptThread_.join();
+    close(listenFd_);
+  }
+
+  const char *baseUrl() const { return baseUrl_; }
+
+  void put(const std::string &name, const std::string &body, const std::string &etag, int forceStatus = 0)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    assets_[name] = Asset{body, etag, forceStatus};
+  }
+
+  std::vector<Request> requests()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return requests_;
+  }
+
+private:
+  void acceptLoop()
+  {
+    while (!stopping_)
+    {
+      pollfd pfd = {listenFd_, POLLIN, 0};
+      if (poll(&pfd, 1, 20) <= 0)
+      {
+        continue;
+      }
+      int fd = accept(listenFd_, nullptr, nullptr);
+      if (fd >= 0)
+      {
+        serve(fd);
+        close(fd);
+      }
+    }
+  }
+
+  static std::string headerValue(const std::string &head, const char *name)
+  {
+    std::string key = std::string("\r\n") + name + ": ";
+    size_t at = head.find(key);
+    if (at == std::string::npos)
+    {
+      return "";
+    }
+    at += key.size();
+    return head.substr(at, head.find("\r\n", at) - at);
+  }
+
+  void serve(int fd)
+  {
+    std::string head;
+    char c;
+    while (head.size() < 4096 && recv(fd, &c, 1, 0) == 1)
+    {
+      head.push_back(c);
+      if (head.size() >= 4 && head.compare(head.size() - 4, 4, "\r\n\r\n") == 0)
+      {
+        break;
+      }
+    }
+    size_t pathStart = head.find(' ') + 1;
+    Request request;
+    request.path = head.substr(pathStart, head.find(' ', pathStart) - pathStart);
+    request.ifNoneMatch = headerValue(head, "If-None-Match");
+    request.deviceId = headerValue(head, "X-Device-ID");
+
+    std::string response;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto found = request.path.compare(0, 7, "/audio/") == 0 ? assets_.find(request.path.substr(7)) : assets_.end();
+      if (found == assets_.end())
+      {
+        request.status = 404;
+        response = "HTTP/1.0 404 NOT FOUND\r\nContent-Length: 0\r\n\r\n";
+      }
+      else if (found->second.forceStatus != 0)
+      {
+        request.status = found->second.forceStatus;
+        response = "HTTP/1.0 " + std::to_string(request.status) + " ERROR\r\nContent-Length: 0\r\n\r\n";
+      }
+      else if (!found->second.etag.empty() && request.ifNoneMatch == found->second.etag)
+      {
+        request.status = 304;
+        response = "HTTP/1.0 304 NOT MODIFIED\r\nETag: " + found->second.etag + "\r\n\r\n";
+      }
+      else
+      {
+        request.status = 200;
+        response = "HTTP/1.0 200 OK\r\nContent-Type: audio/wav\r\nContent-Length: " +
+                   std::to_string(found->second.body.size()) + "\r\n";
+        if (!found->second.etag.empty())
+        {
+          response += "ETag: " + found->second.etag + "\r\n";
+        }
+        response += "\r\n" + found->second.body;
+      }
+      requests_.push_back(request);
+    }
+    send(fd, response.data(), response.size(), MSG_NOSIGNAL);
+  }
+
+  int listenFd_ = -1;
+  char baseUrl_[40] = {0};
+  std::atomic<bool> stopping_{false};
+  std::thread acceptThread_;
+  std::mutex mutex_;
+  std::map<std::string, Asset> assets_;
+  std::vector<Request> requests_;
+};
+
+StandInServer server;
+
+// ---- helpers ----
+
+// 44 字节 WAV 头 + 按 seed 变化的样本；样本里有 0x00，写文件时不能按 C 字符串处理
+std::string makeWav(size_t size, uint8_t seed)
+{
+  std::string body(size, '\0');
+  memcpy(&body[0], "RIFF", 4);
+  memcpy(&body[8], "WAVEfmt ", 8);
+  for (size_t i = 44; i < size; ++i)
+  {
+    body[i] = static_cast<char>((i * 7 + seed) % 251 == 0 ? 0 : (i * 7 + seed) % 251);
+  }
+  return body;
+}
+
+uint64_t keyOf(const std::string &text)
+{
+  return audioCacheHash(text.data(), text.size());
+}
+
+uint64_t urlKey(const char *name)
+{
+  return keyOf(std::string(server.baseUrl()) + "/audio/" + name);
+}
+
+bool cacheFileExists(uint64_t key, const char *suffix)
+{
+  return LittleFS.exists(entryPath(key, suffix));
+}
+
+std::string cacheFileBody(uint64_t key)
+{
+  File file = LittleFS.open(entryPath(key, ".wav"), "r");
+  std::string body(file ? file.size() : 0, '\0');
+  if (file)
+  {
+    file.read(reinterpret_cast<uint8_t *>(&body[0]), body.size());
+  }
+  return body;
+}
+
+bool cached(uint64_t key, AudioCacheInfo *info = nullptr)
+{
+  AudioCacheInfo scratch;
+  return audioCacheLookup(key, info ? info : &scratch);
+}
+
+size_t tmpFileCount()
+{
+  size_t count = 0;
+  for (const auto &entry : std::filesystem::directory_iterator(LittleFS.hostPath(kCacheDir)))
+  {
+    count += entry.path().extension() == ".tmp";
+  }
+  return count;
+}
+
+// 模拟断电重启：内存里的索引全部丢掉，只剩 LittleFS 上的文件
+void reboot()
+{
+  cacheReady = false;
+  entryCount = 0;
+  totalBytes = 0;
+  useClock = 0;
+  pendingTouches = 0;
+  memset(entries, 0xA5, AUDIO_CACHE_MAX_ENTRIES * sizeof(CacheEntry));
+  audioCacheInit();
+}
+
+// 索引魔数写坏后重启，缓存从空开始（孤儿 .wav 每次启动最多清 8 个，反复启动到清完）
+void wipeCache()
+{
+  File index = LittleFS.open(kIndexPath, "w");
+  index.write(reinterpret_cast<const uint8_t *>("bad!"), 4);
+  index.close();
+  for (int i = 0; i < 64 && !std::filesystem::is_empty(LittleFS.hostPath(kCacheDir)); ++i)
+  {
+    reboot();
+    LittleFS.remove(kIndexPath);
+  }
+}
+
+bool store(uint64_t key, const std::string &body, const char *etag = "")
+{
+  return audioCacheStore(key, reinterpret_cast<const uint8_t *>(body.data()), body.size(), etag);
+}
+
+bool playCached(uint64_t key)
+{
+  return audioCachePlay(key);
+}
+} // namespace
+
+const char *standInBaseUrl()
+{
+  return server.baseUrl();
+}
+
+bool initLocalAudioStorage()
+{
+  return true;
+}
+
+bool playAudioStream(Stream &audioStream, size_t audioLength)
+{
+  return playInto(audioStream, audioLength);
+}
+
+bool playAudioStreamAtRate(Stream &audioStream, size_t audioLength, uint32_t)
+{
+  return playInto(audioStream, audioLength);
+}
+
+int main()
+{
+  char rootTemplate[] = "/tmp/audio_cache_check.XXXXXX";
+  const char *root = mkdtemp(rootTemplate);
+  if (root == nullptr || !server.start())
+  {
+    printf("setup failed\n");
+    return 1;
+  }
+  LittleFS.setHostRoot(root);
+
+  printf("1. FNV-1a key\n");
+  expect(audioCacheHash("", 0) == 0xcbf29ce484222325ULL, "empty input hashes to the offset basis");
+  expect(keyOf("a") == 0xaf63dc4c8601ec8cULL, "FNV-1a 64 vector \"a\"");
+  expect(keyOf("foobar") == 0x85944171f73967e8ULL, "FNV-1a 64 vector \"foobar\"");
+  expect(audioCacheHash("bar", 3, audioCacheHash("foo", 3)) == keyOf("foobar"), "seed chains like one long input");
+  expect(entryPath(0x00000000deadbeefULL, ".wav") == "/cache/00000000deadbeef.wav", "file name is 16 hex digits");
+
+  printf("2. init on an empty filesystem\n");
+  expect(audioCacheInit(), "init succeeds");
+  expect(LittleFS.exists(kCacheDir) && !LittleFS.exists(kIndexPath), "cache directory created, no index yet");
+
+  printf("3. cold fetch streams and caches the body\n");
+  std::string turnLeft = makeWav(6000, 1);
+  server.put("turn_left.wav", turnLeft, "\"v1\"");
+  uint64_t turnKey = urlKey("turn_left.wav");
+  expect(playRemoteAudioUrl("/audio/turn_left.wav"), "relative audio_url plays");
+  expect(played == turnLeft, "played bytes match the server body");
+  std::vector<Request> log = server.requests();
+  expect(log.size() == 1 && log[0].path == "/audio/turn_left.wav" && log[0].status == 200, "one GET");
+  expect(log.size() == 1 && log[0].ifNoneMatch.empty() && log[0].deviceId == DEVICE_ID,
+         "no If-None-Match on a miss, X-Device-ID sent");
+  AudioCacheInfo info = {};
+  expect(cached(turnKey, &info) && info.size == 6000 && strcmp(info.etag, "\"v1\"") == 0,
+         "entry keyed by the absolute URL, with size and ETag");
+  expect(cacheFileBody(turnKey) == turnLeft && !cacheFileExists(turnKey, ".tmp"), "payload committed, no .tmp left");
+  expect(LittleFS.exists(kIndexPath), "index written");
+
+  printf("4. ETag revalidation: 304 plays the cached copy\n");
+  played.clear();
+  expect(playRemoteAudioUrl(String(server.baseUrl()) + "/audio/turn_left.wav"), "absolute URL plays");
+  log = server.requests();
+  expect(log.size() == 2 && log[1].ifNoneMatch == "\"v1\"" && log[1].status == 304, "If-None-Match sent, 304 back");
+  expect(played == turnLeft, "cached copy played");
+
+  printf("5. changed ETag replaces the entry\n");
+  std::string turnLeft2 = makeWav(7000, 2);
+  server.put("turn_left.wav", turnLeft2, "\"v2\"");
+  expect(playRemoteAudioUrl("/audio/turn_left.wav"), "new version plays");
+  log = server.requests();
+  expect(log.size() == 3 && log[2].ifNoneMatch == "\"v1\"" && log[2].status == 200, "stale ETag gets a 200");
+  expect(played == turnLeft2, "new body played");
+  expect(cached(turnKey, &info) && info.size == 7000 && strcmp(info.etag, "\"v2\"") == 0, "entry updated");
+  expect(cacheFileBody(turnKey) == turnLeft2, "payload replaced");
+
+  printf("6. trailing chunks are drained into the cache\n");
+  std::string arrive = makeWav(5000, 3);
+  server.put("arrive.wav", arrive, "\"a1\"");
+  playerReadLimit = 4000;
+  expect(playRemoteAudioUrl("/audio/arrive.wav"), "player stops after the data chunk");
+  playerReadLimit = SIZE_MAX;
+  expect(played.size() == 4000, "player read 4000 bytes");
+  expect(cacheFileBody(urlKey("arrive.wav")) == arrive, "cache holds the whole 5000-byte file");
+
+  printf("7. entries without an ETag are replayed without a request\n");
+  std::string beep = makeWav(3000, 4);
+  server.put("beep.wav", beep, "");
+  expect(playRemoteAudioUrl("/audio/beep.wav"), "first play fetches");
+  size_t before = server.requests().size();
+  played.clear();
+  expect(playRemoteAudioUrl("/audio/beep.wav") && played == beep, "second play from cache");
+  expect(server.requests().size() == before, "no request for an immutable entry");
+
+  printf("8. offline and server errors fall back to the cached copy\n");
+  WiFi.setHostStatus(WL_DISCONNECTED);
+  before = server.requests().size();
+  played.clear();
+  expect(playRemoteAudioUrl("/audio/turn_left.wav") && played == turnLeft2, "offline plays the cached copy");
+  expect(!playRemoteAudioUrl("/audio/never_fetched.wav"), "offline miss fails");
+  expect(server.requests().size() == before, "offline makes no request");
+  WiFi.setHostStatus(WL_CONNECTED);
+  server.put("turn_left.wav", turnLeft2, "\"v3\"", 500);
+  played.clear();
+  expect(playRemoteAudioUrl("/audio/turn_left.wav") && played == turnLeft2, "5xx plays the cached copy");
+  expect(cached(turnKey, &info) && strcmp(info.etag, "\"v2\"") == 0, "5xx leaves the entry alone");
+  expect(!playRemoteAudioUrl("/audio/missing.wav"), "404 without a cached copy fails");
+  expect(!cached(urlKey("missing.wav")) && tmpFileCount() == 0, "404 leaves nothing behind");
+
+  printf("9. .tmp -> .wav rename is the only way an entry appears\n");
+  uint64_t writerKey = keyOf("writer");
+  std::string payload = makeWav(1000, 5);
+  {
+    AudioCacheWriter writer;
+    expect(writer.begin(writerKey, payload.size(), "\"w1\""), "begin");
+    expect(cacheFileExists(writerKey, ".tmp") && !cacheFileExists(writerKey, ".wav"), "writes go to .tmp");
+    writer.write(reinterpret_cast<const uint8_t *>(payload.data()), 600);
+    expect(!cached(writerKey), "not visible while writing");
+    expect(!writer.commit(), "short write does not commit");
+    expect(!cacheFileExists(writerKey, ".tmp") && !cached(writerKey), "short write removed");
+
+    expect(writer.begin(writerKey, payload.size(), "\"w1\""), "begin again");
+    writer.write(reinterpret_cast<const uint8_t *>(payload.data()), payload.size());
+    expect(!cached(writerKey), "complete but uncommitted is still invisible");
+    expect(writer.commit(), "commit");
+    expect(!cacheFileExists(writerKey, ".tmp") && cacheFileBody(writerKey) == payload, "renamed to .wav");
+    expect(cached(writerKey, &info) && strcmp(info.etag, "\"w1\"") == 0, "visible after commit");
+
+    uint64_t overKey = keyOf("over");
+    expect(writer.begin(overKey, 100, ""), "begin 100 bytes");
+    std::string tooLong(120, 'x');
+    expect(writer.write(reinterpret_cast<const uint8_t *>(tooLong.data()), tooLong.size()) == 0, "overrun refused");
+    expect(!writer.commit() && !cached(overKey), "overrun does not commit");
+
+    expect(writer.begin(overKey, 100, ""), "begin then abandon");
+  }
+  expect(tmpFileCount() == 0, "destructor removes the abandoned .tmp");
+  {
+    AudioCacheWriter writer;
+    expect(!writer.begin(keyOf("huge"), AUDIO_CACHE_BUDGET_BYTES / 2 + 1, ""), "over half the budget refused");
+  }
+  std::string longEtag(AUDIO_CACHE_ETAG_MAX, 'e');
+  expect(store(keyOf("long-etag"), payload, longEtag.c_str()) && cached(keyOf("long-etag"), &info) &&
+             info.etag[0] == '\0',
+         "ETag too long to send back is dropped");
+
+  printf("10. index survives a reboot\n");
+  File leftover = LittleFS.open("/cache/00000000deadbeef.tmp", "w");
+  leftover.write(reinterpret_cast<const uint8_t *>("partial"), 7);
+  leftover.close();
+  File orphan = LittleFS.open("/cache/0123456789abcdef.wav", "w");
+  orphan.write(reinterpret_cast<const uint8_t *>("orphan"), 6);
+  orphan.close();
+  reboot();
+  expect(cached(turnKey, &info) && info.size == 7000 && strcmp(info.etag, "\"v2\"") == 0, "entry reloaded with ETag");
+  expect(cached(urlKey("arrive.wav")) && cached(urlKey("beep.wav")) && cached(writerKey), "all entries reloaded");
+  expect(!LittleFS.exists("/cache/00000000deadbeef.tmp"), "stale .tmp removed at boot");
+  expect(!LittleFS.exists("/cache/0123456789abcdef.wav"), "orphan payload removed at boot");
+  server.put("turn_left.wav", turnLeft2, "\"v2\"");
+  before = server.requests().size();
+  expect(playRemoteAudioUrl("/audio/turn_left.wav") && played == turnLeft2, "plays after reboot");
+  log = server.requests();
+  expect(log.size() == before + 1 && log.back().status == 304, "reloaded ETag still revalidates with 304");
+
+  File truncated = LittleFS.open(entryPath(writerKey, ".wav"), "w");
+  truncated.write(reinterpret_cast<const uint8_t *>(payload.data()), 10);
+  truncated.close();
+  reboot();
+  expect(!cached(writerKey) && !cacheFileExists(writerKey, ".wav"), "size mismatch dropped and removed");
+  expect(cached(turnKey), "other entries kept");
+
+  wipeCache();
+  expect(!cached(turnKey) && !cacheFileExists(turnKey, ".wav"), "corrupt index starts empty, payloads removed");
+
+  printf("11. LRU eviction under the byte budget\n");
+  const size_t quarter = AUDIO_CACHE_BUDGET_BYTES / 4;
+  uint64_t a = keyOf("A"), b = keyOf("B"), c = keyOf("C"), d = keyOf("D"), e = keyOf("E"), f = keyOf("F");
+  uint64_t g = keyOf("G"), h = keyOf("H");
+  expect(store(a, makeWav(quarter, 10)) && store(b, makeWav(quarter, 11)) && store(c, makeWav(quarter, 12)) &&
+             store(d, makeWav(quarter, 13)),
+         "four quarter-budget entries fill the cache");
+  expect(totalBytes == AUDIO_CACHE_BUDGET_BYTES, "budget exactly used");
+  expect(playCached(a), "touch A");
+  expect(store(e, makeWav(quarter, 14)), "store E");
+  expect(!cached(b) && !cacheFileExists(b, ".wav"), "B (least recently used) evicted and its file removed");
+  expect(cached(a) && cached(c) && cached(d) && cached(e), "A kept because it was played");
+  expect(playCached(c), "touch C");
+  expect(store(f, makeWav(quarter, 15)), "store F");
+  expect(!cached(d) && cached(c), "D evicted next");
+  expect(store(g, makeWav(2 * quarter, 16)), "store half-budget G");
+  expect(!cached(a) && !cached(e) && cached(c) && cached(f) && cached(g), "A then E evicted for G");
+  expect(totalBytes <= AUDIO_CACHE_BUDGET_BYTES, "stays within budget");
+
+  reboot();
+  expect(store(h, makeWav(2 * quarter, 17)), "store H after a reboot");
+  expect(!cached(c) && !cached(f) && cached(g) && cached(h), "use order reloaded from the index: C, F evicted");
+
+  printf("12. LRU eviction at the entry limit\n");
+  wipeCache();
+  std::string small = makeWav(100, 20);
+  bool allStored = true;
+  for (int i = 0; i < AUDIO_CACHE_MAX_ENTRIES; ++i)
+  {
+    allStored = store(keyOf("n" + std::to_string(i)), small) && allStored;
+  }
+  expect(allStored && entryCount == AUDIO_CACHE_MAX_ENTRIES, "index full");
+  expect(playCached(keyOf("n0")), "touch the first entry");
+  expect(store(keyOf("extra"), small), "one more entry");
+  expect(entryCount == AUDIO_CACHE_MAX_ENTRIES && cached(keyOf("n0")) && !cached(keyOf("n1")),
+         "second entry (now least recently used) evicted");
+
+  printf("\ncache %u entries, %u/%lu bytes; server saw %zu requests\n", static_cast<unsigned>(entryCount),
+         static_cast<unsigned>(totalBytes), static_cast<unsigned long>(AUDIO_CACHE_BUDGET_BYTES),
+         server.requests().size());
+
+  server.stop();
+  std::filesystem::remove_all(root);
+  printf("%s (%d failures)\n", failures == 0 ? "OK" : "FAILED", failures);
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,377 @@
+// Host test and throughput benchmark for the base64 codec (src/base64.cpp).
+//
+// 1. RFC 4648 section 10 test vectors, one-shot and streaming.
+// 2. Byte-for-byte comparison with the previous byte-at-a-time implementation
+//    (binary_to_base64() per character) for every length 0..600, unaligned
+//    input/output pointers, all 256 character mappings, and decoding of
+//    strings cut short or followed by characters outside the alphabet.
+// 3. Streaming encoder fed random chunk sizes (0, 1, 2 bytes and larger),
+//    checking the sink sees the same text in buffer-sized pieces.
+// 4. MB/s for a 10 s 16 kHz / 16-bit recording (320 000 bytes, the ASR
+//    request body), old vs new, one-shot and streaming, encode and decode.
+//
+/*
+ *   g++ -std=c++17 -O2 -Wall tools/base64_bench.cpp -o base64_bench
+ *   ./base64_bench
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../src/base64.cpp"
+
+namespace
+{
+// 重写前的实现（逐字节经 binary_to_base64 / base64_to_binary），作为对照
+namespace legacy
+{
+unsigned char binary_to_base64(unsigned char v)
+{
+  if (v < 26) return v + 'A';
+  if (v < 52) return v + 71;
+  if (v < 62) return v - 4;
+  if (v == 62) return '+';
+  if (v == 63) return '/';
+  return 64;
+}
+
+unsigned char base64_to_binary(unsigned char c)
+{
+  if ('A' <= c && c <= 'Z') return c - 'A';
+  if ('a' <= c && c <= 'z') return c - 71;
+  if ('0' <= c && c <= '9') return c + 4;
+  if (c == '+') return 62;
+  if (c == '/') return 63;
+  return 255;
+}
+
+unsigned int decode_base64_length(const unsigned char input[], unsigned int input_length)
+{
+  const unsigned char *start = input;
+  while (base64_to_binary(input[0]) < 64 && (unsigned int)(input - start) < input_length)
+  {
+    ++input;
+  }
+  input_length = (unsigned int)(input - start);
+  return input_length / 4 * 3 + (input_length % 4 ? input_length % 4 - 1 : 0);
+}
+
+unsigned int encode_base64(const unsigned char input[], unsigned int input_length, unsigned char output[])
+{
+  unsigned int full_sets = input_length / 3;
+  for (unsigned int i = 0; i < full_sets; ++i)
+  {
+    output[0] = binary_to_base64(input[0] >> 2);
+    output[1] = binary_to_base64((input[0] & 0x03) << 4 | input[1] >> 4);
+    output[2] = binary_to_base64((input[1] & 0x0F) << 2 | input[2] >> 6);
+    output[3] = binary_to_base64(input[2] & 0x3F);
+    input += 3;
+    output += 4;
+  }
+  switch (input_length % 3)
+  {
+  case 0:
+    output[0] = '\0';
+    break;
+  case 1:
+    output[0] = binary_to_base64(input[0] >> 2);
+    output[1] = binary_to_base64((input[0] & 0x03) << 4);
+    output[2] = '=';
+    output[3] = '=';
+    output[4] = '\0';
+    break;
+  case 2:
+    output[0] = binary_to_base64(input[0] >> 2);
+    output[1] = binary_to_base64((input[0] & 0x03) << 4 | input[1] >> 4);
+    output[2] = binary_to_base64((input[1] & 0x0F) << 2);
+    output[3] = '=';
+    output[4] = '\0';
+    break;
+  }
+  return (input_length + 2) / 3 * 4;
+}
+
+unsigned int decode_base64(const unsigned char input[], unsigned int input_length, unsigned char output[])
+{
+  unsigned int output_length = decode_base64_length(input, input_length);
+  for (unsigned int i = 2; i < output_length; i += 3)
+  {
+    output[0] = base64_to_binary(input[0]) << 2 | base64_to_binary(input[1]) >> 4;
+    output[1] = base64_to_binary(input[1]) << 4 | base64_to_binary(input[2]) >> 2;
+    output[2] = base64_to_binary(input[2]) << 6 | base64_to_binary(input[3]);
+    input += 4;
+    output += 3;
+  }
+  switch (output_length % 3)
+  {
+  case 1:
+    output[0] = base64_to_binary(input[0]) << 2 | base64_to_binary(input[1]) >> 4;
+    break;
+  case 2:
+    output[0] = base64_to_binary(input[0]) << 2 | base64_to_binary(input[1]) >> 4;
+    output[1] = base64_to_binary(input[1]) << 4 | base64_to_binary(input[2]) >> 2;
+    break;
+  }
+  return output_length;
+}
+} // namespace legacy
+
+int failures = 0;
+
+void check(bool condition, const char *what)
+{
+  if (!condition)
+  {
+    printf("  FAIL %s\n", what);
+    ++failures;
+  }
+}
+
+const unsigned char *bytes(const std::string &s)
+{
+  return reinterpret_cast<const unsigned char *>(s.data());
+}
+
+struct Collected
+{
+  std::string text;
+  unsigned int calls = 0;
+  bool pieceSizesOk = true;
+};
+
+void collect(const char data[], unsigned int length, void *context)
+{
+  Collected *c = static_cast<Collected *>(context);
+  c->text.append(data, length);
+  c->calls++;
+  c->pieceSizesOk = c->pieceSizesOk && length > 0 && length <= BASE64_ENCODER_BUFFER;
+}
+
+std::string streamEncode(const unsigned char *data, size_t length, std::mt19937 &rng, Collected *out)
+{
+  base64_encoder encoder;
+  base64_encoder_init(&encoder, collect, out);
+  std::uniform_int_distribution<int> kind(0, 9);
+  size_t offset = 0;
+  while (offset < length)
+  {
+    int k = kind(rng);
+    size_t chunk = k < 3 ? static_cast<size_t>(k) : static_cast<size_t>(rng() % 700);
+    chunk = std::min(chunk, length - offset);
+    base64_encoder_update(&encoder, data + offset, static_cast<unsigned int>(chunk));
+    offset += chunk;
+  }
+  unsigned int total = base64_encoder_finish(&encoder);
+  check(total == out->text.size(), "finish returns the number of characters written");
+  return out->text;
+}
+
+void checkRfcVectors()
+{
+  const char *vectors[][2] = {
+      {"", ""},           {"f", "Zg=="},         {"fo", "Zm8="},         {"foo", "Zm9v"},
+      {"foob", "Zm9vYg=="}, {"fooba", "Zm9vYmE="}, {"foobar", "Zm9vYmFy"},
+  };
+  std::mt19937 rng(1);
+  for (const auto &v : vectors)
+  {
+    std::string plain = v[0];
+    unsigned char out[16];
+    memset(out, 0x55, sizeof(out));
+    unsigned int n = encode_base64(bytes(plain), static_cast<unsigned int>(plain.size()), out);
+    char what[64];
+    snprintf(what, sizeof(what), "RFC 4648 encode \"%s\"", v[0]);
+    check(n == strlen(v[1]) && strcmp(reinterpret_cast<char *>(out), v[1]) == 0, what);
+
+    Collected streamed;
+    snprintf(what, sizeof(what), "RFC 4648 stream \"%s\"", v[0]);
+    check(streamEncode(bytes(plain), plain.size(), rng, &streamed) == v[1], what);
+
+    unsigned char decoded[16];
+    unsigned int m = decode_base64(reinterpret_cast<const unsigned char *>(v[1]), decoded);
+    snprintf(what, sizeof(what), "RFC 4648 decode \"%s\"", v[1]);
+    check(m == plain.size() && memcmp(decoded, plain.data(), m) == 0, what);
+  }
+}
+
+void checkAgainstLegacy()
+{
+  for (unsigned int c = 0; c < 256; ++c)
+  {
+    check(binary_to_base64(c) == legacy::binary_to_base64(c), "binary_to_base64 matches");
+    check(base64_to_binary(c) == legacy::base64_to_binary(c), "base64_to_binary matches");
+  }
+
+  std::mt19937 rng(2);
+  std::vector<unsigned char> input(608);
+  std::vector<unsigned char> expected(1024);
+  std::vector<unsigned char> actual(1024);
+  std::vector<unsigned char> plain(1024);
+  std::vector<unsigned char> legacyPlain(1024);
+  bool encodeOk = true;
+  bool decodeOk = true;
+  bool streamOk = true;
+  bool piecesOk = true;
+  for (unsigned int length = 0; length <= 600; ++length)
+  {
+    unsigned int offset = length % 4; // 未对齐的输入/输出
+    for (unsigned int i = 0; i < length; ++i)
+    {
+      input[offset + i] = static_cast<unsigned char>(rng());
+    }
+    std::fill(expected.begin(), expected.end(), 0xAA);
+    std::fill(actual.begin(), actual.end(), 0xAA);
+    unsigned int a = legacy::encode_base64(input.data() + offset, length, expected.data());
+    unsigned int b = encode_base64(input.data() + offset, length, actual.data() + offset);
+    encodeOk = encodeOk && a == b && memcmp(expected.data(), actual.data() + offset, a + 1) == 0 &&
+               actual[offset + a + 1] == 0xAA;
+
+    unsigned int d = decode_base64(actual.data() + offset, b, plain.data());
+    decodeOk = decodeOk && d == length && memcmp(plain.data(), input.data() + offset, length) == 0;
+
+    Collected streamed;
+    std::string text = streamEncode(input.data() + offset, length, rng, &streamed);
+    streamOk = streamOk && text == reinterpret_cast<const char *>(expected.data());
+    piecesOk = piecesOk && streamed.pieceSizesOk;
+  }
+  check(encodeOk, "encode_base64 byte-identical to the old encoder, lengths 0..600, unaligned");
+  check(decodeOk, "decode_base64 round trip, lengths 0..600");
+  check(streamOk, "streaming encoder matches encode_base64 with random chunks");
+  check(piecesOk, "sink pieces are non-empty and at most BASE64_ENCODER_BUFFER");
+
+  // 截断、夹杂非字母表字符、padding 之后的内容：长度和解码结果都与原实现一致
+  const char *alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  const char *junk = "=\"}\r\n -_.*";
+  bool junkOk = true;
+  for (int trial = 0; trial < 5000; ++trial)
+  {
+    std::string s;
+    size_t n = rng() % 40;
+    for (size_t i = 0; i < n; ++i)
+    {
+      s += (rng() % 8 == 0) ? junk[rng() % strlen(junk)] : alphabet[rng() % 64];
+    }
+    unsigned int limit = (trial % 2) ? static_cast<unsigned int>(rng() % (n + 1)) : static_cast<unsigned int>(-1);
+    std::fill(plain.begin(), plain.end(), 0);
+    std::fill(legacyPlain.begin(), legacyPlain.end(), 0);
+    unsigned int a = legacy::decode_base64(bytes(s), limit, legacyPlain.data());
+    unsigned int b = decode_base64(bytes(s), limit, plain.data());
+    junkOk = junkOk && a == b && decode_base64_length(bytes(s), limit) == a &&
+             memcmp(plain.data(), legacyPlain.data(), 64) == 0;
+  }
+  check(junkOk, "decode matches the old decoder on truncated and junk-terminated input");
+
+  // 流式编码一个大缓冲，检查每次回调都是满缓冲（最后一次除外）
+  std::vector<unsigned char> big(100000);
+  for (auto &byte : big)
+  {
+    byte = static_cast<unsigned char>(rng());
+  }
+  Collected streamed;
+  base64_encoder encoder;
+  base64_encoder_init(&encoder, collect, &streamed);
+  for (size_t offset = 0; offset < big.size(); offset += 1000)
+  {
+    base64_encoder_update(&encoder, big.data() + offset, 1000);
+  }
+  base64_encoder_finish(&encoder);
+  unsigned int expectedCalls = (encode_base64_length(static_cast<unsigned int>(big.size())) + BASE64_ENCODER_BUFFER - 1) /
+                               BASE64_ENCODER_BUFFER;
+  check(streamed.calls == expectedCalls, "sink called once per full buffer");
+}
+
+template <typename F>
+double mbPerSecond(size_t bytesPerRun, F &&run)
+{
+  int runs = 0;
+  auto start = std::chrono::steady_clock::now();
+  double elapsed = 0;
+  do
+  {
+    run();
+    ++runs;
+    elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  } while (elapsed < 0.3);
+  return bytesPerRun * runs / elapsed / 1e6;
+}
+
+void nullSink(const char data[], unsigned int length, void *context)
+{
+  // 模拟写进发送缓冲区
+  std::vector<char> *out = static_cast<std::vector<char> *>(context);
+  memcpy(out->data(), data, length);
+}
+
+volatile unsigned char sinkHole;
+
+void benchmark()
+{
+  const size_t kRecording = 320000; // 10 s × 16 kHz × 16 bit
+  std::mt19937 rng(3);
+  std::vector<unsigned char> pcm(kRecording);
+  for (size_t i = 0; i < pcm.size(); ++i)
+  {
+    // 近似语音 PCM：低幅度正弦加噪声，按小端 int16 存放
+    pcm[i] = static_cast<unsigned char>((i & 1) ? (rng() % 7) : rng());
+  }
+  std::vector<unsigned char> text(encode_base64_length(kRecording) + 1);
+  std::vector<unsigned char> decoded(kRecording + 3);
+  std::vector<char> sinkBuffer(BASE64_ENCODER_BUFFER);
+
+  double oldEncode = mbPerSecond(kRecording, [&] {
+    legacy::encode_base64(pcm.data(), kRecording, text.data());
+    sinkHole = text[kRecording / 2];
+  });
+  double newEncode = mbPerSecond(kRecording, [&] {
+    encode_base64(pcm.data(), kRecording, text.data());
+    sinkHole = text[kRecording / 2];
+  });
+  double streamEncode = mbPerSecond(kRecording, [&] {
+    base64_encoder encoder;
+    base64_encoder_init(&encoder, nullSink, &sinkBuffer);
+    for (size_t offset = 0; offset < kRecording; offset += 1024)
+    {
+      base64_encoder_update(&encoder, pcm.data() + offset,
+                            static_cast<unsigned int>(std::min<size_t>(1024, kRecording - offset)));
+    }
+    sinkHole = static_cast<unsigned char>(base64_encoder_finish(&encoder));
+  });
+  unsigned int textLength = encode_base64(pcm.data(), kRecording, text.data());
+  double oldDecode = mbPerSecond(textLength, [&] {
+    legacy::decode_base64(text.data(), textLength, decoded.data());
+    sinkHole = decoded[kRecording / 2];
+  });
+  double newDecode = mbPerSecond(textLength, [&] {
+    decode_base64(text.data(), textLength, decoded.data());
+    sinkHole = decoded[kRecording / 2];
+  });
+  check(memcmp(decoded.data(), pcm.data(), kRecording) == 0, "benchmark round trip");
+
+  printf("320000-byte recording (MB/s of input):\n");
+  printf("  encode  old %7.1f   new %7.1f (%.1fx)   streaming 1 KB chunks %7.1f (%.1fx)\n", oldEncode, newEncode,
+         newEncode / oldEncode, streamEncode, streamEncode / oldEncode);
+  printf("  decode  old %7.1f   new %7.1f (%.1fx)\n", oldDecode, newDecode, newDecode / oldDecode);
+  printf("  encode time for the ASR body: old %.2f ms, new %.2f ms\n", kRecording / oldEncode / 1e3,
+         kRecording / newEncode / 1e3);
+}
+} // namespace
+
+int main()
+{
+  printf("sizeof(base64_encoder) = %zu bytes, pair table %zu bytes\n", sizeof(base64_encoder), sizeof(kPairs));
+  checkRfcVectors();
+  checkAgainstLegacy();
+  benchmark();
+  if (failures)
+  {
+    printf("%d check(s) failed\n", failures);
+    return 1;
+  }
+  printf("all checks passed\n");
+  return 0;
+}
@@ -0,0 +1,241 @@
+// Host tests for the button debounce/gesture state machine (src/sensors/button_gesture.cpp).
+//
+// Each case is a list of synthetic raw edges (time in ms, level after the edge),
+// including contact bounce bursts, fed to ButtonGestureDetector the way the button
+// task does: the ISR queue delivers edges, and between edges the task wakes at
+// msUntilDeadline() to call update(). The gestures produced, and the time at which
+// each one fires, are compared with the expected output. A second pass replays the
+// same edges with the task stalled (update() only at the end) to check the result
+// does not depend on when update() runs.
+//
+/*
+ *   g++ -std=c++17 -O2 -Wall tools/button_gesture_replay.cpp -o button_gesture_replay
+ *   ./button_gesture_replay
+ */
+
+#include <cstdio>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "../src/sensors/button_gesture.cpp"
+
+namespace
+{
+struct Edge
+{
+  uint32_t timeMs;
+  bool pressed;
+};
+
+struct Fired
+{
+  ButtonGesture gesture;
+  uint32_t timeMs;
+};
+
+struct Case
+{
+  const char *name;
+  std::vector<Edge> edges;
+  std::vector<Fired> expected;
+};
+
+const char *gestureName(ButtonGesture gesture)
+{
+  switch (gesture)
+  {
+  case ButtonGesture::ShortPress:
+    return "short";
+  case ButtonGesture::LongPress:
+    return "long";
+  case ButtonGesture::DoublePress:
+    return "double";
+  default:
+    return "none";
+  }
+}
+
+// 机械触点抖动：在 at 处切换到 pressed，前 spanMs 内来回跳 count 次
+void addBounce(std::vector<Edge> *edges, uint32_t at, bool pressed, int count, uint32_t spanMs)
+{
+  for (int i = 0; i < count; ++i)
+  {
+    uint32_t t = at + spanMs * i / count;
+    edges->push_back({t, pressed});
+    edges->push_back({t + 1, !pressed});
+  }
+  edges->push_back({at + spanMs, pressed});
+}
+
+void drain(ButtonGestureDetector *detector, uint32_t now, std::vector<Fired> *out)
+{
+  for (ButtonGesture g = detector->update(now); g != ButtonGesture::None; g = detector->update(now))
+  {
+    out->push_back({g, now});
+  }
+}
+
+// 模拟按键任务：队列里有边沿就处理，否则睡到下一个截止时刻；时间比较都用差值，跨回绕也成立
+std::vector<Fired> runTask(const std::vector<Edge> &edges, uint32_t startMs, uint32_t endMs)
+{
+  ButtonGestureDetector detector;
+  detector.reset(false, startMs);
+  std::vector<Fired> fired;
+  uint32_t now = startMs;
+  size_t next = 0;
+  while (now - startMs <= endMs - startMs)
+  {
+    uint32_t wait = detector.msUntilDeadline(now);
+    uint32_t untilEnd = endMs - now + 1;
+    if (wait > untilEnd)
+    {
+      wait = untilEnd;
+    }
+    if (next < edges.size() && edges[next].timeMs - now <= wait)
+    {
+      now = edges[next].timeMs;
+      detector.onEdge(edges[next].pressed, now);
+      ++next;
+    }
+    else
+    {
+      now += wait;
+    }
+    drain(&detector, now, &fired);
+  }
+  return fired;
+}
+
+// 任务被长时间阻塞：所有边沿先排队，最后一次性处理
+std::vector<ButtonGesture> runStalled(const std::vector<Edge> &edges, uint32_t startMs, uint32_t endMs)
+{
+  ButtonGestureDetector detector;
+  detector.reset(false, startMs);
+  for (const Edge &edge : edges)
+  {
+    detector.onEdge(edge.pressed, edge.timeMs);
+  }
+  std::vector<Fired> fired;
+  drain(&detector, endMs, &fired);
+  std::vector<ButtonGesture> gestures;
+  for (const Fired &f : fired)
+  {
+    gestures.push_back(f.gesture);
+  }
+  return gestures;
+}
+
+std::string describe(const std::vector<Fired> &fired)
+{
+  std::string text;
+  for (const Fired &f : fired)
+  {
+    text += std::string(gestureName(f.gesture)) + "@" + std::to_string(f.timeMs) + " ";
+  }
+  return text.empty() ? "-" : text;
+}
+
+std::vector<Case> buildCases()
+{
+  std::vector<Case> cases;
+
+  cases.push_back({"clean tap", {{1000, true}, {1090, false}}, {{ButtonGesture::ShortPress, 1340}}});
+
+  // 40 ms 的轻点，原来 100 ms 轮询可能整次错过
+  cases.push_back({"quick 40 ms tap", {{1000, true}, {1040, false}}, {{ButtonGesture::ShortPress, 1290}}});
+
+  Case bouncy{"bouncy tap", {}, {{ButtonGesture::ShortPress, 1370}}};
+  addBounce(&bouncy.edges, 1000, true, 4, 8);
+  addBounce(&bouncy.edges, 1110, false, 5, 10);
+  cases.push_back(bouncy);
+
+  cases.push_back({"glitch shorter than debounce", {{1000, true}, {1010, false}}, {}});
+
+  cases.push_back({"long press fires while held", {{1000, true}, {2500, false}}, {{ButtonGesture::LongPress, 1800}}});
+
+  Case bouncyLong{"bouncy long press", {}, {{ButtonGesture::LongPress, 1806}}};
+  addBounce(&bouncyLong.edges, 1000, true, 3, 6);
+  addBounce(&bouncyLong.edges, 2200, false, 3, 6);
+  cases.push_back(bouncyLong);
+
+  cases.push_back({"double press",
+                   {{1000, true}, {1080, false}, {1230, true}, {1300, false}},
+                   {{ButtonGesture::DoublePress, 1325}}});
+
+  Case bouncyDouble{"bouncy double press", {}, {{ButtonGesture::DoublePress, 1340}}};
+  addBounce(&bouncyDouble.edges, 1000, true, 3, 6);
+  addBounce(&bouncyDouble.edges, 1070, false, 3, 6);
+  addBounce(&bouncyDouble.edges, 1200, true, 3, 6);
+  addBounce(&bouncyDouble.edges, 1300, false, 3, 15);
+  cases.push_back(bouncyDouble);
+
+  // 第二次按下晚于双击窗口：两个单击
+  cases.push_back({"two separate taps",
+                   {{1000, true}, {1080, false}, {1400, true}, {1480, false}},
+                   {{ButtonGesture::ShortPress, 1330}, {ButtonGesture::ShortPress, 1730}}});
+
+  // 第二次按下落在窗口最后几毫秒，消抖结束时窗口已过，仍按边沿时刻算双击
+  cases.push_back({"second press at window edge",
+                   {{1000, true}, {1080, false}, {1325, true}, {1400, false}},
+                   {{ButtonGesture::DoublePress, 1425}}});
+
+  // 单击后接长按：先报单击，再报长按
+  cases.push_back({"tap then hold",
+                   {{1000, true}, {1080, false}, {1200, true}, {2500, false}},
+                   {{ButtonGesture::ShortPress, 2000}, {ButtonGesture::LongPress, 2000}}});
+
+  // 松开时的抖动跨过长按阈值：未确认的松开边沿挡住长按，判为单击
+  cases.push_back({"release just before long threshold",
+                   {{1000, true}, {1795, false}, {1797, true}, {1799, false}},
+                   {{ButtonGesture::ShortPress, 2049}}});
+
+  cases.push_back({"triple press",
+                   {{1000, true}, {1060, false}, {1150, true}, {1210, false}, {1300, true}, {1360, false}},
+                   {{ButtonGesture::DoublePress, 1235}, {ButtonGesture::ShortPress, 1610}}});
+
+  // millis() 跨 32 位回绕
+  const uint32_t wrap = UINT32_MAX - 50;
+  cases.push_back({"millis wrap-around", {{wrap, true}, {wrap + 100, false}}, {{ButtonGesture::ShortPress, wrap + 350}}});
+
+  return cases;
+}
+} // namespace
+
+int main()
+{
+  int failures = 0;
+  for (const Case &c : buildCases())
+  {
+    uint32_t startMs = c.edges.front().timeMs - 1000;
+    uint32_t endMs = c.edges.back().timeMs + 2000;
+    std::vector<Fired> fired = runTask(c.edges, startMs, endMs);
+
+    bool ok = fired.size() == c.expected.size();
+    for (size_t i = 0; ok && i < fired.size(); ++i)
+    {
+      ok = fired[i].gesture == c.expected[i].gesture && fired[i].timeMs == c.expected[i].timeMs;
+    }
+
+    std::vector<ButtonGesture> stalled = runStalled(c.edges, startMs, endMs);
+    bool stalledOk = stalled.size() == c.expected.size();
+    for (size_t i = 0; stalledOk && i < stalled.size(); ++i)
+    {
+      stalledOk = stalled[i] == c.expected[i].gesture;
+    }
+
+    printf("%-36s %-4s got: %s\n", c.name, ok && stalledOk ? "PASS" : "FAIL", describe(fired).c_str());
+    if (!ok)
+    {
+      printf("%36s      want: %s\n", "", describe(c.expected).c_str());
+      ++failures;
+    }
+    else if (!stalledOk)
+    {
+      printf("%36s      stalled task produced %zu gestures\n", "", stalled.size());
+      ++failures;
+    }
+  }
+  printf(failures ? "%d case(s) failed\n" : "all cases passed\n", failures);
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,378 @@
+// Host decoder for the deferred logger's binary output (src/utils/deferred_log.cpp).
+//
+// Build the firmware with -DDLOG_BINARY_OUTPUT=1 and capture the serial port
+// to a file (e.g. `pio device monitor --raw > dump.bin`). Each DLOG call site
+// is sent once as a definition frame carrying its format string; every log
+// after that is an event frame carrying only the site id, core, timestamp,
+// rate-limit count and raw 32-bit arguments. This tool rebuilds the text with
+// the same dlogFormat() the firmware uses in text mode. Bytes outside valid
+// frames (ordinary Serial.printf output, boot ROM messages) are passed through
+// unchanged, so the result reads like the plain serial log.
+//
+/*
+ *   g++ -std=c++17 -O2 tools/dlog_decode.cpp -o dlog_decode
+ *   ./dlog_decode dump.bin            # decode a capture (or - for stdin)
+ *   ./dlog_decode --no-time dump.bin  # without the [seconds core] prefix
+ *   ./dlog_decode --selftest          # round-trip checks, exits 1 on failure
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "../src/utils/deferred_log.cpp"
+
+namespace
+{
+struct Decoder
+{
+  std::map<uint16_t, std::string> formats;
+  bool showTime = true;
+  size_t frames = 0;
+  size_t badFrames = 0;
+  std::string out;
+
+  uint16_t get16(const uint8_t *p) { return static_cast<uint16_t>(p[0] | (p[1] << 8)); }
+  uint32_t get32(const uint8_t *p)
+  {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) | (static_cast<uint32_t>(p[2]) << 16) |
+           (static_cast<uint32_t>(p[3]) << 24);
+  }
+
+  bool event(const uint8_t *payload, size_t length)
+  {
+    if (length < 12)
+    {
+      return false;
+    }
+    uint16_t id = get16(payload);
+    uint8_t core = payload[2];
+    uint8_t argc = payload[3];
+    uint32_t timestampUs = get32(payload + 4);
+    uint32_t suppressed = get32(payload + 8);
+    if (argc > kDlogMaxArgs)
+    {
+      return false;
+    }
+
+    DlogValue values[kDlogMaxArgs];
+    std::string strings[kDlogMaxArgs];
+    size_t offset = 12;
+    for (size_t i = 0; i < argc; ++i)
+    {
+      if (offset >= length)
+      {
+        return false;
+      }
+      values[i].type = payload[offset++];
+      if (values[i].type == DlogString)
+      {
+        if (offset >= length || offset + 1 + payload[offset] > length)
+        {
+          return false;
+        }
+        size_t textLength = payload[offset++];
+        strings[i].assign(reinterpret_cast<const char *>(payload + offset), textLength);
+        values[i].s = strings[i].c_str();
+        offset += textLength;
+      }
+      else
+      {
+        if (offset + 4 > length)
+        {
+          return false;
+        }
+        values[i].u = get32(payload + offset);
+        offset += 4;
+      }
+    }
+
+    if (showTime)
+    {
+      char prefix[40];
+      snprintf(prefix, sizeof(prefix), "[%10.6f c%u] ", timestampUs / 1e6, core);
+      out += prefix;
+    }
+    auto format = formats.find(id);
+    if (format == formats.end())
+    {
+      char unknown[48];
+      snprintf(unknown, sizeof(unknown), "<site %u: definition not captured>\n", id);
+      out += unknown;
+      return true;
+    }
+    char line[1024];
+    size_t lineLength = dlogFormat(line, sizeof(line), format->second.c_str(), values, argc);
+    std::string text(line, lineLength);
+    if (suppressed > 0)
+    {
+      bool newline = !text.empty() && text.back() == '\n';
+      if (newline)
+      {
+        text.pop_back();
+      }
+      text += " (+" + std::to_string(suppressed) + " 条未输出)";
+      if (newline)
+      {
+        text += '\n';
+      }
+    }
+    out += text;
+    return true;
+  }
+
+  // 返回消耗的字节数；0 表示不是有效帧
+  size_t frame(const uint8_t *data, size_t available)
+  {
+    if (available < kDlogFrameHeader + 1 || data[0] != kDlogFrameMagic0 || data[1] != kDlogFrameMagic1)
+    {
+      return 0;
+    }
+    uint8_t type = data[2];
+    size_t length = get16(data + 3);
+    if ((type != DlogFrameDefine && type != DlogFrameEvent) || length > kDlogMaxFramePayload ||
+        available < kDlogFrameHeader + length + 1)
+    {
+      return 0;
+    }
+    const uint8_t *payload = data + kDlogFrameHeader;
+    uint8_t check = 0;
+    for (size_t i = 0; i < length; ++i)
+    {
+      check ^= payload[i];
+    }
+    if (check != payload[length])
+    {
+      ++badFrames;
+      return 0;
+    }
+
+    if (type == DlogFrameDefine)
+    {
+      if (length < 2)
+      {
+        return 0;
+      }
+      formats[get16(payload)] = std::string(reinterpret_cast<const char *>(payload + 2), length - 2);
+    }
+    else if (!event(payload, length))
+    {
+      ++badFrames;
+      return 0;
+    }
+    ++frames;
+    return kDlogFrameHeader + length + 1;
+  }
+
+  void decode(const std::vector<uint8_t> &data)
+  {
+    size_t i = 0;
+    while (i < data.size())
+    {
+      size_t used = frame(data.data() + i, data.size() - i);
+      if (used > 0)
+      {
+        i += used;
+        continue;
+      }
+      out += static_cast<char>(data[i++]);
+    }
+  }
+};
+
+// 与固件 emitBinary() 相同的帧布局，用于自检
+struct Encoder
+{
+  std::vector<uint8_t> bytes;
+
+  void frame(uint8_t type, const std::vector<uint8_t> &payload)
+  {
+    uint8_t check = 0;
+    for (uint8_t b : payload)
+    {
+      check ^= b;
+    }
+    bytes.push_back(kDlogFrameMagic0);
+    bytes.push_back(kDlogFrameMagic1);
+    bytes.push_back(type);
+    bytes.push_back(payload.size() & 0xFF);
+    bytes.push_back(payload.size() >> 8);
+    bytes.insert(bytes.end(), payload.begin(), payload.end());
+    bytes.push_back(check);
+  }
+
+  static void put32(std::vector<uint8_t> &out, uint32_t value)
+  {
+    for (int i = 0; i < 4; ++i)
+    {
+      out.push_back((value >> (8 * i)) & 0xFF);
+    }
+  }
+
+  void define(uint16_t id, const char *format)
+  {
+    std::vector<uint8_t> payload = {static_cast<uint8_t>(id & 0xFF), static_cast<uint8_t>(id >> 8)};
+    payload.insert(payload.end(), format, format + strlen(format));
+    frame(DlogFrameDefine, payload);
+  }
+
+  void event(uint16_t id, uint8_t core, uint32_t timestampUs, uint32_t suppressed, const std::vector<DlogArg> &args,
+             const std::vector<const char *> &strings = {})
+  {
+    std::vector<uint8_t> payload = {static_cast<uint8_t>(id & 0xFF), static_cast<uint8_t>(id >> 8), core,
+                                    static_cast<uint8_t>(args.size())};
+    put32(payload, timestampUs);
+    put32(payload, suppressed);
+    size_t nextString = 0;
+    for (const DlogArg &arg : args)
+    {
+      payload.push_back(arg.type);
+      if (arg.type == DlogString)
+      {
+        const char *text = strings[nextString++];
+        payload.push_back(static_cast<uint8_t>(strlen(text)));
+        payload.insert(payload.end(), text, text + strlen(text));
+      }
+      else
+      {
+        put32(payload, static_cast<uint32_t>(arg.bits));
+      }
+    }
+    frame(DlogFrameEvent, payload);
+  }
+};
+
+int failures = 0;
+
+void expectEqual(const std::string &actual, const std::string &expected, const char *what)
+{
+  if (actual != expected)
+  {
+    printf("FAIL %s\n  expected: %s\n  actual:   %s\n", what, expected.c_str(), actual.c_str());
+    ++failures;
+  }
+}
+
+std::string formatWith(const char *format, const std::vector<DlogArg> &args, const std::vector<const char *> &strings = {})
+{
+  DlogValue values[kDlogMaxArgs];
+  size_t nextString = 0;
+  for (size_t i = 0; i < args.size(); ++i)
+  {
+    values[i].type = args[i].type;
+    if (args[i].type == DlogString)
+    {
+      values[i].s = strings[nextString++];
+    }
+    else
+    {
+      values[i].u = static_cast<uint32_t>(args[i].bits);
+    }
+  }
+  char line[256];
+  size_t length = dlogFormat(line, sizeof(line), format, values, args.size());
+  return std::string(line, length);
+}
+
+int selftest()
+{
+  // 设备上 size_t/unsigned long 为 32 位；这里用 uint32_t 模拟
+  expectEqual(formatWith("[录音] 已录制: %d 字节, 音频能量: %d, 静音计数: %d\n",
+                         {dlogPack(uint32_t(20480)), dlogPack(uint32_t(312)), dlogPack(uint32_t(3))}),
+              "[录音] 已录制: 20480 字节, 音频能量: 312, 静音计数: 3\n", "unsigned through %d");
+  expectEqual(formatWith("超声波统计: 成功率%.1f%% (%lu ms)\n", {dlogPack(87.5f), dlogPack(uint32_t(30012))}),
+              "超声波统计: 成功率87.5% (30012 ms)\n", "float, %% and length modifier");
+  expectEqual(formatWith("%5d|%-4u|%08.3f|%x", {dlogPack(int32_t(-42)), dlogPack(uint8_t(7)), dlogPack(3.14159),
+                                                dlogPack(uint32_t(0xBEEF))}),
+              "  -42|7   |0003.142|beef", "flags, width and precision");
+  expectEqual(formatWith("I2S读取错误: %s, 字节数: %d", {dlogPack("ESP_ERR_TIMEOUT"), dlogPack(0)},
+                         {"ESP_ERR_TIMEOUT"}),
+              "I2S读取错误: ESP_ERR_TIMEOUT, 字节数: 0", "string argument");
+  expectEqual(formatWith("%d %d", {dlogPack(1)}), "1 <?>", "missing argument");
+  expectEqual(formatWith("%d", {dlogPack(2.9f)}), "2", "float through %d");
+
+  Encoder encoder;
+  const char *noise = "ESP-ROM:esp32s3-20210327\r\n";
+  encoder.bytes.insert(encoder.bytes.end(), noise, noise + strlen(noise));
+  encoder.define(1, "[超声波任务] 栈剩余: %d 字节\n");
+  encoder.event(1, 1, 1500000, 0, {dlogPack(uint32_t(2316))});
+  encoder.bytes.push_back(kDlogFrameMagic0); // 截断的残帧按原样透传
+  const char *plain = "[网络任务] 投递: 3\n";
+  encoder.bytes.insert(encoder.bytes.end(), plain, plain + strlen(plain));
+  encoder.define(2, "[音频调试] I2S部分读取: %d/%d 字节\n");
+  encoder.event(2, 0, 2250000, 17, {dlogPack(uint32_t(1024)), dlogPack(int32_t(2048))});
+  encoder.event(9, 0, 2260000, 0, {});
+
+  Decoder decoder;
+  decoder.decode(encoder.bytes);
+  expectEqual(decoder.out,
+              std::string(noise) + "[  1.500000 c1] [超声波任务] 栈剩余: 2316 字节\n" + "\xA5" + plain +
+                  "[  2.250000 c0] [音频调试] I2S部分读取: 1024/2048 字节 (+17 条未输出)\n" +
+                  "[  2.260000 c0] <site 9: definition not captured>\n",
+              "frame stream round trip");
+
+  // 校验字节错误的帧不被解码
+  Encoder corrupt;
+  corrupt.define(1, "x=%d\n");
+  corrupt.event(1, 0, 0, 0, {dlogPack(5)});
+  corrupt.bytes.back() ^= 0xFF;
+  Decoder strict;
+  strict.showTime = false;
+  strict.decode(corrupt.bytes);
+  expectEqual(std::to_string(strict.badFrames), "1", "checksum rejects corrupted frame");
+
+  printf("%s (%d failures)\n", failures == 0 ? "PASS" : "FAIL", failures);
+  return failures == 0 ? 0 : 1;
+}
+} // namespace
+
+int main(int argc, char **argv)
+{
+  Decoder decoder;
+  const char *path = nullptr;
+  for (int i = 1; i < argc; ++i)
+  {
+    if (strcmp(argv[i], "--selftest") == 0)
+    {
+      return selftest();
+    }
+    if (strcmp(argv[i], "--no-time") == 0)
+    {
+      decoder.showTime = false;
+    }
+    else
+    {
+      path = argv[i];
+    }
+  }
+  if (path == nullptr)
+  {
+    fprintf(stderr, "usage: %s [--no-time] <dump.bin | -> | --selftest\n", argv[0]);
+    return 2;
+  }
+
+  FILE *file = strcmp(path, "-") == 0 ? stdin : fopen(path, "rb");
+  if (file == nullptr)
+  {
+    fprintf(stderr, "cannot open %s\n", path);
+    return 1;
+  }
+  std::vector<uint8_t> data;
+  uint8_t buffer[4096];
+  size_t n;
+  while ((n = fread(buffer, 1, sizeof(buffer), file)) > 0)
+  {
+    data.insert(data.end(), buffer, buffer + n);
+  }
+  if (file != stdin)
+  {
+    fclose(file);
+  }
+
+  decoder.decode(data);
+  fwrite(decoder.out.data(), 1, decoder.out.size(), stdout);
+  fprintf(stderr, "%zu frames, %zu sites, %zu rejected\n", decoder.frames, decoder.formats.size(), decoder.badFrames);
+  return 0;
+}
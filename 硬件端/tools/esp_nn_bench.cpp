@@ -0,0 +1,482 @@
+// Host benchmark and bit-exactness check for the ESP-NN kernels used by the
+// wake-word model.
+//
+// Every layer type of tflite_learn_3 (CONV_2D, MAX_POOL_2D, FULLY_CONNECTED,
+// SOFTMAX) is run through each implementation that builds on Linux: the TFLM
+// reference kernel, ESP-NN ANSI C and ESP-NN generic "opt" C where one exists.
+// The model rows use the exact weights, biases and quantization parameters of
+// tflite_learn_3_compiled.cpp; the sweep rows use random weights on nearby
+// shapes. Outputs are compared byte for byte against the reference kernel on
+// random inputs and the run fails on any mismatch. The S3 assembly kernels do
+// not build on the host; compare those on target with tools/model_profile.cpp.
+//
+/*
+ *   S=lib/_3_inferencing/src; K=$S/edge-impulse-sdk/tensorflow/lite
+ *   N=$S/edge-impulse-sdk/porting/espressif/ESP-NN
+ *   for f in convolution/esp_nn_conv_{ansi,opt} pooling/esp_nn_max_pool_ansi \
+ *            fully_connected/esp_nn_fully_connected_ansi softmax/esp_nn_softmax_{ansi,opt}; do
+ *     gcc -c -O2 -I$S -DEI_CLASSIFIER_TFLITE_ENABLE_ESP_NN=1 $N/src/$f.c -o $(basename $f).o
+ *   done
+ *   g++ -std=c++17 -O2 -I$S -DTF_LITE_STATIC_MEMORY -DEI_CLASSIFIER_TFLITE_ENABLE_ESP_NN=0 \
+ *     tools/esp_nn_bench.cpp \
+ *     $K/micro/kernels/{conv,conv_common,pooling,pooling_common,fully_connected,fully_connected_common}.cpp \
+ *     $K/micro/kernels/{softmax,softmax_common,reshape,kernel_util_micro}.cpp \
+ *     $K/kernels/internal/{quantization_util,portable_tensor_utils}.cpp $K/kernels/kernel_util_lite.cpp \
+ *     $K/core/api/common.cpp $K/micro/{micro_utils,micro_context,memory_helpers}.cpp esp_nn_*.o -o esp_nn_bench
+ *   ./esp_nn_bench [min-ms-per-row]
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../lib/_3_inferencing/src/tflite-model/tflite_learn_3_compiled.cpp"
+#include "edge-impulse-sdk/tensorflow/lite/core/api/flatbuffer_conversions.h"
+#include "edge-impulse-sdk/tensorflow/lite/kernels/internal/reference/integer_ops/conv.h"
+#include "edge-impulse-sdk/tensorflow/lite/kernels/internal/reference/integer_ops/fully_connected.h"
+#include "edge-impulse-sdk/tensorflow/lite/kernels/internal/reference/integer_ops/pooling.h"
+#include "edge-impulse-sdk/tensorflow/lite/kernels/internal/reference/softmax.h"
+#include "edge-impulse-sdk/tensorflow/lite/micro/micro_allocator.h"
+
+extern "C"
+{
+#include "edge-impulse-sdk/porting/espressif/ESP-NN/include/esp_nn_ansi_headers.h"
+}
+
+// 固件里由 Edge Impulse 移植层和 TFLM 解释器提供；主机端给出最小实现
+void ei_printf(const char *format, ...)
+{
+  va_list args;
+  va_start(args, format);
+  vprintf(format, args);
+  va_end(args);
+}
+void *ei_calloc(size_t count, size_t size) { return calloc(count, size); }
+void ei_free(void *pointer) { free(pointer); }
+void Log(const char *format, va_list args) { vprintf(format, args); }
+
+namespace tflite
+{
+TfLiteStatus MicroAllocator::RequestScratchBufferInArena(size_t, int, int *) { return kTfLiteError; }
+TfLiteStatus ConvertTensorType(TensorType, TfLiteType *) { return kTfLiteError; }
+} // namespace tflite
+
+namespace
+{
+constexpr int kTrials = 16;
+double minMsPerRow = 50;
+std::mt19937 rng(20261019);
+long failures = 0;
+
+void fillRandom(std::vector<int8_t> &data)
+{
+  std::uniform_int_distribution<int> value(-128, 127);
+  for (int8_t &v : data)
+  {
+    v = static_cast<int8_t>(value(rng));
+  }
+}
+
+// 反复调用直到累计超过 minMsPerRow，返回单次耗时（ns）
+double timeNs(const std::function<void()> &fn)
+{
+  long iterations = 0;
+  long batch = 1;
+  auto start = std::chrono::steady_clock::now();
+  double elapsedNs = 0;
+  while (elapsedNs < minMsPerRow * 1e6)
+  {
+    for (long i = 0; i < batch; ++i)
+    {
+      fn();
+    }
+    iterations += batch;
+    batch *= 2;
+    elapsedNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+  }
+  return elapsedNs / iterations;
+}
+
+struct Impl
+{
+  const char *name;
+  std::function<void(const int8_t *in, int8_t *out)> run;
+};
+
+// 每个实现先在 kTrials 组随机输入上与参考内核逐字节比较，再计时
+void runRows(const char *kernel, const std::string &shape, bool model, double macs, size_t inBytes,
+             size_t outBytes, const std::vector<Impl> &impls)
+{
+  std::vector<std::vector<int8_t>> inputs(kTrials, std::vector<int8_t>(inBytes));
+  for (auto &input : inputs)
+  {
+    fillRandom(input);
+  }
+  std::vector<std::vector<int8_t>> expected(kTrials, std::vector<int8_t>(outBytes));
+  for (int t = 0; t < kTrials; ++t)
+  {
+    impls[0].run(inputs[t].data(), expected[t].data());
+  }
+
+  for (const Impl &impl : impls)
+  {
+    std::vector<int8_t> out(outBytes);
+    size_t mismatched = 0;
+    int maxDiff = 0;
+    for (int t = 0; t < kTrials; ++t)
+    {
+      impl.run(inputs[t].data(), out.data());
+      for (size_t i = 0; i < outBytes; ++i)
+      {
+        int diff = std::abs(out[i] - expected[t][i]);
+        mismatched += diff != 0;
+        maxDiff = std::max(maxDiff, diff);
+      }
+    }
+    double ns = timeNs([&]() { impl.run(inputs[0].data(), out.data()); });
+    char exact[32];
+    if (mismatched == 0)
+    {
+      snprintf(exact, sizeof(exact), "exact");
+    }
+    else
+    {
+      snprintf(exact, sizeof(exact), "DIFF %zu max %d", mismatched, maxDiff);
+      ++failures;
+    }
+    char macRate[16] = "-";
+    if (macs > 0)
+    {
+      snprintf(macRate, sizeof(macRate), "%.0f", macs / ns * 1e3);
+    }
+    printf("%-15s %-5s %-26s %-10s %10.0f %9s  %s\n", kernel, model ? "model" : "sweep", shape.c_str(), impl.name,
+           ns, macRate, exact);
+  }
+}
+
+tflite::RuntimeShape shapeOf(std::initializer_list<int32_t> dims)
+{
+  return tflite::RuntimeShape(static_cast<int>(dims.size()), dims.begin());
+}
+
+struct Quant
+{
+  float scale;
+  int zeroPoint;
+};
+
+Quant quantOf(const TfLiteAffineQuantization &q)
+{
+  return {q.scale->data[0], q.zero_point->data[0]};
+}
+
+// ---- CONV_2D：1xK 'same' 卷积 + ReLU，逐通道量化 ----
+struct ConvCase
+{
+  int width;
+  int inChannels;
+  int outChannels;
+  int kernel;
+  Quant input;
+  Quant output;
+  std::vector<int8_t> filter;
+  std::vector<int32_t> bias;
+  std::vector<float> filterScales;
+};
+
+void benchConv(const ConvCase &c, bool model)
+{
+  const int pad = (c.kernel - 1) / 2;
+  std::vector<int32_t> multiplier(c.outChannels);
+  std::vector<int32_t> shift(c.outChannels);
+  for (int ch = 0; ch < c.outChannels; ++ch)
+  {
+    int channelShift;
+    tflite::QuantizeMultiplier(static_cast<double>(c.input.scale) * static_cast<double>(c.filterScales[ch]) /
+                                   static_cast<double>(c.output.scale),
+                               &multiplier[ch], &channelShift);
+    shift[ch] = channelShift;
+  }
+
+  tflite::ConvParams params = {};
+  params.input_offset = -c.input.zeroPoint;
+  params.weights_offset = 0;
+  params.output_offset = c.output.zeroPoint;
+  params.stride_width = 1;
+  params.stride_height = 1;
+  params.dilation_width_factor = 1;
+  params.dilation_height_factor = 1;
+  params.padding_values.width = pad;
+  params.padding_values.height = 0;
+  params.quantized_activation_min = std::max(-128, c.output.zeroPoint);
+  params.quantized_activation_max = 127;
+  const tflite::RuntimeShape inShape = shapeOf({1, 1, c.width, c.inChannels});
+  const tflite::RuntimeShape filterShape = shapeOf({c.outChannels, 1, c.kernel, c.inChannels});
+  const tflite::RuntimeShape biasShape = shapeOf({c.outChannels});
+  const tflite::RuntimeShape outShape = shapeOf({1, 1, c.width, c.outChannels});
+
+  data_dims_t inDims = {c.width, 1, c.inChannels, 1};
+  data_dims_t filterDims = {c.kernel, 1, 0, 0};
+  data_dims_t outDims = {c.width, 1, c.outChannels, 1};
+  conv_params_t convParams = {-c.input.zeroPoint, c.output.zeroPoint, {1, 1}, {pad, 0}, {0, 0},
+                              {params.quantized_activation_min, params.quantized_activation_max}};
+  quant_data_t quantData = {shift.data(), multiplier.data()};
+  std::vector<int8_t> ansiScratch(std::max(1, esp_nn_get_conv_scratch_size_ansi(&inDims, &filterDims, &outDims, &convParams)));
+  std::vector<int8_t> optScratch(std::max(1, esp_nn_get_conv_scratch_size_opt(&inDims, &filterDims, &outDims, &convParams)));
+
+  std::vector<Impl> impls = {
+      {"tflm-ref",
+       [&](const int8_t *in, int8_t *out) {
+         tflite::reference_integer_ops::ConvPerChannel(params, multiplier.data(), shift.data(), inShape, in,
+                                                       filterShape, c.filter.data(), biasShape, c.bias.data(),
+                                                       outShape, out);
+       }},
+      {"esp-ansi",
+       [&](const int8_t *in, int8_t *out) {
+         esp_nn_set_conv_scratch_buf_ansi(ansiScratch.data());
+         esp_nn_conv_s8_ansi(&inDims, in, &filterDims, c.filter.data(), c.bias.data(), &outDims, out, &convParams,
+                             &quantData);
+       }},
+      {"esp-opt",
+       [&](const int8_t *in, int8_t *out) {
+         esp_nn_set_conv_scratch_buf_opt(optScratch.data());
+         esp_nn_conv_s8_opt(&inDims, in, &filterDims, c.filter.data(), c.bias.data(), &outDims, out, &convParams,
+                            &quantData);
+       }},
+  };
+  char shape[48];
+  snprintf(shape, sizeof(shape), "w%d c%d->%d k1x%d", c.width, c.inChannels, c.outChannels, c.kernel);
+  runRows("CONV_2D", shape, model, static_cast<double>(c.width) * c.outChannels * c.kernel * c.inChannels,
+          static_cast<size_t>(c.width) * c.inChannels, static_cast<size_t>(c.width) * c.outChannels, impls);
+}
+
+ConvCase modelConv(const int8_t *filter, const int32_t *bias, const TfLiteAffineQuantization &filterQuant,
+                   const TfLiteAffineQuantization &inputQuant, const TfLiteAffineQuantization &outputQuant, int width,
+                   int inChannels, int outChannels)
+{
+  ConvCase c;
+  c.width = width;
+  c.inChannels = inChannels;
+  c.outChannels = outChannels;
+  c.kernel = 3;
+  c.input = quantOf(inputQuant);
+  c.output = quantOf(outputQuant);
+  c.filter.assign(filter, filter + outChannels * 3 * inChannels);
+  c.bias.assign(bias, bias + outChannels);
+  c.filterScales.assign(filterQuant.scale->data, filterQuant.scale->data + outChannels);
+  return c;
+}
+
+ConvCase randomConv(int width, int inChannels, int outChannels, int kernel)
+{
+  ConvCase c;
+  c.width = width;
+  c.inChannels = inChannels;
+  c.outChannels = outChannels;
+  c.kernel = kernel;
+  c.input = {0.035f, 17};
+  c.output = {0.035f, -128};
+  c.filter.resize(outChannels * kernel * inChannels);
+  fillRandom(c.filter);
+  std::uniform_int_distribution<int> bias(-2000, 2000);
+  std::uniform_real_distribution<float> scale(0.002f, 0.005f);
+  for (int ch = 0; ch < outChannels; ++ch)
+  {
+    c.bias.push_back(bias(rng));
+    c.filterScales.push_back(scale(rng));
+  }
+  return c;
+}
+
+// ---- MAX_POOL_2D：沿时间轴 2x1 / stride 2，SAME 填充落在末尾 ----
+void benchMaxPool(int frames, int channels, bool model)
+{
+  const int outFrames = (frames + 1) / 2;
+  tflite::PoolParams params = {};
+  params.stride_height = 2;
+  params.stride_width = 1;
+  params.filter_height = 2;
+  params.filter_width = 1;
+  params.padding_values.height = 0;
+  params.padding_values.width = 0;
+  params.quantized_activation_min = -128;
+  params.quantized_activation_max = 127;
+  const tflite::RuntimeShape inShape = shapeOf({1, frames, 1, channels});
+  const tflite::RuntimeShape outShape = shapeOf({1, outFrames, 1, channels});
+
+  std::vector<Impl> impls = {
+      {"tflm-ref",
+       [&](const int8_t *in, int8_t *out) {
+         tflite::reference_integer_ops::MaxPool(params, inShape, in, outShape, out);
+       }},
+      {"esp-ansi",
+       [&](const int8_t *in, int8_t *out) {
+         esp_nn_max_pool_s8_ansi(in, 1, frames, out, 1, outFrames, 1, 2, 1, 2, 0, 0, -128, 127, channels);
+       }},
+  };
+  char shape[48];
+  snprintf(shape, sizeof(shape), "h%d->%d c%d", frames, outFrames, channels);
+  runRows("MAX_POOL_2D", shape, model, 0, static_cast<size_t>(frames) * channels,
+          static_cast<size_t>(outFrames) * channels, impls);
+}
+
+// ---- FULLY_CONNECTED：逐张量量化 ----
+struct FcCase
+{
+  int inputs;
+  int outputs;
+  Quant input;
+  Quant output;
+  float filterScale;
+  std::vector<int8_t> filter;
+  std::vector<int32_t> bias;
+};
+
+void benchFullyConnected(const FcCase &c, bool model)
+{
+  int32_t multiplier;
+  int shift;
+  tflite::QuantizeMultiplier(static_cast<double>(c.input.scale) * static_cast<double>(c.filterScale) /
+                                 static_cast<double>(c.output.scale),
+                             &multiplier, &shift);
+  tflite::FullyConnectedParams params = {};
+  params.input_offset = -c.input.zeroPoint;
+  params.weights_offset = 0;
+  params.output_offset = c.output.zeroPoint;
+  params.output_multiplier = multiplier;
+  params.output_shift = shift;
+  params.quantized_activation_min = -128;
+  params.quantized_activation_max = 127;
+  const tflite::RuntimeShape inShape = shapeOf({1, c.inputs});
+  const tflite::RuntimeShape filterShape = shapeOf({c.outputs, c.inputs});
+  const tflite::RuntimeShape biasShape = shapeOf({c.outputs});
+  const tflite::RuntimeShape outShape = shapeOf({1, c.outputs});
+
+  std::vector<Impl> impls = {
+      {"tflm-ref",
+       [&](const int8_t *in, int8_t *out) {
+         tflite::reference_integer_ops::FullyConnected(params, inShape, in, filterShape, c.filter.data(), biasShape,
+                                                       c.bias.data(), outShape, out);
+       }},
+      {"esp-ansi",
+       [&](const int8_t *in, int8_t *out) {
+         esp_nn_fully_connected_s8_ansi(in, -c.input.zeroPoint, c.inputs, c.filter.data(), 0, c.bias.data(), out,
+                                        c.outputs, c.output.zeroPoint, shift, multiplier, -128, 127);
+       }},
+  };
+  char shape[48];
+  snprintf(shape, sizeof(shape), "%d->%d", c.inputs, c.outputs);
+  runRows("FULLY_CONNECTED", shape, model, static_cast<double>(c.inputs) * c.outputs, c.inputs, c.outputs, impls);
+}
+
+FcCase randomFullyConnected(int inputs, int outputs)
+{
+  FcCase c;
+  c.inputs = inputs;
+  c.outputs = outputs;
+  c.input = {0.039f, -128};
+  c.output = {0.127f, 7};
+  c.filterScale = 0.0035f;
+  c.filter.resize(inputs * outputs);
+  fillRandom(c.filter);
+  std::uniform_int_distribution<int> bias(-200, 200);
+  for (int o = 0; o < outputs; ++o)
+  {
+    c.bias.push_back(bias(rng));
+  }
+  return c;
+}
+
+// ---- SOFTMAX：int8 -> int8，输出 scale 1/256、零点 -128 ----
+void benchSoftmax(int classes, float inputScale, bool model)
+{
+  constexpr int kScaledDiffIntegerBits = 5;
+  tflite::SoftmaxParams params = {};
+  int leftShift;
+  tflite::PreprocessSoftmaxScaling(1.0, static_cast<double>(inputScale), kScaledDiffIntegerBits,
+                                   &params.input_multiplier, &leftShift);
+  params.input_left_shift = leftShift;
+  params.diff_min = -1.0 * tflite::CalculateInputRadius(kScaledDiffIntegerBits, leftShift);
+  params.zero_point = -128;
+  params.scale = 1.0f / 256;
+  const tflite::RuntimeShape shape = shapeOf({1, classes});
+  std::vector<int8_t> optScratch(std::max<int32_t>(1, esp_nn_get_softmax_scratch_size_opt(classes, 1)));
+
+  std::vector<Impl> impls = {
+      {"tflm-ref",
+       [&](const int8_t *in, int8_t *out) { tflite::reference_ops::Softmax(params, shape, in, shape, out); }},
+      {"esp-ansi",
+       [&](const int8_t *in, int8_t *out) {
+         esp_nn_softmax_s8_ansi(in, 1, classes, params.input_multiplier, params.input_left_shift, params.diff_min,
+                                out);
+       }},
+      {"esp-opt",
+       [&](const int8_t *in, int8_t *out) {
+         esp_nn_set_softmax_scratch_buf_opt(optScratch.data());
+         esp_nn_softmax_s8_opt(in, 1, classes, params.input_multiplier, params.input_left_shift, params.diff_min,
+                               out);
+       }},
+  };
+  char label[48];
+  snprintf(label, sizeof(label), "%d classes", classes);
+  runRows("SOFTMAX", label, model, 0, classes, classes, impls);
+}
+} // namespace
+
+int main(int argc, char **argv)
+{
+  if (argc > 1)
+  {
+    minMsPerRow = atof(argv[1]);
+  }
+  printf("%-15s %-5s %-26s %-10s %10s %9s  %s\n", "kernel", "set", "shape", "impl", "ns/op", "MMAC/s", "vs tflm-ref");
+
+  // 模型本身的两层卷积：输入/输出量化取自相邻张量
+  benchConv(modelConv(g0::tensor_data11, g0::tensor_data10, g0::quant11, g0::quant12, g0::quant13, 50, 13, 8), true);
+  benchConv(modelConv(g0::tensor_data9, g0::tensor_data8, g0::quant9, g0::quant16, g0::quant17, 25, 8, 16), true);
+  const int convSweep[][4] = {{50, 13, 16, 3}, {100, 13, 8, 3}, {49, 13, 8, 3}, {25, 16, 16, 3},
+                              {25, 8, 32, 3},  {13, 16, 16, 3}, {50, 13, 8, 5}, {98, 40, 8, 3}};
+  for (const auto &s : convSweep)
+  {
+    benchConv(randomConv(s[0], s[1], s[2], s[3]), false);
+  }
+
+  benchMaxPool(50, 8, true);
+  benchMaxPool(25, 16, true);
+  const int poolSweep[][2] = {{100, 8}, {49, 8}, {26, 16}, {25, 32}, {24, 12}};
+  for (const auto &s : poolSweep)
+  {
+    benchMaxPool(s[0], s[1], false);
+  }
+
+  FcCase fc;
+  fc.inputs = 208;
+  fc.outputs = 3;
+  fc.input = quantOf(g0::quant20);
+  fc.output = quantOf(g0::quant21);
+  fc.filterScale = g0::quant7.scale->data[0];
+  fc.filter.assign(g0::tensor_data7, g0::tensor_data7 + 3 * 208);
+  fc.bias.assign(g0::tensor_data6, g0::tensor_data6 + 3);
+  benchFullyConnected(fc, true);
+  const int fcSweep[][2] = {{208, 8}, {416, 3}, {104, 3}, {640, 16}};
+  for (const auto &s : fcSweep)
+  {
+    benchFullyConnected(randomFullyConnected(s[0], s[1]), false);
+  }
+
+  benchSoftmax(3, g0::quant21.scale->data[0], true);
+  const int softmaxSweep[] = {2, 8, 35, 128};
+  for (int classes : softmaxSweep)
+  {
+    benchSoftmax(classes, 0.127f, false);
+  }
+
+  printf("%s: %ld row(s) differ from tflm-ref\n", failures == 0 ? "OK" : "FAIL", failures);
+  return failures == 0 ? 0 : 1;
+}
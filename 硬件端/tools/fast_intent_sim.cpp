@@ -0,0 +1,215 @@
+// Host simulator for the on-device fast-intent matcher.
+//
+// Compiles src/services/fast_intent.cpp as-is (without ARDUINO defined) against
+// ArduinoJson 7.x, loads the builtin rules (or a rules JSON fetched from
+// GET /v1/fast_intent_rules), runs a transcript corpus through the matcher and
+// reports per-utterance match time plus a latency model of what the fast path
+// saves compared with always calling /ai.
+//
+//   g++ -std=c++17 -O2 -I<path-to>/ArduinoJson/src tools/fast_intent_sim.cpp -o fast_intent_sim
+//   ./fast_intent_sim [--rules rules.json] [--corpus corpus.txt] [--ai-ms 900] [--audio-dir data/audio]
+//
+// Corpus format: one utterance per line, prefixed with "1 " when navigation is
+// active and "0 " otherwise. Lines starting with '#' are ignored.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../src/services/fast_intent.cpp"
+
+namespace
+{
+struct Utterance
+{
+  bool navigationActive;
+  std::string text;
+};
+
+const Utterance kDefaultCorpus[] = {
+    {false, "你好"},
+    {false, "在吗？"},
+    {false, "给我讲个笑话吧"},
+    {false, "讲个故事"},
+    {false, "帮助"},
+    {false, "导航到南昌大学图书馆"},
+    {false, "今天天气怎么样"},
+    {false, "还有多远"},
+    {false, "停止导航"},
+    {false, "今天星期几"},
+    {false, "附近有什么好吃的"},
+    {true, "下一步怎么走"},
+    {true, "还有多远"},
+    {true, "停止导航"},
+    {true, "算了"},
+    {true, "取消"},
+    {true, "明天会下雨吗"},
+};
+
+std::string readFile(const std::string &path)
+{
+  std::ifstream in(path, std::ios::binary);
+  std::stringstream buffer;
+  buffer << in.rdbuf();
+  return buffer.str();
+}
+
+// 读取 WAV data 块长度换算播放时长；文件缺失返回 -1
+double wavDurationMs(const std::string &path)
+{
+  std::string wav = readFile(path);
+  if (wav.size() < 44 || wav.compare(0, 4, "RIFF") != 0)
+  {
+    return -1;
+  }
+  uint32_t byteRate = 0;
+  for (size_t offset = 12; offset + 8 <= wav.size();)
+  {
+    uint32_t chunkSize = static_cast<uint8_t>(wav[offset + 4]) | static_cast<uint8_t>(wav[offset + 5]) << 8 |
+                         static_cast<uint8_t>(wav[offset + 6]) << 16 |
+                         static_cast<uint32_t>(static_cast<uint8_t>(wav[offset + 7])) << 24;
+    if (wav.compare(offset, 4, "fmt ") == 0 && offset + 20 <= wav.size())
+    {
+      byteRate = static_cast<uint8_t>(wav[offset + 16]) | static_cast<uint8_t>(wav[offset + 17]) << 8 |
+                 static_cast<uint8_t>(wav[offset + 18]) << 16 |
+                 static_cast<uint32_t>(static_cast<uint8_t>(wav[offset + 19])) << 24;
+    }
+    if (wav.compare(offset, 4, "data") == 0 && byteRate > 0)
+    {
+      return 1000.0 * chunkSize / byteRate;
+    }
+    offset += 8 + chunkSize + (chunkSize & 1);
+  }
+  return -1;
+}
+
+const char *actionName(FastIntentAction action)
+{
+  switch (action)
+  {
+  case FastIntentAction::LocalAudio:
+    return "local_audio";
+  case FastIntentAction::Speak:
+    return "speak";
+  default:
+    return "server";
+  }
+}
+} // namespace
+
+int main(int argc, char **argv)
+{
+  std::string rulesPath;
+  std::string corpusPath;
+  std::string audioDir = "data/audio";
+  double aiMs = 900;
+  for (int i = 1; i + 1 < argc; i += 2)
+  {
+    std::string flag = argv[i];
+    if (flag == "--rules")
+    {
+      rulesPath = argv[i + 1];
+    }
+    else if (flag == "--corpus")
+    {
+      corpusPath = argv[i + 1];
+    }
+    else if (flag == "--audio-dir")
+    {
+      audioDir = argv[i + 1];
+    }
+    else if (flag == "--ai-ms")
+    {
+      aiMs = atof(argv[i + 1]);
+    }
+  }
+
+  static FastIntentMatcher matcher;
+  std::string rules = rulesPath.empty() ? fastIntentDefaultRules() : readFile(rulesPath);
+  if (!matcher.load(rules.data(), rules.size()))
+  {
+    fprintf(stderr, "failed to load rules\n");
+    return 1;
+  }
+  printf("rules=%s version=%s rules=%zu keywords=%zu nodes=%zu sizeof(matcher)=%zuB\n",
+         rulesPath.empty() ? "builtin" : rulesPath.c_str(),
+         matcher.version(),
+         matcher.ruleCount(),
+         matcher.keywordCount(),
+         matcher.nodeCount(),
+         sizeof(FastIntentMatcher));
+
+  std::vector<Utterance> corpus(std::begin(kDefaultCorpus), std::end(kDefaultCorpus));
+  if (!corpusPath.empty())
+  {
+    corpus.clear();
+    std::ifstream in(corpusPath);
+    std::string line;
+    while (std::getline(in, line))
+    {
+      if (line.size() > 2 && line[0] != '#')
+      {
+        corpus.push_back({line[0] == '1', line.substr(2)});
+      }
+    }
+  }
+
+  // 基线：每句都走 /ai 再按服务端给出的 speak 播报。本地命中时首个声音提前一次 /ai 往返；
+  // speak 规则之后的 TTS 两条路径相同，不计入。server 规则的确认音与 /ai 并行，
+  // 确认音比 /ai 长时正式答复会被推迟，记为 delay。
+  constexpr int kIterations = 20000;
+  double totalSavedMs = 0;
+  double totalDelayMs = 0;
+  size_t hits = 0;
+  for (const Utterance &utterance : corpus)
+  {
+    FastIntentMatch match;
+    bool matched = matcher.match(utterance.text.c_str(), utterance.navigationActive, &match);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int n = 0; n < kIterations; ++n)
+    {
+      matcher.match(utterance.text.c_str(), utterance.navigationActive, &match);
+    }
+    double matchUs =
+        std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / kIterations;
+
+    double savedMs = 0;
+    double delayMs = 0;
+    if (matched)
+    {
+      ++hits;
+      savedMs = aiMs;
+      if (match.action == FastIntentAction::Server)
+      {
+        double ackMs = match.audioId.isEmpty() ? -1 : wavDurationMs(audioDir + "/" + match.audioId.c_str() + ".wav");
+        savedMs = ackMs > 0 ? aiMs : 0;
+        delayMs = ackMs > aiMs ? ackMs - aiMs : 0;
+      }
+    }
+    totalSavedMs += savedMs;
+    totalDelayMs += delayMs;
+
+    printf("nav=%d %-24s %-18s %-12s %-18s match=%5.2fus first_audio-%4.0fms delay+%4.0fms\n",
+           utterance.navigationActive,
+           utterance.text.c_str(),
+           matched ? match.intent.c_str() : "-",
+           matched ? actionName(match.action) : "-",
+           matched ? match.audioId.c_str() : "",
+           matchUs,
+           savedMs,
+           delayMs);
+  }
+
+  printf("utterances=%zu fast_hits=%zu avg_first_audio-%.0fms avg_delay+%.0fms (ai=%.0fms)\n",
+         corpus.size(),
+         hits,
+         corpus.empty() ? 0.0 : totalSavedMs / corpus.size(),
+         corpus.empty() ? 0.0 : totalDelayMs / corpus.size(),
+         aiMs);
+  return 0;
+}
@@ -0,0 +1,369 @@
+// Host tests for the GPS track ring and batch encoder (src/utils/gps_track.cpp)
+// used by the store-and-forward uploader (src/services/track_store.cpp).
+//
+// 1. Encoder output is byte-identical to the vector the server test decodes
+//    (web/tests/test_gps_track.py), random walks round-trip through a reference
+//    decoder, and a full buffer rejects whole points only.
+// 2. Ring: overwrite of the oldest point when full, and dropThrough() after an
+//    upload acknowledgement removes only points that were actually sent, even if
+//    the ring overwrote some of them while the request was in flight.
+// 3. NMEA RMC date/time to Unix epoch milliseconds.
+// 4. Size and request count for one hour of 1 Hz walking: one JSON POST per fix
+//    every 5 s (the previous uploader) against 120-point encoded batches.
+//
+/*
+ *   g++ -std=c++17 -O2 -Wall tools/gps_track_check.cpp -o gps_track_check
+ *   ./gps_track_check
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../src/utils/gps_track.cpp"
+#include "../src/utils/nmea_parser.cpp"
+
+namespace
+{
+int gErrors = 0;
+
+void check(bool condition, const char *what)
+{
+  if (!condition)
+  {
+    printf("  FAIL: %s\n", what);
+    ++gErrors;
+  }
+}
+
+TrackPoint makePoint(int64_t utcMs, int32_t latE6, int32_t lonE6, uint16_t speed, uint8_t hdop, uint8_t sats)
+{
+  TrackPoint point;
+  point.utcMs = utcMs;
+  point.latE6 = latE6;
+  point.lonE6 = lonE6;
+  point.speedDkmh = speed;
+  point.hdopX10 = hdop;
+  point.satellites = sats;
+  return point;
+}
+
+// 参考解码，与 web/utils/track_codec.py 相同
+bool decode(const uint8_t *data, size_t length, std::vector<TrackPoint> *out)
+{
+  size_t pos = 0;
+  auto uvarint = [&](uint64_t *value) {
+    *value = 0;
+    for (int shift = 0; shift < 64; shift += 7)
+    {
+      if (pos >= length)
+      {
+        return false;
+      }
+      uint8_t byte = data[pos++];
+      *value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+      if ((byte & 0x80) == 0)
+      {
+        return true;
+      }
+    }
+    return false;
+  };
+  auto svarint = [&](int64_t *value) {
+    uint64_t raw = 0;
+    if (!uvarint(&raw))
+    {
+      return false;
+    }
+    *value = static_cast<int64_t>(raw >> 1) ^ -static_cast<int64_t>(raw & 1);
+    return true;
+  };
+
+  if (length == 0 || data[pos++] != kTrackFormat)
+  {
+    return false;
+  }
+  out->clear();
+  TrackPoint last = {};
+  while (pos < length)
+  {
+    TrackPoint point = {};
+    uint64_t first = 0;
+    int64_t a = 0, b = 0, c = 0;
+    if (out->empty())
+    {
+      if (!uvarint(&first) || !svarint(&b) || !svarint(&c))
+      {
+        return false;
+      }
+      point.utcMs = static_cast<int64_t>(first);
+      point.latE6 = static_cast<int32_t>(b);
+      point.lonE6 = static_cast<int32_t>(c);
+    }
+    else
+    {
+      if (!svarint(&a) || !svarint(&b) || !svarint(&c))
+      {
+        return false;
+      }
+      point.utcMs = last.utcMs + a;
+      point.latE6 = static_cast<int32_t>(last.latE6 + b);
+      point.lonE6 = static_cast<int32_t>(last.lonE6 + c);
+    }
+    uint64_t speed = 0, hdop = 0, sats = 0;
+    if (!uvarint(&speed) || !uvarint(&hdop) || !uvarint(&sats))
+    {
+      return false;
+    }
+    point.speedDkmh = speed == 0 ? kTrackUnknownSpeed : static_cast<uint16_t>(speed - 1);
+    point.hdopX10 = hdop == 0 ? kTrackUnknownHdop : static_cast<uint8_t>(hdop - 1);
+    point.satellites = static_cast<uint8_t>(sats);
+    out->push_back(point);
+    last = point;
+  }
+  return true;
+}
+
+bool samePoint(const TrackPoint &a, const TrackPoint &b)
+{
+  return a.utcMs == b.utcMs && a.latE6 == b.latE6 && a.lonE6 == b.lonE6 && a.speedDkmh == b.speedDkmh &&
+         a.hdopX10 == b.hdopX10 && a.satellites == b.satellites;
+}
+
+std::string hex(const uint8_t *data, size_t length)
+{
+  std::string text;
+  char byte[3];
+  for (size_t i = 0; i < length; ++i)
+  {
+    snprintf(byte, sizeof(byte), "%02x", data[i]);
+    text += byte;
+  }
+  return text;
+}
+
+// ---------------------------------------------------------------------------
+// 1. 编码
+// ---------------------------------------------------------------------------
+void testEncoder()
+{
+  printf("encoder\n");
+  const int64_t t0 = 1735732800000LL;
+  TrackPoint points[] = {
+      makePoint(t0, 39968724, 116390946, 43, 9, 9),
+      makePoint(t0 + 1000, 39968736, 116390939, 45, 9, 10),
+      makePoint(t0 + 2000, 39968736, 116390939, kTrackUnknownSpeed, kTrackUnknownHdop, 0),
+  };
+  uint8_t buffer[trackEncodedBound(3)];
+  TrackEncoder encoder(buffer, sizeof(buffer));
+  for (const TrackPoint &point : points)
+  {
+    check(encoder.add(point), "vector point fits");
+  }
+  check(hex(buffer, encoder.length()) == "0180d4f28dc232a8ff8e26c4f0ff6e2c0a09d00f180d2e0a0ad00f0000000000",
+        "matches server test vector");
+
+  // 极端值：南纬西经最大值、时间倒退、跨越整个地球的跳变
+  TrackPoint extremes[] = {
+      makePoint(0, -90000000, -180000000, 0, 0, 0),
+      makePoint(4102444800000LL, 90000000, 180000000, 65534, 254, 255),
+      makePoint(1000, -90000000, -180000000, 1, 1, 1),
+  };
+  uint8_t extremeBuffer[trackEncodedBound(3)];
+  TrackEncoder extremeEncoder(extremeBuffer, sizeof(extremeBuffer));
+  for (const TrackPoint &point : extremes)
+  {
+    check(extremeEncoder.add(point), "extreme point within kMaxPointBytes bound");
+  }
+  std::vector<TrackPoint> decoded;
+  check(decode(extremeBuffer, extremeEncoder.length(), &decoded) && decoded.size() == 3, "extremes decode");
+  for (size_t i = 0; i < decoded.size(); ++i)
+  {
+    check(samePoint(decoded[i], extremes[i]), "extreme round trip");
+  }
+
+  // 随机步行轨迹往返
+  std::mt19937 rng(2024);
+  for (int round = 0; round < 200; ++round)
+  {
+    std::vector<TrackPoint> walk;
+    int64_t t = 1700000000000LL + rng() % 100000000;
+    int32_t lat = static_cast<int32_t>(rng() % 180000000) - 90000000;
+    int32_t lon = static_cast<int32_t>(rng() % 360000000) - 180000000;
+    size_t count = 1 + rng() % 150;
+    for (size_t i = 0; i < count; ++i)
+    {
+      t += 900 + rng() % 200 + (rng() % 50 == 0 ? 60000 : 0);
+      lat += static_cast<int32_t>(rng() % 41) - 20;
+      lon += static_cast<int32_t>(rng() % 41) - 20;
+      walk.push_back(makePoint(t, lat, lon, rng() % 4 ? rng() % 80 : kTrackUnknownSpeed,
+                               rng() % 4 ? rng() % 60 : kTrackUnknownHdop, rng() % 20));
+    }
+    std::vector<uint8_t> out(trackEncodedBound(count));
+    TrackEncoder walkEncoder(out.data(), out.size());
+    for (const TrackPoint &point : walk)
+    {
+      walkEncoder.add(point);
+    }
+    bool same = walkEncoder.count() == count && decode(out.data(), walkEncoder.length(), &decoded) &&
+                decoded.size() == count;
+    for (size_t i = 0; same && i < count; ++i)
+    {
+      same = samePoint(decoded[i], walk[i]);
+    }
+    if (!same)
+    {
+      check(false, "random walk round trip");
+      break;
+    }
+  }
+
+  // 缓冲区不够时拒绝整个点
+  uint8_t small[1 + TrackEncoder::kMaxPointBytes + 5];
+  TrackEncoder smallEncoder(small, sizeof(small));
+  check(smallEncoder.add(points[0]), "first point fits small buffer");
+  size_t before = smallEncoder.length();
+  check(!smallEncoder.add(points[1]), "second point rejected");
+  check(smallEncoder.length() == before && smallEncoder.count() == 1, "rejected point writes nothing");
+}
+
+// ---------------------------------------------------------------------------
+// 2. 环
+// ---------------------------------------------------------------------------
+void testRing()
+{
+  printf("ring\n");
+  TrackPoint storage[8];
+  TrackRing ring;
+  ring.attach(storage, 8);
+  for (int i = 0; i < 8; ++i)
+  {
+    check(ring.push(makePoint(i, 0, 0, 0, 0, 0)), "push below capacity");
+  }
+  check(!ring.push(makePoint(8, 0, 0, 0, 0, 0)), "push when full overwrites");
+  check(ring.size() == 8 && ring.at(0).utcMs == 1 && ring.headSeq() == 1 && ring.overwritten() == 1,
+        "oldest overwritten");
+
+  // 上传开始：拷出最旧 5 个并记下序号
+  TrackPoint batch[5];
+  uint64_t seq = ring.headSeq();
+  check(ring.copyOldest(batch, 5) == 5 && batch[0].utcMs == 1 && batch[4].utcMs == 5, "copy oldest");
+  // 请求进行中又来了 3 个点，覆盖了其中 3 个已发送的点
+  for (int i = 9; i < 12; ++i)
+  {
+    ring.push(makePoint(i, 0, 0, 0, 0, 0));
+  }
+  check(ring.at(0).utcMs == 4, "in-flight points overwritten");
+  // 确认后只再移出仍在环里的已发送点（4、5），未发送的 6 起保留
+  ring.dropThrough(seq + 5);
+  check(ring.size() == 6 && ring.at(0).utcMs == 6 && ring.at(5).utcMs == 11, "ack drops only sent points");
+  ring.dropThrough(seq + 2);
+  check(ring.size() == 6, "stale ack is a no-op");
+
+  ring.drop(100);
+  check(ring.size() == 0 && ring.copyOldest(batch, 5) == 0, "drop clamps");
+  for (int i = 0; i < 20; ++i)
+  {
+    ring.push(makePoint(100 + i, 0, 0, 0, 0, 0));
+  }
+  bool ordered = ring.size() == 8;
+  for (size_t i = 0; ordered && i < ring.size(); ++i)
+  {
+    ordered = ring.at(i).utcMs == 112 + static_cast<int64_t>(i);
+  }
+  check(ordered, "wrap-around keeps order");
+
+  TrackRing detached;
+  check(!detached.push(makePoint(1, 0, 0, 0, 0, 0)) && detached.size() == 0, "no storage drops points");
+}
+
+// ---------------------------------------------------------------------------
+// 3. UTC
+// ---------------------------------------------------------------------------
+void testUtc()
+{
+  printf("nmea utc\n");
+  check(nmeaUtcToEpochMs("010125", "120000.00") == 1735732800000LL, "2025-01-01 12:00:00");
+  check(nmeaUtcToEpochMs("010170", "000000") == 3155760000000LL, "two-digit year is 20xx");
+  check(nmeaUtcToEpochMs("290224", "235959.999") == 1709251199999LL, "leap day with milliseconds");
+  check(nmeaUtcToEpochMs("311224", "083559.5") == 1735634159500LL, "one fractional digit");
+  check(nmeaUtcToEpochMs("", "120000.00") == -1, "missing date");
+  check(nmeaUtcToEpochMs("010125", "") == -1, "missing time");
+  check(nmeaUtcToEpochMs("321325", "120000") == -1, "invalid date");
+  check(nmeaUtcToEpochMs("010125", "246000") == -1, "invalid time");
+}
+
+// ---------------------------------------------------------------------------
+// 4. 体积与请求数
+// ---------------------------------------------------------------------------
+void compareUploads()
+{
+  printf("\none hour of 1 Hz walking (~1.3 m/s, hdop 0.9-1.4, 8-11 satellites)\n");
+  std::mt19937 rng(7);
+  std::vector<TrackPoint> hour;
+  int64_t t = 1735732800000LL;
+  double lat = 28.680000, lon = 115.890000, heading = 0.3;
+  for (int i = 0; i < 3600; ++i)
+  {
+    heading += (static_cast<int>(rng() % 21) - 10) * 0.01;
+    lat += 1.3 * cos(heading) / 111320.0;
+    lon += 1.3 * sin(heading) / (111320.0 * cos(lat * M_PI / 180.0));
+    hour.push_back(makePoint(t + i * 1000LL, static_cast<int32_t>(lround(lat * 1e6)),
+                             static_cast<int32_t>(lround(lon * 1e6)), 44 + rng() % 6, 9 + rng() % 6, 8 + rng() % 4));
+  }
+
+  // 旧方式：每 5 s 一个 JSON POST，只带当前点
+  size_t legacyRequests = 0;
+  size_t legacyBytes = 0;
+  for (size_t i = 0; i < hour.size(); i += 5)
+  {
+    char body[160];
+    legacyBytes += snprintf(body, sizeof(body), "{\"device_id\":\"guide-cane-001\",\"latitude\":%.6f,\"longitude\":%.6f}",
+                            hour[i].latE6 / 1e6, hour[i].lonE6 / 1e6);
+    ++legacyRequests;
+  }
+
+  // 新方式：全部 3600 个点，每 120 个一批
+  const size_t kBatch = 120;
+  size_t batchRequests = 0;
+  size_t encodedBytes = 0;
+  size_t bodyBytes = 0;
+  for (size_t start = 0; start < hour.size(); start += kBatch)
+  {
+    size_t count = std::min(kBatch, hour.size() - start);
+    std::vector<uint8_t> out(trackEncodedBound(count));
+    TrackEncoder encoder(out.data(), out.size());
+    for (size_t i = 0; i < count; ++i)
+    {
+      encoder.add(hour[start + i]);
+    }
+    encodedBytes += encoder.length();
+    size_t base64Bytes = (encoder.length() + 2) / 3 * 4;
+    bodyBytes += base64Bytes + strlen("{\"device_id\":\"guide-cane-001\",\"format\":1,\"count\":120,\"track\":\"\"}");
+    ++batchRequests;
+  }
+
+  printf("  legacy  : %4zu requests, %6zu body bytes, %4zu points (every 5th fix)\n", legacyRequests, legacyBytes,
+         legacyRequests);
+  printf("  batched : %4zu requests, %6zu body bytes, %4zu points (%.2f encoded bytes/point)\n", batchRequests,
+         bodyBytes, hour.size(), static_cast<double>(encodedBytes) / hour.size());
+  printf("  %.0fx fewer requests, %.1fx the points in %.2fx the bytes\n",
+         static_cast<double>(legacyRequests) / batchRequests, static_cast<double>(hour.size()) / legacyRequests,
+         static_cast<double>(bodyBytes) / legacyBytes);
+  check(encodedBytes < hour.size() * 9, "under 9 encoded bytes per point");
+  check(bodyBytes < legacyBytes, "full-rate track smaller than 1-in-5 legacy uploads");
+}
+} // namespace
+
+int main()
+{
+  testEncoder();
+  testRing();
+  testUtc();
+  compareUploads();
+  printf(gErrors ? "\nFAILED (%d)\n" : "\nall checks passed\n", gErrors);
+  return gErrors ? 1 : 0;
+}
@@ -0,0 +1,134 @@
+// 主机端测试代替 Arduino-ESP32 核心头文件：只提供音频缓存/远程音频用到的 String、Stream、Serial、millis
+#pragma once
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <chrono>
+#include <string>
+
+class String
+{
+public:
+  String() = default;
+  String(const char *text) : value_(text ? text : "") {}
+  String(const std::string &text) : value_(text) {}
+
+  const char *c_str() const { return value_.c_str(); }
+  unsigned int length() const { return static_cast<unsigned int>(value_.size()); }
+  bool isEmpty() const { return value_.empty(); }
+  char operator[](unsigned int index) const { return index < value_.size() ? value_[index] : '\0'; }
+
+  bool startsWith(const String &prefix) const { return value_.compare(0, prefix.value_.size(), prefix.value_) == 0; }
+  bool endsWith(const String &suffix) const
+  {
+    return value_.size() >= suffix.value_.size() &&
+           value_.compare(value_.size() - suffix.value_.size(), suffix.value_.size(), suffix.value_) == 0;
+  }
+  int indexOf(char c) const
+  {
+    size_t at = value_.find(c);
+    return at == std::string::npos ? -1 : static_cast<int>(at);
+  }
+  int lastIndexOf(char c) const
+  {
+    size_t at = value_.rfind(c);
+    return at == std::string::npos ? -1 : static_cast<int>(at);
+  }
+  String substring(unsigned int from) const { return from < value_.size() ? String(value_.substr(from)) : String(); }
+  String substring(unsigned int from, unsigned int to) const
+  {
+    return from < value_.size() && from < to ? String(value_.substr(from, to - from)) : String();
+  }
+
+  String &operator+=(const String &other)
+  {
+    value_ += other.value_;
+    return *this;
+  }
+  friend String operator+(const String &a, const String &b) { return String(a.value_ + b.value_); }
+  friend String operator+(const String &a, const char *b) { return String(a.value_ + b); }
+  bool operator==(const String &other) const { return value_ == other.value_; }
+  bool operator==(const char *other) const { return value_ == other; }
+  bool operator!=(const String &other) const { return value_ != other.value_; }
+
+private:
+  std::string value_;
+};
+
+class Print
+{
+public:
+  virtual ~Print() = default;
+  virtual size_t write(uint8_t c) = 0;
+  virtual void flush() {}
+};
+
+class Stream : public Print
+{
+public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+  virtual size_t readBytes(char *buffer, size_t length)
+  {
+    size_t n = 0;
+    while (n < length)
+    {
+      int c = read();
+      if (c < 0)
+      {
+        break;
+      }
+      buffer[n++] = static_cast<char>(c);
+    }
+    return n;
+  }
+  size_t readBytes(uint8_t *buffer, size_t length) { return readBytes(reinterpret_cast<char *>(buffer), length); }
+};
+
+// 默认不输出固件日志，测试失败时把 enabled 打开看过程
+class HostSerial
+{
+public:
+  static inline bool enabled = false;
+
+  void printf(const char *format, ...) __attribute__((format(printf, 2, 3)))
+  {
+    if (!enabled)
+    {
+      return;
+    }
+    va_list args;
+    va_start(args, format);
+    vprintf(format, args);
+    va_end(args);
+  }
+  void println(const char *text)
+  {
+    if (enabled)
+    {
+      ::printf("%s\n", text);
+    }
+  }
+  void println(const String &text) { println(text.c_str()); }
+};
+
+inline HostSerial Serial;
+
+inline unsigned long millis()
+{
+  using namespace std::chrono;
+  static const steady_clock::time_point start = steady_clock::now();
+  return static_cast<unsigned long>(duration_cast<milliseconds>(steady_clock::now() - start).count());
+}
+
+template <typename T>
+inline T min(T a, T b)
+{
+  return b < a ? b : a;
+}
@@ -0,0 +1,161 @@
+// 主机端测试代替 Arduino-ESP32 的 FS.h：File 直接包一个宿主机文件或目录
+#pragma once
+
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "Arduino.h"
+
+namespace fs
+{
+class File : public Stream
+{
+public:
+  File() = default;
+
+  static File openFile(const std::string &hostPath, const char *mode)
+  {
+    File file;
+    FILE *fp = fopen(hostPath.c_str(), strcmp(mode, "w") == 0 ? "wb" : strcmp(mode, "a") == 0 ? "ab" : "rb");
+    if (fp != nullptr)
+    {
+      file.state_ = std::make_shared<State>();
+      file.state_->fp = fp;
+      file.state_->hostPath = hostPath;
+    }
+    return file;
+  }
+
+  static File openDirectory(const std::string &hostPath)
+  {
+    File file;
+    DIR *dir = opendir(hostPath.c_str());
+    if (dir == nullptr)
+    {
+      return file;
+    }
+    file.state_ = std::make_shared<State>();
+    file.state_->hostPath = hostPath;
+    file.state_->directory = true;
+    while (dirent *entry = readdir(dir))
+    {
+      if (strcmp(entry->d_name, ".") != 0 && strcmp(entry->d_name, "..") != 0)
+      {
+        file.state_->children.push_back(entry->d_name);
+      }
+    }
+    closedir(dir);
+    std::sort(file.state_->children.begin(), file.state_->children.end());
+    return file;
+  }
+
+  explicit operator bool() const { return state_ && (state_->fp != nullptr || state_->directory); }
+  bool isDirectory() const { return state_ && state_->directory; }
+
+  // 与 Arduino-ESP32 2.x 一致，只返回文件名
+  const char *name() const
+  {
+    if (!state_)
+    {
+      return "";
+    }
+    size_t slash = state_->hostPath.rfind('/');
+    return state_->hostPath.c_str() + (slash == std::string::npos ? 0 : slash + 1);
+  }
+
+  size_t size() const
+  {
+    struct stat info;
+    if (!state_ || state_->directory)
+    {
+      return 0;
+    }
+    if (state_->fp != nullptr)
+    {
+      fflush(state_->fp);
+    }
+    return stat(state_->hostPath.c_str(), &info) == 0 ? static_cast<size_t>(info.st_size) : 0;
+  }
+
+  File openNextFile()
+  {
+    if (!isDirectory() || state_->next >= state_->children.size())
+    {
+      return File();
+    }
+    std::string child = state_->hostPath + "/" + state_->children[state_->next++];
+    struct stat info;
+    if (stat(child.c_str(), &info) == 0 && S_ISDIR(info.st_mode))
+    {
+      return openDirectory(child);
+    }
+    return openFile(child, "r");
+  }
+
+  size_t write(uint8_t c) override { return write(&c, 1); }
+  size_t write(const uint8_t *data, size_t length)
+  {
+    return state_ && state_->fp ? fwrite(data, 1, length, state_->fp) : 0;
+  }
+
+  size_t read(uint8_t *buffer, size_t length) { return state_ && state_->fp ? fread(buffer, 1, length, state_->fp) : 0; }
+  int read() override
+  {
+    uint8_t c;
+    return read(&c, 1) == 1 ? c : -1;
+  }
+  int peek() override
+  {
+    int c = read();
+    if (c >= 0)
+    {
+      ungetc(c, state_->fp);
+    }
+    return c;
+  }
+  int available() override
+  {
+    if (!state_ || state_->fp == nullptr)
+    {
+      return 0;
+    }
+    long at = ftell(state_->fp);
+    return at < 0 ? 0 : static_cast<int>(size() - static_cast<size_t>(at));
+  }
+  size_t readBytes(char *buffer, size_t length) override { return read(reinterpret_cast<uint8_t *>(buffer), length); }
+
+  void close()
+  {
+    if (state_ && state_->fp != nullptr)
+    {
+      fclose(state_->fp);
+      state_->fp = nullptr;
+    }
+  }
+
+private:
+  struct State
+  {
+    ~State()
+    {
+      if (fp != nullptr)
+      {
+        fclose(fp);
+      }
+    }
+    FILE *fp = nullptr;
+    std::string hostPath;
+    bool directory = false;
+    std::vector<std::string> children;
+    size_t next = 0;
+  };
+
+  std::shared_ptr<State> state_;
+};
+} // namespace fs
+
+using fs::File;
@@ -0,0 +1,153 @@
+// 主机端测试代替 Arduino-ESP32 的 HTTPClient：只支持 http:// 的 GET，按 HTTP/1.0 读到连接关闭
+#pragma once
+
+#include <strings.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "WiFi.h"
+
+#define HTTP_CODE_OK 200
+#define HTTP_CODE_NOT_MODIFIED 304
+#define HTTPC_ERROR_CONNECTION_REFUSED (-1)
+#define HTTPC_ERROR_READ_TIMEOUT (-11)
+
+class HTTPClient
+{
+public:
+  bool begin(const String &url)
+  {
+    end();
+    std::string text = url.c_str();
+    if (text.compare(0, 7, "http://") != 0)
+    {
+      return false;
+    }
+    size_t slash = text.find('/', 7);
+    std::string authority = text.substr(7, slash == std::string::npos ? std::string::npos : slash - 7);
+    path_ = slash == std::string::npos ? "/" : text.substr(slash);
+    size_t colon = authority.find(':');
+    host_ = authority.substr(0, colon);
+    port_ = colon == std::string::npos ? 80 : static_cast<uint16_t>(atoi(authority.c_str() + colon + 1));
+    return !host_.empty();
+  }
+
+  void collectHeaders(const char *keys[], size_t count)
+  {
+    collected_.clear();
+    for (size_t i = 0; i < count; ++i)
+    {
+      collected_.emplace_back(keys[i], "");
+    }
+  }
+  void useHTTP10(bool) {}
+  void setTimeout(uint16_t timeoutMs) { timeoutMs_ = timeoutMs; }
+  void addHeader(const String &name, const String &value)
+  {
+    request_ += std::string(name.c_str()) + ": " + value.c_str() + "\r\n";
+  }
+
+  int GET()
+  {
+    if (!client_.connect(host_.c_str(), port_, timeoutMs_))
+    {
+      return HTTPC_ERROR_CONNECTION_REFUSED;
+    }
+    std::string head = "GET " + path_ + " HTTP/1.0\r\nHost: " + host_ + "\r\n" + request_ + "\r\n";
+    client_.write(reinterpret_cast<const uint8_t *>(head.data()), head.size());
+
+    std::string line;
+    int status = HTTPC_ERROR_READ_TIMEOUT;
+    bool first = true;
+    while (readLine(&line))
+    {
+      if (line.empty())
+      {
+        return status;
+      }
+      if (first)
+      {
+        first = false;
+        size_t space = line.find(' ');
+        status = space == std::string::npos ? HTTPC_ERROR_READ_TIMEOUT : atoi(line.c_str() + space + 1);
+        continue;
+      }
+      size_t colon = line.find(':');
+      if (colon == std::string::npos)
+      {
+        continue;
+      }
+      std::string name = line.substr(0, colon);
+      size_t start = line.find_first_not_of(' ', colon + 1);
+      std::string value = start == std::string::npos ? std::string() : line.substr(start);
+      if (strcasecmp(name.c_str(), "Content-Length") == 0)
+      {
+        size_ = atoi(value.c_str());
+      }
+      for (auto &header : collected_)
+      {
+        if (strcasecmp(header.first.c_str(), name.c_str()) == 0)
+        {
+          header.second = value;
+        }
+      }
+    }
+    return HTTPC_ERROR_READ_TIMEOUT;
+  }
+
+  WiFiClient *getStreamPtr() { return client_.connected() ? &client_ : nullptr; }
+  int getSize() const { return size_; }
+
+  String header(const char *name) const
+  {
+    for (const auto &header : collected_)
+    {
+      if (strcasecmp(header.first.c_str(), name) == 0)
+      {
+        return String(header.second);
+      }
+    }
+    return String();
+  }
+
+  void end()
+  {
+    client_.stop();
+    request_.clear();
+    size_ = -1;
+  }
+
+private:
+  bool readLine(std::string *line)
+  {
+    line->clear();
+    while (true)
+    {
+      int c = client_.read();
+      if (c < 0)
+      {
+        return false;
+      }
+      if (c == '\n')
+      {
+        if (!line->empty() && line->back() == '\r')
+        {
+          line->pop_back();
+        }
+        return true;
+      }
+      line->push_back(static_cast<char>(c));
+    }
+  }
+
+  WiFiClient client_;
+  std::string host_;
+  std::string path_;
+  uint16_t port_ = 80;
+  uint32_t timeoutMs_ = 5000;
+  std::string request_;
+  std::vector<std::pair<std::string, std::string>> collected_;
+  int size_ = -1;
+};
@@ -0,0 +1,48 @@
+// 主机端测试代替 LittleFS：设备路径映射到 setHostRoot() 指定的宿主机目录下
+#pragma once
+
+#include <stdio.h>
+#include <sys/stat.h>
+
+#include "FS.h"
+
+namespace fs
+{
+class LittleFSFS
+{
+public:
+  void setHostRoot(const std::string &root) { root_ = root; }
+  std::string hostPath(const char *path) const { return root_ + path; }
+
+  File open(const char *path, const char *mode = "r")
+  {
+    struct stat info;
+    std::string host = hostPath(path);
+    if (strcmp(mode, "r") == 0 && stat(host.c_str(), &info) == 0 && S_ISDIR(info.st_mode))
+    {
+      return File::openDirectory(host);
+    }
+    return File::openFile(host, mode);
+  }
+  File open(const String &path, const char *mode = "r") { return open(path.c_str(), mode); }
+
+  bool exists(const char *path) const
+  {
+    struct stat info;
+    return stat(hostPath(path).c_str(), &info) == 0;
+  }
+  bool exists(const String &path) const { return exists(path.c_str()); }
+  bool mkdir(const char *path) { return ::mkdir(hostPath(path).c_str(), 0755) == 0; }
+  bool remove(const char *path) { return ::remove(hostPath(path).c_str()) == 0; }
+  bool remove(const String &path) { return remove(path.c_str()); }
+  bool rename(const String &from, const String &to)
+  {
+    return ::rename(hostPath(from.c_str()).c_str(), hostPath(to.c_str()).c_str()) == 0;
+  }
+
+private:
+  std::string root_ = ".";
+};
+} // namespace fs
+
+inline fs::LittleFSFS LittleFS;
@@ -0,0 +1,126 @@
+// 主机端测试代替 Arduino-ESP32 的 WiFi.h：WiFiClient 是普通 TCP 套接字，联网状态由测试设置
+#pragma once
+
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include "Arduino.h"
+
+typedef enum
+{
+  WL_IDLE_STATUS = 0,
+  WL_CONNECTED = 3,
+  WL_DISCONNECTED = 6,
+} wl_status_t;
+
+class WiFiClient : public Stream
+{
+public:
+  WiFiClient() = default;
+  ~WiFiClient() { stop(); }
+  WiFiClient(const WiFiClient &) = delete;
+  WiFiClient &operator=(const WiFiClient &) = delete;
+
+  bool connect(const char *host, uint16_t port, uint32_t timeoutMs)
+  {
+    stop();
+    addrinfo hints = {};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo *address = nullptr;
+    char service[8];
+    snprintf(service, sizeof(service), "%u", port);
+    if (getaddrinfo(host, service, &hints, &address) != 0)
+    {
+      return false;
+    }
+    fd_ = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+    timeval timeout = {static_cast<time_t>(timeoutMs / 1000), static_cast<suseconds_t>(timeoutMs % 1000 * 1000)};
+    bool ok = fd_ >= 0 && setsockopt(fd_, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)) == 0 &&
+              ::connect(fd_, address->ai_addr, address->ai_addrlen) == 0;
+    freeaddrinfo(address);
+    if (!ok)
+    {
+      stop();
+    }
+    return ok;
+  }
+
+  bool connected() const { return fd_ >= 0; }
+
+  void stop()
+  {
+    if (fd_ >= 0)
+    {
+      close(fd_);
+      fd_ = -1;
+    }
+  }
+
+  size_t write(uint8_t c) override { return write(&c, 1); }
+  size_t write(const uint8_t *data, size_t length)
+  {
+    size_t sent = 0;
+    while (fd_ >= 0 && sent < length)
+    {
+      ssize_t n = send(fd_, data + sent, length - sent, MSG_NOSIGNAL);
+      if (n <= 0)
+      {
+        break;
+      }
+      sent += static_cast<size_t>(n);
+    }
+    return sent;
+  }
+
+  int available() override
+  {
+    int pending = 0;
+    return fd_ >= 0 && ioctl(fd_, FIONREAD, &pending) == 0 ? pending : 0;
+  }
+  int read() override
+  {
+    uint8_t c;
+    return fd_ >= 0 && recv(fd_, &c, 1, 0) == 1 ? c : -1;
+  }
+  int peek() override
+  {
+    uint8_t c;
+    return fd_ >= 0 && recv(fd_, &c, 1, MSG_PEEK) == 1 ? c : -1;
+  }
+  // 与 Stream::readBytes 一致：读满 length 或超时/连接关闭为止
+  size_t readBytes(char *buffer, size_t length) override
+  {
+    size_t got = 0;
+    while (fd_ >= 0 && got < length)
+    {
+      ssize_t n = recv(fd_, buffer + got, length - got, 0);
+      if (n <= 0)
+      {
+        break;
+      }
+      got += static_cast<size_t>(n);
+    }
+    return got;
+  }
+
+private:
+  int fd_ = -1;
+};
+
+class WiFiClass
+{
+public:
+  wl_status_t status() const { return status_; }
+  void setHostStatus(wl_status_t status) { status_ = status; }
+
+private:
+  wl_status_t status_ = WL_CONNECTED;
+};
+
+inline WiFiClass WiFi;
@@ -0,0 +1,19 @@
+// 主机端测试代替 ESP-IDF 的 esp_heap_caps.h：能力位忽略，直接走 malloc/calloc
+#pragma once
+
+#include <stdlib.h>
+
+#define MALLOC_CAP_8BIT (1 << 2)
+#define MALLOC_CAP_SPIRAM (1 << 10)
+
+static inline void *heap_caps_malloc(size_t size, unsigned caps)
+{
+  (void)caps;
+  return malloc(size);
+}
+
+static inline void *heap_caps_calloc(size_t count, size_t size, unsigned caps)
+{
+  (void)caps;
+  return calloc(count, size);
+}
@@ -0,0 +1,12 @@
+// 主机端构建 ESP-NN 版 TFLM 内核时代替 ESP-IDF 的 esp_timer.h，内核只用它累计耗时
+#pragma once
+
+#include <stdint.h>
+#include <time.h>
+
+static inline int64_t esp_timer_get_time(void)
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (int64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
@@ -0,0 +1,12 @@
+// 主机端测试代替 FreeRTOS.h：只有被测代码用到的类型和常量
+#pragma once
+
+#include <stdint.h>
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+
+#define pdFALSE 0
+#define pdTRUE 1
+#define portMAX_DELAY 0xFFFFFFFFu
+#define portTICK_PERIOD_MS 1
@@ -0,0 +1,30 @@
+// 主机端测试代替 FreeRTOS semphr.h：互斥量用 std::timed_mutex
+#pragma once
+
+#include <chrono>
+#include <mutex>
+
+#include "FreeRTOS.h"
+
+typedef std::timed_mutex *SemaphoreHandle_t;
+
+static inline SemaphoreHandle_t xSemaphoreCreateMutex()
+{
+  return new std::timed_mutex();
+}
+
+static inline BaseType_t xSemaphoreTake(SemaphoreHandle_t mutex, TickType_t ticks)
+{
+  if (ticks == portMAX_DELAY)
+  {
+    mutex->lock();
+    return pdTRUE;
+  }
+  return mutex->try_lock_for(std::chrono::milliseconds(ticks * portTICK_PERIOD_MS)) ? pdTRUE : pdFALSE;
+}
+
+static inline BaseType_t xSemaphoreGive(SemaphoreHandle_t mutex)
+{
+  mutex->unlock();
+  return pdTRUE;
+}
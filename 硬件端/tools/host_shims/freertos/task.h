@@ -0,0 +1,14 @@
+// 主机端测试代替 FreeRTOS task.h
+#pragma once
+
+#include <chrono>
+#include <thread>
+
+#include "FreeRTOS.h"
+
+typedef void *TaskHandle_t;
+
+static inline void vTaskDelay(TickType_t ticks)
+{
+  std::this_thread::sleep_for(std::chrono::milliseconds(ticks * portTICK_PERIOD_MS));
+}
@@ -0,0 +1,128 @@
+// Host runner for the per-node profiler of the EON-compiled wake-word model.
+//
+// Builds tflite_learn_3_compiled.cpp with EI_COMPILED_MODEL_PROFILING=1, runs
+// init -> invoke -> reset the same way tflite_eon.h does for every window, then
+// prints the per-node table and optionally writes the JSON export. Linking the
+// TFLM reference kernels or the ESP-NN generic/ANSI kernels gives a per-layer
+// comparison on Linux; the same profile on target comes from a firmware build
+// with -DEI_COMPILED_MODEL_PROFILING=1.
+//
+/*
+ *   S=lib/_3_inferencing/src; K=$S/edge-impulse-sdk/tensorflow/lite
+ *   KERNELS="$K/micro/kernels/{conv,conv_common,pooling,pooling_common,fully_connected,fully_connected_common}.cpp
+ *            $K/micro/kernels/{softmax,softmax_common,reshape,kernel_util_micro}.cpp"
+ *   COMMON="$K/kernels/internal/{quantization_util,portable_tensor_utils}.cpp $K/kernels/kernel_util_lite.cpp
+ *           $K/core/api/common.cpp $K/micro/{micro_utils,micro_context,memory_helpers}.cpp"
+ *
+ *   # TFLM reference kernels
+ *   g++ -std=c++17 -O2 -I$S -DTF_LITE_STATIC_MEMORY -DEI_CLASSIFIER_TFLITE_ENABLE_ESP_NN=0 \
+ *     -DEI_COMPILED_MODEL_PROFILING=1 tools/model_profile.cpp $KERNELS $COMMON -o model_profile_ref
+ *
+ *   # ESP-NN kernels (generic C on the host; the S3 assembly only builds for target).
+ *   # The C sources are compiled separately; esp_timer.h comes from tools/host_shims.
+ *   N=$S/edge-impulse-sdk/porting/espressif/ESP-NN
+ *   for f in convolution/esp_nn_conv_{ansi,opt} pooling/esp_nn_max_pool_ansi \
+ *            fully_connected/esp_nn_fully_connected_ansi softmax/esp_nn_softmax_{ansi,opt}; do
+ *     gcc -c -O2 -I$S -DEI_CLASSIFIER_TFLITE_ENABLE_ESP_NN=1 $N/src/$f.c -o $(basename $f).o
+ *   done
+ *   g++ -std=c++17 -O2 -I$S -Itools/host_shims -DTF_LITE_STATIC_MEMORY -DEI_CLASSIFIER_TFLITE_ENABLE_ESP_NN=1 \
+ *     -DEI_COMPILED_MODEL_PROFILING=1 tools/model_profile.cpp $KERNELS $COMMON esp_nn_*.o -o model_profile_esp_nn
+ *
+ *   ./model_profile_ref [windows] [profile.json]
+ */
+
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "../lib/_3_inferencing/src/tflite-model/tflite_learn_3_compiled.cpp"
+#include "edge-impulse-sdk/tensorflow/lite/core/api/flatbuffer_conversions.h"
+#include "edge-impulse-sdk/tensorflow/lite/micro/micro_allocator.h"
+
+// 固件里由 Edge Impulse 移植层和 TFLM 解释器提供；主机端给出最小实现
+void ei_printf(const char *format, ...)
+{
+  va_list args;
+  va_start(args, format);
+  vprintf(format, args);
+  va_end(args);
+}
+void *ei_calloc(size_t count, size_t size) { return calloc(count, size); }
+void ei_free(void *pointer) { free(pointer); }
+uint64_t ei_read_timer_us()
+{
+  static const auto origin = std::chrono::steady_clock::now();
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - origin).count();
+}
+void Log(const char *format, va_list args) { vprintf(format, args); }
+
+namespace tflite
+{
+TfLiteStatus MicroAllocator::RequestScratchBufferInArena(size_t, int, int *) { return kTfLiteError; }
+TfLiteStatus ConvertTensorType(TensorType, TfLiteType *) { return kTfLiteError; }
+} // namespace tflite
+
+namespace
+{
+void *alignedAlloc(size_t alignment, size_t size)
+{
+  alignment = alignment < 16 ? 16 : alignment;
+  return calloc(1, (size + alignment - 1) / alignment * alignment);
+}
+} // namespace
+
+int main(int argc, char **argv)
+{
+  long windows = argc > 1 ? strtol(argv[1], nullptr, 10) : 2000;
+  const char *jsonPath = argc > 2 ? argv[2] : nullptr;
+
+  std::mt19937 rng(20261019);
+  std::uniform_int_distribution<int> value(-128, 127);
+  tflite_learn_3_profile_reset();
+  for (long n = 0; n < windows; ++n)
+  {
+    if (tflite_learn_3_init(alignedAlloc) != kTfLiteOk)
+    {
+      fprintf(stderr, "model init failed\n");
+      return 1;
+    }
+    TfLiteTensor input;
+    tflite_learn_3_input(0, &input);
+    for (size_t i = 0; i < input.bytes; ++i)
+    {
+      input.data.int8[i] = static_cast<int8_t>(value(rng));
+    }
+    if (tflite_learn_3_invoke() != kTfLiteOk)
+    {
+      fprintf(stderr, "invoke failed\n");
+      return 1;
+    }
+    tflite_learn_3_reset(free);
+  }
+
+  tflite_learn_3_profile_print();
+
+  size_t length = tflite_learn_3_profile_json(nullptr, 0);
+  std::vector<char> json(length + 1);
+  tflite_learn_3_profile_json(json.data(), json.size());
+  if (jsonPath)
+  {
+    FILE *file = fopen(jsonPath, "w");
+    if (!file)
+    {
+      fprintf(stderr, "cannot write %s\n", jsonPath);
+      return 1;
+    }
+    fputs(json.data(), file);
+    fclose(file);
+    printf("json: %s (%zu bytes)\n", jsonPath, length);
+  }
+  else
+  {
+    printf("%s\n", json.data());
+  }
+  return 0;
+}
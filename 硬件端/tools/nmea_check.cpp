@@ -0,0 +1,446 @@
+// Host corpus test and throughput benchmark for the NMEA parser
+// (src/utils/nmea_parser.cpp).
+//
+// 1. Corpus: RMC/GGA/VTG/GSA from GP, GN, BD and GL talkers; empty fields
+//    (",,") in every position the receiver leaves blank; cold-start sentences
+//    with status V / quality 0; bad, missing and lower-case checksums; truncated
+//    sentences followed by a new '$'; over-long lines; CR-less line endings;
+//    byte-by-byte and random chunking through the zero-copy writeBuffer/commit path.
+// 2. Throughput in sentences/sec for a typical 1 Hz receiver burst (RMC, VTG,
+//    GGA, GSA, 3x GSV, TXT), against the previous strtok_r RMC-only parser.
+//
+/*
+ *   g++ -std=c++17 -O2 -Wall tools/nmea_check.cpp -o nmea_check
+ *   ./nmea_check
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../src/utils/nmea_parser.cpp"
+
+namespace
+{
+int gErrors = 0;
+
+void check(bool condition, const char *what)
+{
+  if (!condition)
+  {
+    printf("  FAIL: %s\n", what);
+    ++gErrors;
+  }
+}
+
+bool near(double a, double b, double tolerance = 1e-7)
+{
+  return std::fabs(a - b) <= tolerance;
+}
+
+// 给语句体（不含 '$' 和 '*hh'）补上校验和
+std::string sentence(const char *body)
+{
+  uint8_t sum = 0;
+  for (const char *p = body; *p != '\0'; ++p)
+  {
+    sum ^= static_cast<uint8_t>(*p);
+  }
+  char tail[8];
+  snprintf(tail, sizeof(tail), "*%02X\r\n", sum);
+  return std::string("$") + body + tail;
+}
+
+uint8_t feedAll(NmeaParser &parser, const std::string &data)
+{
+  return parser.feed(data.data(), data.size());
+}
+
+// ---------------------------------------------------------------------------
+// 1. 语料
+// ---------------------------------------------------------------------------
+void testRmc()
+{
+  printf("RMC\n");
+  NmeaParser parser;
+  // 真实接收机样例（u-blox，带已知校验和）
+  uint8_t got = feedAll(parser, "$GPRMC,083559.00,A,4717.11437,N,00833.91522,E,0.004,77.52,091202,,,A*57\r\n");
+  const NmeaFix &fix = parser.fix();
+  check(got == NmeaParser::Rmc, "u-blox RMC decoded");
+  check(fix.positionValid, "RMC A is valid");
+  check(near(fix.latitude, 47.0 + 17.11437 / 60.0), "RMC latitude");
+  check(near(fix.longitude, 8.0 + 33.91522 / 60.0), "RMC longitude");
+  check(near(fix.speedKmh, 0.004 * 1.852, 1e-5), "RMC knots -> km/h");
+  check(near(fix.courseDeg, 77.52, 1e-4), "RMC course");
+  check(strcmp(fix.utcTime, "083559.00") == 0, "RMC utc time");
+  check(strcmp(fix.utcDate, "091202") == 0, "RMC utc date");
+
+  // 南纬西经、北斗 talker、静止时航向为空
+  got = feedAll(parser, sentence("BDRMC,235959.000,A,3352.1280,S,15112.5610,W,0.00,,311224,,,D"));
+  check(got == NmeaParser::Rmc, "BD RMC decoded");
+  check(near(fix.latitude, -(33.0 + 52.128 / 60.0)), "south latitude negative");
+  check(near(fix.longitude, -(151.0 + 12.561 / 60.0)), "west longitude negative");
+  check(std::isnan(fix.courseDeg), "empty course is NAN");
+  check(near(fix.speedKmh, 0.0), "zero speed");
+
+  // 冷启动：V 状态、位置字段全空，保留上一次坐标但标记无效
+  got = feedAll(parser, sentence("GNRMC,000012.00,V,,,,,,,060180,,,N"));
+  check(got == NmeaParser::Rmc, "cold-start RMC still decoded");
+  check(!fix.positionValid, "RMC V is invalid");
+  check(near(fix.latitude, -(33.0 + 52.128 / 60.0)), "invalid RMC keeps last coordinate");
+  check(std::isnan(fix.speedKmh), "empty speed is NAN");
+
+  // 状态 A 但模式 N（数据无效）
+  feedAll(parser, sentence("GNRMC,120000.00,A,3958.12345,N,11623.45678,E,1.0,90.0,010125,,,N"));
+  check(!fix.positionValid, "RMC mode N is invalid");
+  feedAll(parser, sentence("GNRMC,120001.00,A,3958.12345,N,11623.45678,E,1.0,90.0,010125,,,A"));
+  check(fix.positionValid && near(fix.latitude, 39.0 + 58.12345 / 60.0), "RMC mode A is valid");
+  check(near(fix.longitude, 116.0 + 23.45678 / 60.0), "3-digit degree longitude");
+
+  // NMEA 2.2 之前没有模式字段
+  got = feedAll(parser, sentence("GPRMC,120002,A,3958.1,N,11623.4,E,,,010125,,"));
+  check(got == NmeaParser::Rmc && fix.positionValid, "RMC without mode field");
+
+  // 状态 A 但坐标为空 / 坐标格式错误 / 分 >= 60：格式错误，不改变状态
+  NmeaStats before = parser.stats();
+  check(feedAll(parser, sentence("GPRMC,120003,A,,,,,0.0,0.0,010125,,,A")) == 0, "A with empty position rejected");
+  check(feedAll(parser, sentence("GPRMC,120003,A,39x8.1,N,11623.4,E,0.0,0.0,010125,,,A")) == 0, "garbage latitude rejected");
+  check(feedAll(parser, sentence("GPRMC,120003,A,3961.0,N,11623.4,E,0.0,0.0,010125,,,A")) == 0, "minutes >= 60 rejected");
+  check(feedAll(parser, sentence("GPRMC,120003,A,3958.1,X,11623.4,E,0.0,0.0,010125,,,A")) == 0, "bad hemisphere rejected");
+  check(feedAll(parser, sentence("GPRMC,120003,A,3958.1,N")) == 0, "too few fields rejected");
+  check(parser.stats().malformed == before.malformed + 5, "malformed counted");
+  check(strcmp(fix.utcTime, "120002") == 0, "malformed sentence leaves fix untouched");
+}
+
+void testGga()
+{
+  printf("GGA\n");
+  NmeaParser parser;
+  const NmeaFix &fix = parser.fix();
+  uint8_t got = feedAll(parser, "$GPGGA,092725.00,4717.11399,N,00833.91590,E,1,08,1.01,499.6,M,48.0,M,,*5B\r\n");
+  check(got == NmeaParser::Gga, "u-blox GGA decoded");
+  check(fix.positionValid && fix.quality == 1, "GGA quality 1");
+  check(fix.satellites == 8, "GGA satellites");
+  check(near(fix.hdop, 1.01, 1e-5), "GGA hdop");
+  check(near(fix.altitudeM, 499.6, 1e-4), "GGA altitude");
+  check(near(fix.latitude, 47.0 + 17.11399 / 60.0), "GGA latitude");
+
+  got = feedAll(parser, sentence("GNGGA,092726.00,,,,,0,00,99.99,,,,,,"));
+  check(got == NmeaParser::Gga, "no-fix GGA decoded");
+  check(!fix.positionValid && fix.quality == 0 && fix.satellites == 0, "GGA quality 0 invalid");
+  check(std::isnan(fix.altitudeM), "no-fix altitude NAN");
+  check(near(fix.hdop, 99.99, 1e-4), "no-fix hdop");
+
+  got = feedAll(parser, sentence("GLGGA,092727.00,5530.0000,N,03730.0000,E,2,12,,150.0,M,,M,,"));
+  check(got == NmeaParser::Gga && fix.quality == 2, "GL talker DGPS");
+  check(std::isnan(fix.hdop), "empty hdop is NAN");
+  check(feedAll(parser, sentence("GPGGA,092728.00,5530.0,N,03730.0,E,1,300,1.0,1.0,M,,M,,")) == 0,
+        "satellite count overflow rejected");
+}
+
+void testVtgGsa()
+{
+  printf("VTG / GSA\n");
+  NmeaParser parser;
+  const NmeaFix &fix = parser.fix();
+  uint8_t got = feedAll(parser, "$GPVTG,77.52,T,,M,0.004,N,0.008,K,A*06\r\n");
+  check(got == NmeaParser::Vtg, "u-blox VTG decoded");
+  check(near(fix.courseDeg, 77.52, 1e-4) && near(fix.speedKmh, 0.008, 1e-6), "VTG course and km/h");
+
+  feedAll(parser, sentence("GNVTG,,T,,M,2.5,N,,K,A"));
+  check(std::isnan(fix.courseDeg), "VTG empty course NAN");
+  check(near(fix.speedKmh, 2.5 * 1.852, 1e-5), "VTG falls back to knots");
+
+  got = feedAll(parser, "$GPGSA,A,3,23,29,07,08,09,18,26,28,,,,,1.94,1.18,1.54*0D\r\n");
+  check(got == NmeaParser::Gsa, "u-blox GSA decoded");
+  check(fix.fixMode == 3 && near(fix.pdop, 1.94, 1e-5) && near(fix.hdop, 1.18, 1e-5) && near(fix.vdop, 1.54, 1e-5),
+        "GSA dops");
+  // NMEA 4.1 多了 systemId 字段
+  got = feedAll(parser, sentence("GNGSA,A,2,01,02,03,,,,,,,,,,2.5,2.0,,1"));
+  check(got == NmeaParser::Gsa && fix.fixMode == 2, "GSA 4.1 decoded");
+  check(std::isnan(fix.vdop) && near(fix.hdop, 2.0, 1e-5), "GSA empty vdop NAN");
+  got = feedAll(parser, sentence("GNGSA,A,1,,,,,,,,,,,,,,,"));
+  check(got == NmeaParser::Gsa && fix.fixMode == 1, "GSA no fix");
+  check(near(fix.hdop, 2.0, 1e-5), "empty GSA hdop keeps GGA/GSA value");
+}
+
+void testFraming()
+{
+  printf("framing and checksums\n");
+  NmeaParser parser;
+  const NmeaFix &fix = parser.fix();
+  std::string good = sentence("GPRMC,101010.00,A,3000.0000,N,12000.0000,E,0.0,0.0,010125,,,A");
+
+  std::string bad = good;
+  bad[20] = bad[20] == '1' ? '2' : '1';
+  check(feedAll(parser, bad) == 0 && parser.stats().checksumErrors == 1, "bad checksum rejected");
+  check(!fix.positionValid, "bad checksum does not update");
+
+  check(feedAll(parser, "$GPRMC,101010.00,A,3000.0000,N,12000.0000,E,0.0,0.0,010125,,,A\r\n") == 0,
+        "missing checksum rejected");
+  std::string truncatedChecksum = good.substr(0, good.size() - 3) + "\r\n";
+  check(feedAll(parser, truncatedChecksum) == 0, "one-digit checksum rejected");
+  check(parser.stats().checksumErrors == 3, "checksum errors counted");
+
+  std::string lower = good;
+  for (char &c : lower)
+  {
+    if (c >= 'A' && c <= 'F' && &c > &lower[lower.size() - 5])
+    {
+      c = static_cast<char>(c - 'A' + 'a');
+    }
+  }
+  check(feedAll(parser, lower) == NmeaParser::Rmc, "lower-case checksum accepted");
+
+  // 只有 LF，没有 CR
+  std::string lfOnly = sentence("GPGGA,101011.00,3000.0000,N,12000.0000,E,1,05,1.5,10.0,M,,M,,");
+  lfOnly.erase(lfOnly.size() - 2, 1);
+  check(feedAll(parser, lfOnly) == NmeaParser::Gga, "LF-only line");
+
+  // 截断的语句后紧跟新的 '$'：前半句丢弃，后一句照常解码
+  std::string cut = good.substr(0, 30) + good;
+  NmeaStats before = parser.stats();
+  check(feedAll(parser, cut) == NmeaParser::Rmc, "sentence after truncated one");
+  check(parser.stats().checksumErrors == before.checksumErrors + 1, "truncated fragment counted");
+
+  // 噪声、空行、专有语句、GSV/TXT
+  before = parser.stats();
+  feedAll(parser, "\r\n\r\ngarbage\r\n");
+  feedAll(parser, sentence("PUBX,00,101012.00,3000.0000,N"));
+  feedAll(parser, sentence("GPGSV,3,1,12,01,40,083,46,02,17,308,41,12,07,344,39,14,22,228,45"));
+  feedAll(parser, sentence("GPTXT,01,01,02,ANTSTATUS=OK"));
+  check(parser.stats().ignored == before.ignored + 3, "PUBX/GSV/TXT ignored");
+  check(parser.stats().sentences == before.sentences, "nothing decoded from noise");
+
+  // 超长行：丢到下一个行尾，之后恢复
+  std::string longLine = "$GPTXT," + std::string(300, 'x') + "\r\n";
+  before = parser.stats();
+  check(feedAll(parser, longLine + good) == NmeaParser::Rmc, "recovers after over-long line");
+  check(parser.stats().overflows == before.overflows + 1, "overflow counted");
+  check(parser.stats().bytes == before.bytes + longLine.size() + good.size(), "bytes counted");
+}
+
+void testChunking()
+{
+  printf("chunking\n");
+  std::vector<std::string> burst = {
+      sentence("GNRMC,101010.00,A,3958.12345,N,11623.45678,E,0.5,45.0,010125,,,A"),
+      sentence("GNVTG,45.0,T,,M,0.5,N,0.9,K,A"),
+      sentence("GNGGA,101010.00,3958.12345,N,11623.45678,E,1,09,0.9,45.2,M,-8.0,M,,"),
+      sentence("GNGSA,A,3,01,02,03,04,05,06,07,08,09,,,,1.5,0.9,1.2,1"),
+      sentence("GPGSV,3,1,12,01,40,083,46,02,17,308,41,12,07,344,39,14,22,228,45"),
+  };
+  std::string stream;
+  for (int i = 0; i < 20; ++i)
+  {
+    for (const std::string &s : burst)
+    {
+      stream += s;
+    }
+  }
+
+  NmeaParser whole;
+  feedAll(whole, stream);
+
+  // 逐字节
+  NmeaParser bytewise;
+  uint8_t all = 0;
+  for (char c : stream)
+  {
+    all |= bytewise.feed(&c, 1);
+  }
+  check(all == (NmeaParser::Rmc | NmeaParser::Gga | NmeaParser::Vtg | NmeaParser::Gsa), "byte-wise sees all types");
+  check(memcmp(&bytewise.stats(), &whole.stats(), sizeof(NmeaStats)) == 0, "byte-wise stats match");
+
+  // 随机分块，走 writeBuffer/commit（串口直接读进缓冲区的路径）
+  std::mt19937 rng(4711);
+  for (int round = 0; round < 200; ++round)
+  {
+    NmeaParser parser;
+    size_t offset = 0;
+    while (offset < stream.size())
+    {
+      size_t room = 0;
+      char *dest = parser.writeBuffer(&room);
+      size_t want = 1 + rng() % 160;
+      size_t n = std::min({want, room, stream.size() - offset});
+      memcpy(dest, stream.data() + offset, n);
+      parser.commit(n);
+      offset += n;
+    }
+    if (memcmp(&parser.stats(), &whole.stats(), sizeof(NmeaStats)) != 0 ||
+        memcmp(&parser.fix(), &whole.fix(), sizeof(NmeaFix)) != 0)
+    {
+      check(false, "random chunking matches whole-buffer parse");
+      break;
+    }
+  }
+  const NmeaFix &fix = whole.fix();
+  check(whole.stats().sentences == 80 && whole.stats().ignored == 20, "burst counts");
+  check(fix.positionValid && fix.quality == 1 && fix.satellites == 9 && fix.fixMode == 3, "burst fix");
+  check(near(fix.speedKmh, 0.9, 1e-6) && near(fix.hdop, 0.9, 1e-6) && near(fix.altitudeM, 45.2, 1e-4),
+        "burst values from the last sentence of each kind");
+}
+
+// ---------------------------------------------------------------------------
+// 2. 吞吐
+// ---------------------------------------------------------------------------
+// 改造前 gps.cpp 的解析：逐字节拼行，strtok_r 切分（连续逗号会被合并），只认 RMC
+namespace legacy
+{
+char sentenceBuffer[128];
+size_t sentenceIndex = 0;
+double latitude = 0.0;
+double longitude = 0.0;
+bool valid = false;
+
+double nmeaToDecimal(const char *value)
+{
+  double raw = atof(value);
+  int degrees = static_cast<int>(raw / 100);
+  double minutes = raw - (degrees * 100);
+  return degrees + minutes / 60.0;
+}
+
+void parseRmcSentence(char *sentence)
+{
+  char *fields[16] = {0};
+  int fieldCount = 0;
+  char *context = nullptr;
+  char *token = strtok_r(sentence, ",", &context);
+  while (token != nullptr && fieldCount < 16)
+  {
+    fields[fieldCount++] = token;
+    token = strtok_r(nullptr, ",", &context);
+  }
+  if (fieldCount < 7)
+  {
+    return;
+  }
+  if (strcmp(fields[2], "A") != 0)
+  {
+    valid = false;
+    return;
+  }
+  latitude = nmeaToDecimal(fields[3]);
+  longitude = nmeaToDecimal(fields[5]);
+  if (fields[4][0] == 'S')
+  {
+    latitude = -latitude;
+  }
+  if (fields[6][0] == 'W')
+  {
+    longitude = -longitude;
+  }
+  valid = true;
+}
+
+void feed(const char *data, size_t length)
+{
+  for (size_t i = 0; i < length; ++i)
+  {
+    char c = data[i];
+    if (c == '\r')
+    {
+      continue;
+    }
+    if (c == '\n')
+    {
+      sentenceBuffer[sentenceIndex] = '\0';
+      if (sentenceIndex >= 6 && sentenceBuffer[0] == '$' && sentenceBuffer[3] == 'R' && sentenceBuffer[4] == 'M' &&
+          sentenceBuffer[5] == 'C')
+      {
+        parseRmcSentence(sentenceBuffer);
+      }
+      sentenceIndex = 0;
+      continue;
+    }
+    if (sentenceIndex < sizeof(sentenceBuffer) - 1)
+    {
+      sentenceBuffer[sentenceIndex++] = c;
+    }
+    else
+    {
+      sentenceIndex = 0;
+    }
+  }
+}
+} // namespace legacy
+
+template <typename Fn>
+double sentencesPerSecond(size_t sentencesPerPass, Fn &&pass)
+{
+  size_t passes = 0;
+  auto start = std::chrono::steady_clock::now();
+  double elapsed = 0.0;
+  do
+  {
+    for (int i = 0; i < 100; ++i)
+    {
+      pass();
+    }
+    passes += 100;
+    elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  } while (elapsed < 0.5);
+  return static_cast<double>(passes * sentencesPerPass) / elapsed;
+}
+
+void benchmark()
+{
+  printf("\nthroughput (1 Hz burst: RMC VTG GGA GSA 3xGSV TXT, UART-sized 64-byte reads)\n");
+  std::string burst = sentence("GNRMC,101010.00,A,3958.12345,N,11623.45678,E,0.512,45.31,010125,,,A") +
+                      sentence("GNVTG,45.31,T,,M,0.512,N,0.948,K,A") +
+                      sentence("GNGGA,101010.00,3958.12345,N,11623.45678,E,1,09,0.92,45.2,M,-8.0,M,,") +
+                      sentence("GNGSA,A,3,01,02,03,04,05,06,07,08,09,,,,1.51,0.92,1.20,1") +
+                      sentence("GPGSV,3,1,12,01,40,083,46,02,17,308,41,12,07,344,39,14,22,228,45") +
+                      sentence("GPGSV,3,2,12,15,60,130,48,17,11,040,35,19,33,270,44,24,50,180,47") +
+                      sentence("GPGSV,3,3,12,25,05,120,30,29,70,300,49,31,15,020,38,32,25,210,42") +
+                      sentence("GPTXT,01,01,02,ANTSTATUS=OK");
+  const size_t kSentences = 8;
+  const size_t kRead = 64;
+
+  NmeaParser parser;
+  double fresh = sentencesPerSecond(kSentences, [&]() {
+    size_t offset = 0;
+    while (offset < burst.size())
+    {
+      size_t room = 0;
+      char *dest = parser.writeBuffer(&room);
+      size_t n = std::min({kRead, room, burst.size() - offset});
+      memcpy(dest, burst.data() + offset, n); // 板上这一步就是 gpsSerial.read(dest, n)
+      parser.commit(n);
+      offset += n;
+    }
+  });
+  double old = sentencesPerSecond(kSentences, [&]() {
+    for (size_t offset = 0; offset < burst.size(); offset += kRead)
+    {
+      legacy::feed(burst.data() + offset, std::min(kRead, burst.size() - offset));
+    }
+  });
+  check(parser.fix().positionValid && legacy::valid, "benchmark parsers saw fixes");
+  check(near(parser.fix().latitude, legacy::latitude, 1e-9) && near(parser.fix().longitude, legacy::longitude, 1e-9),
+        "same coordinates as legacy parser");
+  printf("  legacy strtok_r (RMC only, no checksum): %10.0f sentences/s\n", old);
+  printf("  NmeaParser (4 types, checksummed):       %10.0f sentences/s  (%.2fx)\n", fresh, fresh / old);
+  printf("  at 9600 baud a receiver emits < 20 sentences/s\n");
+}
+} // namespace
+
+int main()
+{
+  testRmc();
+  testGga();
+  testVtgGsa();
+  testFraming();
+  testChunking();
+  benchmark();
+  printf(gErrors ? "\nFAILED (%d)\n" : "\nall checks passed\n", gErrors);
+  return gErrors ? 1 : 0;
+}
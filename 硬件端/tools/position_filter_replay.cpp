@@ -0,0 +1,544 @@
+// Host replay test for the GPS position estimator (src/utils/position_filter.cpp).
+//
+// Walks synthetic routes at 1.2 m/s with 1 Hz fixes (3 m white noise plus a
+// slowly drifting bias, HDOP, and RMC speed/course with their own noise) and
+// compares what navigation would see from the raw last fix against the filter:
+// error at fix time, error when queried at 10 Hz between fixes, how far the
+// position jumps per query, and how the estimate coasts through dropouts and
+// multipath jumps in an urban canyon. The checks fail the run if the filter is
+// not better than the raw fixes where it should be, or stays "valid" when it
+// should not.
+//
+// Recorded tracks can be replayed instead, either a raw NMEA log from the GPS
+// UART (parsed with src/utils/nmea_parser.cpp, time from RMC UTC) or a CSV of
+// "t_ms,lat,lng[,hdop,speed_kmh,course_deg]" lines; without ground truth it
+// reports rejected fixes, dropouts and per-second position jumps.
+//
+/*
+ *   g++ -std=c++17 -O2 -Wall tools/position_filter_replay.cpp -o position_filter_replay
+ *   ./position_filter_replay                 # built-in scenarios
+ *   ./position_filter_replay gps.nmea        # replay a recorded NMEA log
+ *   ./position_filter_replay track.csv       # replay a recorded CSV track
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../src/utils/nmea_parser.cpp"
+#include "../src/utils/position_filter.cpp"
+
+namespace
+{
+const double kOriginLat = 28.680000;
+const double kOriginLng = 115.890000;
+const double kPi = 3.14159265358979323846;
+const double kMetersPerLat = 110574.0;
+const double kMetersPerLng = 111320.0 * cos(kOriginLat * kPi / 180.0);
+const double kWalkSpeed = 1.2;
+
+struct Fix
+{
+  uint32_t ms;
+  double lat;
+  double lng;
+  float hdop;
+  float speedKmh;
+  float courseDeg;
+};
+
+struct Truth
+{
+  double x;
+  double y;
+};
+
+struct Walk
+{
+  std::vector<Fix> fixes;
+  std::vector<Truth> truth; // 每 100 ms 一个真值，下标 = ms / 100
+  std::vector<bool> outlier; // 与 fixes 对应：多径跳点
+  double dropoutStart;       // 秒，-1 为没有
+  double dropoutSeconds;
+};
+
+struct Scenario
+{
+  const char *name;
+  std::vector<std::pair<double, double>> corners; // 米
+  double dropoutStart;
+  double dropoutSeconds;
+  float hdop;
+  int outliers;       // 多径跳点个数（30~60 m）
+  bool stationary;    // 原地不动，接收机航向为空
+};
+
+double distance(double x0, double y0, double x1, double y1)
+{
+  return hypot(x1 - x0, y1 - y0);
+}
+
+void toMeters(double lat, double lng, double *x, double *y)
+{
+  *x = (lng - kOriginLng) * kMetersPerLng;
+  *y = (lat - kOriginLat) * kMetersPerLat;
+}
+
+// 按折线步行，真值每 100 ms 记一次；定位 1 Hz，带白噪声、缓慢漂移的偏差和 RMC 速度航向
+Walk walk(const Scenario &scenario, std::mt19937 &rng)
+{
+  Walk w;
+  w.dropoutStart = scenario.dropoutStart;
+  w.dropoutSeconds = scenario.dropoutSeconds;
+  std::normal_distribution<double> noise(0.0, 1.0);
+  std::uniform_real_distribution<double> uniform(0.0, 1.0);
+
+  const auto &corners = scenario.corners;
+  size_t leg = 0;
+  double x = corners[0].first;
+  double y = corners[0].second;
+  double biasX = 0;
+  double biasY = 0;
+  double heading = 0;
+  for (uint32_t ms = 0;; ms += 100)
+  {
+    if (!scenario.stationary)
+    {
+      double remaining = kWalkSpeed * 0.1;
+      while (remaining > 0 && leg + 1 < corners.size())
+      {
+        double dx = corners[leg + 1].first - x;
+        double dy = corners[leg + 1].second - y;
+        double d = hypot(dx, dy);
+        if (d <= remaining)
+        {
+          x = corners[leg + 1].first;
+          y = corners[leg + 1].second;
+          remaining -= d;
+          ++leg;
+          continue;
+        }
+        heading = atan2(dx, dy);
+        x += dx / d * remaining;
+        y += dy / d * remaining;
+        remaining = 0;
+      }
+    }
+    w.truth.push_back({x, y});
+    bool done = scenario.stationary ? ms >= 120000 : leg + 1 >= corners.size();
+
+    if (ms % 1000 == 0)
+    {
+      double t = ms / 1000.0;
+      biasX = 0.98 * biasX + 0.3 * noise(rng);
+      biasY = 0.98 * biasY + 0.3 * noise(rng);
+      bool dropped = scenario.dropoutStart >= 0 && t >= scenario.dropoutStart &&
+                     t < scenario.dropoutStart + scenario.dropoutSeconds;
+      if (!dropped)
+      {
+        double sigma = 3.0 * scenario.hdop;
+        double fx = x + biasX + sigma * noise(rng);
+        double fy = y + biasY + sigma * noise(rng);
+        Fix fix;
+        fix.ms = ms;
+        fix.hdop = scenario.hdop;
+        if (scenario.stationary)
+        {
+          fix.speedKmh = static_cast<float>(fabs(0.2 * noise(rng)));
+          fix.courseDeg = NAN;
+        }
+        else
+        {
+          fix.speedKmh = static_cast<float>((kWalkSpeed + 0.1 * noise(rng)) * 3.6);
+          double course = heading * 180.0 / kPi + 5.0 * noise(rng);
+          fix.courseDeg = static_cast<float>(course < 0 ? course + 360.0 : course);
+        }
+        fix.lat = kOriginLat + fy / kMetersPerLat;
+        fix.lng = kOriginLng + fx / kMetersPerLng;
+        w.fixes.push_back(fix);
+        w.outlier.push_back(false);
+      }
+    }
+    if (done)
+    {
+      break;
+    }
+  }
+
+  // 多径跳点：高楼反射，单点偏出 30~60 m，HDOP 看不出来
+  for (int k = 0; k < scenario.outliers; ++k)
+  {
+    size_t i = 20 + static_cast<size_t>(uniform(rng) * (w.fixes.size() - 40));
+    double angle = uniform(rng) * 2 * kPi;
+    double jump = 30.0 + 30.0 * uniform(rng);
+    w.fixes[i].lat += jump * cos(angle) / kMetersPerLat;
+    w.fixes[i].lng += jump * sin(angle) / kMetersPerLng;
+    w.outlier[i] = true;
+  }
+  return w;
+}
+
+int failures = 0;
+
+void expect(bool condition, const char *scenario, const char *what)
+{
+  if (!condition)
+  {
+    printf("  FAIL [%s] %s\n", scenario, what);
+    ++failures;
+  }
+}
+
+struct Errors
+{
+  double sumSq = 0;
+  double max = 0;
+  size_t n = 0;
+
+  void add(double e)
+  {
+    sumSq += e * e;
+    max = e > max ? e : max;
+    ++n;
+  }
+  double rms() const { return n ? sqrt(sumSq / n) : 0; }
+};
+
+void runScenario(const Scenario &scenario, uint32_t seed)
+{
+  std::mt19937 rng(seed);
+  Walk w = walk(scenario, rng);
+  PositionFilter filter;
+
+  Errors rawAtFix;
+  Errors filteredAtFix;
+  Errors rawHeld;        // 10 Hz 查询：沿用最近一个原始定位
+  Errors estimated;      // 10 Hz 查询：滤波外推
+  Errors heldDropout;    // 丢星期间
+  Errors estimatedDropout;
+  Errors rawStep;        // 每次查询位置跳动
+  Errors estimatedStep;
+  int outliersRejected = 0;
+  int goodRejected = 0;
+  bool validThroughShortDropout = true;
+  bool invalidAfterCoast = false;
+  double recoverError = -1;
+  size_t recoverAt = SIZE_MAX;
+  long long updateNs = 0;
+  long long estimateNs = 0;
+  size_t estimates = 0;
+
+  size_t next = 0;
+  const Fix *held = nullptr;
+  double lastRawX = NAN;
+  double lastRawY = NAN;
+  double lastEstX = NAN;
+  double lastEstY = NAN;
+  int64_t lastFixMs = -1;
+  for (size_t k = 0; k < w.truth.size(); ++k)
+  {
+    uint32_t ms = static_cast<uint32_t>(k * 100);
+    const Truth &truth = w.truth[k];
+    if (next < w.fixes.size() && w.fixes[next].ms == ms)
+    {
+      const Fix &fix = w.fixes[next];
+      auto start = std::chrono::steady_clock::now();
+      bool accepted = filter.update(fix.ms, fix.lat, fix.lng, fix.hdop, fix.speedKmh, fix.courseDeg);
+      updateNs += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+      if (!accepted)
+      {
+        (w.outlier[next] ? outliersRejected : goodRejected)++;
+      }
+      if (!w.outlier[next])
+      {
+        double fx;
+        double fy;
+        toMeters(fix.lat, fix.lng, &fx, &fy);
+        rawAtFix.add(distance(fx, fy, truth.x, truth.y));
+        PositionEstimate now = filter.estimate(ms);
+        double ex;
+        double ey;
+        toMeters(now.latitude, now.longitude, &ex, &ey);
+        filteredAtFix.add(distance(ex, ey, truth.x, truth.y));
+      }
+      if (lastFixMs >= 0 && ms - lastFixMs > 20000)
+      {
+        recoverAt = next + 4; // 长时间丢星后第 5 个定位
+      }
+      if (next == recoverAt)
+      {
+        PositionEstimate now = filter.estimate(ms);
+        double ex;
+        double ey;
+        toMeters(now.latitude, now.longitude, &ex, &ey);
+        recoverError = distance(ex, ey, truth.x, truth.y);
+      }
+      held = &fix;
+      lastFixMs = ms;
+      ++next;
+    }
+    if (held == nullptr)
+    {
+      continue;
+    }
+
+    double t = ms / 1000.0;
+    bool inDropout = w.dropoutStart >= 0 && t >= w.dropoutStart && t < w.dropoutStart + w.dropoutSeconds;
+    double hx;
+    double hy;
+    toMeters(held->lat, held->lng, &hx, &hy);
+    auto start = std::chrono::steady_clock::now();
+    PositionEstimate e = filter.estimate(ms);
+    estimateNs += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    ++estimates;
+    double ex;
+    double ey;
+    toMeters(e.latitude, e.longitude, &ex, &ey);
+
+    if (!inDropout)
+    {
+      rawHeld.add(distance(hx, hy, truth.x, truth.y));
+      estimated.add(distance(ex, ey, truth.x, truth.y));
+    }
+    else
+    {
+      heldDropout.add(distance(hx, hy, truth.x, truth.y));
+      double coast = t - w.dropoutStart;
+      if (coast < 8.0)
+      {
+        estimatedDropout.add(distance(ex, ey, truth.x, truth.y));
+        validThroughShortDropout = validThroughShortDropout && e.valid;
+      }
+      if (coast > 12.0 && !e.valid)
+      {
+        invalidAfterCoast = true;
+      }
+    }
+    if (!std::isnan(lastRawX))
+    {
+      rawStep.add(distance(hx, hy, lastRawX, lastRawY));
+      estimatedStep.add(distance(ex, ey, lastEstX, lastEstY));
+    }
+    lastRawX = hx;
+    lastRawY = hy;
+    lastEstX = ex;
+    lastEstY = ey;
+  }
+
+  printf("%s: %zu fixes over %.0f s, HDOP %.1f, %d multipath jumps", scenario.name, w.fixes.size(),
+         w.truth.size() / 10.0, scenario.hdop, scenario.outliers);
+  if (scenario.dropoutStart >= 0)
+  {
+    printf(", %.0f s dropout", scenario.dropoutSeconds);
+  }
+  printf("\n");
+  printf("  at fix time:   raw %.2f m RMS   filtered %.2f m RMS\n", rawAtFix.rms(), filteredAtFix.rms());
+  printf("  10 Hz queries: last fix %.2f m RMS (max %.1f)   estimate %.2f m RMS (max %.1f)\n", rawHeld.rms(),
+         rawHeld.max, estimated.rms(), estimated.max);
+  printf("  per-query jump: last fix max %.1f m   estimate max %.1f m\n", rawStep.max, estimatedStep.max);
+  if (scenario.outliers)
+  {
+    printf("  multipath: %d/%d rejected, %d good fixes rejected\n", outliersRejected, scenario.outliers, goodRejected);
+  }
+  if (heldDropout.n)
+  {
+    printf("  dropout: frozen fix %.1f m RMS (max %.1f)   coasting first 8 s %.1f m RMS (max %.1f)\n",
+           heldDropout.rms(), heldDropout.max, estimatedDropout.rms(), estimatedDropout.max);
+  }
+  printf("  update %.0f ns, estimate %.0f ns\n", static_cast<double>(updateNs) / w.fixes.size(),
+         static_cast<double>(estimateNs) / estimates);
+
+  expect(filteredAtFix.rms() < rawAtFix.rms(), scenario.name, "filter beats raw fixes at fix time");
+  expect(estimated.rms() < rawHeld.rms(), scenario.name, "estimate beats the held fix between fixes");
+  expect(estimatedStep.max < rawStep.max, scenario.name, "estimate moves smoother than the held fix");
+  expect(outliersRejected == scenario.outliers, scenario.name, "all multipath jumps rejected");
+  expect(goodRejected <= 1, scenario.name, "good fixes not rejected");
+  if (scenario.dropoutStart >= 0 && scenario.dropoutSeconds <= 10)
+  {
+    expect(validThroughShortDropout, scenario.name, "estimate stays valid through a short dropout");
+    expect(estimatedDropout.rms() < heldDropout.rms(), scenario.name, "coasting beats the frozen fix");
+  }
+  if (scenario.dropoutSeconds > 12)
+  {
+    expect(invalidAfterCoast, scenario.name, "estimate invalid once coasting exceeds the limit");
+    printf("  5 fixes after the dropout: %.1f m\n", recoverError);
+    expect(recoverError >= 0 && recoverError < 8.0, scenario.name, "reconverges after a long dropout");
+  }
+}
+
+// 构造一段 RMC + GGA，检查解析器到滤波器的整条路径和 UTC 时间换算
+void checkNmeaPath()
+{
+  const char *lines[] = {
+      "$GNRMC,120000.00,A,2840.8000,N,11553.4000,E,2.33,90.0,010125,,,A*",
+      "$GNGGA,120000.00,2840.8000,N,11553.4000,E,1,09,0.9,30.0,M,,M,,*",
+      "$GNRMC,120001.00,A,2840.8000,N,11553.4007,E,2.33,90.0,010125,,,A*",
+      "$GNGGA,120001.00,2840.8000,N,11553.4007,E,1,09,0.9,30.0,M,,M,,*",
+  };
+  NmeaParser parser;
+  PositionFilter filter;
+  int64_t firstMs = -1;
+  for (const char *body : lines)
+  {
+    uint8_t sum = 0;
+    for (const char *p = body + 1; *p != '*'; ++p)
+    {
+      sum ^= static_cast<uint8_t>(*p);
+    }
+    char line[128];
+    snprintf(line, sizeof(line), "%s%02X\r\n", body, sum);
+    size_t room = 0;
+    char *dest = parser.writeBuffer(&room);
+    size_t n = strlen(line);
+    memcpy(dest, line, n);
+    uint8_t decoded = parser.commit(n);
+    const NmeaFix &fix = parser.fix();
+    if ((decoded & NmeaParser::Rmc) != 0)
+    {
+      int64_t utcMs = nmeaUtcToEpochMs(fix.utcDate, fix.utcTime);
+      firstMs = firstMs < 0 ? utcMs : firstMs;
+      filter.update(static_cast<uint32_t>(utcMs - firstMs), fix.latitude, fix.longitude, fix.hdop, fix.speedKmh,
+                    fix.courseDeg);
+    }
+  }
+  PositionEstimate e = filter.estimate(1500);
+  expect(filter.accepted() == 2, "nmea", "both RMC fixes accepted");
+  expect(e.valid && e.eastMps > 0.3f && fabsf(e.northMps) < 0.3f, "nmea", "eastbound velocity from RMC course");
+  expect(e.longitude > 115.890001 && e.longitude < 115.890025, "nmea", "estimate interpolated east of the last fix");
+  printf("nmea path: %.6f,%.6f at +0.5 s, %.1f km/h course %.0f\n", e.latitude, e.longitude, e.speedKmh, e.courseDeg);
+}
+
+void replayFile(const char *path)
+{
+  std::ifstream in(path);
+  std::string line;
+  std::vector<Fix> fixes;
+  NmeaParser parser;
+  int64_t firstMs = -1;
+  while (std::getline(in, line))
+  {
+    if (!line.empty() && line[0] == '$')
+    {
+      line += "\r\n";
+      size_t room = 0;
+      char *dest = parser.writeBuffer(&room);
+      size_t n = line.size() < room ? line.size() : room;
+      memcpy(dest, line.data(), n);
+      uint8_t decoded = parser.commit(n);
+      const NmeaFix &fix = parser.fix();
+      if ((decoded & NmeaParser::Rmc) != 0 && fix.positionValid)
+      {
+        int64_t utcMs = nmeaUtcToEpochMs(fix.utcDate, fix.utcTime);
+        if (utcMs > 0)
+        {
+          firstMs = firstMs < 0 ? utcMs : firstMs;
+          fixes.push_back({static_cast<uint32_t>(utcMs - firstMs), fix.latitude, fix.longitude, fix.hdop, fix.speedKmh,
+                           fix.courseDeg});
+        }
+      }
+      continue;
+    }
+    double t;
+    double lat;
+    double lng;
+    float hdop = NAN;
+    float speed = NAN;
+    float course = NAN;
+    if (sscanf(line.c_str(), "%lf,%lf,%lf,%f,%f,%f", &t, &lat, &lng, &hdop, &speed, &course) >= 3)
+    {
+      fixes.push_back({static_cast<uint32_t>(t), lat, lng, hdop, speed, course});
+    }
+  }
+  if (fixes.empty())
+  {
+    printf("%s: no fixes\n", path);
+    ++failures;
+    return;
+  }
+
+  PositionFilter filter;
+  Errors rawStep;
+  Errors estimatedStep;
+  int dropouts = 0;
+  uint32_t longestGap = 0;
+  double lastX = NAN;
+  double lastY = NAN;
+  size_t next = 0;
+  const Fix *held = nullptr;
+  for (uint32_t ms = fixes.front().ms; ms <= fixes.back().ms; ms += 1000)
+  {
+    while (next < fixes.size() && fixes[next].ms <= ms)
+    {
+      if (held != nullptr && fixes[next].ms - held->ms > 1500)
+      {
+        ++dropouts;
+        longestGap = std::max(longestGap, fixes[next].ms - held->ms);
+      }
+      filter.update(fixes[next].ms, fixes[next].lat, fixes[next].lng, fixes[next].hdop, fixes[next].speedKmh,
+                    fixes[next].courseDeg);
+      if (held != nullptr)
+      {
+        double x0;
+        double y0;
+        double x1;
+        double y1;
+        toMeters(held->lat, held->lng, &x0, &y0);
+        toMeters(fixes[next].lat, fixes[next].lng, &x1, &y1);
+        rawStep.add(distance(x0, y0, x1, y1));
+      }
+      held = &fixes[next++];
+    }
+    PositionEstimate e = filter.estimate(ms);
+    double x;
+    double y;
+    toMeters(e.latitude, e.longitude, &x, &y);
+    if (!std::isnan(lastX))
+    {
+      estimatedStep.add(distance(x, y, lastX, lastY));
+    }
+    lastX = x;
+    lastY = y;
+  }
+  printf("%s: %zu fixes, %u accepted, %u rejected, %u resets, %d dropouts (longest %.1f s)\n", path, fixes.size(),
+         filter.accepted(), filter.rejected(), filter.resets(), dropouts, longestGap / 1000.0);
+  printf("  per-fix jump: raw %.2f m RMS (max %.1f)   estimate per second %.2f m RMS (max %.1f)\n", rawStep.rms(),
+         rawStep.max, estimatedStep.rms(), estimatedStep.max);
+}
+} // namespace
+
+int main(int argc, char **argv)
+{
+  printf("sizeof(PositionFilter) = %zu bytes\n", sizeof(PositionFilter));
+  if (argc == 2)
+  {
+    replayFile(argv[1]);
+    return failures ? 1 : 0;
+  }
+
+  std::vector<Scenario> scenarios = {
+      {"open sky, L-shaped walk", {{0, 0}, {0, 150}, {120, 150}}, -1, 0, 1.0f, 0, false},
+      {"urban canyon, 8 s dropout + multipath", {{0, 0}, {0, 200}, {-80, 200}, {-80, 320}}, 90, 8, 2.0f, 4, false},
+      {"underpass, 30 s dropout with a turn", {{0, 0}, {0, 100}, {60, 100}, {60, 220}}, 70, 30, 1.2f, 0, false},
+      {"standing at a crossing", {{0, 0}}, -1, 0, 1.5f, 2, true},
+  };
+  uint32_t seed = 7;
+  for (const Scenario &scenario : scenarios)
+  {
+    runScenario(scenario, seed++);
+  }
+  checkNmeaPath();
+
+  if (failures)
+  {
+    printf("%d check(s) failed\n", failures);
+    return 1;
+  }
+  printf("all checks passed\n");
+  return 0;
+}
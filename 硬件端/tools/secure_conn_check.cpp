@@ -0,0 +1,538 @@
+// Host check for the secure-connection pool (src/utils/secure_conn_pool.cpp)
+// against a local TLS stand-in server.
+//
+// The stand-in is an OpenSSL server on 127.0.0.1 limited to TLS 1.2 (what the
+// ESP32's mbedTLS 2.28 negotiates with tsn.baidu.com), with a self-signed P-256
+// certificate, a server-side session cache and session tickets. It answers
+// "ping" with "pong", closes on "close", and counts full vs resumed handshakes
+// on its side so the pool's statistics can be checked against the server's view.
+// The client transport is the OpenSSL equivalent of src/services/secure_client.cpp:
+// sessions are exported/imported as serialized bytes.
+//
+// Scenarios: cold connect (full handshake, session cached), second connection
+// resumes, warm connection reused across TTS-like segments with no handshake,
+// server-side idle close followed by a resumed reconnect, keepWarm off closes
+// the connection, busy warm slot falls back to a resumed temporary connection,
+// other hosts never take the warm slot, a server restart (new ticket keys, empty
+// cache) falls back to a full handshake, and LRU eviction of the per-host cache.
+//
+/*
+ *   g++ -std=c++17 -O2 -Wall tools/secure_conn_check.cpp -o secure_conn_check -lssl -lcrypto -lpthread
+ *   ./secure_conn_check
+ */
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <openssl/err.h>
+#include <openssl/evp.h>
+#include <openssl/ssl.h>
+#include <openssl/x509.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../src/utils/secure_conn_pool.cpp"
+
+namespace
+{
+int failures = 0;
+
+void expect(bool condition, const char *what)
+{
+  if (!condition)
+  {
+    ++failures;
+    printf("  FAIL: %s\n", what);
+  }
+}
+
+uint64_t nowUs()
+{
+  static const auto start = std::chrono::steady_clock::now();
+  return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+}
+
+std::mutex poolMutex;
+void lockPool(void *) { poolMutex.lock(); }
+void unlockPool(void *) { poolMutex.unlock(); }
+
+// ---- stand-in server ----
+
+class StandInServer
+{
+public:
+  bool start()
+  {
+    listenFd_ = socket(AF_INET, SOCK_STREAM, 0);
+    int one = 1;
+    setsockopt(listenFd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    if (bind(listenFd_, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0 || listen(listenFd_, 8) != 0)
+    {
+      return false;
+    }
+    socklen_t len = sizeof(addr);
+    getsockname(listenFd_, reinterpret_cast<sockaddr *>(&addr), &len);
+    port_ = ntohs(addr.sin_port);
+    if (!makeContext())
+    {
+      return false;
+    }
+    acceptThread_ = std::thread([this] { acceptLoop(); });
+    return true;
+  }
+
+  void stop()
+  {
+    stopping_ = true;
+    acceptThread_.join();
+    for (std::thread &t : connections_)
+    {
+      t.join();
+    }
+    SSL_CTX_free(ctx_);
+    close(listenFd_);
+  }
+
+  // 新的 SSL_CTX：新的 ticket 密钥、空的会话缓存，旧会话都无法恢复
+  bool restart()
+  {
+    SSL_CTX *old = ctx_;
+    if (!makeContext())
+    {
+      return false;
+    }
+    SSL_CTX_free(old);
+    return true;
+  }
+
+  // 模拟服务端 keep-alive 超时：关闭所有空闲连接
+  void closeIdleConnections()
+  {
+    ++closeGeneration_;
+    while (open_.load() != 0)
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }
+
+  uint16_t port() const { return port_; }
+  int fullHandshakes() const { return full_.load(); }
+  int resumedHandshakes() const { return resumed_.load(); }
+  int openConnections() const { return open_.load(); }
+
+private:
+  bool makeContext()
+  {
+    std::lock_guard<std::mutex> guard(ctxMutex_);
+    SSL_CTX *ctx = SSL_CTX_new(TLS_server_method());
+    SSL_CTX_set_min_proto_version(ctx, TLS1_2_VERSION);
+    SSL_CTX_set_max_proto_version(ctx, TLS1_2_VERSION);
+    SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_SERVER);
+    static const unsigned char kContext[] = "secure_conn_check";
+    SSL_CTX_set_session_id_context(ctx, kContext, sizeof(kContext) - 1);
+
+    EVP_PKEY *key = EVP_EC_gen("P-256");
+    X509 *cert = X509_new();
+    ASN1_INTEGER_set(X509_get_serialNumber(cert), 1);
+    X509_gmtime_adj(X509_getm_notBefore(cert), 0);
+    X509_gmtime_adj(X509_getm_notAfter(cert), 3600);
+    X509_set_pubkey(cert, key);
+    X509_NAME *name = X509_get_subject_name(cert);
+    X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC, reinterpret_cast<const unsigned char *>("tsn.baidu.com"), -1,
+                               -1, 0);
+    X509_set_issuer_name(cert, name);
+    X509_sign(cert, key, EVP_sha256());
+    bool ok = SSL_CTX_use_certificate(ctx, cert) == 1 && SSL_CTX_use_PrivateKey(ctx, key) == 1;
+    X509_free(cert);
+    EVP_PKEY_free(key);
+    if (!ok)
+    {
+      SSL_CTX_free(ctx);
+      return false;
+    }
+    ctx_ = ctx;
+    return true;
+  }
+
+  void acceptLoop()
+  {
+    while (!stopping_)
+    {
+      pollfd pfd = {listenFd_, POLLIN, 0};
+      if (poll(&pfd, 1, 20) <= 0)
+      {
+        continue;
+      }
+      int fd = accept(listenFd_, nullptr, nullptr);
+      if (fd < 0)
+      {
+        continue;
+      }
+      SSL *ssl;
+      {
+        std::lock_guard<std::mutex> guard(ctxMutex_);
+        ssl = SSL_new(ctx_);
+      }
+      ++open_;
+      connections_.emplace_back([this, fd, ssl] { serve(fd, ssl); });
+    }
+  }
+
+  void serve(int fd, SSL *ssl)
+  {
+    SSL_set_fd(ssl, fd);
+    if (SSL_accept(ssl) == 1)
+    {
+      ++(SSL_session_reused(ssl) ? resumed_ : full_);
+      int generation = closeGeneration_.load();
+      std::string line;
+      bool running = true;
+      while (running && !stopping_ && generation == closeGeneration_.load())
+      {
+        pollfd pfd = {fd, POLLIN, 0};
+        if (SSL_pending(ssl) == 0 && poll(&pfd, 1, 10) <= 0)
+        {
+          continue;
+        }
+        char buffer[64];
+        int n = SSL_read(ssl, buffer, sizeof(buffer));
+        if (n <= 0)
+        {
+          break;
+        }
+        line.append(buffer, static_cast<size_t>(n));
+        size_t newline;
+        while ((newline = line.find('\n')) != std::string::npos)
+        {
+          std::string command = line.substr(0, newline);
+          line.erase(0, newline + 1);
+          if (command == "ping")
+          {
+            SSL_write(ssl, "pong\n", 5);
+          }
+          else
+          {
+            running = false;
+          }
+        }
+      }
+      SSL_shutdown(ssl);
+    }
+    SSL_free(ssl);
+    close(fd);
+    --open_;
+  }
+
+  int listenFd_ = -1;
+  uint16_t port_ = 0;
+  std::mutex ctxMutex_;
+  SSL_CTX *ctx_ = nullptr;
+  std::thread acceptThread_;
+  std::vector<std::thread> connections_;
+  std::atomic<bool> stopping_{false};
+  std::atomic<int> closeGeneration_{0};
+  std::atomic<int> full_{0};
+  std::atomic<int> resumed_{0};
+  std::atomic<int> open_{0};
+};
+
+// ---- client transport (OpenSSL stand-in for the mbedTLS SecureClient) ----
+
+class OpenSslTransport : public TlsTransport
+{
+public:
+  explicit OpenSslTransport(uint16_t serverPort) : serverPort_(serverPort)
+  {
+    ctx_ = SSL_CTX_new(TLS_client_method());
+    SSL_CTX_set_max_proto_version(ctx_, TLS1_2_VERSION);
+    SSL_CTX_set_verify(ctx_, SSL_VERIFY_NONE, nullptr); // 与设备端 setInsecure 一致
+  }
+  ~OpenSslTransport() override
+  {
+    close();
+    SSL_CTX_free(ctx_);
+  }
+
+  bool open(const char *host, uint16_t port, const uint8_t *session, size_t sessionLength, uint32_t timeoutMs) override
+  {
+    (void)port;
+    (void)timeoutMs;
+    close();
+    fd_ = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(serverPort_);
+    if (::connect(fd_, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0)
+    {
+      close();
+      return false;
+    }
+    ssl_ = SSL_new(ctx_);
+    SSL_set_fd(ssl_, fd_);
+    SSL_set_tlsext_host_name(ssl_, host);
+    if (session != nullptr)
+    {
+      const unsigned char *p = session;
+      SSL_SESSION *cached = d2i_SSL_SESSION(nullptr, &p, static_cast<long>(sessionLength));
+      if (cached != nullptr)
+      {
+        SSL_set_session(ssl_, cached);
+        SSL_SESSION_free(cached);
+      }
+    }
+    if (SSL_connect(ssl_) != 1)
+    {
+      close();
+      return false;
+    }
+    resumed_ = SSL_session_reused(ssl_) == 1;
+    return true;
+  }
+
+  bool resumed() const override { return resumed_; }
+
+  size_t saveSession(uint8_t *out, size_t capacity) override
+  {
+    SSL_SESSION *session = ssl_ != nullptr ? SSL_get_session(ssl_) : nullptr;
+    if (session == nullptr)
+    {
+      return 0;
+    }
+    int length = i2d_SSL_SESSION(session, nullptr);
+    if (length <= 0)
+    {
+      return 0;
+    }
+    if (out == nullptr)
+    {
+      return static_cast<size_t>(length);
+    }
+    if (capacity < static_cast<size_t>(length))
+    {
+      return 0;
+    }
+    unsigned char *p = out;
+    return static_cast<size_t>(i2d_SSL_SESSION(session, &p));
+  }
+
+  // 与设备端相同：不阻塞地看一眼，对端发来 close_notify 或 FIN 即视为已关闭
+  bool isOpen() override
+  {
+    if (ssl_ == nullptr)
+    {
+      return false;
+    }
+    pollfd pfd = {fd_, POLLIN, 0};
+    if (poll(&pfd, 1, 0) <= 0)
+    {
+      return true;
+    }
+    char c;
+    int n = SSL_peek(ssl_, &c, 1);
+    return n > 0;
+  }
+
+  void close() override
+  {
+    if (ssl_ != nullptr)
+    {
+      SSL_shutdown(ssl_);
+      SSL_free(ssl_);
+      ssl_ = nullptr;
+    }
+    if (fd_ >= 0)
+    {
+      ::close(fd_);
+      fd_ = -1;
+    }
+    resumed_ = false;
+  }
+
+  // 一次请求/响应，相当于一段 TTS
+  bool request()
+  {
+    if (ssl_ == nullptr || SSL_write(ssl_, "ping\n", 5) != 5)
+    {
+      return false;
+    }
+    char buffer[8] = {};
+    int got = 0;
+    while (got < 5)
+    {
+      int n = SSL_read(ssl_, buffer + got, 5 - got);
+      if (n <= 0)
+      {
+        return false;
+      }
+      got += n;
+    }
+    return memcmp(buffer, "pong\n", 5) == 0;
+  }
+
+private:
+  uint16_t serverPort_;
+  SSL_CTX *ctx_ = nullptr;
+  SSL *ssl_ = nullptr;
+  int fd_ = -1;
+  bool resumed_ = false;
+};
+
+const char *kWarmHost = "tsn.baidu.com";
+const uint16_t kPort = 443;
+const uint32_t kTimeoutMs = 5000;
+
+// 与 SecureConnLease 相同的顺序：先占保温连接，占不到用临时连接
+bool runSegment(SecureConnPool &pool, OpenSslTransport &temporary, const char *host, bool *usedWarm,
+                OpenSslTransport &warm)
+{
+  if (pool.claimWarm(host, kPort))
+  {
+    *usedWarm = true;
+    bool ok = pool.openWarm(kTimeoutMs) && warm.request();
+    pool.releaseWarm(ok);
+    return ok;
+  }
+  *usedWarm = false;
+  bool ok = pool.connect(temporary, host, kPort, kTimeoutMs) && temporary.request();
+  temporary.close();
+  return ok;
+}
+
+void waitForServerConnections(const StandInServer &server, int expected)
+{
+  for (int i = 0; i < 500 && server.openConnections() != expected; ++i)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+}
+} // namespace
+
+int main()
+{
+  StandInServer server;
+  if (!server.start())
+  {
+    printf("stand-in server failed to start\n");
+    return 1;
+  }
+  printf("stand-in TLS 1.2 server on 127.0.0.1:%u\n", static_cast<unsigned>(server.port()));
+
+  SecureConnPool pool(nowUs, lockPool, unlockPool, nullptr);
+  OpenSslTransport warm(server.port());
+  OpenSslTransport temporary(server.port());
+  pool.setWarm(&warm, kWarmHost, kPort);
+  bool usedWarm = false;
+
+  printf("1. cold connect outside a turn\n");
+  expect(runSegment(pool, temporary, kWarmHost, &usedWarm, warm), "cold request succeeds");
+  SecureConnStats s = pool.stats();
+  expect(usedWarm && s.handshakes == 1 && s.resumed == 0, "one full handshake on the warm slot");
+  expect(server.fullHandshakes() == 1 && server.resumedHandshakes() == 0, "server saw one full handshake");
+  expect(pool.sessionCount() == 1, "session cached for the host");
+  waitForServerConnections(server, 0);
+  expect(!pool.warmOpen() && server.openConnections() == 0, "closed after use when not in a turn");
+
+  printf("2. next connection resumes the cached session\n");
+  expect(runSegment(pool, temporary, kWarmHost, &usedWarm, warm), "second request succeeds");
+  s = pool.stats();
+  expect(s.handshakes == 2 && s.resumed == 1, "pool counted a resumed handshake");
+  expect(server.resumedHandshakes() == 1, "server confirms resumption");
+
+  printf("3. voice turn: warm connection reused across segments\n");
+  pool.setKeepWarm(true);
+  int handshakesBefore = server.fullHandshakes() + server.resumedHandshakes();
+  for (int i = 0; i < 6; ++i)
+  {
+    expect(runSegment(pool, temporary, kWarmHost, &usedWarm, warm) && usedWarm, "segment over warm connection");
+  }
+  s = pool.stats();
+  expect(server.fullHandshakes() + server.resumedHandshakes() == handshakesBefore + 1,
+         "one handshake for six segments");
+  expect(s.reused == 5, "five segments reused the open connection");
+  expect(pool.warmOpen() && server.openConnections() == 1, "connection stays open between segments");
+
+  printf("4. server closes the idle connection, next segment reconnects with resumption\n");
+  server.closeIdleConnections();
+  int resumedBefore = server.resumedHandshakes();
+  expect(runSegment(pool, temporary, kWarmHost, &usedWarm, warm) && usedWarm, "segment after idle close");
+  expect(server.resumedHandshakes() == resumedBefore + 1, "reconnect was a resumed handshake");
+  // 响应没读完或服务端要求关闭时，即使在交互中也不保留
+  expect(pool.claimWarm(kWarmHost, kPort) && pool.openWarm(kTimeoutMs), "claim for a non-reusable response");
+  pool.releaseWarm(false);
+  waitForServerConnections(server, 0);
+  expect(!pool.warmOpen() && server.openConnections() == 0, "non-reusable response closes the connection");
+
+  printf("5. warm slot busy: other task uses a temporary, resumed connection\n");
+  expect(pool.claimWarm(kWarmHost, kPort), "first task claims the warm slot");
+  resumedBefore = server.resumedHandshakes();
+  bool ok = pool.connect(temporary, kWarmHost, kPort, kTimeoutMs) && temporary.request();
+  temporary.close();
+  expect(!pool.claimWarm(kWarmHost, kPort), "second claim refused while busy");
+  expect(ok && server.resumedHandshakes() == resumedBefore + 1, "temporary connection resumed");
+  expect(pool.stats().warmBusy == 1, "busy fallback counted");
+  pool.releaseWarm(true);
+
+  printf("6. other hosts never take the warm slot\n");
+  expect(runSegment(pool, temporary, "aip.baidubce.com", &usedWarm, warm) && !usedWarm,
+         "token host uses a temporary connection");
+  expect(pool.sessionCount() == 2, "token host session cached separately");
+
+  printf("7. end of turn closes the warm connection\n");
+  pool.setKeepWarm(false);
+  waitForServerConnections(server, 0);
+  expect(!pool.warmOpen() && server.openConnections() == 0, "warm connection closed");
+
+  printf("8. server restart (new ticket keys, empty cache): full handshake fallback\n");
+  server.restart();
+  int fullBefore = server.fullHandshakes();
+  expect(runSegment(pool, temporary, kWarmHost, &usedWarm, warm), "request after restart succeeds");
+  expect(server.fullHandshakes() == fullBefore + 1, "server did a full handshake");
+  resumedBefore = server.resumedHandshakes();
+  expect(runSegment(pool, temporary, kWarmHost, &usedWarm, warm), "following request succeeds");
+  expect(server.resumedHandshakes() == resumedBefore + 1, "new session cached and resumed");
+
+  printf("9. per-host cache evicts the least recently used host\n");
+  const char *hosts[] = {"a.example", "b.example", "c.example", "d.example"};
+  for (const char *host : hosts)
+  {
+    expect(runSegment(pool, temporary, host, &usedWarm, warm), "extra host request");
+  }
+  expect(pool.sessionCount() == SecureConnPool::kMaxHosts, "cache bounded");
+  s = pool.stats();
+  uint32_t resumedBeforeEvict = s.resumed;
+  expect(runSegment(pool, temporary, "aip.baidubce.com", &usedWarm, warm), "evicted host request");
+  expect(pool.stats().resumed == resumedBeforeEvict, "evicted host needed a full handshake");
+
+  s = pool.stats();
+  uint32_t full = s.handshakes - s.resumed;
+  printf("\nhandshakes %u (full %u, resumed %u), reused %u, busy %u, failed %u, sessions stored %u\n",
+         s.handshakes, full, s.resumed, s.reused, s.warmBusy, s.failed, s.sessionsStored);
+  printf("average full %.2f ms, resumed %.2f ms, max %.2f ms\n",
+         full ? s.fullHandshakeUs / 1000.0 / full : 0.0, s.resumed ? s.resumedHandshakeUs / 1000.0 / s.resumed : 0.0,
+         s.maxHandshakeUs / 1000.0);
+  printf("server: full %d, resumed %d\n", server.fullHandshakes(), server.resumedHandshakes());
+  expect(static_cast<int>(full) == server.fullHandshakes() && static_cast<int>(s.resumed) == server.resumedHandshakes(),
+         "pool statistics match the server");
+
+  warm.close();
+  server.stop();
+  printf("%s (%d failures)\n", failures == 0 ? "OK" : "FAILED", failures);
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,255 @@
+// Host fuzz/benchmark target for the allocation-free parseServerResponse().
+//
+// Compiles src/utils/json_helper.cpp as-is (without ARDUINO defined) against
+// ArduinoJson 7.x and counts every malloc/realloc/calloc that happens while a
+// parse is running. The run fails if any parse touches the heap, overflows the
+// fixed arena, or leaves a FixedString whose length/terminator disagree.
+//
+//   g++ -std=c++17 -O2 -I<path-to>/ArduinoJson/src tools/server_response_bench.cpp -o server_response_bench
+//   ./server_response_bench [fuzz-iterations]
+//
+// libFuzzer build (clang), same invariants checked per input:
+//   clang++ -std=c++17 -g -O1 -fsanitize=fuzzer,address -DSERVER_RESPONSE_LIBFUZZER \
+//           -I<path-to>/ArduinoJson/src tools/server_response_bench.cpp -o server_response_fuzz
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+extern "C" void *__libc_malloc(size_t size);
+extern "C" void *__libc_realloc(void *pointer, size_t size);
+extern "C" void *__libc_calloc(size_t count, size_t size);
+extern "C" void __libc_free(void *pointer);
+
+namespace
+{
+bool countingHeap = false;
+size_t heapCalls = 0;
+} // namespace
+
+#ifndef SERVER_RESPONSE_LIBFUZZER
+// ASan 自带分配器，libFuzzer 构建不替换 malloc
+extern "C" void *malloc(size_t size)
+{
+  heapCalls += countingHeap;
+  return __libc_malloc(size);
+}
+
+extern "C" void *realloc(void *pointer, size_t size)
+{
+  heapCalls += countingHeap;
+  return __libc_realloc(pointer, size);
+}
+
+extern "C" void *calloc(size_t count, size_t size)
+{
+  heapCalls += countingHeap;
+  return __libc_calloc(count, size);
+}
+
+extern "C" void free(void *pointer)
+{
+  __libc_free(pointer);
+}
+#endif
+
+#include "../src/utils/json_helper.cpp"
+
+namespace
+{
+const char kNavigationJson[] =
+    "{\"ok\":true,\"request_id\":\"00000000-0000-0000-0000-000000000000\",\"device_id\":\"guide-cane-001\","
+    "\"intent\":\"navigation.update\",\"response\":\"沿学府大道向东步行120米，前方路口右转\","
+    "\"speak\":{\"mode\":\"tts_text\",\"text\":\"沿学府大道向东步行120米，前方路口右转\",\"audio_id\":\"\",\"audio_url\":\"\"},"
+    "\"navigation\":{\"active\":true,\"destination\":\"南昌大学图书馆\",\"remaining_distance\":860,"
+    "\"total_duration\":690,\"next_instruction\":\"沿学府大道向东步行120米，前方路口右转\"},\"error\":null,"
+    "\"next_instruction\":\"沿学府大道向东步行120米，前方路口右转\",\"remaining_distance\":860,"
+    "\"total_duration\":690,\"navigation_complete\":false}";
+
+const char kWeatherJson[] =
+    "{\"ok\":true,\"request_id\":\"00000000-0000-0000-0000-000000000000\",\"device_id\":\"guide-cane-001\","
+    "\"intent\":\"weather.query\",\"response\":\"南昌市今天多云，17到26度，东北风1-3级。\","
+    "\"speak\":{\"mode\":\"tts_text\",\"text\":\"南昌市今天多云，17到26度，东北风1-3级。\",\"audio_id\":\"\",\"audio_url\":\"\"},"
+    "\"navigation\":{\"active\":false,\"destination\":\"\",\"remaining_distance\":null,\"total_duration\":null,"
+    "\"next_instruction\":\"\"},\"error\":null,\"city\":\"南昌市\",\"date\":\"today\",\"daily\":["
+    "{\"fxDate\":\"2026-10-19\",\"tempMax\":\"26\",\"tempMin\":\"17\",\"textDay\":\"多云\",\"textNight\":\"晴\","
+    "\"windDirDay\":\"东北风\",\"windScaleDay\":\"1-3\",\"humidity\":\"68\",\"precip\":\"0.0\",\"uvIndex\":\"4\"},"
+    "{\"fxDate\":\"2026-10-20\",\"tempMax\":\"25\",\"tempMin\":\"16\",\"textDay\":\"多云\",\"textNight\":\"晴\","
+    "\"windDirDay\":\"东北风\",\"windScaleDay\":\"1-3\",\"humidity\":\"68\",\"precip\":\"0.0\",\"uvIndex\":\"4\"},"
+    "{\"fxDate\":\"2026-10-21\",\"tempMax\":\"24\",\"tempMin\":\"15\",\"textDay\":\"多云\",\"textNight\":\"晴\","
+    "\"windDirDay\":\"东北风\",\"windScaleDay\":\"1-3\",\"humidity\":\"68\",\"precip\":\"0.0\",\"uvIndex\":\"4\"}]}";
+
+template <size_t Capacity>
+bool fixedStringSane(const FixedString<Capacity> &value)
+{
+  return value.length() < Capacity && strlen(value.c_str()) == value.length();
+}
+
+bool responseSane(const ServerResponse &parsed)
+{
+  return fixedStringSane(parsed.intent) && fixedStringSane(parsed.response) && fixedStringSane(parsed.error) &&
+         fixedStringSane(parsed.speakMode) && fixedStringSane(parsed.speakText) && fixedStringSane(parsed.audioId) &&
+         fixedStringSane(parsed.audioUrl) && fixedStringSane(parsed.destination) &&
+         fixedStringSane(parsed.nextInstruction);
+}
+
+// 返回本次解析期间的堆调用次数
+size_t parseCounted(const std::string &payload, ServerResponse *parsed)
+{
+  heapCalls = 0;
+  countingHeap = true;
+  parseServerResponse(payload.data(), payload.size(), parsed);
+  countingHeap = false;
+  return heapCalls;
+}
+
+std::string toMsgPack(const char *json)
+{
+  JsonDocument doc;
+  deserializeJson(doc, json);
+  std::string packed;
+  serializeMsgPack(doc, packed);
+  return packed;
+}
+
+std::string chatReplyText(size_t minBytes)
+{
+  std::string text;
+  while (text.size() < minBytes)
+  {
+    text += "好的，这是一段很长的闲聊回复，用来检查长回复是否完整保留。";
+  }
+  return text;
+}
+
+std::string chatReply(const std::string &text)
+{
+  return "{\"ok\":true,\"intent\":\"chat.normal\",\"response\":\"" + text + "\",\"speak\":{\"mode\":\"tts_text\",\"text\":\"" +
+         text + "\"}}";
+}
+
+std::string mutate(const std::string &seed, std::mt19937 &rng)
+{
+  std::string out = seed;
+  int edits = 1 + static_cast<int>(rng() % 8);
+  for (int i = 0; i < edits && !out.empty(); ++i)
+  {
+    size_t at = rng() % out.size();
+    switch (rng() % 4)
+    {
+    case 0:
+      out[at] = static_cast<char>(rng());
+      break;
+    case 1:
+      out.erase(at, 1 + rng() % 16);
+      break;
+    case 2:
+      out.insert(at, 1 + rng() % 16, static_cast<char>(rng()));
+      break;
+    default:
+      out.resize(at);
+      break;
+    }
+  }
+  return out;
+}
+} // namespace
+
+#ifdef SERVER_RESPONSE_LIBFUZZER
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+  ServerResponse parsed;
+  parseServerResponse(reinterpret_cast<const char *>(data), size, &parsed);
+  // 超大输入耗尽内存池时应当以解析失败收场，而不是越界
+  if (!responseSane(parsed))
+  {
+    abort();
+  }
+  return 0;
+}
+#else
+int main(int argc, char **argv)
+{
+  long fuzzIterations = argc > 1 ? strtol(argv[1], nullptr, 10) : 200000;
+
+  // expectSpeak 非空时要求播报文本原样保留、不截断；超过容量的回复只检查截断落在汉字边界
+  struct Fixture
+  {
+    const char *name;
+    std::string payload;
+    std::string expectSpeak;
+  };
+  const std::string longReply = chatReplyText(1500);
+  std::vector<Fixture> fixtures = {
+      {"navigation.json", kNavigationJson, ""},
+      {"navigation.msgpack", toMsgPack(kNavigationJson), ""},
+      {"weather.json", kWeatherJson, ""},
+      {"weather.msgpack", toMsgPack(kWeatherJson), ""},
+      {"chat-long.json", chatReply(longReply), longReply},
+      {"chat-long.msgpack", toMsgPack(chatReply(longReply).c_str()), longReply},
+      {"chat-oversize.json", chatReply(chatReplyText(SERVER_RESPONSE_TEXT_BYTES + 64)), ""},
+      {"plain-text", "服务暂不可用", ""},
+  };
+
+  int failures = 0;
+  constexpr int kIterations = 20000;
+  for (const Fixture &fixture : fixtures)
+  {
+    ServerResponse parsed;
+    size_t heap = parseCounted(fixture.payload, &parsed);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int n = 0; n < kIterations; ++n)
+    {
+      heap += parseCounted(fixture.payload, &parsed);
+    }
+    double averageUs =
+        std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / kIterations;
+
+    bool ok = heap == 0 && responseSane(parsed);
+    if (!fixture.expectSpeak.empty())
+    {
+      ok = ok && !parsed.truncated && fixture.expectSpeak == getSpeakText(parsed) &&
+           fixture.expectSpeak == parsed.response.c_str();
+    }
+    failures += ok ? 0 : 1;
+    printf("%-20s bytes=%-5zu parse=%6.2fus heap_calls=%zu valid=%d truncated=%d speak=%.24s%s\n",
+           fixture.name,
+           fixture.payload.size(),
+           averageUs,
+           heap,
+           parsed.jsonValid,
+           parsed.truncated,
+           getSpeakText(parsed),
+           ok ? "" : "  <-- FAIL");
+  }
+
+  std::mt19937 rng(20261019);
+  size_t fuzzHeap = 0;
+  long insane = 0;
+  for (long i = 0; i < fuzzIterations; ++i)
+  {
+    const std::string &seed = fixtures[i % fixtures.size()].payload;
+    ServerResponse parsed;
+    fuzzHeap += parseCounted(mutate(seed, rng), &parsed);
+    insane += responseSane(parsed) ? 0 : 1;
+  }
+
+  printf("fuzz iterations=%ld heap_calls=%zu insane=%ld arena_high_water=%zuB/%dB arena_overflows=%zu\n",
+         fuzzIterations,
+         fuzzHeap,
+         insane,
+         serverResponseArenaHighWater(),
+         SERVER_RESPONSE_ARENA_BYTES,
+         serverResponseArenaOverflows());
+
+  if (fuzzHeap != 0 || insane != 0 || serverResponseArenaOverflows() != 0)
+  {
+    ++failures;
+  }
+  return failures == 0 ? 0 : 1;
+}
+#endif
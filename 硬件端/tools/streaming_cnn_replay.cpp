@@ -0,0 +1,180 @@
+// Host replay test for tflite_learn_3_invoke_streaming().
+//
+// Slides a 50-frame window over a long synthetic int8 MFCC stream and, at every
+// step, runs the regular batch graph and the streaming path on the same input.
+// The pooled activations feeding the FC layer and the final softmax output must
+// match byte for byte; the run fails otherwise. It also reports how many conv
+// columns the streaming path recomputed and the host time of both paths.
+//
+/*
+ * Builds against the TFLite Micro reference kernels shipped in the SDK:
+ *
+ *   S=lib/_3_inferencing/src; K=$S/edge-impulse-sdk/tensorflow/lite
+ *   g++ -std=c++17 -O2 -I$S -DTF_LITE_STATIC_MEMORY -DEI_CLASSIFIER_TFLITE_ENABLE_ESP_NN=0 \
+ *     tools/streaming_cnn_replay.cpp \
+ *     $K/micro/kernels/{conv,conv_common,pooling,pooling_common,fully_connected,fully_connected_common}.cpp \
+ *     $K/micro/kernels/{softmax,softmax_common,reshape,kernel_util_micro}.cpp \
+ *     $K/kernels/internal/{quantization_util,portable_tensor_utils}.cpp $K/kernels/kernel_util_lite.cpp \
+ *     $K/core/api/common.cpp $K/micro/{micro_utils,micro_context,memory_helpers}.cpp -o streaming_cnn_replay
+ *   ./streaming_cnn_replay [steps]
+ */
+
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "../lib/_3_inferencing/src/tflite-model/tflite_learn_3_compiled.cpp"
+#include "edge-impulse-sdk/tensorflow/lite/core/api/flatbuffer_conversions.h"
+#include "edge-impulse-sdk/tensorflow/lite/micro/micro_allocator.h"
+
+// 固件里由 Edge Impulse 移植层和 TFLM 解释器提供；编译模型用不到这些路径，主机端给出最小实现
+void ei_printf(const char *format, ...)
+{
+  va_list args;
+  va_start(args, format);
+  vprintf(format, args);
+  va_end(args);
+}
+void *ei_calloc(size_t count, size_t size) { return calloc(count, size); }
+void ei_free(void *pointer) { free(pointer); }
+void Log(const char *format, va_list args) { vprintf(format, args); }
+
+namespace tflite
+{
+TfLiteStatus MicroAllocator::RequestScratchBufferInArena(size_t, int, int *) { return kTfLiteError; }
+TfLiteStatus ConvertTensorType(TensorType, TfLiteType *) { return kTfLiteError; }
+} // namespace tflite
+
+namespace
+{
+void *alignedAlloc(size_t alignment, size_t size)
+{
+  alignment = alignment < 16 ? 16 : alignment;
+  return aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+}
+
+// 量化后的 MFCC 流：c0 缓慢漂移，高阶系数为噪声；perturb>0 时模拟窗口级归一化让旧帧也发生变化
+std::vector<int8_t> makeStream(size_t frames, std::mt19937 &rng)
+{
+  std::normal_distribution<float> noise(0.0f, 1.0f);
+  std::vector<int8_t> stream(frames * kStreamCoeffs);
+  float energy = 0.0f;
+  for (size_t f = 0; f < frames; ++f)
+  {
+    energy = 0.95f * energy + 6.0f * noise(rng);
+    for (int c = 0; c < kStreamCoeffs; ++c)
+    {
+      float v = c == 0 ? energy : (40.0f / (c + 1)) * noise(rng);
+      int q = static_cast<int>(v) + 17;
+      stream[f * kStreamCoeffs + c] = static_cast<int8_t>(q < -128 ? -128 : (q > 127 ? 127 : q));
+    }
+  }
+  return stream;
+}
+
+struct Outputs
+{
+  int8_t pooled[kPool2Frames * kConv2Channels];
+  int8_t scores[3];
+};
+
+void loadWindow(const std::vector<int8_t> &stream, size_t firstFrame, int perturb, std::mt19937 &rng)
+{
+  TfLiteTensor input;
+  tflite_learn_3_input(0, &input);
+  memcpy(input.data.int8, stream.data() + firstFrame * kStreamCoeffs, kStreamFrames * kStreamCoeffs);
+  for (int i = 0; i < perturb; ++i)
+  {
+    input.data.int8[rng() % (kStreamFrames * kStreamCoeffs)] ^= 1;
+  }
+}
+
+Outputs snapshot(const int8_t *pooled)
+{
+  Outputs out;
+  memcpy(out.pooled, pooled, sizeof(out.pooled));
+  TfLiteTensor output;
+  tflite_learn_3_output(0, &output);
+  memcpy(out.scores, output.data.int8, sizeof(out.scores));
+  return out;
+}
+} // namespace
+
+int main(int argc, char **argv)
+{
+  long steps = argc > 1 ? strtol(argv[1], nullptr, 10) : 5000;
+  if (tflite_learn_3_init(alignedAlloc) != kTfLiteOk)
+  {
+    fprintf(stderr, "model init failed\n");
+    return 1;
+  }
+
+  std::mt19937 rng(20261019);
+  std::vector<int8_t> stream = makeStream(static_cast<size_t>(steps) * 8 + kStreamFrames * 2, rng);
+  TfLiteTensor pooledTensor;
+  init_tflite_tensor(19, &pooledTensor);
+
+  // 前一半只在窗口尾部追加新帧；后一半额外翻转若干旧帧，并穿插 0 帧和未对齐的位移
+  const int kShifts[] = {4, 4, 8, 4, 12, 0, 4, 6, 4, 16, 4, 2, 4, 48, 4, 51};
+  size_t frame = 0;
+  long mismatches = 0;
+  double batchUs = 0;
+  double streamUs = 0;
+  tflite_learn_3_streaming_reset();
+  for (long step = 0; step < steps; ++step)
+  {
+    int shift = step == 0 ? 0 : kShifts[step % (sizeof(kShifts) / sizeof(kShifts[0]))];
+    if (frame + shift + kStreamFrames > stream.size() / kStreamCoeffs)
+    {
+      break;
+    }
+    frame += shift;
+    int perturb = step < steps / 2 ? 0 : static_cast<int>(rng() % 4);
+    uint32_t seed = rng();
+
+    std::mt19937 windowRng(seed);
+    loadWindow(stream, frame, perturb, windowRng);
+    auto start = std::chrono::steady_clock::now();
+    if (tflite_learn_3_invoke() != kTfLiteOk)
+    {
+      fprintf(stderr, "batch invoke failed\n");
+      return 1;
+    }
+    batchUs += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    Outputs batch = snapshot(pooledTensor.data.int8);
+
+    windowRng.seed(seed);
+    loadWindow(stream, frame, perturb, windowRng);
+    start = std::chrono::steady_clock::now();
+    // 0 帧和 >50 帧的位移按调用方实际传入，交给流式路径自己判断是否退回全量
+    if (tflite_learn_3_invoke_streaming(shift) != kTfLiteOk)
+    {
+      fprintf(stderr, "streaming invoke failed\n");
+      return 1;
+    }
+    streamUs += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    Outputs streaming = snapshot(stream_state.pool2);
+
+    if (memcmp(&batch, &streaming, sizeof(Outputs)) != 0)
+    {
+      if (++mismatches <= 5)
+      {
+        printf("MISMATCH step=%ld shift=%d perturb=%d batch=(%d,%d,%d) streaming=(%d,%d,%d)\n",
+               step, shift, perturb, batch.scores[0], batch.scores[1], batch.scores[2],
+               streaming.scores[0], streaming.scores[1], streaming.scores[2]);
+      }
+    }
+  }
+
+  const tflite_learn_3_streaming_stats_t *stats = tflite_learn_3_streaming_stats();
+  printf("steps=%u incremental=%u mismatches=%ld\n", stats->invocations, stats->incremental, mismatches);
+  printf("conv1 columns/step=%.1f of %d, conv2 columns/step=%.1f of %d\n",
+         static_cast<double>(stats->conv1_columns) / stats->invocations, kStreamFrames,
+         static_cast<double>(stats->conv2_columns) / stats->invocations, kPool1Frames);
+  printf("host time/step: batch=%.2fus streaming=%.2fus\n", batchUs / stats->invocations,
+         streamUs / stats->invocations);
+  return mismatches == 0 ? 0 : 1;
+}
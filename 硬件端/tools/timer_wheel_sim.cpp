@@ -0,0 +1,440 @@
+// Host tests and wakeup simulation for the sensor scheduler's timer wheel
+// (src/utils/timer_wheel.cpp).
+//
+// 1. Randomised check against a reference model: periodic and one-shot jobs with
+//    delays from 1 ms to beyond the wheel's 44-minute range, callbacks that cancel,
+//    reschedule or add jobs, and an irregular advance() cadence with occasional
+//    multi-second stalls. Every run must happen at or after its deadline, no due
+//    job may be left behind by more than one tick, and periodic jobs must keep
+//    their deadline grid (missed periods counted, never drifted).
+// 2. Wakeups per second of core-0 sensor work, before and after consolidation:
+//    the original three tasks (button polled every 100 ms, light 1 s, GPS 200 ms),
+//    the interrupt-driven button task, and the single scheduler task running the
+//    real button gesture detector on synthetic bouncy presses.
+//
+/*
+ *   g++ -std=c++17 -O2 -Wall tools/timer_wheel_sim.cpp -o timer_wheel_sim
+ *   ./timer_wheel_sim
+ */
+
+#include <cstdio>
+#include <cstdint>
+#include <deque>
+#include <random>
+#include <vector>
+
+#include "../src/sensors/button_gesture.cpp"
+#include "../src/utils/timer_wheel.cpp"
+
+namespace
+{
+const uint32_t kTickMs = 10;
+
+// ---------------------------------------------------------------------------
+// 1. 随机对照
+// ---------------------------------------------------------------------------
+struct RefJob
+{
+  bool active = false;
+  bool pending = false; // 一次性作业执行后为 false，直到 reschedule
+  uint32_t deadline = 0;
+  uint32_t period = 0;
+  uint32_t runs = 0;
+};
+
+TimerWheel *gWheel = nullptr;
+std::vector<RefJob> gRef(TimerWheel::kMaxJobs);
+std::mt19937 gRng(12345);
+uint32_t gNow = 0;
+uint32_t gMaxStep = 0;
+int gErrors = 0;
+uint32_t gTotalRuns = 0;
+
+uint32_t randomDelay()
+{
+  switch (gRng() % 16)
+  {
+  case 0:
+  case 1:
+  case 2:
+    return gRng() % 20;
+  case 3:
+  case 4:
+  case 5:
+    return gRng() % 640;
+  case 6:
+    return gRng() % 41000;
+  case 7:
+    return gRng() % 2700000;
+  case 8:
+    return 2700000 + gRng() % 3000000; // 超出三级范围
+  default:
+    return 100 + gRng() % 2000;
+  }
+}
+
+void fail(const char *what, int id)
+{
+  if (gErrors < 10)
+  {
+    printf("  error at %u ms, job %d: %s (deadline %u)\n", gNow, id, what, gRef[id].deadline);
+  }
+  ++gErrors;
+}
+
+void addRandomJob();
+
+void onJob(void *context)
+{
+  int id = static_cast<int>(reinterpret_cast<intptr_t>(context));
+  RefJob &ref = gRef[id];
+  if (!ref.active || !ref.pending)
+  {
+    fail("ran while not scheduled", id);
+    return;
+  }
+  int32_t late = static_cast<int32_t>(gNow - ref.deadline);
+  if (late < 0)
+  {
+    fail("ran early", id);
+  }
+  // 截止时刻向上取整到 tick，加上两次 advance 之间的间隔
+  else if (static_cast<uint32_t>(late) >= kTickMs + gMaxStep)
+  {
+    fail("ran too late", id);
+  }
+  ++ref.runs;
+  ++gTotalRuns;
+
+  // 参考模型：周期作业按截止时刻累加，落后的周期跳过
+  if (ref.period > 0)
+  {
+    uint32_t next = ref.deadline + ref.period;
+    if (static_cast<int32_t>(gNow - next) >= 0)
+    {
+      next += ((gNow - next) / ref.period + 1) * ref.period;
+    }
+    ref.deadline = next;
+  }
+  else
+  {
+    ref.pending = false;
+  }
+
+  // 回调里改动时间轮
+  switch (gRng() % 40)
+  {
+  case 0:
+    gWheel->cancel(id);
+    ref.active = false;
+    break;
+  case 1:
+  {
+    uint32_t delay = randomDelay();
+    gWheel->reschedule(id, delay);
+    ref.deadline = gNow + delay;
+    ref.pending = true;
+    break;
+  }
+  case 2:
+  {
+    // 取消另一个作业（可能和本作业在同一个槽里）
+    int other = static_cast<int>(gRng() % TimerWheel::kMaxJobs);
+    if (other != id && gRef[other].active)
+    {
+      gWheel->cancel(other);
+      gRef[other].active = false;
+    }
+    break;
+  }
+  case 3:
+    addRandomJob();
+    break;
+  default:
+    break;
+  }
+
+  // 执行完的一次性作业多数释放掉，留一部分占着 id（执行后仍算在 jobCount 里）
+  if (ref.active && !ref.pending && gRng() % 4 != 0)
+  {
+    gWheel->cancel(id);
+    ref.active = false;
+  }
+}
+
+void addRandomJob()
+{
+  // 先占位再分配：id 由时间轮决定，参考状态在返回后写入
+  bool periodic = gRng() % 2 == 0;
+  uint32_t delay = randomDelay();
+  uint32_t period = periodic ? 1 + gRng() % 5000 : 0;
+  int id = TimerWheel::kInvalidJob;
+  for (size_t i = 0; i < TimerWheel::kMaxJobs; ++i)
+  {
+    if (!gRef[i].active)
+    {
+      id = static_cast<int>(i);
+      break;
+    }
+  }
+  if (id == TimerWheel::kInvalidJob)
+  {
+    return;
+  }
+  void *context = reinterpret_cast<void *>(static_cast<intptr_t>(id));
+  int got = periodic ? gWheel->addPeriodic("rnd", period, delay, onJob, context)
+                     : gWheel->addOneShot("rnd", delay, onJob, context);
+  if (got != id)
+  {
+    fail("unexpected id", id);
+    return;
+  }
+  gRef[id].active = true;
+  gRef[id].pending = true;
+  gRef[id].deadline = gNow + delay;
+  gRef[id].period = period;
+  gRef[id].runs = 0;
+}
+
+int runRandomised(uint32_t startMs, uint32_t durationMs)
+{
+  TimerWheel wheel(kTickMs);
+  gWheel = &wheel;
+  gRef.assign(TimerWheel::kMaxJobs, RefJob());
+  gNow = startMs;
+  gErrors = 0;
+  gTotalRuns = 0;
+  wheel.begin(startMs);
+  for (int i = 0; i < 12; ++i)
+  {
+    addRandomJob();
+  }
+
+  const uint32_t endMs = startMs + durationMs;
+  size_t steps = 0;
+  while (static_cast<int32_t>(endMs - gNow) > 0)
+  {
+    uint32_t step;
+    if (gRng() % 500 == 0)
+    {
+      step = 2000 + gRng() % 8000; // 调度任务被阻塞几秒
+    }
+    else
+    {
+      // 通常睡到下一个到期时刻，偶尔被中断提前唤醒
+      uint32_t wait = wheel.msUntilNext(gNow);
+      step = gRng() % 4 == 0 || wait == UINT32_MAX ? 1 + gRng() % 37 : (wait == 0 ? 1 : wait);
+    }
+    gMaxStep = step;
+    gNow += step;
+    wheel.advance(gNow);
+    ++steps;
+
+    for (size_t i = 0; i < TimerWheel::kMaxJobs; ++i)
+    {
+      const RefJob &ref = gRef[i];
+      if (ref.active && ref.pending && static_cast<int32_t>(gNow - ref.deadline) >= static_cast<int32_t>(kTickMs))
+      {
+        fail("left behind", static_cast<int>(i));
+      }
+    }
+    if (wheel.jobCount() < 12 && gRng() % 8 == 0)
+    {
+      addRandomJob();
+    }
+    // 执行过的一次性作业在回调外重新登记
+    int idle = static_cast<int>(gRng() % TimerWheel::kMaxJobs);
+    if (gRef[idle].active && !gRef[idle].pending && gRng() % 4 == 0)
+    {
+      uint32_t delay = randomDelay();
+      wheel.reschedule(idle, delay);
+      gRef[idle].deadline = gNow + delay;
+      gRef[idle].pending = true;
+    }
+  }
+
+  size_t active = 0;
+  for (const RefJob &ref : gRef)
+  {
+    active += ref.active ? 1 : 0;
+  }
+  if (active != wheel.jobCount())
+  {
+    printf("  job count mismatch: wheel %zu, reference %zu\n", wheel.jobCount(), active);
+    ++gErrors;
+  }
+  printf("  start %10u ms: %zu advance() calls, %u job runs, %d errors\n", startMs, steps, gTotalRuns, gErrors);
+  return gErrors;
+}
+
+// ---------------------------------------------------------------------------
+// 2. 唤醒次数
+// ---------------------------------------------------------------------------
+struct Edge
+{
+  uint32_t timeMs;
+  bool pressed;
+};
+
+// 每 pressEveryMs 一次带抖动的单击（按下/松开各 4 个抖动边沿）
+std::vector<Edge> syntheticPresses(uint32_t startMs, uint32_t durationMs, uint32_t pressEveryMs)
+{
+  std::vector<Edge> edges;
+  if (pressEveryMs == 0)
+  {
+    return edges;
+  }
+  for (uint32_t t = startMs + pressEveryMs / 2; t < startMs + durationMs; t += pressEveryMs)
+  {
+    for (int level = 0; level < 2; ++level)
+    {
+      uint32_t at = t + level * 120;
+      bool pressed = level == 0;
+      for (int i = 0; i < 4; ++i)
+      {
+        edges.push_back({at + 2 * i, pressed});
+        edges.push_back({at + 2 * i + 1, !pressed});
+      }
+      edges.push_back({at + 8, pressed});
+    }
+  }
+  return edges;
+}
+
+struct SchedulerSim
+{
+  TimerWheel wheel{kTickMs};
+  ButtonGestureDetector detector;
+  std::deque<Edge> queue;
+  int buttonJob = TimerWheel::kInvalidJob;
+  uint32_t now = 0;
+  uint32_t gestures = 0;
+};
+
+SchedulerSim *gSim = nullptr;
+
+// 与 button_manager.cpp 的作业相同：取边沿、出手势、按下一个截止时刻重新登记
+void simButtonJob(void *)
+{
+  SchedulerSim &sim = *gSim;
+  while (!sim.queue.empty())
+  {
+    sim.detector.onEdge(sim.queue.front().pressed, sim.queue.front().timeMs);
+    sim.queue.pop_front();
+  }
+  for (ButtonGesture g = sim.detector.update(sim.now); g != ButtonGesture::None; g = sim.detector.update(sim.now))
+  {
+    ++sim.gestures;
+  }
+  uint32_t wait = sim.detector.msUntilDeadline(sim.now);
+  sim.wheel.reschedule(sim.buttonJob, wait < 1000 ? wait : 1000);
+}
+
+void simNoop(void *) {}
+
+// 单个调度任务：中断边沿唤醒一次，其余时间睡到时间轮的下一个到期时刻
+double schedulerWakeupsPerSecond(uint32_t durationMs, uint32_t pressEveryMs, uint32_t *gesturesOut)
+{
+  SchedulerSim sim;
+  gSim = &sim;
+  const uint32_t start = 5000;
+  sim.now = start;
+  sim.wheel.begin(start);
+  sim.buttonJob = sim.wheel.addOneShot("button", 1000, simButtonJob, nullptr);
+  sim.wheel.addPeriodic("light", 1000, 1000, simNoop, nullptr);
+  sim.wheel.addPeriodic("gps", 200, 200, simNoop, nullptr);
+  sim.detector.reset(false, start);
+
+  std::vector<Edge> edges = syntheticPresses(start, durationMs, pressEveryMs);
+  size_t next = 0;
+  uint32_t wakeups = 0;
+  while (sim.now - start < durationMs)
+  {
+    uint32_t wait = sim.wheel.msUntilNext(sim.now);
+    bool edgeFirst = next < edges.size() && edges[next].timeMs - sim.now <= wait;
+    sim.now = edgeFirst ? edges[next].timeMs : sim.now + wait;
+    ++wakeups;
+    sim.wheel.advance(sim.now);
+    if (edgeFirst)
+    {
+      // 同一毫秒内的边沿一次唤醒处理完（通知计数被 ulTaskNotifyTake 一次清零）
+      while (next < edges.size() && edges[next].timeMs == sim.now)
+      {
+        sim.queue.push_back(edges[next++]);
+      }
+      sim.wheel.kick(sim.buttonJob);
+    }
+  }
+  *gesturesOut = sim.gestures;
+  return wakeups * 1000.0 / durationMs;
+}
+
+// 中断驱动的按键任务（阻塞在边沿队列上，空闲每秒醒一次补边沿）：边沿和截止时刻各唤醒一次
+double buttonTaskWakeupsPerSecond(uint32_t durationMs, uint32_t pressEveryMs)
+{
+  const uint32_t start = 5000;
+  ButtonGestureDetector detector;
+  detector.reset(false, start);
+  std::vector<Edge> edges = syntheticPresses(start, durationMs, pressEveryMs);
+  size_t next = 0;
+  uint32_t now = start;
+  uint32_t wakeups = 0;
+  while (now - start < durationMs)
+  {
+    while (detector.update(now) != ButtonGesture::None)
+    {
+    }
+    uint32_t wait = detector.msUntilDeadline(now);
+    wait = (wait < 1000 ? wait : 1000) + 1;
+    if (next < edges.size() && edges[next].timeMs - now <= wait)
+    {
+      now = edges[next].timeMs;
+      detector.onEdge(edges[next].pressed, now);
+      ++next;
+    }
+    else
+    {
+      now += wait;
+    }
+    ++wakeups;
+  }
+  return wakeups * 1000.0 / durationMs;
+}
+} // namespace
+
+int main()
+{
+  int failures = 0;
+  printf("randomised timer wheel check (tick %u ms)\n", kTickMs);
+  failures += runRandomised(0, 24 * 3600 * 1000);
+  failures += runRandomised(123456789, 24 * 3600 * 1000);
+  failures += runRandomised(UINT32_MAX - 12 * 3600 * 1000, 24 * 3600 * 1000); // 跨 millis() 回绕
+
+  const uint32_t durationMs = 600 * 1000;
+  const double light = 1.0;
+  const double gps = 5.0;
+  printf("\ncore-0 sensor wakeups per second (%u s simulated)\n", durationMs / 1000);
+  printf("  %-44s %6s %14s\n", "", "idle", "press / 10 s");
+  printf("  %-44s %6.2f %14.2f\n", "3 tasks, button polled every 100 ms", 10.0 + light + gps, 10.0 + light + gps);
+  printf("  %-44s %6.2f %14.2f\n", "3 tasks, interrupt-driven button",
+         buttonTaskWakeupsPerSecond(durationMs, 0) + light + gps,
+         buttonTaskWakeupsPerSecond(durationMs, 10000) + light + gps);
+  uint32_t idleGestures = 0;
+  uint32_t busyGestures = 0;
+  double idle = schedulerWakeupsPerSecond(durationMs, 0, &idleGestures);
+  double busy = schedulerWakeupsPerSecond(durationMs, 10000, &busyGestures);
+  printf("  %-44s %6.2f %14.2f\n", "1 scheduler task, timer wheel", idle, busy);
+  uint32_t expectedGestures = durationMs / 10000;
+  printf("  gestures recognised by the scheduled button job: %u / %u\n", busyGestures, expectedGestures);
+  if (idleGestures != 0 || busyGestures != expectedGestures)
+  {
+    ++failures;
+  }
+
+  const unsigned stack = 4096;
+  printf("\ntask stacks: before 3 x %u = %u bytes, after 1 x %u = %u bytes, freed %u bytes\n", stack, 3 * stack, stack,
+         stack, 2 * stack);
+
+  printf(failures ? "\nFAILED\n" : "\nall checks passed\n");
+  return failures ? 1 : 0;
+}
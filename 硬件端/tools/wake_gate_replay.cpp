@@ -0,0 +1,266 @@
+// Host replay harness for the wake-word energy/flux gate (src/audio/wake_gate.cpp).
+//
+// Mixes speech excerpts cut from data/audio/*.wav into several synthetic noise
+// scenes, runs them through the same amplifyAudioData() gain stage and 1024-sample
+// capture blocks as capture_samples(), and fills 1 s inference windows exactly as
+// audio_inference_callback() does. Without the gate every window goes through
+// run_classifier, but only windows with energy >= WAKE_MIN_AUDIO_ENERGY can ever
+// trigger; a window with audible speech (>= 0.25 s at >= 0 dB SNR) that passes the
+// energy check but is skipped by the gate counts as a miss. The run fails if any
+// scene has a miss. The classifier itself is not run: this measures how many
+// windows the gate withholds from it, not the model's own detection rate.
+//
+/*
+ *   g++ -std=c++17 -O2 tools/wake_gate_replay.cpp -o wake_gate_replay
+ *   ./wake_gate_replay [minutes-per-scene] [data/audio]
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../src/audio/wake_gate.cpp"
+
+namespace
+{
+const size_t kSampleRate = 16000;
+const size_t kBlockSamples = 1024;  // sample_buffer_size 2048 字节
+const size_t kWindowSamples = 16000; // EI_CLASSIFIER_RAW_SAMPLE_COUNT
+const uint32_t kMinAudioEnergy = 150;
+
+std::vector<int16_t> loadWav(const std::string &path)
+{
+  std::vector<int16_t> samples;
+  FILE *file = fopen(path.c_str(), "rb");
+  if (!file)
+  {
+    return samples;
+  }
+  uint8_t header[12];
+  if (fread(header, 1, sizeof(header), file) != sizeof(header) || memcmp(header, "RIFF", 4) != 0)
+  {
+    fclose(file);
+    return samples;
+  }
+  uint8_t chunk[8];
+  while (fread(chunk, 1, sizeof(chunk), file) == sizeof(chunk))
+  {
+    uint32_t size = chunk[4] | chunk[5] << 8 | chunk[6] << 16 | static_cast<uint32_t>(chunk[7]) << 24;
+    if (memcmp(chunk, "data", 4) == 0)
+    {
+      samples.resize(size / 2);
+      samples.resize(fread(samples.data(), 2, samples.size(), file));
+      break;
+    }
+    fseek(file, (size + 1) & ~1u, SEEK_CUR);
+  }
+  fclose(file);
+  return samples;
+}
+
+// 与 main.cpp 的 amplifyAudioData 相同：|x|<100 置零，其余放大 4 倍并限幅
+void amplify(int16_t *buffer, size_t count)
+{
+  for (size_t i = 0; i < count; ++i)
+  {
+    if (abs(buffer[i]) < 100)
+    {
+      buffer[i] = 0;
+      continue;
+    }
+    int32_t v = buffer[i] * 4;
+    buffer[i] = static_cast<int16_t>(std::max<int32_t>(INT16_MIN, std::min<int32_t>(INT16_MAX, v)));
+  }
+}
+
+uint32_t windowEnergy(const int16_t *data, size_t count)
+{
+  uint32_t sum = 0;
+  for (size_t i = 0; i < count; ++i)
+  {
+    sum += abs(data[i]);
+  }
+  return sum / (count * 2);
+}
+
+// 窗口内有效语音（非静音段）不少于 0.25 s 且信噪比不低于 0 dB 才算可闻；
+// 更短或埋在噪声里的片段，原本的分类器也不可能据此唤醒
+bool audibleSpeech(const float *speech, const float *noise, size_t count)
+{
+  double speechPower = 0;
+  double noisePower = 0;
+  size_t active = 0;
+  for (size_t i = 0; i < count; ++i)
+  {
+    if (fabsf(speech[i]) < 25.0f) // 放大前约 -62 dBFS，TTS 片段的句间静音
+    {
+      continue;
+    }
+    speechPower += speech[i] * speech[i];
+    noisePower += noise[i] * noise[i];
+    ++active;
+  }
+  return active >= kSampleRate / 4 && speechPower >= noisePower;
+}
+
+struct Scene
+{
+  const char *name;
+  float white;    // 宽带噪声标准差（放大前的 ADC 计数）
+  float hum;      // 100 Hz 电源哼声幅度
+  float rumble;   // 低通噪声（风扇/车流）标准差
+  float speechDb; // 语音相对原始 WAV 的增益
+  float eventsPerMinute;
+};
+
+struct Result
+{
+  uint32_t windows = 0;
+  uint32_t candidates = 0; // 能量达标、未加门控时可能触发的窗口
+  uint32_t speechCandidates = 0;
+  uint32_t classified = 0;
+  uint32_t misses = 0;
+  double dutyCycle = 0;
+};
+
+Result runScene(const Scene &scene, const std::vector<std::vector<int16_t>> &speech, double minutes, uint32_t seed)
+{
+  std::mt19937 rng(seed);
+  std::normal_distribution<float> gauss(0.0f, 1.0f);
+  size_t total = static_cast<size_t>(minutes * 60 * kSampleRate);
+
+  // 噪声底 + 随机插入的 0.3~0.8 s 语音片段；speech 单独保留，用于判断窗口里的语音是否可闻
+  std::vector<int16_t> raw(total);
+  std::vector<float> speechOnly(total, 0.0f);
+  float rumble = 0.0f;
+  std::vector<float> mix(total);
+  for (size_t i = 0; i < total; ++i)
+  {
+    rumble = 0.98f * rumble + 0.2f * scene.rumble * gauss(rng);
+    mix[i] = scene.white * gauss(rng) + scene.hum * sinf(2.0f * 3.14159265f * 100.0f * i / kSampleRate) + rumble;
+  }
+  size_t events = static_cast<size_t>(scene.eventsPerMinute * minutes);
+  std::uniform_real_distribution<float> level(scene.speechDb - 6.0f, scene.speechDb + 6.0f);
+  for (size_t e = 0; e < events && !speech.empty(); ++e)
+  {
+    const std::vector<int16_t> &clip = speech[rng() % speech.size()];
+    size_t length = std::min(clip.size(), kSampleRate * 3 / 10 + rng() % (kSampleRate / 2));
+    size_t from = clip.size() > length ? rng() % (clip.size() - length) : 0;
+    size_t at = rng() % (total - length);
+    float gain = powf(10.0f, level(rng) / 20.0f);
+    for (size_t i = 0; i < length; ++i)
+    {
+      speechOnly[at + i] += gain * clip[from + i];
+    }
+  }
+  for (size_t i = 0; i < total; ++i)
+  {
+    raw[i] = static_cast<int16_t>(std::max(-32768.0f, std::min(32767.0f, mix[i] + speechOnly[i])));
+  }
+
+  WakeGate gate;
+  Result result;
+  std::vector<int16_t> window(kWindowSamples);
+  size_t fill = 0;
+  size_t windowStart = 0;
+  int16_t block[kBlockSamples];
+  for (size_t pos = 0; pos + kBlockSamples <= total; pos += kBlockSamples)
+  {
+    memcpy(block, &raw[pos], sizeof(block));
+    amplify(block, kBlockSamples);
+    gate.processBlock(block, kBlockSamples);
+    // 与 audio_inference_callback 一致：窗口填满后本块剩余样本丢弃
+    if (fill == 0)
+    {
+      windowStart = pos;
+    }
+    for (size_t i = 0; i < kBlockSamples && fill < kWindowSamples; ++i)
+    {
+      window[fill++] = block[i];
+    }
+    if (fill < kWindowSamples)
+    {
+      continue;
+    }
+    bool open = gate.finishWindow();
+    uint32_t energy = windowEnergy(window.data(), kWindowSamples);
+    bool windowHasSpeech = audibleSpeech(&speechOnly[windowStart], &mix[windowStart], kWindowSamples);
+    ++result.windows;
+    if (energy >= kMinAudioEnergy)
+    {
+      ++result.candidates;
+      result.speechCandidates += windowHasSpeech;
+      if (open)
+      {
+        ++result.classified;
+      }
+      else if (windowHasSpeech)
+      {
+        ++result.misses;
+      }
+    }
+    fill = 0;
+  }
+  result.dutyCycle = static_cast<double>(gate.stats().openBlocks) / gate.stats().blocks;
+  return result;
+}
+} // namespace
+
+int main(int argc, char **argv)
+{
+  double minutes = argc > 1 ? atof(argv[1]) : 30.0;
+  std::string dir = argc > 2 ? argv[2] : "data/audio";
+
+  std::vector<std::vector<int16_t>> speech;
+  if (DIR *d = opendir(dir.c_str()))
+  {
+    while (dirent *entry = readdir(d))
+    {
+      std::string name = entry->d_name;
+      if (name.size() > 4 && name.compare(name.size() - 4, 4, ".wav") == 0)
+      {
+        std::vector<int16_t> clip = loadWav(dir + "/" + name);
+        if (clip.size() > kSampleRate)
+        {
+          speech.push_back(std::move(clip));
+        }
+      }
+    }
+    closedir(d);
+  }
+  if (speech.empty())
+  {
+    fprintf(stderr, "no speech clips in %s\n", dir.c_str());
+    return 1;
+  }
+
+  const Scene scenes[] = {
+      {"silence", 8, 0, 0, -12, 0},
+      {"quiet room + speech", 30, 0, 0, -12, 4},
+      {"fan/hum + speech", 40, 60, 120, -6, 4},
+      {"street + speech", 160, 0, 300, 0, 6},
+      {"loud broadband", 400, 0, 0, 0, 0},
+      {"whisper + speech", 20, 0, 0, -24, 6},
+  };
+
+  printf("%zu speech clips, %.0f min per scene\n", speech.size(), minutes);
+  printf("%-22s %8s %8s %8s %10s %10s %8s\n", "scene", "windows", "energy", "speech", "duty", "runs/min", "misses");
+  uint32_t misses = 0;
+  uint32_t seed = 20261019;
+  for (const Scene &scene : scenes)
+  {
+    Result r = runScene(scene, speech, minutes, seed++);
+    double perMinute = r.classified / (r.windows / 60.0);
+    printf("%-22s %8u %8u %8u %9.1f%% %10.1f %8u\n", scene.name, r.windows, r.candidates, r.speechCandidates,
+           r.dutyCycle * 100.0, perMinute, r.misses);
+    misses += r.misses;
+  }
+  printf("baseline: 60 runs/min in every scene (classifier on each window)\n");
+  return misses == 0 ? 0 : 1;
+}
@@ -0,0 +1,155 @@
+// Host round-trip test for device request bodies (src/utils/wire_body.h).
+//
+// Builds the same documents ServerApi posts (/v1/device/status, /gps, /ai,
+// /v1/gps/track) and encodes them the way postDocument() does, as JSON and as
+// MessagePack. Every MessagePack body here contains 0x00 bytes (zero and small
+// integers, str16 length headers, double payloads); the test checks that the
+// encoded length matches measureMsgPack(), that the bytes after the first 0x00
+// are kept, and that deserializeMsgPack() gives back every field. It also shows
+// what the previous String-based path would have sent: the body cut at the
+// first 0x00. The /v1/gps/track batch is also sent the way
+// postGpsTrackBinary() does under SERVER_WIRE_FORMAT_MSGPACK, as a bin field.
+//
+// Build against the same ArduinoJson release the firmware pulls in (7.x):
+/*
+ *   g++ -std=c++17 -O2 -Wall -I<path-to>/ArduinoJson/src tools/wire_body_check.cpp -o wire_body_check
+ *   ./wire_body_check
+ */
+
+#include <ArduinoJson.h>
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include "../src/utils/wire_body.h"
+
+namespace
+{
+int failures = 0;
+
+void check(bool condition, const char *name, const char *what)
+{
+  if (!condition)
+  {
+    printf("  FAIL [%s] %s\n", name, what);
+    ++failures;
+  }
+}
+
+// 以前 serializeMsgPack(doc, String) 的效果：String 写入器按 C 字符串拼接，遇 0x00 截断
+size_t stringWriterLength(const WireBody &body)
+{
+  const uint8_t *zero = static_cast<const uint8_t *>(memchr(body.data(), 0, body.length()));
+  return zero ? static_cast<size_t>(zero - body.data()) : body.length();
+}
+
+template <typename Verify>
+void roundTrip(const char *name, const JsonDocument &doc, Verify verify)
+{
+  WireBody msgpack;
+  check(msgpack.encode(doc, true), name, "msgpack encode");
+  check(msgpack.length() == measureMsgPack(doc), name, "msgpack length matches measureMsgPack");
+  size_t cut = stringWriterLength(msgpack);
+  check(cut < msgpack.length(), name, "msgpack body contains 0x00 (test covers the NUL case)");
+
+  JsonDocument decoded;
+  DeserializationError error = deserializeMsgPack(decoded, msgpack.data(), msgpack.length());
+  check(!error, name, "msgpack body decodes");
+  check(verify(decoded), name, "msgpack fields round-trip");
+
+  JsonDocument truncated;
+  bool truncatedOk = !deserializeMsgPack(truncated, msgpack.data(), cut) && verify(truncated);
+  check(!truncatedOk, name, "body cut at the first 0x00 would not round-trip");
+
+  WireBody json;
+  check(json.encode(doc, false), name, "json encode");
+  check(json.length() == measureJson(doc), name, "json length matches measureJson");
+  JsonDocument fromJson;
+  check(!deserializeJson(fromJson, json.data(), json.length()) && verify(fromJson), name, "json fields round-trip");
+
+  printf("%-18s msgpack %3zu bytes (String path would send %2zu), json %3zu bytes\n", name, msgpack.length(), cut,
+         json.length());
+}
+} // namespace
+
+int main()
+{
+  {
+    JsonDocument doc;
+    doc["device_id"] = "guide-cane-001";
+    doc["uptime_ms"] = 0;
+    doc["free_heap"] = 180000;
+    doc["rssi"] = -61;
+    doc["app_state"] = "IDLE";
+    doc["navigation_active"] = false;
+    doc["gps_valid"] = false;
+    roundTrip("device_status", doc, [](const JsonDocument &d) {
+      return d["device_id"] == "guide-cane-001" && d["uptime_ms"].as<uint32_t>() == 0 &&
+             d["free_heap"].as<uint32_t>() == 180000 && d["rssi"].as<int>() == -61 && d["app_state"] == "IDLE" &&
+             d["navigation_active"].is<bool>() && !d["navigation_active"].as<bool>() && d["gps_valid"].is<bool>();
+    });
+  }
+  {
+    JsonDocument doc;
+    doc["device_id"] = "guide-cane-001";
+    doc["latitude"] = 28.5; // 尾数低位全 0，按 float32 或 float64 编码都带 0x00
+    doc["longitude"] = 115.89;
+    roundTrip("gps", doc, [](const JsonDocument &d) {
+      return d["device_id"] == "guide-cane-001" && fabs(d["latitude"].as<double>() - 28.5) < 1e-9 &&
+             fabs(d["longitude"].as<double>() - 115.89) < 1e-9;
+    });
+  }
+  {
+    // 超过 31 字节的字符串用 str8/str16 头；长度 256 时 str16 头里带 0x00
+    std::string message(256, 'a');
+    message.replace(0, 6, "导航");
+    JsonDocument doc;
+    doc["device_id"] = "guide-cane-001";
+    doc["message"] = message.c_str();
+    roundTrip("ai", doc, [message](const JsonDocument &d) {
+      return d["device_id"] == "guide-cane-001" && d["message"] == message.c_str();
+    });
+  }
+  {
+    JsonDocument doc;
+    doc["device_id"] = "guide-cane-001";
+    doc["format"] = 1;
+    doc["count"] = 0;
+    doc["track"] = "AQ==";
+    roundTrip("gps_track", doc, [](const JsonDocument &d) {
+      return d["format"].as<int>() == 1 && d["count"].as<int>() == 0 && d["track"] == "AQ==";
+    });
+  }
+
+  {
+    // 与 web/tests/test_gps_track.py 的 DEVICE_VECTOR 相同：varint 增量里有成串的 0x00
+    static const uint8_t track[] = {0x01, 0x80, 0xd4, 0xf2, 0x8d, 0xc2, 0x32, 0xa8, 0xff, 0x8e, 0x26,
+                                    0xc4, 0xf0, 0xff, 0x6e, 0x2c, 0x0a, 0x09, 0xd0, 0x0f, 0x18, 0x0d,
+                                    0x2e, 0x0a, 0x0a, 0xd0, 0x0f, 0x00, 0x00, 0x00, 0x00, 0x00};
+    JsonDocument doc;
+    doc["device_id"] = "guide-cane-001";
+    doc["format"] = 1;
+    doc["count"] = 3;
+    doc["track"] = MsgPackBinary(track, sizeof(track));
+    WireBody body;
+    check(body.encode(doc, true), "gps_track_bin", "msgpack encode");
+    check(body.length() == measureMsgPack(doc), "gps_track_bin", "msgpack length matches measureMsgPack");
+    JsonDocument decoded;
+    check(!deserializeMsgPack(decoded, body.data(), body.length()), "gps_track_bin", "msgpack body decodes");
+    MsgPackBinary bin = decoded["track"].as<MsgPackBinary>();
+    check(bin.size() == sizeof(track) && memcmp(bin.data(), track, sizeof(track)) == 0, "gps_track_bin",
+          "bin field round-trips byte for byte");
+    printf("%-18s msgpack %3zu bytes (track %zu bytes, base64 would be %zu)\n", "gps_track_bin", body.length(),
+           sizeof(track), (sizeof(track) + 2) / 3 * 4);
+  }
+
+  if (failures)
+  {
+    printf("%d check(s) failed\n", failures);
+    return 1;
+  }
+  printf("all checks passed\n");
+  return 0;
+}
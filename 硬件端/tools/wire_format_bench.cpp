@@ -0,0 +1,194 @@
+// Host benchmark: ArduinoJson parse cost of JSON vs MessagePack server responses.
+//
+// Build against the same ArduinoJson release the firmware pulls in (7.x):
+//   g++ -std=c++17 -O2 -I<path-to>/ArduinoJson/src tools/wire_format_bench.cpp -o wire_format_bench
+// Generate fixtures from the server's real response builders, then run:
+//   python ../web/tools/bench_wire_format.py --dump-fixtures /tmp/wire
+//   ./wire_format_bench /tmp/wire/navigation.json /tmp/wire/navigation.msgpack \
+//                       /tmp/wire/weather.json /tmp/wire/weather.msgpack
+//
+// For each file it reports the average parse + field extraction time and the
+// allocator traffic (calls and peak bytes) seen by the JsonDocument, mirroring
+// what parseServerResponse() does on the device.
+
+#include <ArduinoJson.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace
+{
+class CountingAllocator : public ArduinoJson::Allocator
+{
+public:
+  void *allocate(size_t size) override
+  {
+    ++allocations;
+    current += size;
+    if (current > peak)
+    {
+      peak = current;
+    }
+    auto *block = static_cast<size_t *>(malloc(size + sizeof(size_t)));
+    *block = size;
+    return block + 1;
+  }
+
+  void deallocate(void *pointer) override
+  {
+    if (pointer == nullptr)
+    {
+      return;
+    }
+    auto *block = static_cast<size_t *>(pointer) - 1;
+    current -= *block;
+    free(block);
+  }
+
+  void *reallocate(void *pointer, size_t newSize) override
+  {
+    ++reallocations;
+    auto *block = static_cast<size_t *>(pointer) - 1;
+    current = current - *block + newSize;
+    if (current > peak)
+    {
+      peak = current;
+    }
+    block = static_cast<size_t *>(realloc(block, newSize + sizeof(size_t)));
+    *block = newSize;
+    return block + 1;
+  }
+
+  void reset()
+  {
+    allocations = 0;
+    reallocations = 0;
+    peak = current;
+  }
+
+  size_t allocations = 0;
+  size_t reallocations = 0;
+  size_t current = 0;
+  size_t peak = 0;
+};
+
+struct ParsedFields
+{
+  std::string intent;
+  std::string response;
+  std::string speakMode;
+  std::string speakText;
+  std::string audioId;
+  std::string audioUrl;
+  std::string destination;
+  std::string nextInstruction;
+  long remainingDistance = -1;
+  long totalDuration = -1;
+  bool navigationActive = false;
+};
+
+bool isMsgPack(const std::vector<char> &data)
+{
+  if (data.empty())
+  {
+    return false;
+  }
+  auto first = static_cast<uint8_t>(data[0]);
+  return (first >= 0x80 && first <= 0x8f) || first == 0xde || first == 0xdf;
+}
+
+bool parseOnce(const std::vector<char> &data, ArduinoJson::Allocator *allocator, ParsedFields *out)
+{
+  JsonDocument doc(allocator);
+  DeserializationError error = isMsgPack(data) ? deserializeMsgPack(doc, data.data(), data.size())
+                                               : deserializeJson(doc, data.data(), data.size());
+  if (error)
+  {
+    return false;
+  }
+
+  out->intent = doc["intent"] | "";
+  out->response = doc["response"] | "";
+  JsonObjectConst speak = doc["speak"];
+  out->speakMode = speak["mode"] | "tts_text";
+  out->speakText = speak["text"] | "";
+  out->audioId = speak["audio_id"] | "";
+  out->audioUrl = speak["audio_url"] | "";
+  JsonObjectConst navigation = doc["navigation"];
+  out->navigationActive = navigation["active"] | false;
+  out->destination = navigation["destination"] | "";
+  out->remainingDistance = navigation["remaining_distance"] | -1L;
+  out->totalDuration = navigation["total_duration"] | -1L;
+  out->nextInstruction = navigation["next_instruction"] | "";
+  return true;
+}
+
+bool readFile(const char *path, std::vector<char> *data)
+{
+  std::ifstream input(path, std::ios::binary);
+  if (!input)
+  {
+    return false;
+  }
+  data->assign(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+  return true;
+}
+} // namespace
+
+int main(int argc, char **argv)
+{
+  if (argc < 2)
+  {
+    fprintf(stderr, "usage: %s <fixture.json|fixture.msgpack>...\n", argv[0]);
+    return 2;
+  }
+
+  constexpr int kIterations = 20000;
+  for (int i = 1; i < argc; ++i)
+  {
+    std::vector<char> data;
+    if (!readFile(argv[i], &data))
+    {
+      fprintf(stderr, "cannot read %s\n", argv[i]);
+      return 1;
+    }
+
+    CountingAllocator allocator;
+    ParsedFields fields;
+    if (!parseOnce(data, &allocator, &fields))
+    {
+      fprintf(stderr, "parse failed: %s\n", argv[i]);
+      return 1;
+    }
+
+    allocator.reset();
+    parseOnce(data, &allocator, &fields);
+    size_t allocationsPerParse = allocator.allocations;
+    size_t reallocationsPerParse = allocator.reallocations;
+    size_t peakBytes = allocator.peak;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int n = 0; n < kIterations; ++n)
+    {
+      parseOnce(data, &allocator, &fields);
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    double averageUs = std::chrono::duration<double, std::micro>(elapsed).count() / kIterations;
+
+    printf("%-40s %-7s bytes=%-5zu parse=%7.2fus allocs=%zu reallocs=%zu peak=%zuB intent=%s\n",
+           argv[i],
+           isMsgPack(data) ? "msgpack" : "json",
+           data.size(),
+           averageUs,
+           allocationsPerParse,
+           reallocationsPerParse,
+           peakBytes,
+           fields.intent.c_str());
+  }
+  return 0;
+}